@@ -44,6 +44,12 @@ bool MeshImporter::import( FileSystemQPtr fs, const Io::Path& sourceFileName, co
     Io::StreamPtr stream = Io::DiskFileSystem::open( destinationFileName, Io::BinaryWriteStream );
     NIMBLE_BREAK_IF( !stream.valid() );
 
+    // Write the raw mesh header
+    u32 magic   = Scene::MeshFormatRaw::Magic;
+    u32 version = Scene::MeshFormatRaw::Version;
+    stream->write( &magic, 4 );
+    stream->write( &version, 4 );
+
     s32 chunkCount = ( s32 )m_nodes.size();
     stream->write( &chunkCount, 4 );
 
@@ -64,6 +70,10 @@ bool MeshImporter::import( FileSystemQPtr fs, const Io::Path& sourceFileName, co
         stream->write( &vertexCount, 4 );
         stream->write( &indexCount, 4 );
 
+        // Write the index size, so a loader does not have to guess it
+        s32 indexSize = sizeof( indices[0] );
+        stream->write( &indexSize, 4 );
+
         // Write vertices to stream
         for( s32 j = 0; j < vertexCount; j++ ) {
             const Vertex& v = vertices[j];
@@ -75,7 +85,7 @@ bool MeshImporter::import( FileSystemQPtr fs, const Io::Path& sourceFileName, co
         }
 
         // Write indices to stream
-        stream->write( &indices[0], sizeof( u16 ) * indexCount );
+        stream->write( &indices[0], indexSize * indexCount );
     }
 
     return true;
@@ -0,0 +1,808 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "CookedScene.h"
+
+#include "Entity/Entity.h"
+#include "Component/Component.h"
+
+#include <Io/streams/ByteBuffer.h>
+#include <Reflection/Serialization/BinaryValue.h>
+
+DC_BEGIN_DREEMCHEST
+
+namespace Ecs
+{
+
+// ---------------------------------------------------------------- SceneCooker ---------------------------------------------------------------- //
+
+// ** SceneCooker::SceneCooker
+SceneCooker::SceneCooker( EcsWPtr ecs, const Bitset& excluded )
+    : Serializer( ecs, excluded )
+{
+}
+
+// ** SceneCooker::cook
+bool SceneCooker::cook( const EntityArray& entities, Io::StreamPtr stream ) const
+{
+    NIMBLE_ABORT_IF( !stream.valid(), "invalid stream" );
+
+    Array<ClassLayout>  layouts;
+    LayoutIndices       layoutIndices;
+    Array<EntityRecord> records;
+    u32                 componentCount = 0;
+
+    records.reserve( entities.size() );
+
+    // First serialize all entities to an intermediate representation and build class layouts
+    for( s32 i = 0, n = static_cast<s32>( entities.size() ); i < n; i++ )
+    {
+        const EntityPtr& entity = entities[i];
+        NIMBLE_BREAK_IF( !entity.valid(), "invalid entity" );
+
+        EntityRecord record;
+        record.id    = entity->id();
+        record.flags = static_cast<u8>( entity->flags() & ~Entity::Removed );
+
+        const Entity::Components& components = entity->components();
+
+        for( Entity::Components::const_iterator j = components.begin(), end = components.end(); j != end; ++j )
+        {
+            // Skip excluded components
+            if( m_excluded.is( j->second->typeIndex() ) )
+            {
+                continue;
+            }
+
+            // Skip component with no type, this means it's an abstract data type
+            const Reflection::Class* cls = j->second->metaObject();
+
+            if( !cls->type() )
+            {
+                continue;
+            }
+
+            // Lookup a class layout or create a new one
+            LayoutIndices::const_iterator k = layoutIndices.find( cls );
+            u16 layoutIndex;
+
+            if( k == layoutIndices.end() )
+            {
+                NIMBLE_ABORT_IF( layouts.size() >= USHRT_MAX, "too much component types" );
+
+                ClassLayout layout;
+                layout.cls = cls;
+
+                for( s32 m = 0, count = cls->memberCount(); m < count; m++ )
+                {
+                    if( const Reflection::Property* property = cls->member( m )->isProperty() )
+                    {
+                        layout.properties.push_back( property );
+                        layout.types.push_back( Reflection::BinaryValue::kTotalTypes );
+                    }
+                }
+
+                layoutIndex = static_cast<u16>( layouts.size() );
+                layoutIndices[cls] = layoutIndex;
+                layouts.push_back( layout );
+            }
+            else
+            {
+                layoutIndex = k->second;
+            }
+
+            // Serialize component properties
+            KeyValue kv;
+            serialize( j->second->metaInstance(), kv );
+
+            // Now collect property values in a class layout order
+            ClassLayout&    layout = layouts[layoutIndex];
+            ComponentRecord component;
+            component.layout = layoutIndex;
+            component.values.reserve( layout.properties.size() );
+
+            for( s32 m = 0, count = static_cast<s32>( layout.properties.size() ); m < count; m++ )
+            {
+                const Variant& value = kv.valueAtKey( layout.properties[m]->name() );
+                Reflection::BinaryValue::Type type = Reflection::BinaryValue::typeOf( value );
+
+                // The first value defines the property type, properties with mixed types are packed
+                if( layout.types[m] == Reflection::BinaryValue::kTotalTypes )
+                {
+                    layout.types[m] = type;
+                }
+                else if( layout.types[m] != type )
+                {
+                    layout.types[m] = Reflection::BinaryValue::kPacked;
+                }
+
+                component.values.push_back( value );
+            }
+
+            record.components.push_back( component );
+            componentCount++;
+        }
+
+        records.push_back( record );
+    }
+
+    // Build the string table
+    StringIndices strings;
+    Array<String> table;
+
+    for( s32 i = 0, n = static_cast<s32>( layouts.size() ); i < n; i++ )
+    {
+        ClassLayout& layout = layouts[i];
+        internString( layout.cls->name(), strings, table );
+
+        for( s32 j = 0, count = static_cast<s32>( layout.properties.size() ); j < count; j++ )
+        {
+            internString( layout.properties[j]->name(), strings, table );
+
+            // A property without any value is written as null
+            if( layout.types[j] == Reflection::BinaryValue::kTotalTypes )
+            {
+                layout.types[j] = Reflection::BinaryValue::kNull;
+            }
+        }
+    }
+
+    for( s32 i = 0, n = static_cast<s32>( records.size() ); i < n; i++ )
+    {
+        const Array<ComponentRecord>& components = records[i].components;
+
+        for( s32 j = 0, count = static_cast<s32>( components.size() ); j < count; j++ )
+        {
+            const ComponentRecord& component = components[j];
+            const ClassLayout&     layout    = layouts[component.layout];
+
+            for( s32 k = 0, values = static_cast<s32>( component.values.size() ); k < values; k++ )
+            {
+                if( layout.types[k] == Reflection::BinaryValue::kString )
+                {
+                    internString( component.values[k].as<String>(), strings, table );
+                }
+            }
+        }
+    }
+
+    // Write the header
+    u32 magic      = CookedScene::Magic;
+    u16 version    = CookedScene::Version;
+    u16 reserved   = 0;
+    u32 stringCount = static_cast<u32>( table.size() );
+    u32 classCount  = static_cast<u32>( layouts.size() );
+    u32 entityCount = static_cast<u32>( records.size() );
+
+    stream->write( &magic, 4 );
+    stream->write( &version, 2 );
+    stream->write( &reserved, 2 );
+    stream->write( &stringCount, 4 );
+    stream->write( &classCount, 4 );
+    stream->write( &entityCount, 4 );
+    stream->write( &componentCount, 4 );
+
+    // Write the string table
+    for( u32 i = 0; i < stringCount; i++ )
+    {
+        u32 length = static_cast<u32>( table[i].length() );
+        stream->write( &length, 4 );
+        stream->write( table[i].c_str(), length );
+    }
+
+    // Write the class table
+    for( u32 i = 0; i < classCount; i++ )
+    {
+        const ClassLayout& layout = layouts[i];
+
+        u32 name          = strings[layout.cls->name()];
+        u16 propertyCount = static_cast<u16>( layout.properties.size() );
+
+        stream->write( &name, 4 );
+        stream->write( &propertyCount, 2 );
+
+        for( u16 j = 0; j < propertyCount; j++ )
+        {
+            u32 property = strings[layout.properties[j]->name()];
+            u8  type     = layout.types[j];
+
+            stream->write( &property, 4 );
+            stream->write( &type, 1 );
+        }
+    }
+
+    // Write the entity table
+    for( u32 i = 0; i < entityCount; i++ )
+    {
+        const EntityRecord& record = records[i];
+        NIMBLE_ABORT_IF( record.components.size() >= USHRT_MAX, "too much components" );
+
+        u16 count = static_cast<u16>( record.components.size() );
+
+        stream->write( record.id.bytes(), Guid::Size );
+        stream->write( &record.flags, 1 );
+        stream->write( &count, 2 );
+    }
+
+    // Write component records
+    for( u32 i = 0; i < entityCount; i++ )
+    {
+        const Array<ComponentRecord>& components = records[i].components;
+
+        for( s32 j = 0, count = static_cast<s32>( components.size() ); j < count; j++ )
+        {
+            const ComponentRecord& component = components[j];
+            const ClassLayout&     layout    = layouts[component.layout];
+
+            // Write the layout index and a record size placeholder
+            u32 size  = 0;
+            stream->write( &component.layout, 2 );
+            s32 start = stream->position();
+            stream->write( &size, 4 );
+
+            // Write packed property values
+            for( s32 k = 0, values = static_cast<s32>( component.values.size() ); k < values; k++ )
+            {
+                writeValue( stream, static_cast<Reflection::BinaryValue::Type>( layout.types[k] ), component.values[k], strings );
+            }
+
+            // Now patch the record size, so unresolved components can be skipped
+            s32 end = stream->position();
+            size = end - start - 4;
+            stream->setPosition( start );
+            stream->write( &size, 4 );
+            stream->setPosition( end );
+        }
+    }
+
+    return true;
+}
+
+// ** SceneCooker::internString
+u32 SceneCooker::internString( const String& value, StringIndices& indices, Array<String>& strings ) const
+{
+    StringIndices::const_iterator i = indices.find( value );
+
+    if( i != indices.end() )
+    {
+        return i->second;
+    }
+
+    u32 index = static_cast<u32>( strings.size() );
+    indices[value] = index;
+    strings.push_back( value );
+
+    return index;
+}
+
+// ** SceneCooker::writeValue
+void SceneCooker::writeValue( Io::StreamPtr stream, Reflection::BinaryValue::Type type, const Variant& value, const StringIndices& strings ) const
+{
+    // Strings are replaced with indices inside a string table
+    if( type == Reflection::BinaryValue::kString )
+    {
+        StringIndices::const_iterator i = strings.find( value.as<String>() );
+        NIMBLE_ABORT_IF( i == strings.end(), "string was not interned" );
+        stream->write( &i->second, 4 );
+        return;
+    }
+
+    Reflection::BinaryValue::write( stream, type, value );
+}
+
+// ------------------------------------------------------------ CookedSceneLoader ------------------------------------------------------------ //
+
+// ** CookedSceneLoader::CookedSceneLoader
+CookedSceneLoader::CookedSceneLoader( EcsWPtr ecs )
+    : Serializer( ecs )
+{
+}
+
+// ** CookedSceneLoader::load
+bool CookedSceneLoader::load( Reflection::AssemblyWPtr assembly, Io::StreamPtr stream, EntityArray& entities )
+{
+    NIMBLE_ABORT_IF( !assembly.valid(), "invalid assembly" );
+    NIMBLE_ABORT_IF( !stream.valid(), "invalid stream" );
+
+    // Read the whole blob at once, so the rest of loading is just a memory walk
+    s32 size = stream->length() - stream->position();
+
+    if( size < 24 )
+    {
+        LogError( "cookedScene", "%s", "unexpected end of a cooked scene header\n" );
+        return false;
+    }
+
+    Array<u8> blob;
+    blob.resize( size );
+
+    if( stream->read( &blob[0], size ) != size )
+    {
+        LogError( "cookedScene", "%s", "failed to read a cooked scene\n" );
+        return false;
+    }
+
+    Reader reader( &blob[0], size );
+
+    // Read and validate the header
+    u32 magic   = reader.read<u32>();
+    u16 version = reader.read<u16>();
+    reader.read<u16>();
+
+    if( magic != CookedScene::Magic )
+    {
+        LogError( "cookedScene", "%s", "invalid cooked scene magic\n" );
+        return false;
+    }
+
+    if( version != CookedScene::Version )
+    {
+        LogError( "cookedScene", "unsupported cooked scene version %d, expected %d\n", version, CookedScene::Version );
+        return false;
+    }
+
+    u32 stringCount    = reader.read<u32>();
+    u32 classCount     = reader.read<u32>();
+    u32 entityCount    = reader.read<u32>();
+    u32 componentCount = reader.read<u32>();
+
+    // Read the string table
+    Array<String> strings;
+
+    if( !readStrings( reader, stringCount, strings ) )
+    {
+        LogError( "cookedScene", "%s", "corrupted string table\n" );
+        return false;
+    }
+
+    // Read the class table and resolve classes, properties and type converters once
+    Array<ClassLayout> layouts;
+
+    if( !readLayouts( reader, assembly, classCount, strings, layouts ) )
+    {
+        LogError( "cookedScene", "%s", "corrupted class table\n" );
+        return false;
+    }
+
+    // Each entity record takes an identifier, flags and a component count
+    if( entityCount > static_cast<u32>( size - reader.position() ) / (Guid::Size + 3) )
+    {
+        LogError( "cookedScene", "%s", "corrupted entity table\n" );
+        return false;
+    }
+
+    // Read the entity table and construct all entities
+    Array<u16> componentCounts;
+    componentCounts.resize( entityCount );
+
+    s32 first = static_cast<s32>( entities.size() );
+    entities.reserve( first + entityCount );
+    m_loaded.clear();
+
+    for( u32 i = 0; i < entityCount; i++ )
+    {
+        Guid id( reader.current() );
+        reader.skip( Guid::Size );
+
+        u8 flags           = reader.read<u8>();
+        componentCounts[i] = reader.read<u16>();
+
+        EntityPtr entity = m_ecs->createEntity( id );
+        entity->setFlags( flags );
+
+        m_loaded[id] = entity;
+        entities.push_back( entity );
+    }
+
+    // Now read component records, all entities already exist so references are resolved here
+    for( u32 i = 0; i < entityCount && !reader.hasFailed(); i++ )
+    {
+        const EntityPtr& entity = entities[first + i];
+
+        for( u16 j = 0; j < componentCounts[i]; j++ )
+        {
+            u16 index      = reader.read<u16>();
+            u32 recordSize = reader.read<u32>();
+
+            if( index >= layouts.size() || !reader.has( recordSize ) )
+            {
+                reader.fail();
+                break;
+            }
+
+            // A record is read by a separate reader, so a corrupted record never touches the next one
+            Reader       record( reader.current(), recordSize );
+            ClassLayout& layout = layouts[index];
+
+            if( layout.cls )
+            {
+                // A component from a corrupted record is released here
+                ComponentPtr component = readComponent( record, assembly, layout, strings );
+
+                if( record.hasFailed() )
+                {
+                    reader.fail();
+                    break;
+                }
+
+                if( component.valid() )
+                {
+                    entity->attachComponent( component.get() );
+                }
+            }
+
+            // Always continue from the next record, this also skips unresolved components
+            reader.skip( recordSize );
+        }
+    }
+
+    m_loaded.clear();
+
+    // Drop all entities constructed from a corrupted scene, they are not added to an Ecs yet
+    if( reader.hasFailed() )
+    {
+        LogError( "cookedScene", "%s", "corrupted component records\n" );
+        entities.resize( first );
+        return false;
+    }
+
+    LogVerbose( "cookedScene", "%d entities with %d components loaded\n", entityCount, componentCount );
+
+    return true;
+}
+
+// ** CookedSceneLoader::readStrings
+bool CookedSceneLoader::readStrings( Reader& reader, u32 count, Array<String>& strings ) const
+{
+    // Each string takes at least a length prefix, so a string count can't be larger than the rest of a blob
+    if( count > static_cast<u32>( reader.size() - reader.position() ) / 4 )
+    {
+        return false;
+    }
+
+    strings.resize( count );
+
+    for( u32 i = 0; i < count; i++ )
+    {
+        u32 length = reader.read<u32>();
+
+        if( !reader.has( length ) )
+        {
+            return false;
+        }
+
+        strings[i].assign( reinterpret_cast<CString>( reader.current() ), length );
+        reader.skip( length );
+    }
+
+    return !reader.hasFailed();
+}
+
+// ** CookedSceneLoader::readLayouts
+bool CookedSceneLoader::readLayouts( Reader& reader, Reflection::AssemblyWPtr assembly, u32 count, const Array<String>& strings, Array<ClassLayout>& layouts ) const
+{
+    // Each class takes a name index and a property count
+    if( count > static_cast<u32>( reader.size() - reader.position() ) / 6 )
+    {
+        return false;
+    }
+
+    layouts.resize( count );
+
+    for( u32 i = 0; i < count; i++ )
+    {
+        ClassLayout& layout = layouts[i];
+
+        u32 nameIndex     = reader.read<u32>();
+        u16 propertyCount = reader.read<u16>();
+
+        if( reader.hasFailed() || nameIndex >= strings.size() )
+        {
+            return false;
+        }
+
+        const String& name = strings[nameIndex];
+        layout.cls = assembly->findClass( name );
+
+        if( !layout.cls )
+        {
+            LogError( "cookedScene", "unresolved class '%s'\n", name.c_str() );
+        }
+
+        for( u16 j = 0; j < propertyCount; j++ )
+        {
+            u32 propertyIndex = reader.read<u32>();
+            u8  typeIndex     = reader.read<u8>();
+
+            if( reader.hasFailed() || propertyIndex >= strings.size() || typeIndex >= Reflection::BinaryValue::kTotalTypes )
+            {
+                return false;
+            }
+
+            const String&                 propertyName = strings[propertyIndex];
+            Reflection::BinaryValue::Type type         = static_cast<Reflection::BinaryValue::Type>( typeIndex );
+            const Reflection::Property*   property     = NULL;
+
+            if( layout.cls )
+            {
+                const Reflection::Member* member = layout.cls->findMember( propertyName.c_str() );
+                property = member ? member->isProperty() : NULL;
+
+                if( !property )
+                {
+                    LogDebug( "cookedScene", "%s.%s does not exist anymore and will be skipped\n", name.c_str(), propertyName.c_str() );
+                }
+            }
+
+            const Type*   valueType = Reflection::BinaryValue::type( type );
+            TypeConverter converter = property && valueType ? findTypeConverter( valueType, property->type() ) : TypeConverter();
+
+            layout.properties.push_back( property );
+            layout.types.push_back( type );
+            layout.converters.push_back( converter );
+            layout.collections.push_back( -1 );
+            layout.direct.push_back( property && !converter && valueType == property->type() && Reflection::BinaryValue::size( type ) >= 0 ? 1 : 0 );
+        }
+    }
+
+    return true;
+}
+
+// ** CookedSceneLoader::readComponent
+ComponentBase* CookedSceneLoader::readComponent( Reader& reader, Reflection::AssemblyWPtr assembly, ClassLayout& layout, const Array<String>& strings ) const
+{
+    // Construct component instance
+    Reflection::Instance instance = assembly->createInstance( layout.cls );
+
+    if( !instance )
+    {
+        return NULL;
+    }
+
+    // Down-cast instance to an abstract component
+    ComponentBase* component = instance.upCast<ComponentBase>();
+
+    if( !component )
+    {
+        LogError( "cookedScene", "'%s' is not a subclass of component\n", layout.cls->name() );
+        return NULL;
+    }
+
+    // Read packed properties in a class layout order
+    for( s32 i = 0, n = static_cast<s32>( layout.properties.size() ); i < n; i++ )
+    {
+        Reflection::BinaryValue::Type type     = static_cast<Reflection::BinaryValue::Type>( layout.types[i] );
+        const Reflection::Property*   property = layout.properties[i];
+
+        // Fixed-size values of a matching type are written right from a blob memory
+        if( layout.direct[i] )
+        {
+            s32 size = Reflection::BinaryValue::size( type );
+
+            if( !reader.has( size ) )
+            {
+                reader.fail();
+                break;
+            }
+
+            Reflection::BinaryValue::decode( type, reader.current(), *property, instance );
+            reader.skip( size );
+            continue;
+        }
+
+        Variant value = readValue( reader, type, strings );
+
+        if( reader.hasFailed() )
+        {
+            break;
+        }
+
+        if( !property || !value.isValid() )
+        {
+            continue;
+        }
+
+        // Collection properties are detected with a first instance and then cached
+        if( layout.collections[i] != 0 )
+        {
+            Reflection::IteratorUPtr iterator = property->iterator( instance );
+            layout.collections[i] = iterator.get() ? 1 : 0;
+
+            if( Reflection::ListIterator* list = iterator.get() ? iterator->isList() : NULL )
+            {
+                deserializeList( *layout.cls, *property, instance, value, *list );
+                continue;
+            }
+            else if( Reflection::MapIterator* map = iterator.get() ? iterator->isMap() : NULL )
+            {
+                deserializeMap( *layout.cls, *property, instance, value, *map );
+                continue;
+            }
+        }
+
+        // Packed values may have a different type for each instance, so converters are resolved here
+        TypeConverter converter = type == Reflection::BinaryValue::kPacked ? findTypeConverter( value.type(), property->type() ) : layout.converters[i];
+
+        if( converter )
+        {
+            property->deserialize( instance, converter( *layout.cls, *property, value ) );
+        }
+        else
+        {
+            property->deserialize( instance, value );
+        }
+    }
+
+    return component;
+}
+
+// ** CookedSceneLoader::readValue
+Variant CookedSceneLoader::readValue( Reader& reader, Reflection::BinaryValue::Type type, const Array<String>& strings ) const
+{
+    switch( type )
+    {
+    case Reflection::BinaryValue::kNull:
+                                break;
+
+    case Reflection::BinaryValue::kString:
+                                {
+                                    u32 index = reader.read<u32>();
+
+                                    if( index >= strings.size() )
+                                    {
+                                        reader.fail();
+                                        break;
+                                    }
+
+                                    return Variant::fromValue<String>( strings[index] );
+                                }
+
+    case Reflection::BinaryValue::kPacked:
+                                {
+                                    u32 size = reader.read<u32>();
+
+                                    if( !reader.has( size ) )
+                                    {
+                                        reader.fail();
+                                        break;
+                                    }
+
+                                    Variant value;
+                                    Io::ByteBufferPtr buffer = Io::ByteBuffer::createFromData( reader.current(), size );
+                                    Io::BinaryVariantStream( buffer ).read( value );
+                                    reader.skip( size );
+
+                                    return value;
+                                }
+
+    default:                    {
+                                    // Fixed-size values are decoded right from a blob memory
+                                    s32 size = Reflection::BinaryValue::size( type );
+
+                                    if( size < 0 || !reader.has( size ) )
+                                    {
+                                        reader.fail();
+                                        break;
+                                    }
+
+                                    Variant value = Reflection::BinaryValue::decode( type, reader.current() );
+                                    reader.skip( size );
+
+                                    return value;
+                                }
+    }
+
+    return Variant();
+}
+
+// ** CookedSceneLoader::resolveEntity
+EntityWPtr CookedSceneLoader::resolveEntity( const Guid& id ) const
+{
+    // Entities from a scene being loaded are not added to an Ecs yet
+    LoadedEntities::const_iterator i = m_loaded.find( id );
+
+    if( i != m_loaded.end() )
+    {
+        return i->second;
+    }
+
+    return Serializer::resolveEntity( id );
+}
+
+// ------------------------------------------------------------ CookedSceneLoader::Reader ------------------------------------------------------------ //
+
+// ** CookedSceneLoader::Reader::Reader
+CookedSceneLoader::Reader::Reader( const u8* data, s32 size )
+    : m_data( data )
+    , m_size( size )
+    , m_position( 0 )
+    , m_hasFailed( false )
+{
+}
+
+// ** CookedSceneLoader::Reader::has
+bool CookedSceneLoader::Reader::has( u32 size ) const
+{
+    return !m_hasFailed && size <= static_cast<u32>( m_size - m_position );
+}
+
+// ** CookedSceneLoader::Reader::hasFailed
+bool CookedSceneLoader::Reader::hasFailed( void ) const
+{
+    return m_hasFailed;
+}
+
+// ** CookedSceneLoader::Reader::fail
+void CookedSceneLoader::Reader::fail( void )
+{
+    m_hasFailed = true;
+}
+
+// ** CookedSceneLoader::Reader::size
+s32 CookedSceneLoader::Reader::size( void ) const
+{
+    return m_size;
+}
+
+// ** CookedSceneLoader::Reader::current
+const u8* CookedSceneLoader::Reader::current( void ) const
+{
+    return m_data + m_position;
+}
+
+// ** CookedSceneLoader::Reader::skip
+void CookedSceneLoader::Reader::skip( u32 size )
+{
+    if( !has( size ) )
+    {
+        m_hasFailed = true;
+        return;
+    }
+
+    m_position += size;
+}
+
+// ** CookedSceneLoader::Reader::position
+s32 CookedSceneLoader::Reader::position( void ) const
+{
+    return m_position;
+}
+
+// ** CookedSceneLoader::Reader::setPosition
+void CookedSceneLoader::Reader::setPosition( s32 value )
+{
+    if( value < 0 || value > m_size )
+    {
+        m_hasFailed = true;
+        return;
+    }
+
+    m_position = value;
+}
+
+} // namespace Ecs
+
+DC_END_DREEMCHEST
@@ -0,0 +1,228 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Ecs_CookedScene_H__
+#define __DC_Ecs_CookedScene_H__
+
+#include "EntitySerializer.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Ecs
+{
+    //! Describes a binary layout of a cooked scene blob.
+    /*!
+    A cooked scene is produced offline from a set of entities and consists of:
+        - a header with a magic number, format version and table sizes;
+        - a string table that holds all class names, property names and string values;
+        - a class table with a packed property layout for each component type;
+        - an entity table with identifiers, flags and component counts;
+        - component records, each one holds property values packed in a class layout order.
+    Property values are written without names and type tags by a Reflection::BinaryValue, a value type is
+    stored once per class layout and strings are replaced with indices inside a string table.
+    */
+    struct CookedScene
+    {
+        //! A four-character code stored at the beginning of each cooked scene.
+        enum { Magic = 0x4e454353 };
+
+        //! A current version of a cooked scene format.
+        enum { Version = 1 };
+    };
+
+    //! Compiles a set of entities to a binary cooked scene blob.
+    class SceneCooker : public Serializer
+    {
+    public:
+
+                                            //! Constructs SceneCooker instance.
+                                            SceneCooker( EcsWPtr ecs, const Bitset& excluded = Bitset() );
+
+        //! Writes entities to an output stream, returns false if cooking failed.
+        bool                                cook( const EntityArray& entities, Io::StreamPtr stream ) const;
+
+    private:
+
+        //! A packed property layout of a single component class.
+        struct ClassLayout
+        {
+            const Reflection::Class*        cls;        //!< A component meta-class.
+            Array<const Reflection::Property*> properties; //!< Serialized class properties in a packed order.
+            Array<u8>                       types;      //!< A value type of each property.
+        };
+
+        //! Serialized component values before they are packed.
+        struct ComponentRecord
+        {
+            u16                             layout;     //!< An index of a class layout.
+            Array<Variant>                  values;     //!< Property values in a class layout order.
+        };
+
+        //! Serialized entity before it's packed.
+        struct EntityRecord
+        {
+            EntityId                        id;         //!< An entity identifier.
+            u8                              flags;      //!< Entity flags.
+            Array<ComponentRecord>          components; //!< Serialized entity components.
+        };
+
+        //! Container type to map from a string to it's index inside a string table.
+        typedef Map<String, u32>            StringIndices;
+
+        //! Container type to map from a meta-class to a layout index.
+        typedef Map<const Reflection::Class*, u16> LayoutIndices;
+
+        //! Returns an index of a string inside a string table, adds a new string if it does not exist.
+        u32                                 internString( const String& value, StringIndices& indices, Array<String>& strings ) const;
+
+        //! Writes a single packed value to a stream.
+        void                                writeValue( Io::StreamPtr stream, Reflection::BinaryValue::Type type, const Variant& value, const StringIndices& strings ) const;
+    };
+
+    //! Loads entities from a binary cooked scene blob.
+    class CookedSceneLoader : public Serializer
+    {
+    public:
+
+                                            //! Constructs CookedSceneLoader instance.
+                                            CookedSceneLoader( EcsWPtr ecs );
+
+        //! Reads all entities from a cooked scene and appends them to an output array.
+        /*!
+        Entities are created in bulk and are not added to an Ecs instance, so the caller can
+        add them at once with Ecs::addEntities.
+        */
+        bool                                load( Reflection::AssemblyWPtr assembly, Io::StreamPtr stream, EntityArray& entities );
+
+    protected:
+
+        //! Searches for an entity inside a scene being loaded first and then inside an Ecs instance.
+        virtual EntityWPtr                  resolveEntity( const Guid& id ) const NIMBLE_OVERRIDE;
+
+    private:
+
+        //! A forward only reader of a cooked scene memory blob.
+        /*!
+        A cooked scene may be corrupted, so reading past the end does not abort. Instead a reader
+        is marked as failed and all following reads return zero.
+        */
+        class Reader
+        {
+        public:
+
+                                            //! Constructs Reader instance.
+                                            Reader( const u8* data, s32 size );
+
+            //! Returns true if the specified number of bytes can be read.
+            bool                            has( u32 size ) const;
+
+            //! Returns true if a reader has failed to read a value.
+            bool                            hasFailed( void ) const;
+
+            //! Marks a reader as failed, used when a read value is out of range.
+            void                            fail( void );
+
+            //! Returns the current read pointer.
+            const u8*                       current( void ) const;
+
+            //! Skips the specified number of bytes.
+            void                            skip( u32 size );
+
+            //! Returns the current read position.
+            s32                             position( void ) const;
+
+            //! Returns a total blob size.
+            s32                             size( void ) const;
+
+            //! Sets the current read position.
+            void                            setPosition( s32 value );
+
+            //! Reads a POD value.
+            template<typename TValue>
+            TValue                          read( void );
+
+        private:
+
+            const u8*                       m_data;     //!< A blob data pointer.
+            s32                             m_size;     //!< A total blob size.
+            s32                             m_position; //!< A current read position.
+            bool                            m_hasFailed;    //!< Indicates that a reader has failed.
+        };
+
+        //! A runtime class layout resolved once per cooked scene.
+        struct ClassLayout
+        {
+            const Reflection::Class*        cls;            //!< A resolved component meta-class or NULL if it's not registered.
+            Array<const Reflection::Property*> properties;  //!< Resolved properties or NULL if a property does not exist anymore.
+            Array<u8>                       types;          //!< Packed value types.
+            Array<TypeConverter>            converters;     //!< Type converters resolved for each property.
+            Array<s8>                       collections;    //!< Set to 1 for collection properties, -1 if unknown yet.
+            Array<u8>                       direct;         //!< Set to 1 for fixed-size values that match a property type and are written without a Variant.
+        };
+
+        //! Container type to map entity identifiers to loaded entities.
+        typedef Map<Guid, EntityWPtr>       LoadedEntities;
+
+        //! Reads a string table, returns false if it's corrupted.
+        bool                                readStrings( Reader& reader, u32 count, Array<String>& strings ) const;
+
+        //! Reads a class table and resolves classes, returns false if it's corrupted.
+        bool                                readLayouts( Reader& reader, Reflection::AssemblyWPtr assembly, u32 count, const Array<String>& strings, Array<ClassLayout>& layouts ) const;
+
+        //! Reads a single packed value.
+        Variant                             readValue( Reader& reader, Reflection::BinaryValue::Type type, const Array<String>& strings ) const;
+
+        //! Reads a single component record and returns a constructed component, a reader is marked as failed if a record is corrupted.
+        ComponentBase*                      readComponent( Reader& reader, Reflection::AssemblyWPtr assembly, ClassLayout& layout, const Array<String>& strings ) const;
+
+    private:
+
+        LoadedEntities                      m_loaded;   //!< Entities constructed by a current load call.
+    };
+
+    // ** CookedSceneLoader::Reader::read
+    template<typename TValue>
+    TValue CookedSceneLoader::Reader::read( void )
+    {
+        TValue value;
+
+        if( m_hasFailed || !has( sizeof( TValue ) ) )
+        {
+            m_hasFailed = true;
+            memset( &value, 0, sizeof( TValue ) );
+            return value;
+        }
+
+        memcpy( &value, m_data + m_position, sizeof( TValue ) );
+        m_position += sizeof( TValue );
+        return value;
+    }
+
+} // namespace Ecs
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Ecs_CookedScene_H__    */
@@ -42,7 +42,7 @@ namespace Ecs {
 // -------------------------------------------------------------- Ecs -------------------------------------------------------------- //
 
 // ** Ecs::Ecs
-Ecs::Ecs( const EntityIdGeneratorPtr& entityIdGenerator ) : m_entityId( entityIdGenerator )
+Ecs::Ecs( const EntityIdGeneratorPtr& entityIdGenerator ) : m_entityId( entityIdGenerator ), m_destructionBudget( 0 )
 {
 }
 
@@ -197,9 +197,8 @@ void Ecs::removeEntity( const EntityId& id )
         return;
     }
 
+    // Removed entities leave indices in bulk inside cleanupRemovedEntities
     i->second->markAsRemoved();
-
-    m_changed.insert( i->second );
     m_removed.insert( i->second );
 }
 
@@ -290,13 +289,65 @@ void Ecs::rebuildChangedEntities( void )
 void Ecs::cleanupRemovedEntities( void )
 {
     while( m_removed.size() ) {
-        EntitySet removed = m_removed;
+        EntityArray removed = toEntityArray( m_removed );
         m_removed.clear();
 
-        for( EntitySet::iterator i = removed.begin(), end = removed.end(); i != end; ++i ) {
-            m_entities.erase( (*i)->id() );
+        // Remove entities from indices, so systems do not process them anymore
+        for( Indices::iterator i = m_indices.begin(), end = m_indices.end(); i != end; ++i ) {
+            i->second->removeEntities( removed );
+        }
+
+        // Unregister entities and keep them alive until they are destroyed
+        for( s32 i = 0, n = static_cast<s32>( removed.size() ); i < n; i++ ) {
+            m_entities.erase( removed[i]->id() );
+            m_destructionQueue.push_back( removed[i] );
         }
     }
+
+    // Without a time budget entities are destroyed right away
+    if( m_destructionBudget == 0 ) {
+        destroyRemovedEntities( 0 );
+    }
+}
+
+// ** Ecs::destroyRemovedEntities
+s32 Ecs::destroyRemovedEntities( u32 budget )
+{
+    // Entities are released in small batches, so a time is not queried for each of them
+    enum { BatchSize = 64 };
+
+    u64 startTime = Platform::currentTime();
+    s32 count     = 0;
+
+    while( !m_destructionQueue.empty() ) {
+        if( budget && count && (count % BatchSize) == 0 && Platform::currentTime() - startTime >= budget ) {
+            break;
+        }
+
+        // Releasing the last reference destroys an entity and all its components
+        m_destructionQueue.pop_front();
+        count++;
+    }
+
+    return count;
+}
+
+// ** Ecs::destructionQueueSize
+s32 Ecs::destructionQueueSize( void ) const
+{
+    return static_cast<s32>( m_destructionQueue.size() );
+}
+
+// ** Ecs::destructionBudget
+u32 Ecs::destructionBudget( void ) const
+{
+    return m_destructionBudget;
+}
+
+// ** Ecs::setDestructionBudget
+void Ecs::setDestructionBudget( u32 value )
+{
+    m_destructionBudget = value;
 }
 
 // ** Ecs::update
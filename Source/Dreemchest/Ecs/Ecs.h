@@ -149,9 +149,28 @@ namespace Ecs {
         //! Rebuild indices for changed entitites.
         void            rebuildChangedEntities( void );
 
-        //! Cleans up removed entities.
+        //! Removes queued entities from indices and moves them to a destruction queue.
         void            cleanupRemovedEntities( void );
 
+        //! Releases entities from a destruction queue until a time budget in milliseconds is exhausted, returns the number of released entities.
+        /*!
+        \param budget A time budget in milliseconds, zero releases all queued entities.
+        */
+        s32             destroyRemovedEntities( u32 budget );
+
+        //! Returns a total number of removed entities that are waiting for destruction.
+        s32             destructionQueueSize( void ) const;
+
+        //! Returns a time budget in milliseconds spent each frame on destruction of removed entities.
+        u32             destructionBudget( void ) const;
+
+        //! Sets a time budget in milliseconds spent each frame on destruction of removed entities, zero destroys them at once.
+        /*!
+        With a non-zero budget removed entities are kept in a destruction queue, an owner of an ECS
+        should call destroyRemovedEntities once per frame to release them.
+        */
+        void            setDestructionBudget( u32 value );
+
         //! Creates a new system group.
         SystemGroupPtr    createGroup( const String& name, u32 mask );
 
@@ -224,6 +243,8 @@ namespace Ecs {
 
         EntitySet                            m_changed;            //!< Entities that was changed.
         EntitySet                            m_removed;            //!< Entities that will be removed.
+        EntityList                          m_destructionQueue; //!< Removed entities that are waiting for destruction.
+        u32                                 m_destructionBudget;    //!< A time budget in milliseconds spent each frame on entity destruction.
         IndexSet                            m_changedIndices;   //!< Indices that were changed.
         DataCacheList                       m_dataCaches;       //!< List of data caches that should be populated.
     };
@@ -244,6 +265,7 @@ DC_END_DREEMCHEST
 
 #ifndef DC_BUILD_LIBRARY
     #include "EntitySerializer.h"
+    #include "CookedScene.h"
     #include "Component/Component.h"
     #include "Entity/Entity.h"
     #include "Entity/Aspect.h"
@@ -78,6 +78,33 @@ void Index::notifyEntityChanged( const EntityPtr& entity )
     }
 }
 
+// ** Index::removeEntities
+void Index::removeEntities( const EntityArray& entities )
+{
+    if( m_entities.empty() ) {
+        return;
+    }
+
+    // A batch is larger than an index, so walk index entities and pick removed ones
+    if( m_entities.size() < entities.size() ) {
+        for( EntitySet::iterator i = m_entities.begin(); i != m_entities.end(); ) {
+            EntityPtr entity = *(i++);
+
+            if( entity->flags() & Entity::Removed ) {
+                processEntityRemoved( entity );
+            }
+        }
+        return;
+    }
+
+    // Otherwise lookup each removed entity
+    for( s32 i = 0, n = static_cast<s32>( entities.size() ); i < n; i++ ) {
+        if( m_entities.count( entities[i] ) ) {
+            processEntityRemoved( entities[i] );
+        }
+    }
+}
+
 // ** Index::processEntityAdded
 void Index::processEntityAdded( const EntityPtr& entity )
 {
@@ -77,6 +77,9 @@ namespace Ecs {
         //! Processes the entity change
         void                    notifyEntityChanged( const EntityPtr& entity );
 
+        //! Removes a batch of removed entities with a single pass over a smaller of two sets.
+        void                    removeEntities( const EntityArray& entities );
+
     protected:
 
         EcsWPtr                    m_ecs;                //!< Parent ECS instance.
@@ -87,7 +87,7 @@ namespace Ecs
         //! Converts an entity reference to a Guid variant value.
         Variant                             convertEntityPtrToGuid( const Reflection::Class& cls, const Reflection::Property& property, const Variant& value ) const;
 
-    private:
+    protected:
 
         //! Container type to store component conversions.
         typedef HashMap<String32, ComponentConverter> ComponentConverters;
@@ -62,7 +62,7 @@ const Address& ConnectionTCP::address( void ) const
 }
 
 // ** ConnectionTCP::sendData
-s32 ConnectionTCP::sendData( Io::ByteBufferWPtr data )
+s32 ConnectionTCP::sendData( Io::ByteBufferWPtr data, PacketDelivery delivery )
 {
     NIMBLE_BREAK_IF( !m_socket.valid(), "invalid socket" );
     s32 result = m_socket->send( data->buffer(), data->length() );
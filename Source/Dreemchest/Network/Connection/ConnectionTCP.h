@@ -38,6 +38,9 @@ namespace Network {
     class ConnectionTCP : public Connection_ {
     public:
 
+                            //! Constructs ConnectionTCP instance.
+                            ConnectionTCP( TCPSocketPtr socket );
+
                             //! Cleans up the socket event subscribtions.
         virtual             ~ConnectionTCP( void );
 
@@ -45,18 +48,15 @@ namespace Network {
         TCPSocketWPtr       socket( void ) const;
 
         //! Returns a remote address of a connection.
-        const Address&        address( void ) const;
+        virtual const Address& address( void ) const NIMBLE_OVERRIDE;
 
         //! Closes this TCP connection.
         virtual void        close( void ) NIMBLE_OVERRIDE;
 
     protected:
 
-                            //! Constructs ConnectionTCP instance.
-                            ConnectionTCP( TCPSocketPtr socket );
-
-        //! Sends a byte buffer over TCP connection.
-        virtual s32         sendData( Io::ByteBufferWPtr stream ) NIMBLE_OVERRIDE;
+        //! Sends a byte buffer over TCP connection, all packets are reliable and ordered.
+        virtual s32         sendData( Io::ByteBufferWPtr stream, PacketDelivery delivery ) NIMBLE_OVERRIDE;
 
         //! Splits the received data into packets and emits notifications.
         void                handleSocketData( const TCPSocket::Data& e );
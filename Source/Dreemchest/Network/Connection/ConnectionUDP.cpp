@@ -0,0 +1,704 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "ConnectionUDP.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Network {
+
+// ** ConnectionUDP::ConnectionUDP
+ConnectionUDP::ConnectionUDP( UDPSocketWPtr socket, const Address& address, u16 port )
+    : m_socket( socket )
+    , m_address( address )
+    , m_port( port )
+    , m_isClosed( false )
+    , m_isHandshaking( false )
+    , m_lastHandshakeTime( 0 )
+    , m_localSequence( 0 )
+    , m_remoteSequence( 0 )
+    , m_receivedBits( 0 )
+    , m_hasReceived( false )
+    , m_ackPending( false )
+    , m_lastSendTime( 0 )
+    , m_nextReliable( 0 )
+    , m_lastUnreliable( 0 )
+    , m_hasUnreliable( false )
+    , m_incomingBytes( 0 )
+    , m_smoothedRtt( 0.0f )
+    , m_sendRate( MinSendRate * 4 )
+    , m_tokens( static_cast<f32>( MaxDatagramSize ) )
+    , m_acked( 0 )
+    , m_lost( 0 )
+    , m_packetLoss( 0.0f )
+    , m_lastRateUpdate( 0 )
+    , m_sendFailures( 0 )
+{
+    NIMBLE_ABORT_IF( !m_socket.valid(), "invalid socket" );
+
+    // Create the temporary read buffer for received packet
+    m_packet = Io::ByteBuffer::create();
+
+    m_nextMessageId[ReliableOrdered]     = 0;
+    m_nextMessageId[UnreliableSequenced] = 0;
+}
+
+// ** ConnectionUDP::address
+const Address& ConnectionUDP::address( void ) const
+{
+    return m_address;
+}
+
+// ** ConnectionUDP::port
+u16 ConnectionUDP::port( void ) const
+{
+    return m_port;
+}
+
+// ** ConnectionUDP::sendRate
+s32 ConnectionUDP::sendRate( void ) const
+{
+    return m_sendRate;
+}
+
+// ** ConnectionUDP::packetLoss
+f32 ConnectionUDP::packetLoss( void ) const
+{
+    return m_packetLoss;
+}
+
+// ** ConnectionUDP::sendFailures
+s32 ConnectionUDP::sendFailures( void ) const
+{
+    return m_sendFailures;
+}
+
+// ** ConnectionUDP::isClosed
+bool ConnectionUDP::isClosed( void ) const
+{
+    return m_isClosed;
+}
+
+// ** ConnectionUDP::isHandshake
+bool ConnectionUDP::isHandshake( Io::ByteBufferWPtr data )
+{
+    if( data->length() != HandshakeSize ) {
+        return false;
+    }
+
+    u32 magic, version;
+    memcpy( &magic, data->buffer(), sizeof( magic ) );
+    memcpy( &version, data->buffer() + sizeof( magic ), sizeof( version ) );
+
+    return magic == HandshakeMagic && version == ProtocolVersion;
+}
+
+// ** ConnectionUDP::startHandshake
+void ConnectionUDP::startHandshake( void )
+{
+    m_isHandshaking = true;
+    sendHandshake();
+}
+
+// ** ConnectionUDP::isNewer
+bool ConnectionUDP::isNewer( u16 a, u16 b )
+{
+    return a != b && static_cast<u16>( a - b ) < 0x8000;
+}
+
+// ** ConnectionUDP::close
+void ConnectionUDP::close( void )
+{
+    if( m_isClosed ) {
+        return;
+    }
+
+    m_isClosed = true;
+
+    // Drop all queued messages
+    m_outgoing.clear();
+    m_sent.clear();
+
+    // Notify all subscribers that connection is now closed
+    notify<Closed>( this );
+}
+
+// ** ConnectionUDP::sendData
+s32 ConnectionUDP::sendData( Io::ByteBufferWPtr data, PacketDelivery delivery )
+{
+    if( m_isClosed ) {
+        return 0;
+    }
+
+    // Calculate the number of fragments this message is split into
+    s32 size  = data->length();
+    s32 count = std::max( ( size + MaxFragmentSize - 1 ) / MaxFragmentSize, 1 );
+    NIMBLE_ABORT_IF( count > MaxFragments, "message is too large to be sent over UDP" );
+
+    // Queue the message
+    OutgoingMessage message;
+    message.id      = m_nextMessageId[delivery]++;
+    message.channel = delivery;
+    message.time    = time();
+    message.data    = Array<u8>( data->buffer(), data->buffer() + size );
+    message.sentTime.resize( count, -1 );
+    message.acked.resize( count, false );
+    message.pending = count;
+    m_outgoing.push_back( message );
+
+    return size;
+}
+
+// ** ConnectionUDP::processDatagram
+void ConnectionUDP::processDatagram( Io::ByteBufferWPtr data )
+{
+    if( m_isClosed ) {
+        return;
+    }
+
+    // A handshake resent by a remote peer before it received anything from this side
+    if( isHandshake( data ) ) {
+        resetTimeout();
+        return;
+    }
+
+    if( data->length() < DatagramHeaderSize ) {
+        LogWarning( "connection", "%d bytes datagram received from %s:%d is too small\n", data->length(), m_address.toString(), m_port );
+        return;
+    }
+
+    // A remote peer has accepted this connection
+    m_isHandshaking = false;
+
+    // Anything received from a remote peer keeps the connection alive
+    resetTimeout();
+    trackReceivedAmount( data->length() );
+
+    // Read the datagram header
+    u16 sequence, ack;
+    u32 ackBits;
+    u8  count;
+
+    data->setPosition( 0 );
+    data->read( &sequence, sizeof( sequence ) );
+    data->read( &ack, sizeof( ack ) );
+    data->read( &ackBits, sizeof( ackBits ) );
+    data->read( &count, sizeof( count ) );
+
+    // Acknowledge datagrams received by a remote peer
+    if( count & AckFlag ) {
+        processAcks( ack, ackBits );
+    }
+
+    // This datagram was already received
+    if( !trackReceived( sequence ) ) {
+        return;
+    }
+
+    count &= MaxMessages;
+
+    // Only datagrams with messages are acknowledged immediately, ack-only datagrams are acknowledged by a keep-alive
+    if( count ) {
+        m_ackPending = true;
+    }
+
+    // Read all messages
+    for( u8 i = 0; i < count && !m_isClosed; i++ ) {
+        if( data->bytesAvailable() < MessageHeaderSize ) {
+            LogWarning( "connection", "malformed datagram received from %s:%d\n", m_address.toString(), m_port );
+            return;
+        }
+
+        u8  channel, index, fragments;
+        u16 id, size;
+
+        data->read( &channel, sizeof( channel ) );
+        data->read( &id, sizeof( id ) );
+        data->read( &index, sizeof( index ) );
+        data->read( &fragments, sizeof( fragments ) );
+        data->read( &size, sizeof( size ) );
+
+        if( channel > UnreliableSequenced || index >= fragments || data->bytesAvailable() < size ) {
+            LogWarning( "connection", "malformed message received from %s:%d\n", m_address.toString(), m_port );
+            return;
+        }
+
+        receiveFragment( static_cast<PacketDelivery>( channel ), id, index, fragments, data->current(), size );
+        data->setPosition( size, Io::SeekCur );
+    }
+}
+
+// ** ConnectionUDP::processAcks
+void ConnectionUDP::processAcks( u16 ack, u32 ackBits )
+{
+    for( SentDatagrams::iterator i = m_sent.begin(); i != m_sent.end(); ) {
+        // Check whether this datagram is acknowledged by an ack sequence number or ack bits
+        u16  distance = static_cast<u16>( ack - i->sequence );
+        bool acked    = distance == 0 || ( distance <= 32 && ( ackBits & ( 1u << ( distance - 1 ) ) ) );
+
+        if( !acked ) {
+            ++i;
+            continue;
+        }
+
+        // Update the smoothed round trip time
+        f32 sample = static_cast<f32>( time() - i->time );
+        m_smoothedRtt = m_smoothedRtt > 0.0f ? m_smoothedRtt + ( sample - m_smoothedRtt ) * 0.1f : sample;
+        setRoundTripTime( static_cast<s32>( m_smoothedRtt ) );
+        m_acked++;
+
+        // Acknowledge all reliable fragments sent inside this datagram
+        for( s32 j = 0, n = static_cast<s32>( i->fragments.size() ); j < n; j++ ) {
+            const FragmentRef& fragment = i->fragments[j];
+
+            for( OutgoingMessages::iterator k = m_outgoing.begin(), end = m_outgoing.end(); k != end; ++k ) {
+                if( k->channel != ReliableOrdered || k->id != fragment.message ) {
+                    continue;
+                }
+
+                if( !k->acked[fragment.index] ) {
+                    k->acked[fragment.index] = true;
+                    k->pending--;
+                }
+                break;
+            }
+        }
+
+        i = m_sent.erase( i );
+    }
+
+    // Remove completely acknowledged reliable messages
+    for( OutgoingMessages::iterator i = m_outgoing.begin(); i != m_outgoing.end(); ) {
+        if( i->channel == ReliableOrdered && i->pending == 0 ) {
+            i = m_outgoing.erase( i );
+        } else {
+            ++i;
+        }
+    }
+}
+
+// ** ConnectionUDP::trackReceived
+bool ConnectionUDP::trackReceived( u16 sequence )
+{
+    // This is the first received datagram
+    if( !m_hasReceived ) {
+        m_hasReceived    = true;
+        m_remoteSequence = sequence;
+        m_receivedBits   = 0;
+        return true;
+    }
+
+    // The most recent datagram - shift the received bitmask
+    if( isNewer( sequence, m_remoteSequence ) ) {
+        u16 shift = static_cast<u16>( sequence - m_remoteSequence );
+
+        if( shift < 32 ) {
+            m_receivedBits = ( m_receivedBits << shift ) | ( 1u << ( shift - 1 ) );
+        } else {
+            m_receivedBits = shift == 32 ? 1u << 31 : 0;
+        }
+
+        m_remoteSequence = sequence;
+        return true;
+    }
+
+    // Duplicate datagram or a datagram that is too old to be acknowledged
+    u16 distance = static_cast<u16>( m_remoteSequence - sequence );
+    if( distance == 0 || distance > 32 ) {
+        return false;
+    }
+
+    u32 bit = 1u << ( distance - 1 );
+    if( m_receivedBits & bit ) {
+        return false;
+    }
+
+    m_receivedBits |= bit;
+    return true;
+}
+
+// ** ConnectionUDP::receiveFragment
+void ConnectionUDP::receiveFragment( PacketDelivery channel, u16 id, u8 index, u8 count, const u8* data, u16 size )
+{
+    // Skip messages that were already delivered
+    if( channel == ReliableOrdered ) {
+        if( id != m_nextReliable && !isNewer( id, m_nextReliable ) ) {
+            return;
+        }
+    } else if( m_hasUnreliable && !isNewer( id, m_lastUnreliable ) ) {
+        return;
+    }
+
+    IncomingMessages& incoming = m_incoming[channel];
+
+    if( channel == ReliableOrdered ) {
+        // Reliable messages too far ahead of the expected one are dropped, a sender resends them later
+        if( static_cast<u16>( id - m_nextReliable ) >= ReceiveWindow ) {
+            return;
+        }
+    } else {
+        // A newer unreliable message supersedes partially received ones outside of the window
+        for( IncomingMessages::iterator i = incoming.begin(); i != incoming.end(); ) {
+            if( isNewer( id, i->first ) && static_cast<u16>( id - i->first ) >= ReceiveWindow ) {
+                m_incomingBytes -= i->second.bytes;
+                incoming.erase( i++ );
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    // Cap the amount of buffered data, older unreliable messages are dropped first
+    if( m_incomingBytes + size > MaxIncomingBytes ) {
+        IncomingMessages& unreliable = m_incoming[UnreliableSequenced];
+
+        for( IncomingMessages::iterator i = unreliable.begin(); i != unreliable.end(); ) {
+            if( channel == ReliableOrdered || isNewer( id, i->first ) ) {
+                m_incomingBytes -= i->second.bytes;
+                unreliable.erase( i++ );
+            } else {
+                ++i;
+            }
+        }
+
+        // The next expected reliable message is always accepted so the channel could not stall
+        bool expected = channel == ReliableOrdered && id == m_nextReliable;
+
+        if( m_incomingBytes + size > MaxIncomingBytes && !expected ) {
+            LogWarning( "connection", "too much incoming data buffered for %s:%d, fragment dropped\n", m_address.toString(), m_port );
+            return;
+        }
+    }
+
+    // Store the fragment data
+    IncomingMessage& message = incoming[id];
+
+    if( message.fragments.empty() ) {
+        message.fragments.resize( count );
+    }
+
+    if( static_cast<s32>( message.fragments.size() ) != count || !message.fragments[index].empty() ) {
+        return;
+    }
+
+    message.fragments[index].assign( data, data + size );
+    message.received++;
+    message.bytes   += size;
+    m_incomingBytes += size;
+
+    // Deliver all completed reliable messages in order
+    if( channel == ReliableOrdered ) {
+        while( !m_isClosed ) {
+            IncomingMessages::iterator i = incoming.find( m_nextReliable );
+
+            if( i == incoming.end() || i->second.received != static_cast<s32>( i->second.fragments.size() ) ) {
+                break;
+            }
+
+            Array<u8> assembled;
+            for( s32 j = 0, n = static_cast<s32>( i->second.fragments.size() ); j < n; j++ ) {
+                assembled.insert( assembled.end(), i->second.fragments[j].begin(), i->second.fragments[j].end() );
+            }
+
+            m_incomingBytes -= i->second.bytes;
+            incoming.erase( i );
+            m_nextReliable++;
+            deliverMessage( assembled );
+        }
+        return;
+    }
+
+    // Unreliable message is not completed yet
+    if( message.received != static_cast<s32>( message.fragments.size() ) ) {
+        return;
+    }
+
+    Array<u8> assembled;
+    for( s32 j = 0, n = static_cast<s32>( message.fragments.size() ); j < n; j++ ) {
+        assembled.insert( assembled.end(), message.fragments[j].begin(), message.fragments[j].end() );
+    }
+
+    m_lastUnreliable = id;
+    m_hasUnreliable  = true;
+
+    // Drop this and all older partially received messages
+    for( IncomingMessages::iterator i = incoming.begin(); i != incoming.end(); ) {
+        if( !isNewer( i->first, id ) ) {
+            m_incomingBytes -= i->second.bytes;
+            incoming.erase( i++ );
+        } else {
+            ++i;
+        }
+    }
+
+    deliverMessage( assembled );
+}
+
+// ** ConnectionUDP::deliverMessage
+void ConnectionUDP::deliverMessage( const Array<u8>& message )
+{
+    Io::ByteBufferPtr stream = Io::ByteBuffer::createFromArray( message );
+
+    // Parse packets while there is data left in a message
+    while( stream->hasDataLeft() && !m_isClosed ) {
+        // Read single packet from a stream
+        Header header = readPacket( stream, m_packet );
+
+        if( !header.type ) {
+            break;
+        }
+
+        // Notify about this packet
+        notifyPacketReceived( header.type, header.size, m_packet );
+    }
+}
+
+// ** ConnectionUDP::update
+void ConnectionUDP::update( u32 dt )
+{
+    Connection_::update( dt );
+
+    if( m_isClosed ) {
+        return;
+    }
+
+    // Nothing was received for too long
+    if( timeout() > ConnectionTimeout ) {
+        LogWarning( "connection", "connection to %s:%d timed out\n", m_address.toString(), m_port );
+        close();
+        return;
+    }
+
+    // A handshake datagram may be lost, so resend it until a remote peer responds
+    if( m_isHandshaking && time() - m_lastHandshakeTime >= HandshakeInterval ) {
+        sendHandshake();
+    }
+
+    // Refill the send budget, allow bursts up to a quarter of a second
+    m_tokens = std::min( m_tokens + m_sendRate * dt * 0.001f, m_sendRate * 0.25f );
+
+    detectLosses();
+    updateSendRate();
+    flush();
+}
+
+// ** ConnectionUDP::retransmitTimeout
+s32 ConnectionUDP::retransmitTimeout( void ) const
+{
+    return std::max( static_cast<s32>( m_smoothedRtt * 2.0f ), 100 );
+}
+
+// ** ConnectionUDP::detectLosses
+void ConnectionUDP::detectLosses( void )
+{
+    s32 timeout = retransmitTimeout();
+
+    // Datagrams are stored in order they were sent, so stop at the first one that could still be acknowledged
+    while( !m_sent.empty() && time() - m_sent.front().time > timeout ) {
+        m_sent.pop_front();
+        m_lost++;
+    }
+}
+
+// ** ConnectionUDP::updateSendRate
+void ConnectionUDP::updateSendRate( void )
+{
+    if( time() - m_lastRateUpdate < 1000 ) {
+        return;
+    }
+
+    m_lastRateUpdate = time();
+
+    s32 total = m_acked + m_lost;
+    m_packetLoss = total ? static_cast<f32>( m_lost ) / total : 0.0f;
+
+    // Halve the send rate when losing packets, otherwise increase it additively
+    if( m_packetLoss > 0.05f ) {
+        m_sendRate = std::max( m_sendRate / 2, static_cast<s32>( MinSendRate ) );
+        LogDebug( "connection", "%2.2f%% packet loss to %s:%d, send rate decreased to %d bytes/s\n", m_packetLoss * 100.0f, m_address.toString(), m_port, m_sendRate );
+    } else if( total ) {
+        m_sendRate = std::min( m_sendRate + SendRateIncrease, static_cast<s32>( MaxSendRate ) );
+    }
+
+    m_acked = 0;
+    m_lost  = 0;
+}
+
+// ** ConnectionUDP::flush
+void ConnectionUDP::flush( void )
+{
+    // Drop unreliable messages that were waiting for too long
+    for( OutgoingMessages::iterator i = m_outgoing.begin(); i != m_outgoing.end(); ) {
+        if( i->channel == UnreliableSequenced && time() - i->time > UnreliableTimeout ) {
+            i = m_outgoing.erase( i );
+        } else {
+            ++i;
+        }
+    }
+
+    s32 retransmit = retransmitTimeout();
+
+    while( true ) {
+        // Write the datagram header, the message count is patched once messages are written
+        Io::ByteBufferPtr datagram = Io::ByteBuffer::create();
+        u8 messages = 0;
+
+        datagram->write( &m_localSequence, sizeof( m_localSequence ) );
+        datagram->write( &m_remoteSequence, sizeof( m_remoteSequence ) );
+        datagram->write( &m_receivedBits, sizeof( m_receivedBits ) );
+        datagram->write( &messages, sizeof( messages ) );
+
+        SentDatagram sent;
+        sent.sequence = m_localSequence;
+        sent.time     = time();
+
+        // Pack message fragments while there is a send budget
+        bool full = m_tokens <= 0.0f;
+
+        for( OutgoingMessages::iterator i = m_outgoing.begin(); i != m_outgoing.end() && !full; ) {
+            OutgoingMessage& message = *i;
+
+            for( s32 j = 0, n = static_cast<s32>( message.sentTime.size() ); j < n; j++ ) {
+                // Skip acknowledged fragments and fragments that wait for an acknowledgement
+                if( message.acked[j] || ( message.sentTime[j] >= 0 && time() - message.sentTime[j] < retransmit ) ) {
+                    continue;
+                }
+
+                s32 offset = j * MaxFragmentSize;
+                u16 size   = static_cast<u16>( std::min( static_cast<s32>( message.data.size() ) - offset, static_cast<s32>( MaxFragmentSize ) ) );
+
+                if( datagram->length() + MessageHeaderSize + size > MaxDatagramSize || messages == MaxMessages ) {
+                    full = true;
+                    break;
+                }
+
+                u8 channel = static_cast<u8>( message.channel );
+                u8 index   = static_cast<u8>( j );
+                u8 count   = static_cast<u8>( n );
+
+                datagram->write( &channel, sizeof( channel ) );
+                datagram->write( &message.id, sizeof( message.id ) );
+                datagram->write( &index, sizeof( index ) );
+                datagram->write( &count, sizeof( count ) );
+                datagram->write( &size, sizeof( size ) );
+                if( size ) {
+                    datagram->write( &message.data[offset], size );
+                }
+
+                messages++;
+                message.sentTime[j] = time();
+
+                // Reliable fragments wait for an acknowledgement, unreliable ones are sent once
+                if( message.channel == ReliableOrdered ) {
+                    FragmentRef fragment;
+                    fragment.message = message.id;
+                    fragment.index   = index;
+                    sent.fragments.push_back( fragment );
+                } else {
+                    message.acked[j] = true;
+                    message.pending--;
+                }
+            }
+
+            if( message.channel == UnreliableSequenced && message.pending == 0 ) {
+                i = m_outgoing.erase( i );
+            } else {
+                ++i;
+            }
+        }
+
+        // Nothing to send, but a received datagram should be acknowledged or a connection kept alive
+        if( !messages && !m_ackPending && time() - m_lastSendTime < KeepAliveInterval ) {
+            break;
+        }
+
+        // Patch the message count
+        u8 count = static_cast<u8>( messages | ( m_hasReceived ? AckFlag : 0 ) );
+        datagram->setPosition( DatagramHeaderSize - sizeof( count ) );
+        datagram->write( &count, sizeof( count ) );
+
+        if( !sendDatagram( datagram ) ) {
+            close();
+            break;
+        }
+
+        // Only datagrams with messages are tracked for acknowledgement
+        if( !messages ) {
+            break;
+        }
+
+        m_sent.push_back( sent );
+    }
+}
+
+// ** ConnectionUDP::sendDatagram
+s32 ConnectionUDP::sendDatagram( Io::ByteBufferWPtr datagram )
+{
+    if( !m_socket.valid() ) {
+        return 0;
+    }
+
+    s32 result = static_cast<s32>( m_socket->send( m_address, m_port, datagram->buffer(), datagram->length() ) );
+
+    // A failed datagram does not consume a sequence number or a send budget
+    if( result <= 0 ) {
+        LogWarning( "connection", "failed to send a datagram to %s:%d\n", m_address.toString(), m_port );
+        m_sendFailures++;
+        return 0;
+    }
+
+    m_localSequence++;
+    m_lastSendTime = time();
+    m_ackPending   = false;
+    m_tokens      -= result;
+    trackSentAmount( result );
+
+    return result;
+}
+
+// ** ConnectionUDP::sendHandshake
+void ConnectionUDP::sendHandshake( void )
+{
+    if( !m_socket.valid() ) {
+        return;
+    }
+
+    u32 handshake[2] = { HandshakeMagic, ProtocolVersion };
+    s32 result       = static_cast<s32>( m_socket->send( m_address, m_port, handshake, sizeof( handshake ) ) );
+
+    m_lastHandshakeTime = time();
+
+    if( result <= 0 ) {
+        m_sendFailures++;
+        return;
+    }
+
+    trackSentAmount( result );
+}
+
+} // namespace Network
+
+DC_END_DREEMCHEST
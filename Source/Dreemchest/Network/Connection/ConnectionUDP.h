@@ -0,0 +1,230 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Network_ConnectionUDP_H__
+#define __DC_Network_ConnectionUDP_H__
+
+#include "Connection_.h"
+#include "../Sockets/UDPSocket.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Network {
+
+    //! Connection to a remote peer over a shared UDP socket.
+    /*!
+     Each datagram carries a sequence number and acknowledges the last 33 datagrams received
+     from a remote side. Packets are sent as messages over two channels: a reliable ordered one
+     resends message fragments until they are acknowledged, an unreliable sequenced one drops
+     messages that are older than the last delivered. Messages larger than a single datagram are
+     split into fragments. The outgoing traffic is paced by a send rate that is increased while
+     datagrams are acknowledged and halved each time the packet loss becomes noticeable.
+
+     A connecting side sends a handshake datagram until anything is received from a remote peer,
+     a listening side creates a connection only after a valid handshake is received.
+     */
+    class ConnectionUDP : public Connection_ {
+    public:
+
+        enum {
+              MaxDatagramSize       = 1200                          //!< Maximum datagram size that is not fragmented by IP layer.
+            , DatagramHeaderSize    = 9                             //!< Sequence, ack, ack bits and message count.
+            , AckFlag               = 0x80                          //!< Set in a message count byte when ack fields are valid.
+            , MaxMessages           = 0x7F                          //!< Maximum number of messages inside a single datagram.
+            , MessageHeaderSize     = 7                             //!< Channel, message id, fragment index & count, size.
+            , MaxFragmentSize       = MaxDatagramSize - DatagramHeaderSize - MessageHeaderSize
+            , MaxFragments          = 255                           //!< Maximum number of fragments a single message is split into.
+            , ReceiveWindow         = 256                           //!< Incoming messages with an id this far ahead of the expected one are dropped.
+            , MaxIncomingBytes      = 1024 * 1024                   //!< Maximum amount of fragment data buffered for incoming messages.
+            , MinSendRate           = 8192                          //!< Minimum send rate in bytes per second.
+            , MaxSendRate           = 262144                        //!< Maximum send rate in bytes per second.
+            , SendRateIncrease      = 4096                          //!< Send rate is increased by this value each second without losses.
+            , KeepAliveInterval     = 100                           //!< An ack-only datagram is sent when nothing was sent for this amount of milliseconds.
+            , UnreliableTimeout     = 250                           //!< Unreliable messages that were not sent during this time are dropped.
+            , ConnectionTimeout     = 10000                         //!< A connection is closed when nothing was received during this time.
+            , HandshakeMagic        = 0x50445544                    //!< A four-character code that starts a handshake datagram.
+            , HandshakeSize         = 8                             //!< A handshake magic and a protocol version, smaller than a datagram header.
+            , HandshakeInterval     = 250                           //!< A handshake is resent with this interval until a remote peer responds.
+            , ProtocolVersion       = 1                             //!< A datagram protocol version, peers with another version are not accepted.
+        };
+
+                                //! Constructs ConnectionUDP instance.
+                                ConnectionUDP( UDPSocketWPtr socket, const Address& address, u16 port );
+
+        //! Returns a remote address of a connection.
+        virtual const Address&  address( void ) const NIMBLE_OVERRIDE;
+
+        //! Returns a remote port of a connection.
+        u16                     port( void ) const;
+
+        //! Returns current send rate in bytes per second.
+        s32                     sendRate( void ) const;
+
+        //! Returns the packet loss ratio measured during the last second.
+        f32                     packetLoss( void ) const;
+
+        //! Returns the number of datagrams that a socket failed to send.
+        s32                     sendFailures( void ) const;
+
+        //! Returns true if this connection was closed.
+        bool                    isClosed( void ) const;
+
+        //! Closes this UDP connection.
+        virtual void            close( void ) NIMBLE_OVERRIDE;
+
+        //! Processes a datagram received from a remote peer.
+        void                    processDatagram( Io::ByteBufferWPtr data );
+
+        //! Starts sending handshake datagrams to a remote peer, used by a connecting side.
+        void                    startHandshake( void );
+
+        //! Returns true if a datagram is a valid handshake with a matching protocol version.
+        static bool             isHandshake( Io::ByteBufferWPtr data );
+
+    protected:
+
+        //! Queues a byte buffer for sending over the requested channel.
+        virtual s32             sendData( Io::ByteBufferWPtr data, PacketDelivery delivery ) NIMBLE_OVERRIDE;
+
+        //! Updates the congestion control and flushes queued messages.
+        virtual void            update( u32 dt ) NIMBLE_OVERRIDE;
+
+    private:
+
+        //! Returns true if the sequence number a is newer than b.
+        static bool             isNewer( u16 a, u16 b );
+
+        //! Acknowledges sent datagrams and message fragments.
+        void                    processAcks( u16 ack, u32 ackBits );
+
+        //! Tracks the received datagram sequence number, returns false for duplicates.
+        bool                    trackReceived( u16 sequence );
+
+        //! Stores the received message fragment and delivers completed messages.
+        void                    receiveFragment( PacketDelivery channel, u16 id, u8 index, u8 count, const u8* data, u16 size );
+
+        //! Splits the message to packets and emits notifications.
+        void                    deliverMessage( const Array<u8>& message );
+
+        //! Returns the time to wait for an acknowledgement before a datagram is considered lost.
+        s32                     retransmitTimeout( void ) const;
+
+        //! Detects lost datagrams.
+        void                    detectLosses( void );
+
+        //! Adjusts the send rate each second according to a measured packet loss.
+        void                    updateSendRate( void );
+
+        //! Packs queued message fragments into datagrams and sends them.
+        void                    flush( void );
+
+        //! Sends a single datagram, returns the total number of bytes sent.
+        s32                     sendDatagram( Io::ByteBufferWPtr datagram );
+
+        //! Sends a handshake datagram, it does not consume a datagram sequence number.
+        void                    sendHandshake( void );
+
+    private:
+
+        //! A reference to a message fragment inside the sent datagram.
+        struct FragmentRef {
+            u16                 message;        //!< Message id.
+            u8                  index;          //!< Fragment index.
+        };
+
+        //! Outgoing message that is split into fragments.
+        struct OutgoingMessage {
+            u16                 id;             //!< Message id.
+            PacketDelivery      channel;        //!< Message channel.
+            s32                 time;           //!< The time message was queued.
+            Array<u8>           data;           //!< Message data.
+            Array<s32>          sentTime;       //!< The last time each fragment was sent or -1.
+            Array<bool>         acked;          //!< Indicates that a fragment was acknowledged.
+            s32                 pending;        //!< The number of fragments left to acknowledge (or send for unreliable messages).
+        };
+
+        //! A datagram that was sent and waits for acknowledgement.
+        struct SentDatagram {
+            u16                 sequence;       //!< Datagram sequence number.
+            s32                 time;           //!< The time datagram was sent.
+            Array<FragmentRef>  fragments;      //!< Reliable fragments sent inside this datagram.
+        };
+
+        //! Incoming message that is assembled from fragments.
+        struct IncomingMessage {
+                                //! Constructs IncomingMessage instance.
+                                IncomingMessage( void )
+                                    : received( 0 ), bytes( 0 ) {}
+            s32                 received;       //!< The number of received fragments.
+            s32                 bytes;          //!< The total size of received fragments.
+            Array< Array<u8> >  fragments;      //!< Received fragment data.
+        };
+
+        //! Container type to store outgoing messages.
+        typedef List<OutgoingMessage>           OutgoingMessages;
+
+        //! Container type to store sent datagrams.
+        typedef List<SentDatagram>              SentDatagrams;
+
+        //! Container type to store incoming messages.
+        typedef Map<u16, IncomingMessage>       IncomingMessages;
+
+        UDPSocketWPtr           m_socket;               //!< Socket used to send datagrams.
+        Address                 m_address;              //!< Remote peer address.
+        u16                     m_port;                 //!< Remote peer port.
+        bool                    m_isClosed;             //!< Indicates that a connection was closed.
+        bool                    m_isHandshaking;        //!< Indicates that a handshake is resent until a remote peer responds.
+        s32                     m_lastHandshakeTime;    //!< The last time a handshake was sent.
+        Io::ByteBufferPtr       m_packet;               //!< Temporary buffer to read received packets.
+        u16                     m_localSequence;        //!< Next datagram sequence number.
+        u16                     m_remoteSequence;       //!< The most recent received datagram sequence number.
+        u32                     m_receivedBits;         //!< Bitmask of received datagrams prior to the most recent one.
+        bool                    m_hasReceived;          //!< Indicates that at least one datagram was received.
+        bool                    m_ackPending;           //!< Indicates that a received datagram was not acknowledged yet.
+        s32                     m_lastSendTime;         //!< The last time a datagram was sent.
+        u16                     m_nextMessageId[2];     //!< Next message id for each channel.
+        u16                     m_nextReliable;         //!< Next reliable message id to be delivered.
+        u16                     m_lastUnreliable;       //!< Last delivered unreliable message id.
+        bool                    m_hasUnreliable;        //!< Indicates that at least one unreliable message was delivered.
+        OutgoingMessages        m_outgoing;             //!< Queued outgoing messages.
+        SentDatagrams           m_sent;                 //!< Sent datagrams waiting for acknowledgement.
+        IncomingMessages        m_incoming[2];          //!< Incoming messages being assembled for each channel.
+        s32                     m_incomingBytes;        //!< The total size of fragments buffered for incoming messages.
+        f32                     m_smoothedRtt;          //!< Smoothed round trip time.
+        s32                     m_sendRate;             //!< Current send rate in bytes per second.
+        f32                     m_tokens;               //!< Amount of bytes that could be sent right now.
+        s32                     m_acked;                //!< The number of datagrams acknowledged since the last send rate update.
+        s32                     m_lost;                 //!< The number of datagrams lost since the last send rate update.
+        f32                     m_packetLoss;           //!< Packet loss ratio measured during the last second.
+        s32                     m_lastRateUpdate;       //!< The last time a send rate was updated.
+        s32                     m_sendFailures;         //!< The number of datagrams a socket failed to send.
+    };
+
+} // namespace Network
+
+DC_END_DREEMCHEST
+
+#endif  /*  !__DC_Network_ConnectionUDP_H__ */
@@ -123,11 +123,17 @@ void Connection_::setRoundTripTime( s32 value )
     m_roundTripTime = value;
 }
 
+// ** Connection::resetTimeout
+void Connection_::resetTimeout( void )
+{
+    m_timeout = 0;
+}
+
 // ** Connection::notifyPacketReceived
 void Connection_::notifyPacketReceived( PacketTypeId type, u16 size, Io::ByteBufferWPtr packet )
 {
     // Reset the timeout counter
-    m_timeout = 0;
+    resetTimeout();
 
     // Notify all listeners about this packet
     notify<Received>( this, type, size, packet );
@@ -153,7 +159,7 @@ void Connection_::send( const AbstractPacket& packet )
     u32 bytesWritten = writePacket( packet, stream );
 
     // Send binary data to socket
-    s32 bytesSent = sendData( stream );
+    s32 bytesSent = sendData( stream, packet.delivery() );
 
     // The socket was closed.
     if( bytesSent == 0 ) {
@@ -36,10 +36,14 @@ namespace Network {
     //! Remote connection interface wraps a network sockets and used for sending/receiving packets.
     class Connection_ : public InjectEventEmitter<RefCounted> {
     friend class Application;
+    friend class Connection;
     public:
 
         virtual                 ~Connection_( void ) {}
 
+        //! Returns a remote address of a connection.
+        virtual const Address&  address( void ) const = 0;
+
         //! Sets the connection id.
         void                    setId( u32 value );
 
@@ -145,11 +149,14 @@ namespace Network {
         //! Reads the packet from a binary stream to a temporary buffer and returns it's header.
         Header                  readPacket( Io::ByteBufferWPtr stream, Io::ByteBufferWPtr packet ) const;
 
+        //! Resets the timeout counter, called when any data is received from a remote side.
+        void                    resetTimeout( void );
+
         //! Updates this connection
-        void                    update( u32 dt );
+        virtual void            update( u32 dt );
 
-        //! Sends a byte buffer over this connection.
-        virtual s32             sendData( Io::ByteBufferWPtr data ) = 0;
+        //! Sends a byte buffer over this connection with requested delivery guarantees.
+        virtual s32             sendData( Io::ByteBufferWPtr data, PacketDelivery delivery ) = 0;
 
         //! Closes this connection.
         virtual void            close( void ) = 0;
@@ -69,6 +69,7 @@ namespace Network {
 
     class TCPSocket;
     class UDPSocket;
+    class ConnectionUDP;
     class TCPSocketListener;
     class SocketDescriptor;
     class Connection;
@@ -84,15 +85,24 @@ namespace Network {
     //! Declare smart pointer types.
     dcDeclarePtrs( Application )
     dcDeclarePtrs( ApplicationTCP )
+    dcDeclarePtrs( ApplicationUDP )
     dcDeclarePtrs( TCPSocket )
     dcDeclarePtrs( UDPSocket )
     dcDeclarePtrs( TCPSocketListener )
     dcDeclarePtrs( Connection )
     dcDeclarePtrs( Connection_ )
+    dcDeclarePtrs( ConnectionUDP )
+    dcDeclarePtrs( EntityReplicator )
 
     //! Unique packet identifier type.
     typedef TypeId PacketTypeId;
 
+    //! Delivery guarantees requested by a packet from a connection transport.
+    enum PacketDelivery {
+          ReliableOrdered       //!< A packet is guaranteed to be delivered in order.
+        , UnreliableSequenced   //!< A packet could be lost, but it's never delivered after a newer one.
+    };
+
     //! Network packet unique pointer.
     typedef UPtr<class AbstractPacket> PacketUPtr;
 
@@ -308,11 +318,15 @@ DC_END_DREEMCHEST
 #ifndef DC_BUILD_LIBRARY
     #include "NetworkHandler/Connection.h"
     #include "NetworkHandler/ApplicationTCP.h"
+    #include "NetworkHandler/ApplicationUDP.h"
+    #include "Connection/ConnectionUDP.h"
     #include "Sockets/TCPSocketListener.h"
     #include "Sockets/TCPSocket.h"
     #include "Sockets/UDPSocket.h"
     #include "Packets/PacketHandler.h"
     #include "Packets/Ping.h"
+    #include "Packets/Snapshot.h"
+    #include "Replication/EntityReplicator.h"
 #endif
 
 #endif    /*    !__DC_Network_H__    */
@@ -0,0 +1,151 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "ApplicationUDP.h"
+#include "Connection.h"
+
+#include "../Connection/ConnectionUDP.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Network {
+
+// ** ApplicationUDP::ApplicationUDP
+ApplicationUDP::ApplicationUDP( UDPSocketPtr socket, bool accept )
+    : m_socket( socket ), m_accept( accept ), m_serverPort( 0 ), m_connectPending( false )
+{
+    NIMBLE_ABORT_IF( !socket.valid(), "invalid UDP socket" );
+    m_socket->subscribe<UDPSocket::Data>( dcThisMethod( ApplicationUDP::handleSocketData ) );
+}
+
+// ** ApplicationUDP::~ApplicationUDP
+ApplicationUDP::~ApplicationUDP( void )
+{
+    m_socket->unsubscribe<UDPSocket::Data>( dcThisMethod( ApplicationUDP::handleSocketData ) );
+}
+
+// ** ApplicationUDP::connect
+ApplicationUDPPtr ApplicationUDP::connect( const Address& address, u16 port )
+{
+    UDPSocketPtr socket = UDPSocket::create();
+
+    // The connection is created on the first update, so listeners could subscribe for Connected event
+    ApplicationUDP* app = DC_NEW ApplicationUDP( socket, false );
+    app->m_serverAddress  = address;
+    app->m_serverPort     = port;
+    app->m_connectPending = true;
+
+    return ApplicationUDPPtr( app );
+}
+
+// ** ApplicationUDP::listen
+ApplicationUDPPtr ApplicationUDP::listen( u16 port )
+{
+    // Bind the socket to a port
+    UDPSocketPtr socket = UDPSocket::create();
+
+    // Failed to bind - can't create UDP application instance
+    if( !socket->listen( port ) ) {
+        return ApplicationUDPPtr();
+    }
+
+    return ApplicationUDPPtr( DC_NEW ApplicationUDP( socket, true ) );
+}
+
+// ** ApplicationUDP::peerKey
+u64 ApplicationUDP::peerKey( const Address& address, u16 port )
+{
+    return ( static_cast<u64>( static_cast<u32>( address ) ) << 16 ) | port;
+}
+
+// ** ApplicationUDP::update
+void ApplicationUDP::update( u32 dt )
+{
+    // Update the base application, this flushes queued datagrams of all connections
+    Application::update( dt );
+
+    if( m_connectPending ) {
+        createPeer( m_serverAddress, m_serverPort )->startHandshake();
+        m_connectPending = false;
+    }
+
+    // Receive all pending datagrams
+    m_socket->recv();
+
+    // Remove destroyed or closed connections
+    for( ConnectionByPeer::iterator i = m_connectionByPeer.begin(); i != m_connectionByPeer.end(); ) {
+        if( !i->second.valid() || i->second->isClosed() ) {
+            m_connectionByPeer.erase( i++ );
+        } else {
+            ++i;
+        }
+    }
+}
+
+// ** ApplicationUDP::createPeer
+ConnectionUDPWPtr ApplicationUDP::createPeer( const Address& address, u16 port )
+{
+    // Create the UDP transport and a connection instance that wraps it
+    ConnectionUDPPtr transport( DC_NEW ConnectionUDP( m_socket, address, port ) );
+    ConnectionWPtr   connection = createConnection( transport );
+
+    // Register this connection
+    m_connectionByPeer[peerKey( address, port )] = transport;
+
+    // Notify listeners about a new connection
+    notify<Connected>( this, connection );
+
+    return transport;
+}
+
+// ** ApplicationUDP::handleSocketData
+void ApplicationUDP::handleSocketData( const UDPSocket::Data& e )
+{
+    ConnectionByPeer::iterator i = m_connectionByPeer.find( peerKey( e.address, e.port ) );
+    ConnectionUDPWPtr connection;
+
+    if( i != m_connectionByPeer.end() && i->second.valid() && !i->second->isClosed() ) {
+        connection = i->second;
+    } else if( m_accept ) {
+        // Only a valid handshake creates a new peer, so stray datagrams can't allocate connections
+        if( !ConnectionUDP::isHandshake( e.data ) ) {
+            LogDebug( "connection", "datagram from %s:%d without a handshake ignored\n", e.address.toString(), e.port );
+            return;
+        }
+
+        createPeer( e.address, e.port );
+        return;
+    } else {
+        LogDebug( "connection", "datagram from unknown peer %s:%d ignored\n", e.address.toString(), e.port );
+        return;
+    }
+
+    connection->processDatagram( e.data );
+}
+
+} // namespace Network
+
+DC_END_DREEMCHEST
@@ -0,0 +1,83 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Network_ApplicationUDP_H__
+#define __DC_Network_ApplicationUDP_H__
+
+#include "NetworkApplication.h"
+#include "../Sockets/UDPSocket.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Network {
+
+    //! Network application that uses UDP as a transport protocol, all peers share a single datagram socket.
+    class ApplicationUDP : public Application {
+    public:
+
+        virtual                     ~ApplicationUDP( void ) NIMBLE_OVERRIDE;
+
+        //! Connects the UDP application to a remote host.
+        static ApplicationUDPPtr    connect( const Address& address, u16 port );
+
+        //! Launches a listening UDP application on a specified port.
+        static ApplicationUDPPtr    listen( u16 port );
+
+    private:
+
+                                    //! Constructs ApplicationUDP instance.
+                                    ApplicationUDP( UDPSocketPtr socket, bool accept );
+
+        //! Creates a connection to a remote peer and emits Connected event.
+        ConnectionUDPWPtr           createPeer( const Address& address, u16 port );
+
+        //! Dispatches a received datagram to a peer connection, a listening socket accepts a new peer after a valid handshake.
+        void                        handleSocketData( const UDPSocket::Data& e );
+
+        //! Receives and processes all incoming datagrams.
+        virtual void                update( u32 dt ) NIMBLE_OVERRIDE;
+
+        //! Returns a peer key for a specified address and port.
+        static u64                  peerKey( const Address& address, u16 port );
+
+    private:
+
+        //! Container type to map from a remote address & port to a connection.
+        typedef Map<u64, ConnectionUDPWPtr> ConnectionByPeer;
+
+        UDPSocketPtr                m_socket;               //!< UDP socket instance.
+        ConnectionByPeer            m_connectionByPeer;     //!< Peer to connection mapping.
+        bool                        m_accept;               //!< Indicates that handshakes from unknown peers create new connections.
+        Address                     m_serverAddress;        //!< A remote server address to connect to on the first update.
+        u16                         m_serverPort;           //!< A remote server port to connect to on the first update.
+        bool                        m_connectPending;       //!< Indicates that a connection to server should be created.
+    };
+
+} // namespace Network
+
+DC_END_DREEMCHEST
+
+#endif  /*  !__DC_Network_ApplicationUDP_H__ */
@@ -26,17 +26,76 @@
 
 #include "Connection.h"
 #include "NetworkApplication.h"
-#include "../Sockets/TCPSocket.h"
 
 DC_BEGIN_DREEMCHEST
 
 namespace Network {
 
 // ** Connection::Connection
-Connection::Connection( Application* application, const TCPSocketPtr& socket )
-    : ConnectionTCP( socket ), m_application( application ), m_nextRemoteCallId( 1 )
+Connection::Connection( Application* application, Connection_Ptr transport )
+    : m_application( application ), m_transport( transport ), m_nextRemoteCallId( 1 )
 {
+    NIMBLE_ABORT_IF( !m_transport.valid(), "invalid transport connection" );
     memset( &m_traffic, 0, sizeof( m_traffic ) );
+
+    // Subscribe for transport events
+    m_transport->subscribe<Connection_::Received>( dcThisMethod( Connection::handleTransportReceived ) );
+    m_transport->subscribe<Connection_::Closed>( dcThisMethod( Connection::handleTransportClosed ) );
+}
+
+// ** Connection::~Connection
+Connection::~Connection( void )
+{
+    m_transport->unsubscribe<Connection_::Received>( dcThisMethod( Connection::handleTransportReceived ) );
+    m_transport->unsubscribe<Connection_::Closed>( dcThisMethod( Connection::handleTransportClosed ) );
+}
+
+// ** Connection::transport
+Connection_WPtr Connection::transport( void ) const
+{
+    return m_transport;
+}
+
+// ** Connection::address
+const Address& Connection::address( void ) const
+{
+    return m_transport->address();
+}
+
+// ** Connection::sendData
+s32 Connection::sendData( Io::ByteBufferWPtr data, PacketDelivery delivery )
+{
+    return m_transport->sendData( data, delivery );
+}
+
+// ** Connection::close
+void Connection::close( void )
+{
+    // Unsubscribe from transport events, so the close notification is not received twice
+    m_transport->unsubscribe<Connection_::Received>( dcThisMethod( Connection::handleTransportReceived ) );
+    m_transport->unsubscribe<Connection_::Closed>( dcThisMethod( Connection::handleTransportClosed ) );
+
+    // Close the transport connection
+    m_transport->close();
+
+    // Notify all subscribers that connection is now closed
+    notify<Closed>( this );
+}
+
+// ** Connection::handleTransportReceived
+void Connection::handleTransportReceived( const Connection_::Received& e )
+{
+    // Track the received amount
+    trackReceivedAmount( Header::Size + e.size );
+
+    // Notify about this packet
+    notifyPacketReceived( e.type, e.size, e.packet );
+}
+
+// ** Connection::handleTransportClosed
+void Connection::handleTransportClosed( const Connection_::Closed& e )
+{
+    close();
 }
 
 // ** Connection::traffic
@@ -70,7 +129,10 @@ void Connection::handleResponse( const Packets::RemoteCallResponse& packet )
 // ** Connection::update
 void Connection::update( u32 dt )
 {
-    ConnectionTCP::update( dt );
+    Connection_::update( dt );
+
+    // Update the transport connection
+    m_transport->update( dt );
 
     if( time() - m_traffic.m_lastUpdateTimestamp >= 1000 ) {
         m_traffic.m_sentBps        = (totalBytesSent()     - m_traffic.m_lastSentBytes)      * 8;
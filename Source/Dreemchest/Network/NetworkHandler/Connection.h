@@ -27,15 +27,15 @@
 #ifndef __Network_Connection_H__
 #define __Network_Connection_H__
 
-#include "../Connection/ConnectionTCP.h"
+#include "../Connection/Connection_.h"
 #include "RemoteCallHandler.h"
 
 DC_BEGIN_DREEMCHEST
 
 namespace Network {
 
-    //! Remote connection interface.
-    class Connection : public ConnectionTCP {
+    //! Remote connection interface, wraps a transport connection (TCP or UDP) and adds RPC & traffic tracking on top of it.
+    class Connection : public Connection_ {
     friend class Application;
     public:
 
@@ -48,9 +48,21 @@ namespace Network {
             u32                    m_lastReceivedBytes;    //!< Total received bytes when the tacking was update.
         };
 
+                                //! Unsubscribes from transport connection events.
+        virtual                 ~Connection( void );
+
         //! Returns parent network application instance.
         Application*            application( void ) const;
 
+        //! Returns the transport connection instance.
+        Connection_WPtr         transport( void ) const;
+
+        //! Returns a remote address of a transport connection.
+        virtual const Address&  address( void ) const NIMBLE_OVERRIDE;
+
+        //! Closes the transport connection.
+        virtual void            close( void ) NIMBLE_OVERRIDE;
+
         //! Returns the traffic counter.
         const Traffic&            traffic( void ) const;
 
@@ -69,10 +81,19 @@ namespace Network {
     private:
 
                                 //! Constructs Connection instance.
-                                Connection( Application* application, const TCPSocketPtr& socket );
+                                Connection( Application* application, Connection_Ptr transport );
 
-        //! Updates this connection
-        void                    update( u32 dt );
+        //! Updates this connection and an underlying transport.
+        virtual void            update( u32 dt ) NIMBLE_OVERRIDE;
+
+        //! Passes the serialized packet to a transport connection.
+        virtual s32             sendData( Io::ByteBufferWPtr data, PacketDelivery delivery ) NIMBLE_OVERRIDE;
+
+        //! Forwards a packet received by a transport connection to application.
+        void                    handleTransportReceived( const Connection_::Received& e );
+
+        //! Closes this connection once the transport was closed.
+        void                    handleTransportClosed( const Connection_::Closed& e );
 
         //! Handles a recieved remote call response.
         void                    handleResponse( const Packets::RemoteCallResponse& packet );
@@ -96,6 +117,9 @@ namespace Network {
         //! Parent network connection.
         Application*            m_application;
 
+        //! Transport connection used to send and receive data.
+        Connection_Ptr          m_transport;
+
         //! A list of pending remote calls.
         PendingRemoteCalls        m_pendingRemoteCalls;
 
@@ -28,6 +28,7 @@
 #include "Connection.h"
 
 #include "../Connection/ConnectionMiddleware.h"
+#include "../Connection/ConnectionTCP.h"
 
 #include "../Sockets/UDPSocket.h"
 #include "../Sockets/TCPSocket.h"
@@ -70,9 +71,15 @@ Application::~Application( void )
 
 // ** Application::createConnection
 ConnectionPtr Application::createConnection( TCPSocketWPtr socket )
+{
+    return createConnection( Connection_Ptr( DC_NEW ConnectionTCP( socket ) ) );
+}
+
+// ** Application::createConnection
+ConnectionPtr Application::createConnection( Connection_Ptr transport )
 {
     // Create the connection instance and add it to an active connections set
-    ConnectionPtr connection( DC_NEW Connection( this, socket ) );
+    ConnectionPtr connection( DC_NEW Connection( this, transport ) );
     m_connections.insert( connection );
 
     // Subscribe for connection events.
@@ -117,6 +117,9 @@ namespace Network {
         //! Creates a connection from socket.
         ConnectionPtr            createConnection( TCPSocketWPtr socket );
 
+        //! Creates a connection that uses a specified transport connection to send and receive data.
+        ConnectionPtr            createConnection( Connection_Ptr transport );
+
         //! Removes the connection instance from application and emits Disconnected event.
         void                    closeConnection( ConnectionWPtr connection );
 
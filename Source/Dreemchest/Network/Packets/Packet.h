@@ -46,6 +46,9 @@ namespace Network {
         //! Returns the unique packet identifier.
         virtual PacketTypeId    id( void ) const = 0;
 
+        //! Returns delivery guarantees required by this packet, only UDP connections respect this.
+        virtual PacketDelivery  delivery( void ) const { return ReliableOrdered; }
+
         //! Writes packet to a binary stream.
         virtual void            serialize( Io::StreamWPtr stream ) const = 0;
 
@@ -0,0 +1,124 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Network_Packet_Snapshot_H__
+#define __DC_Network_Packet_Snapshot_H__
+
+#include "PacketHandler.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Network {
+
+namespace Packets {
+
+    //! Bit-packed entity state encoded relative to a previously acknowledged snapshot.
+    /*!
+    A receiver reconstructs a full entity state from a baseline and a payload, so a snapshot
+    that was not decoded completely is dropped. A truncated packet is deserialized with a zero
+    sequence number, which is never used by a sender.
+    */
+    struct EntitySnapshot : public Packet<EntitySnapshot> {
+        //! The maximum payload size that fits a length field.
+        enum { MaxPayloadSize = 0xFFFF };
+
+                        //! Constructs EntitySnapshot instance.
+                        EntitySnapshot( u32 sequence = 0, u32 baseline = 0, const BinaryBlob& payload = BinaryBlob() )
+                            : sequence( sequence ), baseline( baseline ), payload( payload ) {}
+
+        u32             sequence;   //!< A snapshot sequence number.
+        u32             baseline;   //!< A sequence number of a snapshot this one is encoded against or zero.
+        BinaryBlob      payload;    //!< Encoded entity state.
+
+        //! Snapshots are encoded against acknowledged ones, so they could be lost.
+        virtual PacketDelivery delivery( void ) const NIMBLE_OVERRIDE { return UnreliableSequenced; }
+
+        virtual void    serialize( Io::StreamWPtr stream ) const NIMBLE_OVERRIDE
+        {
+            // A sender should split entities between snapshots instead of truncating a payload
+            NIMBLE_ABORT_IF( payload.size() > MaxPayloadSize, "snapshot payload is too large" );
+            u16 length = static_cast<u16>( payload.size() );
+
+            stream->write( &sequence, sizeof( sequence ) );
+            stream->write( &baseline, sizeof( baseline ) );
+            stream->write( &length, sizeof( length ) );
+
+            if( length ) {
+                stream->write( &payload[0], length );
+            }
+        }
+
+        virtual void    deserialize( Io::StreamWPtr stream ) NIMBLE_OVERRIDE
+        {
+            u16 length = 0;
+            s32 bytes  = 0;
+
+            bytes += stream->read( &sequence, sizeof( sequence ) );
+            bytes += stream->read( &baseline, sizeof( baseline ) );
+            bytes += stream->read( &length, sizeof( length ) );
+            payload.resize( length );
+
+            if( length ) {
+                bytes += stream->read( &payload[0], length );
+            }
+
+            // Mark a truncated snapshot, so it will be dropped by a receiver
+            if( bytes != static_cast<s32>( sizeof( sequence ) + sizeof( baseline ) + sizeof( length ) + length ) ) {
+                sequence = 0;
+                payload.clear();
+            }
+        }
+    };
+
+    //! Acknowledges a received entity snapshot, so it could be used as a baseline.
+    struct EntitySnapshotAck : public Packet<EntitySnapshotAck> {
+                        //! Constructs EntitySnapshotAck instance.
+                        EntitySnapshotAck( u32 sequence = 0 )
+                            : sequence( sequence ) {}
+
+        u32             sequence;   //!< An acknowledged snapshot sequence number.
+
+        //! A newer acknowledgement always supersedes an older one.
+        virtual PacketDelivery delivery( void ) const NIMBLE_OVERRIDE { return UnreliableSequenced; }
+
+        virtual void    serialize( Io::StreamWPtr stream ) const NIMBLE_OVERRIDE
+        {
+            stream->write( &sequence, sizeof( sequence ) );
+        }
+
+        virtual void    deserialize( Io::StreamWPtr stream ) NIMBLE_OVERRIDE
+        {
+            stream->read( &sequence, sizeof( sequence ) );
+        }
+    };
+
+} // namespace Packets
+
+} // namespace Network
+
+DC_END_DREEMCHEST
+
+#endif  /*  __DC_Network_Packet_Snapshot_H__ */
@@ -0,0 +1,205 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "BitStream.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Network {
+
+// ------------------------------------------------------------ Quantization ------------------------------------------------------------ //
+
+// ** Quantization::quantize
+u32 Quantization::quantize( f32 value ) const
+{
+    NIMBLE_BREAK_IF( bits == 0 || bits > 31, "invalid quantization bits" );
+    NIMBLE_BREAK_IF( max <= min, "invalid quantization range" );
+
+    u32 steps = (1u << bits) - 1;
+    f32 t     = (value - min) / (max - min);
+
+    if( t <= 0.0f ) {
+        return 0;
+    }
+    if( t >= 1.0f ) {
+        return steps;
+    }
+
+    return static_cast<u32>( t * steps + 0.5f );
+}
+
+// ** Quantization::dequantize
+f32 Quantization::dequantize( u32 value ) const
+{
+    NIMBLE_BREAK_IF( bits == 0 || bits > 31, "invalid quantization bits" );
+
+    u32 steps = (1u << bits) - 1;
+    return min + (max - min) * (static_cast<f32>( value ) / steps);
+}
+
+// ------------------------------------------------------------ BitWriter ------------------------------------------------------------ //
+
+// ** BitWriter::BitWriter
+BitWriter::BitWriter( void )
+    : m_bits( 0 )
+{
+}
+
+// ** BitWriter::writeBits
+void BitWriter::writeBits( u32 value, s32 count )
+{
+    NIMBLE_BREAK_IF( count < 0 || count > 32, "invalid bit count" );
+
+    for( s32 i = 0; i < count; i++ ) {
+        s32 byte = m_bits >> 3;
+
+        if( byte >= static_cast<s32>( m_data.size() ) ) {
+            m_data.push_back( 0 );
+        }
+
+        if( (value >> i) & 1 ) {
+            m_data[byte] |= static_cast<u8>( 1 << (m_bits & 7) );
+        }
+
+        m_bits++;
+    }
+}
+
+// ** BitWriter::writeBool
+void BitWriter::writeBool( bool value )
+{
+    writeBits( value ? 1 : 0, 1 );
+}
+
+// ** BitWriter::writeVarUInt
+void BitWriter::writeVarUInt( u32 value )
+{
+    do {
+        u32 group = value & 0x7F;
+        value >>= 7;
+        writeBits( group, 7 );
+        writeBool( value != 0 );
+    } while( value );
+}
+
+// ** BitWriter::bitCount
+s32 BitWriter::bitCount( void ) const
+{
+    return m_bits;
+}
+
+// ** BitWriter::data
+const BinaryBlob& BitWriter::data( void ) const
+{
+    return m_data;
+}
+
+// ------------------------------------------------------------ BitReader ------------------------------------------------------------ //
+
+// ** BitReader::BitReader
+BitReader::BitReader( const BinaryBlob& data )
+    : m_data( data )
+    , m_position( 0 )
+    , m_hasFailed( false )
+{
+}
+
+// ** BitReader::hasFailed
+bool BitReader::hasFailed( void ) const
+{
+    return m_hasFailed;
+}
+
+// ** BitReader::hasBits
+bool BitReader::hasBits( s32 count ) const
+{
+    return m_position + count <= static_cast<s32>( m_data.size() ) * 8;
+}
+
+// ** BitReader::readBits
+u32 BitReader::readBits( s32 count )
+{
+    NIMBLE_BREAK_IF( count < 0 || count > 32, "invalid bit count" );
+
+    // Do not read anything after a failure or past the end of a stream
+    if( m_hasFailed || !hasBits( count ) ) {
+        m_hasFailed = true;
+        return 0;
+    }
+
+    u32 value = 0;
+
+    for( s32 i = 0; i < count; i++ ) {
+        if( (m_data[m_position >> 3] >> (m_position & 7)) & 1 ) {
+            value |= 1u << i;
+        }
+
+        m_position++;
+    }
+
+    return value;
+}
+
+// ** BitReader::readBool
+bool BitReader::readBool( void )
+{
+    return readBits( 1 ) != 0;
+}
+
+// ** BitReader::readVarUInt
+u32 BitReader::readVarUInt( void )
+{
+    u32 value = 0;
+
+    for( s32 shift = 0; ; shift += 7 ) {
+        u32 group = readBits( 7 );
+
+        // A fifth group holds the 4 highest bits of a value and can't be followed by another one
+        if( shift == 28 && group > 0xF ) {
+            m_hasFailed = true;
+        }
+
+        value |= group << shift;
+
+        if( !readBool() ) {
+            break;
+        }
+
+        if( shift == 28 ) {
+            m_hasFailed = true;
+        }
+
+        if( m_hasFailed ) {
+            break;
+        }
+    }
+
+    return m_hasFailed ? 0 : value;
+}
+
+} // namespace Network
+
+DC_END_DREEMCHEST
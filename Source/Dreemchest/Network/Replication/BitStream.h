@@ -0,0 +1,118 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Network_BitStream_H__
+#define __DC_Network_BitStream_H__
+
+#include "../Packets/Packet.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Network {
+
+    //! Maps a floating point value from a known range to an integer with a specified number of bits.
+    struct Quantization {
+                            //! Constructs Quantization instance, zero bits means that values are sent as is.
+                            Quantization( f32 min = 0.0f, f32 max = 0.0f, u8 bits = 0 )
+                                : min( min ), max( max ), bits( bits ) {}
+
+        //! Converts a floating point value to an integer, values outside of a range are clamped.
+        u32                 quantize( f32 value ) const;
+
+        //! Converts an integer back to a floating point value.
+        f32                 dequantize( u32 value ) const;
+
+        f32                 min;    //!< The minimum value.
+        f32                 max;    //!< The maximum value.
+        u8                  bits;   //!< The total number of bits used to store a value.
+    };
+
+    //! Writes values with an arbitrary number of bits to a byte array.
+    class BitWriter {
+    public:
+
+                            //! Constructs BitWriter instance.
+                            BitWriter( void );
+
+        //! Writes the lowest bits of a value.
+        void                writeBits( u32 value, s32 count );
+
+        //! Writes a single bit.
+        void                writeBool( bool value );
+
+        //! Writes an unsigned integer in groups of 7 bits, so small values take less space.
+        void                writeVarUInt( u32 value );
+
+        //! Returns the total number of bits written.
+        s32                 bitCount( void ) const;
+
+        //! Returns written bytes, the last byte is padded with zeroes.
+        const BinaryBlob&   data( void ) const;
+
+    private:
+
+        BinaryBlob          m_data; //!< Written bytes.
+        s32                 m_bits; //!< The total number of bits written.
+    };
+
+    //! Reads values written by a BitWriter.
+    /*!
+    A bit stream may come from a remote side, so reading past the end or a malformed value
+    does not abort. Instead a reader is marked as failed and all following reads return zero.
+    */
+    class BitReader {
+    public:
+
+                            //! Constructs BitReader instance.
+                            BitReader( const BinaryBlob& data );
+
+        //! Returns true if there are specified number of bits left.
+        bool                hasBits( s32 count ) const;
+
+        //! Returns true if a reader has failed to read a value.
+        bool                hasFailed( void ) const;
+
+        //! Reads a value with a specified number of bits.
+        u32                 readBits( s32 count );
+
+        //! Reads a single bit.
+        bool                readBool( void );
+
+        //! Reads an unsigned integer written in groups of 7 bits, a reader fails if a value does not fit 32 bits.
+        u32                 readVarUInt( void );
+
+    private:
+
+        const BinaryBlob&   m_data;     //!< Bytes being read.
+        s32                 m_position; //!< Current bit position.
+        bool                m_hasFailed;    //!< Indicates that a reader has failed.
+    };
+
+} // namespace Network
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Network_BitStream_H__    */
@@ -0,0 +1,813 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "EntityReplicator.h"
+
+#include <Reflection/MetaObject/Property.h>
+
+DC_BEGIN_DREEMCHEST
+
+namespace Network {
+
+// ** EntityReplicator::EntityReplicator
+EntityReplicator::EntityReplicator( ApplicationWPtr application, Ecs::EcsWPtr ecs, s32 bytesPerSecond )
+    : m_application( application )
+    , m_ecs( ecs )
+    , m_bytesPerSecond( bytesPerSecond )
+    , m_nextNetworkId( 1 )
+{
+    m_replicated = m_ecs->requestIndex( "Replicated", Ecs::Aspect::all<Replicated>() );
+
+#if DREEMCHEST_CPP11
+    m_application->addPacketHandler< PacketHandlerCallback<Packets::EntitySnapshot> >( dcThisMethod( EntityReplicator::handleSnapshotPacket ) );
+    m_application->addPacketHandler< PacketHandlerCallback<Packets::EntitySnapshotAck> >( dcThisMethod( EntityReplicator::handleSnapshotAckPacket ) );
+#else
+    NIMBLE_NOT_IMPLEMENTED
+#endif  /*  #if DREEMCHEST_CPP11    */
+
+    m_application->subscribe<Application::Connected>( dcThisMethod( EntityReplicator::handleConnected ) );
+    m_application->subscribe<Application::Disconnected>( dcThisMethod( EntityReplicator::handleDisconnected ) );
+}
+
+// ** EntityReplicator::~EntityReplicator
+EntityReplicator::~EntityReplicator( void )
+{
+    if( m_application.valid() ) {
+        m_application->unsubscribe<Application::Connected>( dcThisMethod( EntityReplicator::handleConnected ) );
+        m_application->unsubscribe<Application::Disconnected>( dcThisMethod( EntityReplicator::handleDisconnected ) );
+    }
+}
+
+// ** EntityReplicator::bytesPerSecond
+s32 EntityReplicator::bytesPerSecond( void ) const
+{
+    return m_bytesPerSecond;
+}
+
+// ** EntityReplicator::setBytesPerSecond
+void EntityReplicator::setBytesPerSecond( s32 value )
+{
+    m_bytesPerSecond = value;
+}
+
+// ** EntityReplicator::registerComponent
+void EntityReplicator::registerComponent( TypeIdx type, const Reflection::Class* cls, ComponentFactory factory )
+{
+    NIMBLE_ABORT_IF( m_componentTypes.size() >= 32, "too many replicated component types" );
+
+    ComponentType componentType;
+    componentType.type    = type;
+    componentType.cls     = cls;
+    componentType.factory = factory;
+
+    for( s32 i = 0, n = cls->memberCount(); i < n; i++ ) {
+        const Reflection::Property* property = cls->member( i )->isProperty();
+
+        if( !property ) {
+            continue;
+        }
+
+        Field field;
+        field.property = property;
+        field.type     = Reflection::BinaryValue::typeOf( property->type() );
+        field.scalars  = 1;
+        field.bits     = 32;
+
+        switch( field.type ) {
+        case Reflection::BinaryValue::kBoolean: field.bits = 1;                         break;
+        case Reflection::BinaryValue::kInt8:
+        case Reflection::BinaryValue::kUInt8:   field.bits = 8;                         break;
+        case Reflection::BinaryValue::kInt16:
+        case Reflection::BinaryValue::kUInt16:  field.bits = 16;                        break;
+        case Reflection::BinaryValue::kInt32:
+        case Reflection::BinaryValue::kUInt32:
+        case Reflection::BinaryValue::kFloat32: break;
+        case Reflection::BinaryValue::kVec2:    field.scalars = 2;                      break;
+        case Reflection::BinaryValue::kVec3:    field.scalars = 3;                      break;
+        case Reflection::BinaryValue::kVec4:    field.scalars = 4;                      break;
+        case Reflection::BinaryValue::kQuat:    field.scalars = 4;
+                                                field.quantization = Quantization( -1.0f, 1.0f, 16 );
+                                                break;
+        case Reflection::BinaryValue::kRgb:     field.scalars = 3;
+                                                field.quantization = Quantization( 0.0f, 1.0f, 8 );
+                                                break;
+        case Reflection::BinaryValue::kRgba:    field.scalars = 4;
+                                                field.quantization = Quantization( 0.0f, 1.0f, 8 );
+                                                break;
+        default:                                LogDebug( "replication", "%s.%s has a type that could not be replicated\n", cls->name(), property->name() );
+                                                continue;
+        }
+
+        if( field.quantization.bits ) {
+            field.bits = field.quantization.bits;
+        }
+
+        componentType.fields.push_back( field );
+    }
+
+    m_componentTypes.push_back( componentType );
+}
+
+// ** EntityReplicator::setQuantization
+void EntityReplicator::setQuantization( const Reflection::Class* cls, CString property, const Quantization& quantization )
+{
+    NIMBLE_ABORT_IF( quantization.bits > 31, "quantized values should fit 31 bits" );
+
+    for( s32 i = 0, n = static_cast<s32>( m_componentTypes.size() ); i < n; i++ ) {
+        ComponentType& componentType = m_componentTypes[i];
+
+        if( componentType.cls != cls ) {
+            continue;
+        }
+
+        for( s32 j = 0, m = static_cast<s32>( componentType.fields.size() ); j < m; j++ ) {
+            Field& field = componentType.fields[j];
+
+            if( strcmp( field.property->name(), property ) != 0 ) {
+                continue;
+            }
+
+            switch( field.type ) {
+            case Reflection::BinaryValue::kFloat32:
+            case Reflection::BinaryValue::kVec2:
+            case Reflection::BinaryValue::kVec3:
+            case Reflection::BinaryValue::kVec4:
+            case Reflection::BinaryValue::kQuat:
+            case Reflection::BinaryValue::kRgb:
+            case Reflection::BinaryValue::kRgba:    break;
+            default:                                LogWarning( "replication", "%s.%s is not a floating point property\n", cls->name(), property );
+                                                    return;
+            }
+
+            field.quantization = quantization;
+            field.bits         = quantization.bits ? quantization.bits : 32;
+            return;
+        }
+    }
+
+    LogWarning( "replication", "%s.%s is not replicated\n", cls->name(), property );
+}
+
+// ** EntityReplicator::update
+void EntityReplicator::update( u32 dt )
+{
+    // Capture the state of all replicated entities once
+    captureEntities( dt );
+
+    // Now send a snapshot to each connection
+    for( ConnectionStates::iterator i = m_connections.begin(), end = m_connections.end(); i != end; ++i ) {
+        sendSnapshot( i->second, dt );
+    }
+}
+
+// ** EntityReplicator::connectionState
+EntityReplicator::ConnectionState& EntityReplicator::connectionState( ConnectionWPtr connection )
+{
+    ConnectionState& state = m_connections[connection->id()];
+    state.connection = connection;
+    return state;
+}
+
+// ** EntityReplicator::captureEntities
+void EntityReplicator::captureEntities( u32 dt )
+{
+    m_current.clear();
+    m_priorities.clear();
+
+    const Ecs::EntitySet& entities = m_replicated->entities();
+
+    for( Ecs::EntitySet::const_iterator i = entities.begin(), end = entities.end(); i != end; ++i ) {
+        const Ecs::EntityPtr& entity     = *i;
+        Replicated*           replicated = entity->get<Replicated>();
+
+        // Assign a network identifier to a new entity
+        if( replicated->networkId() == 0 ) {
+            replicated->setNetworkId( m_nextNetworkId++ );
+        }
+
+        u32 id = replicated->networkId();
+        captureEntity( *entity, m_current[id] );
+        m_priorities[id] = replicated->priority();
+    }
+}
+
+// ** EntityReplicator::captureEntity
+void EntityReplicator::captureEntity( const Ecs::Entity& entity, EntityState& state ) const
+{
+    const Ecs::Entity::Components& components = entity.components();
+
+    state.mask = 0;
+    state.words.clear();
+
+    for( s32 i = 0, n = static_cast<s32>( m_componentTypes.size() ); i < n; i++ ) {
+        const ComponentType& componentType = m_componentTypes[i];
+        Ecs::Entity::Components::const_iterator component = components.find( componentType.type );
+
+        if( component == components.end() ) {
+            continue;
+        }
+
+        state.mask |= BIT( i );
+
+        const Ecs::ComponentBase*    base     = component->second.get();
+        Reflection::InstanceConst    instance = base->metaInstance();
+
+        for( s32 j = 0, m = static_cast<s32>( componentType.fields.size() ); j < m; j++ ) {
+            captureField( componentType.fields[j], instance, state.words );
+        }
+    }
+}
+
+// ** EntityReplicator::applyEntity
+void EntityReplicator::applyEntity( Ecs::Entity& entity, const EntityState& state ) const
+{
+    Ecs::Entity::Components& components = entity.components();
+    s32                      offset     = 0;
+
+    for( s32 i = 0, n = static_cast<s32>( m_componentTypes.size() ); i < n; i++ ) {
+        const ComponentType& componentType = m_componentTypes[i];
+        Ecs::Entity::Components::iterator component = components.find( componentType.type );
+
+        // The component was removed on a remote side
+        if( (state.mask & BIT( i )) == 0 ) {
+            if( component != components.end() ) {
+                entity.detachById( componentType.type );
+            }
+            continue;
+        }
+
+        // Construct a new component instance
+        Ecs::ComponentBase* instance = component != components.end() ? component->second.get() : entity.attachComponent( componentType.factory() );
+
+        for( s32 j = 0, m = static_cast<s32>( componentType.fields.size() ); j < m; j++ ) {
+            offset = applyField( componentType.fields[j], instance->metaInstance(), state.words, offset );
+        }
+    }
+}
+
+// ** EntityReplicator::captureField
+void EntityReplicator::captureField( const Field& field, const Reflection::InstanceConst& instance, Array<u32>& words ) const
+{
+    const Reflection::Property& property = *field.property;
+
+    switch( field.type ) {
+    case Reflection::BinaryValue::kBoolean: words.push_back( property.get<bool>( instance ) ? 1 : 0 );
+                                            break;
+    case Reflection::BinaryValue::kInt8:    words.push_back( static_cast<u8>( property.get<s8>( instance ) ) );
+                                            break;
+    case Reflection::BinaryValue::kUInt8:   words.push_back( property.get<u8>( instance ) );
+                                            break;
+    case Reflection::BinaryValue::kInt16:   words.push_back( static_cast<u16>( property.get<s16>( instance ) ) );
+                                            break;
+    case Reflection::BinaryValue::kUInt16:  words.push_back( property.get<u16>( instance ) );
+                                            break;
+    case Reflection::BinaryValue::kInt32:   words.push_back( static_cast<u32>( property.get<s32>( instance ) ) );
+                                            break;
+    case Reflection::BinaryValue::kUInt32:  words.push_back( property.get<u32>( instance ) );
+                                            break;
+    case Reflection::BinaryValue::kFloat32: words.push_back( encodeFloat( field, property.get<f32>( instance ) ) );
+                                            break;
+    case Reflection::BinaryValue::kVec2:    {
+                                                Vec2 v = property.get<Vec2>( instance );
+                                                words.push_back( encodeFloat( field, v.x ) );
+                                                words.push_back( encodeFloat( field, v.y ) );
+                                            }
+                                            break;
+    case Reflection::BinaryValue::kVec3:    {
+                                                Vec3 v = property.get<Vec3>( instance );
+                                                words.push_back( encodeFloat( field, v.x ) );
+                                                words.push_back( encodeFloat( field, v.y ) );
+                                                words.push_back( encodeFloat( field, v.z ) );
+                                            }
+                                            break;
+    case Reflection::BinaryValue::kVec4:    {
+                                                Vec4 v = property.get<Vec4>( instance );
+                                                words.push_back( encodeFloat( field, v.x ) );
+                                                words.push_back( encodeFloat( field, v.y ) );
+                                                words.push_back( encodeFloat( field, v.z ) );
+                                                words.push_back( encodeFloat( field, v.w ) );
+                                            }
+                                            break;
+    case Reflection::BinaryValue::kQuat:    {
+                                                Quat v = property.get<Quat>( instance );
+                                                words.push_back( encodeFloat( field, v.x ) );
+                                                words.push_back( encodeFloat( field, v.y ) );
+                                                words.push_back( encodeFloat( field, v.z ) );
+                                                words.push_back( encodeFloat( field, v.w ) );
+                                            }
+                                            break;
+    case Reflection::BinaryValue::kRgb:     {
+                                                Rgb v = property.get<Rgb>( instance );
+                                                words.push_back( encodeFloat( field, v.r ) );
+                                                words.push_back( encodeFloat( field, v.g ) );
+                                                words.push_back( encodeFloat( field, v.b ) );
+                                            }
+                                            break;
+    case Reflection::BinaryValue::kRgba:    {
+                                                Rgba v = property.get<Rgba>( instance );
+                                                words.push_back( encodeFloat( field, v.r ) );
+                                                words.push_back( encodeFloat( field, v.g ) );
+                                                words.push_back( encodeFloat( field, v.b ) );
+                                                words.push_back( encodeFloat( field, v.a ) );
+                                            }
+                                            break;
+    default:                                NIMBLE_BREAK_IF( true, "unexpected field type" );
+    }
+}
+
+// ** EntityReplicator::applyField
+s32 EntityReplicator::applyField( const Field& field, const Reflection::Instance& instance, const Array<u32>& words, s32 offset ) const
+{
+    NIMBLE_ABORT_IF( offset + field.scalars > static_cast<s32>( words.size() ), "entity state is too short" );
+
+    const Reflection::Property& property = *field.property;
+    const u32*                  w        = &words[offset];
+
+    switch( field.type ) {
+    case Reflection::BinaryValue::kBoolean: property.set<bool>( instance, w[0] != 0 );                      break;
+    case Reflection::BinaryValue::kInt8:    property.set<s8>( instance, static_cast<s8>( w[0] ) );          break;
+    case Reflection::BinaryValue::kUInt8:   property.set<u8>( instance, static_cast<u8>( w[0] ) );          break;
+    case Reflection::BinaryValue::kInt16:   property.set<s16>( instance, static_cast<s16>( w[0] ) );        break;
+    case Reflection::BinaryValue::kUInt16:  property.set<u16>( instance, static_cast<u16>( w[0] ) );        break;
+    case Reflection::BinaryValue::kInt32:   property.set<s32>( instance, static_cast<s32>( w[0] ) );        break;
+    case Reflection::BinaryValue::kUInt32:  property.set<u32>( instance, w[0] );                            break;
+    case Reflection::BinaryValue::kFloat32: property.set<f32>( instance, decodeFloat( field, w[0] ) );      break;
+    case Reflection::BinaryValue::kVec2:    {
+                                                Vec2 v;
+                                                v.x = decodeFloat( field, w[0] ); v.y = decodeFloat( field, w[1] );
+                                                property.set<Vec2>( instance, v );
+                                            }
+                                            break;
+    case Reflection::BinaryValue::kVec3:    {
+                                                Vec3 v;
+                                                v.x = decodeFloat( field, w[0] ); v.y = decodeFloat( field, w[1] ); v.z = decodeFloat( field, w[2] );
+                                                property.set<Vec3>( instance, v );
+                                            }
+                                            break;
+    case Reflection::BinaryValue::kVec4:    {
+                                                Vec4 v;
+                                                v.x = decodeFloat( field, w[0] ); v.y = decodeFloat( field, w[1] ); v.z = decodeFloat( field, w[2] ); v.w = decodeFloat( field, w[3] );
+                                                property.set<Vec4>( instance, v );
+                                            }
+                                            break;
+    case Reflection::BinaryValue::kQuat:    {
+                                                Quat v;
+                                                v.x = decodeFloat( field, w[0] ); v.y = decodeFloat( field, w[1] ); v.z = decodeFloat( field, w[2] ); v.w = decodeFloat( field, w[3] );
+                                                property.set<Quat>( instance, v );
+                                            }
+                                            break;
+    case Reflection::BinaryValue::kRgb:     {
+                                                Rgb v;
+                                                v.r = decodeFloat( field, w[0] ); v.g = decodeFloat( field, w[1] ); v.b = decodeFloat( field, w[2] );
+                                                property.set<Rgb>( instance, v );
+                                            }
+                                            break;
+    case Reflection::BinaryValue::kRgba:    {
+                                                Rgba v;
+                                                v.r = decodeFloat( field, w[0] ); v.g = decodeFloat( field, w[1] ); v.b = decodeFloat( field, w[2] ); v.a = decodeFloat( field, w[3] );
+                                                property.set<Rgba>( instance, v );
+                                            }
+                                            break;
+    default:                                NIMBLE_BREAK_IF( true, "unexpected field type" );
+    }
+
+    return offset + field.scalars;
+}
+
+// ** EntityReplicator::scalarCount
+s32 EntityReplicator::scalarCount( u32 mask ) const
+{
+    s32 count = 0;
+
+    for( s32 i = 0, n = static_cast<s32>( m_componentTypes.size() ); i < n; i++ ) {
+        if( (mask & BIT( i )) == 0 ) {
+            continue;
+        }
+
+        const Array<Field>& fields = m_componentTypes[i].fields;
+
+        for( s32 j = 0, m = static_cast<s32>( fields.size() ); j < m; j++ ) {
+            count += fields[j].scalars;
+        }
+    }
+
+    return count;
+}
+
+// ** EntityReplicator::encodeFloat
+u32 EntityReplicator::encodeFloat( const Field& field, f32 value )
+{
+    if( field.quantization.bits ) {
+        return field.quantization.quantize( value );
+    }
+
+    u32 bits;
+    memcpy( &bits, &value, sizeof( bits ) );
+    return bits;
+}
+
+// ** EntityReplicator::decodeFloat
+f32 EntityReplicator::decodeFloat( const Field& field, u32 value )
+{
+    if( field.quantization.bits ) {
+        return field.quantization.dequantize( value );
+    }
+
+    f32 result;
+    memcpy( &result, &value, sizeof( result ) );
+    return result;
+}
+
+// ** EntityReplicator::sendSnapshot
+void EntityReplicator::sendSnapshot( ConnectionState& state, u32 dt )
+{
+    // Refill the bandwidth budget, allowing at most a second of burst traffic
+    s32 budgetPerSecond = m_bytesPerSecond * 8;
+    state.budget = std::min( state.budget + budgetPerSecond * static_cast<s32>( dt ) / 1000, budgetPerSecond );
+
+    // Start from the state known to a remote side
+    const Snapshot* baseline = findSnapshot( state.sent, state.acknowledged );
+
+    Snapshot snapshot;
+    snapshot.sequence = state.nextSequence;
+
+    if( baseline ) {
+        snapshot.entities = baseline->entities;
+    }
+
+    BitWriter writer;
+
+    // Write entities that do not exist anymore, the rest of them stay in a snapshot and are written next time
+    Array<u32> removed;
+
+    for( EntityStates::const_iterator i = snapshot.entities.begin(), end = snapshot.entities.end(); i != end && static_cast<s32>( removed.size() ) < MaxRemovalsPerSnapshot; ++i ) {
+        if( m_current.find( i->first ) == m_current.end() ) {
+            removed.push_back( i->first );
+        }
+    }
+
+    writer.writeVarUInt( static_cast<u32>( removed.size() ) );
+
+    for( s32 i = 0, n = static_cast<s32>( removed.size() ); i < n; i++ ) {
+        writer.writeVarUInt( removed[i] );
+        snapshot.entities.erase( removed[i] );
+        state.priorities.erase( removed[i] );
+    }
+
+    // Accumulate the priority of entities that differ from a baseline
+    Array<Candidate> candidates;
+
+    for( EntityStates::const_iterator i = m_current.begin(), end = m_current.end(); i != end; ++i ) {
+        EntityStates::const_iterator known = snapshot.entities.find( i->first );
+
+        if( known != snapshot.entities.end() && known->second.mask == i->second.mask && known->second.words == i->second.words ) {
+            continue;
+        }
+
+        f32& priority = state.priorities[i->first];
+        priority += m_priorities[i->first] * dt;
+
+        Candidate candidate;
+        candidate.id       = i->first;
+        candidate.priority = priority;
+        candidates.push_back( candidate );
+    }
+
+    // Nothing to send
+    if( removed.empty() && candidates.empty() ) {
+        return;
+    }
+
+    // Write the most important entities until the budget is exhausted
+    std::sort( candidates.begin(), candidates.end() );
+
+    s32 written = 0;
+
+    for( s32 i = 0, n = static_cast<s32>( candidates.size() ); i < n && writer.bitCount() < state.budget; i++ ) {
+        u32                             id       = candidates[i].id;
+        const EntityState&              current  = m_current[id];
+        EntityStates::const_iterator    known    = snapshot.entities.find( id );
+
+        // An entity that does not fit a payload is written to a next snapshot
+        if( writer.bitCount() + maxEntityBits( current ) + 1 > MaxPayloadBits ) {
+            break;
+        }
+
+        writer.writeBool( true );
+        writer.writeVarUInt( id );
+        writeEntity( writer, current, known != snapshot.entities.end() ? &known->second : NULL );
+
+        snapshot.entities[id]  = current;
+        state.priorities[id]   = 0.0f;
+        written++;
+    }
+
+    writer.writeBool( false );
+
+    if( removed.empty() && written == 0 ) {
+        return;
+    }
+
+    state.budget -= writer.bitCount();
+
+    // Send a snapshot and keep it until it's acknowledged
+    state.connection->send( Packets::EntitySnapshot( snapshot.sequence, baseline ? baseline->sequence : 0, writer.data() ) );
+    state.nextSequence++;
+    state.sent.push_back( snapshot );
+
+    if( static_cast<s32>( state.sent.size() ) > MaxSnapshots ) {
+        state.sent.pop_front();
+    }
+}
+
+// ** EntityReplicator::writeEntity
+void EntityReplicator::writeEntity( BitWriter& writer, const EntityState& state, const EntityState* baseline ) const
+{
+    bool full = baseline == NULL || baseline->mask != state.mask;
+    s32  offset = 0;
+
+    // A set of components has changed, so all values are written
+    writer.writeBool( full );
+
+    if( full ) {
+        writer.writeBits( state.mask, static_cast<s32>( m_componentTypes.size() ) );
+    }
+
+    for( s32 i = 0, n = static_cast<s32>( m_componentTypes.size() ); i < n; i++ ) {
+        if( (state.mask & BIT( i )) == 0 ) {
+            continue;
+        }
+
+        const Array<Field>& fields = m_componentTypes[i].fields;
+
+        for( s32 j = 0, m = static_cast<s32>( fields.size() ); j < m; j++ ) {
+            const Field& field   = fields[j];
+            bool         changed = full;
+
+            for( s32 k = 0; k < field.scalars && !changed; k++ ) {
+                changed = state.words[offset + k] != baseline->words[offset + k];
+            }
+
+            if( !full ) {
+                writer.writeBool( changed );
+            }
+
+            if( changed ) {
+                for( s32 k = 0; k < field.scalars; k++ ) {
+                    writer.writeBits( state.words[offset + k], field.bits );
+                }
+            }
+
+            offset += field.scalars;
+        }
+    }
+}
+
+// ** EntityReplicator::maxEntityBits
+s32 EntityReplicator::maxEntityBits( const EntityState& state ) const
+{
+    // A presence flag, a network identifier, a full state flag and a component mask
+    s32 bits = 1 + 40 + 1 + static_cast<s32>( m_componentTypes.size() );
+
+    for( s32 i = 0, n = static_cast<s32>( m_componentTypes.size() ); i < n; i++ ) {
+        if( (state.mask & BIT( i )) == 0 ) {
+            continue;
+        }
+
+        const Array<Field>& fields = m_componentTypes[i].fields;
+
+        for( s32 j = 0, m = static_cast<s32>( fields.size() ); j < m; j++ ) {
+            bits += 1 + fields[j].scalars * fields[j].bits;
+        }
+    }
+
+    return bits;
+}
+
+// ** EntityReplicator::readEntity
+bool EntityReplicator::readEntity( BitReader& reader, EntityState& state ) const
+{
+    bool full   = reader.readBool();
+    s32  offset = 0;
+
+    if( full ) {
+        state.mask = reader.readBits( static_cast<s32>( m_componentTypes.size() ) );
+        state.words.resize( scalarCount( state.mask ) );
+    }
+
+    // A delta references an entity that does not exist in a baseline
+    if( reader.hasFailed() || static_cast<s32>( state.words.size() ) != scalarCount( state.mask ) ) {
+        return false;
+    }
+
+    for( s32 i = 0, n = static_cast<s32>( m_componentTypes.size() ); i < n; i++ ) {
+        if( (state.mask & BIT( i )) == 0 ) {
+            continue;
+        }
+
+        const Array<Field>& fields = m_componentTypes[i].fields;
+
+        for( s32 j = 0, m = static_cast<s32>( fields.size() ); j < m; j++ ) {
+            const Field& field = fields[j];
+
+            if( full || reader.readBool() ) {
+                for( s32 k = 0; k < field.scalars; k++ ) {
+                    state.words[offset + k] = reader.readBits( field.bits );
+                }
+            }
+
+            offset += field.scalars;
+        }
+    }
+
+    return !reader.hasFailed();
+}
+
+// ** EntityReplicator::readSnapshot
+bool EntityReplicator::readSnapshot( const BinaryBlob& payload, Snapshot& snapshot ) const
+{
+    BitReader reader( payload );
+
+    // Remove entities that do not exist on a remote side anymore
+    for( u32 i = 0, n = reader.readVarUInt(); i < n && !reader.hasFailed(); i++ ) {
+        snapshot.entities.erase( reader.readVarUInt() );
+    }
+
+    // Decode changed entities
+    while( reader.readBool() ) {
+        u32 id = reader.readVarUInt();
+
+        if( reader.hasFailed() || !readEntity( reader, snapshot.entities[id] ) ) {
+            return false;
+        }
+    }
+
+    return !reader.hasFailed();
+}
+
+// ** EntityReplicator::applySnapshot
+void EntityReplicator::applySnapshot( ConnectionState& state, const Snapshot& snapshot )
+{
+    // Remove local entities that are not present in a snapshot
+    for( EntityStates::const_iterator i = state.local.begin(), end = state.local.end(); i != end; ++i ) {
+        if( snapshot.entities.count( i->first ) ) {
+            continue;
+        }
+
+        Map<u32, Ecs::EntityWPtr>::iterator entity = m_entities.find( i->first );
+
+        if( entity != m_entities.end() ) {
+            if( entity->second.valid() ) {
+                m_ecs->removeEntity( entity->second->id() );
+            }
+            m_entities.erase( entity );
+        }
+    }
+
+    // Create and update local entities that differ from a snapshot
+    for( EntityStates::const_iterator i = snapshot.entities.begin(), end = snapshot.entities.end(); i != end; ++i ) {
+        EntityStates::const_iterator applied = state.local.find( i->first );
+        Ecs::EntityWPtr&             local   = m_entities[i->first];
+
+        if( local.valid() && applied != state.local.end() && applied->second.mask == i->second.mask && applied->second.words == i->second.words ) {
+            continue;
+        }
+
+        if( !local.valid() ) {
+            Ecs::EntityPtr created = m_ecs->createEntity();
+            m_ecs->addEntity( created );
+            local = created;
+        }
+
+        applyEntity( *local.get(), i->second );
+    }
+
+    state.local   = snapshot.entities;
+    state.applied = snapshot.sequence;
+}
+
+// ** EntityReplicator::findSnapshot
+const EntityReplicator::Snapshot* EntityReplicator::findSnapshot( const Snapshots& snapshots, u32 sequence )
+{
+    if( sequence == 0 ) {
+        return NULL;
+    }
+
+    for( Snapshots::const_iterator i = snapshots.begin(), end = snapshots.end(); i != end; ++i ) {
+        if( i->sequence == sequence ) {
+            return &*i;
+        }
+    }
+
+    return NULL;
+}
+
+// ** EntityReplicator::discardSnapshots
+void EntityReplicator::discardSnapshots( Snapshots& snapshots, u32 sequence )
+{
+    while( !snapshots.empty() && snapshots.front().sequence < sequence ) {
+        snapshots.pop_front();
+    }
+}
+
+// ** EntityReplicator::handleSnapshotPacket
+void EntityReplicator::handleSnapshotPacket( ConnectionWPtr connection, const Packets::EntitySnapshot& packet )
+{
+    ConnectionState& state = connectionState( connection );
+
+    // A snapshot was truncated or is older than an applied one
+    if( packet.sequence == 0 || packet.sequence <= state.applied ) {
+        return;
+    }
+
+    // A baseline is required to decode a delta
+    const Snapshot* baseline = findSnapshot( state.received, packet.baseline );
+
+    if( packet.baseline && !baseline ) {
+        LogWarning( "replication", "snapshot %d references unknown baseline %d and will be skipped\n", packet.sequence, packet.baseline );
+        return;
+    }
+
+    Snapshot snapshot;
+    snapshot.sequence = packet.sequence;
+
+    if( baseline ) {
+        snapshot.entities = baseline->entities;
+    }
+
+    // A malformed snapshot is dropped and is not acknowledged
+    if( !readSnapshot( packet.payload, snapshot ) ) {
+        LogWarning( "replication", "snapshot %d is malformed and will be skipped\n", packet.sequence );
+        return;
+    }
+
+    // Reconcile local entities with a full decoded state
+    applySnapshot( state, snapshot );
+
+    // Baselines older than a referenced one will never be used again
+    discardSnapshots( state.received, packet.baseline );
+    state.received.push_back( snapshot );
+
+    if( static_cast<s32>( state.received.size() ) > MaxSnapshots ) {
+        state.received.pop_front();
+    }
+
+#if DREEMCHEST_CPP11
+    connection->send<Packets::EntitySnapshotAck>( packet.sequence );
+#else
+    NIMBLE_NOT_IMPLEMENTED
+#endif  /*  #if DREEMCHEST_CPP11    */
+}
+
+// ** EntityReplicator::handleSnapshotAckPacket
+void EntityReplicator::handleSnapshotAckPacket( ConnectionWPtr connection, const Packets::EntitySnapshotAck& packet )
+{
+    ConnectionState& state = connectionState( connection );
+
+    // Acknowledgements may arrive out of order
+    if( packet.sequence <= state.acknowledged ) {
+        return;
+    }
+
+    state.acknowledged = packet.sequence;
+    discardSnapshots( state.sent, packet.sequence );
+}
+
+// ** EntityReplicator::handleConnected
+void EntityReplicator::handleConnected( const Application::Connected& e )
+{
+    connectionState( e.connection );
+}
+
+// ** EntityReplicator::handleDisconnected
+void EntityReplicator::handleDisconnected( const Application::Disconnected& e )
+{
+    m_connections.erase( e.connection->id() );
+}
+
+} // namespace Network
+
+DC_END_DREEMCHEST
@@ -0,0 +1,330 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Network_EntityReplicator_H__
+#define __DC_Network_EntityReplicator_H__
+
+#include "BitStream.h"
+#include "../NetworkHandler/NetworkApplication.h"
+#include "../Packets/Snapshot.h"
+
+#include <Ecs/Entity/Entity.h>
+#include <Ecs/Entity/Index.h>
+#include <Ecs/Entity/Aspect.h>
+#include <Ecs/Component/Component.h>
+
+#include <Reflection/Serialization/BinaryValue.h>
+
+DC_BEGIN_DREEMCHEST
+
+namespace Network {
+
+    //! Marks an entity to be replicated to remote connections.
+    class Replicated : public Ecs::Component<Replicated> {
+
+        INTROSPECTION_SUPER( Replicated, Ecs::ComponentBase
+            , PROPERTY( priority, priority, setPriority, "The replication priority, entities with a higher priority are sent more often." )
+            )
+
+    public:
+
+                                //! Constructs Replicated instance.
+                                Replicated( f32 priority = 1.0f )
+                                    : m_priority( priority ), m_networkId( 0 ) {}
+
+        //! Returns the replication priority.
+        f32                     priority( void ) const;
+
+        //! Sets the replication priority.
+        void                    setPriority( f32 value );
+
+        //! Returns the network identifier assigned by a replicator.
+        u32                     networkId( void ) const;
+
+        //! Sets the network identifier.
+        void                    setNetworkId( u32 value );
+
+    private:
+
+        f32                     m_priority;     //!< The replication priority.
+        u32                     m_networkId;    //!< The network identifier or zero if it was not assigned yet.
+    };
+
+    // ** Replicated::priority
+    inline f32 Replicated::priority( void ) const
+    {
+        return m_priority;
+    }
+
+    // ** Replicated::setPriority
+    inline void Replicated::setPriority( f32 value )
+    {
+        m_priority = value;
+    }
+
+    // ** Replicated::networkId
+    inline u32 Replicated::networkId( void ) const
+    {
+        return m_networkId;
+    }
+
+    // ** Replicated::setNetworkId
+    inline void Replicated::setNetworkId( u32 value )
+    {
+        m_networkId = value;
+    }
+
+    //! Replicates selected component properties of entities to remote connections.
+    /*!
+    Each update the state of all entities with a Replicated component is captured and quantized.
+    For each connection a snapshot is delta-encoded against the last snapshot acknowledged by
+    a remote side, only changed properties are bit-packed. Changed entities are sorted by
+    an accumulated priority and written until a per-connection bandwidth budget is exhausted,
+    so entities that were skipped are sent first next time.
+
+    A receiver decodes a snapshot against a baseline it has stored, so a decoded snapshot describes
+    all entities that exist on a sending side. Local entities are reconciled with it, so an entity
+    that was removed while an acknowledgement was lost or reordered is removed anyway. Snapshots
+    that are older than an applied one or that could not be decoded are dropped.
+
+    Both sides should register the same component types in the same order. A replicator
+    registers packet handlers inside an application, so it should live as long as an application does.
+    */
+    class EntityReplicator : public RefCounted {
+    public:
+
+                                //! Constructs EntityReplicator instance.
+                                EntityReplicator( ApplicationWPtr application, Ecs::EcsWPtr ecs, s32 bytesPerSecond = 16384 );
+        virtual                 ~EntityReplicator( void );
+
+        //! Registers a component type which fixed-size properties will be replicated.
+        template<typename TComponent>
+        void                    registerComponent( void );
+
+        //! Sets the quantization for floating point values of a component property.
+        template<typename TComponent>
+        void                    setQuantization( CString property, const Quantization& quantization );
+
+        //! Returns the per-connection bandwidth budget.
+        s32                     bytesPerSecond( void ) const;
+
+        //! Sets the per-connection bandwidth budget.
+        void                    setBytesPerSecond( s32 value );
+
+        //! Captures the current entity state and sends snapshots to all connections.
+        void                    update( u32 dt );
+
+    private:
+
+        //! Component factory function type.
+        typedef Ecs::ComponentBase* ( *ComponentFactory )( void );
+
+        //! A single replicated property.
+        struct Field {
+            const Reflection::Property*     property;       //!< A component property.
+            Reflection::BinaryValue::Type   type;           //!< A property value type.
+            s32                             scalars;        //!< The number of scalar values stored by this field.
+            u8                              bits;           //!< The number of bits used by each scalar.
+            Quantization                    quantization;   //!< Quantization applied to floating point scalars.
+        };
+
+        //! A replicated component type.
+        struct ComponentType {
+            TypeIdx                         type;           //!< A component type index.
+            const Reflection::Class*        cls;            //!< A component meta-class.
+            ComponentFactory                factory;        //!< Constructs a new component instance.
+            Array<Field>                    fields;         //!< Replicated component properties.
+        };
+
+        //! A quantized entity state.
+        struct EntityState {
+            u32                             mask;           //!< Replicated components attached to an entity.
+            Array<u32>                      words;          //!< Quantized scalar values of all components in a mask order.
+        };
+
+        //! Container type to map network identifiers to entity states.
+        typedef Map<u32, EntityState>       EntityStates;
+
+        //! An entity state snapshot sent to or received from a connection.
+        struct Snapshot {
+            u32                             sequence;       //!< A snapshot sequence number.
+            EntityStates                    entities;       //!< Entity states known to a remote side when this snapshot is received.
+        };
+
+        //! Container type to store snapshots in a sequence order.
+        typedef List<Snapshot>              Snapshots;
+
+        //! A replication state of a single connection.
+        struct ConnectionState {
+                                            //! Constructs ConnectionState instance.
+                                            ConnectionState( void )
+                                                : nextSequence( 1 ), acknowledged( 0 ), applied( 0 ), budget( 0 ) {}
+
+            ConnectionWPtr                  connection;     //!< A connection instance.
+            u32                             nextSequence;   //!< The next snapshot sequence number.
+            u32                             acknowledged;   //!< The last acknowledged snapshot sequence number.
+            u32                             applied;        //!< The last received snapshot sequence number applied to local entities.
+            EntityStates                    local;          //!< Entity states applied to local entities.
+            s32                             budget;         //!< The number of bits that could be sent.
+            Snapshots                       sent;           //!< Sent snapshots that are waiting for an acknowledgement.
+            Snapshots                       received;       //!< Received snapshots that could be used as a baseline.
+            Map<u32, f32>                   priorities;     //!< Accumulated priority of each entity.
+        };
+
+        //! Container type to store connection states by connection id.
+        typedef Map<u32, ConnectionState>   ConnectionStates;
+
+        //! An entity that was changed since a baseline and is waiting to be sent.
+        struct Candidate {
+            u32                             id;             //!< Entity network identifier.
+            f32                             priority;       //!< Accumulated entity priority.
+
+            //! Sorts candidates by priority in descending order.
+            bool                            operator < ( const Candidate& other ) const { return priority > other.priority; }
+        };
+
+        //! The maximum number of snapshots stored for each connection.
+        enum { MaxSnapshots = 32 };
+
+        //! The maximum number of removed entities written to a single snapshot, the rest are written to next ones.
+        enum { MaxRemovalsPerSnapshot = 4096 };
+
+        //! The maximum number of bits written to a snapshot payload.
+        enum { MaxPayloadBits = Packets::EntitySnapshot::MaxPayloadSize * 8 };
+
+        //! Constructs a component instance of a specified type.
+        template<typename TComponent>
+        static Ecs::ComponentBase*          createComponent( void );
+
+        //! Registers a component type.
+        void                    registerComponent( TypeIdx type, const Reflection::Class* cls, ComponentFactory factory );
+
+        //! Sets the quantization for a component property.
+        void                    setQuantization( const Reflection::Class* cls, CString property, const Quantization& quantization );
+
+        //! Returns the connection state or creates a new one.
+        ConnectionState&        connectionState( ConnectionWPtr connection );
+
+        //! Captures the quantized state of all replicated entities.
+        void                    captureEntities( u32 dt );
+
+        //! Captures the quantized state of a single entity.
+        void                    captureEntity( const Ecs::Entity& entity, EntityState& state ) const;
+
+        //! Applies the quantized state to an entity.
+        void                    applyEntity( Ecs::Entity& entity, const EntityState& state ) const;
+
+        //! Writes field values to an array of quantized scalars.
+        void                    captureField( const Field& field, const Reflection::InstanceConst& instance, Array<u32>& words ) const;
+
+        //! Reads field values from an array of quantized scalars.
+        s32                     applyField( const Field& field, const Reflection::Instance& instance, const Array<u32>& words, s32 offset ) const;
+
+        //! Returns the total number of scalars used by components in a mask.
+        s32                     scalarCount( u32 mask ) const;
+
+        //! Builds and sends a snapshot to a connection.
+        void                    sendSnapshot( ConnectionState& state, u32 dt );
+
+        //! Writes an entity state encoded against a baseline state.
+        void                    writeEntity( BitWriter& writer, const EntityState& state, const EntityState* baseline ) const;
+
+        //! Returns the maximum number of bits used to write an entity state.
+        s32                     maxEntityBits( const EntityState& state ) const;
+
+        //! Reads an entity state encoded against a baseline state, returns false if a stream is malformed.
+        bool                    readEntity( BitReader& reader, EntityState& state ) const;
+
+        //! Decodes a snapshot payload against a baseline, returns false if a payload is malformed.
+        bool                    readSnapshot( const BinaryBlob& payload, Snapshot& snapshot ) const;
+
+        //! Creates, updates and removes local entities to match a decoded snapshot.
+        void                    applySnapshot( ConnectionState& state, const Snapshot& snapshot );
+
+        //! Returns a snapshot with a specified sequence number or NULL.
+        static const Snapshot*  findSnapshot( const Snapshots& snapshots, u32 sequence );
+
+        //! Removes all snapshots older than a specified sequence number.
+        static void             discardSnapshots( Snapshots& snapshots, u32 sequence );
+
+        //! Quantizes a floating point scalar.
+        static u32              encodeFloat( const Field& field, f32 value );
+
+        //! Restores a floating point scalar.
+        static f32              decodeFloat( const Field& field, u32 value );
+
+        //! Handles an entity snapshot packet.
+        void                    handleSnapshotPacket( ConnectionWPtr connection, const Packets::EntitySnapshot& packet );
+
+        //! Handles a snapshot acknowledgement packet.
+        void                    handleSnapshotAckPacket( ConnectionWPtr connection, const Packets::EntitySnapshotAck& packet );
+
+        //! Starts tracking a new connection.
+        void                    handleConnected( const Application::Connected& e );
+
+        //! Handles a disconnected connection.
+        void                    handleDisconnected( const Application::Disconnected& e );
+
+    private:
+
+        ApplicationWPtr         m_application;      //!< Parent network application.
+        Ecs::EcsWPtr            m_ecs;              //!< Replicated entity component system.
+        Ecs::IndexPtr           m_replicated;       //!< All entities with a Replicated component.
+        s32                     m_bytesPerSecond;   //!< The per-connection bandwidth budget.
+        Array<ComponentType>    m_componentTypes;   //!< Replicated component types in a registration order.
+        ConnectionStates        m_connections;      //!< Replication state of each connection.
+        EntityStates            m_current;          //!< The entity state captured by a last update.
+        Map<u32, f32>           m_priorities;       //!< The priority of each captured entity.
+        Map<u32, Ecs::EntityWPtr> m_entities;       //!< Local entities by network identifier.
+        u32                     m_nextNetworkId;    //!< The next network identifier to be assigned.
+    };
+
+    // ** EntityReplicator::registerComponent
+    template<typename TComponent>
+    void EntityReplicator::registerComponent( void )
+    {
+        registerComponent( Ecs::ComponentBase::typeId<TComponent>(), TComponent::staticMetaObject(), &EntityReplicator::createComponent<TComponent> );
+    }
+
+    // ** EntityReplicator::setQuantization
+    template<typename TComponent>
+    void EntityReplicator::setQuantization( CString property, const Quantization& quantization )
+    {
+        setQuantization( TComponent::staticMetaObject(), property, quantization );
+    }
+
+    // ** EntityReplicator::createComponent
+    template<typename TComponent>
+    Ecs::ComponentBase* EntityReplicator::createComponent( void )
+    {
+        return DC_NEW TComponent;
+    }
+
+} // namespace Network
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Network_EntityReplicator_H__    */
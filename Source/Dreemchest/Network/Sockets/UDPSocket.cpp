@@ -85,22 +85,28 @@ bool UDPSocket::listen( u16 port )
 // ** UDPSocket::recv
 void UDPSocket::recv( void )
 {
-    sockaddr_in addr;
-    socklen_t   addrlen = sizeof( addr );
-    
-    SocketResult result = recvfrom( m_descriptor, ( s8* )m_data->buffer(), m_data->length(), 0, ( sockaddr* )&addr, &addrlen );
+    s8 datagram[MaxDatagramSize];
 
-    if( result.wouldBlock() ) {
-        return;
-    }
+    // Read datagrams until the socket would block
+    while( true ) {
+        sockaddr_in addr;
+        socklen_t   addrlen = sizeof( addr );
 
-    if( result.isError() ) {
-        LogError( "socket", "recvfrom failed %d, %s\n", result.errorCode(), result.errorMessage().c_str() );
-        return;
-    }
+        SocketResult result = recvfrom( m_descriptor, datagram, sizeof( datagram ), 0, ( sockaddr* )&addr, &addrlen );
 
-    Address remoteAddress( addr.sin_addr.s_addr );
-    notify<Data>( this, Address( addr.sin_addr.s_addr ), m_data );
+        if( result.wouldBlock() ) {
+            break;
+        }
+
+        if( result.isError() ) {
+            LogError( "socket", "recvfrom failed %d, %s\n", result.errorCode(), result.errorMessage().c_str() );
+            break;
+        }
+
+        // Copy the datagram to a byte buffer and emit an event
+        Io::ByteBufferPtr data = Io::ByteBuffer::createFromData( reinterpret_cast<const u8*>( datagram ), result );
+        notify<Data>( this, Address( addr.sin_addr.s_addr ), ntohs( addr.sin_port ), data );
+    }
 }
 
 // ** UDPSocket::create
@@ -43,7 +43,10 @@ namespace Network {
         //! Starts listening for datagrams at a given port.
         bool                    listen( u16 port );
 
-        //! Checks if any data has been received.
+        //! Maximum size of a datagram that can be received.
+        enum { MaxDatagramSize = 65507 };
+
+        //! Receives all pending datagrams and emits a Data event for each of them.
         void                    recv( void );
 
         //! Creates a new UDP socket instance.
@@ -55,11 +58,12 @@ namespace Network {
         //! This event is emitted when packet was received.
         struct Data {
                                 //! Constructs Data instance.
-                                Data( UDPSocketWPtr sender, const Address& address, Io::ByteBufferWPtr data )
-                                    : sender( sender ), address( address ), data( data ) {}
+                                Data( UDPSocketWPtr sender, const Address& address, u16 port, Io::ByteBufferWPtr data )
+                                    : sender( sender ), address( address ), port( port ), data( data ) {}
 
             UDPSocketWPtr       sender;     //!< Socket instance that received packet.
             Address             address;    //!< Sender remote address.
+            u16                 port;       //!< Sender remote port.
             Io::ByteBufferWPtr  data;       //!< Received data.
         };
 
@@ -55,8 +55,8 @@ AssemblyPtr Assembly::create( const String& name, AssemblyWPtr parent )
     return DC_NEW Assembly( name, parent );
 }
 
-// ** Assembly::createInstance
-Instance Assembly::createInstance( const String& name ) const
+// ** Assembly::findClass
+const Class* Assembly::findClass( const String& name ) const
 {
     // Create a hash string from a requested class name.
     String64 hash( name.c_str() );
@@ -64,13 +64,30 @@ Instance Assembly::createInstance( const String& name ) const
     // Find the class by hash value
     Classes::const_iterator i = m_classes.find( hash );
 
-    if( i == m_classes.end() ) {
+    return i != m_classes.end() ? i->second : NULL;
+}
+
+// ** Assembly::createInstance
+Instance Assembly::createInstance( const String& name ) const
+{
+    // Find the class by name
+    const Class* cls = findClass( name );
+
+    if( cls == NULL ) {
     //    LogError( "assembly", "unresolved class '%s'\n", name.c_str() );
         return Instance();
     }
 
+    return createInstance( cls );
+}
+
+// ** Assembly::createInstance
+Instance Assembly::createInstance( const Class* cls ) const
+{
+    NIMBLE_ABORT_IF( cls == NULL, "invalid class" );
+
     // Get the type instance being allocated
-    const Type* type = i->second->type();
+    const Type* type = cls->type();
 
     // -------------------------------
     static bool warningShown = false;
@@ -85,7 +102,7 @@ Instance Assembly::createInstance( const String& name ) const
     // Construct an instance
     type->construct( pointer );
 
-    Instance instance( i->second, pointer );
+    Instance instance( cls, pointer );
 
     return instance;
 }
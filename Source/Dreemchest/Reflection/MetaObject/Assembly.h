@@ -40,6 +40,12 @@ namespace Reflection {
         //! Creates a new class instance.
         Instance            createInstance( const String& name ) const;
 
+        //! Creates a new instance of a previously resolved class.
+        Instance            createInstance( const Class* cls ) const;
+
+        //! Returns a class with a specified name or NULL if it was not registered.
+        const Class*        findClass( const String& name ) const;
+
         //! Adds new class to this assembly.
         template<typename TClass>
         bool                registerClass( void );
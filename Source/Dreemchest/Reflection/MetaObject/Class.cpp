@@ -26,6 +26,7 @@
 
 #include "Class.h"
 #include "Instance.h"
+#include "../Serialization/Schema.h"
 
 DC_BEGIN_DREEMCHEST
 
@@ -36,6 +37,7 @@ namespace Reflection {
 // ** Member::Member
 Member::Member( CString name )
     : m_name( name )
+    , m_hash( MetaObject::hashName( name ) )
 {
 
 }
@@ -46,6 +48,12 @@ CString Member::name( void ) const
     return m_name;
 }
 
+// ** Member::hash
+u32 Member::hash( void ) const
+{
+    return m_hash;
+}
+
 // ----------------------------------------------------------- Class ----------------------------------------------------------- //
 
 // ** Class::Class
@@ -55,6 +63,7 @@ Class::Class( CString name, const Type* type, Member** members, s32 memberCount
     , m_members( members )
     , m_memberCount( memberCount )
     , m_upCast( NULL )
+    , m_schema( NULL )
 {
 }
 
@@ -65,7 +74,14 @@ Class::Class( const Class* super, CString name, const Type* type, Member** membe
     , m_members( members )
     , m_memberCount( memberCount )
     , m_upCast( upCast )
+    , m_schema( NULL )
+{
+}
+
+// ** Class::~Class
+Class::~Class( void )
 {
+    delete m_schema;
 }
 
 // ** Class::isClass
@@ -118,13 +134,26 @@ InstanceConst Class::upCast( const InstanceConst& instance ) const
     return m_upCast ? m_upCast( instance ) : InstanceConst();
 }
 
+// ** Class::schema
+const Schema& Class::schema( void ) const
+{
+    if( !m_schema ) {
+        m_schema = DC_NEW Schema( this );
+    }
+
+    return *m_schema;
+}
+
 // ** Class::findMember
 Member* Class::findMember( CString name )
 {
+    u32 hash = hashName( name );
+
+    // Compare precomputed hashes first and only then check a name
     for( s32 i = 0; i < memberCount(); i++ ) {
-        Member* m = member( i );
+        Member* m = m_members[i];
 
-        if( strcmp( m->name(), name ) == 0 ) {
+        if( m->hash() == hash && strcmp( m->name(), name ) == 0 ) {
             return m;
         }
     }
@@ -132,6 +161,18 @@ Member* Class::findMember( CString name )
     return NULL;
 }
 
+// ** Class::findMemberByHash
+const Member* Class::findMemberByHash( u32 hash ) const
+{
+    for( s32 i = 0; i < memberCount(); i++ ) {
+        if( m_members[i]->hash() == hash ) {
+            return m_members[i];
+        }
+    }
+
+    return NULL;
+}
+
 } // namespace Reflection
 
 DC_END_DREEMCHEST
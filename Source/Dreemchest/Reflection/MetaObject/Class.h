@@ -44,6 +44,9 @@ namespace Reflection {
         //! Returns the property name.
         CString                 name( void ) const;
 
+        //! Returns the property name hash that is calculated once on registration.
+        u32                     hash( void ) const;
+
         //! Perfors the type cast to a Property type.
         virtual const Property* isProperty( void ) const { return NULL; }
         virtual Property*       isProperty( void ) { return NULL; }
@@ -51,6 +54,7 @@ namespace Reflection {
     private:
 
         CString                 m_name; //!< The property name.
+        u32                     m_hash; //!< The property name hash.
     };
 
     //! The Class meta object contains meta-information about a single class.
@@ -66,6 +70,9 @@ namespace Reflection {
                                 //! Constructs Class instance with a super class.
                                 Class( const Class* super, CString name, const Type* type, Member** members, s32 memberCount, UpCast upCast );
 
+                                //! Destroys Class instance.
+                                ~Class( void );
+
         //! Returns the super class.
         const Class*            super( void ) const;
 
@@ -80,9 +87,15 @@ namespace Reflection {
         const Member*           findMember( CString name ) const;
         Member*                 findMember( CString name );
 
+        //! Returns the member with a specified name hash.
+        const Member*           findMemberByHash( u32 hash ) const;
+
         //! Performs an upcast of an instance pointer.
         InstanceConst           upCast( const InstanceConst& instance ) const;
 
+        //! Returns a binary layout of class properties, it's generated on a first request.
+        const Schema&           schema( void ) const;
+
         //! Returns an instance pointer type casted to Class or NULL, if the metaobject is not a class.
         virtual const Class*    isClass( void ) const NIMBLE_OVERRIDE;
         virtual Class*          isClass( void ) NIMBLE_OVERRIDE;
@@ -93,6 +106,7 @@ namespace Reflection {
         Member**                m_members;      //!< All members exposed by data type.
         s32                     m_memberCount;  //!< The total number of members.
         UpCast                  m_upCast;       //!< Performs an up-casting of an instance pointer.
+        mutable Schema*         m_schema;       //!< A lazily generated binary layout.
     };
 
     namespace Private {
@@ -33,6 +33,7 @@ namespace Reflection {
 // ** MetaObject::MetaObject
 MetaObject::MetaObject( CString name, const Type* type )
     : m_name( name )
+    , m_hash( hashName( name ) )
     , m_type( type )
 {
 }
@@ -49,6 +50,25 @@ const Type* MetaObject::type( void ) const
     return m_type;
 }
 
+// ** MetaObject::hash
+u32 MetaObject::hash( void ) const
+{
+    return m_hash;
+}
+
+// ** MetaObject::hashName
+u32 MetaObject::hashName( CString value )
+{
+    // Use the djb2 string hash function
+    u32 hash = 5381;
+
+    for( const u8* i = reinterpret_cast<const u8*>( value ); *i; i++ ) {
+        hash = (hash * 33) ^ *i;
+    }
+
+    return hash;
+}
+
 } // namespace Reflection
 
 DC_END_DREEMCHEST
\ No newline at end of file
@@ -46,6 +46,12 @@ namespace Reflection {
         //! Returns the instrospected type instance.
         const Type*             type( void ) const;
 
+        //! Returns the type name hash.
+        u32                     hash( void ) const;
+
+        //! Calculates a name hash value used by meta-objects, members and binary schemas.
+        static u32              hashName( CString value );
+
         //! Returns an instance pointer type casted to Class or NULL, if the metaobject is not a class.
         virtual const Class*    isClass( void ) const { return NULL; }
         virtual Class*          isClass( void ) { return NULL; }
@@ -57,6 +63,7 @@ namespace Reflection {
     private:
 
         CString                 m_name; //!< The type name.
+        u32                     m_hash; //!< The type name hash.
         const Type*             m_type; //!< The introspected type instance.
     };
 
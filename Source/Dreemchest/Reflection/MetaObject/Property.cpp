@@ -47,11 +47,13 @@ PropertyInfo::PropertyInfo( CString description )
 // ----------------------------------------------------------------- Property ----------------------------------------------------------------- //
 
 // ** Property::Property
-Property::Property( CString name, const Type* type, const MetaObject* metaObject, const PropertyInfo& info )
+Property::Property( CString name, const Type* type, const MetaObject* metaObject, const PropertyInfo& info, RawGetter getter, RawSetter setter )
     : Member( name )
     , m_metaObject( metaObject )
     , m_type( type )
     , m_info( info )
+    , m_rawGetter( getter )
+    , m_rawSetter( setter )
 {
 }
 
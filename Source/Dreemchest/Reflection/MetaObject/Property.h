@@ -50,8 +50,14 @@ namespace Reflection {
     class Property : public Member {
     public:
 
+        //! Reads a property value to a memory pointed by value, it should be an instance of a property type.
+        typedef void                ( *RawGetter )( const Property* property, const InstanceConst& instance, void* value );
+
+        //! Writes a property value from a memory pointed by value, it should be an instance of a property type.
+        typedef void                ( *RawSetter )( const Property* property, const Instance& instance, const void* value );
+
                                     //! Constructs the Property instance.
-                                    Property( CString name, const Type* type, const MetaObject* metaObject, const PropertyInfo& info );
+                                    Property( CString name, const Type* type, const MetaObject* metaObject, const PropertyInfo& info, RawGetter getter, RawSetter setter );
 
         //! This type can be type casted to a property.
         virtual const Property*     isProperty( void ) const NIMBLE_OVERRIDE;
@@ -85,13 +91,41 @@ namespace Reflection {
         //! Converts a property value to a Variant.
         virtual Variant             serialize( InstanceConst instance ) const NIMBLE_ABSTRACT;
 
+        //! Reads the property value without boxing it to a Variant, a value type should match a property type.
+        template<typename TValue>
+        TValue                      get( InstanceConst instance ) const;
+
+        //! Writes the property value without boxing it to a Variant, a value type should match a property type.
+        template<typename TValue>
+        void                        set( Instance instance, const TValue& value ) const;
+
     private:
 
         const MetaObject*           m_metaObject;   //!< The property value meta-object.
         const Type*                 m_type;         //!< The property value type.
         PropertyInfo                m_info;         //!< Property information.
+        RawGetter                   m_rawGetter;    //!< Reads a property value without a virtual call and a Variant construction.
+        RawSetter                   m_rawSetter;    //!< Writes a property value without a virtual call and a Variant construction.
     };
 
+    // ** Property::get
+    template<typename TValue>
+    TValue Property::get( InstanceConst instance ) const
+    {
+        NIMBLE_ABORT_IF( !m_type->is<TValue>(), "property type mismatch" );
+        TValue value;
+        m_rawGetter( this, instance, &value );
+        return value;
+    }
+
+    // ** Property::set
+    template<typename TValue>
+    void Property::set( Instance instance, const TValue& value ) const
+    {
+        NIMBLE_ABORT_IF( !m_type->is<TValue>(), "property type mismatch" );
+        m_rawSetter( this, instance, &value );
+    }
+
     namespace Private {
 
         //! Generic value property bound to a specified type.
@@ -129,6 +163,14 @@ namespace Reflection {
             //! Encodes property value to Variant.
             virtual Variant             serialize( InstanceConst instance ) const NIMBLE_OVERRIDE;
 
+        private:
+
+            //! Reads the property value to a memory pointed by value.
+            static void                 getRaw( const Property* property, const InstanceConst& instance, void* value );
+
+            //! Writes the property value from a memory pointed by value.
+            static void                 setRaw( const Property* property, const Instance& instance, const void* value );
+
         private:
 
             Getter                      m_getter;       //!< The property getter.
@@ -138,7 +180,7 @@ namespace Reflection {
         // ** GenericProperty::GenericProperty
         template<typename TObject, typename TValue, typename TPropertyValue>
         GenericProperty<TObject, TValue, TPropertyValue>::GenericProperty( CString name, Getter getter, Setter setter, const PropertyInfo& info )
-            : Property( name, Type::fromClass<TValue>(), staticMetaObject<TValue>(), info )
+            : Property( name, Type::fromClass<TValue>(), staticMetaObject<TValue>(), info, &GenericProperty::getRaw, &GenericProperty::setRaw )
             , m_getter( getter )
             , m_setter( setter )
         {
@@ -212,6 +254,22 @@ namespace Reflection {
             return result;
         }
 
+        // ** GenericProperty::getRaw
+        template<typename TObject, typename TValue, typename TPropertyValue>
+        void GenericProperty<TObject, TValue, TPropertyValue>::getRaw( const Property* property, const InstanceConst& instance, void* value )
+        {
+            const GenericProperty* self = static_cast<const GenericProperty*>( property );
+            *reinterpret_cast<TValue*>( value ) = (instance.pointer<TObject>()->*self->m_getter)();
+        }
+
+        // ** GenericProperty::setRaw
+        template<typename TObject, typename TValue, typename TPropertyValue>
+        void GenericProperty<TObject, TValue, TPropertyValue>::setRaw( const Property* property, const Instance& instance, const void* value )
+        {
+            const GenericProperty* self = static_cast<const GenericProperty*>( property );
+            (instance.pointer<TObject>()->*self->m_setter)( *reinterpret_cast<const TValue*>( value ) );
+        }
+
     } // namespace Private
 
 } // namespace Reflection
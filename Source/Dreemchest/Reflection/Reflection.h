@@ -47,6 +47,11 @@ namespace Reflection {
     class Property;
     struct PropertyInfo;
 
+    class Serializer;
+    class Schema;
+    class BinaryValue;
+    class BinaryArchive;
+
     dcDeclarePtrs( Assembly )
 
     //! An iterator unique pointer type.
@@ -64,6 +69,8 @@ DC_END_DREEMCHEST
     #include "MetaObject/Assembly.h"
     #include "MetaObject/Instance.h"
     #include "Serialization/Serializer.h"
+    #include "Serialization/Schema.h"
+    #include "Serialization/BinaryArchive.h"
 #endif  /*  !DC_BUILD_LIBRARY   */
 
 #endif    /*    !__DC_Reflection_H__    */
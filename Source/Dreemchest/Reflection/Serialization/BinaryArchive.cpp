@@ -0,0 +1,80 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "BinaryArchive.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Reflection {
+
+// ** BinaryArchive::BinaryArchive
+BinaryArchive::BinaryArchive( Io::StreamWPtr stream, bool embedSchemas )
+    : m_stream( stream )
+    , m_embedSchemas( embedSchemas )
+{
+    NIMBLE_BREAK_IF( !m_stream.valid(), "invalid stream" );
+}
+
+// ** BinaryArchive::stream
+Io::StreamWPtr BinaryArchive::stream( void ) const
+{
+    return m_stream;
+}
+
+// ** BinaryArchive::embedSchemas
+bool BinaryArchive::embedSchemas( void ) const
+{
+    return m_embedSchemas;
+}
+
+// ** BinaryArchive::markSchemaWritten
+bool BinaryArchive::markSchemaWritten( u32 hash )
+{
+    return m_written.insert( hash ).second;
+}
+
+// ** BinaryArchive::addStoredSchema
+void BinaryArchive::addStoredSchema( u32 hash, const StoredSchema& schema )
+{
+    m_stored[hash] = schema;
+}
+
+// ** BinaryArchive::findStoredSchema
+const BinaryArchive::StoredSchema* BinaryArchive::findStoredSchema( u32 hash ) const
+{
+    StoredSchemas::const_iterator i = m_stored.find( hash );
+    return i != m_stored.end() ? &i->second : NULL;
+}
+
+// ** BinaryArchive::scratch
+Array<u8>& BinaryArchive::scratch( void )
+{
+    return m_scratch;
+}
+
+} // namespace Reflection
+
+DC_END_DREEMCHEST
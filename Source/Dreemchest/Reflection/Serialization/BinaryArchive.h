@@ -0,0 +1,96 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Reflection_BinaryArchive_H__
+#define __DC_Reflection_BinaryArchive_H__
+
+#include "Schema.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Reflection {
+
+    //! A compact binary archive that stores instances using class schemas.
+    /*!
+    Each instance record starts with a schema hash followed by property values without names
+    and type tags. The first record of each class may embed a schema description, so records
+    written with an older class layout can still be read: fields are matched by name hashes and
+    unknown or changed fields are skipped. When both sides are known to share the same layouts
+    (network snapshots for example) schema embedding can be disabled.
+    */
+    class BinaryArchive {
+    public:
+
+        //! Instance record flags.
+        enum RecordFlags {
+            SchemaFollows = BIT( 0 )    //!< A record is followed by a schema description.
+        };
+
+        //! A schema description read from an archive.
+        struct StoredSchema {
+            String              className;  //!< A class name.
+            Array<u32>          names;      //!< Field name hashes.
+            Array<u8>           types;      //!< Field value types.
+        };
+
+                                //! Constructs BinaryArchive instance.
+                                BinaryArchive( Io::StreamWPtr stream, bool embedSchemas = true );
+
+        //! Returns an archive stream.
+        Io::StreamWPtr          stream( void ) const;
+
+        //! Returns true if schemas are embedded to an archive.
+        bool                    embedSchemas( void ) const;
+
+        //! Returns true if a schema with a specified hash was not written yet and marks it as written.
+        bool                    markSchemaWritten( u32 hash );
+
+        //! Registers a schema description read from an archive.
+        void                    addStoredSchema( u32 hash, const StoredSchema& schema );
+
+        //! Returns a schema description with a specified hash or NULL if it was not read yet.
+        const StoredSchema*     findStoredSchema( u32 hash ) const;
+
+        //! Returns a temporary buffer used for fixed-size blocks.
+        Array<u8>&              scratch( void );
+
+    private:
+
+        //! Container type to store read schema descriptions.
+        typedef Map<u32, StoredSchema> StoredSchemas;
+
+        Io::StreamWPtr          m_stream;       //!< An archive stream.
+        bool                    m_embedSchemas; //!< Indicates that schema descriptions are embedded to an archive.
+        Set<u32>                m_written;      //!< Hashes of schemas that were already written.
+        StoredSchemas           m_stored;       //!< Schema descriptions read from an archive.
+        Array<u8>               m_scratch;      //!< A temporary buffer for fixed-size blocks.
+    };
+
+} // namespace Reflection
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Reflection_BinaryArchive_H__    */
@@ -0,0 +1,488 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "BinaryValue.h"
+
+#include "../MetaObject/Property.h"
+
+#include <Io/KeyValue.h>
+#include <Io/streams/ByteBuffer.h>
+
+DC_BEGIN_DREEMCHEST
+
+namespace Reflection {
+
+#define RETURN_BINARY_TYPE_IF( type, id ) if( valueType->is<type>() ) return id
+
+// ** BinaryValue::typeOf
+BinaryValue::Type BinaryValue::typeOf( const Variant& value )
+{
+    if( !value.isValid() ) {
+        return kNull;
+    }
+
+    return typeOf( value.type() );
+}
+
+// ** BinaryValue::typeOf
+BinaryValue::Type BinaryValue::typeOf( const ::DC_DREEMCHEST_NS Type* valueType )
+{
+    if( !valueType ) {
+        return kNull;
+    }
+
+    RETURN_BINARY_TYPE_IF( bool, kBoolean );
+    RETURN_BINARY_TYPE_IF( s8, kInt8 );
+    RETURN_BINARY_TYPE_IF( u8, kUInt8 );
+    RETURN_BINARY_TYPE_IF( s16, kInt16 );
+    RETURN_BINARY_TYPE_IF( u16, kUInt16 );
+    RETURN_BINARY_TYPE_IF( s32, kInt32 );
+    RETURN_BINARY_TYPE_IF( u32, kUInt32 );
+    RETURN_BINARY_TYPE_IF( s64, kInt64 );
+    RETURN_BINARY_TYPE_IF( u64, kUInt64 );
+    RETURN_BINARY_TYPE_IF( f32, kFloat32 );
+    RETURN_BINARY_TYPE_IF( f64, kFloat64 );
+    RETURN_BINARY_TYPE_IF( String, kString );
+    RETURN_BINARY_TYPE_IF( Guid, kGuid );
+    RETURN_BINARY_TYPE_IF( Vec2, kVec2 );
+    RETURN_BINARY_TYPE_IF( Vec3, kVec3 );
+    RETURN_BINARY_TYPE_IF( Vec4, kVec4 );
+    RETURN_BINARY_TYPE_IF( Quat, kQuat );
+    RETURN_BINARY_TYPE_IF( Rgb, kRgb );
+    RETURN_BINARY_TYPE_IF( Rgba, kRgba );
+
+    // All other values are written by a BinaryVariantStream
+    return kPacked;
+}
+
+#undef RETURN_BINARY_TYPE_IF
+
+// ** BinaryValue::type
+const ::DC_DREEMCHEST_NS Type* BinaryValue::type( Type value )
+{
+    switch( value ) {
+    case kBoolean:  return ::DC_DREEMCHEST_NS Type::fromClass<bool>();
+    case kInt8:     return ::DC_DREEMCHEST_NS Type::fromClass<s8>();
+    case kUInt8:    return ::DC_DREEMCHEST_NS Type::fromClass<u8>();
+    case kInt16:    return ::DC_DREEMCHEST_NS Type::fromClass<s16>();
+    case kUInt16:   return ::DC_DREEMCHEST_NS Type::fromClass<u16>();
+    case kInt32:    return ::DC_DREEMCHEST_NS Type::fromClass<s32>();
+    case kUInt32:   return ::DC_DREEMCHEST_NS Type::fromClass<u32>();
+    case kInt64:    return ::DC_DREEMCHEST_NS Type::fromClass<s64>();
+    case kUInt64:   return ::DC_DREEMCHEST_NS Type::fromClass<u64>();
+    case kFloat32:  return ::DC_DREEMCHEST_NS Type::fromClass<f32>();
+    case kFloat64:  return ::DC_DREEMCHEST_NS Type::fromClass<f64>();
+    case kString:   return ::DC_DREEMCHEST_NS Type::fromClass<String>();
+    case kGuid:     return ::DC_DREEMCHEST_NS Type::fromClass<Guid>();
+    case kVec2:     return ::DC_DREEMCHEST_NS Type::fromClass<Vec2>();
+    case kVec3:     return ::DC_DREEMCHEST_NS Type::fromClass<Vec3>();
+    case kVec4:     return ::DC_DREEMCHEST_NS Type::fromClass<Vec4>();
+    case kQuat:     return ::DC_DREEMCHEST_NS Type::fromClass<Quat>();
+    case kRgb:      return ::DC_DREEMCHEST_NS Type::fromClass<Rgb>();
+    case kRgba:     return ::DC_DREEMCHEST_NS Type::fromClass<Rgba>();
+    default:        break;
+    }
+
+    return NULL;
+}
+
+// ** BinaryValue::isValidType
+bool BinaryValue::isValidType( u8 value )
+{
+    return value < kTotalTypes;
+}
+
+// ** BinaryValue::size
+s32 BinaryValue::size( Type type )
+{
+    switch( type ) {
+    case kNull:     return 0;
+    case kBoolean:  return 1;
+    case kInt8:     return 1;
+    case kUInt8:    return 1;
+    case kInt16:    return 2;
+    case kUInt16:   return 2;
+    case kInt32:    return 4;
+    case kUInt32:   return 4;
+    case kInt64:    return 8;
+    case kUInt64:   return 8;
+    case kFloat32:  return 4;
+    case kFloat64:  return 8;
+    case kGuid:     return Guid::Size;
+    case kVec2:     return 8;
+    case kVec3:     return 12;
+    case kVec4:     return 16;
+    case kQuat:     return 16;
+    case kRgb:      return 12;
+    case kRgba:     return 16;
+    default:        break;
+    }
+
+    return -1;
+}
+
+// ** BinaryValue::encode
+void BinaryValue::encode( Type type, const Variant& value, u8* output )
+{
+    #define ENCODE_POD( TValue ) { TValue v = value.as<TValue>(); memcpy( output, &v, sizeof( TValue ) ); }
+    #define ENCODE_FLOATS( ... ) { f32 v[] = { __VA_ARGS__ }; memcpy( output, v, sizeof( v ) ); }
+
+    switch( type ) {
+    case kNull:     break;
+    case kBoolean:  output[0] = value.as<bool>() ? 1 : 0;   break;
+    case kInt8:     ENCODE_POD( s8 );                       break;
+    case kUInt8:    ENCODE_POD( u8 );                       break;
+    case kInt16:    ENCODE_POD( s16 );                      break;
+    case kUInt16:   ENCODE_POD( u16 );                      break;
+    case kInt32:    ENCODE_POD( s32 );                      break;
+    case kUInt32:   ENCODE_POD( u32 );                      break;
+    case kInt64:    ENCODE_POD( s64 );                      break;
+    case kUInt64:   ENCODE_POD( u64 );                      break;
+    case kFloat32:  ENCODE_POD( f32 );                      break;
+    case kFloat64:  ENCODE_POD( f64 );                      break;
+    case kGuid:     memcpy( output, value.as<Guid>().bytes(), Guid::Size );
+                    break;
+    case kVec2:     { Vec2 v = value.as<Vec2>(); ENCODE_FLOATS( v.x, v.y ); }
+                    break;
+    case kVec3:     { Vec3 v = value.as<Vec3>(); ENCODE_FLOATS( v.x, v.y, v.z ); }
+                    break;
+    case kVec4:     { Vec4 v = value.as<Vec4>(); ENCODE_FLOATS( v.x, v.y, v.z, v.w ); }
+                    break;
+    case kQuat:     { Quat v = value.as<Quat>(); ENCODE_FLOATS( v.x, v.y, v.z, v.w ); }
+                    break;
+    case kRgb:      { Rgb v = value.as<Rgb>(); ENCODE_FLOATS( v.r, v.g, v.b ); }
+                    break;
+    case kRgba:     { Rgba v = value.as<Rgba>(); ENCODE_FLOATS( v.r, v.g, v.b, v.a ); }
+                    break;
+    default:        NIMBLE_BREAK_IF( true, "only fixed-size values could be encoded" );
+    }
+
+    #undef ENCODE_POD
+    #undef ENCODE_FLOATS
+}
+
+// ** BinaryValue::decode
+Variant BinaryValue::decode( Type type, const u8* input )
+{
+    #define DECODE_POD( TValue ) { TValue v; memcpy( &v, input, sizeof( TValue ) ); return Variant::fromValue<TValue>( v ); }
+
+    // Floats are copied out because a value may start at an unaligned offset
+    f32 floats[4];
+
+    if( type >= kVec2 && type <= kRgba ) {
+        memcpy( floats, input, size( type ) );
+    }
+
+    switch( type ) {
+    case kNull:     break;
+    case kBoolean:  return Variant::fromValue<bool>( input[0] != 0 );
+    case kInt8:     DECODE_POD( s8 );
+    case kUInt8:    DECODE_POD( u8 );
+    case kInt16:    DECODE_POD( s16 );
+    case kUInt16:   DECODE_POD( u16 );
+    case kInt32:    DECODE_POD( s32 );
+    case kUInt32:   DECODE_POD( u32 );
+    case kInt64:    DECODE_POD( s64 );
+    case kUInt64:   DECODE_POD( u64 );
+    case kFloat32:  DECODE_POD( f32 );
+    case kFloat64:  DECODE_POD( f64 );
+    case kGuid:     return Variant::fromValue<Guid>( Guid( input ) );
+    case kVec2:     {
+                        Vec2 v;
+                        v.x = floats[0]; v.y = floats[1];
+                        return Variant::fromValue<Vec2>( v );
+                    }
+    case kVec3:     {
+                        Vec3 v;
+                        v.x = floats[0]; v.y = floats[1]; v.z = floats[2];
+                        return Variant::fromValue<Vec3>( v );
+                    }
+    case kVec4:     {
+                        Vec4 v;
+                        v.x = floats[0]; v.y = floats[1]; v.z = floats[2]; v.w = floats[3];
+                        return Variant::fromValue<Vec4>( v );
+                    }
+    case kQuat:     {
+                        Quat v;
+                        v.x = floats[0]; v.y = floats[1]; v.z = floats[2]; v.w = floats[3];
+                        return Variant::fromValue<Quat>( v );
+                    }
+    case kRgb:      {
+                        Rgb v;
+                        v.r = floats[0]; v.g = floats[1]; v.b = floats[2];
+                        return Variant::fromValue<Rgb>( v );
+                    }
+    case kRgba:     {
+                        Rgba v;
+                        v.r = floats[0]; v.g = floats[1]; v.b = floats[2]; v.a = floats[3];
+                        return Variant::fromValue<Rgba>( v );
+                    }
+    default:        NIMBLE_BREAK_IF( true, "only fixed-size values could be decoded" );
+    }
+
+    #undef DECODE_POD
+
+    return Variant();
+}
+
+// ** BinaryValue::encode
+void BinaryValue::encode( Type type, const Property& property, const InstanceConst& instance, u8* output )
+{
+    #define ENCODE_POD( TValue ) { TValue v = property.get<TValue>( instance ); memcpy( output, &v, sizeof( TValue ) ); }
+    #define ENCODE_FLOATS( ... ) { f32 v[] = { __VA_ARGS__ }; memcpy( output, v, sizeof( v ) ); }
+
+    switch( type ) {
+    case kNull:     break;
+    case kBoolean:  output[0] = property.get<bool>( instance ) ? 1 : 0;  break;
+    case kInt8:     ENCODE_POD( s8 );                                   break;
+    case kUInt8:    ENCODE_POD( u8 );                                   break;
+    case kInt16:    ENCODE_POD( s16 );                                  break;
+    case kUInt16:   ENCODE_POD( u16 );                                  break;
+    case kInt32:    ENCODE_POD( s32 );                                  break;
+    case kUInt32:   ENCODE_POD( u32 );                                  break;
+    case kInt64:    ENCODE_POD( s64 );                                  break;
+    case kUInt64:   ENCODE_POD( u64 );                                  break;
+    case kFloat32:  ENCODE_POD( f32 );                                  break;
+    case kFloat64:  ENCODE_POD( f64 );                                  break;
+    case kGuid:     memcpy( output, property.get<Guid>( instance ).bytes(), Guid::Size );
+                    break;
+    case kVec2:     { Vec2 v = property.get<Vec2>( instance ); ENCODE_FLOATS( v.x, v.y ); }
+                    break;
+    case kVec3:     { Vec3 v = property.get<Vec3>( instance ); ENCODE_FLOATS( v.x, v.y, v.z ); }
+                    break;
+    case kVec4:     { Vec4 v = property.get<Vec4>( instance ); ENCODE_FLOATS( v.x, v.y, v.z, v.w ); }
+                    break;
+    case kQuat:     { Quat v = property.get<Quat>( instance ); ENCODE_FLOATS( v.x, v.y, v.z, v.w ); }
+                    break;
+    case kRgb:      { Rgb v = property.get<Rgb>( instance ); ENCODE_FLOATS( v.r, v.g, v.b ); }
+                    break;
+    case kRgba:     { Rgba v = property.get<Rgba>( instance ); ENCODE_FLOATS( v.r, v.g, v.b, v.a ); }
+                    break;
+    default:        NIMBLE_BREAK_IF( true, "only fixed-size values could be encoded" );
+    }
+
+    #undef ENCODE_POD
+    #undef ENCODE_FLOATS
+}
+
+// ** BinaryValue::decode
+void BinaryValue::decode( Type type, const u8* input, const Property& property, const Instance& instance )
+{
+    #define DECODE_POD( TValue ) { TValue v; memcpy( &v, input, sizeof( TValue ) ); property.set<TValue>( instance, v ); }
+
+    // Floats are copied out because a value may start at an unaligned offset
+    f32 floats[4];
+
+    if( type >= kVec2 && type <= kRgba ) {
+        memcpy( floats, input, size( type ) );
+    }
+
+    switch( type ) {
+    case kNull:     break;
+    case kBoolean:  property.set<bool>( instance, input[0] != 0 );      break;
+    case kInt8:     DECODE_POD( s8 );                                   break;
+    case kUInt8:    DECODE_POD( u8 );                                   break;
+    case kInt16:    DECODE_POD( s16 );                                  break;
+    case kUInt16:   DECODE_POD( u16 );                                  break;
+    case kInt32:    DECODE_POD( s32 );                                  break;
+    case kUInt32:   DECODE_POD( u32 );                                  break;
+    case kInt64:    DECODE_POD( s64 );                                  break;
+    case kUInt64:   DECODE_POD( u64 );                                  break;
+    case kFloat32:  DECODE_POD( f32 );                                  break;
+    case kFloat64:  DECODE_POD( f64 );                                  break;
+    case kGuid:     property.set<Guid>( instance, Guid( input ) );      break;
+    case kVec2:     {
+                        Vec2 v;
+                        v.x = floats[0]; v.y = floats[1];
+                        property.set<Vec2>( instance, v );
+                    }
+                    break;
+    case kVec3:     {
+                        Vec3 v;
+                        v.x = floats[0]; v.y = floats[1]; v.z = floats[2];
+                        property.set<Vec3>( instance, v );
+                    }
+                    break;
+    case kVec4:     {
+                        Vec4 v;
+                        v.x = floats[0]; v.y = floats[1]; v.z = floats[2]; v.w = floats[3];
+                        property.set<Vec4>( instance, v );
+                    }
+                    break;
+    case kQuat:     {
+                        Quat v;
+                        v.x = floats[0]; v.y = floats[1]; v.z = floats[2]; v.w = floats[3];
+                        property.set<Quat>( instance, v );
+                    }
+                    break;
+    case kRgb:      {
+                        Rgb v;
+                        v.r = floats[0]; v.g = floats[1]; v.b = floats[2];
+                        property.set<Rgb>( instance, v );
+                    }
+                    break;
+    case kRgba:     {
+                        Rgba v;
+                        v.r = floats[0]; v.g = floats[1]; v.b = floats[2]; v.a = floats[3];
+                        property.set<Rgba>( instance, v );
+                    }
+                    break;
+    default:        NIMBLE_BREAK_IF( true, "only fixed-size values could be decoded" );
+    }
+
+    #undef DECODE_POD
+}
+
+// ** BinaryValue::write
+void BinaryValue::write( Io::StreamWPtr stream, Type type, const Variant& value )
+{
+    switch( type ) {
+    case kString:   {
+                        String v = value.as<String>();
+                        u32 length = static_cast<u32>( v.length() );
+                        stream->write( &length, 4 );
+                        stream->write( v.c_str(), length );
+                    }
+                    break;
+    case kPacked:   {
+                        // Write a value to a temporary buffer and then copy it with a size prefix
+                        Io::ByteBufferPtr buffer = Io::ByteBuffer::create();
+                        Io::BinaryVariantStream( buffer ).write( value );
+
+                        u32 length = static_cast<u32>( buffer->length() );
+                        stream->write( &length, 4 );
+                        stream->write( buffer->buffer(), length );
+                    }
+                    break;
+    default:        {
+                        u8 bytes[32];
+                        s32 length = size( type );
+                        NIMBLE_BREAK_IF( length < 0 || length > static_cast<s32>( sizeof( bytes ) ), "unexpected value size" );
+                        encode( type, value, bytes );
+                        stream->write( bytes, length );
+                    }
+    }
+}
+
+// ** BinaryValue::readBytes
+bool BinaryValue::readBytes( Io::StreamWPtr stream, void* buffer, s32 size )
+{
+    if( size == 0 ) {
+        return true;
+    }
+
+    if( size < 0 || size > stream->length() - stream->position() ) {
+        return false;
+    }
+
+    return stream->read( buffer, size ) == size;
+}
+
+// ** BinaryValue::read
+bool BinaryValue::read( Io::StreamWPtr stream, Type type, Variant& value )
+{
+    switch( type ) {
+    case kNull:     value = Variant();
+                    return true;
+    case kString:   {
+                        u32 length;
+
+                        // Reject length prefixes that exceed the rest of a stream
+                        if( !readBytes( stream, &length, 4 ) || length > static_cast<u32>( stream->length() - stream->position() ) ) {
+                            return false;
+                        }
+
+                        String v;
+                        v.resize( length );
+
+                        if( length && !readBytes( stream, &v[0], length ) ) {
+                            return false;
+                        }
+
+                        value = Variant::fromValue<String>( v );
+                        return true;
+                    }
+    case kPacked:   {
+                        u32 length;
+
+                        if( !readBytes( stream, &length, 4 ) || length > static_cast<u32>( stream->length() - stream->position() ) ) {
+                            return false;
+                        }
+
+                        Array<u8> bytes;
+                        bytes.resize( length );
+
+                        if( length && !readBytes( stream, &bytes[0], length ) ) {
+                            return false;
+                        }
+
+                        value = Variant();
+                        Io::BinaryVariantStream( Io::ByteBuffer::createFromArray( bytes ) ).read( value );
+                        return true;
+                    }
+    default:        {
+                        u8 bytes[32];
+                        s32 length = size( type );
+
+                        if( length < 0 || length > static_cast<s32>( sizeof( bytes ) ) || !readBytes( stream, bytes, length ) ) {
+                            return false;
+                        }
+
+                        value = decode( type, bytes );
+                        return true;
+                    }
+    }
+
+    return false;
+}
+
+// ** BinaryValue::skip
+bool BinaryValue::skip( Io::StreamWPtr stream, Type type )
+{
+    s32 length = size( type );
+
+    // Variable-sized values are prefixed with a size
+    if( length < 0 ) {
+        u32 prefix;
+
+        if( !readBytes( stream, &prefix, 4 ) || prefix > static_cast<u32>( stream->length() - stream->position() ) ) {
+            return false;
+        }
+
+        length = static_cast<s32>( prefix );
+    }
+
+    if( length > stream->length() - stream->position() ) {
+        return false;
+    }
+
+    stream->setPosition( length, Io::SeekCur );
+    return true;
+}
+
+} // namespace Reflection
+
+DC_END_DREEMCHEST
@@ -0,0 +1,114 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Reflection_BinaryValue_H__
+#define __DC_Reflection_BinaryValue_H__
+
+#include "../Reflection.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Reflection {
+
+    //! Encodes and decodes property values to a compact binary form without type tags.
+    /*!
+    A value type is expected to be stored once by a caller (inside a class schema or a table),
+    so only a raw value is written to a stream.
+    */
+    class BinaryValue {
+    public:
+
+        //! Available binary value types.
+        enum Type {
+              kNull             //!< No value is stored.
+            , kBoolean          //!< A single byte boolean value.
+            , kInt8             //!< A signed 8 bit integer.
+            , kUInt8            //!< An unsigned 8 bit integer.
+            , kInt16            //!< A signed 16 bit integer.
+            , kUInt16           //!< An unsigned 16 bit integer.
+            , kInt32            //!< A signed 32 bit integer.
+            , kUInt32           //!< An unsigned 32 bit integer.
+            , kInt64            //!< A signed 64 bit integer.
+            , kUInt64           //!< An unsigned 64 bit integer.
+            , kFloat32          //!< A single precision floating point value.
+            , kFloat64          //!< A double precision floating point value.
+            , kString           //!< A length-prefixed string.
+            , kGuid             //!< A 16 byte unique identifier.
+            , kVec2             //!< Two floats.
+            , kVec3             //!< Three floats.
+            , kVec4             //!< Four floats.
+            , kQuat             //!< Four floats of a quaternion.
+            , kRgb              //!< Three floats of a color.
+            , kRgba             //!< Four floats of a color with alpha.
+            , kPacked           //!< A size-prefixed value written by a BinaryVariantStream (arrays, key-value objects and custom types).
+            , kTotalTypes
+        };
+
+        //! Returns a binary value type for a specified variant.
+        static Type                 typeOf( const Variant& value );
+
+        //! Returns a binary value type for a specified runtime type.
+        static Type                 typeOf( const ::DC_DREEMCHEST_NS Type* type );
+
+        //! Returns a runtime type that corresponds to a binary value type.
+        static const ::DC_DREEMCHEST_NS Type* type( Type value );
+
+        //! Returns true if a stored type tag is a valid binary value type.
+        static bool                 isValidType( u8 value );
+
+        //! Returns a size of a fixed-size value in bytes or -1 for variable-sized values.
+        static s32                  size( Type type );
+
+        //! Encodes a fixed-size value to a memory buffer.
+        static void                 encode( Type type, const Variant& value, u8* output );
+
+        //! Decodes a fixed-size value from a memory buffer.
+        static Variant              decode( Type type, const u8* input );
+
+        //! Encodes a fixed-size property value to a memory buffer without boxing it to a Variant.
+        static void                 encode( Type type, const Property& property, const InstanceConst& instance, u8* output );
+
+        //! Decodes a fixed-size value from a memory buffer and writes it to a property without boxing it to a Variant.
+        static void                 decode( Type type, const u8* input, const Property& property, const Instance& instance );
+
+        //! Writes a value of any type to a stream.
+        static void                 write( Io::StreamWPtr stream, Type type, const Variant& value );
+
+        //! Reads a value of any type from a stream, returns false if a stream is truncated or malformed.
+        static bool                 read( Io::StreamWPtr stream, Type type, Variant& value );
+
+        //! Skips a value of any type inside a stream, returns false if a stream is truncated.
+        static bool                 skip( Io::StreamWPtr stream, Type type );
+
+        //! Reads an exact number of bytes from a stream, returns false if less bytes are left.
+        static bool                 readBytes( Io::StreamWPtr stream, void* buffer, s32 size );
+    };
+
+} // namespace Reflection
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Reflection_BinaryValue_H__    */
@@ -0,0 +1,132 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "Schema.h"
+
+#include "../MetaObject/Class.h"
+#include "../MetaObject/Property.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Reflection {
+
+// ** Schema::Schema
+Schema::Schema( const Class* cls )
+    : m_class( cls )
+    , m_hash( cls->hash() )
+    , m_fixedFieldCount( 0 )
+    , m_fixedSize( 0 )
+{
+    Array<Field> variable;
+
+    for( s32 i = 0, n = cls->memberCount(); i < n; i++ ) {
+        const Property* property = cls->member( i )->isProperty();
+
+        if( !property ) {
+            continue;
+        }
+
+        Field field;
+        field.property = property;
+        field.member   = i;
+        field.name     = property->hash();
+        field.type     = BinaryValue::typeOf( property->type() );
+        field.offset   = -1;
+
+        // Fixed-size fields are packed to a contiguous block
+        s32 size = BinaryValue::size( field.type );
+
+        if( size >= 0 ) {
+            field.offset  = m_fixedSize;
+            m_fixedSize  += size;
+            m_fields.push_back( field );
+        } else {
+            variable.push_back( field );
+        }
+    }
+
+    m_fixedFieldCount = static_cast<s32>( m_fields.size() );
+    m_fields.insert( m_fields.end(), variable.begin(), variable.end() );
+
+    // Mix all field names and types into a schema hash
+    for( s32 i = 0, n = fieldCount(); i < n; i++ ) {
+        m_hash = (m_hash * 33) ^ m_fields[i].name;
+        m_hash = (m_hash * 33) ^ static_cast<u32>( m_fields[i].type );
+    }
+}
+
+// ** Schema::cls
+const Class* Schema::cls( void ) const
+{
+    return m_class;
+}
+
+// ** Schema::hash
+u32 Schema::hash( void ) const
+{
+    return m_hash;
+}
+
+// ** Schema::fieldCount
+s32 Schema::fieldCount( void ) const
+{
+    return static_cast<s32>( m_fields.size() );
+}
+
+// ** Schema::field
+const Schema::Field& Schema::field( s32 index ) const
+{
+    NIMBLE_ABORT_IF( index < 0 || index >= fieldCount(), "index is out of range" );
+    return m_fields[index];
+}
+
+// ** Schema::fixedFieldCount
+s32 Schema::fixedFieldCount( void ) const
+{
+    return m_fixedFieldCount;
+}
+
+// ** Schema::fixedSize
+s32 Schema::fixedSize( void ) const
+{
+    return m_fixedSize;
+}
+
+// ** Schema::findField
+s32 Schema::findField( u32 name ) const
+{
+    for( s32 i = 0, n = fieldCount(); i < n; i++ ) {
+        if( m_fields[i].name == name ) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+} // namespace Reflection
+
+DC_END_DREEMCHEST
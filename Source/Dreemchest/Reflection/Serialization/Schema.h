@@ -0,0 +1,91 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Reflection_Schema_H__
+#define __DC_Reflection_Schema_H__
+
+#include "BinaryValue.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Reflection {
+
+    //! A binary layout of class properties that is generated once per class.
+    /*!
+    Fixed-size properties are laid out first in a contiguous block with precomputed offsets,
+    followed by variable-sized properties. A schema hash is calculated from a class name
+    and property names and types, so archives written with an older class layout can be detected.
+    */
+    class Schema {
+    public:
+
+        //! A single schema field.
+        struct Field {
+            const Property*     property;   //!< A class property.
+            s32                 member;     //!< A property member index inside a class.
+            u32                 name;       //!< A property name hash.
+            BinaryValue::Type   type;       //!< A property value type.
+            s32                 offset;     //!< A field offset inside a fixed-size block or -1 for variable-sized fields.
+        };
+
+                                //! Constructs Schema instance for a specified class.
+        explicit                Schema( const Class* cls );
+
+        //! Returns a class this schema was generated for.
+        const Class*            cls( void ) const;
+
+        //! Returns a schema hash.
+        u32                     hash( void ) const;
+
+        //! Returns the total number of fields.
+        s32                     fieldCount( void ) const;
+
+        //! Returns a field at specified index.
+        const Field&            field( s32 index ) const;
+
+        //! Returns the total number of fixed-size fields, they are always the first ones.
+        s32                     fixedFieldCount( void ) const;
+
+        //! Returns a size of a fixed-size block in bytes.
+        s32                     fixedSize( void ) const;
+
+        //! Returns an index of a field with a specified name hash or -1 if there is no such field.
+        s32                     findField( u32 name ) const;
+
+    private:
+
+        const Class*            m_class;            //!< A parent class.
+        u32                     m_hash;             //!< A schema hash value.
+        Array<Field>            m_fields;           //!< Schema fields.
+        s32                     m_fixedFieldCount;  //!< The total number of fixed-size fields.
+        s32                     m_fixedSize;        //!< A total size of fixed-size fields.
+    };
+
+} // namespace Reflection
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Reflection_Schema_H__    */
@@ -30,6 +30,7 @@
 #include "../MetaObject/Class.h"
 #include "../MetaObject/Property.h"
 #include "../MetaObject/Instance.h"
+#include "../MetaObject/Iterator.h"
 
 DC_BEGIN_DREEMCHEST
 
@@ -158,6 +159,288 @@ void Serializer::deserialize( const Instance& instance, const KeyValue& ar ) con
     }
 }
 
+// ** Serializer::serialize
+bool Serializer::serialize( InstanceConst instance, BinaryArchive& ar ) const
+{
+    NIMBLE_ABORT_IF( !instance, "invalid instance" );
+
+    // Get the meta-class and it's binary layout
+    const Class*   cls    = instance.type();
+    const Schema&  schema = cls->schema();
+    Io::StreamWPtr stream = ar.stream();
+
+    // Write the record header, a schema description is written only once per archive
+    u32 hash  = schema.hash();
+    u8  flags = ar.embedSchemas() && ar.markSchemaWritten( hash ) ? BinaryArchive::SchemaFollows : 0;
+
+    stream->write( &hash, 4 );
+    stream->write( &flags, 1 );
+
+    if( flags & BinaryArchive::SchemaFollows ) {
+        u16 count = static_cast<u16>( schema.fieldCount() );
+
+        BinaryValue::write( stream, BinaryValue::kString, Variant::fromValue<String>( cls->name() ) );
+        stream->write( &count, 2 );
+
+        for( u16 i = 0; i < count; i++ ) {
+            const Schema::Field& field = schema.field( i );
+            u8 type = field.type;
+            stream->write( &field.name, 4 );
+            stream->write( &type, 1 );
+        }
+    }
+
+    // Encode fixed-size fields to a contiguous block and write it at once
+    if( s32 size = schema.fixedSize() ) {
+        Array<u8>& block = ar.scratch();
+        block.resize( size );
+
+        for( s32 i = 0, n = schema.fixedFieldCount(); i < n; i++ ) {
+            const Schema::Field& field = schema.field( i );
+            BinaryValue::encode( field.type, *field.property, instance, &block[field.offset] );
+        }
+
+        stream->write( &block[0], size );
+    }
+
+    // Now write variable-sized fields
+    for( s32 i = schema.fixedFieldCount(), n = schema.fieldCount(); i < n; i++ ) {
+        const Schema::Field& field = schema.field( i );
+        writeBinaryField( *cls, *field.property, field.type, instance, stream );
+    }
+
+    return true;
+}
+
+// ** Serializer::deserialize
+Instance Serializer::deserialize( AssemblyWPtr assembly, BinaryArchive& ar ) const
+{
+    NIMBLE_ABORT_IF( !assembly.valid(), "invalid assembly" );
+
+    // Read the record header
+    u32 hash;
+    const BinaryArchive::StoredSchema* stored;
+
+    if( !readBinaryHeader( ar, hash, stored ) ) {
+        return Instance();
+    }
+
+    if( !stored ) {
+        LogError( "serializer", "record with schema %x has no embedded schema description\n", hash );
+        return Instance();
+    }
+
+    // Construct class instance by name
+    Instance instance = assembly->createInstance( stored->className );
+
+    if( !instance ) {
+        LogError( "serializer", "unresolved class '%s'\n", stored->className.c_str() );
+
+        // Skip all record values
+        for( s32 i = 0, n = static_cast<s32>( stored->types.size() ); i < n; i++ ) {
+            if( !BinaryValue::skip( ar.stream(), static_cast<BinaryValue::Type>( stored->types[i] ) ) ) {
+                LogError( "serializer", "'%s' record is truncated\n", stored->className.c_str() );
+                break;
+            }
+        }
+
+        return instance;
+    }
+
+    // Read instance properties
+    if( !readBinaryBody( instance, ar, hash, stored ) ) {
+        return Instance();
+    }
+
+    return instance;
+}
+
+// ** Serializer::deserialize
+bool Serializer::deserialize( const Instance& instance, BinaryArchive& ar ) const
+{
+    NIMBLE_ABORT_IF( !instance, "invalid instance" );
+
+    u32 hash;
+    const BinaryArchive::StoredSchema* stored;
+
+    if( !readBinaryHeader( ar, hash, stored ) ) {
+        return false;
+    }
+
+    return readBinaryBody( instance, ar, hash, stored );
+}
+
+// ** Serializer::readBinaryHeader
+bool Serializer::readBinaryHeader( BinaryArchive& ar, u32& hash, const BinaryArchive::StoredSchema*& stored ) const
+{
+    Io::StreamWPtr stream = ar.stream();
+
+    u8 flags;
+
+    if( !BinaryValue::readBytes( stream, &hash, 4 ) || !BinaryValue::readBytes( stream, &flags, 1 ) ) {
+        LogError( "serializer", "record header is truncated\n" );
+        return false;
+    }
+
+    // Register a schema description that follows the header
+    if( flags & BinaryArchive::SchemaFollows ) {
+        BinaryArchive::StoredSchema schema;
+        Variant                     className;
+        u16                         count;
+
+        if( !BinaryValue::read( stream, BinaryValue::kString, className ) || !BinaryValue::readBytes( stream, &count, 2 ) ) {
+            LogError( "serializer", "schema %x description is truncated\n", hash );
+            return false;
+        }
+
+        schema.className = className.as<String>();
+        schema.names.resize( count );
+        schema.types.resize( count );
+
+        for( u16 i = 0; i < count; i++ ) {
+            if( !BinaryValue::readBytes( stream, &schema.names[i], 4 ) || !BinaryValue::readBytes( stream, &schema.types[i], 1 ) ) {
+                LogError( "serializer", "schema %x description is truncated\n", hash );
+                return false;
+            }
+
+            // Type tags are later cast to a BinaryValue::Type, so reject unknown ones here
+            if( !BinaryValue::isValidType( schema.types[i] ) ) {
+                LogError( "serializer", "schema %x has a field with an unknown type %d\n", hash, schema.types[i] );
+                return false;
+            }
+        }
+
+        ar.addStoredSchema( hash, schema );
+    }
+
+    stored = ar.findStoredSchema( hash );
+    return true;
+}
+
+// ** Serializer::readBinaryBody
+bool Serializer::readBinaryBody( const Instance& instance, BinaryArchive& ar, u32 hash, const BinaryArchive::StoredSchema* stored ) const
+{
+    const Class*   cls    = instance.type();
+    const Schema&  schema = cls->schema();
+    Io::StreamWPtr stream = ar.stream();
+
+    // The record was written with the same class layout, so read a fixed-size block at once
+    if( hash == schema.hash() ) {
+        if( s32 size = schema.fixedSize() ) {
+            Array<u8>& block = ar.scratch();
+            block.resize( size );
+
+            if( !BinaryValue::readBytes( stream, &block[0], size ) ) {
+                LogError( "serializer", "%s record is truncated\n", cls->name() );
+                return false;
+            }
+
+            for( s32 i = 0, n = schema.fixedFieldCount(); i < n; i++ ) {
+                const Schema::Field& field = schema.field( i );
+                BinaryValue::decode( field.type, &block[field.offset], *field.property, instance );
+            }
+        }
+
+        for( s32 i = schema.fixedFieldCount(), n = schema.fieldCount(); i < n; i++ ) {
+            const Schema::Field& field = schema.field( i );
+
+            if( !readBinaryField( *cls, *field.property, field.type, instance, stream ) ) {
+                LogError( "serializer", "%s record is truncated\n", cls->name() );
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // The record layout is unknown and could not be skipped
+    if( !stored ) {
+        LogError( "serializer", "%s record has an unknown schema %x\n", cls->name(), hash );
+        return false;
+    }
+
+    // Otherwise match stored fields by name hashes and skip the missing or changed ones
+    for( s32 i = 0, n = static_cast<s32>( stored->types.size() ); i < n; i++ ) {
+        BinaryValue::Type type  = static_cast<BinaryValue::Type>( stored->types[i] );
+        s32               index = schema.findField( stored->names[i] );
+        bool              result;
+
+        if( index < 0 || schema.field( index ).type != type ) {
+            result = BinaryValue::skip( stream, type );
+        } else {
+            result = readBinaryField( *cls, *schema.field( index ).property, type, instance, stream );
+        }
+
+        if( !result ) {
+            LogError( "serializer", "%s record is truncated\n", cls->name() );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ** Serializer::writeBinaryField
+void Serializer::writeBinaryField( const Class& cls, const Property& property, BinaryValue::Type type, const InstanceConst& instance, Io::StreamWPtr stream ) const
+{
+    // Values with a binary encoding are written as is
+    if( type != BinaryValue::kPacked ) {
+        BinaryValue::write( stream, type, property.get( instance ) );
+        return;
+    }
+
+    // Other values are converted the same way as for a key-value storage
+    KeyValue          kv;
+    ConstIteratorUPtr iterator = property.iterator( instance );
+
+    if( const Reflection::ListIterator* list = iterator.get() ? iterator->isList() : NULL ) {
+        serializeList( cls, property, instance, *list, kv );
+    }
+    else if( const Reflection::MapIterator* map = iterator.get() ? iterator->isMap() : NULL ) {
+        serializeMap( cls, property, instance, *map, kv );
+    }
+    else {
+        serializeValue( cls, property, instance, kv );
+    }
+
+    BinaryValue::write( stream, type, kv.valueAtKey( property.name() ) );
+}
+
+// ** Serializer::readBinaryField
+bool Serializer::readBinaryField( const Class& cls, const Property& property, BinaryValue::Type type, const Instance& instance, Io::StreamWPtr stream ) const
+{
+    Variant value;
+
+    if( !BinaryValue::read( stream, type, value ) ) {
+        return false;
+    }
+
+    if( !value.isValid() ) {
+        return true;
+    }
+
+    // Values with a binary encoding have the same type as a property
+    if( type != BinaryValue::kPacked ) {
+        property.set( instance, value );
+        return true;
+    }
+
+    // Other values may require a type conversion
+    IteratorUPtr iterator = property.iterator( instance );
+
+    if( Reflection::ListIterator* list = iterator.get() ? iterator->isList() : NULL ) {
+        deserializeList( cls, property, instance, value, *list );
+    }
+    else if( Reflection::MapIterator* map = iterator.get() ? iterator->isMap() : NULL ) {
+        deserializeMap( cls, property, instance, value, *map );
+    }
+    else {
+        deserializeValue( cls, property, instance, value );
+    }
+
+    return true;
+}
+
 // ** Serializer::deserializeList
 void Serializer::deserializeList( const Class& cls, const Property& property, const Instance& instance, const Variant& value, Reflection::ListIterator& iterator ) const
 {
@@ -300,7 +583,7 @@ Variant Serializer::readPropertyValue( const Class* cls, const Property* propert
     }
 
     // No value inside an archive - try a default one
-    PropertyDefaults::const_iterator i = m_defaults.find( calculatePropertyReaderHash( cls, property->name() ) );
+    PropertyDefaults::const_iterator i = m_defaults.find( calculatePropertyReaderHash( cls, property->hash() ) );
 
     if( i != m_defaults.end() ) {
         return i->second( ar );
@@ -311,9 +594,9 @@ Variant Serializer::readPropertyValue( const Class* cls, const Property* propert
 }
 
 // ** Serializer::calculatePropertyReaderHash
-String64 Serializer::calculatePropertyReaderHash( const Class* cls, CString name ) const
+u64 Serializer::calculatePropertyReaderHash( const Class* cls, u32 name ) const
 {
-    return String64( (String( cls->name() ) + "." + name).c_str() );
+    return static_cast<u64>( cls->hash() ) << 32 | name;
 }
 
 // ** Serializer::calculateTypeConverterHash
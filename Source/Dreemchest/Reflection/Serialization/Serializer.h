@@ -27,7 +27,8 @@
 #ifndef __DC_Reflection_Serializer_H__
 #define __DC_Reflection_Serializer_H__
 
-#include "../Reflection.h"
+#include "BinaryArchive.h"
+#include "../MetaObject/MetaObject.h"
 
 DC_BEGIN_DREEMCHEST
 
@@ -54,6 +55,15 @@ namespace Reflection {
         //! Reads instance properties from a key-value storage.
         void                    deserialize( const Instance& instance, const KeyValue& ar ) const;
 
+        //! Writes an object instance to a compact binary archive.
+        bool                    serialize( InstanceConst instance, BinaryArchive& ar ) const;
+
+        //! Reads an object instance from a compact binary archive, a class is resolved by an embedded schema.
+        Instance                deserialize( AssemblyWPtr assembly, BinaryArchive& ar ) const;
+
+        //! Reads instance properties from a compact binary archive.
+        bool                    deserialize( const Instance& instance, BinaryArchive& ar ) const;
+
         //! Registers a type converter.
         template<typename TFrom, typename TTo>
         void                    registerTypeConverter( const TypeConverter& callback );
@@ -73,8 +83,8 @@ namespace Reflection {
         //! Returns a value converter.
         TypeConverter           findTypeConverter( const Type* from, const Type* to ) const;
 
-        //! Calculates a property reader hash value.
-        String64                calculatePropertyReaderHash( const Class* cls, CString name ) const;
+        //! Calculates a property reader hash value from a class name hash and a property name hash.
+        u64                     calculatePropertyReaderHash( const Class* cls, u32 name ) const;
 
         //! Calculates a type converter hash.
         u64                     calculateTypeConverterHash( const Type* from, const Type* to ) const;
@@ -97,13 +107,25 @@ namespace Reflection {
         //! Serializes a primitive value.
         void                    serializeValue( const Class& cls, const Property& property, const InstanceConst& instance, KeyValue& ar ) const;
 
+        //! Reads a binary record header and an associated schema description, returns false if a header is malformed.
+        bool                    readBinaryHeader( BinaryArchive& ar, u32& hash, const BinaryArchive::StoredSchema*& stored ) const;
+
+        //! Reads binary record values to an instance.
+        bool                    readBinaryBody( const Instance& instance, BinaryArchive& ar, u32 hash, const BinaryArchive::StoredSchema* stored ) const;
+
+        //! Writes a variable-sized property value to a binary stream.
+        void                    writeBinaryField( const Class& cls, const Property& property, BinaryValue::Type type, const InstanceConst& instance, Io::StreamWPtr stream ) const;
+
+        //! Reads a property value from a binary stream, returns false if a stream is truncated or malformed.
+        bool                    readBinaryField( const Class& cls, const Property& property, BinaryValue::Type type, const Instance& instance, Io::StreamWPtr stream ) const;
+
     private:
 
         //! Container type to store type conversions.
         typedef HashMap<u64, TypeConverter> TypeConverters;
 
         //! Container type to store property serializers/deserializers.
-        typedef HashMap<String64, PropertyDefault> PropertyDefaults;
+        typedef HashMap<u64, PropertyDefault> PropertyDefaults;
 
         TypeConverters            m_typeConverters;        //!< Custom type converters.
         PropertyDefaults        m_defaults;                //!< Property default value callbacks.
@@ -121,7 +143,7 @@ namespace Reflection {
     template<typename TType>
     void Serializer::registerPropertyDefault( const String& name, const PropertyDefault& callback )
     {
-        String64 hash = calculatePropertyReaderHash( TType::staticMetaObject(), name.c_str() );
+        u64 hash = calculatePropertyReaderHash( TType::staticMetaObject(), MetaObject::hashName( name.c_str() ) );
         m_defaults[hash] = callback;
     }
 
@@ -25,6 +25,7 @@
  **************************************************************************/
 
 #include "CommandBuffer.h"
+#include "../RenderProfiler.h"
 
 DC_BEGIN_DREEMCHEST
 
@@ -64,6 +65,7 @@ void CommandBuffer::uploadConstantBuffer(ConstantBuffer_ id, const void* data, s
     OpCode opCode;
     opCode.type = OpCode::UploadConstantBuffer;
     opCode.upload.id = id;
+    opCode.upload.offset = 0;
     opCode.upload.buffer = adoptDataBuffer(data, size);
     push( opCode );
 }
@@ -74,6 +76,7 @@ void CommandBuffer::uploadConstantBuffer(ConstantBuffer_ id, const PersistentPoi
     OpCode opCode;
     opCode.type = OpCode::UploadConstantBuffer;
     opCode.upload.id = id;
+    opCode.upload.offset = 0;
     opCode.upload.buffer.data = reinterpret_cast<const u8*>(data.value);
     opCode.upload.buffer.size = size;
     push( opCode );
@@ -85,21 +88,43 @@ void CommandBuffer::uploadVertexBuffer(VertexBuffer_ id, const void* data, s32 s
     OpCode opCode;
     opCode.type = OpCode::UploadVertexBuffer;
     opCode.upload.id = id;
+    opCode.upload.offset = 0;
     opCode.upload.buffer = adoptDataBuffer(data, size);
     push( opCode );
 }
 
 // ** CommandBuffer::uploadVertexBuffer
-void CommandBuffer::uploadVertexBuffer(VertexBuffer_ id, const PersistentPointer& data, s32 size)
+void CommandBuffer::uploadVertexBuffer(VertexBuffer_ id, const PersistentPointer& data, s32 size, s32 offset)
 {
     OpCode opCode;
     opCode.type = OpCode::UploadVertexBuffer;
     opCode.upload.id = id;
+    opCode.upload.offset = offset;
     opCode.upload.buffer.data = reinterpret_cast<const u8*>(data.value);
     opCode.upload.buffer.size = size;
     push( opCode );
 }
  
+// ** CommandBuffer::beginProfileScope
+void CommandBuffer::beginProfileScope(CString name)
+{
+    OpCode opCode;
+    opCode.type = OpCode::BeginProfileScope;
+    opCode.profile.name = name;
+    opCode.profile.timestamp = RenderProfiler::timestamp();
+    push( opCode );
+}
+
+// ** CommandBuffer::endProfileScope
+void CommandBuffer::endProfileScope()
+{
+    OpCode opCode;
+    opCode.type = OpCode::EndProfileScope;
+    opCode.profile.name = NULL;
+    opCode.profile.timestamp = RenderProfiler::timestamp();
+    push( opCode );
+}
+ 
 // ** CommandBuffer::adoptDataBuffer
 OpCode::Buffer CommandBuffer::adoptDataBuffer(const void* data, s32 size)
 {
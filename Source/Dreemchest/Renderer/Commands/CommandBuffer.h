@@ -59,9 +59,15 @@ namespace Renderer
         
         //! Emits a vertex buffer upload command.
         void                        uploadVertexBuffer(VertexBuffer_ id, const void* data, s32 size);
+        
+        //! Emits a command that opens a named profiler scope.
+        void                        beginProfileScope(CString name);
+        
+        //! Emits a command that closes an active profiler scope.
+        void                        endProfileScope();
 
-        //! Emits a vertex buffer upload command.
-        void                        uploadVertexBuffer(VertexBuffer_ id, const PersistentPointer& data, s32 size);
+        //! Emits a vertex buffer upload command that writes a persistent data to a specified buffer offset without copying it.
+        void                        uploadVertexBuffer(VertexBuffer_ id, const PersistentPointer& data, s32 size, s32 offset = 0);
 
     protected:
 
@@ -57,6 +57,8 @@ namespace Renderer
             , DeleteConstantBuffer      //!< Destroys an allocated constant buffer.
             , DeleteProgram             //!< Destroys a program and all it's permutations.
             , PrecompilePermutation     //!< Precompiles a shader program permutation.
+            , BeginProfileScope         //!< Opens a named profiler scope.
+            , EndProfileScope           //!< Closes an active profiler scope.
         };
         
         //! A data buffer used by a command.
@@ -100,6 +102,7 @@ namespace Renderer
             struct
             {
                 ResourceId                  program;                    //!< A passed resource id.
+                ResourceId                  featureLayout;              //!< A feature layout used to generate permutation options.
                 PipelineFeatures            features;                   //!< Passed shader features.
             } precompile;
             
@@ -127,16 +130,23 @@ namespace Renderer
                 const CommandBuffer*        commands;                   //!< A command buffer to be executed.
             } execute;
             
+            struct
+            {
+                CString                     name;                       //!< A scope name, should stay valid until a frame is executed.
+                u64                         timestamp;                  //!< A time in microseconds when this command was recorded.
+            } profile;
+            
             struct
             {
                 ResourceId                  id;                         //!< A target buffer handle.
                 Buffer                      buffer;                     //!< An attached data buffer.
+                s32                         offset;                     //!< A target buffer offset to upload data at.
             } upload;
             
             struct
             {
                 ResourceId                  id;                         //!< Handle to an input layout being constructed.
-                u8                          format;                     //!< Vertex format used by an input layout constructor.
+                u16                         format;                     //!< Vertex format key used by an input layout constructor.
             } createInputLayout;
             
             struct
@@ -144,6 +154,7 @@ namespace Renderer
                 ResourceId                  id;                         //!< Handle to a buffer object being constructed.
                 Buffer                      buffer;                     //!< An attached data buffer.
                 ResourceId                  layout;                     //!< Used by a constant buffer constructor.
+                u8                          indexSize;                  //!< Used by an index buffer constructor.
             } createBuffer;
             
             struct
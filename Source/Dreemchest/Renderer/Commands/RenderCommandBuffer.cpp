@@ -36,7 +36,6 @@ namespace Renderer
 RenderCommandBuffer::RenderCommandBuffer(RenderFrame& frame)
     : m_frame(frame)
     , m_stateStack(frame.stateStack())
-    , m_transientResourceIndex(0)
 {
 }
 
@@ -77,6 +76,29 @@ RenderCommandBuffer& RenderCommandBuffer::renderToTexture(TransientTexture id, u
     return commands;
 }
 
+// ** RenderCommandBuffer::renderToTexture
+RenderCommandBuffer& RenderCommandBuffer::renderToTexture(Texture_ id, u32 options, const Rect& viewport)
+{
+    RenderCommandBuffer& commands = m_frame.createCommandBuffer();
+    
+    OpCode opCode;
+    opCode.type = OpCode::RenderToTexture;
+    opCode.sorting = 0;
+    opCode.renderToTextures.commands = &commands;
+    opCode.renderToTextures.id = (ResourceId*)m_frame.allocate(sizeof(ResourceId));
+    opCode.renderToTextures.count = 1;
+    *opCode.renderToTextures.id = static_cast<ResourceId>(id);
+    opCode.renderToTextures.side = 255;
+    opCode.renderToTextures.options = options;
+    opCode.renderToTextures.viewport.x = viewport.min().x;
+    opCode.renderToTextures.viewport.y = viewport.min().y;
+    opCode.renderToTextures.viewport.width = viewport.width();
+    opCode.renderToTextures.viewport.height = viewport.height();
+    push( opCode );
+    
+    return commands;
+}
+
 // ** RenderCommandBuffer::renderToCubeMap
 RenderCommandBuffer& RenderCommandBuffer::renderToCubeMap(TransientTexture id, u8 side, u32 options, const Rect& viewport)
 {
@@ -132,9 +154,7 @@ RenderCommandBuffer& RenderCommandBuffer::renderToTarget(u32 options, const Rect
 // ** RenderCommandBuffer::acquireTexture2D
 TransientTexture RenderCommandBuffer::acquireTexture2D(u16 width, u16 height, u32 options)
 {
-    NIMBLE_ABORT_IF( m_transientResourceIndex + 1 >= 255, "too transient resources used" );
-    
-    TransientTexture id = TransientTexture::create(++m_transientResourceIndex);
+    TransientTexture id = TransientTexture::create(m_frame.acquireTransientSlot());
     
     OpCode opCode;
     opCode.type = OpCode::AcquireTexture;
@@ -152,9 +172,7 @@ TransientTexture RenderCommandBuffer::acquireTexture2D(u16 width, u16 height, u3
 // ** RenderCommandBuffer::acquireTextureCube
 TransientTexture RenderCommandBuffer::acquireTextureCube(u16 size, u32 options)
 {
-    NIMBLE_ABORT_IF( m_transientResourceIndex + 1 >= 255, "too transient resources used" );
-    
-    TransientTexture id = TransientTexture::create(++m_transientResourceIndex);
+    TransientTexture id = TransientTexture::create(m_frame.acquireTransientSlot());
     
     OpCode opCode;
     opCode.type = OpCode::AcquireTexture;
@@ -180,43 +198,43 @@ void RenderCommandBuffer::releaseTexture(TransientTexture id)
 }
 
 // ** RenderCommandBuffer::drawIndexed
-void RenderCommandBuffer::drawIndexed(u32 sorting, PrimitiveType primitives, s32 first, s32 count)
+void RenderCommandBuffer::drawIndexed(u64 sorting, PrimitiveType primitives, s32 first, s32 count)
 {
     emitDrawCall(OpCode::DrawIndexed, sorting, primitives, first, count, m_stateStack.states(), m_stateStack.size(), NULL);
 }
 
 // ** RenderCommandBuffer::drawIndexed
-void RenderCommandBuffer::drawIndexed(u32 sorting, PrimitiveType primitives, s32 first, s32 count, const StateBlock& stateBlock)
+void RenderCommandBuffer::drawIndexed(u64 sorting, PrimitiveType primitives, s32 first, s32 count, const StateBlock& stateBlock)
 {
     emitDrawCall(OpCode::DrawIndexed, sorting, primitives, first, count, m_stateStack.states(), m_stateStack.size(), &stateBlock);
 }
 
 // ** RenderCommandBuffer::drawPrimitives
-void RenderCommandBuffer::drawPrimitives(u32 sorting, PrimitiveType primitives, s32 first, s32 count)
+void RenderCommandBuffer::drawPrimitives(u64 sorting, PrimitiveType primitives, s32 first, s32 count)
 {
     emitDrawCall(OpCode::DrawPrimitives, sorting, primitives, first, count, m_stateStack.states(), m_stateStack.size(), NULL);
 }
 
 // ** RenderCommandBuffer::drawPrimitives
-void RenderCommandBuffer::drawPrimitives(u32 sorting, PrimitiveType primitives, s32 first, s32 count, const StateBlock& stateBlock)
+void RenderCommandBuffer::drawPrimitives(u64 sorting, PrimitiveType primitives, s32 first, s32 count, const StateBlock& stateBlock)
 {
     emitDrawCall(OpCode::DrawPrimitives, sorting, primitives, first, count, m_stateStack.states(), m_stateStack.size(), &stateBlock);
 }
     
 // ** RenderCommandBuffer::drawItem
-void RenderCommandBuffer::drawItem(u32 sorting, const RenderItem& item)
+void RenderCommandBuffer::drawItem(u64 sorting, const RenderItem& item)
 {
     emitDrawCall(item.indexed ? OpCode::DrawIndexed : OpCode::DrawPrimitives, sorting, item.primitives, item.first, item.count, m_stateStack.states(), m_stateStack.size(), &item.states);
 }
 
 // ** RenderCommandBuffer::drawItem
-void RenderCommandBuffer::drawItem(u32 sorting, const RenderItem& item, const StateBlock& stateBlock)
+void RenderCommandBuffer::drawItem(u64 sorting, const RenderItem& item, const StateBlock& stateBlock)
 {
     NIMBLE_NOT_IMPLEMENTED
 }
 
 // ** RenderCommandBuffer::emitDrawCall
-void RenderCommandBuffer::emitDrawCall(OpCode::Type type, u32 sorting, PrimitiveType primitives, s32 first, s32 count, const StateBlock** stateBlocks, s32 stateBlockCount, const StateBlock* overrideStateBlock)
+void RenderCommandBuffer::emitDrawCall(OpCode::Type type, u64 sorting, PrimitiveType primitives, s32 first, s32 count, const StateBlock** stateBlocks, s32 stateBlockCount, const StateBlock* overrideStateBlock)
 {
     // Compile an array of state blocks
     OpCode::CompiledStateBlock* compiledStateBlock = (OpCode::CompiledStateBlock*)m_frame.allocate(sizeof(OpCode::CompiledStateBlock));
@@ -69,6 +69,9 @@ namespace Renderer
         //! Emits a rendering to a viewport of a specified render target command.
         RenderCommandBuffer&        renderToTexture(TransientTexture id, u32 options = 0, const Rect& viewport = Rect(0.0f, 0.0f, 1.0f, 1.0f));
         
+        //! Emits a rendering to a viewport of a persistent render target command.
+        RenderCommandBuffer&        renderToTexture(Texture_ id, u32 options = 0, const Rect& viewport = Rect(0.0f, 0.0f, 1.0f, 1.0f));
+        
         //! Emits a command to start rendering to a viewport of a specified cube map side.
         RenderCommandBuffer&        renderToCubeMap(TransientTexture id, u8 side, u32 options = 0, const Rect& viewport = Rect(0.0f, 0.0f, 1.0f, 1.0f));
         
@@ -78,23 +81,23 @@ namespace Renderer
         //! Emits a rendering to a viewport.
         RenderCommandBuffer&        renderToTarget(u32 options = 0, const Rect& viewport = Rect(0.0f, 0.0f, 1.0f, 1.0f));
         
-        //! Emits a draw indexed command that inherits all rendering states from a state stack.
-        void                        drawIndexed(u32 sorting, PrimitiveType primitives, s32 first, s32 count);
+        //! Emits a draw indexed command that inherits all rendering states from a state stack, first is an index number, not a byte offset.
+        void                        drawIndexed(u64 sorting, PrimitiveType primitives, s32 first, s32 count);
         
         //! Emits a draw indexed command with a single render state block.
-        void                        drawIndexed(u32 sorting, PrimitiveType primitives, s32 first, s32 count, const StateBlock& stateBlock);
+        void                        drawIndexed(u64 sorting, PrimitiveType primitives, s32 first, s32 count, const StateBlock& stateBlock);
         
         //! Emits a draw primitives command that inherits all rendering states from a state stack.
-        void                        drawPrimitives(u32 sorting, PrimitiveType primitives, s32 first, s32 count);
+        void                        drawPrimitives(u64 sorting, PrimitiveType primitives, s32 first, s32 count);
         
         //! Emits a draw primitives command that inherits all rendering states from a state stack.
-        void                        drawPrimitives(u32 sorting, PrimitiveType primitives, s32 first, s32 count, const StateBlock& stateBlock);
+        void                        drawPrimitives(u64 sorting, PrimitiveType primitives, s32 first, s32 count, const StateBlock& stateBlock);
         
         //! Emits a draw command for a given render item.
-        void                        drawItem(u32 sorting, const RenderItem& item);
+        void                        drawItem(u64 sorting, const RenderItem& item);
         
         //! Emits a draw command for a given render item.
-        void                        drawItem(u32 sorting, const RenderItem& item, const StateBlock& stateBlock);
+        void                        drawItem(u64 sorting, const RenderItem& item, const StateBlock& stateBlock);
         
     protected:
         
@@ -102,7 +105,7 @@ namespace Renderer
                                     RenderCommandBuffer(RenderFrame& frame);
         
         //! Emits a draw call command.
-        void                        emitDrawCall( OpCode::Type type, u32 sorting, PrimitiveType primitives, s32 first, s32 count, const StateBlock** states, s32 stateCount, const StateBlock* overrideStateBlock);
+        void                        emitDrawCall( OpCode::Type type, u64 sorting, PrimitiveType primitives, s32 first, s32 count, const StateBlock** states, s32 stateCount, const StateBlock* overrideStateBlock);
         
         //! Compiles a state block stack to an array of rendering state.
         s32                         compileStateStack(const StateBlock* const * stateBlocks, s32 count, State* states, s32 maxStates, OpCode::CompiledStateBlock* compiledStateBlock);
@@ -111,7 +114,6 @@ namespace Renderer
         
         RenderFrame&                m_frame;                    //!< A parent render frame that issued this command buffer.
         StateStack&                 m_stateStack;               //!< An active state stack.
-        u8                          m_transientResourceIndex;   //!< A transient resource index relative to a current stack offset.
     };
 
 } // namespace Renderer
@@ -44,7 +44,7 @@ InputLayout ResourceCommandBuffer::createInputLayout(InputLayout id, const Verte
     OpCode opCode;
     opCode.type = OpCode::CreateInputLayout;
     opCode.createInputLayout.id = id;
-    opCode.createInputLayout.format = vertexFormat;
+    opCode.createInputLayout.format = vertexFormat.key();
     push( opCode );
     return id;
 }
@@ -61,12 +61,15 @@ VertexBuffer_ ResourceCommandBuffer::createVertexBuffer(VertexBuffer_ id, const
 }
 
 // ** ResourceCommandBuffer::createIndexBuffer
-IndexBuffer_ ResourceCommandBuffer::createIndexBuffer(IndexBuffer_ id, const void* data, s32 size)
+IndexBuffer_ ResourceCommandBuffer::createIndexBuffer(IndexBuffer_ id, const void* data, s32 size, s32 indexSize)
 {
+    NIMBLE_ABORT_IF(indexSize != sizeof(u16) && indexSize != sizeof(u32), "unsupported index size");
+    
     OpCode opCode;
     opCode.type = OpCode::CreateIndexBuffer;
     opCode.createBuffer.id = id;
     opCode.createBuffer.buffer = adoptDataBuffer(data, size);
+    opCode.createBuffer.indexSize = static_cast<u8>(indexSize);
     push( opCode );
     return id;
 }
@@ -119,6 +122,15 @@ Texture_ ResourceCommandBuffer::createTextureCube(Texture_ id, const void* data,
     return id;
 }
 
+// ** ResourceCommandBuffer::deleteTexture
+void ResourceCommandBuffer::deleteTexture(Texture_ id)
+{
+    OpCode opCode;
+    opCode.type = OpCode::DeleteTexture;
+    opCode.id   = id;
+    push(opCode);
+}
+
 // ** ResourceCommandBuffer::deleteConstantBuffer
 void ResourceCommandBuffer::deleteConstantBuffer(ConstantBuffer_ id)
 {
@@ -138,12 +150,13 @@ void ResourceCommandBuffer::deleteProgram(Program id)
 }
 
 // ** ResourceCommandBuffer::precompilePermutation
-void ResourceCommandBuffer::precompilePermutation(Program id, PipelineFeatures features)
+void ResourceCommandBuffer::precompilePermutation(Program id, FeatureLayout featureLayout, PipelineFeatures features)
 {
     OpCode opCode;
-    opCode.type                = OpCode::PrecompilePermutation;
-    opCode.precompile.program  = id;
-    opCode.precompile.features = features;
+    opCode.type                     = OpCode::PrecompilePermutation;
+    opCode.precompile.program       = id;
+    opCode.precompile.featureLayout = featureLayout;
+    opCode.precompile.features      = features;
     push(opCode);
 }
     
@@ -47,7 +47,7 @@ namespace Renderer
         VertexBuffer_               createVertexBuffer(VertexBuffer_ id, const void* data, s32 size);
         
         //! Emits an index buffer creation command.
-        IndexBuffer_                createIndexBuffer(IndexBuffer_ id, const void* data, s32 size);
+        IndexBuffer_                createIndexBuffer(IndexBuffer_ id, const void* data, s32 size, s32 indexSize);
         
         //! Emits a constant buffer creation command.
         ConstantBuffer_             createConstantBuffer(ConstantBuffer_ id, const void* data, s32 size, UniformLayout layout);
@@ -58,6 +58,9 @@ namespace Renderer
         //! Emits a cube texture creation command.
         Texture_                    createTextureCube(Texture_ id, const void* data, u16 size, u16 mipLevels, u32 options);
         
+        //! Emits a texture destruction command.
+        void                        deleteTexture(Texture_ id);
+        
         //! Emits a constant buffer destruction command.
         void                        deleteConstantBuffer(ConstantBuffer_ id);
         
@@ -65,7 +68,7 @@ namespace Renderer
         void                        deleteProgram(Program id);
         
         //! Emits a permutation precompilation command.
-        void                        precompilePermutation(Program id, PipelineFeatures features);
+        void                        precompilePermutation(Program id, FeatureLayout featureLayout, PipelineFeatures features);
         
     private:
         
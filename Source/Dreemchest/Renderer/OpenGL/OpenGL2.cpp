@@ -832,6 +832,20 @@ bool OpenGL2::dumpErrors(CString fileName, s32 line)
 }
 
     
+// ** convertElementType
+static GLenum convertElementType(VertexBufferLayout::ElementType type)
+{
+    static GLenum s_elementType[] =
+    {
+          GL_FLOAT
+        , GL_HALF_FLOAT
+        , GL_BYTE
+        , GL_UNSIGNED_BYTE
+    };
+    
+    return s_elementType[type];
+}
+    
 #if DEV_RENDERER_DEPRECATED_INPUT_LAYOUTS
 // ** OpenGL2::enableInputLayout
 void OpenGL2::enableInputLayout(GLbyte* pointer, const VertexBufferLayout& layout)
@@ -848,13 +862,13 @@ void OpenGL2::enableInputLayout(GLbyte* pointer, const VertexBufferLayout& layou
     if (normal)
     {
         glEnableClientState(GL_NORMAL_ARRAY);
-        glNormalPointer(GL_FLOAT, stride, pointer + normal.offset);
+        glNormalPointer(convertElementType(normal.type), stride, pointer + normal.offset);
     }
     
     if (color)
     {
         glEnableClientState(GL_COLOR_ARRAY);
-        glColorPointer(color.count, GL_UNSIGNED_BYTE, stride, pointer + color.offset);
+        glColorPointer(color.count, convertElementType(color.type), stride, pointer + color.offset);
     }
     
     if (pointSize)
@@ -873,12 +887,12 @@ void OpenGL2::enableInputLayout(GLbyte* pointer, const VertexBufferLayout& layou
         {
             glClientActiveTexture(GL_TEXTURE0 + i);
             glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-            glTexCoordPointer(uv.count, GL_FLOAT, stride, pointer + uv.offset);
+            glTexCoordPointer(uv.count, convertElementType(uv.type), stride, pointer + uv.offset);
         }
     }
     
     glEnableClientState(GL_VERTEX_ARRAY);
-    glVertexPointer(position.count, GL_FLOAT, stride, pointer + position.offset);
+    glVertexPointer(position.count, convertElementType(position.type), stride, pointer + position.offset);
 }
 
 // ** OpenGL2::disableInputLayout
@@ -920,24 +934,6 @@ void OpenGL2::setInputLayout(const GLint* locations, const VertexBufferLayout& l
 {
     DREEMCHEST_GL_SENTINEL
     
-    static GLenum s_attributeType[] =
-    {
-          GL_FLOAT
-        , GL_FLOAT
-        , GL_UNSIGNED_BYTE
-        , GL_FLOAT
-        , GL_FLOAT
-        , GL_FLOAT
-        , GL_FLOAT
-        , GL_FLOAT
-        , GL_FLOAT
-        , GL_FLOAT
-        , GL_FLOAT
-        , GL_FLOAT
-        , GL_FLOAT
-        , GL_FLOAT
-    };
-    
     s32 stride = layout.vertexSize();
     
     for (s32 i = 0; i < MaxVertexAttributes; i++)
@@ -954,7 +950,7 @@ void OpenGL2::setInputLayout(const GLint* locations, const VertexBufferLayout& l
             const VertexBufferLayout::Element& element = layout[i];
             
             glEnableVertexAttribArray(location);
-            glVertexAttribPointer(location, element.count, s_attributeType[i], i == 2 ? GL_TRUE : GL_FALSE, stride, static_cast<u8*>(NULL) + element.offset);
+            glVertexAttribPointer(location, element.count, convertElementType(element.type), element.normalized ? GL_TRUE : GL_FALSE, stride, static_cast<u8*>(NULL) + element.offset);
         }
     }
 }
@@ -1084,7 +1080,7 @@ void OpenGL2::drawElements(PrimitiveType primType, GLenum type, u32 firstIndex,
     };
     
     NIMBLE_ABORT_IF(mode[primType] == 0, "unsupported primitive type");
-    glDrawElements(mode[primType], count, type, static_cast<GLbyte*>(NULL) + firstIndex);
+    glDrawElements(mode[primType], count, type, static_cast<GLbyte*>(NULL) + firstIndex * (type == GL_UNSIGNED_INT ? sizeof(u32) : sizeof(u16)));
 #endif  //  #if !DEV_RENDERER_SKIP_DRAW_CALLS
 }
 
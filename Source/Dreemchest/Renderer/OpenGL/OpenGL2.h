@@ -432,6 +432,10 @@ namespace Renderer
         static GLenum   textureFilter(TextureFilter filter);
         
         //! Renders an indexed batch of primitives.
+        /*!
+         The firstIndex is counted in indices of a specified type, not in bytes, it is converted
+         to a byte offset inside a bound index buffer by multiplying it with an index size.
+        */
         static void     drawElements(PrimitiveType primType, GLenum type, u32 firstIndex, u32 count);
 
         //! Renders a batch of primitives.
@@ -123,6 +123,7 @@ OpenGL2RenderingContext::OpenGL2RenderingContext(RenderViewPtr view)
     : OpenGLRenderingContext(view)
     , m_requestedProgram(0)
     , m_requestedFeatureLayout(NULL)
+    , m_activeIndexType(GL_UNSIGNED_SHORT)
     , m_activeInputLayout(NULL)
     , m_activeVertexBuffer(0)
 #if DEV_RENDERER_PROGRAM_CACHING
@@ -156,21 +157,24 @@ OpenGL2RenderingContext::OpenGL2RenderingContext(RenderViewPtr view)
     m_constantBuffers.emplace(0, ConstantBuffer());
     m_vertexBuffers.emplace(0, 0);
     m_indexBuffers.emplace(0, 0);
+    m_indexTypes.emplace(0, GL_UNSIGNED_SHORT);
 }
     
 // ** OpenGL2RenderingContext::acquireTexture
 ResourceId OpenGL2RenderingContext::acquireTexture(u8 type, u16 width, u16 height, u32 options)
 {
     // First search for a free render target
-    for (List<Texture_>::const_iterator i = m_transientTextures.begin(), end = m_transientTextures.end(); i != end; ++i)
+    for (List<Texture_>::iterator i = m_transientTextures.begin(), end = m_transientTextures.end(); i != end; ++i)
     {
         // Get a texture info by id
         const TextureInfo& info = textureInfo(*i);
         
-        // Does the render target format match the requested one?
+        // Does the render target format match the requested one? Remove it from a free list, so it's not shared by two transient resources.
         if (type == info.type && info.width == width && info.height == height && info.options == options)
         {
-            return *i;
+            ResourceId id = *i;
+            m_transientTextures.erase(i);
+            return id;
         }
     }
     
@@ -223,6 +227,13 @@ ResourceId OpenGL2RenderingContext::allocateTexture(u8 type, const void* data, u
     return id;
 }
 
+// ** OpenGL2RenderingContext::deleteTexture
+void OpenGL2RenderingContext::deleteTexture(ResourceId id)
+{
+    OpenGL2::Texture::destroy(m_textures[id]);
+    m_textures.emplace(id, 0);
+}
+
 // ** OpenGL2RenderingContext::executeCommandBuffer
 void OpenGL2RenderingContext::executeCommandBuffer(const CommandBuffer& commands)
 {
@@ -264,11 +275,11 @@ void OpenGL2RenderingContext::executeCommandBuffer(const CommandBuffer& commands
                 break;
                 
             case OpCode::UploadVertexBuffer:
-                OpenGL2::Buffer::subData(GL_ARRAY_BUFFER, m_vertexBuffers[opCode.upload.id], 0, opCode.upload.buffer.size, opCode.upload.buffer.data);
+                OpenGL2::Buffer::subData(GL_ARRAY_BUFFER, m_vertexBuffers[opCode.upload.id], opCode.upload.offset, opCode.upload.buffer.size, opCode.upload.buffer.data);
                 break;
                 
             case OpCode::CreateInputLayout:
-                m_inputLayouts.emplace(opCode.createInputLayout.id, createVertexBufferLayout(opCode.createInputLayout.format));
+                m_inputLayouts.emplace(opCode.createInputLayout.id, createVertexBufferLayout(VertexFormat::fromKey(opCode.createInputLayout.format)));
                 break;
                 
             case OpCode::CreateTexture:
@@ -283,8 +294,10 @@ void OpenGL2RenderingContext::executeCommandBuffer(const CommandBuffer& commands
                 break;
                 
             case OpCode::CreateIndexBuffer:
+                NIMBLE_ABORT_IF(opCode.createBuffer.indexSize == sizeof(u32) && !m_caps.uintIndices, "32-bit indices are not supported");
                 id = OpenGL2::Buffer::create(GL_ARRAY_BUFFER, opCode.createBuffer.buffer.data, opCode.createBuffer.buffer.size, GL_DYNAMIC_DRAW);
                 m_indexBuffers.emplace(opCode.createBuffer.id, id);
+                m_indexTypes.emplace(opCode.createBuffer.id, opCode.createBuffer.indexSize == sizeof(u32) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT);
                 break;
                 
             case OpCode::CreateVertexBuffer:
@@ -295,7 +308,8 @@ void OpenGL2RenderingContext::executeCommandBuffer(const CommandBuffer& commands
             case OpCode::CreateConstantBuffer:
             {
                 ConstantBuffer constantBuffer;
-                constantBuffer.layout = m_uniformLayouts[opCode.createBuffer.layout];
+                constantBuffer.layout     = m_uniformLayouts[opCode.createBuffer.layout];
+                constantBuffer.layoutHash = calculateLayoutHash(&constantBuffer.layout[0]);
                 constantBuffer.data.resize(opCode.createBuffer.buffer.size);
             #if DEV_RENDERER_UNIFORM_CACHING
                 constantBuffer.revision.id    = opCode.createBuffer.id;
@@ -311,6 +325,11 @@ void OpenGL2RenderingContext::executeCommandBuffer(const CommandBuffer& commands
             }
                 break;
                 
+            case OpCode::DeleteTexture:
+                deleteTexture(opCode.id);
+                releaseIdentifier(RenderResourceType::Texture, opCode.id);
+                break;
+                
             case OpCode::DeleteConstantBuffer:
                 m_constantBuffers.emplace(opCode.id, ConstantBuffer());
                 releaseIdentifier(RenderResourceType::ConstantBuffer, opCode.id);
@@ -326,10 +345,19 @@ void OpenGL2RenderingContext::executeCommandBuffer(const CommandBuffer& commands
             case OpCode::PrecompilePermutation:
                 if (!lookupPermutation(opCode.precompile.program, opCode.precompile.features, &permutation))
                 {
-                    compileShaderPermutation(opCode.precompile.program, opCode.precompile.features, NULL);
+                    const PipelineFeatureLayout* featureLayout = opCode.precompile.featureLayout ? m_pipelineFeatureLayouts[opCode.precompile.featureLayout].get() : NULL;
+                    compileShaderPermutation(opCode.precompile.program, opCode.precompile.features, featureLayout);
                 }
                 break;
                 
+            case OpCode::BeginProfileScope:
+                beginProfileScope(opCode);
+                break;
+                
+            case OpCode::EndProfileScope:
+                endProfileScope(opCode);
+                break;
+                
             case OpCode::AcquireTexture:
             {
                 ResourceId id = acquireTexture(opCode.transientTexture.type, opCode.transientTexture.width, opCode.transientTexture.height, opCode.transientTexture.options);
@@ -445,7 +473,8 @@ void OpenGL2RenderingContext::executeCommandBuffer(const CommandBuffer& commands
             #endif  //  #if !DEV_RENDERER_DEPRECATED_INPUT_LAYOUTS
                 
                 // Perform an actual draw call
-                OpenGL2::drawElements(opCode.drawCall.primitives, GL_UNSIGNED_SHORT, opCode.drawCall.first, opCode.drawCall.count);
+                m_counters.drawCalls++;
+                OpenGL2::drawElements(opCode.drawCall.primitives, m_activeIndexType, opCode.drawCall.first, opCode.drawCall.count);
                 break;
                 
             case OpCode::DrawPrimitives:
@@ -468,6 +497,7 @@ void OpenGL2RenderingContext::executeCommandBuffer(const CommandBuffer& commands
             #endif  //  #if !DEV_RENDERER_DEPRECATED_INPUT_LAYOUTS
                 
                 // Perform an actual draw call
+                m_counters.drawCalls++;
                 OpenGL2::drawArrays(opCode.drawCall.primitives, opCode.drawCall.first, opCode.drawCall.count);
                 break;
                 
@@ -509,6 +539,7 @@ const VertexBufferLayout* OpenGL2RenderingContext::compilePipelineState(const St
                 
             case State::BindIndexBuffer:
                 OpenGL2::Buffer::bind(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffers[state.resourceId]);
+                m_activeIndexType = m_indexTypes[state.resourceId];
                 break;
                 
             case State::SetInputLayout:
@@ -670,99 +701,139 @@ const OpenGLRenderingContext::Permutation* OpenGL2RenderingContext::applyProgram
     return permutation;
 }
     
-// ** OpenGL2RenderingContext::updateUniforms
-void OpenGL2RenderingContext::updateUniforms(const Permutation* permutation)
+// ** OpenGL2RenderingContext::calculateLayoutHash
+u32 OpenGL2RenderingContext::calculateLayoutHash(const UniformElement* elements)
 {
-    struct UniformPointer
+    u32 hash = 5381;
+    
+    for (const UniformElement* element = elements; element->name; element++)
     {
-        static const void* findByName(const Permutation::Uniform& uniform, const FixedArray<ConstantBuffer>& constantBuffers, const ResourceId* boundConstantBuffers)
+        for (CString name = element->name.value(); *name; name++)
         {
-            ResourceId id = boundConstantBuffers[uniform.index];
-            const ConstantBuffer& cbuffer = constantBuffers[id];
-
-            for (const UniformElement* constant = &cbuffer.layout[0]; constant->name; constant++)
-            {
-                if (constant->name.hash() == uniform.hash)
-                {
-                    return &cbuffer.data[constant->offset];
-                }
-            }
-            
-            NIMBLE_NOT_IMPLEMENTED
-            return NULL;
+            hash = ((hash << 5) + hash) + *name;
         }
+        
+        hash = ((hash << 5) + hash) + element->type;
+        hash = ((hash << 5) + hash) + element->offset;
+        hash = ((hash << 5) + hash) + element->size;
+    }
+    
+    // Zero is reserved for unresolved binding tables
+    return hash ? hash : 1;
+}
+    
+// ** OpenGL2RenderingContext::resolveBindingTable
+const OpenGL2RenderingContext::Permutation::BindingTable& OpenGL2RenderingContext::resolveBindingTable(const Permutation* permutation, u8 slot, u32 layout, const UniformElement* elements) const
+{
+    // This slot was already used with a constant buffer of the same layout
+    Permutation::BindingTables::const_iterator i = permutation->bindings[slot].find(layout);
+    
+    if (i != permutation->bindings[slot].end())
+    {
+        return i->second;
+    }
+    
+    //! Uniform upload functions referenced by binding tables.
+    struct UniformUpload
+    {
+        static void int1(GLint location, const void* value, s32 count)   { OpenGL2::Program::uniform1i(location, reinterpret_cast<const s32*>(value), count); }
+        static void float1(GLint location, const void* value, s32 count) { OpenGL2::Program::uniform1f(location, reinterpret_cast<const f32*>(value), count); }
+        static void float2(GLint location, const void* value, s32 count) { OpenGL2::Program::uniform2f(location, reinterpret_cast<const f32*>(value), count); }
+        static void float3(GLint location, const void* value, s32 count) { OpenGL2::Program::uniform3f(location, reinterpret_cast<const f32*>(value), count); }
+        static void float4(GLint location, const void* value, s32 count) { OpenGL2::Program::uniform4f(location, reinterpret_cast<const f32*>(value), count); }
+        static void matrix4(GLint location, const void* value, s32 count){ OpenGL2::Program::uniformMatrix4(location, reinterpret_cast<const f32*>(value), count); }
     };
     
-    const void* pointer = NULL;
+    Permutation::BindingTable& table = permutation->bindings[slot][layout];
+    table.layout = layout;
     
     for (size_t i = 0, n = permutation->uniforms.size(); i < n; i++)
     {
         const Permutation::Uniform& uniform = permutation->uniforms[i];
         
-    #if DEV_RENDERER_UNIFORM_CACHING
-        ResourceId id = m_requestedCBuffer[uniform.index];
-        NIMBLE_ABORT_IF(!id, "no constant buffer bound");
+        if (uniform.index != slot)
+        {
+            continue;
+        }
         
-        const ConstantBuffer& cbuffer = m_constantBuffers[id];
+        // Lookup a uniform inside a constant buffer layout by name
+        const UniformElement* constant = elements;
         
-        // Nothing changed, so just skip this uniform
-        if (permutation->buffers[uniform.index].hash == cbuffer.revision.hash)
+        while (constant->name && !(constant->name.hash() == uniform.hash))
         {
-            continue;
+            constant++;
         }
-    #endif  //  #if DEV_RENDERER_UNIFORM_CACHING
         
-        // Count this uniform update
-        m_counters.uniformsUploaded++;
+        NIMBLE_ABORT_IF(!constant->name, "uniform not found in a constant buffer layout");
+        
+        Permutation::UniformBinding binding;
+        binding.location = uniform.location;
+        binding.size     = uniform.size;
+        binding.offset   = constant->offset;
         
         switch (uniform.type)
         {
-            case GL_INT:
-                pointer = UniformPointer::findByName(uniform, m_constantBuffers, m_requestedCBuffer);
-                OpenGL2::Program::uniform1i(uniform.location, reinterpret_cast<const s32*>(pointer), uniform.size);
-                break;
-                
-            case GL_FLOAT:
-                pointer = UniformPointer::findByName(uniform, m_constantBuffers, m_requestedCBuffer);
-                OpenGL2::Program::uniform1f(uniform.location, reinterpret_cast<const f32*>(pointer), uniform.size);
-                break;
-                
-            case GL_FLOAT_VEC2:
-                pointer = UniformPointer::findByName(uniform, m_constantBuffers, m_requestedCBuffer);
-                OpenGL2::Program::uniform2f(uniform.location, reinterpret_cast<const f32*>(pointer), uniform.size);
-                break;
-                
-            case GL_FLOAT_VEC3:
-                pointer = UniformPointer::findByName(uniform, m_constantBuffers, m_requestedCBuffer);
-                OpenGL2::Program::uniform3f(uniform.location, reinterpret_cast<const f32*>(pointer), uniform.size);
-                break;
-                
-            case GL_FLOAT_VEC4:
-                pointer = UniformPointer::findByName(uniform, m_constantBuffers, m_requestedCBuffer);
-                OpenGL2::Program::uniform4f(uniform.location, reinterpret_cast<const f32*>(pointer), uniform.size);
-                break;
-                
-            case GL_FLOAT_MAT4:
-                pointer = UniformPointer::findByName(uniform, m_constantBuffers, m_requestedCBuffer);
-                OpenGL2::Program::uniformMatrix4(uniform.location, reinterpret_cast<const f32*>(pointer), uniform.size);
-                break;
-                
-            default:
-                NIMBLE_NOT_IMPLEMENTED
+            case GL_INT:        binding.upload = UniformUpload::int1;       break;
+            case GL_FLOAT:      binding.upload = UniformUpload::float1;     break;
+            case GL_FLOAT_VEC2: binding.upload = UniformUpload::float2;     break;
+            case GL_FLOAT_VEC3: binding.upload = UniformUpload::float3;     break;
+            case GL_FLOAT_VEC4: binding.upload = UniformUpload::float4;     break;
+            case GL_FLOAT_MAT4: binding.upload = UniformUpload::matrix4;    break;
+            default:            NIMBLE_NOT_IMPLEMENTED
         }
+        
+        table.uniforms.push_back(binding);
     }
     
-#if DEV_RENDERER_UNIFORM_CACHING
-    for (size_t i = 0, n = permutation->uniforms.size(); i < n; i++)
+    return table;
+}
+    
+// ** OpenGL2RenderingContext::updateUniforms
+void OpenGL2RenderingContext::updateUniforms(const Permutation* permutation)
+{
+    for (u8 slot = 0; slot < State::MaxConstantBuffers; slot++)
     {
-        const Permutation::Uniform& uniform = permutation->uniforms[i];
-        ResourceId                  id      = m_requestedCBuffer[uniform.index];
-        const ConstantBuffer&       cbuffer = m_constantBuffers[id];
+        // This constant buffer slot is not referenced by a permutation
+        if ((permutation->bufferMask & BIT(slot)) == 0)
+        {
+            continue;
+        }
+        
+        ResourceId id = m_requestedCBuffer[slot];
+        NIMBLE_ABORT_IF(!id, "no constant buffer bound");
+        
+        const ConstantBuffer& cbuffer = m_constantBuffers[id];
         
-        // Update uniform hash values.
-        permutation->buffers[uniform.index] = cbuffer.revision;
+    #if DEV_RENDERER_UNIFORM_CACHING
+        // Nothing changed, so just skip the whole buffer
+        if (permutation->buffers[slot].hash == cbuffer.revision.hash)
+        {
+            continue;
+        }
+        permutation->buffers[slot] = cbuffer.revision;
+    #endif  //  #if DEV_RENDERER_UNIFORM_CACHING
+        
+        // Bindings are cached per layout, so alternating constant buffer layouts never resolve them again
+        const Permutation::BindingTable* table = permutation->active[slot];
+        
+        if (table == NULL || table->layout != cbuffer.layoutHash)
+        {
+            table = &resolveBindingTable(permutation, slot, cbuffer.layoutHash, &cbuffer.layout[0]);
+            permutation->active[slot] = table;
+        }
+        
+        // Now upload all uniforms from this buffer
+        const u8* data = &cbuffer.data[0];
+        
+        for (size_t i = 0, n = table->uniforms.size(); i < n; i++)
+        {
+            const Permutation::UniformBinding& binding = table->uniforms[i];
+            binding.upload(binding.location, data + binding.offset, binding.size);
+        }
+        
+        // Count these uniform updates
+        m_counters.uniformsUploaded += static_cast<s32>(table->uniforms.size());
     }
-#endif  //  #if DEV_RENDERER_UNIFORM_CACHING
 }
     
 // ** OpenGL2RenderingContext::compileShaderPermutation
@@ -810,6 +881,9 @@ const OpenGL2RenderingContext::Permutation* OpenGL2RenderingContext::compileShad
     // Finally save a compiled permutation
     permutation = savePermutation(program, features, id);
     
+    // Record this permutation to a session manifest
+    recordPermutation(program, featureLayout, features);
+    
     return permutation;
 }
     
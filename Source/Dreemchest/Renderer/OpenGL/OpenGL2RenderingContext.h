@@ -56,6 +56,9 @@ namespace Renderer
         
         //! Update uniforms from active constant buffers.
         void                        updateUniforms(const Permutation* permutation);
+        
+        //! Returns permutation uniforms that are read from a specified constant buffer slot, they are resolved once per constant buffer layout.
+        const Permutation::BindingTable& resolveBindingTable(const Permutation* permutation, u8 slot, u32 layout, const UniformElement* elements) const;
 
         //! Acquires a transient texture.
         ResourceId                  acquireTexture(u8 type, u16 width, u16 height, u32 options);
@@ -66,6 +69,9 @@ namespace Renderer
         //! Allocates a new texture of specified type.
         ResourceId                  allocateTexture(u8 type, const void* data, u16 width, u16 height, u16 mipLevels, u32 options, ResourceId id = 0);
         
+        //! Destroys a texture object.
+        void                        deleteTexture(ResourceId id);
+        
     private:
         
         //! A software-emulated constant buffer
@@ -73,6 +79,7 @@ namespace Renderer
         {
             Array<u8>               data;       //!< Actual buffer data.
             Array<UniformElement>   layout;     //!< A constant buffer layout.
+            u32                     layoutHash; //!< A constant buffer layout hash, binding tables are resolved once per layout.
         #if DEV_RENDERER_UNIFORM_CACHING
             Revision                revision;   //!< A constant buffer revision number to track modifications.
         #endif  //  #if DEV_RENDERER_UNIFORM_CACHING
@@ -96,10 +103,14 @@ namespace Renderer
             bool                    m_withPrecision;        //!< Used by OpenGLES context to emit precision modifiers.
         };
         
+        //! Calculates a hash value of a uniform layout.
+        static u32                  calculateLayoutHash(const UniformElement* elements);
+        
         FixedArray<ConstantBuffer>  m_constantBuffers;      //!< An array of allocated constant buffer instances.
         ResourceId                  m_requestedProgram;     //!< A shader program id to be set.
         ResourceId                  m_requestedCBuffer[State::MaxConstantBuffers];
         const PipelineFeatureLayout*    m_requestedFeatureLayout;
+        GLenum                      m_activeIndexType;      //!< An index type of a bound index buffer.
     #if DEV_RENDERER_INPUT_LAYOUT_CACHING
         const VertexBufferLayout*   m_activeInputLayout;    //!< An active input layout.
         GLuint                      m_activeVertexBuffer;   //!< An active vertex buffer.
@@ -87,6 +87,14 @@ OpenGLRenderingContext::OpenGLRenderingContext(RenderViewPtr view)
     glGetIntegerv(GL_MAX_CUBE_MAP_TEXTURE_SIZE, &m_caps.maxCubeMapSize);
     glGetIntegerv(GL_MAX_TEXTURE_SIZE, &m_caps.maxTextureSize);
     
+#if !defined(DC_OPENGLES2_ENABLED)
+    m_caps.uintIndices = true;
+#else
+    // OpenGL ES 2.0 supports 32-bit indices only through an extension
+    CString extensions = reinterpret_cast<CString>(glGetString(GL_EXTENSIONS));
+    m_caps.uintIndices = extensions && strstr(extensions, "GL_OES_element_index_uint") != NULL;
+#endif  //  #if !defined(DC_OPENGLES2_ENABLED)
+    
     if (m_caps.maxRenderTargets)
     {
         m_drawBuffers = DC_NEW GLuint[m_caps.maxRenderTargets];
@@ -150,7 +158,14 @@ bool OpenGLRenderingContext::lookupPermutation(ResourceId program, PipelineFeatu
 const OpenGLRenderingContext::Permutation* OpenGLRenderingContext::savePermutation(ResourceId program, PipelineFeatures features, GLuint id)
 {
     Permutation permutation;
-    permutation.program = id;
+    permutation.program    = id;
+    permutation.bufferMask = 0;
+    
+    // Binding tables are resolved once a permutation is used with a constant buffer
+    for (s32 i = 0; i < State::MaxConstantBuffers; i++)
+    {
+        permutation.active[i] = NULL;
+    }
 #if DEV_RENDERER_UNIFORM_CACHING
     memset(permutation.buffers, 0, sizeof(permutation.buffers));
 #endif  //  #if DEV_RENDERER_UNIFORM_CACHING
@@ -186,6 +201,7 @@ const OpenGLRenderingContext::Permutation* OpenGLRenderingContext::savePermutati
         
         LogDebug("opengl", "\tuniform '%s' location %d\n", uniformInfo.name, uniform.location);
         
+        permutation.bufferMask |= BIT(uniform.index);
         permutation.uniforms.push_back(uniform);
     }
     
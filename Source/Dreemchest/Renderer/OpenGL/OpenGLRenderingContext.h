@@ -69,12 +69,37 @@ namespace Renderer
                 GLint           location;           //!< A uniform location.
             };
             
+            //! A function that uploads a uniform value located inside a constant buffer.
+            typedef void (*UniformUploadFunction)(GLint location, const void* value, s32 count);
+            
+            //! A uniform resolved against a constant buffer layout.
+            struct UniformBinding
+            {
+                GLint                   location;   //!< A uniform location.
+                GLint                   size;       //!< A uniform size.
+                u32                     offset;     //!< A uniform value offset inside a constant buffer.
+                UniformUploadFunction   upload;     //!< A function to upload a uniform value.
+            };
+            
+            //! Uniforms that are read from a single constant buffer slot.
+            struct BindingTable
+            {
+                u32                     layout;     //!< A constant buffer layout hash these bindings were resolved for.
+                Array<UniformBinding>   uniforms;   //!< Resolved uniform bindings.
+            };
+            
+            //! Binding tables of a single constant buffer slot keyed by a constant buffer layout hash.
+            typedef Map<u32, BindingTable> BindingTables;
+            
         #if DEV_RENDERER_UNIFORM_CACHING
             mutable Revision    buffers[State::MaxConstantBuffers];
         #endif  //  #if DEV_RENDERER_UNIFORM_CACHING
             
             GLuint              program;                            //!< An OpenGL program identifier.
             Array<Uniform>      uniforms;                           //!< Active uniforms extracted from a program by means of an introspection.
+            u32                 bufferMask;                         //!< A bit mask of constant buffer slots referenced by uniforms.
+            mutable BindingTables bindings[State::MaxConstantBuffers];  //!< Uniform binding tables for each constant buffer slot and layout.
+            mutable const BindingTable* active[State::MaxConstantBuffers]; //!< A binding table used by a last uniform update of each slot or NULL.
         #if !DEV_RENDERER_DEPRECATED_INPUT_LAYOUTS
             GLint               attributes[MaxVertexAttributes];    //!< An array of located vertex attributes.
         #endif  //  #if !DEV_RENDERER_DEPRECATED_INPUT_LAYOUTS
@@ -131,6 +156,7 @@ namespace Renderer
         
         FixedArray<GLuint>                      m_vertexBuffers;        //!< Allocated vertex buffers.
         FixedArray<GLuint>                      m_indexBuffers;         //!< Allocated index buffers.
+        FixedArray<GLenum>                      m_indexTypes;           //!< Index types of allocated index buffers.
         FixedArray<GLuint>                      m_textures;             //!< Allocated textures.
         List<Texture_>                          m_transientTextures;    //!< A list of free textures.
         mutable FixedArray<ProgramPermutations> m_permutations;         //!< Available program permutations.
@@ -36,17 +36,34 @@ namespace Renderer
 // ** RenderFrame::RenderFrame
 RenderFrame::RenderFrame(RenderingContext& renderingContext, s32 size)
     : m_defaults(renderingContext.defaultStateBlock())
+    , m_uploads(renderingContext.uploadRing())
     , m_stateStack(4096, MaxStateStackDepth)
     , m_allocator(size)
 {
+    memset(m_transientSlots, 0, sizeof(m_transientSlots));
     setAllocationCapacity(size);
 }
 
 // ** RenderFrame::internBuffer
-const void* RenderFrame::internBuffer(const void* data, s32 size)
+PersistentPointer RenderFrame::internBuffer(const void* data, s32 size)
 {
-    NIMBLE_NOT_IMPLEMENTED;
-    return NULL;
+    void* interned = allocateUpload(size);
+    memcpy(interned, data, size);
+    return persistentPointer(interned);
+}
+
+// ** RenderFrame::allocateUpload
+void* RenderFrame::allocateUpload(s32 size)
+{
+    UploadRing::Allocation allocation = m_uploads.allocate(size);
+    
+    // An upload ring is exhausted, so fallback to a frame memory
+    if (allocation.data == NULL)
+    {
+        return allocate(size);
+    }
+    
+    return allocation.data;
 }
 
 // ** RenderFrame::allocate
@@ -103,6 +120,38 @@ RenderCommandBuffer& RenderFrame::createCommandBuffer()
     return *commandBuffer;
 }
 
+// ** RenderFrame::acquireTransientSlot
+TransientResourceId RenderFrame::acquireTransientSlot()
+{
+    // Slots are returned only when a release command is executed, because a command buffer recorded later
+    // may be executed nested inside an earlier one while a released slot is still loaded
+    // Start from a first slot, because a zero one is an invalid transient identifier
+    for (s32 i = 1; i < MaxTransientSlots; i++)
+    {
+        u32 mask = 1u << (i & 31);
+        
+        if ((m_transientSlots[i >> 5] & mask) == 0)
+        {
+            m_transientSlots[i >> 5] |= mask;
+            return static_cast<TransientResourceId>(i);
+        }
+    }
+    
+    NIMBLE_ABORT_IF(true, "too many transient resources acquired by a frame");
+    return 0;
+}
+
+// ** RenderFrame::releaseTransientSlot
+void RenderFrame::releaseTransientSlot(TransientResourceId slot)
+{
+    u32 mask = 1u << (slot & 31);
+    
+    NIMBLE_ABORT_IF(slot == 0, "invalid transient resource slot");
+    NIMBLE_ABORT_IF((m_transientSlots[slot >> 5] & mask) == 0, "transient resource slot was not acquired");
+    
+    m_transientSlots[slot >> 5] &= ~mask;
+}
+
 // ** RenderFrame::stateStack
 StateStack& RenderFrame::stateStack()
 {
@@ -120,6 +169,7 @@ void RenderFrame::clear()
     m_commandBuffers.clear();
 
     m_allocator.reset();
+    memset(m_transientSlots, 0, sizeof(m_transientSlots));
     m_stateStack.reset();
     m_stateStack.push(m_defaults);
     
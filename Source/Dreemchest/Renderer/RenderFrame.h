@@ -48,6 +48,12 @@ namespace Renderer
         //! Creates a new command buffer.
         RenderCommandBuffer&                    createCommandBuffer();
 
+        //! Allocates a free transient resource slot, slots are shared by all command buffers of a frame.
+        TransientResourceId                     acquireTransientSlot();
+
+        //! Returns a transient resource slot back to a frame, invoked once a release command is executed.
+        void                                    releaseTransientSlot(TransientResourceId slot);
+
         //! Returns a state stack.
         StateStack&                             stateStack();
 
@@ -55,8 +61,11 @@ namespace Renderer
         const RenderCommandBuffer&              entryPoint() const;
         RenderCommandBuffer&                    entryPoint();
 
-        //! Interns a memory buffer that will by used during a frame rendering.
-        const void*                             internBuffer(const void* data, s32 size);
+        //! Copies a memory buffer to an upload ring, so it can be referenced by upload commands without an additional copy.
+        PersistentPointer                       internBuffer(const void* data, s32 size);
+        
+        //! Allocates a block of upload memory that stays valid until a frame is executed.
+        void*                                   allocateUpload(s32 size);
 
         //! Allocates a block of memory that is used during a frame rendering.
         void*                                   allocate(s32 size);
@@ -80,14 +89,19 @@ namespace Renderer
 
     private:
 
+        //! A maximum number of transient resource slots, a zero slot is reserved for an invalid identifier.
+        enum { MaxTransientSlots = 256 };
+
         //! Container type to store recorded command buffers.
         typedef Array<CommandBuffer*>           Commands;
 
         StateBlock&                             m_defaults;             //!< A default state block is pushed automatically to a state stack.
+        UploadRing&                             m_uploads;              //!< An upload ring shared by all frames in flight.
         RenderCommandBuffer*                    m_entryPoint;           //!< A root command buffer.
         Commands                                m_commandBuffers;       //!< An array of recorded commands buffers.
         StateStack                              m_stateStack;           //!< Current state stack.
         LinearAllocator                         m_allocator;            //!< A linear allocator used by a frame renderers.
+        u32                                     m_transientSlots[MaxTransientSlots / 32];   //!< A bit mask of acquired transient resource slots.
     };
 
     //! Returns a total number of captured command buffers.
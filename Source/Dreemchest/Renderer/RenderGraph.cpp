@@ -0,0 +1,356 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "RenderGraph.h"
+#include "Commands/RenderCommandBuffer.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Renderer
+{
+    
+// ** RenderGraph::RenderGraph
+RenderGraph::RenderGraph()
+    : m_isCompiled(false)
+{
+    memset(&m_statistics, 0, sizeof(m_statistics));
+}
+
+// ** RenderGraph::createTexture2D
+RenderGraph::Resource RenderGraph::createTexture2D(u16 width, u16 height, u32 options)
+{
+    TextureResource resource;
+    resource.type     = TextureType2D;
+    resource.width    = width;
+    resource.height   = height;
+    resource.options  = options;
+    resource.first    = -1;
+    resource.last     = -1;
+    resource.physical = -1;
+    m_resources.push_back(resource);
+    m_isCompiled = false;
+    
+    return static_cast<Resource>(m_resources.size() - 1);
+}
+
+// ** RenderGraph::createTextureCube
+RenderGraph::Resource RenderGraph::createTextureCube(u16 size, u32 options)
+{
+    Resource resource = createTexture2D(size, size, options);
+    m_resources[resource].type = TextureTypeCube;
+    return resource;
+}
+
+// ** RenderGraph::addPass
+s32 RenderGraph::addPass(const String& name, const PassCallback& callback)
+{
+    Pass pass;
+    pass.name        = name;
+    pass.callback    = callback;
+    pass.target      = -1;
+    pass.options     = 0;
+    pass.sideEffects = false;
+    pass.culled      = false;
+    m_passes.push_back(pass);
+    m_isCompiled = false;
+    
+    return static_cast<s32>(m_passes.size() - 1);
+}
+
+// ** RenderGraph::read
+void RenderGraph::read(s32 pass, Resource resource)
+{
+    NIMBLE_ABORT_IF(pass < 0 || pass >= static_cast<s32>(m_passes.size()), "invalid pass index");
+    NIMBLE_ABORT_IF(resource < 0 || resource >= static_cast<s32>(m_resources.size()), "invalid resource");
+    m_passes[pass].reads.push_back(resource);
+    m_isCompiled = false;
+}
+
+// ** RenderGraph::write
+void RenderGraph::write(s32 pass, Resource resource, u32 options, const Rect& viewport)
+{
+    NIMBLE_ABORT_IF(pass < 0 || pass >= static_cast<s32>(m_passes.size()), "invalid pass index");
+    NIMBLE_ABORT_IF(resource < 0 || resource >= static_cast<s32>(m_resources.size()), "invalid resource");
+    NIMBLE_ABORT_IF(m_passes[pass].target >= 0, "only a single render target per pass is supported");
+    m_passes[pass].target   = resource;
+    m_passes[pass].options  = options;
+    m_passes[pass].viewport = viewport;
+    m_isCompiled = false;
+}
+
+// ** RenderGraph::setSideEffects
+void RenderGraph::setSideEffects(s32 pass)
+{
+    NIMBLE_ABORT_IF(pass < 0 || pass >= static_cast<s32>(m_passes.size()), "invalid pass index");
+    m_passes[pass].sideEffects = true;
+    m_isCompiled = false;
+}
+
+// ** RenderGraph::statistics
+const RenderGraph::Statistics& RenderGraph::statistics() const
+{
+    return m_statistics;
+}
+
+// ** RenderGraph::texture
+TransientTexture RenderGraph::texture(Resource resource) const
+{
+    NIMBLE_ABORT_IF(resource < 0 || resource >= static_cast<s32>(m_resources.size()), "invalid resource");
+    s32 physical = m_resources[resource].physical;
+    NIMBLE_ABORT_IF(physical < 0, "resource is not used by any pass");
+    return m_physical[physical].id;
+}
+
+// ** RenderGraph::clear
+void RenderGraph::clear()
+{
+    m_passes.clear();
+    m_resources.clear();
+    m_physical.clear();
+    memset(&m_statistics, 0, sizeof(m_statistics));
+    m_isCompiled = false;
+}
+
+// ** RenderGraph::bytesPerTexture
+s32 RenderGraph::bytesPerTexture(u8 type, u16 width, u16 height, u32 options)
+{
+    PixelFormat format = Private::pixelFormatFromOptions(options);
+    s32         bytes  = Private::depthBitsFromOptions(options) / 8;
+    
+    if (format != PixelUnknown)
+    {
+        bytes += bytesPerPixel(format);
+    }
+    
+    return width * height * bytes * (type == TextureTypeCube ? 6 : 1);
+}
+
+// ** RenderGraph::compile
+void RenderGraph::compile()
+{
+    s32 passCount     = static_cast<s32>(m_passes.size());
+    s32 resourceCount = static_cast<s32>(m_resources.size());
+    
+    memset(&m_statistics, 0, sizeof(m_statistics));
+    
+    // Walk passes backwards and cull the ones that do not contribute to passes with side effects
+    Array<bool> needed(resourceCount, false);
+    
+    for (s32 i = passCount - 1; i >= 0; i--)
+    {
+        Pass& pass = m_passes[i];
+        
+        pass.culled = !pass.sideEffects && (pass.target < 0 || !needed[pass.target]);
+        
+        if (pass.culled)
+        {
+            LogVerbose("renderGraph", "pass '%s' culled\n", pass.name.c_str());
+            m_statistics.culledPasses++;
+            continue;
+        }
+        
+        // Render target is kept alive, because a pass may accumulate on top of previous contents
+        if (pass.target >= 0)
+        {
+            needed[pass.target] = true;
+        }
+        
+        for (size_t j = 0, n = pass.reads.size(); j < n; j++)
+        {
+            needed[pass.reads[j]] = true;
+        }
+        
+        m_statistics.passes++;
+    }
+    
+    // Calculate a lifetime of each resource as a range of passes that use it
+    for (s32 i = 0; i < resourceCount; i++)
+    {
+        m_resources[i].first    = -1;
+        m_resources[i].last     = -1;
+        m_resources[i].physical = -1;
+    }
+    
+    for (s32 i = 0; i < passCount; i++)
+    {
+        const Pass& pass = m_passes[i];
+        
+        if (pass.culled)
+        {
+            continue;
+        }
+        
+        for (s32 j = -1, n = static_cast<s32>(pass.reads.size()); j < n; j++)
+        {
+            Resource resource = j < 0 ? pass.target : pass.reads[j];
+            
+            if (resource < 0)
+            {
+                continue;
+            }
+            
+            TextureResource& texture = m_resources[resource];
+            texture.first = texture.first < 0 ? i : texture.first;
+            texture.last  = i;
+        }
+    }
+    
+    // Now alias resources, processing them in order of a first use
+    Array< std::pair<s32, s32> > order;
+    for (s32 i = 0; i < resourceCount; i++)
+    {
+        if (m_resources[i].first >= 0)
+        {
+            order.push_back(std::make_pair(m_resources[i].first, i));
+        }
+    }
+    std::sort(order.begin(), order.end());
+    
+    m_physical.clear();
+    
+    for (size_t i = 0, n = order.size(); i < n; i++)
+    {
+        TextureResource& texture = m_resources[order[i].second];
+        s32              bytes   = bytesPerTexture(texture.type, texture.width, texture.height, texture.options);
+        
+        // Find a physical texture with a matching description that is not used after this resource is written
+        for (s32 j = 0, count = static_cast<s32>(m_physical.size()); j < count; j++)
+        {
+            const PhysicalTexture& physical = m_physical[j];
+            
+            if (physical.last < texture.first && physical.type == texture.type && physical.width == texture.width && physical.height == texture.height && physical.options == texture.options)
+            {
+                texture.physical = j;
+                break;
+            }
+        }
+        
+        // Nothing found - allocate a new physical texture
+        if (texture.physical < 0)
+        {
+            PhysicalTexture physical;
+            physical.type    = texture.type;
+            physical.width   = texture.width;
+            physical.height  = texture.height;
+            physical.options = texture.options;
+            physical.first   = texture.first;
+            physical.last    = texture.last;
+            physical.bytes   = bytes;
+            m_physical.push_back(physical);
+            
+            texture.physical = static_cast<s32>(m_physical.size() - 1);
+            m_statistics.physicalBytes += bytes;
+        }
+        
+        m_physical[texture.physical].last = texture.last;
+        m_statistics.requestedBytes += bytes;
+        m_statistics.resources++;
+    }
+    
+    // A peak memory is a maximum size of physical textures that are alive at the same pass
+    for (s32 i = 0; i < passCount; i++)
+    {
+        s32 alive = 0;
+        
+        for (size_t j = 0, n = m_physical.size(); j < n; j++)
+        {
+            if (m_physical[j].first <= i && i <= m_physical[j].last)
+            {
+                alive += m_physical[j].bytes;
+            }
+        }
+        
+        m_statistics.peakBytes = max2(m_statistics.peakBytes, alive);
+    }
+    
+    m_statistics.physicalTextures = static_cast<s32>(m_physical.size());
+    m_isCompiled = true;
+    
+    LogVerbose("renderGraph", "%d passes (%d culled), %d transient textures aliased to %d (%d KB instead of %d KB, %d KB at peak)\n"
+               , m_statistics.passes, m_statistics.culledPasses, m_statistics.resources, m_statistics.physicalTextures, m_statistics.physicalBytes / 1024, m_statistics.requestedBytes / 1024, m_statistics.peakBytes / 1024);
+}
+
+// ** RenderGraph::execute
+void RenderGraph::execute(RenderCommandBuffer& commands)
+{
+    NIMBLE_ABORT_IF(!m_isCompiled, "a render graph should be compiled before execution");
+    
+    for (s32 i = 0, n = static_cast<s32>(m_passes.size()); i < n; i++)
+    {
+        const Pass& pass = m_passes[i];
+        
+        if (pass.culled)
+        {
+            continue;
+        }
+        
+        // Acquire physical textures that are first used by this pass
+        for (size_t j = 0, count = m_physical.size(); j < count; j++)
+        {
+            PhysicalTexture& physical = m_physical[j];
+            
+            if (physical.first != i)
+            {
+                continue;
+            }
+            
+            if (physical.type == TextureTypeCube)
+            {
+                physical.id = commands.acquireTextureCube(physical.width, physical.options);
+            }
+            else
+            {
+                physical.id = commands.acquireTexture2D(physical.width, physical.height, physical.options);
+            }
+        }
+        
+        // Cube map passes render to each side by themselves
+        if (pass.target >= 0 && m_resources[pass.target].type != TextureTypeCube)
+        {
+            pass.callback(commands.renderToTexture(texture(pass.target), pass.options, pass.viewport), *this);
+        }
+        else
+        {
+            pass.callback(commands, *this);
+        }
+        
+        // Release physical textures that are not used after this pass
+        for (size_t j = 0, count = m_physical.size(); j < count; j++)
+        {
+            PhysicalTexture& physical = m_physical[j];
+            
+            if (physical.last == i)
+            {
+                commands.releaseTexture(physical.id);
+                physical.id = TransientTexture();
+            }
+        }
+    }
+}
+    
+} // namespace Renderer
+
+DC_END_DREEMCHEST
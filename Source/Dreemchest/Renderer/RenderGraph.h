@@ -0,0 +1,158 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Renderer_RenderGraph_H__
+#define __DC_Renderer_RenderGraph_H__
+
+#include "Renderer.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Renderer
+{
+    //! A render graph records passes together with transient textures they read and write.
+    /*!
+     Once all passes are declared the graph is compiled: passes that do not contribute to
+     any pass with side effects are culled, lifetimes of transient textures are calculated
+     and textures with matching descriptions and non-overlapping lifetimes are aliased to
+     a single transient texture. The compiled graph is then executed by emitting acquire,
+     release and render to transient texture commands to a command buffer.
+     */
+    class RenderGraph
+    {
+    public:
+        
+        //! A transient texture handle declared by a render graph.
+        typedef s32                 Resource;
+        
+        //! A callback that records pass commands, the command buffer renders to a pass target if it has one.
+        typedef cClosure<void(RenderCommandBuffer&, const RenderGraph&)> PassCallback;
+        
+        //! Render graph statistics collected during compilation.
+        struct Statistics
+        {
+            s32                     passes;             //!< A total number of passes that will be executed.
+            s32                     culledPasses;       //!< A total number of culled passes.
+            s32                     resources;          //!< A total number of used transient textures.
+            s32                     physicalTextures;   //!< A total number of transient textures after aliasing.
+            s32                     requestedBytes;     //!< A total render target memory of all used transient textures without aliasing.
+            s32                     physicalBytes;      //!< A total render target memory of physical textures after aliasing.
+            s32                     peakBytes;          //!< A maximum render target memory that is alive during a single pass.
+        };
+        
+                                    //! Constructs a RenderGraph instance.
+                                    RenderGraph();
+        
+        //! Declares a transient 2D texture.
+        Resource                    createTexture2D(u16 width, u16 height, u32 options);
+        
+        //! Declares a transient cube texture.
+        Resource                    createTextureCube(u16 size, u32 options);
+        
+        //! Adds a new pass and returns it's index.
+        s32                         addPass(const String& name, const PassCallback& callback);
+        
+        //! Declares that a pass samples a specified texture.
+        void                        read(s32 pass, Resource resource);
+        
+        //! Declares that a pass renders to a specified texture, a single render target per pass is supported.
+        void                        write(s32 pass, Resource resource, u32 options = 0, const Rect& viewport = Rect(0.0f, 0.0f, 1.0f, 1.0f));
+        
+        //! Marks a pass as having side effects (e.g. renders to a viewport), such passes are never culled.
+        void                        setSideEffects(s32 pass);
+        
+        //! Culls unused passes, calculates resource lifetimes and aliases transient textures.
+        void                        compile();
+        
+        //! Emits all passes to a specified command buffer.
+        void                        execute(RenderCommandBuffer& commands);
+        
+        //! Returns a transient texture handle that corresponds to a resource, valid only while executing passes.
+        TransientTexture            texture(Resource resource) const;
+        
+        //! Returns statistics collected by the last compilation.
+        const Statistics&           statistics() const;
+        
+        //! Removes all passes and resources.
+        void                        clear();
+        
+    private:
+        
+        //! Returns a number of bytes required by a transient texture.
+        static s32                  bytesPerTexture(u8 type, u16 width, u16 height, u32 options);
+        
+    private:
+        
+        //! A transient texture description.
+        struct TextureResource
+        {
+            u8                      type;           //!< A texture type.
+            u16                     width;          //!< A texture width.
+            u16                     height;         //!< A texture height.
+            u32                     options;        //!< A texture options.
+            s32                     first;          //!< An index of the first pass that uses this texture or -1.
+            s32                     last;           //!< An index of the last pass that uses this texture or -1.
+            s32                     physical;       //!< An index of an aliased physical texture or -1.
+        };
+        
+        //! A physical transient texture that is shared by aliased resources.
+        struct PhysicalTexture
+        {
+            u8                      type;           //!< A texture type.
+            u16                     width;          //!< A texture width.
+            u16                     height;         //!< A texture height.
+            u32                     options;        //!< A texture options.
+            s32                     first;          //!< An index of the first pass that uses this texture.
+            s32                     last;           //!< An index of the last pass that uses this texture.
+            s32                     bytes;          //!< A texture size in bytes.
+            TransientTexture        id;             //!< An acquired transient texture while executing.
+        };
+        
+        //! A render graph pass.
+        struct Pass
+        {
+            String                  name;           //!< A pass name.
+            PassCallback            callback;       //!< A pass callback.
+            Array<Resource>         reads;          //!< Sampled textures.
+            Resource                target;         //!< A render target or -1.
+            u32                     options;        //!< Render target options.
+            Rect                    viewport;       //!< Render target viewport.
+            bool                    sideEffects;    //!< Indicates that a pass could not be culled.
+            bool                    culled;         //!< Indicates that a pass was culled.
+        };
+        
+        Array<Pass>                 m_passes;       //!< Declared passes.
+        Array<TextureResource>      m_resources;    //!< Declared transient textures.
+        Array<PhysicalTexture>      m_physical;     //!< Physical transient textures after aliasing.
+        Statistics                  m_statistics;   //!< Compilation statistics.
+        bool                        m_isCompiled;   //!< Indicates that a graph was compiled.
+    };
+    
+} // namespace Renderer
+
+DC_END_DREEMCHEST
+
+#endif  /*  !__DC_Renderer_RenderGraph_H__   */
@@ -0,0 +1,274 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "RenderProfiler.h"
+
+#if DREEMCHEST_CPP11
+    #include <chrono>
+#endif  /*  #if DREEMCHEST_CPP11    */
+
+DC_BEGIN_DREEMCHEST
+
+namespace Renderer
+{
+
+// ** RenderProfiler::RenderProfiler
+RenderProfiler::RenderProfiler()
+    : m_isEnabled(false)
+    , m_capturedFrameCount(1)
+    , m_frameIndex(0)
+    , m_isActive(false)
+{
+}
+
+// ** RenderProfiler::isEnabled
+bool RenderProfiler::isEnabled() const
+{
+    return m_isEnabled;
+}
+
+// ** RenderProfiler::setEnabled
+void RenderProfiler::setEnabled(bool value)
+{
+    m_isEnabled = value;
+}
+
+// ** RenderProfiler::setCapturedFrameCount
+void RenderProfiler::setCapturedFrameCount(s32 value)
+{
+    NIMBLE_ABORT_IF(value < 1, "at least one frame should be captured");
+    m_capturedFrameCount = value;
+}
+
+// ** RenderProfiler::capturedFrameCount
+s32 RenderProfiler::capturedFrameCount() const
+{
+    return static_cast<s32>(m_frames.size()) - (m_isActive ? 1 : 0);
+}
+
+// ** RenderProfiler::capturedFrame
+const RenderProfiler::Frame& RenderProfiler::capturedFrame(s32 index) const
+{
+    NIMBLE_ABORT_IF(index < 0 || index >= capturedFrameCount(), "index is out of range");
+    
+    List<Frame>::const_iterator i = m_frames.begin();
+    std::advance(i, index);
+    return *i;
+}
+
+// ** RenderProfiler::lastFrame
+const RenderProfiler::Frame* RenderProfiler::lastFrame() const
+{
+    s32 count = capturedFrameCount();
+    return count ? &capturedFrame(count - 1) : NULL;
+}
+
+// ** RenderProfiler::beginFrame
+void RenderProfiler::beginFrame()
+{
+    if (!m_isEnabled)
+    {
+        return;
+    }
+    
+    // Drop the oldest frames
+    while (static_cast<s32>(m_frames.size()) >= m_capturedFrameCount)
+    {
+        m_frames.pop_front();
+    }
+    
+    m_frames.push_back(Frame());
+    
+    Frame& frame = m_frames.back();
+    frame.index  = m_frameIndex++;
+    frame.begin  = timestamp();
+    frame.end    = frame.begin;
+    
+    m_stack.clear();
+    m_isActive = true;
+}
+
+// ** RenderProfiler::endFrame
+void RenderProfiler::endFrame()
+{
+    if (!m_isActive)
+    {
+        return;
+    }
+    
+    NIMBLE_BREAK_IF(!m_stack.empty(), "not all profiler scopes were closed");
+    
+    m_frames.back().end = timestamp();
+    m_isActive = false;
+}
+
+// ** RenderProfiler::beginScope
+RenderProfiler::Scope& RenderProfiler::beginScope(CString name, u64 recordTime, const FrameCounters& counters)
+{
+    NIMBLE_ABORT_IF(!m_isActive, "no frame is being profiled");
+    
+    Array<Scope>& scopes = m_frames.back().scopes;
+    
+    Scope scope;
+    scope.name         = name;
+    scope.parent       = m_stack.empty() ? -1 : m_stack.back();
+    scope.depth        = static_cast<s32>(m_stack.size());
+    scope.recordBegin  = recordTime;
+    scope.recordEnd    = recordTime;
+    scope.executeBegin = timestamp();
+    scope.executeEnd   = scope.executeBegin;
+    scope.gpuTime      = -1;
+    scope.timerQuery   = -1;
+    scope.counters     = counters;
+    
+    m_stack.push_back(static_cast<s32>(scopes.size()));
+    scopes.push_back(scope);
+    
+    return scopes.back();
+}
+
+// ** RenderProfiler::endScope
+RenderProfiler::Scope* RenderProfiler::endScope(u64 recordTime, const FrameCounters& counters)
+{
+    if (!m_isActive || m_stack.empty())
+    {
+        LogWarning("profiler", "%s", "closing a profiler scope that was never opened\n");
+        return NULL;
+    }
+    
+    Scope& scope = m_frames.back().scopes[m_stack.back()];
+    m_stack.pop_back();
+    
+    scope.recordEnd  = recordTime;
+    scope.executeEnd = timestamp();
+    
+    // Counters stored at the beginning of a scope are turned to deltas
+    scope.counters.drawCalls            = counters.drawCalls            - scope.counters.drawCalls;
+    scope.counters.programSwitches      = counters.programSwitches      - scope.counters.programSwitches;
+    scope.counters.inputLayoutSwitches  = counters.inputLayoutSwitches  - scope.counters.inputLayoutSwitches;
+    scope.counters.uniformsUploaded     = counters.uniformsUploaded     - scope.counters.uniformsUploaded;
+    scope.counters.permutationsCompiled = counters.permutationsCompiled - scope.counters.permutationsCompiled;
+    scope.counters.stateSwitches        = counters.stateSwitches        - scope.counters.stateSwitches;
+    
+    return &scope;
+}
+
+// ** RenderProfiler::clear
+void RenderProfiler::clear()
+{
+    m_frames.clear();
+    m_stack.clear();
+    m_isActive = false;
+}
+
+// ** RenderProfiler::chromeTrace
+String RenderProfiler::chromeTrace() const
+{
+    //! Execution events are written to a first thread lane, recording events to a second one.
+    enum { ExecutionLane, RecordingLane };
+    
+    s32 count = capturedFrameCount();
+    
+    if (count == 0)
+    {
+        return "{\"traceEvents\":[]}";
+    }
+    
+    // All timestamps are exported relative to the earliest one
+    u64 origin = capturedFrame(0).begin;
+    
+    for (s32 i = 0; i < count; i++)
+    {
+        const Array<Scope>& scopes = capturedFrame(i).scopes;
+        
+        for (size_t j = 0, n = scopes.size(); j < n; j++)
+        {
+            origin = min2(origin, scopes[j].recordBegin);
+        }
+    }
+    
+    String trace = "{\"traceEvents\":[\n";
+    char event[512];
+    
+    for (s32 i = 0; i < count; i++)
+    {
+        const Frame& frame = capturedFrame(i);
+        
+        // Write a frame event
+        _snprintf(event, sizeof(event), "%s{\"name\":\"Frame %u\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%llu,\"dur\":%llu}"
+                  , i ? ",\n" : ""
+                  , frame.index
+                  , ExecutionLane
+                  , static_cast<unsigned long long>(frame.begin - origin)
+                  , static_cast<unsigned long long>(frame.end - frame.begin));
+        trace += event;
+        
+        // Write an execution and a recording event for each scope
+        for (size_t j = 0, n = frame.scopes.size(); j < n; j++)
+        {
+            const Scope& scope = frame.scopes[j];
+            
+            _snprintf(event, sizeof(event), ",\n{\"name\":\"%s\",\"cat\":\"execute\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%llu,\"dur\":%llu,\"args\":{\"drawCalls\":%d,\"stateSwitches\":%d,\"programSwitches\":%d,\"inputLayoutSwitches\":%d,\"uniformsUploaded\":%d,\"permutationsCompiled\":%d,\"gpuTime\":%lld}}"
+                      , scope.name
+                      , ExecutionLane
+                      , static_cast<unsigned long long>(scope.executeBegin - origin)
+                      , static_cast<unsigned long long>(scope.executeEnd - scope.executeBegin)
+                      , scope.counters.drawCalls
+                      , scope.counters.stateSwitches
+                      , scope.counters.programSwitches
+                      , scope.counters.inputLayoutSwitches
+                      , scope.counters.uniformsUploaded
+                      , scope.counters.permutationsCompiled
+                      , static_cast<long long>(scope.gpuTime));
+            trace += event;
+            
+            _snprintf(event, sizeof(event), ",\n{\"name\":\"%s\",\"cat\":\"record\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%llu,\"dur\":%llu}"
+                      , scope.name
+                      , RecordingLane
+                      , static_cast<unsigned long long>(scope.recordBegin - origin)
+                      , static_cast<unsigned long long>(scope.recordEnd - scope.recordBegin));
+            trace += event;
+        }
+    }
+    
+    trace += "\n]}\n";
+    
+    return trace;
+}
+
+// ** RenderProfiler::timestamp
+u64 RenderProfiler::timestamp()
+{
+#if DREEMCHEST_CPP11
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#else
+    return Platform::currentTime() * 1000;
+#endif  /*  #if DREEMCHEST_CPP11    */
+}
+
+} // namespace Renderer
+
+DC_END_DREEMCHEST
@@ -0,0 +1,132 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Renderer_RenderProfiler_H__
+#define __DC_Renderer_RenderProfiler_H__
+
+#include "Renderer.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Renderer
+{
+    //! A rendering context counters.
+    struct FrameCounters
+    {
+        s32                             drawCalls;              //!< A total number of issued draw calls.
+        s32                             programSwitches;        //!< A total number of times shader program was switched.
+        s32                             inputLayoutSwitches;    //!< A total number of times an input layout was switched.
+        s32                             uniformsUploaded;       //!< A total number of uniforms that were uploaded.
+        s32                             permutationsCompiled;   //!< A total number of new program permutations compiled.
+        s32                             stateSwitches;          //!< Recorded number of state changes.
+    };
+    
+    //! Render profiler collects a hierarchy of named scopes pushed to command buffers with their timings and counters.
+    class RenderProfiler
+    {
+    public:
+        
+        //! A single profiled scope of a frame.
+        struct Scope
+        {
+            CString                     name;                   //!< A scope name.
+            s32                         parent;                 //!< A parent scope index or -1 for root scopes.
+            s32                         depth;                  //!< A scope nesting depth.
+            u64                         recordBegin;            //!< A time in microseconds when a scope recording started.
+            u64                         recordEnd;              //!< A time in microseconds when a scope recording ended.
+            u64                         executeBegin;           //!< A time in microseconds when a scope execution started.
+            u64                         executeEnd;             //!< A time in microseconds when a scope execution ended.
+            s64                         gpuTime;                //!< A GPU time in microseconds or -1 if timer queries are not supported.
+            s32                         timerQuery;             //!< A backend timer query or -1.
+            FrameCounters               counters;               //!< Counters accumulated inside this scope including nested scopes.
+        };
+        
+        //! A profiled frame.
+        struct Frame
+        {
+            u32                         index;                  //!< A frame index.
+            u64                         begin;                  //!< A time in microseconds when a frame execution started.
+            u64                         end;                    //!< A time in microseconds when a frame execution ended.
+            Array<Scope>                scopes;                 //!< All scopes executed by this frame in execution order.
+        };
+        
+                                        //! Constructs a RenderProfiler instance.
+                                        RenderProfiler();
+        
+        //! Returns true if profiling is enabled.
+        bool                            isEnabled() const;
+        
+        //! Enables or disables profiling.
+        void                            setEnabled(bool value);
+        
+        //! Sets a maximum number of recent frames that are kept for a trace export.
+        void                            setCapturedFrameCount(s32 value);
+        
+        //! Returns a total number of captured frames.
+        s32                             capturedFrameCount() const;
+        
+        //! Returns a captured frame at specified index starting from the oldest one.
+        const Frame&                    capturedFrame(s32 index) const;
+        
+        //! Returns the last completely profiled frame.
+        const Frame*                    lastFrame() const;
+        
+        //! Starts profiling a new frame.
+        void                            beginFrame();
+        
+        //! Finishes profiling a current frame.
+        void                            endFrame();
+        
+        //! Opens a new scope.
+        Scope&                          beginScope(CString name, u64 recordTime, const FrameCounters& counters);
+        
+        //! Closes an active scope and returns it.
+        Scope*                          endScope(u64 recordTime, const FrameCounters& counters);
+        
+        //! Discards all captured frames.
+        void                            clear();
+        
+        //! Exports all captured frames in a Chrome trace event format.
+        String                          chromeTrace() const;
+        
+        //! Returns a current time in microseconds.
+        static u64                      timestamp();
+        
+    private:
+        
+        bool                            m_isEnabled;            //!< Indicates that profiling is enabled.
+        s32                             m_capturedFrameCount;   //!< A maximum number of captured frames.
+        List<Frame>                     m_frames;               //!< Recent profiled frames, the last one is being recorded.
+        Array<s32>                      m_stack;                //!< Active scope indices.
+        u32                             m_frameIndex;           //!< A next frame index.
+        bool                            m_isActive;             //!< Indicates that a frame is being profiled.
+    };
+    
+} // namespace Renderer
+
+DC_END_DREEMCHEST
+
+#endif  /*  !__DC_Renderer_RenderProfiler_H__   */
@@ -367,11 +367,13 @@ namespace Renderer {
     typedef UPtr<class RenderFrame> RenderFrameUPtr;
     
     struct State;
+    struct OpCode;
     class StateBlock;
     class VertexFormat;
     struct UniformElement;
     class RenderFrame;
     class PipelineFeatureLayout;
+    class UploadRing;
     
     class CommandBuffer;
         class RenderCommandBuffer;
@@ -663,6 +665,9 @@ DC_END_DREEMCHEST
 #ifndef DC_BUILD_LIBRARY
     #include "BatchRenderer.h"
     #include "Renderer2D.h"
+    #include "RenderGraph.h"
+    #include "UploadRing.h"
+    #include "RenderProfiler.h"
     #include "RenderingContext.h"
     #include "RenderingContext.h"
 #endif
@@ -43,19 +43,20 @@ namespace Renderer
 /*!
  Transient target stack is used to convert local indices that are
  stored in commands to a global index of an transient resources.
+ Transient indices are allocated by a render frame and shared by all it's
+ command buffers, so a nested command buffer can use resources acquired
+ by it's parents (e.g. sample a shadow map while rendering to another target).
+ An index is returned to a frame when a release command is executed.
  */
 class RenderingContext::TransientResourceStack
 {
 public:
     
-    //! A maximum number of intermediate render targets that can be hold by a single stack frame.
-    enum { StackFrameSize = 8 };
+    //! A maximum number of transient resources that can be loaded at once.
+    enum { MaxTransientResources = 256 };
     
     //! A maximum number of stack frames that can be pushed during rendering.
-    enum { MaxStackFrames = 8 };
-    
-    //! A total size of an intermediate stack size.
-    enum { MaxStackSize = MaxStackFrames * StackFrameSize };
+    enum { MaxStackFrames = 32 };
     
                                 //! Constructs an TransientResourceStack instance.
                                 TransientResourceStack();
@@ -77,61 +78,66 @@ public:
     
 private:
     
-    ResourceId*                 m_stackFrame;                   //!< An active render target stack frame.
-    ResourceId                  m_identifiers[MaxStackSize];    //!< An array of intermediate render target handles.
+    s32                         m_depth;                                //!< An active stack frame depth.
+    ResourceId                  m_identifiers[MaxTransientResources];   //!< An array of intermediate render target handles.
+    u8                          m_frames[MaxTransientResources];        //!< A stack frame depth each resource was loaded at.
 };
 
 // ** RenderingContext::TransientResourceStack::TransientResourceStack
 RenderingContext::TransientResourceStack::TransientResourceStack( void )
-    : m_stackFrame( m_identifiers )
+    : m_depth( 0 )
 {
     memset(m_identifiers, 0, sizeof(m_identifiers));
+    memset(m_frames, 0, sizeof(m_frames));
 }
 
 // ** RenderingContext::TransientResourceStack::pushFrame
 void RenderingContext::TransientResourceStack::pushFrame( void )
 {
-    NIMBLE_ABORT_IF( (m_stackFrame + StackFrameSize) > (m_identifiers + MaxStackSize), "frame stack overflow" );
-    m_stackFrame += StackFrameSize;
+    NIMBLE_ABORT_IF( m_depth + 1 >= MaxStackFrames, "frame stack overflow" );
+    m_depth++;
 }
 
 // ** RenderingContext::TransientResourceStack::popFrame
 void RenderingContext::TransientResourceStack::popFrame( void )
 {
-    NIMBLE_ABORT_IF( m_stackFrame == m_identifiers, "stack underflow" );
+    NIMBLE_ABORT_IF( m_depth == 0, "stack underflow" );
     
-    // Ensure that all render targets were released
-    for( s32 i = 0; i < StackFrameSize; i++ )
+    // Ensure that all render targets loaded by this frame were released
+    for( s32 i = 0; i < MaxTransientResources; i++ )
     {
-        if( m_stackFrame[i] )
+        if( m_identifiers[i] && m_frames[i] == m_depth )
         {
             LogWarning( "rvm", "%s", "an intermediate render target was not released before popping a stack frame\n" );
+            m_identifiers[i] = 0;
         }
     }
     
     // Pop a stack frame
-    m_stackFrame -= StackFrameSize;
+    m_depth--;
 }
 
 // ** RenderingContext::TransientResourceStack::get
 ResourceId RenderingContext::TransientResourceStack::get(TransientResourceId index) const
 {
     NIMBLE_ABORT_IF( index == 0, "invalid render target index" );
-    return m_stackFrame[index - 1];
+    return m_identifiers[index];
 }
 
 // ** RenderingContext::TransientResourceStack::load
 void RenderingContext::TransientResourceStack::load(TransientResourceId index, ResourceId id)
 {
     NIMBLE_ABORT_IF( index == 0, "invalid render target index" );
-    m_stackFrame[index - 1] = id;
+    NIMBLE_ABORT_IF( m_identifiers[index], "transient resource slot is already in use" );
+    m_identifiers[index] = id;
+    m_frames[index]      = static_cast<u8>( m_depth );
 }
 
 // ** RenderingContext::TransientResourceStack::unload
 void RenderingContext::TransientResourceStack::unload(TransientResourceId index)
 {
     NIMBLE_ABORT_IF( index == 0, "invalid render target index" );
-    m_stackFrame[index - 1] = 0;
+    m_identifiers[index] = 0;
 }
     
 // -------------------------------------------------------------------------------- RenderingContext -------------------------------------------------------------------------------- //
@@ -140,7 +146,9 @@ void RenderingContext::TransientResourceStack::unload(TransientResourceId index)
 RenderingContext::RenderingContext(RenderViewPtr view)
     : m_view(view)
     , m_shaderLibrary(*this)
+    , m_uploadRing(1024 * 512)
     , m_frame(*this)
+    , m_precompileBudget(0)
 {
     LogDebug("renderingContext", "rendering context size is %d bytes\n", sizeof(RenderingContext));
     LogDebug("renderingContext", "rendering state size is %d bytes\n", sizeof(State));
@@ -315,6 +323,81 @@ RenderFrame& RenderingContext::allocateFrame(s32 size)
     return m_frame;
 }
 
+// ** RenderingContext::profiler
+RenderProfiler& RenderingContext::profiler()
+{
+    return m_profiler;
+}
+
+// ** RenderingContext::saveProfilerTrace
+bool RenderingContext::saveProfilerTrace(const String& fileName) const
+{
+    Io::StreamPtr stream = Io::DiskFileSystem::open(fileName, Io::BinaryWriteStream);
+    
+    if (!stream.valid())
+    {
+        LogWarning("renderingContext", "failed to write a profiler trace to '%s'\n", fileName.c_str());
+        return false;
+    }
+    
+    String trace = m_profiler.chromeTrace();
+    stream->write(trace.c_str(), static_cast<s32>(trace.length()));
+    
+    return true;
+}
+
+// ** RenderingContext::beginProfileScope
+void RenderingContext::beginProfileScope(const OpCode& opCode)
+{
+    if (!m_profiler.isEnabled())
+    {
+        return;
+    }
+    
+    RenderProfiler::Scope& scope = m_profiler.beginScope(opCode.profile.name, opCode.profile.timestamp, m_counters);
+    scope.timerQuery = beginGpuTimer();
+}
+
+// ** RenderingContext::endProfileScope
+void RenderingContext::endProfileScope(const OpCode& opCode)
+{
+    if (!m_profiler.isEnabled())
+    {
+        return;
+    }
+    
+    RenderProfiler::Scope* scope = m_profiler.endScope(opCode.profile.timestamp, m_counters);
+    
+    if (scope && scope->timerQuery >= 0)
+    {
+        endGpuTimer(scope->timerQuery);
+        scope->gpuTime = gpuTimerResult(scope->timerQuery);
+    }
+}
+
+// ** RenderingContext::beginGpuTimer
+s32 RenderingContext::beginGpuTimer()
+{
+    return -1;
+}
+
+// ** RenderingContext::endGpuTimer
+void RenderingContext::endGpuTimer(s32 query)
+{
+}
+
+// ** RenderingContext::gpuTimerResult
+s64 RenderingContext::gpuTimerResult(s32 query)
+{
+    return -1;
+}
+
+// ** RenderingContext::uploadRing
+UploadRing& RenderingContext::uploadRing()
+{
+    return m_uploadRing;
+}
+
 // ** RenderingContext::display
 void RenderingContext::display(RenderFrame& frame, bool wait)
 {
@@ -327,14 +410,26 @@ void RenderingContext::display(RenderFrame& frame, bool wait)
     // Clear all counters.
     memset(&m_counters, 0, sizeof(m_counters));
     
+    // Start profiling a frame
+    m_profiler.beginFrame();
+    
     // Reset active rendering states
     memset(m_activeStates, 0, sizeof(m_activeStates));
     
+    // Queue manifest permutations that should be precompiled this frame
+    queuePendingPermutations();
+    
     // First execute a construction command buffer
     construct();
     
     // Execute an entry point command buffer
     execute(frame.entryPoint());
+    
+    // All frame uploads were consumed, so close an upload ring segment
+    m_uploadRing.endFrame();
+    
+    // Finish profiling a frame
+    m_profiler.endFrame();
 
     // End frame
     if (m_view.valid())
@@ -373,6 +468,7 @@ void RenderingContext::loadTransientResource(TransientResourceId transient, Reso
 void RenderingContext::unloadTransientResource(TransientResourceId transient)
 {
     m_transientResources->unload(transient);
+    m_frame.releaseTransientSlot(transient);
 }
     
 // ** RenderingContext::transientTarget
@@ -398,7 +494,7 @@ void RenderingContext::releaseIdentifier(RenderResourceType::Enum type, Resource
 InputLayout RenderingContext::requestInputLayout(const VertexFormat& format)
 {
     // First lookup a previously constucted input layout
-    InputLayout id = m_inputLayoutCache[format];
+    InputLayout id = m_inputLayoutCache[format.key()];
     
     if( id )
     {
@@ -412,7 +508,7 @@ InputLayout RenderingContext::requestInputLayout(const VertexFormat& format)
     id = m_resourceCommandBuffer->createInputLayout(id, format);
     
     // Now put a new input layout to cache
-    m_inputLayoutCache[format] = id;
+    m_inputLayoutCache[format.key()] = id;
     
     return id;
 }
@@ -469,6 +565,9 @@ FeatureLayout RenderingContext::requestPipelineFeatureLayout(const PipelineFeatu
     
     // Put this layout instance to a pool
     m_pipelineFeatureLayouts.emplace(id, layout);
+    
+    // Register this layout, so it can be referenced from a permutation manifest
+    m_featureLayoutByHash.insert(std::make_pair(ShaderLibrary::featureLayoutHash(layout), id));
 
     return id;
 }
@@ -481,10 +580,10 @@ VertexBuffer_ RenderingContext::requestVertexBuffer( const void* data, s32 size
 }
 
 // ** RenderingContext::requestIndexBuffer
-IndexBuffer_ RenderingContext::requestIndexBuffer( const void* data, s32 size )
+IndexBuffer_ RenderingContext::requestIndexBuffer( const void* data, s32 size, s32 indexSize )
 {
     IndexBuffer_ id = allocateIdentifier(RenderResourceType::IndexBuffer);
-    return m_resourceCommandBuffer->createIndexBuffer(id, data, size);
+    return m_resourceCommandBuffer->createIndexBuffer(id, data, size, indexSize);
 }
 
 // ** RenderingContext::requestConstantBuffer
@@ -553,13 +652,202 @@ Program RenderingContext::requestProgram(const ShaderProgramDescriptor& descript
     // Put this program to a pool
     m_programs.emplace(id, descriptor);
     
+    // Register this program, so it can be referenced from a permutation manifest
+    m_programByHash.insert(std::make_pair(m_shaderLibrary.programHash(descriptor), id));
+    
     return id;
 }
     
 // ** RenderingContext::precompilePermutations
 void RenderingContext::precompilePermutations(Program id, FeatureLayout features)
 {
-    m_resourceCommandBuffer->precompilePermutation(id, 0);
+    m_resourceCommandBuffer->precompilePermutation(id, features, 0);
+}
+
+// ** RenderingContext::precompilePermutations
+s32 RenderingContext::precompilePermutations(const String& manifest)
+{
+    s32 count = parsePermutationManifest(manifest, m_pendingPermutations);
+    LogVerbose("renderingContext", "%d permutations queued for precompilation\n", count);
+    return count;
+}
+
+// ** RenderingContext::parsePermutationManifest
+s32 RenderingContext::parsePermutationManifest(const String& manifest, PendingPermutations& permutations)
+{
+    s32 count = 0;
+    
+    for (size_t start = 0; start < manifest.length();)
+    {
+        // Extract a next manifest line
+        size_t end = manifest.find('\n', start);
+        
+        if (end == String::npos)
+        {
+            end = manifest.length();
+        }
+        
+        String line = manifest.substr(start, end - start);
+        start = end + 1;
+        
+        // Skip empty lines and comments
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        
+        // Parse a permutation entry
+        u32 program, featureLayout, featuresHigh, featuresLow;
+        
+        if (sscanf(line.c_str(), "%x %x %8x%8x", &program, &featureLayout, &featuresHigh, &featuresLow) != 4)
+        {
+            LogWarning("renderingContext", "malformed permutation manifest entry '%s'\n", line.c_str());
+            continue;
+        }
+        
+        PermutationEntry entry;
+        entry.program       = program;
+        entry.featureLayout = featureLayout;
+        entry.features      = (static_cast<PipelineFeatures>(featuresHigh) << 32) | featuresLow;
+        permutations.push_back(entry);
+        count++;
+    }
+    
+    return count;
+}
+
+// ** RenderingContext::loadPermutationManifest
+s32 RenderingContext::loadPermutationManifest(const String& fileName)
+{
+    String manifest = Io::DiskFileSystem::readTextFile(fileName);
+    
+    if (manifest.empty())
+    {
+        LogVerbose("renderingContext", "no permutation manifest found at '%s'\n", fileName.c_str());
+        return 0;
+    }
+    
+    return precompilePermutations(manifest);
+}
+
+// ** RenderingContext::permutationManifest
+String RenderingContext::permutationManifest() const
+{
+    return formatPermutationManifest(m_permutationManifest);
+}
+
+// ** RenderingContext::formatPermutationManifest
+String RenderingContext::formatPermutationManifest(const PermutationManifest& permutations)
+{
+    String manifest = "# program layout features\n";
+    
+    for (PermutationManifest::const_iterator i = permutations.begin(), end = permutations.end(); i != end; ++i)
+    {
+        char line[64];
+        _snprintf(line, sizeof(line), "%08x %08x %08x%08x\n", i->program, i->featureLayout, static_cast<u32>(i->features >> 32), static_cast<u32>(i->features));
+        manifest += line;
+    }
+    
+    return manifest;
+}
+
+// ** RenderingContext::savePermutationManifest
+bool RenderingContext::savePermutationManifest(const String& fileName) const
+{
+    Io::StreamPtr stream = Io::DiskFileSystem::open(fileName, Io::BinaryWriteStream);
+    
+    if (!stream.valid())
+    {
+        LogWarning("renderingContext", "failed to write a permutation manifest to '%s'\n", fileName.c_str());
+        return false;
+    }
+    
+    String manifest = permutationManifest();
+    stream->write(manifest.c_str(), static_cast<s32>(manifest.length()));
+    
+    return true;
+}
+
+// ** RenderingContext::setPrecompileBudget
+void RenderingContext::setPrecompileBudget(s32 value)
+{
+    m_precompileBudget = value;
+}
+
+// ** RenderingContext::pendingPermutationCount
+s32 RenderingContext::pendingPermutationCount() const
+{
+    return static_cast<s32>(m_pendingPermutations.size());
+}
+
+// ** RenderingContext::queuePendingPermutations
+void RenderingContext::queuePendingPermutations()
+{
+    s32 queued = 0;
+    
+    for (PendingPermutations::iterator i = m_pendingPermutations.begin(); i != m_pendingPermutations.end();)
+    {
+        // This frame has exhausted it's precompilation budget
+        if (m_precompileBudget && queued >= m_precompileBudget)
+        {
+            break;
+        }
+        
+        // A program is not requested yet, so keep this entry until it is
+        Map<u32, Program>::const_iterator program = m_programByHash.find(i->program);
+        
+        if (program == m_programByHash.end())
+        {
+            ++i;
+            continue;
+        }
+        
+        // Zero hash stands for permutations compiled without a feature layout
+        FeatureLayout featureLayout;
+        
+        if (i->featureLayout)
+        {
+            Map<u32, FeatureLayout>::const_iterator layout = m_featureLayoutByHash.find(i->featureLayout);
+            
+            if (layout == m_featureLayoutByHash.end())
+            {
+                ++i;
+                continue;
+            }
+            
+            featureLayout = layout->second;
+        }
+        
+        m_resourceCommandBuffer->precompilePermutation(program->second, featureLayout, i->features);
+        i = m_pendingPermutations.erase(i);
+        queued++;
+    }
+}
+
+// ** RenderingContext::recordPermutation
+void RenderingContext::recordPermutation(ResourceId program, const PipelineFeatureLayout* featureLayout, PipelineFeatures features)
+{
+    PermutationEntry entry;
+    entry.program       = m_shaderLibrary.programHash(m_programs[program]);
+    entry.featureLayout = ShaderLibrary::featureLayoutHash(featureLayout);
+    entry.features      = features;
+    m_permutationManifest.insert(entry);
+}
+
+// ** RenderingContext::PermutationEntry::operator <
+bool RenderingContext::PermutationEntry::operator < (const PermutationEntry& other) const
+{
+    if (program != other.program)
+    {
+        return program < other.program;
+    }
+    
+    if (featureLayout != other.featureLayout)
+    {
+        return featureLayout < other.featureLayout;
+    }
+    
+    return features < other.features;
 }
 
 // ** RenderingContext::requestProgram
@@ -601,6 +889,12 @@ Program RenderingContext::requestProgram(const String& vertex)
     return id;
 }
 
+// ** RenderingContext::deleteTexture
+void RenderingContext::deleteTexture(Texture_ id)
+{
+    m_resourceCommandBuffer->deleteTexture(id);
+}
+
 // ** RenderingContext::deleteConstantBuffer
 void RenderingContext::deleteConstantBuffer(ConstantBuffer_ id)
 {
@@ -618,6 +912,14 @@ void RenderingContext::deleteUniformLayout(UniformLayout id)
 // ** RenderingContext::deleteConstantBuffer
 void RenderingContext::deleteProgram(Program id)
 {
+    // Unregister a program hash
+    Map<u32, Program>::iterator i = m_programByHash.find(m_shaderLibrary.programHash(m_programs[id]));
+    
+    if (i != m_programByHash.end() && i->second == id)
+    {
+        m_programByHash.erase(i);
+    }
+    
     m_resourceCommandBuffer->deleteProgram(id);
 }
 
@@ -638,26 +940,31 @@ VertexBufferLayoutUPtr RenderingContext::createVertexBufferLayout(VertexFormat v
     // Create an input layout
     VertexBufferLayoutUPtr inputLayout = DC_NEW VertexBufferLayout(vertexFormat.vertexSize());
     
+    // Packed attributes are expanded to floats by the vertex fetch
+    VertexBufferLayout::ElementType positionType = vertexFormat.isPacked(VertexFormat::PackedPosition)  ? VertexBufferLayout::Float16 : VertexBufferLayout::Float32;
+    VertexBufferLayout::ElementType normalType   = vertexFormat.isPacked(VertexFormat::PackedNormal)    ? VertexBufferLayout::Int8    : VertexBufferLayout::Float32;
+    VertexBufferLayout::ElementType uvType       = vertexFormat.isPacked(VertexFormat::PackedTexCoords) ? VertexBufferLayout::Float16 : VertexBufferLayout::Float32;
+    
     // Add vertex attributes to an input layout
     if(vertexFormat & VertexFormat::Position)
     {
-        inputLayout->attributeLocation(VertexPosition, 3, vertexFormat.attributeOffset(VertexFormat::Position));
+        inputLayout->attributeLocation(VertexPosition, 3, vertexFormat.attributeOffset(VertexFormat::Position), positionType);
     }
     if(vertexFormat & VertexFormat::Color)
     {
-        inputLayout->attributeLocation(VertexColor, 4, vertexFormat.attributeOffset(VertexFormat::Color));
+        inputLayout->attributeLocation(VertexColor, 4, vertexFormat.attributeOffset(VertexFormat::Color), VertexBufferLayout::UInt8, true);
     }
     if(vertexFormat & VertexFormat::Normal)
     {
-        inputLayout->attributeLocation(VertexNormal, 3, vertexFormat.attributeOffset(VertexFormat::Normal));
+        inputLayout->attributeLocation(VertexNormal, 3, vertexFormat.attributeOffset(VertexFormat::Normal), normalType, normalType != VertexBufferLayout::Float32);
     }
     if(vertexFormat & VertexFormat::TexCoord0)
     {
-        inputLayout->attributeLocation(VertexTexCoord0, 2, vertexFormat.attributeOffset(VertexFormat::TexCoord0));
+        inputLayout->attributeLocation(VertexTexCoord0, 2, vertexFormat.attributeOffset(VertexFormat::TexCoord0), uvType);
     }
     if(vertexFormat & VertexFormat::TexCoord1)
     {
-        inputLayout->attributeLocation(VertexTexCoord1, 2, vertexFormat.attributeOffset(VertexFormat::TexCoord1));
+        inputLayout->attributeLocation(VertexTexCoord1, 2, vertexFormat.attributeOffset(VertexFormat::TexCoord1), uvType);
     }
     
     return inputLayout;
@@ -31,6 +31,9 @@
 #include "RenderFrame.h"
 #include "PipelineFeatureLayout.h"
 #include "ShaderLibrary.h"
+#include "UploadRing.h"
+#include "RenderProfiler.h"
+#include "VertexFormat.h"
 
 DC_BEGIN_DREEMCHEST
 
@@ -42,15 +45,25 @@ namespace Renderer
     public:
         
         //! A rendering context counters.
-        struct FrameCounters
+        typedef Renderer::FrameCounters         FrameCounters;
+        
+        //! A permutation manifest entry identifies a program permutation by content hashes instead of resource identifiers.
+        struct PermutationEntry
         {
-            s32                                 programSwitches;        //!< A total number of times shader program was switched.
-            s32                                 inputLayoutSwitches;    //!< A total number of times an input layout was switched.
-            s32                                 uniformsUploaded;       //!< A total number of uniforms that were uploaded.
-            s32                                 permutationsCompiled;   //!< A total number of new program permutations compiled.
-            s32                                 stateSwitches;          //!< Recorded number of state changes.
+            u32                                 program;                //!< A program source code hash.
+            u32                                 featureLayout;          //!< A feature layout hash.
+            PipelineFeatures                    features;               //!< A permutation feature mask.
+            
+            //! Compares two permutation entries.
+            bool                                operator < (const PermutationEntry& other) const;
         };
         
+        //! A set of unique permutations compiled during a session.
+        typedef Set<PermutationEntry>           PermutationManifest;
+        
+        //! A list of manifest permutations waiting for precompilation.
+        typedef List<PermutationEntry>          PendingPermutations;
+        
         //! Rendering context capabilities
         struct Caps
         {
@@ -58,6 +71,7 @@ namespace Renderer
             s32                                 maxTextures;            //!< A maximum number of textures that can be bound simultaneously.
             s32                                 maxCubeMapSize;         //!< A maximum supported cube map size.
             s32                                 maxTextureSize;         //!< A maximum supported texture size.
+            bool                                uintIndices;            //!< Indicates that 32-bit index buffers are supported.
         };
         
         //! Cleans all allocated resources.
@@ -73,6 +87,12 @@ namespace Renderer
         //! Returns last frame rendering counters.
         const FrameCounters&                    frameCounters() const;
         
+        //! Returns a render profiler that collects named scopes pushed to command buffers.
+        RenderProfiler&                         profiler();
+        
+        //! Exports frames captured by a profiler to a Chrome trace file.
+        bool                                    saveProfilerTrace(const String& fileName) const;
+        
         //! Returns a device capabilities.
         const Caps&                             caps() const;
         
@@ -82,6 +102,9 @@ namespace Renderer
         //! Allocates a rendering frame instance.
         RenderFrame&                            allocateFrame(s32 size = 1024 * 100);
         
+        //! Returns an upload ring used for per-frame dynamic data.
+        UploadRing&                             uploadRing();
+        
         //! Displays a frame captured by a render scene.
         void                                    display(RenderFrame& frame, bool wait = true);
         
@@ -97,8 +120,8 @@ namespace Renderer
         //! Queues a vertex buffer instance for creation and returns it's index.
         VertexBuffer_                           requestVertexBuffer( const void* data, s32 size );
         
-        //! Queues an index buffer instance for creation and returns it's index.
-        IndexBuffer_                            requestIndexBuffer( const void* data, s32 size );
+        //! Queues an index buffer instance for creation and returns it's index, indices are either 16 or 32 bit wide.
+        IndexBuffer_                            requestIndexBuffer( const void* data, s32 size, s32 indexSize = sizeof( u16 ) );
         
         //! Queues a constant buffer instance for creation and returns it's index.
         ConstantBuffer_                         requestConstantBuffer(const void* data, s32 size, UniformLayout layout);
@@ -139,6 +162,33 @@ namespace Renderer
         //! Queues a command to precompile a shader program permutation.
         void                                    precompilePermutations(Program id, FeatureLayout features);
         
+        //! Queues all permutations listed in a manifest for precompilation and returns a total number of parsed entries.
+        s32                                     precompilePermutations(const String& manifest);
+        
+        //! Reads a permutation manifest from a file and queues it for precompilation.
+        s32                                     loadPermutationManifest(const String& fileName);
+        
+        //! Returns a text manifest of all program permutations compiled during this session.
+        String                                  permutationManifest() const;
+        
+        //! Writes a session permutation manifest to a file.
+        bool                                    savePermutationManifest(const String& fileName) const;
+        
+        //! Formats a text manifest with a line per permutation entry.
+        static String                           formatPermutationManifest(const PermutationManifest& permutations);
+        
+        //! Parses a text manifest, appends all valid entries to an output list and returns their total number.
+        static s32                              parsePermutationManifest(const String& manifest, PendingPermutations& permutations);
+        
+        //! Sets a maximum number of manifest permutations precompiled per displayed frame, zero means all at once.
+        void                                    setPrecompileBudget(s32 value);
+        
+        //! Returns a total number of manifest permutations that are still waiting for precompilation.
+        s32                                     pendingPermutationCount() const;
+        
+        //! Queues a texture destruction.
+        void                                    deleteTexture(Texture_ id);
+        
         //! Queues a constant buffer destruction.
         void                                    deleteConstantBuffer(ConstantBuffer_ id);
         
@@ -190,13 +240,34 @@ namespace Renderer
         //! Sets a texture info for a specified resource id.
         void                                    setTextureInfo(Texture_ id, TextureType type, u16 width, u16 height, u32 options);
         
+        //! Records a compiled program permutation to a session manifest.
+        void                                    recordPermutation(ResourceId program, const PipelineFeatureLayout* featureLayout, PipelineFeatures features);
+        
+        //! Queues pending manifest permutations with already requested programs and feature layouts for precompilation.
+        void                                    queuePendingPermutations();
+        
+        //! Opens a profiler scope upon a command buffer execution.
+        void                                    beginProfileScope(const OpCode& opCode);
+        
+        //! Closes a profiler scope upon a command buffer execution.
+        void                                    endProfileScope(const OpCode& opCode);
+        
+        //! Starts a GPU timer query and returns it's identifier or -1 if timer queries are not supported by a backend.
+        virtual s32                             beginGpuTimer();
+        
+        //! Ends a GPU timer query.
+        virtual void                            endGpuTimer(s32 query);
+        
+        //! Returns an elapsed time of a GPU timer query in microseconds or -1 if a result is not available.
+        virtual s64                             gpuTimerResult(s32 query);
+        
     protected:
 
         //! A forward declaration of a stack type to store intermediate render targets.
         class TransientResourceStack;
         
         //! A maximum number of input layout types
-        enum { MaxInputLayouts = 255 };
+        enum { MaxInputLayouts = 256 << VertexFormat::TotalPackingBits };
         
         RenderViewPtr                           m_view;                                                 //!< A rendering viewport.
         ResourceIdentifiers                     m_identifiers[RenderResourceType::TotalTypes];          //!< An array of persistent identifier managers.
@@ -213,9 +284,16 @@ namespace Renderer
         Program                                 m_defaultProgram;                                       //!< A default program to be used.
         ShaderLibrary                           m_shaderLibrary;                                        //!< A shader library.
         FrameCounters                           m_counters;                                             //!< Performance counters.
+        RenderProfiler                          m_profiler;                                             //!< A hierarchical frame profiler.
         State                                   m_activeStates[32];                                     //!< Active rendering states.
         Caps                                    m_caps;                                                 //!< Rendering context capabilities.
+        UploadRing                              m_uploadRing;                                           //!< A ring buffer for per-frame dynamic data uploads.
         RenderFrame                             m_frame;                                                //!< A shared rendering frame.
+        Map<u32, Program>                       m_programByHash;                                        //!< Maps from a program source code hash to a program.
+        Map<u32, FeatureLayout>                 m_featureLayoutByHash;                                  //!< Maps from a feature layout hash to a feature layout.
+        PermutationManifest                     m_permutationManifest;                                  //!< All permutations compiled during this session.
+        PendingPermutations                     m_pendingPermutations;                                  //!< Manifest permutations waiting for precompilation.
+        s32                                     m_precompileBudget;                                     //!< A maximum number of permutations precompiled per frame.
     };
     
     // ** RenderingContext::allocateIdentifier
@@ -234,6 +234,7 @@ ResourceId ShaderLibrary::allocateShader(const String& name, const String& code,
 
     // Emplace a shader instance with this identifier
     m_shaders[type].emplace(id, code);
+    m_shaderHashes[type].emplace(id, hashString(5381, code));
     
     return id;
 }
@@ -241,6 +242,24 @@ ResourceId ShaderLibrary::allocateShader(const String& name, const String& code,
 // ** ShaderLibrary::generateShaderCode
 bool ShaderLibrary::generateShaderCode(const ShaderProgramDescriptor& program, PipelineFeatures features, const PipelineFeatureLayout* featureLayout, String result[TotalShaderTypes]) const
 {
+    // Construct a permutation source key
+    SourceKey key;
+    key.program       = programHash(program);
+    key.featureLayout = featureLayoutHash(featureLayout);
+    key.features      = features;
+    
+    // This permutation was already generated, so just copy the memoized source
+    GeneratedSources::const_iterator i = m_generatedSources.find(key);
+    
+    if (i != m_generatedSources.end() && isSameSource(i->second, program, featureLayout))
+    {
+        for (s32 j = 0; j < TotalShaderTypes; j++)
+        {
+            result[j] = i->second.code[j];
+        }
+        return true;
+    }
+    
     // Generate an options string
     String options = generateOptionsString(features, featureLayout);
 
@@ -257,13 +276,75 @@ bool ShaderLibrary::generateShaderCode(const ShaderProgramDescriptor& program, P
         result[ComputeShaderType] = options + computeShader(program.computeShader);
     }
 
-    for (s32 i = 0; i < TotalShaderTypes; i++)
+    // Preprocess each stage and save it to a cache, an entry with a colliding key is replaced
+    GeneratedSource& generated = m_generatedSources[key];
+    
+    for (s32 j = 0; j < TotalShaderTypes; j++)
+    {
+        preprocessShader(result[j]);
+        generated.code[j]   = result[j];
+        generated.stages[j] = stageSource(program, static_cast<ShaderType>(j));
+    }
+    
+    generated.features.clear();
+    
+    for (s32 j = 0, n = featureLayout ? featureLayout->elementCount() : 0; j < n; j++)
     {
-        preprocessShader(result[i]);
+        generated.features.push_back(featureLayout->elementAt(j));
     }
 
     return true;
 }
+
+// ** ShaderLibrary::stageSource
+const String& ShaderLibrary::stageSource(const ShaderProgramDescriptor& program, ShaderType type) const
+{
+    static const String s_empty;
+    
+    switch (type)
+    {
+        case VertexShaderType:      return vertexShader(program.vertexShader);
+        case FragmentShaderType:    return fragmentShader(program.fragmentShader);
+        case GeometryShaderType:    return program.geometryShader ? geometryShader(program.geometryShader) : s_empty;
+        case ComputeShaderType:     return program.computeShader ? computeShader(program.computeShader) : s_empty;
+        default:                    break;
+    }
+    
+    return s_empty;
+}
+
+// ** ShaderLibrary::isSameSource
+bool ShaderLibrary::isSameSource(const GeneratedSource& generated, const ShaderProgramDescriptor& program, const PipelineFeatureLayout* featureLayout) const
+{
+    // Compare feature layouts first, they are much shorter than a source code
+    s32 count = featureLayout ? featureLayout->elementCount() : 0;
+    
+    if (static_cast<s32>(generated.features.size()) != count)
+    {
+        return false;
+    }
+    
+    for (s32 i = 0; i < count; i++)
+    {
+        const PipelineFeatureLayout::Element& element = featureLayout->elementAt(i);
+        
+        if (generated.features[i].mask != element.mask || generated.features[i].name != element.name)
+        {
+            return false;
+        }
+    }
+    
+    // Strings of a different length are rejected without comparing characters
+    for (s32 i = 0; i < TotalShaderTypes; i++)
+    {
+        if (generated.stages[i] != stageSource(program, static_cast<ShaderType>(i)))
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
     
 // ** ShaderLibrary::generateOptionsString
 String ShaderLibrary::generateOptionsString(PipelineFeatures features, const PipelineFeatureLayout* featureLayout) const
@@ -315,6 +396,7 @@ void ShaderLibrary::preprocessShader(String& shader) const
 void ShaderLibrary::addPreprocessor(ShaderPreprocessorUPtr preprocessor)
 {
     m_preprocessors.push_back(preprocessor);
+    invalidateGeneratedSources();
 }
     
 // ** ShaderLibrary::findSharedSource
@@ -336,6 +418,7 @@ void ShaderLibrary::addSharedSource(const String& name, const String& source)
 {
     NIMBLE_ABORT_IF(m_sharedSources.count(name) != 0, "a shader library already contains a shared source with the same name");
     m_sharedSources[name] = source;
+    invalidateGeneratedSources();
 }
     
 // ** ShaderLibrary::addSharedFunction
@@ -345,6 +428,7 @@ void ShaderLibrary::addSharedFunction(const String& name, const String& source)
     sharedFunction.name = name;
     sharedFunction.code = source;
     m_sharedFunctions.push_back(sharedFunction);
+    invalidateGeneratedSources();
 }
 
 // ** ShaderLibrary::sharedFunctions
@@ -353,6 +437,104 @@ const ShaderLibrary::SharedFunctions& ShaderLibrary::sharedFunctions() const
     return m_sharedFunctions;
 }
 
+// ** ShaderLibrary::programHash
+u32 ShaderLibrary::programHash(const ShaderProgramDescriptor& program) const
+{
+    u32 hash = 5381;
+    
+    // Stage hashes are cached when a shader is added, so a source code is never hashed again.
+    // Optional stages are prefixed with a stage type, so a geometry shader can't be mistaken for a compute one.
+    hash = ((hash << 5) + hash) + m_shaderHashes[VertexShaderType][program.vertexShader];
+    hash = ((hash << 5) + hash) + m_shaderHashes[FragmentShaderType][program.fragmentShader];
+    
+    if (program.geometryShader)
+    {
+        hash = ((hash << 5) + hash) + GeometryShaderType;
+        hash = ((hash << 5) + hash) + m_shaderHashes[GeometryShaderType][program.geometryShader];
+    }
+    
+    if (program.computeShader)
+    {
+        hash = ((hash << 5) + hash) + ComputeShaderType;
+        hash = ((hash << 5) + hash) + m_shaderHashes[ComputeShaderType][program.computeShader];
+    }
+    
+    return hash;
+}
+
+// ** ShaderLibrary::featureLayoutHash
+u32 ShaderLibrary::featureLayoutHash(const PipelineFeatureLayout* featureLayout)
+{
+    if (!featureLayout)
+    {
+        return 0;
+    }
+    
+    u32 hash = 5381;
+    
+    for (s32 i = 0, n = featureLayout->elementCount(); i < n; i++)
+    {
+        const PipelineFeatureLayout::Element& element = featureLayout->elementAt(i);
+        
+        for (size_t j = 0; j < element.name.length(); j++)
+        {
+            hash = ((hash << 5) + hash) + static_cast<u8>(element.name[j]);
+        }
+        
+        hash = ((hash << 5) + hash) + static_cast<u32>(element.mask);
+        hash = ((hash << 5) + hash) + static_cast<u32>(element.mask >> 32);
+    }
+    
+    // Zero is reserved for permutations without a feature layout
+    return hash ? hash : 1;
+}
+
+// ** ShaderLibrary::hashString
+u32 ShaderLibrary::hashString(u32 hash, const String& value)
+{
+    for (size_t i = 0, n = value.length(); i < n; i++)
+    {
+        hash = ((hash << 5) + hash) + static_cast<u8>(value[i]);
+    }
+    
+    // Mix in a stage separator, so moving code between stages changes a hash
+    return ((hash << 5) + hash) + 0xFF;
+}
+
+// ** ShaderLibrary::cachedSourceCount
+s32 ShaderLibrary::cachedSourceCount() const
+{
+    return static_cast<s32>(m_generatedSources.size());
+}
+
+// ** ShaderLibrary::invalidateGeneratedSources
+void ShaderLibrary::invalidateGeneratedSources()
+{
+    if (m_generatedSources.empty())
+    {
+        return;
+    }
+    
+    LogVerbose("shaderLibrary", "%d generated permutation sources invalidated\n", static_cast<s32>(m_generatedSources.size()));
+    m_generatedSources.clear();
+}
+
+// ** ShaderLibrary::SourceKey::operator <
+bool ShaderLibrary::SourceKey::operator < (const SourceKey& other) const
+{
+    if (features != other.features)
+    {
+        return features < other.features;
+    }
+    
+    if (featureLayout != other.featureLayout)
+    {
+        return featureLayout < other.featureLayout;
+    }
+    
+    return program < other.program;
+}
+
 // --------------------------------------------------- UniformBufferPreprocessor --------------------------------------------------- //
 
 // ** UniformBufferPreprocessor::preprocess
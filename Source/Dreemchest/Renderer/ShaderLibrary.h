@@ -108,6 +108,51 @@ namespace Renderer
         
         //! Returns an array of shared functions.
         const SharedFunctions&          sharedFunctions() const;
+        
+        //! Returns a 32-bit hash of an unprocessed program source code that stays the same between sessions, combined from stage hashes cached when a shader is added.
+        u32                             programHash(const ShaderProgramDescriptor& program) const;
+        
+        //! Returns a 32-bit hash of feature names and masks that stays the same between sessions, zero stands for no feature layout.
+        static u32                      featureLayoutHash(const PipelineFeatureLayout* featureLayout);
+        
+        //! Returns a total number of generated permutation sources that are currently cached.
+        s32                             cachedSourceCount() const;
+
+    private:
+        
+        //! A key to lookup a generated permutation source, resource identifiers and layout pointers are reused after release, so content hashes are used instead.
+        struct SourceKey
+        {
+            u32                             program;                    //!< A program source code hash.
+            u32                             featureLayout;              //!< A feature layout hash.
+            PipelineFeatures                features;                   //!< A permutation feature mask.
+            
+            //! Compares two source keys.
+            bool                            operator < (const SourceKey& other) const;
+        };
+        
+        //! A generated source code of all program stages.
+        struct GeneratedSource
+        {
+            String                          code[TotalShaderTypes];     //!< A preprocessed source code of each stage.
+            String                          stages[TotalShaderTypes];   //!< An unprocessed source code of each stage, compared on a lookup so a hash collision never returns a wrong source.
+            Array<PipelineFeatureLayout::Element> features;             //!< Feature layout elements a source was generated with.
+        };
+        
+        //! A container type to memoize generated permutation sources.
+        typedef Map<SourceKey, GeneratedSource> GeneratedSources;
+        
+        //! Drops all memoized permutation sources, invoked each time a shared source or preprocessor is added.
+        void                            invalidateGeneratedSources();
+        
+        //! Accumulates a hash of a string.
+        static u32                      hashString(u32 hash, const String& value);
+        
+        //! Returns an unprocessed source code of a program stage or an empty string if a stage is not used.
+        const String&                   stageSource(const ShaderProgramDescriptor& program, ShaderType type) const;
+        
+        //! Returns true if a memoized source was generated from the same program stages and feature layout.
+        bool                            isSameSource(const GeneratedSource& generated, const ShaderProgramDescriptor& program, const PipelineFeatureLayout* featureLayout) const;
 
     private:
 
@@ -130,9 +175,11 @@ namespace Renderer
         const RenderingContext&         m_renderingContext;                 //!< Parent rendering context instance.
         ResourceIdentifiers             m_identifiers[TotalShaderTypes];    //!< An array of shader resource identifiers.
         FixedArray<String>              m_shaders[TotalShaderTypes];        //!< An array of shader containers.
+        FixedArray<u32>                 m_shaderHashes[TotalShaderTypes];   //!< A source code hash of each shader, so a program hash is not recalculated from a source.
         SharedFunctions                 m_sharedFunctions;                  //!< An container of shared functions.
         Map<String, String>             m_sharedSources;                    //!< A container to map from a shader name to a shared source code.
         List<ShaderPreprocessorUPtr>    m_preprocessors;                    //!< A list of shader preprocessors that are consequently invoked.
+        mutable GeneratedSources        m_generatedSources;                 //!< Memoized permutation sources, so a program permutation is preprocessed only once.
     };
 
     //! A base class for all shader preprocessors that rgenerate uniform buffer definitions.
@@ -0,0 +1,194 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "UploadRing.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Renderer
+{
+    
+// ** UploadRing::UploadRing
+UploadRing::UploadRing(s32 capacity, s32 framesInFlight, s32 alignment)
+    : m_framesInFlight(max2(framesInFlight, 1))
+    , m_alignment(alignment)
+    , m_head(0)
+    , m_tail(0)
+    , m_used(0)
+    , m_frameSize(0)
+    , m_frame(0)
+    , m_failedAllocations(0)
+{
+    NIMBLE_ABORT_IF(alignment <= 0 || (alignment & (alignment - 1)) != 0, "an upload alignment should be a power of two");
+    m_memory.resize(capacity);
+}
+
+// ** UploadRing::~UploadRing
+UploadRing::~UploadRing()
+{
+}
+    
+// ** UploadRing::capacity
+s32 UploadRing::capacity() const
+{
+    return static_cast<s32>(m_memory.size());
+}
+
+// ** UploadRing::usedBytes
+s32 UploadRing::usedBytes() const
+{
+    return m_used;
+}
+
+// ** UploadRing::failedAllocations
+s32 UploadRing::failedAllocations() const
+{
+    return m_failedAllocations;
+}
+
+// ** UploadRing::allocate
+UploadRing::Allocation UploadRing::allocate(s32 size)
+{
+    Allocation allocation;
+    allocation.data   = NULL;
+    allocation.offset = 0;
+    allocation.size   = size;
+    
+    // Align an allocation size
+    s32 aligned = (size + m_alignment - 1) & ~(m_alignment - 1);
+    
+    if (aligned <= 0 || aligned > capacity())
+    {
+        m_failedAllocations++;
+        return allocation;
+    }
+    
+    while (true)
+    {
+        // A ring is empty, so restart it from the beginning
+        if (m_used == 0)
+        {
+            m_head = m_tail = 0;
+        }
+        
+        if (m_head > m_tail || m_used == 0)
+        {
+            // A free space lies after a head
+            if (m_head + aligned <= capacity())
+            {
+                break;
+            }
+            
+            // Wrap around and waste a ring tail, if there is enough space before an oldest frame
+            if (aligned <= m_tail)
+            {
+                s32 wasted   = capacity() - m_head;
+                m_used      += wasted;
+                m_frameSize += wasted;
+                m_head       = 0;
+                break;
+            }
+        }
+        else if (m_head + aligned <= m_tail)
+        {
+            // A free space lies between a head and an oldest frame
+            break;
+        }
+        
+        // No space left, so wait for an oldest frame in flight
+        if (!retireOldestFrame())
+        {
+            LogWarning("uploadRing", "failed to allocate %d bytes, current frame already owns %d bytes\n", size, m_frameSize);
+            m_failedAllocations++;
+            return allocation;
+        }
+    }
+    
+    allocation.data   = &m_memory[m_head];
+    allocation.offset = m_head;
+    
+    m_head      += aligned;
+    m_used      += aligned;
+    m_frameSize += aligned;
+    
+    return allocation;
+}
+
+// ** UploadRing::endFrame
+void UploadRing::endFrame()
+{
+    // Protect a frame segment with a fence
+    insertFence(m_frame);
+    
+    FrameSegment segment;
+    segment.frame = m_frame++;
+    segment.end   = m_head;
+    segment.size  = m_frameSize;
+    m_frames.push_back(segment);
+    m_frameSize = 0;
+    
+    // Wait for oldest frames, so at most a specified number of frames are in flight
+    while (static_cast<s32>(m_frames.size()) >= m_framesInFlight)
+    {
+        retireOldestFrame();
+    }
+}
+
+// ** UploadRing::retireOldestFrame
+bool UploadRing::retireOldestFrame()
+{
+    if (m_frames.empty())
+    {
+        return false;
+    }
+    
+    const FrameSegment& segment = m_frames.front();
+    waitFence(segment.frame);
+    
+    // Empty frames do not own a ring segment, so a tail is left as is
+    if (segment.size)
+    {
+        m_tail  = segment.end;
+        m_used -= segment.size;
+    }
+    m_frames.pop_front();
+    
+    return true;
+}
+
+// ** UploadRing::insertFence
+void UploadRing::insertFence(u32 frame)
+{
+}
+
+// ** UploadRing::waitFence
+void UploadRing::waitFence(u32 frame)
+{
+}
+    
+} // namespace Renderer
+
+DC_END_DREEMCHEST
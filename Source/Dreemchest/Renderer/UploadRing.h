@@ -0,0 +1,113 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Renderer_UploadRing_H__
+#define __DC_Renderer_UploadRing_H__
+
+#include "Renderer.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Renderer
+{
+    //! An upload ring sub-allocates per-frame dynamic data from a single memory block shared by several frames in flight.
+    /*!
+     Each frame writes to it's own segment of a ring and this segment is reused only after
+     a frame fence was signalled. The base implementation is backed by a CPU memory and
+     treats a fence as signalled right after a frame commands were executed, which is exactly
+     the case for backends that copy an uploaded data to a GPU upon command execution.
+     */
+    class UploadRing
+    {
+    public:
+        
+        //! A sub-allocated block of memory.
+        struct Allocation
+        {
+            u8*                         data;       //!< A pointer to an allocated block, NULL if a ring is out of memory.
+            s32                         offset;     //!< An allocation offset from the beginning of a ring.
+            s32                         size;       //!< An allocated block size.
+        };
+        
+                                        //! Constructs an UploadRing instance.
+                                        UploadRing(s32 capacity, s32 framesInFlight = 3, s32 alignment = 16);
+        virtual                         ~UploadRing();
+        
+        //! Sub-allocates a block of memory that stays valid until a frame that allocated it is retired.
+        Allocation                      allocate(s32 size);
+        
+        //! Closes a current frame segment and protects it with a fence, waits for an oldest frame if too many frames are in flight.
+        void                            endFrame();
+        
+        //! Returns a ring capacity.
+        s32                             capacity() const;
+        
+        //! Returns a total number of bytes owned by all frames in flight.
+        s32                             usedBytes() const;
+        
+        //! Returns a total number of failed allocations since creation.
+        s32                             failedAllocations() const;
+        
+    protected:
+        
+        //! Inserts a fence after all commands of a frame segment, does nothing for a CPU ring.
+        virtual void                    insertFence(u32 frame);
+        
+        //! Blocks until a frame fence is signalled, does nothing for a CPU ring.
+        virtual void                    waitFence(u32 frame);
+        
+    private:
+        
+        //! Waits for an oldest frame in flight and releases it's segment.
+        bool                            retireOldestFrame();
+        
+    private:
+        
+        //! A ring segment that is owned by a frame in flight.
+        struct FrameSegment
+        {
+            u32                         frame;      //!< A frame index used to identify a fence.
+            s32                         end;        //!< A ring offset right after the last allocation of a frame.
+            s32                         size;       //!< A total number of bytes owned by a frame including a wasted tail.
+        };
+        
+        Array<u8>                       m_memory;           //!< A ring memory.
+        List<FrameSegment>              m_frames;           //!< Frames in flight ordered from the oldest one.
+        s32                             m_framesInFlight;   //!< A maximum number of frames in flight.
+        s32                             m_alignment;        //!< Each allocation is aligned to this number of bytes.
+        s32                             m_head;             //!< A next allocation offset.
+        s32                             m_tail;             //!< A beginning of an oldest frame segment.
+        s32                             m_used;             //!< A total number of bytes owned by frames in flight.
+        s32                             m_frameSize;        //!< A total number of bytes allocated by a current frame.
+        u32                             m_frame;            //!< A current frame index.
+        s32                             m_failedAllocations;//!< A total number of allocations that did not fit a ring.
+    };
+    
+} // namespace Renderer
+
+DC_END_DREEMCHEST
+
+#endif  /*  !__DC_Renderer_UploadRing_H__   */
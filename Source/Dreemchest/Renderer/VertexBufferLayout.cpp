@@ -47,10 +47,12 @@ const VertexBufferLayout::Element& VertexBufferLayout::operator [](s32 index) co
 }
 
 // ** VertexBufferLayout::attributeLocation
-void VertexBufferLayout::attributeLocation(VertexAttribute attribute, s32 count, s32 offset)
+void VertexBufferLayout::attributeLocation(VertexAttribute attribute, s32 count, s32 offset, ElementType type, bool normalized)
 {
-    m_attributes[attribute].count  = count;
-    m_attributes[attribute].offset = offset;
+    m_attributes[attribute].count      = count;
+    m_attributes[attribute].offset     = offset;
+    m_attributes[attribute].type       = type;
+    m_attributes[attribute].normalized = normalized;
     
     m_features = m_features | PipelineFeature::vertexAttribute(attribute);
 }
@@ -38,16 +38,29 @@ namespace Renderer
     {
     public:
         
+        //! Available attribute component types.
+        enum ElementType
+        {
+              Float32       //!< A 32-bit floating point component.
+            , Float16       //!< A 16-bit floating point component.
+            , Int8          //!< A signed byte component.
+            , UInt8         //!< An unsigned byte component.
+        };
+        
         //! Input layout element.
         struct Element
         {
-            s32     count;      //!< Attribute size.
-            s32     offset;     //!< Attribute offset.
+            s32         count;      //!< Attribute size.
+            s32         offset;     //!< Attribute offset.
+            ElementType type;       //!< Attribute component type.
+            bool        normalized; //!< Indicates that integer components are mapped to a [0, 1] or [-1, 1] range.
             
             //! Constructs a new Element instance.
             Element( void )
                 : count( -1 )
                 , offset( -1 )
+                , type( Float32 )
+                , normalized( false )
                 {
                 }
             
@@ -70,7 +83,7 @@ namespace Renderer
         s32                     vertexSize( void ) const;
         
         //! Defines a vertex attribute location.
-        void                    attributeLocation( VertexAttribute attribute, s32 count, s32 offset );
+        void                    attributeLocation( VertexAttribute attribute, s32 count, s32 offset, ElementType type = Float32, bool normalized = false );
         
         //! Returns the vertex position attribute.
         const Element&          position( void ) const;
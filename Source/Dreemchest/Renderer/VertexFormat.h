@@ -57,8 +57,17 @@ namespace Renderer
             , PointSize     = BIT(VertexPointSize)
         };
         
+        //! Available attribute packing modes, each one trades precision for a smaller vertex.
+        enum Packing
+        {
+              PackedPosition    = BIT(0)    //!< A position is stored as four half floats, the last one is a padding.
+            , PackedNormal      = BIT(1)    //!< A normal is stored as four signed normalized bytes, the last one is a padding.
+            , PackedTexCoords   = BIT(2)    //!< Texture coordinates are stored as two half floats.
+            , TotalPackingBits  = 3         //!< A total number of packing bits.
+        };
+        
                                 //! Constructs a VertexFormat instance.
-                                VertexFormat( u8 attributes );
+                                VertexFormat( u8 attributes, u8 packing = 0 );
         
         //! Converts a VertexFormat to u8 value.
         operator                u8( void ) const;
@@ -69,6 +78,21 @@ namespace Renderer
         //! Tests two vertex formats for an equality.
         bool                    operator == ( const VertexFormat& other ) const;
         
+        //! Tests two vertex formats for an inequality.
+        bool                    operator != ( const VertexFormat& other ) const;
+        
+        //! Returns attribute packing flags.
+        u8                      packing( void ) const;
+        
+        //! Returns true if a specified packing mode is enabled.
+        bool                    isPacked( Packing value ) const;
+        
+        //! Returns a unique key that includes both attributes and packing flags.
+        u16                     key( void ) const;
+        
+        //! Constructs a vertex format from a key.
+        static VertexFormat     fromKey( u16 value );
+        
         //! Returns a vertex size.
         s32                     vertexSize( void ) const;
         
@@ -107,11 +131,13 @@ namespace Renderer
     private:
         
         u8                      m_attributes;   //!< Vertex attribute mask.
+        u8                      m_packing;      //!< Vertex attribute packing flags.
     };
     
     // ** VertexFormat::VertexFormat
-    NIMBLE_INLINE VertexFormat::VertexFormat( u8 attributes )
+    NIMBLE_INLINE VertexFormat::VertexFormat( u8 attributes, u8 packing )
         : m_attributes( attributes | Position )
+        , m_packing( packing )
     {
     }
     
@@ -130,7 +156,37 @@ namespace Renderer
     // ** VertexFormat::operator ==
     NIMBLE_INLINE bool VertexFormat::operator == ( const VertexFormat& other ) const
     {
-        return m_attributes == other.m_attributes;
+        return m_attributes == other.m_attributes && m_packing == other.m_packing;
+    }
+    
+    // ** VertexFormat::operator !=
+    NIMBLE_INLINE bool VertexFormat::operator != ( const VertexFormat& other ) const
+    {
+        return !(*this == other);
+    }
+    
+    // ** VertexFormat::packing
+    NIMBLE_INLINE u8 VertexFormat::packing( void ) const
+    {
+        return m_packing;
+    }
+    
+    // ** VertexFormat::isPacked
+    NIMBLE_INLINE bool VertexFormat::isPacked( Packing value ) const
+    {
+        return m_packing & value ? true : false;
+    }
+    
+    // ** VertexFormat::key
+    NIMBLE_INLINE u16 VertexFormat::key( void ) const
+    {
+        return static_cast<u16>( m_attributes ) | (static_cast<u16>( m_packing ) << 8);
+    }
+    
+    // ** VertexFormat::fromKey
+    NIMBLE_INLINE VertexFormat VertexFormat::fromKey( u16 value )
+    {
+        return VertexFormat( static_cast<u8>( value & 0xFF ), static_cast<u8>( value >> 8 ) );
     }
     
     // ** VertexFormat::vertexSize
@@ -169,11 +225,11 @@ namespace Renderer
     {
         switch( attribute )
         {
-            case Position:  return sizeof( f32 ) * 3;
-            case Normal:    return sizeof( f32 ) * 3;
+            case Position:  return isPacked( PackedPosition )  ? sizeof( u16 ) * 4 : sizeof( f32 ) * 3;
+            case Normal:    return isPacked( PackedNormal )    ? sizeof( s8  ) * 4 : sizeof( f32 ) * 3;
             case Color:     return sizeof( u8  ) * 4;
-            case TexCoord0: return sizeof( f32 ) * 2;
-            case TexCoord1: return sizeof( f32 ) * 2;
+            case TexCoord0: return isPacked( PackedTexCoords ) ? sizeof( u16 ) * 2 : sizeof( f32 ) * 2;
+            case TexCoord1: return isPacked( PackedTexCoords ) ? sizeof( u16 ) * 2 : sizeof( f32 ) * 2;
             default:        NIMBLE_NOT_IMPLEMENTED
         }
         
@@ -28,6 +28,7 @@
 
 #include "Image.h"
 #include "Mesh.h"
+#include "MeshProcessing.h"
 #include "Material.h"
 
 DC_BEGIN_DREEMCHEST
@@ -67,10 +68,23 @@ bool ImageFormatRaw::constructFromStream( Io::StreamPtr stream, Assets::Assets&
 // ** MeshFormatRaw::constructFromStream
 bool MeshFormatRaw::constructFromStream( Io::StreamPtr stream, Assets::Assets& assets, Mesh& asset )
 {
-    // Read the total number of mesh chunks
+    // Read the total number of mesh chunks or a header of a versioned mesh
     u32 chunkCount;
     stream->read( &chunkCount, 4 );
 
+    // Meshes without a header were written before index sizes became explicit
+    u32 version = 1;
+
+    if( chunkCount == Magic ) {
+        stream->read( &version, 4 );
+        stream->read( &chunkCount, 4 );
+    }
+
+    if( version > Version ) {
+        LogError( "mesh", "unsupported raw mesh version %d, expected %d\n", version, Version );
+        return false;
+    }
+
     // Set the total number of mesh chunks
     asset.setChunkCount( chunkCount );
     NIMBLE_BREAK_IF( chunkCount != 1 );
@@ -88,10 +102,22 @@ bool MeshFormatRaw::constructFromStream( Io::StreamPtr stream, Assets::Assets& a
         stream->read( &vertexCount, 4 );
         stream->read( &indexCount, 4 );
 
+        // Read the index size, the first version of a format always stored 16-bit indices
+        u32 indexSize = sizeof( u16 );
+
+        if( version >= 2 ) {
+            stream->read( &indexSize, 4 );
+        }
+
+        if( indexSize != sizeof( u16 ) && indexSize != sizeof( u32 ) ) {
+            LogError( "mesh", "invalid raw mesh index size %d\n", indexSize );
+            return false;
+        }
+
         // Read vertex buffer
         vertices.resize( vertices.size() + vertexCount );
 
-        for( u32 j = vertices.size() - vertexCount; j < vertexCount; j++ ) {
+        for( u32 j = vertices.size() - vertexCount; j < vertices.size(); j++ ) {
             Mesh::Vertex* v = &vertices[j];
 
             stream->read( &v->position.x, sizeof( v->position ) );
@@ -103,10 +129,14 @@ bool MeshFormatRaw::constructFromStream( Io::StreamPtr stream, Assets::Assets& a
         // Read index buffer
         indices.resize( indices.size() + indexCount );
 
-        for( u32 j = indices.size() - indexCount; j < indexCount; j++ ) {
-            u16 idx;
-            stream->read( &idx, sizeof(u16) );
-            indices[j] = idx;
+        if( indexSize == sizeof( u32 ) ) {
+            stream->read( &indices[indices.size() - indexCount], indexCount * sizeof( u32 ) );
+        } else {
+            for( u32 j = indices.size() - indexCount; j < indices.size(); j++ ) {
+                u16 idx;
+                stream->read( &idx, sizeof(u16) );
+                indices[j] = idx;
+            }
         }
 
         // Set chunk texture
@@ -119,6 +149,9 @@ bool MeshFormatRaw::constructFromStream( Io::StreamPtr stream, Assets::Assets& a
     // Set mesh index buffer
     asset.setIndexBuffer( indices );
 
+    // Reorder data for a vertex cache, meshes are stored as exported
+    MeshProcessing::optimize( asset );
+
     // Update node bounds
     asset.updateBounds();
 
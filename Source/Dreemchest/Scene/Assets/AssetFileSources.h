@@ -42,7 +42,20 @@ namespace Scene {
     };
 
     //! Loads a mesh from a raw binary format.
+    /*!
+    A raw mesh starts with a header that holds a magic code and a format version, each chunk stores
+    an explicit size of its indices. Files without a header are read as a first version of a format,
+    which always stored 16-bit indices.
+    */
     class MeshFormatRaw : public Assets::FileSource<Mesh> {
+    public:
+
+        //! A four-character code stored at the beginning of a raw mesh.
+        enum { Magic = 0x4853454d };
+
+        //! A current version of a raw mesh format.
+        enum { Version = 2 };
+
     protected:
 
         //! Loads mesh data from an input stream.
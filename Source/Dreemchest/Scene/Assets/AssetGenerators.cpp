@@ -171,8 +171,7 @@ bool MeshBoxGenerator::generate( Assets::Assets& assets, Mesh& mesh )
     vb.resize( kVertexCount );
     memcpy( &vb[0], vertices, sizeof vertices );
 
-    ib.resize( kIndexCount );
-    memcpy( &ib[0], indices, sizeof indices );
+    ib.assign( indices, indices + kIndexCount );
 
     mesh.setChunkCount( 1 );
     mesh.setVertexBuffer( vb );
@@ -961,8 +960,7 @@ bool MeshSphereGenerator::generate( Assets::Assets& assets, Mesh& mesh )
         vb.push_back( v );
     }
 
-    ib.resize( kIndexCount );
-    memcpy( &ib[0], indices, sizeof indices );
+    ib.assign( indices, indices + kIndexCount );
 
     mesh.setChunkCount( 1 );
     mesh.setVertexBuffer( vb );
@@ -2565,8 +2563,7 @@ bool MeshTorusGenerator::generate( Assets::Assets& assets, Mesh& mesh )
         vb.push_back( v );
     }
 
-    ib.resize( kIndexCount );
-    memcpy( &ib[0], indices, sizeof indices );
+    ib.assign( indices, indices + kIndexCount );
 
     mesh.setChunkCount( 1 );
     mesh.setVertexBuffer( vb );
@@ -100,6 +100,12 @@ const Renderer::VertexFormat& Mesh::vertexFormat( void ) const
     return m_vertexFormat;
 }
 
+// ** Mesh::setVertexFormat
+void Mesh::setVertexFormat( const Renderer::VertexFormat& value )
+{
+    m_vertexFormat = value;
+}
+
 // ** Mesh::updateBounds
 void Mesh::updateBounds( void )
 {
@@ -48,7 +48,7 @@ namespace Scene
         };
 
         typedef Array<Vertex>           VertexBuffer;        //!< Mesh vertex buffer type.
-        typedef Array<u16>              IndexBuffer;        //!< Mesh index buffer type.
+        typedef Array<u32>              IndexBuffer;        //!< Mesh index buffer type.
 
                                         //! Constructs Mesh instance.
                                         Mesh( void );
@@ -59,6 +59,9 @@ namespace Scene
         //! Returns a vertex format.
         const Renderer::VertexFormat&   vertexFormat( void ) const;
 
+        //! Sets a vertex format used to render this mesh, packed formats trade attribute precision for a smaller vertex.
+        void                            setVertexFormat( const Renderer::VertexFormat& value );
+
         //! Returns the total number of mesh chunks.
         s32                             chunkCount( void ) const;
 
@@ -0,0 +1,476 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "MeshProcessing.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene
+{
+
+// ** MeshProcessing::optimize
+void MeshProcessing::optimize( Mesh& mesh, s32 cacheSize )
+{
+    Mesh::VertexBuffer vertices = mesh.vertexBuffer();
+    Mesh::IndexBuffer  indices  = mesh.indexBuffer();
+
+    if( indices.empty() )
+    {
+        return;
+    }
+
+    f32 acmr = averageCacheMissRatio( indices, static_cast<s32>( vertices.size() ), cacheSize );
+
+    // First reorder triangles, then lay vertices out in the order they are referenced by these triangles
+    optimizeVertexCache( indices, static_cast<s32>( vertices.size() ), cacheSize );
+    optimizeVertexFetch( vertices, indices );
+
+    LogVerbose( "mesh", "%d vertices optimized, ACMR %2.3f -> %2.3f\n", vertices.size(), acmr, averageCacheMissRatio( indices, static_cast<s32>( vertices.size() ), cacheSize ) );
+
+    mesh.setVertexBuffer( vertices );
+    mesh.setIndexBuffer( indices );
+}
+
+// ** MeshProcessing::vertexScore
+f32 MeshProcessing::vertexScore( s32 cachePosition, s32 remainingTriangles, s32 cacheSize )
+{
+    // This vertex is not used by any of the remaining triangles
+    if( remainingTriangles == 0 )
+    {
+        return -1.0f;
+    }
+
+    f32 score = 0.0f;
+
+    // Vertices of a last emitted triangle get a fixed score, so the optimizer does not prefer triangles that share an edge with it
+    if( cachePosition >= 0 )
+    {
+        if( cachePosition < 3 )
+        {
+            score = 0.75f;
+        }
+        else
+        {
+            score = powf( 1.0f - f32( cachePosition - 3 ) / (cacheSize - 3), 1.5f );
+        }
+    }
+
+    // Boost vertices with only a few triangles left, so they can leave a cache sooner
+    score += 2.0f * powf( static_cast<f32>( remainingTriangles ), -0.5f );
+
+    return score;
+}
+
+// ** MeshProcessing::optimizeVertexCache
+void MeshProcessing::optimizeVertexCache( Mesh::IndexBuffer& indices, s32 vertexCount, s32 cacheSize )
+{
+    NIMBLE_ABORT_IF( cacheSize <= 3, "vertex cache size should be greater than 3" );
+
+    s32 triangleCount = static_cast<s32>( indices.size() ) / 3;
+
+    if( triangleCount == 0 )
+    {
+        return;
+    }
+
+    // Count triangles that reference each vertex
+    Array<s32> remaining( vertexCount, 0 );
+    Array<s32> offsets( vertexCount + 1, 0 );
+
+    for( s32 i = 0, n = triangleCount * 3; i < n; i++ )
+    {
+        NIMBLE_ABORT_IF( indices[i] >= static_cast<u32>( vertexCount ), "index is out of range" );
+        remaining[indices[i]]++;
+    }
+
+    for( s32 i = 0; i < vertexCount; i++ )
+    {
+        offsets[i + 1] = offsets[i] + remaining[i];
+    }
+
+    // Build vertex to triangle adjacency lists
+    Array<s32> adjacency( triangleCount * 3 );
+    Array<s32> fill( offsets.begin(), offsets.end() - 1 );
+
+    for( s32 i = 0, n = triangleCount * 3; i < n; i++ )
+    {
+        adjacency[fill[indices[i]]++] = i / 3;
+    }
+
+    // Calculate initial vertex and triangle scores
+    Array<s32> cachePosition( vertexCount, -1 );
+    Array<f32> vertexScores( vertexCount );
+    Array<f32> triangleScores( triangleCount );
+    Array<u8>  emitted( triangleCount, 0 );
+
+    for( s32 i = 0; i < vertexCount; i++ )
+    {
+        vertexScores[i] = vertexScore( -1, remaining[i], cacheSize );
+    }
+
+    for( s32 i = 0; i < triangleCount; i++ )
+    {
+        triangleScores[i] = vertexScores[indices[i * 3 + 0]] + vertexScores[indices[i * 3 + 1]] + vertexScores[indices[i * 3 + 2]];
+    }
+
+    // Emit triangles greedily, each time picking the best scored one among triangles that touch a cache
+    Mesh::IndexBuffer output;
+    Array<s32>        cache;
+    Array<s32>        next;
+    s32               best = -1;
+
+    output.reserve( triangleCount * 3 );
+    cache.reserve( cacheSize + 3 );
+    next.reserve( cacheSize + 3 );
+
+    for( s32 i = 0; i < triangleCount; i++ )
+    {
+        // No triangles touch a cache, so perform a full search
+        if( best < 0 )
+        {
+            f32 bestScore = -1.0f;
+
+            for( s32 j = 0; j < triangleCount; j++ )
+            {
+                if( !emitted[j] && triangleScores[j] > bestScore )
+                {
+                    bestScore = triangleScores[j];
+                    best      = j;
+                }
+            }
+        }
+
+        // Emit the triangle
+        const u32* triangle = &indices[best * 3];
+        output.push_back( triangle[0] );
+        output.push_back( triangle[1] );
+        output.push_back( triangle[2] );
+        emitted[best] = 1;
+
+        // Remove the triangle from adjacency lists of its vertices and put them to the front of a cache
+        next.clear();
+
+        for( s32 k = 0; k < 3; k++ )
+        {
+            s32  vertex = triangle[k];
+            s32* list   = &adjacency[offsets[vertex]];
+
+            if( std::find( next.begin(), next.end(), vertex ) != next.end() )
+            {
+                continue;
+            }
+
+            for( s32 j = 0; j < remaining[vertex]; j++ )
+            {
+                if( list[j] == best )
+                {
+                    list[j] = list[remaining[vertex] - 1];
+                    break;
+                }
+            }
+
+            remaining[vertex]--;
+            next.push_back( vertex );
+        }
+
+        for( s32 j = 0, n = static_cast<s32>( cache.size() ); j < n; j++ )
+        {
+            if( std::find( next.begin(), next.end(), cache[j] ) == next.end() )
+            {
+                next.push_back( cache[j] );
+            }
+        }
+
+        // Update scores of cached and just evicted vertices
+        for( s32 j = 0, n = static_cast<s32>( next.size() ); j < n; j++ )
+        {
+            s32 vertex = next[j];
+            cachePosition[vertex] = j < cacheSize ? j : -1;
+            vertexScores[vertex]  = vertexScore( cachePosition[vertex], remaining[vertex], cacheSize );
+        }
+
+        // Update scores of affected triangles and pick the best one
+        f32 bestScore = -1.0f;
+        best = -1;
+
+        for( s32 j = 0, n = static_cast<s32>( next.size() ); j < n; j++ )
+        {
+            s32        vertex = next[j];
+            const s32* list   = &adjacency[offsets[vertex]];
+
+            for( s32 k = 0; k < remaining[vertex]; k++ )
+            {
+                s32 t = list[k];
+                triangleScores[t] = vertexScores[indices[t * 3 + 0]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+                if( triangleScores[t] > bestScore )
+                {
+                    bestScore = triangleScores[t];
+                    best      = t;
+                }
+            }
+        }
+
+        // Drop evicted vertices
+        if( static_cast<s32>( next.size() ) > cacheSize )
+        {
+            next.resize( cacheSize );
+        }
+
+        cache.swap( next );
+    }
+
+    indices = output;
+}
+
+// ** MeshProcessing::optimizeVertexFetch
+void MeshProcessing::optimizeVertexFetch( Mesh::VertexBuffer& vertices, Mesh::IndexBuffer& indices )
+{
+    Array<s32>         remap( vertices.size(), -1 );
+    Mesh::VertexBuffer output;
+    output.reserve( vertices.size() );
+
+    for( s32 i = 0, n = static_cast<s32>( indices.size() ); i < n; i++ )
+    {
+        s32& index = remap[indices[i]];
+
+        if( index < 0 )
+        {
+            index = static_cast<s32>( output.size() );
+            output.push_back( vertices[indices[i]] );
+        }
+
+        indices[i] = index;
+    }
+
+    vertices = output;
+}
+
+// ** MeshProcessing::averageCacheMissRatio
+f32 MeshProcessing::averageCacheMissRatio( const Mesh::IndexBuffer& indices, s32 vertexCount, s32 cacheSize )
+{
+    if( indices.size() < 3 )
+    {
+        return 0.0f;
+    }
+
+    // A vertex is cached while less than cacheSize other vertices were inserted after it
+    Array<s32> timestamps( vertexCount, -cacheSize - 1 );
+    s32        time   = 0;
+    s32        misses = 0;
+
+    for( s32 i = 0, n = static_cast<s32>( indices.size() ); i < n; i++ )
+    {
+        s32& timestamp = timestamps[indices[i]];
+
+        if( time - timestamp > cacheSize )
+        {
+            timestamp = time++;
+            misses++;
+        }
+    }
+
+    return static_cast<f32>( misses ) / (indices.size() / 3);
+}
+
+// ** MeshProcessing::indexSize
+s32 MeshProcessing::indexSize( s32 vertexCount )
+{
+    return vertexCount > 0xFFFF + 1 ? sizeof( u32 ) : sizeof( u16 );
+}
+
+// ** MeshProcessing::packIndices
+Array<u8> MeshProcessing::packIndices( const Mesh::IndexBuffer& indices, s32 indexSize )
+{
+    NIMBLE_ABORT_IF( indexSize != sizeof( u16 ) && indexSize != sizeof( u32 ), "unsupported index size" );
+
+    Array<u8> result( indices.size() * indexSize );
+
+    if( indices.empty() )
+    {
+        return result;
+    }
+
+    if( indexSize == sizeof( u32 ) )
+    {
+        memcpy( &result[0], &indices[0], result.size() );
+        return result;
+    }
+
+    u16* output = reinterpret_cast<u16*>( &result[0] );
+
+    for( s32 i = 0, n = static_cast<s32>( indices.size() ); i < n; i++ )
+    {
+        NIMBLE_BREAK_IF( indices[i] > 0xFFFF, "index does not fit 16 bits" );
+        output[i] = static_cast<u16>( indices[i] );
+    }
+
+    return result;
+}
+
+// ** MeshProcessing::unindexVertices
+Mesh::VertexBuffer MeshProcessing::unindexVertices( const Mesh::VertexBuffer& vertices, const Mesh::IndexBuffer& indices )
+{
+    Mesh::VertexBuffer result( indices.size() );
+
+    for( s32 i = 0, n = static_cast<s32>( indices.size() ); i < n; i++ )
+    {
+        result[i] = vertices[indices[i]];
+    }
+
+    return result;
+}
+
+// ** MeshProcessing::packVertices
+Array<u8> MeshProcessing::packVertices( const Mesh::VertexBuffer& vertices, const Renderer::VertexFormat& vertexFormat )
+{
+    typedef Renderer::VertexFormat VF;
+
+    s32       stride = vertexFormat.vertexSize();
+    Array<u8> result( vertices.size() * stride );
+
+    // Texture coordinate attributes for each UV layer
+    VF::Attribute uvLayers[Mesh::Vertex::MaxTexCoords] = { VF::TexCoord0, VF::TexCoord1 };
+
+    for( s32 i = 0, n = static_cast<s32>( vertices.size() ); i < n; i++ )
+    {
+        const Mesh::Vertex& vertex = vertices[i];
+        u8*                 output = &result[i * stride];
+
+        // Write a vertex position
+        if( vertexFormat.isPacked( VF::PackedPosition ) )
+        {
+            u16 position[] = { packHalf( vertex.position.x ), packHalf( vertex.position.y ), packHalf( vertex.position.z ), packHalf( 1.0f ) };
+            memcpy( output + vertexFormat.attributeOffset( VF::Position ), position, sizeof( position ) );
+        }
+        else
+        {
+            memcpy( output + vertexFormat.attributeOffset( VF::Position ), &vertex.position.x, sizeof( vertex.position ) );
+        }
+
+        // Write a vertex normal
+        if( vertexFormat & VF::Normal )
+        {
+            if( vertexFormat.isPacked( VF::PackedNormal ) )
+            {
+                f32 components[] = { vertex.normal.x, vertex.normal.y, vertex.normal.z };
+                s8  normal[4]    = { 0, 0, 0, 0 };
+
+                for( s32 j = 0; j < 3; j++ )
+                {
+                    normal[j] = static_cast<s8>( floor( min2( max2( components[j], -1.0f ), 1.0f ) * 127.0f + 0.5f ) );
+                }
+
+                memcpy( output + vertexFormat.attributeOffset( VF::Normal ), normal, sizeof( normal ) );
+            }
+            else
+            {
+                memcpy( output + vertexFormat.attributeOffset( VF::Normal ), &vertex.normal.x, sizeof( vertex.normal ) );
+            }
+        }
+
+        // Mesh vertices have no color, so write a white one
+        if( vertexFormat & VF::Color )
+        {
+            u32 white = ~0u;
+            memcpy( output + vertexFormat.attributeOffset( VF::Color ), &white, sizeof( white ) );
+        }
+
+        // Write texture coordinates
+        for( s32 j = 0; j < Mesh::Vertex::MaxTexCoords; j++ )
+        {
+            if( !(vertexFormat & uvLayers[j]) )
+            {
+                continue;
+            }
+
+            if( vertexFormat.isPacked( VF::PackedTexCoords ) )
+            {
+                u16 uv[] = { packHalf( vertex.uv[j].x ), packHalf( vertex.uv[j].y ) };
+                memcpy( output + vertexFormat.attributeOffset( uvLayers[j] ), uv, sizeof( uv ) );
+            }
+            else
+            {
+                memcpy( output + vertexFormat.attributeOffset( uvLayers[j] ), &vertex.uv[j].x, sizeof( vertex.uv[j] ) );
+            }
+        }
+    }
+
+    return result;
+}
+
+// ** MeshProcessing::packHalf
+u16 MeshProcessing::packHalf( f32 value )
+{
+    u32 bits;
+    memcpy( &bits, &value, sizeof( bits ) );
+
+    u32 sign     = (bits >> 16) & 0x8000;
+    s32 exponent = static_cast<s32>( (bits >> 23) & 0xFF ) - 127 + 15;
+    u32 mantissa = bits & 0x7FFFFF;
+
+    // Too small values are flushed to zero
+    if( exponent < -10 )
+    {
+        return static_cast<u16>( sign );
+    }
+
+    // Values below the smallest normal half are stored as denormals
+    if( exponent <= 0 )
+    {
+        mantissa |= 0x800000;
+
+        s32 shift = 14 - exponent;
+        u32 half  = mantissa >> shift;
+
+        if( (mantissa >> (shift - 1)) & 1 )
+        {
+            half++;
+        }
+
+        return static_cast<u16>( sign | half );
+    }
+
+    // Too large values, infinities and NaNs are stored as an infinity
+    if( exponent >= 31 )
+    {
+        return static_cast<u16>( sign | 0x7C00 );
+    }
+
+    // Round to nearest, a mantissa overflow correctly carries to an exponent
+    u32 half = sign | (exponent << 10) | (mantissa >> 13);
+
+    if( mantissa & 0x1000 )
+    {
+        half++;
+    }
+
+    return static_cast<u16>( half );
+}
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
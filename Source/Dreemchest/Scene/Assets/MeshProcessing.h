@@ -0,0 +1,81 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Scene_MeshProcessing_H__
+#define __DC_Scene_MeshProcessing_H__
+
+#include "Mesh.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene
+{
+    //! Prepares mesh data for rendering: reorders it for a GPU vertex cache and packs it to a compact vertex format.
+    class MeshProcessing
+    {
+    public:
+
+        //! A default post-transform vertex cache size used by the optimizer.
+        enum { DefaultCacheSize = 32 };
+
+        //! Reorders triangles and vertices of a mesh for a better vertex cache and fetch locality.
+        static void                 optimize( Mesh& mesh, s32 cacheSize = DefaultCacheSize );
+
+        //! Reorders triangles to maximize post-transform vertex cache hits.
+        static void                 optimizeVertexCache( Mesh::IndexBuffer& indices, s32 vertexCount, s32 cacheSize = DefaultCacheSize );
+
+        //! Reorders vertices in an order they are referenced by triangles and removes unused ones.
+        static void                 optimizeVertexFetch( Mesh::VertexBuffer& vertices, Mesh::IndexBuffer& indices );
+
+        //! Returns an average number of vertex cache misses per triangle for a FIFO cache of specified size.
+        static f32                  averageCacheMissRatio( const Mesh::IndexBuffer& indices, s32 vertexCount, s32 cacheSize = DefaultCacheSize );
+
+        //! Returns the smallest index size in bytes that can address specified number of vertices.
+        static s32                  indexSize( s32 vertexCount );
+
+        //! Converts indices to an array of 16 or 32 bit values.
+        static Array<u8>            packIndices( const Mesh::IndexBuffer& indices, s32 indexSize );
+
+        //! Writes a copy of a referenced vertex for each index, so a mesh can be rendered without an index buffer.
+        static Mesh::VertexBuffer   unindexVertices( const Mesh::VertexBuffer& vertices, const Mesh::IndexBuffer& indices );
+
+        //! Converts vertices to an interleaved buffer of specified vertex format.
+        static Array<u8>            packVertices( const Mesh::VertexBuffer& vertices, const Renderer::VertexFormat& vertexFormat );
+
+        //! Converts a 32-bit float to a 16-bit half float.
+        static u16                  packHalf( f32 value );
+
+    private:
+
+        //! Calculates the vertex score used to select a next triangle.
+        static f32                  vertexScore( s32 cachePosition, s32 remainingTriangles, s32 cacheSize );
+    };
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Scene_MeshProcessing_H__    */
@@ -358,11 +358,17 @@ Vec3 Heightmap::normal( u32 x, u32 z ) const
 // ** Heightmap::set
 void Heightmap::set( StrongPtr<Generator> generator )
 {
-    // Generate heightmap
+    // Generate heightmap row by row directly to a buffer
     for( u32 z = 0; z <= m_size; z++ ) {
-        for( u32 x = 0; x <= m_size; x++ ) {
-            setHeight( x, z, generator->calculate( x, z ) );
-        }
+        generator->calculateRow( z, m_size + 1, &m_buffer[z * (m_size + 1)] );
+    }
+}
+
+// ** Heightmap::Generator::calculateRow
+void Heightmap::Generator::calculateRow( u32 z, u32 count, Type* output )
+{
+    for( u32 x = 0; x < count; x++ ) {
+        output[x] = calculate( x, z );
     }
 }
 
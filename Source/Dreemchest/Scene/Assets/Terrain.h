@@ -46,6 +46,9 @@ namespace Scene {
 
             //! Calculates the height at specified point.
             virtual Type        calculate( u32 x, u32 z ) = 0;
+
+            //! Calculates heights for a row of points, override to generate a whole row at once.
+            virtual void        calculateRow( u32 z, u32 count, Type* output );
         };
 
                                 //! Constructs the Heightmap instance.
@@ -0,0 +1,875 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "TerrainLod.h"
+
+#if DC_THREADS_AVAILABLE
+    #include "../../Threads/Task/TaskManager.h"
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+// ------------------------------------------------------------------- TerrainTile ------------------------------------------------------------------- //
+
+// ** TerrainTile::TerrainTile
+TerrainTile::TerrainTile( s32 x, s32 z, s32 lod )
+    : m_x( x )
+    , m_z( z )
+    , m_lod( lod )
+    , m_state( Pending )
+    , m_lastUsed( 0 )
+    , m_minHeight( 0.0f )
+    , m_maxHeight( 0.0f )
+{
+}
+
+// ** TerrainTile::x
+s32 TerrainTile::x( void ) const
+{
+    return m_x;
+}
+
+// ** TerrainTile::z
+s32 TerrainTile::z( void ) const
+{
+    return m_z;
+}
+
+// ** TerrainTile::lod
+s32 TerrainTile::lod( void ) const
+{
+    return m_lod;
+}
+
+// ** TerrainTile::step
+s32 TerrainTile::step( void ) const
+{
+    return 1 << m_lod;
+}
+
+// ** TerrainTile::state
+TerrainTile::State TerrainTile::state( void ) const
+{
+    return m_state;
+}
+
+// ** TerrainTile::setState
+void TerrainTile::setState( State value )
+{
+    m_state = value;
+}
+
+// ** TerrainTile::lastUsed
+u32 TerrainTile::lastUsed( void ) const
+{
+    return m_lastUsed;
+}
+
+// ** TerrainTile::setLastUsed
+void TerrainTile::setLastUsed( u32 value )
+{
+    m_lastUsed = value;
+}
+
+// ** TerrainTile::vertices
+const TerrainTile::VertexBuffer& TerrainTile::vertices( void ) const
+{
+    return m_vertices;
+}
+
+// ** TerrainTile::minHeight
+f32 TerrainTile::minHeight( void ) const
+{
+    return m_minHeight;
+}
+
+// ** TerrainTile::maxHeight
+f32 TerrainTile::maxHeight( void ) const
+{
+    return m_maxHeight;
+}
+
+// ** TerrainTile::allocatedBytes
+u32 TerrainTile::allocatedBytes( void ) const
+{
+    return static_cast<u32>( m_vertices.capacity() * sizeof( Vertex ) + sizeof( TerrainTile ) );
+}
+
+// ** TerrainTile::height
+f32 TerrainTile::height( f32 x, f32 z ) const
+{
+    NIMBLE_BREAK_IF( m_vertices.empty(), "tile was not generated yet" );
+
+    s32 stride = Terrain::kChunkSize + 1;
+    f32 size   = static_cast<f32>( Terrain::kChunkSize * step() );
+
+    // Convert to tile cell coordinates
+    f32 cx = min2( max2( (x - m_x * size) / step(), 0.0f ), static_cast<f32>( Terrain::kChunkSize ) );
+    f32 cz = min2( max2( (z - m_z * size) / step(), 0.0f ), static_cast<f32>( Terrain::kChunkSize ) );
+
+    s32 hx = min2( static_cast<s32>( floor( cx ) ), Terrain::kChunkSize - 1 );
+    s32 hz = min2( static_cast<s32>( floor( cz ) ), Terrain::kChunkSize - 1 );
+
+    // Calculate the fraction values
+    f32 fx = cx - hx;
+    f32 fz = cz - hz;
+
+    // Calculate interpolated tile height
+    f32 height = 0.0f;
+
+    height += m_vertices[(hz    ) * stride + hx    ].position.y * (1.0f - fx) * (1.0f - fz);
+    height += m_vertices[(hz    ) * stride + hx + 1].position.y * (       fx) * (1.0f - fz);
+    height += m_vertices[(hz + 1) * stride + hx    ].position.y * (1.0f - fx) * (       fz);
+    height += m_vertices[(hz + 1) * stride + hx + 1].position.y * (       fx) * (       fz);
+
+    return height;
+}
+
+// ** TerrainTile::generate
+void TerrainTile::generate( const Terrain& terrain )
+{
+    s32 stride  = Terrain::kChunkSize + 1;
+    s32 padded  = Terrain::kChunkSize + 3;
+    s32 step    = this->step();
+    s32 size    = static_cast<s32>( terrain.size() );
+    s32 originX = m_x * Terrain::kChunkSize * step;
+    s32 originZ = m_z * Terrain::kChunkSize * step;
+    f32 uvSize  = 1.0f / size;
+
+    // Sample heights once with a single sample border used to calculate normals
+    Array<f32> heights;
+    heights.resize( padded * padded );
+
+    for( s32 i = 0; i < padded; i++ ) {
+        s32 z = min2( max2( originZ + (i - 1) * step, 0 ), size );
+
+        for( s32 j = 0; j < padded; j++ ) {
+            s32 x = min2( max2( originX + (j - 1) * step, 0 ), size );
+            heights[i * padded + j] = terrain.heightAtVertex( x, z );
+        }
+    }
+
+    // Fill the vertex buffer
+    m_vertices.resize( stride * stride );
+    m_minHeight = heights[padded + 1];
+    m_maxHeight = heights[padded + 1];
+
+    for( s32 i = 0; i <= Terrain::kChunkSize; i++ ) {
+        for( s32 j = 0; j <= Terrain::kChunkSize; j++ ) {
+            const f32* h      = &heights[(i + 1) * padded + (j + 1)];
+            Vertex&    vertex = m_vertices[i * stride + j];
+
+            vertex.position = Vec3( static_cast<f32>( min2( originX + j * step, size ) ), h[0], static_cast<f32>( min2( originZ + i * step, size ) ) );
+            vertex.normal   = Vec3( h[-1] - h[1], 2.0f * step, h[-padded] - h[padded] );
+            vertex.normal.normalize();
+            vertex.uv       = Vec2( vertex.position.x, vertex.position.z ) * uvSize;
+
+            // Odd vertices are missing on a coarser grid, so they morph to the edge or diagonal
+            // of a coarser triangle they lie on. Diagonals match the chunk index buffer split.
+            bool oddRow    = (i & 1) != 0;
+            bool oddColumn = (j & 1) != 0;
+
+            if( oddRow && oddColumn ) {
+                vertex.morphHeight = (h[padded - 1] + h[-padded + 1]) * 0.5f;
+            }
+            else if( oddColumn ) {
+                vertex.morphHeight = (h[-1] + h[1]) * 0.5f;
+            }
+            else if( oddRow ) {
+                vertex.morphHeight = (h[-padded] + h[padded]) * 0.5f;
+            }
+            else {
+                vertex.morphHeight = h[0];
+            }
+
+            m_minHeight = min2( m_minHeight, h[0] );
+            m_maxHeight = max2( m_maxHeight, h[0] );
+        }
+    }
+}
+
+// ------------------------------------------------------------------- TerrainLod -------------------------------------------------------------------- //
+
+// ** TerrainLod::TerrainLod
+TerrainLod::TerrainLod( const Terrain& terrain, f32 lodDistance, u32 maxResidentTiles )
+    : m_terrain( terrain )
+    , m_chunkCount( terrain.chunkCount() )
+    , m_maxLod( 0 )
+    , m_lodDistance( lodDistance )
+    , m_morphRatio( 0.5f )
+    , m_maxResidentTiles( maxResidentTiles )
+    , m_generationBudget( 8 )
+    , m_frame( 0 )
+{
+    NIMBLE_BREAK_IF( m_chunkCount == 0, "terrain should contain at least one chunk" );
+
+    // The root node should cover a whole terrain
+    while( (1 << m_maxLod) < m_chunkCount ) {
+        m_maxLod++;
+    }
+
+    m_lodGrid.resize( m_chunkCount * m_chunkCount );
+    createIndexBuffers();
+
+#if DC_THREADS_AVAILABLE
+    m_mutex = Threads::Mutex::create();
+#endif  /*  DC_THREADS_AVAILABLE    */
+}
+
+// ** TerrainLod::~TerrainLod
+TerrainLod::~TerrainLod( void )
+{
+#if DC_THREADS_AVAILABLE
+    // Background tasks reference tiles and this object, so wait for them to finish
+    for( Tiles::const_iterator i = m_tiles.begin(), end = m_tiles.end(); i != end; ++i ) {
+        if( i->second->m_task.valid() ) {
+            i->second->m_task->waitForCompletion();
+        }
+    }
+#endif  /*  DC_THREADS_AVAILABLE    */
+}
+
+// ** TerrainLod::maxLod
+s32 TerrainLod::maxLod( void ) const
+{
+    return m_maxLod;
+}
+
+// ** TerrainLod::lodDistance
+f32 TerrainLod::lodDistance( void ) const
+{
+    return m_lodDistance;
+}
+
+// ** TerrainLod::setLodDistance
+void TerrainLod::setLodDistance( f32 value )
+{
+    NIMBLE_BREAK_IF( value <= 0.0f, "LOD distance should be positive" );
+    m_lodDistance = value;
+}
+
+// ** TerrainLod::morphRatio
+f32 TerrainLod::morphRatio( void ) const
+{
+    return m_morphRatio;
+}
+
+// ** TerrainLod::setMorphRatio
+void TerrainLod::setMorphRatio( f32 value )
+{
+    m_morphRatio = min2( max2( value, 0.0f ), 1.0f );
+}
+
+// ** TerrainLod::maxResidentTiles
+u32 TerrainLod::maxResidentTiles( void ) const
+{
+    return m_maxResidentTiles;
+}
+
+// ** TerrainLod::setMaxResidentTiles
+void TerrainLod::setMaxResidentTiles( u32 value )
+{
+    m_maxResidentTiles = value;
+}
+
+// ** TerrainLod::generationBudget
+u32 TerrainLod::generationBudget( void ) const
+{
+    return m_generationBudget;
+}
+
+// ** TerrainLod::setGenerationBudget
+void TerrainLod::setGenerationBudget( u32 value )
+{
+    m_generationBudget = value;
+}
+
+#if DC_THREADS_AVAILABLE
+
+// ** TerrainLod::setTaskManager
+void TerrainLod::setTaskManager( Threads::TaskManagerWPtr value )
+{
+    m_taskManager = value;
+}
+
+// ** TerrainLod::generateTile
+void TerrainLod::generateTile( Threads::TaskProgressWPtr progress, void* userData )
+{
+    TerrainTile* tile = reinterpret_cast<TerrainTile*>( userData );
+    tile->generate( m_terrain );
+
+    DC_SCOPED_LOCK( m_mutex );
+    tile->setState( TerrainTile::Ready );
+}
+
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+// ** TerrainLod::nodes
+const TerrainLod::Nodes& TerrainLod::nodes( void ) const
+{
+    return m_nodes;
+}
+
+// ** TerrainLod::indexBuffer
+const Terrain::IndexBuffer& TerrainLod::indexBuffer( u8 edges ) const
+{
+    NIMBLE_ABORT_IF( edges >= TotalEdgeMasks, "invalid edge mask" );
+    return m_indexBuffers[edges];
+}
+
+// ** TerrainLod::residentTileCount
+u32 TerrainLod::residentTileCount( void ) const
+{
+    return static_cast<u32>( m_tiles.size() ) - pendingTileCount();
+}
+
+// ** TerrainLod::pendingTileCount
+u32 TerrainLod::pendingTileCount( void ) const
+{
+#if DC_THREADS_AVAILABLE
+    DC_SCOPED_LOCK( m_mutex );
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+    u32 count = 0;
+
+    for( Tiles::const_iterator i = m_tiles.begin(), end = m_tiles.end(); i != end; ++i ) {
+        if( i->second->state() == TerrainTile::Pending ) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+// ** TerrainLod::allocatedBytes
+u32 TerrainLod::allocatedBytes( void ) const
+{
+#if DC_THREADS_AVAILABLE
+    DC_SCOPED_LOCK( m_mutex );
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+    u32 bytes = 0;
+
+    for( Tiles::const_iterator i = m_tiles.begin(), end = m_tiles.end(); i != end; ++i ) {
+        if( i->second->state() == TerrainTile::Ready ) {
+            bytes += i->second->allocatedBytes();
+        }
+    }
+
+    return bytes;
+}
+
+// ** TerrainLod::height
+f32 TerrainLod::height( f32 x, f32 z ) const
+{
+    f32 size = static_cast<f32>( m_terrain.size() );
+
+    if( x < 0.0f || x > size ) return -1.0f;
+    if( z < 0.0f || z > size ) return -1.0f;
+
+    // Look for the finest resident tile that covers this point
+    for( s32 lod = 0; lod <= m_maxLod; lod++ ) {
+        s32 tileSize = Terrain::kChunkSize << lod;
+        s32 tiles    = (m_chunkCount + (1 << lod) - 1) >> lod;
+        s32 tx       = min2( static_cast<s32>( x ) / tileSize, tiles - 1 );
+        s32 tz       = min2( static_cast<s32>( z ) / tileSize, tiles - 1 );
+
+        TerrainTileWPtr tile = findReadyTile( tx, tz, lod );
+
+        if( tile.valid() ) {
+            return tile->height( x, z );
+        }
+    }
+
+    // No tiles were generated for this point yet
+    return m_terrain.height( x, z );
+}
+
+// ** TerrainLod::update
+const TerrainLod::Nodes& TerrainLod::update( const Vec3& camera )
+{
+    Array<Vec3> cameras;
+    cameras.push_back( camera );
+    return update( cameras );
+}
+
+// ** TerrainLod::update
+const TerrainLod::Nodes& TerrainLod::update( const Array<Vec3>& cameras )
+{
+    m_frame++;
+
+    // Select nodes and split the ones that break the quadtree balance until it is restored
+    m_forcedSplits.clear();
+
+    do {
+        m_nodes.clear();
+        selectNode( 0, 0, m_maxLod, cameras );
+        fillLodGrid();
+    } while( balanceNodes() );
+
+    // Calculate stitched edges for a balanced quadtree
+    assignEdges();
+
+    // Process nodes from near to far, so the nearest tiles are generated first
+    std::sort( m_nodes.begin(), m_nodes.end(), nodeDistanceLess );
+
+    // Request missing tiles, cover the ones that are not ready yet and release unused ones
+    requestTiles();
+    substituteMissingTiles( cameras );
+    evictTiles();
+
+    return m_nodes;
+}
+
+// ** TerrainLod::selectNode
+void TerrainLod::selectNode( s32 x, s32 z, s32 lod, const Array<Vec3>& cameras )
+{
+    // Skip nodes that are completely outside a terrain
+    if( (x << lod) >= m_chunkCount || (z << lod) >= m_chunkCount ) {
+        return;
+    }
+
+    f32 distance = distanceToNode( x, z, lod, cameras );
+
+    // Split this node if any camera is close enough or a neighbour requires it
+    if( lod > 0 && (distance < lodRange( lod ) || m_forcedSplits.count( tileKey( x, z, lod ) )) ) {
+        selectNode( x * 2 + 0, z * 2 + 0, lod - 1, cameras );
+        selectNode( x * 2 + 1, z * 2 + 0, lod - 1, cameras );
+        selectNode( x * 2 + 0, z * 2 + 1, lod - 1, cameras );
+        selectNode( x * 2 + 1, z * 2 + 1, lod - 1, cameras );
+        return;
+    }
+
+    m_nodes.push_back( createNode( x, z, lod, distance ) );
+}
+
+// ** TerrainLod::createNode
+TerrainLod::Node TerrainLod::createNode( s32 x, s32 z, s32 lod, f32 distance ) const
+{
+    // Vertices morph to a next LOD while approaching a distance this node was split at
+    f32 rangeStart = lodRange( lod );
+    f32 rangeEnd   = lodRange( lod + 1 );
+
+    Node node;
+    node.x          = x;
+    node.z          = z;
+    node.lod        = lod;
+    node.edges      = 0;
+    node.distance   = distance;
+    node.morphStart = rangeStart + (rangeEnd - rangeStart) * m_morphRatio;
+    node.morphEnd   = rangeEnd;
+
+    return node;
+}
+
+// ** TerrainLod::fillLodGrid
+void TerrainLod::fillLodGrid( void )
+{
+    for( s32 i = 0, n = static_cast<s32>( m_nodes.size() ); i < n; i++ ) {
+        const Node& node = m_nodes[i];
+
+        s32 x0 = node.x << node.lod;
+        s32 z0 = node.z << node.lod;
+        s32 x1 = min2( x0 + (1 << node.lod), m_chunkCount );
+        s32 z1 = min2( z0 + (1 << node.lod), m_chunkCount );
+
+        for( s32 z = z0; z < z1; z++ ) {
+            for( s32 x = x0; x < x1; x++ ) {
+                m_lodGrid[z * m_chunkCount + x] = node.lod;
+            }
+        }
+    }
+}
+
+// ** TerrainLod::lodAtChunk
+s32 TerrainLod::lodAtChunk( s32 x, s32 z ) const
+{
+    if( x < 0 || z < 0 || x >= m_chunkCount || z >= m_chunkCount ) {
+        return -1;
+    }
+
+    return m_lodGrid[z * m_chunkCount + x];
+}
+
+// ** TerrainLod::balanceNodes
+bool TerrainLod::balanceNodes( void )
+{
+    bool changed = false;
+
+    for( s32 i = 0, n = static_cast<s32>( m_nodes.size() ); i < n; i++ ) {
+        const Node& node = m_nodes[i];
+
+        // Nodes at the two finest levels can't have a neighbour two levels finer
+        if( node.lod < 2 ) {
+            continue;
+        }
+
+        s32 x0     = node.x << node.lod;
+        s32 z0     = node.z << node.lod;
+        s32 chunks = 1 << node.lod;
+        s32 finest = node.lod;
+
+        // Find the finest neighbour along all four edges
+        for( s32 j = 0; j < chunks; j++ ) {
+            s32 lods[] = {
+                  lodAtChunk( x0 + j, z0 - 1 )
+                , lodAtChunk( x0 + chunks, z0 + j )
+                , lodAtChunk( x0 + j, z0 + chunks )
+                , lodAtChunk( x0 - 1, z0 + j )
+            };
+
+            for( s32 k = 0; k < 4; k++ ) {
+                if( lods[k] >= 0 ) {
+                    finest = min2( finest, lods[k] );
+                }
+            }
+        }
+
+        if( finest < node.lod - 1 ) {
+            m_forcedSplits.insert( tileKey( node.x, node.z, node.lod ) );
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+// ** TerrainLod::assignEdges
+void TerrainLod::assignEdges( void )
+{
+    for( s32 i = 0, n = static_cast<s32>( m_nodes.size() ); i < n; i++ ) {
+        Node& node = m_nodes[i];
+
+        s32 x0     = node.x << node.lod;
+        s32 z0     = node.z << node.lod;
+        s32 chunks = 1 << node.lod;
+        s32 coarse = node.lod + 1;
+
+        // A coarser neighbour always covers a whole edge of a balanced node
+        if( lodAtChunk( x0, z0 - 1 ) == coarse )      node.edges |= EdgeNorth;
+        if( lodAtChunk( x0 + chunks, z0 ) == coarse ) node.edges |= EdgeEast;
+        if( lodAtChunk( x0, z0 + chunks ) == coarse ) node.edges |= EdgeSouth;
+        if( lodAtChunk( x0 - 1, z0 ) == coarse )      node.edges |= EdgeWest;
+    }
+}
+
+// ** TerrainLod::requestTiles
+void TerrainLod::requestTiles( void )
+{
+#if DC_THREADS_AVAILABLE
+    DC_SCOPED_LOCK( m_mutex );
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+    u32 budget = m_generationBudget;
+
+    // The root tile is requested first, so there is always a coarser tile to fall back to
+    requestTile( 0, 0, m_maxLod, budget );
+
+    for( s32 i = 0, n = static_cast<s32>( m_nodes.size() ); i < n; i++ ) {
+        Node& node = m_nodes[i];
+        node.tile = requestTile( node.x, node.z, node.lod, budget );
+    }
+}
+
+// ** TerrainLod::requestTile
+TerrainTileWPtr TerrainLod::requestTile( s32 x, s32 z, s32 lod, u32& budget )
+{
+    u64             key = tileKey( x, z, lod );
+    Tiles::iterator i   = m_tiles.find( key );
+
+    // The tile is resident or is being generated
+    if( i != m_tiles.end() ) {
+        TerrainTilePtr& tile = i->second;
+        tile->setLastUsed( m_frame );
+
+        if( tile->state() != TerrainTile::Ready ) {
+            return TerrainTileWPtr();
+        }
+
+    #if DC_THREADS_AVAILABLE
+        tile->m_task = Threads::TaskProgressPtr();
+    #endif  /*  DC_THREADS_AVAILABLE    */
+        return tile;
+    }
+
+    // Too many tiles were requested during this update
+    if( budget == 0 ) {
+        return TerrainTileWPtr();
+    }
+    budget--;
+
+    TerrainTilePtr tile = DC_NEW TerrainTile( x, z, lod );
+    tile->setLastUsed( m_frame );
+    m_tiles[key] = tile;
+
+#if DC_THREADS_AVAILABLE
+    // Queue the tile generation, coarser tiles cover more area and are generated first
+    if( m_taskManager.valid() ) {
+        tile->m_task = m_taskManager->runBackgroundTask( dcThisMethod( TerrainLod::generateTile ), tile.get(), tile->lod() );
+        return TerrainTileWPtr();
+    }
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+    tile->generate( m_terrain );
+    tile->setState( TerrainTile::Ready );
+
+    return tile;
+}
+
+// ** TerrainLod::substituteMissingTiles
+void TerrainLod::substituteMissingTiles( const Array<Vec3>& cameras )
+{
+    // Find the nearest coarser resident tile for each node that has no tile
+    Map<u64, TerrainTileWPtr> fallbacks;
+
+    for( s32 i = 0, n = static_cast<s32>( m_nodes.size() ); i < n; i++ ) {
+        const Node& node = m_nodes[i];
+
+        if( node.tile.valid() ) {
+            continue;
+        }
+
+        for( s32 lod = node.lod + 1; lod <= m_maxLod; lod++ ) {
+            s32             shift = lod - node.lod;
+            TerrainTileWPtr tile  = findReadyTile( node.x >> shift, node.z >> shift, lod );
+
+            if( tile.valid() ) {
+                fallbacks[tileKey( tile->x(), tile->z(), tile->lod() )] = tile;
+                break;
+            }
+        }
+    }
+
+    if( fallbacks.empty() ) {
+        return;
+    }
+
+    // Drop all nodes covered by a fallback tile, including finer fallback tiles
+    Nodes nodes;
+
+    for( s32 i = 0, n = static_cast<s32>( m_nodes.size() ); i < n; i++ ) {
+        const Node& node = m_nodes[i];
+
+        if( !hasCoarserNode( node.x, node.z, node.lod, m_maxLod, fallbacks ) ) {
+            nodes.push_back( node );
+        }
+    }
+
+    for( Map<u64, TerrainTileWPtr>::const_iterator i = fallbacks.begin(), end = fallbacks.end(); i != end; ++i ) {
+        const TerrainTileWPtr& tile = i->second;
+
+        if( hasCoarserNode( tile->x(), tile->z(), tile->lod(), m_maxLod, fallbacks ) ) {
+            continue;
+        }
+
+        // Fallback tiles are rendered, so they should not be evicted during this update
+        tile->setLastUsed( m_frame );
+
+        Node node = createNode( tile->x(), tile->z(), tile->lod(), distanceToNode( tile->x(), tile->z(), tile->lod(), cameras ) );
+        node.tile = tile;
+        nodes.push_back( node );
+    }
+
+    m_nodes = nodes;
+
+    // Fallback nodes may border finer nodes, so recalculate stitched edges and keep near to far order
+    fillLodGrid();
+
+    for( s32 i = 0, n = static_cast<s32>( m_nodes.size() ); i < n; i++ ) {
+        m_nodes[i].edges = 0;
+    }
+
+    assignEdges();
+    std::sort( m_nodes.begin(), m_nodes.end(), nodeDistanceLess );
+}
+
+// ** TerrainLod::hasCoarserNode
+bool TerrainLod::hasCoarserNode( s32 x, s32 z, s32 lod, s32 maxLod, const Map<u64, TerrainTileWPtr>& nodes )
+{
+    for( s32 coarser = lod + 1; coarser <= maxLod; coarser++ ) {
+        s32 shift = coarser - lod;
+
+        if( nodes.count( tileKey( x >> shift, z >> shift, coarser ) ) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ** TerrainLod::evictTiles
+void TerrainLod::evictTiles( void )
+{
+    if( m_tiles.size() <= m_maxResidentTiles ) {
+        return;
+    }
+
+#if DC_THREADS_AVAILABLE
+    DC_SCOPED_LOCK( m_mutex );
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+    // Tiles that are still generated or were selected during this update are never evicted
+    Array<TerrainTilePtr> unused;
+
+    for( Tiles::const_iterator i = m_tiles.begin(), end = m_tiles.end(); i != end; ++i ) {
+        if( i->second->state() == TerrainTile::Ready && i->second->lastUsed() != m_frame ) {
+            unused.push_back( i->second );
+        }
+    }
+
+    // Evict least recently used tiles first
+    std::sort( unused.begin(), unused.end(), tileUsageLess );
+
+    for( s32 i = 0, n = static_cast<s32>( unused.size() ); i < n && m_tiles.size() > m_maxResidentTiles; i++ ) {
+        const TerrainTilePtr& tile = unused[i];
+        tile->setState( TerrainTile::Evicted );
+        m_tiles.erase( tileKey( tile->x(), tile->z(), tile->lod() ) );
+    }
+}
+
+// ** TerrainLod::findReadyTile
+TerrainTileWPtr TerrainLod::findReadyTile( s32 x, s32 z, s32 lod ) const
+{
+#if DC_THREADS_AVAILABLE
+    DC_SCOPED_LOCK( m_mutex );
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+    Tiles::const_iterator i = m_tiles.find( tileKey( x, z, lod ) );
+
+    if( i == m_tiles.end() || i->second->state() != TerrainTile::Ready ) {
+        return TerrainTileWPtr();
+    }
+
+    return i->second;
+}
+
+// ** TerrainLod::lodRange
+f32 TerrainLod::lodRange( s32 lod ) const
+{
+    return m_lodDistance * (1 << lod);
+}
+
+// ** TerrainLod::distanceToNode
+f32 TerrainLod::distanceToNode( s32 x, s32 z, s32 lod, const Vec3& point ) const
+{
+    f32 size = static_cast<f32>( Terrain::kChunkSize << lod );
+    f32 minY = 0.0f;
+    f32 maxY = m_terrain.maxHeight();
+
+    // Use actual height bounds of a resident tile when possible
+    TerrainTileWPtr tile = findReadyTile( x, z, lod );
+
+    if( tile.valid() ) {
+        minY = tile->minHeight();
+        maxY = tile->maxHeight();
+    }
+
+    Vec3 min( x * size, minY, z * size );
+    Vec3 max( (x + 1) * size, maxY, (z + 1) * size );
+
+    // Calculate a distance to the closest point of node bounds
+    f32 dx = max2( max2( min.x - point.x, point.x - max.x ), 0.0f );
+    f32 dy = max2( max2( min.y - point.y, point.y - max.y ), 0.0f );
+    f32 dz = max2( max2( min.z - point.z, point.z - max.z ), 0.0f );
+
+    return sqrtf( dx * dx + dy * dy + dz * dz );
+}
+
+// ** TerrainLod::distanceToNode
+f32 TerrainLod::distanceToNode( s32 x, s32 z, s32 lod, const Array<Vec3>& cameras ) const
+{
+    f32 distance = FLT_MAX;
+
+    for( s32 i = 0, n = static_cast<s32>( cameras.size() ); i < n; i++ ) {
+        distance = min2( distance, distanceToNode( x, z, lod, cameras[i] ) );
+    }
+
+    return distance;
+}
+
+// ** TerrainLod::createIndexBuffers
+void TerrainLod::createIndexBuffers( void )
+{
+    s32                  stride  = Terrain::kChunkSize + 1;
+    Terrain::IndexBuffer indices = m_terrain.chunkIndexBuffer();
+
+    for( s32 mask = 0; mask < TotalEdgeMasks; mask++ ) {
+        Terrain::IndexBuffer& stitched = m_indexBuffers[mask];
+        stitched.reserve( indices.size() );
+
+        for( s32 i = 0, n = static_cast<s32>( indices.size() ); i + 2 < n; i += 3 ) {
+            u16 triangle[3];
+
+            // Snap odd vertices on stitched edges to a previous even vertex, so the edge matches a coarser neighbour
+            for( s32 k = 0; k < 3; k++ ) {
+                s32 row    = indices[i + k] / stride;
+                s32 column = indices[i + k] % stride;
+
+                if( (column & 1) && ((row == 0 && (mask & EdgeNorth)) || (row == Terrain::kChunkSize && (mask & EdgeSouth))) ) {
+                    column--;
+                }
+                if( (row & 1) && ((column == 0 && (mask & EdgeWest)) || (column == Terrain::kChunkSize && (mask & EdgeEast))) ) {
+                    row--;
+                }
+
+                triangle[k] = static_cast<u16>( row * stride + column );
+            }
+
+            // Skip triangles collapsed by snapping
+            if( triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2] ) {
+                continue;
+            }
+
+            stitched.push_back( triangle[0] );
+            stitched.push_back( triangle[1] );
+            stitched.push_back( triangle[2] );
+        }
+    }
+}
+
+// ** TerrainLod::tileKey
+u64 TerrainLod::tileKey( s32 x, s32 z, s32 lod )
+{
+    return (static_cast<u64>( lod ) << 48) | (static_cast<u64>( z ) << 24) | static_cast<u64>( x );
+}
+
+// ** TerrainLod::nodeDistanceLess
+bool TerrainLod::nodeDistanceLess( const Node& a, const Node& b )
+{
+    return a.distance < b.distance;
+}
+
+// ** TerrainLod::tileUsageLess
+bool TerrainLod::tileUsageLess( const TerrainTilePtr& a, const TerrainTilePtr& b )
+{
+    return a->lastUsed() < b->lastUsed();
+}
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
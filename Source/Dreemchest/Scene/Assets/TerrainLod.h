@@ -0,0 +1,320 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Scene_TerrainLod_H__
+#define __DC_Scene_TerrainLod_H__
+
+#include "Terrain.h"
+#include "../../Threads/Threads.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+    dcDeclarePtrs( TerrainTile )
+
+    //! A single terrain tile mesh generated at a fixed level of detail.
+    /*!
+     A tile always contains Terrain::kChunkSize x Terrain::kChunkSize cells, but each cell
+     covers 2^lod heightmap samples, so the coarser the LOD the larger area a tile covers.
+     Each vertex stores a morph height - the height of the same point on a coarser LOD grid,
+     so the renderer can blend between levels instead of popping.
+    */
+    class TerrainTile : public RefCounted {
+    friend class TerrainLod;
+    public:
+
+        //! A tile generation state.
+        enum State {
+              Pending   //!< A tile is queued for generation.
+            , Ready     //!< A tile mesh is generated and can be rendered.
+            , Evicted   //!< A tile was evicted from a terrain LOD, so renderers should release its GPU buffers.
+        };
+
+        //! Terrain tile vertex struct.
+        struct Vertex {
+            Vec3                position;       //!< Vertex position in terrain space.
+            f32                 morphHeight;    //!< Vertex height on a next coarser LOD grid.
+            Vec3                normal;         //!< Vertex normal.
+            Vec2                uv;             //!< Vertex UV coordinate.
+        };
+
+        typedef Array<Vertex>   VertexBuffer;   //!< Tile vertex buffer type.
+
+                                //! Constructs TerrainTile instance.
+                                TerrainTile( s32 x, s32 z, s32 lod );
+
+        //! Returns tile X coordinate in tiles of the same LOD.
+        s32                     x( void ) const;
+
+        //! Returns tile Z coordinate in tiles of the same LOD.
+        s32                     z( void ) const;
+
+        //! Returns tile level of detail.
+        s32                     lod( void ) const;
+
+        //! Returns a distance between two adjacent tile vertices in heightmap samples.
+        s32                     step( void ) const;
+
+        //! Returns tile generation state.
+        State                   state( void ) const;
+
+        //! Sets tile generation state.
+        void                    setState( State value );
+
+        //! Returns the frame index this tile was last selected for rendering.
+        u32                     lastUsed( void ) const;
+
+        //! Sets the frame index this tile was last selected for rendering.
+        void                    setLastUsed( u32 value );
+
+        //! Returns tile vertex buffer.
+        const VertexBuffer&     vertices( void ) const;
+
+        //! Returns the minimum tile height.
+        f32                     minHeight( void ) const;
+
+        //! Returns the maximum tile height.
+        f32                     maxHeight( void ) const;
+
+        //! Returns the amount of memory used by this tile.
+        u32                     allocatedBytes( void ) const;
+
+        //! Returns the bilinearly interpolated tile height at specified terrain space point.
+        f32                     height( f32 x, f32 z ) const;
+
+        //! Generates tile vertices from a terrain heightmap.
+        void                    generate( const Terrain& terrain );
+
+    private:
+
+        s32                     m_x;            //!< Tile X coordinate.
+        s32                     m_z;            //!< Tile Z coordinate.
+        s32                     m_lod;          //!< Tile level of detail.
+        State                   m_state;        //!< Tile generation state.
+        u32                     m_lastUsed;     //!< The frame index this tile was last selected.
+        f32                     m_minHeight;    //!< The minimum tile height.
+        f32                     m_maxHeight;    //!< The maximum tile height.
+        VertexBuffer            m_vertices;     //!< Generated tile vertices.
+    #if DC_THREADS_AVAILABLE
+        Threads::TaskProgressPtr m_task;        //!< A background task that generates this tile.
+    #endif  /*  DC_THREADS_AVAILABLE    */
+    };
+
+    //! Selects and streams terrain tiles using a chunked quadtree.
+    /*!
+     The root quadtree node covers the whole terrain at the coarsest LOD, each node is split
+     while a camera is closer than a LOD range, which doubles with each level. Selected nodes
+     are balanced so adjacent nodes differ by at most one level and each node records which of
+     its edges border a coarser node - these edges are stitched by an index buffer variant that
+     skips odd edge vertices. Tile meshes are generated on demand by background tasks and tiles
+     that were not used recently are evicted once the resident tile budget is exceeded.
+
+     While a tile is being generated its area is covered by the nearest coarser resident tile,
+     so a terrain never has holes. The root tile is always requested first for this reason.
+
+     All cameras that share a terrain LOD are passed to a single update per frame, so tiles
+     selected for one camera are never evicted by an update issued for another one.
+    */
+    class TerrainLod : public RefCounted {
+    public:
+
+        //! Tile edge flags, each set flag means that a neighbour on this side is one LOD coarser.
+        enum Edge {
+              EdgeNorth = BIT( 0 )  //!< A tile edge with a minimum Z coordinate.
+            , EdgeEast  = BIT( 1 )  //!< A tile edge with a maximum X coordinate.
+            , EdgeSouth = BIT( 2 )  //!< A tile edge with a maximum Z coordinate.
+            , EdgeWest  = BIT( 3 )  //!< A tile edge with a minimum X coordinate.
+            , TotalEdgeMasks = 16   //!< A total number of edge mask combinations.
+        };
+
+        //! A selected quadtree node.
+        struct Node {
+            s32                 x;              //!< Node X coordinate in nodes of the same LOD.
+            s32                 z;              //!< Node Z coordinate in nodes of the same LOD.
+            s32                 lod;            //!< Node level of detail.
+            u8                  edges;          //!< A bit mask of edges that should be stitched to a coarser neighbour.
+            f32                 distance;       //!< A distance from the nearest camera to a node bounds.
+            f32                 morphStart;     //!< A camera distance at which vertices start morphing to a coarser LOD.
+            f32                 morphEnd;       //!< A camera distance at which vertices are completely morphed.
+            TerrainTileWPtr     tile;           //!< A tile mesh to render or NULL if neither this tile nor a coarser one was generated yet.
+        };
+
+        typedef Array<Node>     Nodes;          //!< An array of selected quadtree nodes.
+
+                                //! Constructs TerrainLod instance.
+                                TerrainLod( const Terrain& terrain, f32 lodDistance = 64.0f, u32 maxResidentTiles = 256 );
+        virtual                 ~TerrainLod( void );
+
+        //! Returns the coarsest level of detail.
+        s32                     maxLod( void ) const;
+
+        //! Returns a camera distance at which the finest LOD switches to a next one.
+        f32                     lodDistance( void ) const;
+
+        //! Sets a camera distance at which the finest LOD switches to a next one.
+        void                    setLodDistance( f32 value );
+
+        //! Returns a fraction of a LOD range after which vertices start morphing.
+        f32                     morphRatio( void ) const;
+
+        //! Sets a fraction of a LOD range after which vertices start morphing.
+        void                    setMorphRatio( f32 value );
+
+        //! Returns the maximum number of tiles that are kept in memory.
+        u32                     maxResidentTiles( void ) const;
+
+        //! Sets the maximum number of tiles that are kept in memory.
+        void                    setMaxResidentTiles( u32 value );
+
+        //! Returns the maximum number of tiles that are generated or queued per update.
+        u32                     generationBudget( void ) const;
+
+        //! Sets the maximum number of tiles that are generated or queued per update.
+        void                    setGenerationBudget( u32 value );
+
+    #if DC_THREADS_AVAILABLE
+        //! Sets a task manager used to generate tiles in background, tiles are generated synchronously without it.
+        void                    setTaskManager( Threads::TaskManagerWPtr value );
+    #endif  /*  DC_THREADS_AVAILABLE    */
+
+        //! Selects quadtree nodes for a camera position, requests missing tiles and evicts unused ones.
+        const Nodes&            update( const Vec3& camera );
+
+        //! Selects quadtree nodes for all camera positions, a node is split when any camera is close enough.
+        const Nodes&            update( const Array<Vec3>& cameras );
+
+        //! Returns nodes selected by a last update.
+        const Nodes&            nodes( void ) const;
+
+        //! Returns an index buffer that stitches specified tile edges to a coarser neighbour.
+        const Terrain::IndexBuffer& indexBuffer( u8 edges ) const;
+
+        //! Returns the interpolated terrain height at specified point using the finest resident tile.
+        f32                     height( f32 x, f32 z ) const;
+
+        //! Returns a total number of resident tiles.
+        u32                     residentTileCount( void ) const;
+
+        //! Returns a total number of tiles that are still being generated.
+        u32                     pendingTileCount( void ) const;
+
+        //! Returns the amount of memory used by resident tiles.
+        u32                     allocatedBytes( void ) const;
+
+    private:
+
+        //! Container type to store resident tiles.
+        typedef Map<u64, TerrainTilePtr> Tiles;
+
+        //! Recursively selects quadtree nodes.
+        void                    selectNode( s32 x, s32 z, s32 lod, const Array<Vec3>& cameras );
+
+        //! Writes levels of detail of selected nodes to a per-chunk grid.
+        void                    fillLodGrid( void );
+
+        //! Returns a level of detail of a node that covers specified chunk or -1 for chunks outside a terrain.
+        s32                     lodAtChunk( s32 x, s32 z ) const;
+
+        //! Marks nodes that have a neighbour two or more levels finer to be split, returns true if any node was marked.
+        bool                    balanceNodes( void );
+
+        //! Calculates stitched edges of each selected node.
+        void                    assignEdges( void );
+
+        //! Creates a selected node at specified camera distance.
+        Node                    createNode( s32 x, s32 z, s32 lod, f32 distance ) const;
+
+        //! Finds a resident tile or queues a new one and assigns ready tiles to selected nodes.
+        void                    requestTiles( void );
+
+        //! Returns a ready tile or queues a new one within a generation budget.
+        TerrainTileWPtr         requestTile( s32 x, s32 z, s32 lod, u32& budget );
+
+        //! Replaces nodes with tiles that are still being generated by the nearest coarser resident tile.
+        void                    substituteMissingTiles( const Array<Vec3>& cameras );
+
+        //! Returns true if any coarser node that contains specified one is in a set.
+        static bool             hasCoarserNode( s32 x, s32 z, s32 lod, s32 maxLod, const Map<u64, TerrainTileWPtr>& nodes );
+
+        //! Evicts least recently used tiles that exceed a resident tile budget.
+        void                    evictTiles( void );
+
+        //! Returns a resident tile ready for rendering or NULL.
+        TerrainTileWPtr         findReadyTile( s32 x, s32 z, s32 lod ) const;
+
+        //! Returns a LOD range, a node is split when a camera is closer than this distance.
+        f32                     lodRange( s32 lod ) const;
+
+        //! Returns a distance from a point to a node bounds.
+        f32                     distanceToNode( s32 x, s32 z, s32 lod, const Vec3& point ) const;
+
+        //! Returns a distance from the nearest camera to a node bounds.
+        f32                     distanceToNode( s32 x, s32 z, s32 lod, const Array<Vec3>& cameras ) const;
+
+        //! Builds index buffers for all edge mask combinations.
+        void                    createIndexBuffers( void );
+
+        //! Packs tile coordinates to a single key.
+        static u64              tileKey( s32 x, s32 z, s32 lod );
+
+        //! Compares two nodes by a camera distance.
+        static bool             nodeDistanceLess( const Node& a, const Node& b );
+
+        //! Compares two tiles by a frame index they were last used.
+        static bool             tileUsageLess( const TerrainTilePtr& a, const TerrainTilePtr& b );
+
+    #if DC_THREADS_AVAILABLE
+        //! A background task that generates a single tile.
+        void                    generateTile( Threads::TaskProgressWPtr progress, void* userData );
+    #endif  /*  DC_THREADS_AVAILABLE    */
+
+    private:
+
+        const Terrain&          m_terrain;              //!< A source terrain.
+        s32                     m_chunkCount;           //!< A number of finest tiles along each side.
+        s32                     m_maxLod;               //!< The coarsest level of detail.
+        f32                     m_lodDistance;          //!< A finest LOD range.
+        f32                     m_morphRatio;           //!< A fraction of a LOD range after which vertices start morphing.
+        u32                     m_maxResidentTiles;     //!< The maximum number of resident tiles.
+        u32                     m_generationBudget;     //!< The maximum number of tiles generated per update.
+        u32                     m_frame;                //!< A current update index.
+        Tiles                   m_tiles;                //!< Resident and pending tiles.
+        Nodes                   m_nodes;                //!< Selected nodes.
+        Array<s32>              m_lodGrid;              //!< Levels of detail of selected nodes per finest chunk.
+        Set<u64>                m_forcedSplits;         //!< Nodes that are split to keep a quadtree balanced.
+        Terrain::IndexBuffer    m_indexBuffers[TotalEdgeMasks]; //!< Stitched index buffers for each edge mask.
+    #if DC_THREADS_AVAILABLE
+        Threads::TaskManagerWPtr m_taskManager;         //!< A task manager used to generate tiles.
+        Threads::MutexPtr       m_mutex;                //!< Guards tile generation states.
+    #endif  /*  DC_THREADS_AVAILABLE    */
+    };
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Scene_TerrainLod_H__    */
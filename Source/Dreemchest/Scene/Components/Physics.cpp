@@ -263,6 +263,7 @@ RigidBody2D::RigidBody2D( f32 mass, Type type, u16 category, u16 collisionMask,
     , m_category( category )
     , m_collisionMask( collisionMask )
     , m_rotatedTo( 0.0f )
+    , m_region( 0 )
 {
     m_flags.set( IsBullet, isBullet );
     m_flags.set( IsSensor, isSensor );
@@ -505,6 +506,18 @@ void RigidBody2D::setLinearVelocity( const Vec2& value )
     m_linearVelocity = value;
 }
 
+// ** RigidBody2D::region
+u16 RigidBody2D::region( void ) const
+{
+    return m_region;
+}
+
+// ** RigidBody2D::setRegion
+void RigidBody2D::setRegion( u16 value )
+{
+    m_region = value;
+}
+
 // ** RigidBody2D::updateMass
 void RigidBody2D::updateMass( f32 value )
 {
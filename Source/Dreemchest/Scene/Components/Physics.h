@@ -318,6 +318,12 @@ namespace Scene {
         //! Sets linear velocity of a body.
         void                    setLinearVelocity( const Vec2& value );
 
+        //! Returns a simulation region this body belongs to, bodies from different regions never interact.
+        u16                     region( void ) const;
+
+        //! Sets a simulation region, should be set before a body is added to a scene.
+        void                    setRegion( u16 value );
+
     private:
 
         //! Queues new collision event.
@@ -358,6 +364,7 @@ namespace Scene {
         Vec2                    m_movedTo;          //!< World-space position this rigid body was moved.
         f32                     m_rotatedTo;        //!< An angle this rigid body was rotated.
         FlagSet8                m_flags;            //!< State flags.
+        u16                     m_region;           //!< Independent simulation region index.
         Vec2                    m_linearVelocity;   //!< Linear velocity of a body.
     };
 
@@ -64,6 +64,10 @@ ForwardRenderer::ForwardRenderer( s32 shadowSize, s32 shadowCascadeCount )
     , m_shadowCascadeCount( shadowCascadeCount )
     , m_shadowCascadeLambda( 0.5f )
     , m_debugCascadeShadows( false )
+    , m_clustered( false )
+    , m_shadowUpdateBudget( 0 )
+    , m_staggeredCascades( true )
+    , m_occlusionCulling( false )
 {
 }
 
@@ -115,6 +119,54 @@ void ForwardRenderer::setShadowCascadeLambda( f32 value )
     m_shadowCascadeLambda = value;
 }
 
+// ** ForwardRenderer::isClustered
+bool ForwardRenderer::isClustered( void ) const
+{
+    return m_clustered;
+}
+
+// ** ForwardRenderer::setClustered
+void ForwardRenderer::setClustered( bool value )
+{
+    m_clustered = value;
+}
+
+// ** ForwardRenderer::shadowUpdateBudget
+s32 ForwardRenderer::shadowUpdateBudget( void ) const
+{
+    return m_shadowUpdateBudget;
+}
+
+// ** ForwardRenderer::setShadowUpdateBudget
+void ForwardRenderer::setShadowUpdateBudget( s32 value )
+{
+    m_shadowUpdateBudget = max2( value, 0 );
+}
+
+// ** ForwardRenderer::isStaggeredCascades
+bool ForwardRenderer::isStaggeredCascades( void ) const
+{
+    return m_staggeredCascades;
+}
+
+// ** ForwardRenderer::setStaggeredCascades
+void ForwardRenderer::setStaggeredCascades( bool value )
+{
+    m_staggeredCascades = value;
+}
+
+// ** ForwardRenderer::isOcclusionCulling
+bool ForwardRenderer::isOcclusionCulling( void ) const
+{
+    return m_occlusionCulling;
+}
+
+// ** ForwardRenderer::setOcclusionCulling
+void ForwardRenderer::setOcclusionCulling( bool value )
+{
+    m_occlusionCulling = value;
+}
+
 // -------------------------------------------------------------- DebugRenderer -------------------------------------------------------------- //
 
 // ** DebugRenderer::DebugRenderer
@@ -161,6 +213,39 @@ void DebugRenderer::setCameraColor( const Rgba& value )
     m_cameraColor = value;
 }
 
+// ------------------------------------------------------------- TerrainRenderer ------------------------------------------------------------- //
+
+// ** TerrainRenderer::TerrainRenderer
+TerrainRenderer::TerrainRenderer( TerrainLodPtr lod, const Rgba& color )
+    : m_lod( lod )
+    , m_color( color )
+{
+}
+
+// ** TerrainRenderer::lod
+TerrainLodWPtr TerrainRenderer::lod( void ) const
+{
+    return m_lod;
+}
+
+// ** TerrainRenderer::setLod
+void TerrainRenderer::setLod( TerrainLodPtr value )
+{
+    m_lod = value;
+}
+
+// ** TerrainRenderer::color
+const Rgba& TerrainRenderer::color( void ) const
+{
+    return m_color;
+}
+
+// ** TerrainRenderer::setColor
+void TerrainRenderer::setColor( const Rgba& value )
+{
+    m_color = value;
+}
+
 // ------------------------------------------------ Light ------------------------------------------------- //
 
 // ** Light::Light
@@ -171,6 +256,7 @@ Light::Light( LightType type, const Rgb& color, f32 intensity, f32 range )
     , m_range( range )
     , m_cutoff( 45.0f )
     , m_castsShadow( false )
+    , m_shadowUpdateInterval( 1 )
 {
 }
 
@@ -246,6 +332,18 @@ void Light::setCastsShadows( bool value )
     m_castsShadow = value;
 }
 
+// ** Light::shadowUpdateInterval
+s32 Light::shadowUpdateInterval( void ) const
+{
+    return m_shadowUpdateInterval;
+}
+
+// ** Light::setShadowUpdateInterval
+void Light::setShadowUpdateInterval( s32 value )
+{
+    m_shadowUpdateInterval = max2( value, 1 );
+}
+
 // ---------------------------------------------- StaticMesh ---------------------------------------------- //
 
 // ** StaticMesh::mesh
@@ -285,6 +383,18 @@ void StaticMesh::setMaterial( u32 index, MaterialHandle value )
     m_materials[index] = value;
 }
 
+// ** StaticMesh::isOccluder
+bool StaticMesh::isOccluder( void ) const
+{
+    return m_occluder;
+}
+
+// ** StaticMesh::setOccluder
+void StaticMesh::setOccluder( bool value )
+{
+    m_occluder = value;
+}
+
 #if DEV_DEPRECATED_HAL
 // ** StaticMesh::lightmap
 const Renderer::TexturePtr& StaticMesh::lightmap( void ) const
@@ -32,6 +32,7 @@
 #include "../Assets/Mesh.h"
 #include "../Assets/Image.h"
 #include "../Assets/Material.h"
+#include "../Assets/TerrainLod.h"
 
 DC_BEGIN_DREEMCHEST
 
@@ -89,12 +90,40 @@ namespace Scene
         //! Sets a parameter value used by a splitting planes calculation function, should be in [0, 1] range.
         void                            setShadowCascadeLambda( f32 value );
 
+        //! Returns true if point and spot lights are rendered in a single clustered pass.
+        bool                            isClustered( void ) const;
+
+        //! Enables or disables a clustered rendering of point and spot lights.
+        void                            setClustered( bool value );
+
+        //! Returns a maximum number of shadow maps that are re-rendered each frame.
+        s32                             shadowUpdateBudget( void ) const;
+
+        //! Sets a maximum number of shadow maps that are re-rendered each frame, zero means no limit.
+        void                            setShadowUpdateBudget( s32 value );
+
+        //! Returns true if distant shadow cascades are updated in a round-robin order instead of each frame.
+        bool                            isStaggeredCascades( void ) const;
+
+        //! Enables or disables round-robin updates of distant shadow cascades.
+        void                            setStaggeredCascades( bool value );
+
+        //! Returns true if static meshes hidden behind occluders are skipped.
+        bool                            isOcclusionCulling( void ) const;
+
+        //! Enables or disables a software occlusion culling of static meshes.
+        void                            setOcclusionCulling( bool value );
+
     private:
 
         s32                             m_shadowSize;           //!< A shadow texture size.
         s32                             m_shadowCascadeCount;   //!< A total number of cascades a camera frustum is split to.
         f32                             m_shadowCascadeLambda;  //!< An interpolation factor between linear and logarithmic splitting schemes.
         bool                            m_debugCascadeShadows;  //!< Enables a debug rendering of cascaded shadowmaps.
+        bool                            m_clustered;            //!< Point and spot lights are assigned to view space clusters and rendered in a single pass.
+        s32                             m_shadowUpdateBudget;   //!< A maximum number of shadow maps that are re-rendered each frame.
+        bool                            m_staggeredCascades;    //!< Only a nearest cascade is updated each frame, others are updated in a round-robin order.
+        bool                            m_occlusionCulling;     //!< Occluder meshes are rasterized to a CPU depth buffer used to skip hidden meshes.
     };
 
     //! This component is attached to a camera to render a debug info.
@@ -130,6 +159,32 @@ namespace Scene
         Rgba                            m_cameraColor;      //!< A color of all camera frustums.
     };
 
+    //! This component is attached to a camera to render a terrain with a quadtree level of detail.
+    class TerrainRenderer : public Ecs::Component<TerrainRenderer>
+    {
+    public:
+
+                                        //! Constructs a TerrainRenderer instance.
+                                        TerrainRenderer( TerrainLodPtr lod = TerrainLodPtr(), const Rgba& color = Rgba( 1.0f, 1.0f, 1.0f, 1.0f ) );
+
+        //! Returns a terrain level of detail that selects rendered tiles.
+        TerrainLodWPtr                  lod( void ) const;
+
+        //! Sets a terrain level of detail that selects rendered tiles.
+        void                            setLod( TerrainLodPtr value );
+
+        //! Returns a terrain color.
+        const Rgba&                     color( void ) const;
+
+        //! Sets a terrain color.
+        void                            setColor( const Rgba& value );
+
+    private:
+
+        TerrainLodPtr                   m_lod;      //!< A terrain level of detail, tiles are selected once per frame for all cameras that share it.
+        Rgba                            m_color;    //!< A terrain color.
+    };
+
     //! Available light types.
     NIMBLE_DECLARE_ENUM( LightType, Point, Spot, Directional )
 
@@ -184,6 +239,12 @@ namespace Scene
         //! Sets a shadow casting flag.
         void                            setCastsShadows( bool value );
 
+        //! Returns a minimum number of frames between two shadow map updates.
+        s32                             shadowUpdateInterval( void ) const;
+
+        //! Sets a minimum number of frames between two shadow map updates, a value of 1 allows updating shadows each frame.
+        void                            setShadowUpdateInterval( s32 value );
+
     private:
 
         LightType                       m_type;            //!< Light type.
@@ -192,6 +253,7 @@ namespace Scene
         f32                             m_range;        //!< Light influence range.
         f32                             m_cutoff;       //!< Light spot cutoff value.
         bool                            m_castsShadow;  //!< Indicates that a light casts shadows.
+        s32                             m_shadowUpdateInterval; //!< A minimum number of frames between shadow map updates.
     };
 
     //! Holds the static mesh data with per-instance materials.
@@ -206,6 +268,7 @@ namespace Scene
                                         //! Constructs StaticMesh instance.
                                         StaticMesh( const MeshHandle mesh = MeshHandle() )
                                             : m_mesh( mesh )
+                                            , m_occluder( false )
                                             {
                                             }
 
@@ -230,6 +293,12 @@ namespace Scene
         //! Sets the material by index.
         void                            setMaterial( u32 index, MaterialHandle value );
 
+        //! Returns true if this mesh is rasterized to an occlusion buffer.
+        bool                            isOccluder( void ) const;
+
+        //! Marks this mesh as an occluder, occluders should be large and have a low polygon count.
+        void                            setOccluder( bool value );
+
     #if DEV_DEPRECATED_HAL
         //! Returns a lightmap texture.
         const Renderer::TexturePtr&     lightmap( void ) const;
@@ -243,6 +312,7 @@ namespace Scene
         MeshHandle                      m_mesh;                 //!< Mesh to be rendered.
         Bounds                          m_worldSpaceBounds;     //!< Mesh world space bounding box.
         Array<MaterialHandle>           m_materials;            //!< Mesh materials array.
+        bool                            m_occluder;             //!< Indicates that this mesh hides meshes behind it.
     #if DEV_DEPRECATED_HAL
         Renderer::TexturePtr            m_lightmap;             //!< Lightmap texture that is rendered for this mesh.
     #endif  /*  #if DEV_DEPRECATED_HAL  */
@@ -76,6 +76,18 @@ void Transform::setMatrix( const Matrix4& value )
     m_transform = value;
 }
 
+// ** Transform::renderMatrix
+const Matrix4& Transform::renderMatrix( void ) const
+{
+    return m_renderTransform;
+}
+
+// ** Transform::setRenderMatrix
+void Transform::setRenderMatrix( const Matrix4& value )
+{
+    m_renderTransform = value;
+}
+
 // ** Transform::parent
 const TransformWPtr& Transform::parent( void ) const
 {
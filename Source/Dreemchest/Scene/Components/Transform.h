@@ -58,12 +58,18 @@ namespace Scene {
                                 Transform( s32 x, s32 y, s32 z, const TransformWPtr& parent = TransformWPtr() )
                                     : m_parent( parent ), m_position( x, y, z ), m_scale( 1.0f, 1.0f, 1.0f ) {}
 
-        //! Returns an affine transformation matrix.
+        //! Returns an affine transformation matrix calculated from a simulated state.
         const Matrix4&            matrix( void ) const;
 
         //! Sets the affine transform.
         void                    setMatrix( const Matrix4& value );
 
+        //! Returns an affine transformation matrix interpolated between two simulation steps, only rendering should use it.
+        const Matrix4&            renderMatrix( void ) const;
+
+        //! Sets the interpolated affine transform.
+        void                    setRenderMatrix( const Matrix4& value );
+
         //! Returns parent transform.
         const TransformWPtr&    parent( void ) const;
 
@@ -173,6 +179,7 @@ namespace Scene {
         Quat                    m_rotation;        //!< Object rotation.
         Vec3                    m_scale;        //!< Object scale.
         Matrix4                    m_transform;    //!< Affine transform matrix.
+        Matrix4                    m_renderTransform;  //!< Interpolated affine transform matrix.
     };
 
     //! The coordinate system axes.
@@ -166,7 +166,16 @@ Matrix4 CascadedShadowMaps::calculateViewProjection( const BoundingVolume& world
 
     // Transform a world space bounds to a light space
 #if DEV_CSM_BOUNDING_SPHERES
-    Bounds lightSpaceBounds = Bounds::fromSphere( inverseLight * worldSpaceBounds.center(), worldSpaceBounds.radius() );
+    // Quantize a sphere radius, so rounding errors do not change a projection scale when a camera rotates,
+    // and grow it by a single texel to cover a cascade after snapping
+    f32 radius = ceilf( worldSpaceBounds.radius() * 16.0f ) / 16.0f * m_textureSize / (m_textureSize - 2.0f);
+    f32 texel  = radius * 2.0f / m_textureSize;
+
+    // Snap a light space center to a texel grid, so a projection stays exactly the same while a camera moves inside a single texel
+    Vec3 center = inverseLight * worldSpaceBounds.center();
+    center = Vec3( floorf( center.x / texel ) * texel, floorf( center.y / texel ) * texel, floorf( center.z / texel ) * texel );
+
+    Bounds lightSpaceBounds = Bounds::fromSphere( center, radius );
 #else
     Bounds lightSpaceBounds = worldSpaceBounds * inverseLight;
 #endif  /*  #if DEV_CSM_BOUNDING_SPHERES    */
@@ -178,8 +187,10 @@ Matrix4 CascadedShadowMaps::calculateViewProjection( const BoundingVolume& world
     // IMPORTANT: minZ and maxZ are swapped!
     Matrix4 projection = Matrix4::ortho( min.x, max.x, min.y, max.y, max.z + 50.0f, min.z );
 
-    // Fix the sub-texel jittering
+#if !DEV_CSM_BOUNDING_SPHERES
+    // Fix the sub-texel jittering, a snapped bounding sphere already maps a world origin to a texel corner
     projection = fixSubTexel( projection * inverseLight, projection );
+#endif  /*  #if !DEV_CSM_BOUNDING_SPHERES    */
 
     // Return a final view-projection matrix for a cascade
     return projection * inverseLight;
@@ -32,7 +32,7 @@ namespace Scene {
 
 // ** DebugRenderSystem::DebugRenderSystem
 DebugRenderSystem::DebugRenderSystem( RenderingContext& context, RenderScene& renderScene )
-    : RenderSystem( context, renderScene )
+    : RenderSystem( context, renderScene, "DebugRenderSystem" )
     , m_staticMeshes( context, renderScene )
     , m_lights( context, renderScene )
     , m_cameras( context, renderScene )
@@ -25,6 +25,7 @@
  **************************************************************************/
 
 #include "ForwardRenderSystem.h"
+#include "../../Assets/Mesh.h"
 
 DC_BEGIN_DREEMCHEST
 
@@ -32,21 +33,84 @@ namespace Scene {
 
 // ** ForwardRenderSystem::ForwardRenderSystem
 ForwardRenderSystem::ForwardRenderSystem( RenderingContext& context, RenderScene& renderScene )
-    : RenderSystem( context, renderScene )
+    : RenderSystem( context, renderScene, "ForwardRenderSystem" )
     , m_ambient( context, renderScene )
     , m_shadows( context, renderScene )
     , m_debugCascadedShadows( context, renderScene )
     , m_debugRenderTarget( context, renderScene )
+    , m_culling( renderScene )
+    , m_clusters( renderScene )
+    , m_shadowCache( context, renderScene )
 {
     m_phongShader       = m_context.deprecatedRequestShader( "../../Source/Dreemchest/Scene/Rendering/Shaders/Phong.shader" );
+    m_clusteredShader   = m_context.deprecatedRequestShader( "../../Source/Dreemchest/Scene/Rendering/Shaders/Clustered.shader" );
     m_clipPlanesCBuffer = m_context.deprecatedRequestConstantBuffer( NULL, sizeof( RenderScene::CBuffer::ClipPlanes ), RenderScene::CBuffer::ClipPlanes::Layout );
+    m_clustersCBuffer   = m_context.deprecatedRequestConstantBuffer( NULL, sizeof( RenderScene::CBuffer::Clusters ), RenderScene::CBuffer::Clusters::Layout );
+}
+
+#if DC_THREADS_AVAILABLE
+
+// ** ForwardRenderSystem::setTaskManager
+void ForwardRenderSystem::setTaskManager( Threads::TaskManagerWPtr value )
+{
+    m_clusters.setTaskManager( value );
+    m_occlusion.setTaskManager( value );
+}
+
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+// ** ForwardRenderSystem::beginFrame
+void ForwardRenderSystem::beginFrame( RenderFrame& frame, RenderCommandBuffer& commands )
+{
+    // Shadow maps are shared between cameras, so a cache frame is advanced once
+    m_shadowCache.beginFrame();
 }
 
 // ** ForwardRenderSystem::emitRenderOperations
 void ForwardRenderSystem::emitRenderOperations( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const Ecs::Entity& entity, const Camera& camera, const Transform& transform, const ForwardRenderer& forwardRenderer )
 {
+    // Sort opaque draw calls front-to-back and translucent ones back-to-front relative to this camera
+    m_sorting = DrawSorting::fromCamera( camera, transform );
+    m_ambient.setSorting( m_sorting );
+
+    // Reset a number of shadow maps that can be rendered for this camera
+    m_shadowCache.setBudget( forwardRenderer.shadowUpdateBudget() );
+
+    Matrix4 viewProjection = Camera::calculateViewProjection( camera, *entity.get<Viewport>(), transform.renderMatrix() );
+
+    // Rasterize occluders before any mesh is tested for visibility
+    const OcclusionBuffer* occlusion = NULL;
+
+    if( forwardRenderer.isOcclusionCulling() ) {
+        rasterizeOccluders( viewProjection );
+        occlusion = &m_occlusion;
+    }
+
+    // Test all static meshes against a camera frustum and occluders once per frame
+    m_culling.setCamera( viewProjection, occlusion );
+
+    // Passes that are not limited by a light volume render only meshes that were not occluded
+    const RenderScene::NodeIndices* visible = NULL;
+
+    if( occlusion ) {
+        m_visibleMeshes.clear();
+
+        for( s32 i = 0, n = m_renderScene.staticMeshes().count(); i < n; i++ ) {
+            if( m_culling.isMeshVisible( i ) ) {
+                m_visibleMeshes.push_back( i );
+            }
+        }
+
+        visible = &m_visibleMeshes;
+    }
+
     // First perform an ambient render pass
-    m_ambient.render( frame, commands, stateStack );
+    m_ambient.render( frame, commands, stateStack, visible );
+
+    // Point and spot lights are rendered in a single pass in a clustered mode
+    if( forwardRenderer.isClustered() ) {
+        renderClusteredLights( frame, commands, stateStack, camera, transform, *entity.get<Viewport>(), visible );
+    }
 
     // Get all light sources
     const RenderScene::Lights& lights = m_renderScene.lights();
@@ -56,6 +120,16 @@ void ForwardRenderSystem::emitRenderOperations( RenderFrame& frame, RenderComman
         // Get a light by index
         const RenderScene::LightNode& light = lights[i];
 
+        // Skip lights that do not affect anything inside a camera frustum
+        if( !m_culling.isLightVisible( light ) ) {
+            continue;
+        }
+
+        // Only directional lights are rendered separately in a clustered mode
+        if( forwardRenderer.isClustered() && light.light->type() != LightType::Directional ) {
+            continue;
+        }
+
         // Emit render operations according to a light type
         switch( light.light->type() ) {
         case LightType::Spot:           renderSpotLight( frame, commands, stateStack, forwardRenderer, light );
@@ -72,35 +146,44 @@ void ForwardRenderSystem::emitRenderOperations( RenderFrame& frame, RenderComman
 // ** ForwardRenderSystem::renderSpotLight
 void ForwardRenderSystem::renderSpotLight( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const ForwardRenderer& forwardRenderer, const RenderScene::LightNode& light )
 {
-    TransientTexture shadowTexture;
-    ShadowParameters shadowParameters;
+    // Collect meshes inside a light cone, nothing to render if none of them are visible
+    m_culling.cullLight( light, m_visibility );
+
+    if( !hasReceivers() ) {
+        return;
+    }
 
     // Construct a view-projection matrix for this spot light
     Matrix4 viewProjection = Matrix4::perspective( light.light->cutoff() * 2.0f, 1.0f, 0.1f, light.light->range() * 2.0f ) * light.matrix->inversed();
 
+    beginLightGraph( frame, stateStack, light );
+
     // First render a shadowmap for this light instance
     if( light.light->castsShadows() ) {
+        ShadowParameters shadowParameters;
         shadowParameters.transform = viewProjection;
         shadowParameters.invSize   = 1.0f / forwardRenderer.shadowSize();
-        shadowTexture              = m_shadows.render( frame, commands, stateStack, shadowParameters );        
+        renderShadows( frame, commands, stateStack, NULL, light, 0, shadowParameters );
     }
 
     // Render a light pass
     RenderScene::CBuffer::ClipPlanes clip = RenderScene::CBuffer::ClipPlanes::fromViewProjection( viewProjection );
-    renderLight( frame, commands, stateStack, light, &clip, shadowTexture );
-
-    // Release an intermediate shadow render target
-    if( shadowTexture ) {
-        commands.releaseTexture(shadowTexture);
-    }
+    executeLightGraph( commands, &clip );
 }
 
 // ** ForwardRenderSystem::renderPointLight
 void ForwardRenderSystem::renderPointLight( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const ForwardRenderer& forwardRenderer, const RenderScene::LightNode& light )
 {
+    // Collect meshes inside a light sphere, nothing to render if none of them are visible
+    m_culling.cullLight( light, m_visibility );
+
+    if( !hasReceivers() ) {
+        return;
+    }
+
     // Render a light pass
     RenderScene::CBuffer::ClipPlanes clip = RenderScene::CBuffer::ClipPlanes::fromSphere( *light.matrix * Vec3::zero(), light.light->range() );
-    renderLight( frame, commands, stateStack, light, &clip );
+    renderLight( frame, commands, stateStack, light, &clip, m_visibility.receivers );
 }
 
 // ** ForwardRenderSystem::renderDirectionalLight
@@ -108,7 +191,8 @@ void ForwardRenderSystem::renderDirectionalLight( RenderFrame& frame, RenderComm
 {
     // Light does not cast any shadows, so just render it
     if( !light.light->castsShadows() ) {
-        renderLight( frame, commands, stateStack, light, NULL );
+        m_culling.cullDirectional( m_visibility );
+        renderLight( frame, commands, stateStack, light, NULL, m_visibility.receivers );
         return;
     }
 
@@ -118,41 +202,199 @@ void ForwardRenderSystem::renderDirectionalLight( RenderFrame& frame, RenderComm
     f32 lambda       = forwardRenderer.shadowCascadeLambda();
 
     // Construct a cascaded shadow maps instance
-    CascadedShadowMaps csm( cameraTransform.matrix(), *light.matrix, shadowSize );
+    CascadedShadowMaps csm( cameraTransform.renderMatrix(), *light.matrix, shadowSize );
     csm.calculate( camera.fov(), camera.near(), camera.far(), viewport.aspect(), lambda, cascadeCount );
 
     // Render each cascade
     for( s32 j = 0; j < cascadeCount; j++ ) {
         const CascadedShadowMaps::Cascade& cascade = csm.cascadeAt( j );
 
+        // Collect shadow casters and visible receivers inside a cascade volume
+        m_culling.cullCascade( cascade.transform, m_visibility );
+
+        if( !hasReceivers() ) {
+            continue;
+        }
+
         ShadowParameters parameters;
         parameters.invSize   = 1.0f / shadowSize;
         parameters.transform = cascade.transform;
 
-        TransientTexture shadows = m_shadows.render( frame, commands, stateStack, parameters );
+        // A nearest cascade is updated each frame, distant ones may be updated in a round-robin order
+        bool scheduled = !forwardRenderer.isStaggeredCascades() || m_shadowCache.isCascadeScheduled( j, cascadeCount );
+
+        beginLightGraph( frame, stateStack, light );
+        renderShadows( frame, commands, stateStack, &camera, light, j, parameters, scheduled );
 
+        // Render a light pass together with a debug shadow texture
         RenderScene::CBuffer::ClipPlanes clip = RenderScene::CBuffer::ClipPlanes::fromNearAndFar( cameraTransform.axisZ(), cameraTransform.worldSpacePosition(), cascade.near, cascade.far );
+        executeLightGraph( commands, &clip, forwardRenderer.isDebugCascadeShadows() ? &viewport : NULL, j * 130 );
+    }
+
+    // Render a debug info for a shadow cascades
+    if( forwardRenderer.isDebugCascadeShadows() ) {
+        m_debugCascadedShadows.render( frame, commands, stateStack, csm );
+    }
+}
+
+// ** ForwardRenderSystem::renderClusteredLights
+void ForwardRenderSystem::renderClusteredLights( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const Camera& camera, const Transform& transform, const Viewport& viewport, const RenderScene::NodeIndices* visible )
+{
+    // Assign lights to clusters, nothing to render if none of them are visible
+    m_clusters.update( camera, transform, viewport );
+
+    if( m_clusters.lightCount() == 0 ) {
+        return;
+    }
+
+    // Upload packed light lists
+    const RenderScene::CBuffer::Clusters& clusters = m_clusters.parameters();
+    commands.uploadConstantBuffer( m_clustersCBuffer, frame.internBuffer( &clusters, sizeof( RenderScene::CBuffer::Clusters ) ), sizeof( RenderScene::CBuffer::Clusters ) );
 
-        renderLight( frame, commands, stateStack, light, &clip, shadows );
+    // Clustered light state block, lights are accumulated on top of an ambient pass
+    StateScope state = stateStack.newScope();
+    state->bindConstantBuffer( m_clustersCBuffer, Constants::Clusters );
+    state->bindProgram( m_clusteredShader );
+    state->setBlend( Renderer::BlendOne, Renderer::BlendOne );
+    state->setDepthState( Renderer::LessEqual, false );
+    state->setPolygonOffset( -1, -1 );
+
+    // Emit render operations
+    commands.beginProfileScope( "ClusteredLightPass" );
+    RenderPassBase::emitStaticMeshes( m_renderScene.staticMeshes(), frame, commands, stateStack, RenderMaskPhong, &m_sorting, visible );
+    RenderPassBase::emitPointClouds( m_renderScene.pointClouds(), frame, commands, stateStack, RenderMaskPhong, &m_sorting );
+    commands.endProfileScope();
+}
+
+// ** ForwardRenderSystem::rasterizeOccluders
+void ForwardRenderSystem::rasterizeOccluders( const Matrix4& viewProjection )
+{
+    const RenderScene::StaticMeshes& staticMeshes = m_renderScene.staticMeshes();
+
+    m_occlusion.clear();
+
+    for( s32 i = 0, n = staticMeshes.count(); i < n; i++ ) {
+        const RenderScene::StaticMeshNode& node = staticMeshes[i];
+
+        // Only meshes that were explicitly marked as occluders are rasterized
+        if( !node.mesh->isOccluder() || !node.mesh->mesh().isLoaded() ) {
+            continue;
+        }
+
+        const Mesh&                 mesh     = node.mesh->mesh().readLock();
+        const Mesh::VertexBuffer&   vertices = mesh.vertexBuffer();
+        const Mesh::IndexBuffer&    indices  = mesh.indexBuffer();
 
-        // Render a debug shadow texture
-        if( forwardRenderer.isDebugCascadeShadows() )
-        {
-            m_debugRenderTarget.render( frame, commands, stateStack, viewport, shadows, 128, j * 130, 0 );
+        if( indices.empty() ) {
+            continue;
         }
 
-        // Release an intermediate shadow render target
-        commands.releaseTexture(shadows);
+        m_occlusion.addOccluder( viewProjection * *node.matrix, &vertices[0].position, sizeof( Mesh::Vertex ), &indices[0], static_cast<s32>( indices.size() ) );
     }
 
-    // Render a debug info for a shadow cascades
-    if( forwardRenderer.isDebugCascadeShadows() ) {
-        m_debugCascadedShadows.render( frame, commands, stateStack, csm );
+    m_occlusion.rasterize();
+}
+
+// ** ForwardRenderSystem::renderShadows
+void ForwardRenderSystem::renderShadows( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const Camera* camera, const RenderScene::LightNode& light, s32 cascade, ShadowParameters& parameters, bool scheduled )
+{
+    s32                 size  = static_cast<s32>( 1.0f / parameters.invSize );
+    ShadowCache::Entry  entry = m_shadowCache.request( camera, light.light, cascade, size, parameters.transform, m_visibility.casters, scheduled );
+
+    // No cache slots left, so declare a transient shadow map that is rendered before a light pass
+    if( !entry.texture ) {
+        m_lightGraph.shadowParameters = parameters;
+        m_lightGraph.shadows          = m_graph.createTexture2D( size, size, TextureD24 );
+
+        s32 pass = m_graph.addPass( "ShadowPass", dcThisMethod( ForwardRenderSystem::emitShadowGraphPass ) );
+        m_graph.write( pass, m_lightGraph.shadows );
+        return;
+    }
+
+    // A cached shadow map may be reused for other receivers, so it is hashed and rendered with all casters inside a light volume.
+    // A cached shadow map is sampled with a transform it was rendered with.
+    parameters.transform        = entry.transform;
+    m_lightGraph.cachedShadows  = entry.texture;
+
+    if( entry.update ) {
+        m_shadows.render( frame, commands, stateStack, parameters, entry.texture, &m_visibility.casters );
+    } else {
+        m_shadows.upload( frame, commands, parameters );
+    }
+}
+
+// ** ForwardRenderSystem::beginLightGraph
+void ForwardRenderSystem::beginLightGraph( RenderFrame& frame, StateStack& stateStack, const RenderScene::LightNode& light )
+{
+    m_graph.clear();
+
+    m_lightGraph.frame          = &frame;
+    m_lightGraph.stateStack     = &stateStack;
+    m_lightGraph.light          = &light;
+    m_lightGraph.clip           = NULL;
+    m_lightGraph.shadows        = -1;
+    m_lightGraph.cachedShadows  = Texture_();
+    m_lightGraph.debugViewport  = NULL;
+    m_lightGraph.debugOffset    = 0;
+}
+
+// ** ForwardRenderSystem::executeLightGraph
+void ForwardRenderSystem::executeLightGraph( RenderCommandBuffer& commands, const RenderScene::CBuffer::ClipPlanes* clip, const Viewport* debugViewport, s32 debugOffset )
+{
+    m_lightGraph.clip = clip;
+
+    // A light pass renders to a viewport, so it is never culled
+    s32 lightPass = m_graph.addPass( "LightPass", dcThisMethod( ForwardRenderSystem::emitLightGraphPass ) );
+    m_graph.setSideEffects( lightPass );
+
+    if( m_lightGraph.shadows >= 0 ) {
+        m_graph.read( lightPass, m_lightGraph.shadows );
+
+        // Render a transient shadow map on top of a viewport
+        if( debugViewport ) {
+            m_lightGraph.debugViewport = debugViewport;
+            m_lightGraph.debugOffset   = debugOffset;
+
+            s32 debugPass = m_graph.addPass( "DebugShadowPass", dcThisMethod( ForwardRenderSystem::emitDebugShadowGraphPass ) );
+            m_graph.read( debugPass, m_lightGraph.shadows );
+            m_graph.setSideEffects( debugPass );
+        }
     }
+
+    // Transient textures are acquired before a first pass that uses them and released after the last one
+    m_graph.compile();
+    m_graph.execute( commands );
+}
+
+// ** ForwardRenderSystem::emitShadowGraphPass
+void ForwardRenderSystem::emitShadowGraphPass( RenderCommandBuffer& commands, const RenderGraph& graph )
+{
+    // A transient shadow map is never reused, so only casters that shadow visible receivers are rendered
+    m_shadows.emitCasters( *m_lightGraph.frame, commands, *m_lightGraph.stateStack, m_lightGraph.shadowParameters, &m_visibility.visibleCasters );
+}
+
+// ** ForwardRenderSystem::emitLightGraphPass
+void ForwardRenderSystem::emitLightGraphPass( RenderCommandBuffer& commands, const RenderGraph& graph )
+{
+    TransientTexture shadows = m_lightGraph.shadows >= 0 ? graph.texture( m_lightGraph.shadows ) : TransientTexture();
+    renderLight( *m_lightGraph.frame, commands, *m_lightGraph.stateStack, *m_lightGraph.light, m_lightGraph.clip, m_visibility.receivers, shadows, m_lightGraph.cachedShadows );
+}
+
+// ** ForwardRenderSystem::emitDebugShadowGraphPass
+void ForwardRenderSystem::emitDebugShadowGraphPass( RenderCommandBuffer& commands, const RenderGraph& graph )
+{
+    m_debugRenderTarget.render( *m_lightGraph.frame, commands, *m_lightGraph.stateStack, *m_lightGraph.debugViewport, graph.texture( m_lightGraph.shadows ), 128, m_lightGraph.debugOffset, 0 );
+}
+
+// ** ForwardRenderSystem::hasReceivers
+bool ForwardRenderSystem::hasReceivers( void ) const
+{
+    // Point clouds are not culled, so a light pass should be rendered if there are any
+    return !m_visibility.receivers.empty() || m_renderScene.pointClouds().count() > 0;
 }
 
 // ** ForwardRenderSystem::renderLight
-void ForwardRenderSystem::renderLight( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const RenderScene::LightNode& light, const RenderScene::CBuffer::ClipPlanes* clip, TransientTexture shadows )
+void ForwardRenderSystem::renderLight( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const RenderScene::LightNode& light, const RenderScene::CBuffer::ClipPlanes* clip, const RenderScene::NodeIndices& receivers, TransientTexture shadows, Texture_ cachedShadows )
 {
     // A light type feature bits
     PipelineFeatures lightType[] = { ShaderPointLight, ShaderSpotLight, ShaderDirectionalLight };
@@ -180,10 +422,17 @@ void ForwardRenderSystem::renderLight( RenderFrame& frame, RenderCommandBuffer&
         state->bindTexture(shadows, TextureSampler::Shadow);
         state->bindConstantBuffer( m_shadows.cbuffer(), Constants::Shadow );
     }
+    else if( cachedShadows )
+    {
+        state->bindTexture(cachedShadows, TextureSampler::Shadow);
+        state->bindConstantBuffer( m_shadows.cbuffer(), Constants::Shadow );
+    }
 
     // Emit render operations
-    RenderPassBase::emitStaticMeshes( m_renderScene.staticMeshes(), frame, commands, stateStack, RenderMaskPhong );
-    RenderPassBase::emitPointClouds( m_renderScene.pointClouds(), frame, commands, stateStack, RenderMaskPhong );
+    commands.beginProfileScope( "LightPass" );
+    RenderPassBase::emitStaticMeshes( m_renderScene.staticMeshes(), frame, commands, stateStack, RenderMaskPhong, &m_sorting, &receivers );
+    RenderPassBase::emitPointClouds( m_renderScene.pointClouds(), frame, commands, stateStack, RenderMaskPhong, &m_sorting );
+    commands.endProfileScope();
 }
 
 } // namespace Scene
@@ -32,6 +32,10 @@
 #include "../Passes/DebugRenderPasses.h"
 #include "../Passes/GenericRenderPasses.h"
 #include "CascadedShadowMaps.h"
+#include "LightCulling.h"
+#include "LightClusters.h"
+#include "OcclusionBuffer.h"
+#include "ShadowCache.h"
 
 DC_BEGIN_DREEMCHEST
 
@@ -43,15 +47,50 @@ namespace Scene {
 
                                         ForwardRenderSystem( RenderingContext& context, RenderScene& renderScene );
 
+    #if DC_THREADS_AVAILABLE
+        //! Sets a task manager used to assign lights to clusters and rasterize occluders in background.
+        void                            setTaskManager( Threads::TaskManagerWPtr value );
+    #endif  /*  DC_THREADS_AVAILABLE    */
+
     protected:
 
         //! Alias the shadow constant buffer type.
         typedef RenderScene::CBuffer::Shadow ShadowParameters;
 
+        //! Starts a new shadow cache frame.
+        virtual void                    beginFrame( RenderFrame& frame, RenderCommandBuffer& commands ) NIMBLE_OVERRIDE;
+
         virtual void                    emitRenderOperations( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const Ecs::Entity& entity, const Camera& camera, const Transform& transform, const ForwardRenderer& forwardRenderer ) NIMBLE_OVERRIDE;
 
-        //! Generate commands to render a light pass for a single light source.
-        void                            renderLight( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const RenderScene::LightNode& light, const RenderScene::CBuffer::ClipPlanes* clip, TransientTexture shadows = TransientTexture() );
+        //! Generate commands to render a light pass for a single light source, only meshes from a receivers list are rendered.
+        void                            renderLight( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const RenderScene::LightNode& light, const RenderScene::CBuffer::ClipPlanes* clip, const RenderScene::NodeIndices& receivers, TransientTexture shadows = TransientTexture(), Texture_ cachedShadows = Texture_() );
+
+        //! Renders a shadow map of a light cascade or reuses a cached one, a camera is passed only for shadow maps fitted to a camera frustum.
+        void                            renderShadows( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const Camera* camera, const RenderScene::LightNode& light, s32 cascade, ShadowParameters& parameters, bool scheduled = true );
+
+        //! Starts recording a render graph of a single light.
+        void                            beginLightGraph( RenderFrame& frame, StateStack& stateStack, const RenderScene::LightNode& light );
+
+        //! Adds a light pass and an optional debug shadow pass to a light render graph, then compiles and executes it.
+        void                            executeLightGraph( RenderCommandBuffer& commands, const RenderScene::CBuffer::ClipPlanes* clip, const Viewport* debugViewport = NULL, s32 debugOffset = 0 );
+
+        //! A render graph pass that renders shadow casters to a transient shadow map.
+        void                            emitShadowGraphPass( RenderCommandBuffer& commands, const RenderGraph& graph );
+
+        //! A render graph pass that renders light receivers.
+        void                            emitLightGraphPass( RenderCommandBuffer& commands, const RenderGraph& graph );
+
+        //! A render graph pass that renders a transient shadow map to a viewport.
+        void                            emitDebugShadowGraphPass( RenderCommandBuffer& commands, const RenderGraph& graph );
+
+        //! Generate commands to render all point and spot lights in a single clustered pass, only static meshes from a visible list are rendered when one is passed.
+        void                            renderClusteredLights( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const Camera& camera, const Transform& transform, const Viewport& viewport, const RenderScene::NodeIndices* visible = NULL );
+
+        //! Rasterizes all loaded occluder meshes to an occlusion buffer.
+        void                            rasterizeOccluders( const Matrix4& viewProjection );
+
+        //! Returns true if a culled light affects any visible renderable.
+        bool                            hasReceivers( void ) const;
 
         //! Emits operations to render a spot light pass.
         void                            renderSpotLight( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const ForwardRenderer& forwardRenderer, const RenderScene::LightNode& light );
@@ -64,12 +103,36 @@ namespace Scene {
 
     private:
 
+        //! A light that is rendered through a render graph, pass callbacks read it when a graph is executed.
+        struct LightGraph {
+            RenderFrame*                            frame;              //!< A frame that is being recorded.
+            StateStack*                             stateStack;         //!< An active state stack.
+            const RenderScene::LightNode*           light;              //!< A light being rendered.
+            const RenderScene::CBuffer::ClipPlanes* clip;               //!< Light pass clipping planes or NULL.
+            ShadowParameters                        shadowParameters;   //!< Parameters of a transient shadow map.
+            RenderGraph::Resource                   shadows;            //!< A transient shadow map or -1.
+            Texture_                                cachedShadows;      //!< A cached shadow map used instead of a transient one.
+            const Viewport*                         debugViewport;      //!< A viewport to render a debug shadow map to or NULL.
+            s32                                     debugOffset;        //!< A horizontal offset of a debug shadow map.
+        };
+
         Program                         m_phongShader;
+        Program                         m_clusteredShader;      //!< Accumulates all lights of a fragment cluster.
         ConstantBuffer_                 m_clipPlanesCBuffer;
+        ConstantBuffer_                 m_clustersCBuffer;      //!< Packed per-cluster light lists.
         AmbientPass                     m_ambient;
         ShadowPass                      m_shadows;
         DebugCascadedShadows            m_debugCascadedShadows;
         DebugRenderTarget               m_debugRenderTarget;
+        DrawSorting                     m_sorting;              //!< Draw call sorting relative to an active camera.
+        LightCulling                    m_culling;              //!< Builds per-light visibility lists.
+        LightCulling::Visibility        m_visibility;           //!< Meshes affected by a light that is being rendered.
+        LightClusters                   m_clusters;             //!< Assigns lights to view space clusters.
+        ShadowCache                     m_shadowCache;          //!< Persistent shadow maps of static lights.
+        OcclusionBuffer                 m_occlusion;            //!< A CPU depth buffer with rasterized occluders.
+        RenderScene::NodeIndices        m_visibleMeshes;        //!< Static meshes that passed both frustum and occlusion tests.
+        RenderGraph                     m_graph;                //!< Declares passes of a light together with transient textures they use.
+        LightGraph                      m_lightGraph;           //!< A light that is being recorded to a render graph.
     };
 
 } // namespace Scene
@@ -0,0 +1,335 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "LightClusters.h"
+
+#if DC_THREADS_AVAILABLE
+    #include "../../../Threads/Task/TaskManager.h"
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+// ** LightClusters::LightClusters
+LightClusters::LightClusters( const RenderScene& renderScene )
+    : m_renderScene( renderScene )
+    , m_parameters( DC_NEW Parameters )
+    , m_near( 0.1f )
+    , m_far( 1.0f )
+    , m_sliceScale( 0.0f )
+    , m_sliceBias( 0.0f )
+{
+    memset( m_parameters.get(), 0, sizeof( Parameters ) );
+    memset( m_counts, 0, sizeof( m_counts ) );
+}
+
+#if DC_THREADS_AVAILABLE
+
+// ** LightClusters::setTaskManager
+void LightClusters::setTaskManager( Threads::TaskManagerWPtr value )
+{
+    m_taskManager = value;
+}
+
+// ** LightClusters::assignTask
+void LightClusters::assignTask( Threads::TaskProgressWPtr progress, void* userData )
+{
+    const Job* job = reinterpret_cast<const Job*>( userData );
+    assignSlices( job->first, job->last );
+}
+
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+// ** LightClusters::parameters
+const LightClusters::Parameters& LightClusters::parameters( void ) const
+{
+    return *m_parameters.get();
+}
+
+// ** LightClusters::lightCount
+s32 LightClusters::lightCount( void ) const
+{
+    return static_cast<s32>( m_volumes.size() );
+}
+
+// ** LightClusters::update
+void LightClusters::update( const Camera& camera, const Transform& transform, const Viewport& viewport )
+{
+    // Slices are distributed logarithmically between near and far clipping planes
+    m_near       = max2( camera.near(), 0.01f );
+    m_far        = max2( camera.far(), m_near + 0.01f );
+    m_sliceScale = Slices / logf( m_far / m_near );
+    m_sliceBias  = logf( m_near ) * m_sliceScale;
+
+    // A camera looks along a negative Z axis
+    Vec3 eye     = transform.worldSpacePosition();
+    Vec3 forward = -transform.axisZ();
+
+    // Calculate tile planes and collect lights inside a camera frustum
+    calculateTilePlanes( Camera::calculateViewProjection( camera, viewport, transform.renderMatrix() ).inversed() );
+    collectLights( eye, forward );
+
+    // Assign lights to clusters, each task processes its own range of depth slices
+#if DC_THREADS_AVAILABLE
+    Threads::TaskManagerWPtr taskManager = m_taskManager;
+
+    if( taskManager.valid() && !m_volumes.empty() ) {
+        Threads::TaskProgressPtr tasks[MaxJobs];
+
+        for( s32 i = 0; i < MaxJobs; i++ ) {
+            m_jobs[i].first = Slices *  i      / MaxJobs;
+            m_jobs[i].last  = Slices * (i + 1) / MaxJobs;
+            tasks[i] = taskManager->runBackgroundTask( dcThisMethod( LightClusters::assignTask ), &m_jobs[i] );
+        }
+
+        for( s32 i = 0; i < MaxJobs; i++ ) {
+            tasks[i]->waitForCompletion();
+        }
+    } else
+#endif  /*  DC_THREADS_AVAILABLE    */
+    {
+        assignSlices( 0, Slices );
+    }
+
+    // Now pack light lists to a constant buffer
+    packClusters();
+
+    // Save parameters used by a fragment shader to locate a cluster
+    Rect        rect   = viewport.denormalize( camera.ndc() );
+    Parameters& output = *m_parameters.get();
+
+    output.grid    = Vec4( static_cast<f32>( TilesX ), static_cast<f32>( TilesY ), static_cast<f32>( Slices ), static_cast<f32>( m_volumes.size() ) );
+    output.screen  = Vec4( rect.min().x, rect.min().y, rect.width(), rect.height() );
+    output.depth   = Vec4( m_near, m_far, m_sliceScale, m_sliceBias );
+    output.eye     = Vec4( eye.x, eye.y, eye.z, 1.0f );
+    output.forward = Vec4( forward.x, forward.y, forward.z, 0.0f );
+}
+
+// ** LightClusters::calculateTilePlanes
+void LightClusters::calculateTilePlanes( const Matrix4& inverseViewProjection )
+{
+    // Vertical planes pass through near and far points of each horizontal tile boundary
+    for( s32 i = 0; i <= TilesX; i++ ) {
+        f32 x = -1.0f + 2.0f * i / TilesX;
+        m_planesX[i] = tilePlane( unproject( inverseViewProjection, x, -1.0f, -1.0f )
+                                , unproject( inverseViewProjection, x,  1.0f, -1.0f )
+                                , unproject( inverseViewProjection, x, -1.0f,  1.0f )
+                                , unproject( inverseViewProjection, x + 1.0f, 0.0f, 0.0f ) );
+    }
+
+    // Horizontal planes are constructed in the same way
+    for( s32 i = 0; i <= TilesY; i++ ) {
+        f32 y = -1.0f + 2.0f * i / TilesY;
+        m_planesY[i] = tilePlane( unproject( inverseViewProjection, -1.0f, y, -1.0f )
+                                , unproject( inverseViewProjection,  1.0f, y, -1.0f )
+                                , unproject( inverseViewProjection, -1.0f, y,  1.0f )
+                                , unproject( inverseViewProjection, 0.0f, y + 1.0f, 0.0f ) );
+    }
+}
+
+// ** LightClusters::collectLights
+void LightClusters::collectLights( const Vec3& eye, const Vec3& forward )
+{
+    const RenderScene::Lights& lights = m_renderScene.lights();
+    Parameters&                output = *m_parameters.get();
+
+    m_volumes.clear();
+
+    for( s32 i = 0, n = lights.count(); i < n && static_cast<s32>( m_volumes.size() ) < Parameters::MaxLights; i++ ) {
+        const RenderScene::LightNode& light = lights[i];
+
+        // Directional lights affect all clusters
+        if( light.light->type() == LightType::Directional ) {
+            continue;
+        }
+
+        Vec3 position = *light.matrix * Vec3::zero();
+        f32  range    = light.light->range();
+
+        // Calculate a light bounding sphere, spot lights shine along a negative Z axis
+        LightVolume volume;
+        volume.center = position;
+        volume.radius = range;
+
+        if( light.light->type() == LightType::Spot ) {
+            f32 radius    = range * tanf( radians( light.light->cutoff() ) );
+            volume.center = position - light.transform->axisZ() * range * 0.5f;
+            volume.radius = min2( range, sqrtf( range * range * 0.25f + radius * radius ) );
+        }
+
+        // Skip lights that are outside of a depth range
+        f32 depth = dot( volume.center - eye, forward );
+
+        if( depth + volume.radius < m_near || depth - volume.radius > m_far ) {
+            continue;
+        }
+
+        // Skip lights that are outside of a camera frustum
+        if( !overlappedTiles( m_planesX, TilesX, volume.center, volume.radius, volume.firstTile[0], volume.lastTile[0] ) ) {
+            continue;
+        }
+        if( !overlappedTiles( m_planesY, TilesY, volume.center, volume.radius, volume.firstTile[1], volume.lastTile[1] ) ) {
+            continue;
+        }
+
+        volume.firstSlice = sliceFromDepth( depth - volume.radius );
+        volume.lastSlice  = sliceFromDepth( depth + volume.radius );
+
+        // Write light parameters, spot lights store a cutoff cosine and point lights are marked with a negative value
+        s32  index     = static_cast<s32>( m_volumes.size() );
+        Rgb  color     = light.light->color();
+        Vec3 direction = light.transform->axisZ();
+
+        output.positions[index]  = Vec4( position.x, position.y, position.z, range );
+        output.colors[index]     = Vec4( color.r, color.g, color.b, light.light->intensity() );
+        output.directions[index] = light.light->type() == LightType::Spot ? Vec4( direction.x, direction.y, direction.z, cosf( radians( light.light->cutoff() ) ) ) : Vec4( 0.0f, 0.0f, 0.0f, -2.0f );
+
+        m_volumes.push_back( volume );
+    }
+}
+
+// ** LightClusters::assignSlices
+void LightClusters::assignSlices( s32 first, s32 last )
+{
+    const s32 clustersPerSlice = TilesX * TilesY;
+
+    // Reset light counters of all clusters in this slice range
+    memset( m_counts + first * clustersPerSlice, 0, (last - first) * clustersPerSlice );
+
+    for( s32 i = 0, n = static_cast<s32>( m_volumes.size() ); i < n; i++ ) {
+        const LightVolume& volume = m_volumes[i];
+
+        // Clamp a light slice range to slices processed by this job
+        s32 firstSlice = max2( volume.firstSlice, first );
+        s32 lastSlice  = min2( volume.lastSlice, last - 1 );
+
+        for( s32 z = firstSlice; z <= lastSlice; z++ ) {
+            for( s32 y = volume.firstTile[1]; y <= volume.lastTile[1]; y++ ) {
+                for( s32 x = volume.firstTile[0]; x <= volume.lastTile[0]; x++ ) {
+                    s32 cluster = (z * TilesY + y) * TilesX + x;
+
+                    if( m_counts[cluster] < MaxLightsPerCluster ) {
+                        m_lights[cluster][m_counts[cluster]++] = static_cast<u8>( i );
+                    }
+                }
+            }
+        }
+    }
+}
+
+// ** LightClusters::packClusters
+void LightClusters::packClusters( void )
+{
+    // Both arrays are tightly packed vectors, so access them as plain float arrays
+    f32* ranges  = &m_parameters->ranges[0].x;
+    f32* indices = &m_parameters->indices[0].x;
+    s32  offset  = 0;
+
+    for( s32 i = 0; i < TotalClusters; i++ ) {
+        // Lights that do not fit into an index list are dropped
+        s32 count = min2( static_cast<s32>( m_counts[i] ), Parameters::MaxIndices - offset );
+
+        ranges[i * 2 + 0] = static_cast<f32>( offset );
+        ranges[i * 2 + 1] = static_cast<f32>( count );
+
+        for( s32 j = 0; j < count; j++ ) {
+            indices[offset++] = static_cast<f32>( m_lights[i][j] );
+        }
+    }
+}
+
+// ** LightClusters::sliceFromDepth
+s32 LightClusters::sliceFromDepth( f32 depth ) const
+{
+    s32 slice = static_cast<s32>( floorf( logf( max2( depth, m_near ) ) * m_sliceScale - m_sliceBias ) );
+    return max2( 0, min2( slice, static_cast<s32>( Slices ) - 1 ) );
+}
+
+// ** LightClusters::overlappedTiles
+bool LightClusters::overlappedTiles( const TilePlane* planes, s32 count, const Vec3& center, f32 radius, s32& first, s32& last )
+{
+    // A sphere is completely outside of the first or the last tile boundary
+    if( distanceToPlane( planes[0], center ) < -radius || distanceToPlane( planes[count], center ) > radius ) {
+        return false;
+    }
+
+    first = 0;
+    last  = count - 1;
+
+    // Skip tiles that are completely on a negative side of a sphere
+    while( first < last && distanceToPlane( planes[first + 1], center ) > radius ) {
+        first++;
+    }
+
+    // Skip tiles that are completely on a positive side of a sphere
+    while( last > first && distanceToPlane( planes[last], center ) < -radius ) {
+        last--;
+    }
+
+    return true;
+}
+
+// ** LightClusters::distanceToPlane
+f32 LightClusters::distanceToPlane( const TilePlane& plane, const Vec3& point )
+{
+    return dot( plane.normal, point ) + plane.distance;
+}
+
+// ** LightClusters::unproject
+Vec3 LightClusters::unproject( const Matrix4& inverseViewProjection, f32 x, f32 y, f32 z )
+{
+    Vec4 point = inverseViewProjection * Vec4( x, y, z, 1.0f );
+    return Vec3( point.x / point.w, point.y / point.w, point.z / point.w );
+}
+
+// ** LightClusters::tilePlane
+LightClusters::TilePlane LightClusters::tilePlane( const Vec3& a, const Vec3& b, const Vec3& c, const Vec3& reference )
+{
+    Vec3 normal = (b - a) % (c - a);
+    normal.normalize();
+
+    // Orient a plane towards a reference point
+    if( dot( normal, reference - a ) < 0.0f ) {
+        normal = -normal;
+    }
+
+    TilePlane plane;
+    plane.normal   = normal;
+    plane.distance = -dot( normal, a );
+
+    return plane;
+}
+
+// ** LightClusters::dot
+f32 LightClusters::dot( const Vec3& a, const Vec3& b )
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
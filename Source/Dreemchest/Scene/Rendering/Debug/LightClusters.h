@@ -0,0 +1,160 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Scene_Rendering_LightClusters_H__
+#define __DC_Scene_Rendering_LightClusters_H__
+
+#include "../RenderScene.h"
+#include "../../../Threads/Threads.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+    //! Assigns point and spot lights to view space clusters used by a clustered forward light pass.
+    /*!
+    A camera frustum is split to a grid of screen tiles and logarithmic depth slices. Each light
+    bounding sphere is tested against tile planes and slice depth ranges and a light index is
+    appended to each cluster it overlaps. Depth slices are distributed between background tasks,
+    so each task writes to its own set of clusters. Resulting lists are packed into a single constant
+    buffer, so a fragment shader can iterate only over lights that affect a cluster it belongs to.
+    Directional lights affect every cluster, so they are not assigned and should be rendered separately.
+    */
+    class LightClusters {
+    public:
+
+        //! Alias the clusters constant buffer type.
+        typedef RenderScene::CBuffer::Clusters Parameters;
+
+        enum {
+              TilesX                = Parameters::TilesX                    //!< A total number of horizontal screen tiles.
+            , TilesY                = Parameters::TilesY                    //!< A total number of vertical screen tiles.
+            , Slices                = Parameters::Slices                    //!< A total number of depth slices.
+            , TotalClusters         = TilesX * TilesY * Slices              //!< A total number of clusters.
+            , MaxLightsPerCluster   = 32                                    //!< A maximum number of lights that are assigned to a single cluster.
+            , MaxJobs               = 4                                     //!< A maximum number of tasks used to assign lights.
+        };
+
+                                        //! Constructs a LightClusters instance.
+                                        LightClusters( const RenderScene& renderScene );
+
+    #if DC_THREADS_AVAILABLE
+        //! Sets a task manager used to assign lights in background, lights are assigned synchronously without it.
+        void                            setTaskManager( Threads::TaskManagerWPtr value );
+    #endif  /*  DC_THREADS_AVAILABLE    */
+
+        //! Assigns lights to clusters of a camera frustum and packs the result into constant buffer parameters.
+        void                            update( const Camera& camera, const Transform& transform, const Viewport& viewport );
+
+        //! Returns packed cluster parameters that should be uploaded to a constant buffer.
+        const Parameters&               parameters( void ) const;
+
+        //! Returns a total number of lights that were assigned to at least one cluster.
+        s32                             lightCount( void ) const;
+
+    private:
+
+        //! A plane that passes through a camera position and a screen tile boundary.
+        struct TilePlane {
+            Vec3                        normal;                 //!< Plane normal oriented towards positive NDC coordinates.
+            f32                         distance;               //!< Plane distance.
+        };
+
+        //! A bounding volume of a single light source.
+        struct LightVolume {
+            Vec3                        center;                 //!< Bounding sphere center.
+            f32                         radius;                 //!< Bounding sphere radius.
+            s32                         firstSlice;             //!< A first depth slice touched by a light.
+            s32                         lastSlice;              //!< A last depth slice touched by a light.
+            s32                         firstTile[2];           //!< First horizontal and vertical tiles touched by a light.
+            s32                         lastTile[2];            //!< Last horizontal and vertical tiles touched by a light.
+        };
+
+        //! A range of depth slices processed by a single task.
+        struct Job {
+            s32                         first;                  //!< A first depth slice.
+            s32                         last;                   //!< A slice after the last one.
+        };
+
+        //! Calculates tile planes from an inverse view-projection matrix.
+        void                            calculateTilePlanes( const Matrix4& inverseViewProjection );
+
+        //! Collects bounding volumes of all point and spot lights that are inside a camera frustum.
+        void                            collectLights( const Vec3& eye, const Vec3& forward );
+
+        //! Appends light indices to all clusters inside a range of depth slices.
+        void                            assignSlices( s32 first, s32 last );
+
+        //! Packs per-cluster light lists to constant buffer parameters.
+        void                            packClusters( void );
+
+    #if DC_THREADS_AVAILABLE
+        //! A background task that assigns lights to a range of depth slices.
+        void                            assignTask( Threads::TaskProgressWPtr progress, void* userData );
+    #endif  /*  DC_THREADS_AVAILABLE    */
+
+        //! Returns a depth slice index for a view space depth value.
+        s32                             sliceFromDepth( f32 depth ) const;
+
+        //! Returns a first and last tile overlapped by a sphere along a single screen axis.
+        static bool                     overlappedTiles( const TilePlane* planes, s32 count, const Vec3& center, f32 radius, s32& first, s32& last );
+
+        //! Returns a signed distance from a point to a tile plane.
+        static f32                      distanceToPlane( const TilePlane& plane, const Vec3& point );
+
+        //! Transforms a point from a normalized device space to a world space.
+        static Vec3                     unproject( const Matrix4& inverseViewProjection, f32 x, f32 y, f32 z );
+
+        //! Constructs a tile plane from three points and orients it towards a reference point.
+        static TilePlane                tilePlane( const Vec3& a, const Vec3& b, const Vec3& c, const Vec3& reference );
+
+        //! Returns a dot product of two vectors.
+        static f32                      dot( const Vec3& a, const Vec3& b );
+
+    private:
+
+        const RenderScene&              m_renderScene;                              //!< Parent render scene.
+        UPtr<Parameters>                m_parameters;                               //!< Packed cluster parameters.
+        TilePlane                       m_planesX[TilesX + 1];                      //!< Vertical tile planes from left to right.
+        TilePlane                       m_planesY[TilesY + 1];                      //!< Horizontal tile planes from bottom to top.
+        Array<LightVolume>              m_volumes;                                  //!< Bounding volumes of lights inside a camera frustum.
+        u8                              m_lights[TotalClusters][MaxLightsPerCluster];   //!< Light indices assigned to each cluster.
+        u8                              m_counts[TotalClusters];                    //!< A total number of lights assigned to each cluster.
+        f32                             m_near;                                     //!< A first slice starts at this depth.
+        f32                             m_far;                                      //!< A last slice ends at this depth.
+        f32                             m_sliceScale;                               //!< Maps a logarithm of a depth to a slice index.
+        f32                             m_sliceBias;                                //!< A slice index bias.
+    #if DC_THREADS_AVAILABLE
+        Threads::TaskManagerWPtr        m_taskManager;                              //!< A task manager used to assign lights.
+        Job                             m_jobs[MaxJobs];                            //!< Slice ranges processed by background tasks.
+    #endif  /*  DC_THREADS_AVAILABLE    */
+    };
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Scene_Rendering_LightClusters_H__    */
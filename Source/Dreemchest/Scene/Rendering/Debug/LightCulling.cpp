@@ -0,0 +1,293 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "LightCulling.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+// ** LightCulling::LightCulling
+LightCulling::LightCulling( const RenderScene& renderScene )
+    : m_renderScene( renderScene )
+{
+}
+
+// ** LightCulling::setCamera
+void LightCulling::setCamera( const Matrix4& viewProjection, const OcclusionBuffer* occlusion )
+{
+    // Extract and normalize camera frustum planes
+    RenderScene::CBuffer::ClipPlanes planes = RenderScene::CBuffer::ClipPlanes::fromViewProjection( viewProjection );
+
+    for( s32 i = 0; i < 6; i++ ) {
+        m_frustum[i] = planes.equation[i];
+        m_frustum[i].normalize();
+    }
+
+    // Test each static mesh against a camera frustum once, so light passes can reuse the result
+    const RenderScene::StaticMeshes& staticMeshes = m_renderScene.staticMeshes();
+    m_cameraVisible.resize( staticMeshes.count() );
+
+    for( s32 i = 0, n = staticMeshes.count(); i < n; i++ ) {
+        const Bounds& bounds = staticMeshes[i].mesh->worldSpaceBounds();
+        bool          inside = true;
+
+        for( s32 j = 0; j < 6 && inside; j++ ) {
+            inside = !m_frustum[j].isBehind( bounds );
+        }
+
+        // Meshes hidden behind occluders are neither rendered nor lit
+        if( inside && occlusion && occlusion->isOccluded( bounds, viewProjection ) ) {
+            inside = false;
+        }
+
+        m_cameraVisible[i] = inside ? 1 : 0;
+    }
+}
+
+// ** LightCulling::isMeshVisible
+bool LightCulling::isMeshVisible( s32 index ) const
+{
+    return m_cameraVisible[index] != 0;
+}
+
+// ** LightCulling::isLightVisible
+bool LightCulling::isLightVisible( const RenderScene::LightNode& light ) const
+{
+    Vec3 position = *light.matrix * Vec3::zero();
+    f32  range    = light.light->range();
+
+    switch( light.light->type() ) {
+    case LightType::Point:          return isInsideCamera( position, range );
+
+    case LightType::Spot:           {
+                                        // A spot light illuminates a sector of a range sphere, a sphere centered at the middle of an axis
+                                        // contains an apex, a tip and a rim of this sector and is always finite
+                                        Vec3 axis   = -light.transform->axisZ();
+                                        f32  cosine = cosf( radians( min2( light.light->cutoff(), 90.0f ) ) );
+                                        f32  radius = range * sqrtf( max2( 0.25f, 1.25f - cosine ) );
+
+                                        // Wide cones are better bounded by a light range sphere
+                                        if( radius >= range ) {
+                                            return isInsideCamera( position, range );
+                                        }
+
+                                        return isInsideCamera( position + axis * range * 0.5f, radius );
+                                    }
+
+    case LightType::Directional:    return true;
+    }
+
+    return true;
+}
+
+// ** LightCulling::cullLight
+void LightCulling::cullLight( const RenderScene::LightNode& light, Visibility& output ) const
+{
+    output.casters.clear();
+    output.visibleCasters.clear();
+    output.receivers.clear();
+
+    Vec3 position = *light.matrix * Vec3::zero();
+    f32  range    = light.light->range();
+
+    // Spot lights shine along a negative Z axis
+    bool spot   = light.light->type() == LightType::Spot;
+    Vec3 axis   = -light.transform->axisZ();
+    f32  angle  = radians( light.light->cutoff() );
+    f32  cosine = cosf( angle );
+    f32  sine   = sinf( angle );
+
+    const RenderScene::StaticMeshes& staticMeshes = m_renderScene.staticMeshes();
+
+    for( s32 i = 0, n = staticMeshes.count(); i < n; i++ ) {
+        const Bounds& bounds = staticMeshes[i].mesh->worldSpaceBounds();
+
+        // Skip all meshes that are outside of a light range
+        if( !intersectsSphere( bounds, position, range ) ) {
+            continue;
+        }
+
+        // Spot light additionally tests a bounding sphere against a light cone
+        if( spot && !intersectsCone( bounds.center(), bounds.radius(), position, axis, range, cosine, sine ) ) {
+            continue;
+        }
+
+        output.casters.push_back( i );
+
+        if( m_cameraVisible[i] ) {
+            output.receivers.push_back( i );
+        }
+    }
+
+    // A light volume is not limited by receivers, so all casters may shadow them
+    output.visibleCasters = output.casters;
+}
+
+// ** LightCulling::cullCascade
+void LightCulling::cullCascade( const Matrix4& transform, Visibility& output ) const
+{
+    output.casters.clear();
+    output.visibleCasters.clear();
+    output.receivers.clear();
+
+    // Extract cascade planes, a near plane is skipped because casters between a light and a cascade still cast shadows
+    RenderScene::CBuffer::ClipPlanes planes = RenderScene::CBuffer::ClipPlanes::fromViewProjection( transform );
+
+    const RenderScene::StaticMeshes& staticMeshes = m_renderScene.staticMeshes();
+
+    // A light space rectangle that contains all visible receivers
+    Vec2 receiversMin(  FLT_MAX,  FLT_MAX );
+    Vec2 receiversMax( -FLT_MAX, -FLT_MAX );
+
+    for( s32 i = 0, n = staticMeshes.count(); i < n; i++ ) {
+        const Bounds& bounds = staticMeshes[i].mesh->worldSpaceBounds();
+        bool          inside = true;
+
+        for( s32 j = 0; j < 5 && inside; j++ ) {
+            inside = !planes.equation[j].isBehind( bounds );
+        }
+
+        if( !inside ) {
+            continue;
+        }
+
+        output.casters.push_back( i );
+
+        if( m_cameraVisible[i] ) {
+            Vec2 lower, upper;
+            lightSpaceRect( transform, bounds, lower, upper );
+
+            receiversMin = Vec2( min2( receiversMin.x, lower.x ), min2( receiversMin.y, lower.y ) );
+            receiversMax = Vec2( max2( receiversMax.x, upper.x ), max2( receiversMax.y, upper.y ) );
+            output.receivers.push_back( i );
+        }
+    }
+
+    // Point clouds are not culled and may receive shadows from any caster
+    if( m_renderScene.pointClouds().count() > 0 ) {
+        output.visibleCasters = output.casters;
+        return;
+    }
+
+    // A caster is projected along a light direction, so it can only shadow receivers that overlap it in a light space
+    for( s32 i = 0, n = static_cast<s32>( output.casters.size() ); i < n; i++ ) {
+        s32  index = output.casters[i];
+        Vec2 lower, upper;
+        lightSpaceRect( transform, staticMeshes[index].mesh->worldSpaceBounds(), lower, upper );
+
+        if( upper.x < receiversMin.x || lower.x > receiversMax.x || upper.y < receiversMin.y || lower.y > receiversMax.y ) {
+            continue;
+        }
+
+        output.visibleCasters.push_back( index );
+    }
+}
+
+// ** LightCulling::cullDirectional
+void LightCulling::cullDirectional( Visibility& output ) const
+{
+    output.casters.clear();
+    output.visibleCasters.clear();
+    output.receivers.clear();
+
+    // A directional light affects everything, so just output meshes that are visible by a camera
+    for( s32 i = 0, n = static_cast<s32>( m_cameraVisible.size() ); i < n; i++ ) {
+        if( m_cameraVisible[i] ) {
+            output.receivers.push_back( i );
+        }
+    }
+}
+
+// ** LightCulling::isInsideCamera
+bool LightCulling::isInsideCamera( const Vec3& center, f32 radius ) const
+{
+    for( s32 i = 0; i < 6; i++ ) {
+        if( m_frustum[i].isBehind( center, radius ) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ** LightCulling::intersectsCone
+bool LightCulling::intersectsCone( const Vec3& center, f32 radius, const Vec3& apex, const Vec3& axis, f32 range, f32 cosine, f32 sine )
+{
+    Vec3 v             = center - apex;
+    f32  lengthSquared = dot( v, v );
+    f32  projection    = dot( v, axis );
+
+    // A sphere is behind an apex or beyond a cone range
+    if( projection < -radius || projection > range + radius ) {
+        return false;
+    }
+
+    // Distance from a sphere center to a cone side
+    f32 distance = cosine * sqrtf( max2( lengthSquared - projection * projection, 0.0f ) ) - projection * sine;
+    return distance <= radius;
+}
+
+// ** LightCulling::intersectsSphere
+bool LightCulling::intersectsSphere( const Bounds& bounds, const Vec3& center, f32 radius )
+{
+    const Vec3& lower = bounds.min();
+    const Vec3& upper = bounds.max();
+
+    // Find the point inside a box that is closest to a sphere center
+    Vec3 closest( min2( max2( center.x, lower.x ), upper.x ), min2( max2( center.y, lower.y ), upper.y ), min2( max2( center.z, lower.z ), upper.z ) );
+    Vec3 delta = closest - center;
+
+    return dot( delta, delta ) <= radius * radius;
+}
+
+// ** LightCulling::lightSpaceRect
+void LightCulling::lightSpaceRect( const Matrix4& transform, const Bounds& bounds, Vec2& lower, Vec2& upper )
+{
+    const Vec3& a = bounds.min();
+    const Vec3& b = bounds.max();
+
+    lower = Vec2(  FLT_MAX,  FLT_MAX );
+    upper = Vec2( -FLT_MAX, -FLT_MAX );
+
+    // Project all bounding box corners to a light clip space
+    for( s32 i = 0; i < 8; i++ ) {
+        Vec3 corner = transform * Vec3( (i & 1) ? b.x : a.x, (i & 2) ? b.y : a.y, (i & 4) ? b.z : a.z );
+
+        lower = Vec2( min2( lower.x, corner.x ), min2( lower.y, corner.y ) );
+        upper = Vec2( max2( upper.x, corner.x ), max2( upper.y, corner.y ) );
+    }
+}
+
+// ** LightCulling::dot
+f32 LightCulling::dot( const Vec3& a, const Vec3& b )
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
@@ -0,0 +1,102 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Scene_Rendering_LightCulling_H__
+#define __DC_Scene_Rendering_LightCulling_H__
+
+#include "../RenderScene.h"
+#include "OcclusionBuffer.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+    //! Builds per-light lists of static meshes affected by a light source.
+    /*!
+    Light volumes are tested against world space bounds of static meshes: a sphere
+    for point lights, a cone for spot lights and a shadow cascade volume for directional lights.
+    A single cull produces both a list of shadow casters and a list of meshes that are inside a camera frustum.
+    */
+    class LightCulling {
+    public:
+
+        //! Static meshes affected by a single light source.
+        struct Visibility {
+            RenderScene::NodeIndices    casters;                //!< Meshes inside a light volume extruded towards a light, rendered to cached shadow maps.
+            RenderScene::NodeIndices    visibleCasters;         //!< Casters that may shadow visible receivers, rendered to shadow maps that are not reused between frames.
+            RenderScene::NodeIndices    receivers;              //!< Meshes inside both a light volume and a camera frustum, rendered by a light pass.
+        };
+
+                                        //! Constructs a LightCulling instance.
+                                        LightCulling( const RenderScene& renderScene );
+
+        //! Tests all static meshes against a camera frustum and an optional occlusion buffer, should be called once per frame before culling lights.
+        void                            setCamera( const Matrix4& viewProjection, const OcclusionBuffer* occlusion = NULL );
+
+        //! Returns true if a static mesh with a specified index is inside a camera frustum and is not occluded.
+        bool                            isMeshVisible( s32 index ) const;
+
+        //! Returns true if a light volume intersects a camera frustum.
+        bool                            isLightVisible( const RenderScene::LightNode& light ) const;
+
+        //! Collects static meshes inside a point or spot light volume.
+        void                            cullLight( const RenderScene::LightNode& light, Visibility& output ) const;
+
+        //! Collects static meshes inside a directional light shadow cascade, casters that do not overlap visible receivers in a light space are not added to visible casters.
+        void                            cullCascade( const Matrix4& transform, Visibility& output ) const;
+
+        //! Collects static meshes lit by a directional light without shadows.
+        void                            cullDirectional( Visibility& output ) const;
+
+    private:
+
+        //! Returns true if a bounding sphere is inside a camera frustum.
+        bool                            isInsideCamera( const Vec3& center, f32 radius ) const;
+
+        //! Returns true if a bounding sphere intersects a spot light cone.
+        static bool                     intersectsCone( const Vec3& center, f32 radius, const Vec3& apex, const Vec3& axis, f32 range, f32 cosine, f32 sine );
+
+        //! Returns true if a bounding box intersects a sphere.
+        static bool                     intersectsSphere( const Bounds& bounds, const Vec3& center, f32 radius );
+
+        //! Calculates a light clip space rectangle of a bounding box.
+        static void                     lightSpaceRect( const Matrix4& transform, const Bounds& bounds, Vec2& lower, Vec2& upper );
+
+        //! Returns a dot product of two vectors.
+        static f32                      dot( const Vec3& a, const Vec3& b );
+
+    private:
+
+        const RenderScene&              m_renderScene;          //!< Parent render scene.
+        Plane                           m_frustum[6];           //!< Camera frustum planes.
+        Array<u8>                       m_cameraVisible;        //!< Camera visibility flag for each static mesh.
+    };
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Scene_Rendering_LightCulling_H__    */
@@ -0,0 +1,357 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "OcclusionBuffer.h"
+
+#if DC_THREADS_AVAILABLE
+    #include "../../../Threads/Task/TaskManager.h"
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+    #define DC_SCENE_OCCLUSION_SSE  1
+    #include <xmmintrin.h>
+#else
+    #define DC_SCENE_OCCLUSION_SSE  0
+#endif
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+//! Points with a smaller clip space W are too close to a camera plane to be projected.
+static const f32 kMinClipW = 0.0001f;
+
+// ** OcclusionBuffer::OcclusionBuffer
+OcclusionBuffer::OcclusionBuffer( void )
+{
+    for( s32 i = 0; i < Levels; i++ ) {
+        m_levels[i].resize( (Width >> i) * (Height >> i), 1.0f );
+    }
+}
+
+#if DC_THREADS_AVAILABLE
+
+// ** OcclusionBuffer::setTaskManager
+void OcclusionBuffer::setTaskManager( Threads::TaskManagerWPtr value )
+{
+    m_taskManager = value;
+}
+
+// ** OcclusionBuffer::rasterizeTask
+void OcclusionBuffer::rasterizeTask( Threads::TaskProgressWPtr progress, void* userData )
+{
+    const Job* job = reinterpret_cast<const Job*>( userData );
+    rasterizeBand( job->first, job->last );
+}
+
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+// ** OcclusionBuffer::triangleCount
+s32 OcclusionBuffer::triangleCount( void ) const
+{
+    return static_cast<s32>( m_triangles.size() );
+}
+
+// ** OcclusionBuffer::depthAt
+f32 OcclusionBuffer::depthAt( s32 level, s32 x, s32 y ) const
+{
+    NIMBLE_ABORT_IF( level < 0 || level >= Levels, "level is out of range" );
+    return m_levels[level][y * (Width >> level) + x];
+}
+
+// ** OcclusionBuffer::clear
+void OcclusionBuffer::clear( void )
+{
+    m_triangles.clear();
+
+    for( s32 i = 0; i < Levels; i++ ) {
+        std::fill( m_levels[i].begin(), m_levels[i].end(), 1.0f );
+    }
+}
+
+// ** OcclusionBuffer::addOccluder
+void OcclusionBuffer::addOccluder( const Matrix4& transform, const Vec3* positions, s32 stride, const u32* indices, s32 count )
+{
+    const u8* vertices = reinterpret_cast<const u8*>( positions );
+
+    for( s32 i = 0; i + 2 < count; i += 3 ) {
+        Vec4 clip[3];
+
+        for( s32 j = 0; j < 3; j++ ) {
+            const Vec3& position = *reinterpret_cast<const Vec3*>( vertices + indices[i + j] * stride );
+            clip[j] = transform * Vec4( position.x, position.y, position.z, 1.0f );
+        }
+
+        Triangle triangle;
+
+        if( setupTriangle( clip[0], clip[1], clip[2], triangle ) ) {
+            m_triangles.push_back( triangle );
+        }
+    }
+}
+
+// ** OcclusionBuffer::rasterize
+void OcclusionBuffer::rasterize( void )
+{
+    // Each task rasterizes and reduces its own band of rows
+#if DC_THREADS_AVAILABLE
+    Threads::TaskManagerWPtr taskManager = m_taskManager;
+
+    if( taskManager.valid() && !m_triangles.empty() ) {
+        Threads::TaskProgressPtr tasks[MaxJobs];
+
+        for( s32 i = 0; i < MaxJobs; i++ ) {
+            m_jobs[i].first = BandHeight *  i;
+            m_jobs[i].last  = BandHeight * (i + 1);
+            tasks[i] = taskManager->runBackgroundTask( dcThisMethod( OcclusionBuffer::rasterizeTask ), &m_jobs[i] );
+        }
+
+        for( s32 i = 0; i < MaxJobs; i++ ) {
+            tasks[i]->waitForCompletion();
+        }
+    } else
+#endif  /*  DC_THREADS_AVAILABLE    */
+    {
+        rasterizeBand( 0, Height );
+    }
+}
+
+// ** OcclusionBuffer::isOccluded
+bool OcclusionBuffer::isOccluded( const Bounds& bounds, const Matrix4& viewProjection ) const
+{
+    const Vec3& lower = bounds.min();
+    const Vec3& upper = bounds.max();
+
+    // Project all box corners to calculate a screen space rectangle and a nearest depth
+    Vec3 nearest(  FLT_MAX,  FLT_MAX,  FLT_MAX );
+    Vec3 farthest( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+
+    for( s32 i = 0; i < 8; i++ ) {
+        Vec4 point = viewProjection * Vec4( i & 1 ? upper.x : lower.x, i & 2 ? upper.y : lower.y, i & 4 ? upper.z : lower.z, 1.0f );
+
+        // A box crosses a camera plane, so it can not be hidden
+        if( point.w <= kMinClipW ) {
+            return false;
+        }
+
+        Vec3 screen = toScreen( point );
+        nearest  = Vec3( min2( nearest.x, screen.x ), min2( nearest.y, screen.y ), min2( nearest.z, screen.z ) );
+        farthest = Vec3( max2( farthest.x, screen.x ), max2( farthest.y, screen.y ), max2( farthest.z, screen.z ) );
+    }
+
+    // Boxes outside of a screen are left for a frustum culling
+    if( farthest.x < 0.0f || farthest.y < 0.0f || nearest.x >= Width || nearest.y >= Height ) {
+        return false;
+    }
+
+    s32 x0 = max2( static_cast<s32>( floorf( nearest.x ) ), 0 );
+    s32 y0 = max2( static_cast<s32>( floorf( nearest.y ) ), 0 );
+    s32 x1 = min2( static_cast<s32>( floorf( farthest.x ) ), Width - 1 );
+    s32 y1 = min2( static_cast<s32>( floorf( farthest.y ) ), Height - 1 );
+
+    // Select a pyramid level where a rectangle covers just a few texels
+    s32 level = 0;
+
+    while( level < Levels - 1 && (x1 - x0 >= MaxTestTexels || y1 - y0 >= MaxTestTexels) ) {
+        x0 >>= 1; y0 >>= 1;
+        x1 >>= 1; y1 >>= 1;
+        level++;
+    }
+
+    // A box is visible if it is nearer than a farthest occluder in any overlapped texel
+    const f32* depth = &m_levels[level][0];
+    s32        width = Width >> level;
+
+    for( s32 y = y0; y <= y1; y++ ) {
+        for( s32 x = x0; x <= x1; x++ ) {
+            if( nearest.z <= depth[y * width + x] ) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// ** OcclusionBuffer::rasterizeBand
+void OcclusionBuffer::rasterizeBand( s32 first, s32 last )
+{
+    // Reset band rows to a far plane
+    std::fill( m_levels[0].begin() + first * Width, m_levels[0].begin() + last * Width, 1.0f );
+
+    for( s32 i = 0, n = static_cast<s32>( m_triangles.size() ); i < n; i++ ) {
+        const Triangle& triangle = m_triangles[i];
+
+        if( triangle.max[1] >= first && triangle.min[1] < last ) {
+            rasterizeTriangle( triangle, first, last );
+        }
+    }
+
+    // Band height is a power of two, so each level is reduced independently from other bands
+    for( s32 i = 0; i < Levels - 1; i++ ) {
+        reduceLevel( i, first >> i, last >> i );
+    }
+}
+
+// ** OcclusionBuffer::rasterizeTriangle
+void OcclusionBuffer::rasterizeTriangle( const Triangle& triangle, s32 first, s32 last )
+{
+    const f32 (*edges)[3] = triangle.edges;
+    const f32*  plane     = triangle.depth;
+
+    s32 y0 = max2( triangle.min[1], first );
+    s32 y1 = min2( triangle.max[1], last - 1 );
+
+#if DC_SCENE_OCCLUSION_SSE
+    // Four pixels of a row are tested at once, a depth buffer width is a multiple of four
+    __m128 offsets = _mm_setr_ps( 0.5f, 1.5f, 2.5f, 3.5f );
+    __m128 zero    = _mm_setzero_ps();
+    __m128 a0      = _mm_set1_ps( edges[0][0] );
+    __m128 a1      = _mm_set1_ps( edges[1][0] );
+    __m128 a2      = _mm_set1_ps( edges[2][0] );
+    __m128 az      = _mm_set1_ps( plane[0] );
+#endif  /*  DC_SCENE_OCCLUSION_SSE  */
+
+    for( s32 y = y0; y <= y1; y++ ) {
+        f32* row = &m_levels[0][y * Width];
+        f32  py  = y + 0.5f;
+
+        // Edge and depth values at the beginning of a row
+        f32 e0 = edges[0][1] * py + edges[0][2];
+        f32 e1 = edges[1][1] * py + edges[1][2];
+        f32 e2 = edges[2][1] * py + edges[2][2];
+        f32 ez = plane[1] * py + plane[2];
+
+        s32 x = triangle.min[0];
+
+    #if DC_SCENE_OCCLUSION_SSE
+        __m128 r0 = _mm_set1_ps( e0 );
+        __m128 r1 = _mm_set1_ps( e1 );
+        __m128 r2 = _mm_set1_ps( e2 );
+        __m128 rz = _mm_set1_ps( ez );
+
+        for( x &= ~3; x <= triangle.max[0]; x += 4 ) {
+            __m128 px     = _mm_add_ps( _mm_set1_ps( static_cast<f32>( x ) ), offsets );
+            __m128 inside = _mm_and_ps( _mm_and_ps( _mm_cmpge_ps( _mm_add_ps( _mm_mul_ps( a0, px ), r0 ), zero )
+                                                  , _mm_cmpge_ps( _mm_add_ps( _mm_mul_ps( a1, px ), r1 ), zero ) )
+                                                  , _mm_cmpge_ps( _mm_add_ps( _mm_mul_ps( a2, px ), r2 ), zero ) );
+            __m128 depth  = _mm_loadu_ps( row + x );
+            __m128 nearer = _mm_min_ps( depth, _mm_add_ps( _mm_mul_ps( az, px ), rz ) );
+            _mm_storeu_ps( row + x, _mm_or_ps( _mm_and_ps( inside, nearer ), _mm_andnot_ps( inside, depth ) ) );
+        }
+    #endif  /*  DC_SCENE_OCCLUSION_SSE  */
+
+        for( ; x <= triangle.max[0]; x++ ) {
+            f32 px = x + 0.5f;
+
+            if( edges[0][0] * px + e0 >= 0.0f && edges[1][0] * px + e1 >= 0.0f && edges[2][0] * px + e2 >= 0.0f ) {
+                row[x] = min2( row[x], plane[0] * px + ez );
+            }
+        }
+    }
+}
+
+// ** OcclusionBuffer::reduceLevel
+void OcclusionBuffer::reduceLevel( s32 level, s32 first, s32 last )
+{
+    const f32* input  = &m_levels[level][0];
+    f32*       output = &m_levels[level + 1][0];
+    s32        width  = Width >> (level + 1);
+
+    // Each texel of a next level keeps a farthest depth of four texels below it
+    for( s32 y = first / 2; y < last / 2; y++ ) {
+        const f32* top    = input + (y * 2 + 0) * width * 2;
+        const f32* bottom = input + (y * 2 + 1) * width * 2;
+
+        for( s32 x = 0; x < width; x++ ) {
+            output[y * width + x] = max2( max2( top[x * 2], top[x * 2 + 1] ), max2( bottom[x * 2], bottom[x * 2 + 1] ) );
+        }
+    }
+}
+
+// ** OcclusionBuffer::setupTriangle
+bool OcclusionBuffer::setupTriangle( const Vec4& a, const Vec4& b, const Vec4& c, Triangle& triangle )
+{
+    // Triangles that cross a camera plane are skipped, missing occluders only make a test more conservative
+    if( a.w <= kMinClipW || b.w <= kMinClipW || c.w <= kMinClipW ) {
+        return false;
+    }
+
+    Vec3 v[3] = { toScreen( a ), toScreen( b ), toScreen( c ) };
+
+    // Both sides of an occluder are rasterized, so flip clockwise triangles
+    f32 area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[1].y - v[0].y) * (v[2].x - v[0].x);
+
+    if( area < 0.0f ) {
+        std::swap( v[1], v[2] );
+        area = -area;
+    }
+
+    if( area < 1e-6f ) {
+        return false;
+    }
+
+    // Calculate a screen space bounding rectangle clipped to a depth buffer
+    triangle.min[0] = max2( static_cast<s32>( floorf( min2( v[0].x, min2( v[1].x, v[2].x ) ) ) ), 0 );
+    triangle.min[1] = max2( static_cast<s32>( floorf( min2( v[0].y, min2( v[1].y, v[2].y ) ) ) ), 0 );
+    triangle.max[0] = min2( static_cast<s32>( floorf( max2( v[0].x, max2( v[1].x, v[2].x ) ) ) ), Width - 1 );
+    triangle.max[1] = min2( static_cast<s32>( floorf( max2( v[0].y, max2( v[1].y, v[2].y ) ) ) ), Height - 1 );
+
+    if( triangle.min[0] > triangle.max[0] || triangle.min[1] > triangle.max[1] ) {
+        return false;
+    }
+
+    // Edge functions are positive on the inner side of each edge
+    for( s32 i = 0; i < 3; i++ ) {
+        const Vec3& from = v[i];
+        const Vec3& to   = v[(i + 1) % 3];
+
+        // An edge shared by two triangles is evaluated relative to the same vertex, so no pixels are lost along it
+        const Vec3& origin = (from.x < to.x || (from.x == to.x && from.y < to.y)) ? from : to;
+
+        triangle.edges[i][0] = from.y - to.y;
+        triangle.edges[i][1] = to.x - from.x;
+        triangle.edges[i][2] = -(triangle.edges[i][0] * origin.x + triangle.edges[i][1] * origin.y);
+    }
+
+    // A depth is interpolated by barycentric coordinates, which are edge functions of opposite edges divided by an area
+    for( s32 i = 0; i < 3; i++ ) {
+        triangle.depth[i] = (triangle.edges[1][i] * v[0].z + triangle.edges[2][i] * v[1].z + triangle.edges[0][i] * v[2].z) / area;
+    }
+
+    return true;
+}
+
+// ** OcclusionBuffer::toScreen
+Vec3 OcclusionBuffer::toScreen( const Vec4& point )
+{
+    f32 w = 1.0f / point.w;
+    return Vec3( (point.x * w * 0.5f + 0.5f) * Width, (point.y * w * 0.5f + 0.5f) * Height, point.z * w * 0.5f + 0.5f );
+}
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
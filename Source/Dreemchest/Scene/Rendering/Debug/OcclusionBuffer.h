@@ -0,0 +1,134 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Scene_Rendering_OcclusionBuffer_H__
+#define __DC_Scene_Rendering_OcclusionBuffer_H__
+
+#include "../RenderScene.h"
+#include "../../../Threads/Threads.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+    //! A low resolution depth buffer with occluder triangles rasterized on a CPU.
+    /*!
+    Occluder triangles are transformed to a screen space and set up once, then a depth buffer is
+    split to horizontal bands that are rasterized by background tasks, each band keeps a nearest depth
+    of each pixel. After rasterization each band builds its part of a hierarchical depth pyramid, where
+    each texel holds a farthest depth of four texels below it. A bounding box is occluded when its nearest
+    projected depth is behind a farthest depth of all pyramid texels that its screen rectangle overlaps.
+    All tests are conservative: anything that can not be reliably projected is reported as visible.
+    */
+    class OcclusionBuffer {
+    public:
+
+        enum {
+              Width                 = 256                                   //!< A depth buffer width in pixels.
+            , Height                = 128                                   //!< A depth buffer height in pixels.
+            , Levels                = 6                                     //!< A total number of depth pyramid levels including a depth buffer itself.
+            , MaxJobs               = 4                                     //!< A total number of horizontal bands rasterized in parallel.
+            , BandHeight            = Height / MaxJobs                      //!< A total number of rows in a single band, each band is reduced to a single row of a last level.
+            , MaxTestTexels         = 4                                     //!< A pyramid level is selected so that a tested rectangle spans at most this number of texels.
+        };
+
+                                        //! Constructs an OcclusionBuffer instance.
+                                        OcclusionBuffer( void );
+
+    #if DC_THREADS_AVAILABLE
+        //! Sets a task manager used to rasterize occluders in background, occluders are rasterized synchronously without it.
+        void                            setTaskManager( Threads::TaskManagerWPtr value );
+    #endif  /*  DC_THREADS_AVAILABLE    */
+
+        //! Removes all occluders and resets a depth buffer to a far plane.
+        void                            clear( void );
+
+        //! Adds indexed occluder triangles transformed by a world-view-projection matrix, positions are read with a specified byte stride.
+        void                            addOccluder( const Matrix4& transform, const Vec3* positions, s32 stride, const u32* indices, s32 count );
+
+        //! Rasterizes all added occluders and builds a depth pyramid.
+        void                            rasterize( void );
+
+        //! Returns true if a world space bounding box is completely hidden behind rasterized occluders.
+        bool                            isOccluded( const Bounds& bounds, const Matrix4& viewProjection ) const;
+
+        //! Returns a depth value of a pyramid texel, a zero level is a depth buffer itself.
+        f32                             depthAt( s32 level, s32 x, s32 y ) const;
+
+        //! Returns a total number of occluder triangles that were set up for rasterization.
+        s32                             triangleCount( void ) const;
+
+    private:
+
+        //! A screen space triangle ready for rasterization.
+        struct Triangle {
+            f32                         edges[3][3];            //!< Edge function coefficients, a pixel is inside when all of them are non-negative.
+            f32                         depth[3];               //!< Depth plane coefficients.
+            s32                         min[2];                 //!< A first pixel of a screen space bounding rectangle.
+            s32                         max[2];                 //!< A last pixel of a screen space bounding rectangle.
+        };
+
+        //! A range of depth buffer rows processed by a single task.
+        struct Job {
+            s32                         first;                  //!< A first row.
+            s32                         last;                   //!< A row after the last one.
+        };
+
+        //! Rasterizes all triangles to a range of rows and reduces them to a depth pyramid.
+        void                            rasterizeBand( s32 first, s32 last );
+
+        //! Rasterizes a single triangle clipped to a range of rows.
+        void                            rasterizeTriangle( const Triangle& triangle, s32 first, s32 last );
+
+        //! Reduces a range of rows of a pyramid level to a next one.
+        void                            reduceLevel( s32 level, s32 first, s32 last );
+
+        //! Sets up a screen space triangle, returns false if a triangle is degenerate, offscreen or crosses a near plane.
+        static bool                     setupTriangle( const Vec4& a, const Vec4& b, const Vec4& c, Triangle& triangle );
+
+        //! Transforms a clip space point to a depth buffer space.
+        static Vec3                     toScreen( const Vec4& point );
+
+    #if DC_THREADS_AVAILABLE
+        //! A background task that rasterizes a single band.
+        void                            rasterizeTask( Threads::TaskProgressWPtr progress, void* userData );
+    #endif  /*  DC_THREADS_AVAILABLE    */
+
+    private:
+
+        Array<Triangle>                 m_triangles;                                //!< Occluder triangles set up for rasterization.
+        Array<f32>                      m_levels[Levels];                           //!< A depth buffer followed by depth pyramid levels.
+    #if DC_THREADS_AVAILABLE
+        Threads::TaskManagerWPtr        m_taskManager;                              //!< A task manager used to rasterize occluders.
+        Job                             m_jobs[MaxJobs];                            //!< Row ranges processed by background tasks.
+    #endif  /*  DC_THREADS_AVAILABLE    */
+    };
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Scene_Rendering_OcclusionBuffer_H__    */
@@ -0,0 +1,214 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "ShadowCache.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+// ** ShadowCache::ShadowCache
+ShadowCache::ShadowCache( RenderingContext& context, const RenderScene& renderScene )
+    : m_context( context )
+    , m_renderScene( renderScene )
+    , m_frame( 0 )
+    , m_budget( 0 )
+{
+    for( s32 i = 0; i < MaxSlots; i++ ) {
+        m_slots[i].hasCamera = false;
+        m_slots[i].cascade   = 0;
+        m_slots[i].size      = 0;
+        m_slots[i].casters   = 0;
+        m_slots[i].rendered  = 0;
+        m_slots[i].used      = 0;
+        m_slots[i].valid     = false;
+    }
+}
+
+// ** ShadowCache::~ShadowCache
+ShadowCache::~ShadowCache( void )
+{
+    for( s32 i = 0; i < MaxSlots; i++ ) {
+        if( m_slots[i].texture ) {
+            m_context.deleteTexture( m_slots[i].texture );
+        }
+    }
+}
+
+// ** ShadowCache::beginFrame
+void ShadowCache::beginFrame( void )
+{
+    m_frame++;
+    m_budget = -1;
+}
+
+// ** ShadowCache::setBudget
+void ShadowCache::setBudget( s32 budget )
+{
+    m_budget = budget > 0 ? budget : -1;
+}
+
+// ** ShadowCache::request
+ShadowCache::Entry ShadowCache::request( const Camera* camera, const Light* light, s32 cascade, s32 size, const Matrix4& transform, const RenderScene::NodeIndices& casters, bool scheduled )
+{
+    Entry entry;
+    entry.transform = transform;
+    entry.update    = true;
+
+    // All slots are used this frame, so a shadow map should be rendered to a transient texture
+    Slot* slot = findSlot( camera, light, cascade );
+
+    if( !slot ) {
+        return entry;
+    }
+
+    // Allocate a new shadow map texture if a size has changed, a previous one is destroyed
+    if( slot->size != size ) {
+        if( slot->texture ) {
+            m_context.deleteTexture( slot->texture );
+        }
+
+        slot->texture = m_context.requestTexture2D( NULL, size, size, TextureD24 );
+        slot->size    = size;
+        slot->valid   = false;
+    }
+
+    slot->used    = m_frame;
+    entry.texture = slot->texture;
+
+    // Nothing has changed since a shadow map was rendered
+    u32  hash  = hashCasters( casters );
+    bool dirty = !slot->valid || slot->casters != hash || !isEqual( slot->transform, transform );
+
+    if( !dirty ) {
+        entry.transform = slot->transform;
+        entry.update    = false;
+        return entry;
+    }
+
+    // A shadow map is outdated, but it was rendered recently or there is no budget left for this frame
+    bool throttled = !scheduled || m_frame - slot->rendered < static_cast<u32>( light->shadowUpdateInterval() ) || m_budget == 0;
+
+    if( slot->valid && throttled ) {
+        entry.transform = slot->transform;
+        entry.update    = false;
+        return entry;
+    }
+
+    // Render a shadow map, invalid slots are always rendered because there is nothing to sample from
+    if( m_budget > 0 ) {
+        m_budget--;
+    }
+
+    slot->transform = transform;
+    slot->casters   = hash;
+    slot->rendered  = m_frame;
+    slot->valid     = true;
+
+    return entry;
+}
+
+// ** ShadowCache::isCascadeScheduled
+bool ShadowCache::isCascadeScheduled( s32 cascade, s32 count ) const
+{
+    if( cascade == 0 || count <= 2 ) {
+        return true;
+    }
+
+    return static_cast<s32>( m_frame % (count - 1) ) == cascade - 1;
+}
+
+// ** ShadowCache::findSlot
+ShadowCache::Slot* ShadowCache::findSlot( const Camera* camera, const Light* light, s32 cascade )
+{
+    Slot* lru = NULL;
+
+    for( s32 i = 0; i < MaxSlots; i++ ) {
+        Slot& slot = m_slots[i];
+
+        // A weak pointer is reset when a light or a camera is destroyed, so a new one allocated at the same address never matches it
+        if( !slot.light.valid() || (slot.hasCamera && !slot.camera.valid()) ) {
+            slot.used = 0;
+        }
+        else if( slot.light.get() == light && slot.camera.get() == camera && slot.cascade == cascade ) {
+            return &slot;
+        }
+
+        // Slots that were requested during this frame can't be reused
+        if( slot.used != m_frame && (!lru || slot.used < lru->used) ) {
+            lru = &slot;
+        }
+    }
+
+    if( lru ) {
+        lru->light     = const_cast<Light*>( light );
+        lru->camera    = const_cast<Camera*>( camera );
+        lru->hasCamera = camera != NULL;
+        lru->cascade   = cascade;
+        lru->valid   = false;
+    }
+
+    return lru;
+}
+
+// ** ShadowCache::hashCasters
+u32 ShadowCache::hashCasters( const RenderScene::NodeIndices& casters ) const
+{
+    const RenderScene::StaticMeshes& staticMeshes = m_renderScene.staticMeshes();
+
+    // A FNV-1a hash of caster indices and transforms
+    u32 hash = 2166136261u;
+
+    for( s32 i = 0, n = static_cast<s32>( casters.size() ); i < n; i++ ) {
+        const Matrix4& matrix = *staticMeshes[casters[i]].matrix;
+
+        hash = (hash ^ static_cast<u32>( casters[i] )) * 16777619u;
+
+        for( s32 j = 0; j < 16; j++ ) {
+            u32 bits;
+            memcpy( &bits, &matrix[j], sizeof( bits ) );
+            hash = (hash ^ bits) * 16777619u;
+        }
+    }
+
+    return hash;
+}
+
+// ** ShadowCache::isEqual
+bool ShadowCache::isEqual( const Matrix4& a, const Matrix4& b )
+{
+    for( s32 i = 0; i < 16; i++ ) {
+        if( a[i] != b[i] ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
@@ -0,0 +1,115 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Scene_Rendering_ShadowCache_H__
+#define __DC_Scene_Rendering_ShadowCache_H__
+
+#include "../RenderScene.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+    //! Keeps persistent shadow maps of light sources between frames.
+    /*!
+    Each shadow casting light (or a shadow cascade of a directional light) owns a slot with a persistent
+    depth texture. A shadow map is re-rendered only when a light transform or a transform of any
+    shadow caster inside a light volume changes. Updates are additionally throttled by a per-light
+    update interval and a total number of shadow maps that can be rendered each frame, a throttled
+    shadow map is sampled with a transform it was rendered with. Cached shadow maps are rendered with all
+    casters inside a light volume rather than ones that shadow visible receivers, so a camera movement
+    does not invalidate them and a reused shadow map stays valid for any receiver.
+    */
+    class ShadowCache {
+    public:
+
+        enum {
+              MaxSlots = 16                                     //!< A maximum number of cached shadow maps.
+        };
+
+        //! A shadow map lookup result.
+        struct Entry {
+            Texture_                    texture;                //!< A persistent shadow map, invalid if no slot is available.
+            Matrix4                     transform;              //!< A light transform that should be used to sample a shadow map.
+            bool                        update;                 //!< Indicates that a shadow map should be rendered this frame.
+        };
+
+                                        //! Constructs a ShadowCache instance.
+                                        ShadowCache( RenderingContext& context, const RenderScene& renderScene );
+                                        ~ShadowCache( void );
+
+        //! Starts a new frame, should be called once per rendered frame before any camera is processed.
+        void                            beginFrame( void );
+
+        //! Resets a shadow update budget for a camera being rendered, zero budget means no limit.
+        void                            setBudget( s32 budget );
+
+        //! Looks up a shadow map of a light cascade and decides whether it should be re-rendered, an outdated shadow map is reused if an update is not scheduled.
+        Entry                           request( const Camera* camera, const Light* light, s32 cascade, s32 size, const Matrix4& transform, const RenderScene::NodeIndices& casters, bool scheduled = true );
+
+        //! Returns true if a cascade update is scheduled for this frame, a nearest cascade is updated each frame and others are updated in a round-robin order.
+        bool                            isCascadeScheduled( s32 cascade, s32 count ) const;
+
+    private:
+
+        //! A cached shadow map.
+        struct Slot {
+            Light::WPtr                 light;                  //!< A light that owns this slot, becomes invalid once a light is destroyed.
+            Camera::WPtr                camera;                 //!< A camera a shadow map was fitted to, becomes invalid once a camera is destroyed.
+            bool                        hasCamera;              //!< Indicates that a shadow map depends on a camera.
+            s32                         cascade;                //!< A shadow cascade index.
+            s32                         size;                   //!< A shadow map size.
+            Texture_                    texture;                //!< A persistent depth texture.
+            Matrix4                     transform;              //!< A light transform a shadow map was rendered with.
+            u32                         casters;                //!< A hash of shadow casters a shadow map was rendered with.
+            u32                         rendered;               //!< A frame a shadow map was rendered at.
+            u32                         used;                   //!< A last frame a slot was requested.
+            bool                        valid;                  //!< Indicates that a shadow map contains rendered casters.
+        };
+
+        //! Returns a slot owned by a light cascade, allocates a slot of a destroyed light or a least recently used one if there is no such slot.
+        Slot*                           findSlot( const Camera* camera, const Light* light, s32 cascade );
+
+        //! Calculates a hash of shadow caster indices and transforms.
+        u32                             hashCasters( const RenderScene::NodeIndices& casters ) const;
+
+        //! Returns true if two transforms are equal.
+        static bool                     isEqual( const Matrix4& a, const Matrix4& b );
+
+    private:
+
+        RenderingContext&               m_context;              //!< A rendering context used to create shadow maps.
+        const RenderScene&              m_renderScene;          //!< Parent render scene.
+        Slot                            m_slots[MaxSlots];      //!< Cached shadow maps.
+        u32                             m_frame;                //!< Current frame index.
+        s32                             m_budget;               //!< A number of shadow maps that can still be rendered this frame.
+    };
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Scene_Rendering_ShadowCache_H__    */
@@ -34,7 +34,7 @@ namespace Scene {
 
 // ** SpriteRenderSystem::SpriteRenderSystem
 SpriteRenderSystem::SpriteRenderSystem( RenderingContext& context, RenderScene& renderScene )
-    : RenderSystem( context, renderScene )
+    : RenderSystem( context, renderScene, "SpriteRenderSystem" )
     , m_vertexFormat( VertexFormat::Position | VertexFormat::Color | VertexFormat::TexCoord0 )
 {
     // Allocate and initialize an index buffer
@@ -99,8 +99,8 @@ void SpriteRenderSystem::emitSpriteBatch( RenderFrame& frame, RenderCommandBuffe
         return;
     }
 
-    // Begin batch by allocating a chunk of vertex data
-    void* vertices = frame.allocate( m_vertexFormat.vertexSize() * count * 2 );
+    // Begin batch by allocating a chunk of vertex data, each sprite is written as 4 vertices
+    void* vertices = frame.allocateUpload( m_vertexFormat.vertexSize() * count * 4 );
 
     // A total number of emitted vertices
     s32 vertexCount = 0;
@@ -121,7 +121,7 @@ void SpriteRenderSystem::emitSpriteBatch( RenderFrame& frame, RenderCommandBuffe
     StateScope state = stateStack.push( sprites[first].material.states );
 
     // Upload vertex data to a GPU buffer and emit a draw indexed command
-    commands.uploadVertexBuffer( m_vertexBuffer, vertices, vertexCount * m_vertexFormat.vertexSize() );
+    commands.uploadVertexBuffer( m_vertexBuffer, Renderer::persistentPointer( vertices ), vertexCount * m_vertexFormat.vertexSize() );
     commands.drawIndexed( 0, Renderer::PrimTriangles, 0, vertexCount * 3 );
 }
 
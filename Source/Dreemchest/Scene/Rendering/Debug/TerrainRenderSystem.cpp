@@ -0,0 +1,215 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "TerrainRenderSystem.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+// ------------------------------------------------------------- TerrainRenderSystem ------------------------------------------------------------- //
+
+// ** TerrainRenderSystem::CBuffer::Layout
+RenderScene::CBuffer::BufferLayout TerrainRenderSystem::CBuffer::Layout[] =
+{
+      { "Terrain.morph", Renderer::UniformElement::Vec4, offsetof( CBuffer, morph ), }
+    , { "Terrain.color", Renderer::UniformElement::Vec4, offsetof( CBuffer, color ), }
+    , { NULL }
+};
+
+// ** TerrainRenderSystem::TerrainRenderSystem
+TerrainRenderSystem::TerrainRenderSystem( RenderingContext& context, RenderScene& renderScene )
+    : RenderSystem( context, renderScene, "TerrainRenderSystem" )
+    , m_vertexFormat( VertexFormat::Position | VertexFormat::Normal | VertexFormat::TexCoord0 | VertexFormat::TexCoord1 )
+{
+    // Request an input layout for a terrain vertex format
+    m_inputLayout    = context.requestInputLayout( m_vertexFormat );
+
+    // Request a constant buffer with morph parameters of a rendered tile
+    m_constantBuffer = context.deprecatedRequestConstantBuffer( NULL, sizeof( CBuffer ), CBuffer::Layout );
+
+    // Create a terrain shader
+    m_shader = m_context.deprecatedRequestShader( "../../Source/Dreemchest/Scene/Rendering/Shaders/Terrain.shader" );
+}
+
+// ** TerrainRenderSystem::beginFrame
+void TerrainRenderSystem::beginFrame( RenderFrame& frame, RenderCommandBuffer& commands )
+{
+    // Group positions of all cameras by a terrain LOD they render
+    Map< TerrainLod*, Array<Vec3> > cameras;
+
+    const Ecs::EntitySet& entities = m_cameras->entities();
+
+    for( Ecs::EntitySet::const_iterator i = entities.begin(), end = entities.end(); i != end; ++i ) {
+        TerrainLodWPtr lod = (*i)->get<TerrainRenderer>()->lod();
+
+        if( lod.valid() ) {
+            cameras[lod.get()].push_back( (*i)->get<Transform>()->worldSpacePosition() );
+        }
+    }
+
+    // Update each terrain LOD once, so an update for one camera never evicts tiles used by another one
+    for( Map< TerrainLod*, Array<Vec3> >::const_iterator i = cameras.begin(), end = cameras.end(); i != end; ++i ) {
+        TerrainLod& lod = *i->first;
+
+        // Stitched index buffers do not depend on a terrain, so they are uploaded once
+        if( m_indices.empty() ) {
+            createIndexBuffer( lod );
+        }
+
+        lod.update( i->second );
+    }
+
+    // Reuse vertex buffers of tiles evicted by these updates before uploading new ones
+    releaseEvictedTiles();
+
+    for( Map< TerrainLod*, Array<Vec3> >::const_iterator i = cameras.begin(), end = cameras.end(); i != end; ++i ) {
+        uploadTiles( frame, commands, *i->first );
+    }
+}
+
+// ** TerrainRenderSystem::emitRenderOperations
+void TerrainRenderSystem::emitRenderOperations( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const Ecs::Entity& entity, const Camera& camera, const Transform& transform, const TerrainRenderer& terrainRenderer )
+{
+    TerrainLodWPtr lod = terrainRenderer.lod();
+
+    // Nothing to render - just skip
+    if( !lod.valid() ) {
+        return;
+    }
+
+    // Nodes were selected for all cameras by a frame update
+    const TerrainLod::Nodes& nodes = lod->nodes();
+
+    // Push a terrain rendering state
+    StateScope state = stateStack.newScope();
+    state->bindIndexBuffer( m_indexBuffer );
+    state->bindInputLayout( m_inputLayout );
+    state->bindProgram( m_shader );
+    state->bindConstantBuffer( m_constantBuffer, Constants::Instance );
+
+    // Nodes are sorted from near to far, so tiles are rendered front to back
+    for( s32 i = 0, n = static_cast<s32>( nodes.size() ); i < n; i++ ) {
+        const TerrainLod::Node& node = nodes[i];
+
+        // A tile is not generated yet and there is no coarser one to replace it
+        if( !node.tile.valid() ) {
+            continue;
+        }
+
+        TileBuffers::const_iterator tile = m_tileBuffers.find( node.tile.get() );
+        NIMBLE_BREAK_IF( tile == m_tileBuffers.end(), "a selected tile was not uploaded" );
+
+        if( tile == m_tileBuffers.end() ) {
+            continue;
+        }
+
+        // Vertices are morphed by a shader, so only a morph range of a node is updated per tile
+        CBuffer parameters;
+        parameters.morph = Vec4( node.morphStart, 1.0f / max2( node.morphEnd - node.morphStart, 0.001f ), 0.0f, 0.0f );
+        parameters.color = terrainRenderer.color();
+        commands.uploadConstantBuffer( m_constantBuffer, frame.internBuffer( &parameters, sizeof parameters ), sizeof parameters );
+
+        StateScope instance = stateStack.newScope();
+        instance->bindVertexBuffer( tile->second.buffer );
+        commands.drawIndexed( 0, Renderer::PrimTriangles, m_firstIndex[node.edges], m_indexCount[node.edges] );
+    }
+}
+
+// ** TerrainRenderSystem::uploadTiles
+void TerrainRenderSystem::uploadTiles( RenderFrame& frame, RenderCommandBuffer& commands, const TerrainLod& lod )
+{
+    const TerrainLod::Nodes& nodes = lod.nodes();
+    s32                      size  = (Terrain::kChunkSize + 1) * (Terrain::kChunkSize + 1) * m_vertexFormat.vertexSize();
+
+    for( s32 i = 0, n = static_cast<s32>( nodes.size() ); i < n; i++ ) {
+        const TerrainLod::Node& node = nodes[i];
+
+        // Skip missing tiles and tiles that are already resident on a GPU
+        if( !node.tile.valid() || m_tileBuffers.find( node.tile.get() ) != m_tileBuffers.end() ) {
+            continue;
+        }
+
+        // Take a vertex buffer released by an evicted tile or request a new one
+        TileBuffer tileBuffer;
+        tileBuffer.tile = node.tile.get();
+
+        if( m_freeBuffers.empty() ) {
+            tileBuffer.buffer = m_context.requestVertexBuffer( NULL, size );
+        } else {
+            tileBuffer.buffer = m_freeBuffers.back();
+            m_freeBuffers.pop_back();
+        }
+
+        // Write tile vertices with a morph height stored in a second texture coordinate
+        const TerrainTile::VertexBuffer& source   = node.tile->vertices();
+        void*                            vertices = frame.allocateUpload( size );
+
+        for( s32 j = 0, count = static_cast<s32>( source.size() ); j < count; j++ ) {
+            const TerrainTile::Vertex& vertex = source[j];
+
+            m_vertexFormat.setVertexAttribute( VertexFormat::Position, vertex.position, vertices, j );
+            m_vertexFormat.setVertexAttribute( VertexFormat::Normal, vertex.normal, vertices, j );
+            m_vertexFormat.setVertexAttribute( VertexFormat::TexCoord0, vertex.uv, vertices, j );
+            m_vertexFormat.setVertexAttribute( VertexFormat::TexCoord1, Vec2( vertex.morphHeight, 0.0f ), vertices, j );
+        }
+
+        commands.uploadVertexBuffer( tileBuffer.buffer, Renderer::persistentPointer( vertices ), size );
+        m_tileBuffers[node.tile.get()] = tileBuffer;
+    }
+}
+
+// ** TerrainRenderSystem::releaseEvictedTiles
+void TerrainRenderSystem::releaseEvictedTiles( void )
+{
+    for( TileBuffers::iterator i = m_tileBuffers.begin(); i != m_tileBuffers.end(); ) {
+        if( i->second.tile->state() != TerrainTile::Evicted ) {
+            ++i;
+            continue;
+        }
+
+        m_freeBuffers.push_back( i->second.buffer );
+        m_tileBuffers.erase( i++ );
+    }
+}
+
+// ** TerrainRenderSystem::createIndexBuffer
+void TerrainRenderSystem::createIndexBuffer( const TerrainLod& lod )
+{
+    for( s32 i = 0; i < TerrainLod::TotalEdgeMasks; i++ ) {
+        const Terrain::IndexBuffer& indices = lod.indexBuffer( i );
+
+        m_firstIndex[i] = static_cast<s32>( m_indices.size() );
+        m_indexCount[i] = static_cast<s32>( indices.size() );
+        m_indices.insert( m_indices.end(), indices.begin(), indices.end() );
+    }
+
+    m_indexBuffer = m_context.requestIndexBuffer( &m_indices[0], static_cast<s32>( m_indices.size() * sizeof( u16 ) ) );
+}
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
@@ -0,0 +1,101 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Scene_Rendering_TerrainRenderSystem_H__
+#define __DC_Scene_Rendering_TerrainRenderSystem_H__
+
+#include "../RenderSystem/RenderSystem.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+    //! Renders terrain tiles selected by a terrain LOD.
+    /*!
+     Each terrain LOD is updated once per frame with positions of all cameras that render it.
+     A resident tile is uploaded once to its own vertex buffer that stores a morph height as a
+     vertex attribute, so heights are blended to a coarser LOD by a camera distance in a vertex
+     shader. Tiles are rendered with an index buffer that stitches their edges and vertex buffers
+     of evicted tiles are reused by tiles that become resident later.
+    */
+    class TerrainRenderSystem : public RenderSystem<TerrainRenderer> {
+    public:
+
+        //! A terrain constant buffer type.
+        struct CBuffer {
+            static RenderScene::CBuffer::BufferLayout Layout[];
+            Vec4                        morph;              //!< A camera distance at which vertices start morphing followed by an inverse morph range.
+            Rgba                        color;              //!< A terrain color.
+        };
+
+                                        //! Constructs TerrainRenderSystem instance.
+                                        TerrainRenderSystem( RenderingContext& context, RenderScene& renderScene );
+
+    protected:
+
+        //! Updates each terrain LOD once for all cameras and uploads vertex buffers of newly selected tiles.
+        virtual void                    beginFrame( RenderFrame& frame, RenderCommandBuffer& commands ) NIMBLE_OVERRIDE;
+
+        //! Emits render operations for tiles selected by a terrain LOD.
+        virtual void                    emitRenderOperations( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const Ecs::Entity& entity, const Camera& camera, const Transform& transform, const TerrainRenderer& terrainRenderer ) NIMBLE_OVERRIDE;
+
+        //! Uploads vertex buffers of selected tiles that are not resident on a GPU yet.
+        void                            uploadTiles( RenderFrame& frame, RenderCommandBuffer& commands, const TerrainLod& lod );
+
+        //! Returns vertex buffers of evicted tiles to a free list.
+        void                            releaseEvictedTiles( void );
+
+        //! Concatenates stitched index buffers of a terrain LOD and uploads them to a GPU.
+        void                            createIndexBuffer( const TerrainLod& lod );
+
+    private:
+
+        //! A GPU vertex buffer that holds a single tile.
+        struct TileBuffer {
+            TerrainTilePtr              tile;               //!< A tile that was uploaded to this buffer.
+            VertexBuffer_               buffer;             //!< A vertex buffer with tile vertices.
+        };
+
+        //! Container type to map from a tile to its vertex buffer.
+        typedef Map<const TerrainTile*, TileBuffer> TileBuffers;
+
+        Program                         m_shader;           //!< A shader that morphs tile vertices.
+        VertexFormat                    m_vertexFormat;     //!< A terrain vertex format, a morph height is stored in a second texture coordinate.
+        IndexBuffer_                    m_indexBuffer;      //!< A static index buffer with all stitched edge variants.
+        InputLayout                     m_inputLayout;      //!< An input layout constructed from a vertex format.
+        ConstantBuffer_                 m_constantBuffer;   //!< A terrain constant buffer that is updated before each tile.
+        TileBuffers                     m_tileBuffers;      //!< Vertex buffers of tiles uploaded to a GPU.
+        Array<VertexBuffer_>            m_freeBuffers;      //!< Vertex buffers released by evicted tiles.
+        Terrain::IndexBuffer            m_indices;          //!< Concatenated stitched index buffers.
+        s32                             m_firstIndex[TerrainLod::TotalEdgeMasks];   //!< The first index of each stitched index buffer.
+        s32                             m_indexCount[TerrainLod::TotalEdgeMasks];   //!< A total number of indices in each stitched index buffer.
+    };
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Scene_Rendering_TerrainRenderSystem_H__    */
@@ -61,9 +61,9 @@ void DebugLightPass::emitRenderOperations( RenderFrame& frame, RenderCommandBuff
 
     // Emit a bounding box to an output stream
     switch( light.type() ) {
-    case LightType::Point:  emitWireBounds( frame, commands, stateStack, bounds * transform.matrix() );
+    case LightType::Point:  emitWireBounds( frame, commands, stateStack, bounds * transform.renderMatrix() );
                             break;
-    case LightType::Spot:   emitFrustum( frame, commands, stateStack, light.cutoff() * 2.0f, 1.0f, 0.1f, light.range() * 2.0f, transform.matrix() );
+    case LightType::Spot:   emitFrustum( frame, commands, stateStack, light.cutoff() * 2.0f, 1.0f, 0.1f, light.range() * 2.0f, transform.renderMatrix() );
                             break;
     }
 }
@@ -88,7 +88,7 @@ void DebugCameraPass::emitRenderOperations( RenderFrame& frame, RenderCommandBuf
     }
 
     switch( camera.projection() ) {
-    case Projection::Perspective:   emitFrustum( frame, commands, stateStack, camera.fov(), aspect, camera.near(), camera.far(), transform.matrix() );
+    case Projection::Perspective:   emitFrustum( frame, commands, stateStack, camera.fov(), aspect, camera.near(), camera.far(), transform.renderMatrix() );
                                     break;
     }
 }
@@ -188,7 +188,7 @@ void DebugCascadedShadows::emitRenderOperations( RenderFrame& frame, RenderComma
 
     // Caclulate CSM splits
     s32 cascades = m_csm.cascadeCount();
-    m_csm = CascadedShadowMaps( transform.matrix(), m_csm.light(), m_csm.textureSize() );
+    m_csm = CascadedShadowMaps( transform.renderMatrix(), m_csm.light(), m_csm.textureSize() );
     m_csm.calculate( camera.fov(), camera.near(), camera.far(), aspect, 0.3f, cascades );
 
     // Visualize camera frustum splits
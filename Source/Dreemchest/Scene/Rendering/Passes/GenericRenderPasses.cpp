@@ -39,14 +39,16 @@ AmbientPass::AmbientPass( RenderingContext& context, RenderScene& renderScene )
 }
 
 // ** AmbientPass::render
-void AmbientPass::render( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack )
+void AmbientPass::render( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const RenderScene::NodeIndices* visible )
 {
     StateScope pass = stateStack.newScope();
     pass->bindProgram( m_shader );
     pass->enableFeatures( ShaderEmissionColor | ShaderAmbientColor );
 
-    RenderPassBase::emitStaticMeshes( m_renderScene.staticMeshes(), frame, commands, stateStack );
-    RenderPassBase::emitPointClouds( m_renderScene.pointClouds(), frame, commands, stateStack );
+    commands.beginProfileScope( "AmbientPass" );
+    RenderPassBase::emitStaticMeshes( m_renderScene.staticMeshes(), frame, commands, stateStack, ~0, &m_sorting, visible );
+    RenderPassBase::emitPointClouds( m_renderScene.pointClouds(), frame, commands, stateStack, ~0, &m_sorting );
+    commands.endProfileScope();
 }
 
 // ------------------------------------------------------- ShadowPass ------------------------------------------------------- //
@@ -69,20 +71,25 @@ ConstantBuffer_ ShadowPass::cbuffer( void ) const
 }
 
 // ** ShadowPass::render
-TransientTexture ShadowPass::render( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const RenderScene::CBuffer::Shadow& parameters )
+void ShadowPass::render( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const RenderScene::CBuffer::Shadow& parameters, Texture_ target, const RenderScene::NodeIndices* casters )
 {
-    // Acquire a shadow render target
-    s32 dimensions  = static_cast<s32>( 1.0f / parameters.invSize );
-
-    TransientTexture renderTarget = commands.acquireTexture2D( dimensions, dimensions, TextureD24);
+    emitCasters( frame, commands.renderToTexture(target), stateStack, parameters, casters );
+}
 
-    // Render scene from a light's point of view
-    RenderCommandBuffer& cmd = commands.renderToTexture(renderTarget);
+// ** ShadowPass::upload
+void ShadowPass::upload( RenderFrame& frame, RenderCommandBuffer& commands, const RenderScene::CBuffer::Shadow& parameters )
+{
+    commands.uploadConstantBuffer( m_cbuffer, frame.internBuffer( &parameters, sizeof parameters ), sizeof parameters );
+}
 
-    cmd.clear( Rgba( 1.0f, 1.0f, 1.0f, 1.0f ), ~0 );
+// ** ShadowPass::emitCasters
+void ShadowPass::emitCasters( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const RenderScene::CBuffer::Shadow& parameters, const RenderScene::NodeIndices* casters )
+{
+    commands.beginProfileScope( "ShadowPass" );
+    commands.clear( Rgba( 1.0f, 1.0f, 1.0f, 1.0f ), ~0 );
 
     // Update a shadow constant buffer
-    cmd.uploadConstantBuffer( m_cbuffer, frame.internBuffer( &parameters, sizeof parameters ), sizeof parameters );
+    upload( frame, commands, parameters );
 
     // Push a shadow pass scope
     StateScope state = stateStack.newScope();
@@ -91,9 +98,8 @@ TransientTexture ShadowPass::render( RenderFrame& frame, RenderCommandBuffer& co
     state->setCullFace( Renderer::TriangleFaceFront );
 
     // Render all static meshes to a target
-    RenderPassBase::emitStaticMeshes( m_renderScene.staticMeshes(), frame, cmd, stateStack );
-
-    return renderTarget;
+    RenderPassBase::emitStaticMeshes( m_renderScene.staticMeshes(), frame, commands, stateStack, ~0, &m_sorting, casters );
+    commands.endProfileScope();
 }
 
 } // namespace Scene
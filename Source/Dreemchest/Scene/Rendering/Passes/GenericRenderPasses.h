@@ -41,8 +41,8 @@ namespace Scene {
                                     //! Constructs a AmbientPass instance.
                                     AmbientPass( RenderingContext& context, RenderScene& renderScene );
 
-        //! Emits operations to render an ambient lit scene.
-        void                        render( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack );
+        //! Emits operations to render an ambient lit scene, only static meshes from a visible list are rendered when one is passed.
+        void                        render( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const RenderScene::NodeIndices* visible = NULL );
 
     private:
 
@@ -56,8 +56,14 @@ namespace Scene {
                                     //! Constructs a ShadowPass instance.
                                     ShadowPass( RenderingContext& context, RenderScene& renderScene );
 
-        //! Emits render operations to output a depth to a texture.
-        TransientTexture            render( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const RenderScene::CBuffer::Shadow& parameters );
+        //! Emits render operations to output shadow casters depth to a command buffer that renders to a shadow map, only casters from a visible list are rendered when one is passed.
+        void                        emitCasters( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const RenderScene::CBuffer::Shadow& parameters, const RenderScene::NodeIndices* casters = NULL );
+
+        //! Emits render operations to output a depth to a persistent shadow map.
+        void                        render( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const RenderScene::CBuffer::Shadow& parameters, Texture_ target, const RenderScene::NodeIndices* casters = NULL );
+
+        //! Uploads shadow parameters used to sample a shadow map that was rendered during one of previous frames.
+        void                        upload( RenderFrame& frame, RenderCommandBuffer& commands, const RenderScene::CBuffer::Shadow& parameters );
 
         //! Returns a constant buffer that is used for shadow parameters.
         ConstantBuffer_             cbuffer( void ) const;
@@ -26,6 +26,7 @@
 
 #include "RenderCache.h"
 #include "../Assets/Mesh.h"
+#include "../Assets/MeshProcessing.h"
 #include "../Assets/Material.h"
 #include "../Assets/Image.h"
 
@@ -49,14 +50,14 @@ RenderCachePtr TestRenderCache::create( Assets::AssetsWPtr assets, RenderingCont
 // ** TestRenderCache::requestInputLayout
 InputLayout TestRenderCache::requestInputLayout( const VertexFormat& format )
 {
-    InputLayouts::iterator i = m_inputLayouts.find( format );
+    InputLayouts::iterator i = m_inputLayouts.find( format.key() );
 
     if( i != m_inputLayouts.end() ) {
         return i->second;
     }
 
     InputLayout id = m_context->requestInputLayout( format );
-    m_inputLayouts[format] = id;
+    m_inputLayouts[format.key()] = id;
     return id;
 }
 
@@ -71,10 +72,13 @@ VertexBuffer_ TestRenderCache::requestVertexBuffer( const MeshHandle& mesh )
 
     NIMBLE_BREAK_IF( mesh->chunkCount() == 0, "could not cache an empty mesh" );
 
-    const Mesh::VertexBuffer& vertices = mesh->vertexBuffer();
-    VertexFormat vertexFormat( VertexFormat::Normal | VertexFormat::TexCoord0 | VertexFormat::TexCoord1 );
+    // Meshes rendered without indices store a copy of a vertex for each index
+    Mesh::VertexBuffer vertices = isIndexed( mesh ) ? mesh->vertexBuffer() : MeshProcessing::unindexVertices( mesh->vertexBuffer(), mesh->indexBuffer() );
 
-    VertexBuffer_ id = m_context->requestVertexBuffer( &vertices[0], vertices.size() * vertexFormat.vertexSize() );
+    // Convert vertices to a mesh vertex format
+    Array<u8> packed = MeshProcessing::packVertices( vertices, mesh->vertexFormat() );
+
+    VertexBuffer_ id = m_context->requestVertexBuffer( &packed[0], packed.size() );
     m_vertexBuffers[mesh.asset().uniqueId()] = id;
 
     LogVerbose( "renderCache", "vertex buffer with %d vertices created\n", vertices.size() );
@@ -93,16 +97,31 @@ IndexBuffer_ TestRenderCache::requestIndexBuffer( const MeshHandle& mesh )
 
     NIMBLE_BREAK_IF( mesh->chunkCount() == 0, "could not cache an empty mesh" );
 
-    const Mesh::IndexBuffer& indices = mesh->indexBuffer();
+    // A rendering context can't address all vertices of this mesh
+    if( !isIndexed( mesh ) ) {
+        return IndexBuffer_();
+    }
+
+    // Use 16-bit indices unless a mesh has too many vertices
+    const Mesh::IndexBuffer& indices   = mesh->indexBuffer();
+    s32                      indexSize = MeshProcessing::indexSize( mesh->vertexBuffer().size() );
+    Array<u8>                packed    = MeshProcessing::packIndices( indices, indexSize );
 
-    IndexBuffer_ id = m_context->requestIndexBuffer( &indices[0], indices.size() * sizeof( u16 ) );
+    IndexBuffer_ id = m_context->requestIndexBuffer( &packed[0], packed.size(), indexSize );
     m_indexBuffers[mesh.asset().uniqueId()] = id;
 
-    LogVerbose( "renderCache", "index buffer with %d indices created\n", indices.size() );
+    LogVerbose( "renderCache", "index buffer with %d %d-bit indices created\n", indices.size(), indexSize * 8 );
 
     return id;
 }
 
+// ** TestRenderCache::isIndexed
+bool TestRenderCache::isIndexed( const MeshHandle& mesh ) const
+{
+    // 32-bit indices are optional on OpenGL ES 2.0 devices
+    return MeshProcessing::indexSize( mesh->vertexBuffer().size() ) == sizeof( u16 ) || m_context->caps().uintIndices;
+}
+
 // ** TestRenderCache::requestMesh
 const TestRenderCache::RenderableNode* TestRenderCache::requestMesh( const MeshHandle& asset )
 {
@@ -125,12 +144,18 @@ const TestRenderCache::RenderableNode* TestRenderCache::requestMesh( const MeshH
 
     // Create a new render node
     RenderableNode* node = DC_NEW RenderableNode;
-    node->offset = 0;
-    node->count  = asset->indexBuffer().size();
+    node->offset  = 0;
+    node->count   = asset->indexBuffer().size();
+    node->indexed = isIndexed( asset );
     node->states.bindVertexBuffer( requestVertexBuffer( asset ) );
-    node->states.bindIndexBuffer( requestIndexBuffer( asset ) );
     node->states.bindInputLayout( requestInputLayout( asset->vertexFormat() ) );
 
+    if( node->indexed ) {
+        node->states.bindIndexBuffer( requestIndexBuffer( asset ) );
+    } else {
+        LogWarning( "renderCache", "32-bit indices are not supported, '%s' is rendered without an index buffer\n", asset.asset().name().c_str() );
+    }
+
     // Associate this material node with an asset identifier
     m_renderable[assetId] = node;
 
@@ -145,8 +170,9 @@ const TestRenderCache::RenderableNode* TestRenderCache::createRenderable( const
     VertexBuffer_ vertexBuffer = m_context->requestVertexBuffer( vertices, count * vertexFormat.vertexSize() );
 
     RenderableNode* node = DC_NEW RenderableNode;
-    node->offset = 0;
-    node->count  = count;
+    node->offset  = 0;
+    node->count   = count;
+    node->indexed = false;
     node->states.bindVertexBuffer( vertexBuffer );
     node->states.bindInputLayout( requestInputLayout( vertexFormat ) );
 
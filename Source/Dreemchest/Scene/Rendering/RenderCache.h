@@ -51,6 +51,7 @@ namespace Scene {
         struct RenderableNode {
             s32                         offset;         //!< Render command offset argument.
             s32                         count;          //!< Render command count argument.
+            bool                        indexed;        //!< Indicates that a renderable is rendered with an index buffer.
             StateBlock8                 states;         //!< Renderable instance states that is bound right before rendering.
         };
 
@@ -87,9 +88,12 @@ namespace Scene {
         //! Requests a new vertex buffer for a mesh asset or returns a cached one.
         virtual VertexBuffer_                   requestVertexBuffer( const MeshHandle& mesh ) NIMBLE_OVERRIDE;
 
-        //! Requests a new index buffer for a mesh asset or returns a cached one.
+        //! Requests a new index buffer for a mesh asset or returns a cached one, meshes rendered without indices have no index buffer.
         virtual IndexBuffer_                    requestIndexBuffer( const MeshHandle& mesh ) NIMBLE_OVERRIDE;
 
+        //! Returns true if a mesh can be rendered with an index buffer supported by a rendering context.
+        bool                                    isIndexed( const MeshHandle& mesh ) const;
+
         //! Creates a renderable node instance for a specified mesh or returns a cached one.
         virtual const RenderableNode*           requestMesh( const MeshHandle& asset ) NIMBLE_OVERRIDE;
 
@@ -113,7 +117,7 @@ namespace Scene {
     private:
 
         //! Container type to store mapping from a vertex format to a previously created input layout.
-        typedef HashMap<u8, InputLayout>           InputLayouts;
+        typedef HashMap<u16, InputLayout>          InputLayouts;
 
         //! Container type to store mapping from an asset id to a previously created vertex buffer.
         typedef HashMap<Assets::AssetId, VertexBuffer_> VertexBuffers;
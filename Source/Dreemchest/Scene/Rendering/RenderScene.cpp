@@ -116,6 +116,22 @@ RenderScene::CBuffer::BufferLayout RenderScene::CBuffer::ClipPlanes::Layout[] =
     , { NULL }
 };
 
+// ** RenderScene::CBuffer::Clusters::Layout
+RenderScene::CBuffer::BufferLayout RenderScene::CBuffer::Clusters::Layout[] =
+{
+      { "Clusters.grid",       Renderer::UniformElement::Vec4, offsetof( CBuffer::Clusters, grid       ), }
+    , { "Clusters.screen",     Renderer::UniformElement::Vec4, offsetof( CBuffer::Clusters, screen     ), }
+    , { "Clusters.depth",      Renderer::UniformElement::Vec4, offsetof( CBuffer::Clusters, depth      ), }
+    , { "Clusters.eye",        Renderer::UniformElement::Vec4, offsetof( CBuffer::Clusters, eye        ), }
+    , { "Clusters.forward",    Renderer::UniformElement::Vec4, offsetof( CBuffer::Clusters, forward    ), }
+    , { "Clusters.positions",  Renderer::UniformElement::Vec4, offsetof( CBuffer::Clusters, positions  ), CBuffer::Clusters::MaxLights }
+    , { "Clusters.colors",     Renderer::UniformElement::Vec4, offsetof( CBuffer::Clusters, colors     ), CBuffer::Clusters::MaxLights }
+    , { "Clusters.directions", Renderer::UniformElement::Vec4, offsetof( CBuffer::Clusters, directions ), CBuffer::Clusters::MaxLights }
+    , { "Clusters.ranges",     Renderer::UniformElement::Vec4, offsetof( CBuffer::Clusters, ranges     ), CBuffer::Clusters::TilesX * CBuffer::Clusters::TilesY * CBuffer::Clusters::Slices / 2 }
+    , { "Clusters.indices",    Renderer::UniformElement::Vec4, offsetof( CBuffer::Clusters, indices    ), CBuffer::Clusters::MaxIndices / 4 }
+    , { NULL }
+};
+
 // ** RenderScene::CBuffer::ClipPlanes::fromNearAndFar
 RenderScene::CBuffer::ClipPlanes RenderScene::CBuffer::ClipPlanes::fromNearAndFar( const Vec3& direction, const Vec3& position, f32 near, f32 far )
 {
@@ -274,11 +290,15 @@ Renderer::RenderFrame& RenderScene::captureFrame( void )
     }
 
     // Process all render systems
+    entryPoint.beginProfileScope( "RenderScene" );
+
     for( s32 i = 0, n = static_cast<s32>( m_renderSystems.size() ); i < n; i++ )
     {
         m_renderSystems[i]->render( frame, entryPoint );
     }
 
+    entryPoint.endProfileScope();
+
     return frame;
 }
 
@@ -298,7 +318,7 @@ void RenderScene::updateConstantBuffers( Renderer::RenderFrame& frame )
     for( s32 i = 0, n = cameras.count(); i < n; i++ )
     {
         CameraNode& node = cameras[i];
-        node.parameters->transform = Camera::calculateViewProjection( *node.camera, *node.viewport, node.transform->matrix() );
+        node.parameters->transform = Camera::calculateViewProjection( *node.camera, *node.viewport, node.transform->renderMatrix() );
         node.parameters->near      = node.camera->near();
         node.parameters->far       = node.camera->far();
         node.parameters->position  = node.transform->worldSpacePosition();
@@ -326,7 +346,7 @@ void RenderScene::updateConstantBuffers( Renderer::RenderFrame& frame )
     for( s32 i = 0, n = pointClouds.count(); i < n; i++ )
     {
         PointCloudNode& node = pointClouds[i];
-        node.instance.parameters->transform = node.transform->matrix();
+        node.instance.parameters->transform = node.transform->renderMatrix();
         commands.uploadConstantBuffer( node.constantBuffer, node.instance.parameters.get(), sizeof( CBuffer::Instance ) );
     }
 
@@ -336,7 +356,7 @@ void RenderScene::updateConstantBuffers( Renderer::RenderFrame& frame )
     for( s32 i = 0, n = staticMeshes.count(); i < n; i++ )
     {
         StaticMeshNode& node = staticMeshes[i];
-        node.instance.parameters->transform = node.transform->matrix();
+        node.instance.parameters->transform = node.transform->renderMatrix();
         commands.uploadConstantBuffer( node.constantBuffer, node.instance.parameters.get(), sizeof( CBuffer::Instance ) );
     }
 }
@@ -367,7 +387,7 @@ RenderScene::LightNode RenderScene::createLightNode( const Ecs::Entity& entity )
     LightNode light;
 
     light.transform         = entity.get<Transform>();
-    light.matrix            = &light.transform->matrix();
+    light.matrix            = &light.transform->renderMatrix();
     light.light             = entity.get<Light>();
     light.constantBuffer    = m_context->deprecatedRequestConstantBuffer( NULL, sizeof( CBuffer::Light ), CBuffer::Light::Layout );
     light.parameters        = DC_NEW CBuffer::Light;
@@ -381,7 +401,7 @@ RenderScene::SpriteNode RenderScene::createSpriteNode( const Ecs::Entity& entity
     SpriteNode sprite;
 
     sprite.transform         = entity.get<Transform>();
-    sprite.matrix            = &sprite.transform->matrix();
+    sprite.matrix            = &sprite.transform->renderMatrix();
     sprite.sprite            = entity.get<Sprite>();
 
     initializeInstanceNode( entity, sprite, sprite.sprite->material() );
@@ -396,7 +416,7 @@ RenderScene::CameraNode RenderScene::createCameraNode( const Ecs::Entity& entity
 
     camera.transform        = entity.get<Transform>();
     camera.viewport         = entity.get<Viewport>();
-    camera.matrix           = &camera.transform->matrix();
+    camera.matrix           = &camera.transform->renderMatrix();
     camera.camera           = entity.get<Camera>();
     camera.constantBuffer   = m_context->deprecatedRequestConstantBuffer( NULL, sizeof( CBuffer::View ), CBuffer::View::Layout );
     camera.parameters       = DC_NEW CBuffer::View;
@@ -417,12 +437,14 @@ RenderScene::StaticMeshNode RenderScene::createStaticMeshNode( const Ecs::Entity
     /*const Mesh&       data  =*/ asset.readLock();
 
     mesh.count = 0;
+    mesh.indexed = false;
     mesh.states = NULL;
 
     if( const AbstractRenderCache::RenderableNode* cached = m_cache->requestMesh( mesh.mesh->mesh() ) )
     {
         mesh.states = &cached->states;
         mesh.count  = cached->count;
+        mesh.indexed = cached->indexed;
     }
 
     return mesh;
@@ -433,7 +455,7 @@ void RenderScene::initializeInstanceNode( const Ecs::Entity& entity, InstanceNod
 {
     instance.mask                   = ~0;
     instance.transform              = entity.get<Transform>();
-    instance.matrix                 = &instance.transform->matrix();
+    instance.matrix                 = &instance.transform->renderMatrix();
     instance.constantBuffer         = m_context->deprecatedRequestConstantBuffer( NULL, sizeof( CBuffer::Instance ), CBuffer::Instance::Layout );
     instance.instance.parameters    = DC_NEW CBuffer::Instance;
     instance.material.lighting      = -1;
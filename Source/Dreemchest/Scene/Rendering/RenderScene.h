@@ -117,6 +117,29 @@ namespace Scene
                 //! Constructs a clip planes from a bounding sphere.
                 static ClipPlanes   fromSphere( const Vec3& center, f32 radius );
             };
+            struct Clusters
+            {
+                enum
+                {
+                      TilesX        = 8                             //!< A total number of horizontal screen tiles.
+                    , TilesY        = 4                             //!< A total number of vertical screen tiles.
+                    , Slices        = 8                             //!< A total number of depth slices.
+                    , MaxLights     = 64                            //!< A maximum number of lights that are assigned to clusters.
+                    , MaxIndices    = 1024                          //!< A maximum total number of light indices.
+                };
+
+                static BufferLayout Layout[];
+                Vec4                grid;                           //!< A cluster grid size and a total number of lights.
+                Vec4                screen;                         //!< A viewport rectangle in pixels.
+                Vec4                depth;                          //!< Near and far planes followed by a slice scale and bias.
+                Vec4                eye;                            //!< A camera position.
+                Vec4                forward;                        //!< A camera view direction.
+                Vec4                positions[MaxLights];           //!< Light positions and ranges.
+                Vec4                colors[MaxLights];              //!< Light colors and intensities.
+                Vec4                directions[MaxLights];          //!< Spot light directions and cutoff cosines, point lights have a negative cutoff.
+                Vec4                ranges[TilesX * TilesY * Slices / 2];   //!< An offset and count of light indices for each pair of clusters.
+                Vec4                indices[MaxIndices / 4];        //!< Light indices packed four per vector.
+            };
         };
 
         //! Base class for all renderable entities.
@@ -181,6 +204,7 @@ namespace Scene
         {
             const StaticMesh*                   mesh;               //!< Mesh component.
             s32                                 count;              //!< A total number of indices in a mesh.
+            bool                                indexed;            //!< Indicates that a mesh is rendered with an index buffer.
             const Renderer::StateBlock*   states;             //!< A renderable state.
         };
 
@@ -199,6 +223,9 @@ namespace Scene
         //! A fixed array with sprite nodes inside.
         typedef FixedArray<SpriteNode>          Sprites;
 
+        //! An array of node indices used to emit a visible subset of nodes.
+        typedef Array<s32>                      NodeIndices;
+
         //! Returns parent scene.
         SceneWPtr                               scene( void ) const;
 
@@ -30,6 +30,111 @@ DC_BEGIN_DREEMCHEST
 
 namespace Scene {
 
+// ---------------------------------------------------------------- DrawSortKeyBuilder ---------------------------------------------------------------- //
+
+// ** DrawSortKeyBuilder::build
+u64 DrawSortKeyBuilder::build( const RenderScene::InstanceNode& instance, const Renderer::StateBlock* states, u8 layer, f32 depth ) const
+{
+    // A program may be bound by either a renderable or a material, a program bound by a pass is the same for all draw calls
+    ResourceId program = findResource( states, Renderer::State::BindProgram );
+    if( !program ) {
+        program = findResource( instance.material.states, Renderer::State::BindProgram );
+    }
+
+    // An input layout is bound by a renderable state block
+    ResourceId inputLayout = findResource( states, Renderer::State::SetInputLayout );
+
+    // Materials are identified by a constant buffer, or by a state block when a material has no constants
+    u64 material = findResource( instance.material.states, Renderer::State::BindConstantBuffer, Constants::Material );
+    if( !material && instance.material.states ) {
+        material = static_cast<u64>( reinterpret_cast<size_t>( instance.material.states ) >> 4 );
+    }
+
+    // Quantize a normalized depth value
+    u64 maxDepth  = (u64( 1 ) << DepthBits) - 1;
+    u64 quantized = static_cast<u64>( min2( max2( depth, 0.0f ), 1.0f ) * maxDepth );
+
+    // Translucent instances should be rendered after all opaque ones
+    bool translucent = instance.material.rendering == RenderingMode::Translucent || instance.material.rendering == RenderingMode::Additive;
+
+    u64 key = u64( layer & ((1 << LayerBits) - 1) );
+    key = (key << 1) | (translucent ? 1 : 0);
+
+    if( translucent ) {
+        // Back-to-front order goes first, state changes are only reduced for draws at the same depth
+        key = (key << DepthBits)        | (maxDepth - quantized);
+        key = (key << ProgramBits)      | (program & ((1 << ProgramBits) - 1));
+        key = (key << InputLayoutBits)  | (inputLayout & ((1 << InputLayoutBits) - 1));
+        key = (key << MaterialBits)     | (material & ((1 << MaterialBits) - 1));
+    } else {
+        // Group draws by state first and render each group front-to-back
+        key = (key << ProgramBits)      | (program & ((1 << ProgramBits) - 1));
+        key = (key << InputLayoutBits)  | (inputLayout & ((1 << InputLayoutBits) - 1));
+        key = (key << MaterialBits)     | (material & ((1 << MaterialBits) - 1));
+        key = (key << DepthBits)        | quantized;
+    }
+
+    return key;
+}
+
+// ** DrawSortKeyBuilder::findResource
+ResourceId DrawSortKeyBuilder::findResource( const Renderer::StateBlock* states, u8 type, s32 index )
+{
+    if( !states ) {
+        return 0;
+    }
+
+    for( s32 i = 0, n = states->stateCount(); i < n; i++ ) {
+        const Renderer::State& state = states->state( i );
+
+        if( state.type != type ) {
+            continue;
+        }
+
+        if( index >= 0 && state.data.index != index ) {
+            continue;
+        }
+
+        return state.resourceId;
+    }
+
+    return 0;
+}
+
+// ------------------------------------------------------------------- DrawSorting ------------------------------------------------------------------- //
+
+// ** DrawSorting::DrawSorting
+DrawSorting::DrawSorting( void )
+    : builder( NULL )
+    , eye( Vec3::zero() )
+    , direction( Vec3::axisZ() )
+    , far( 1.0f )
+    , layer( 0 )
+    , sorted( false )
+{
+}
+
+// ** DrawSorting::depth
+f32 DrawSorting::depth( const Vec3& point ) const
+{
+    Vec3 delta = point - eye;
+    return (delta.x * direction.x + delta.y * direction.y + delta.z * direction.z) / far;
+}
+
+// ** DrawSorting::fromCamera
+DrawSorting DrawSorting::fromCamera( const Camera& camera, const Transform& transform, u8 layer )
+{
+    DrawSorting sorting;
+    sorting.eye       = transform.worldSpacePosition();
+    sorting.direction = -transform.axisZ();
+    sorting.far       = camera.far();
+    sorting.layer     = layer;
+    sorting.sorted    = true;
+    return sorting;
+}
+
+// ------------------------------------------------------------------ RenderPassBase ------------------------------------------------------------------ //
+
 // ** RenderPassBase::RenderPassBase
 RenderPassBase::RenderPassBase( Renderer::RenderingContext& context, RenderScene& renderScene )
     : m_context( context )
@@ -53,63 +158,171 @@ void RenderPassBase::renderWithColor( RenderFrame& frame, RenderCommandBuffer& c
     state->bindConstantBuffer( m_materialCBuffer, Constants::Material );
 
     // Emit required render operations
+    commands.beginProfileScope( "RenderPass" );
     begin( frame, commands, stateStack );
     emitRenderOperations( frame, commands, stateStack );
     end( frame, commands, stateStack );
+    commands.endProfileScope();
+}
+
+// ** RenderPassBase::setSorting
+void RenderPassBase::setSorting( const DrawSorting& value )
+{
+    m_sorting = value;
+}
+
+// ** RenderPassBase::sorting
+const DrawSorting& RenderPassBase::sorting( void ) const
+{
+    return m_sorting;
+}
+
+// ** RenderPassBase::sortKey
+u64 RenderPassBase::sortKey( const DrawSorting* sorting, const RenderScene::InstanceNode& instance, const Renderer::StateBlock* states )
+{
+    static DrawSortKeyBuilder defaultBuilder;
+
+    if( !sorting ) {
+        return 0;
+    }
+
+    const DrawSortKeyBuilder* builder = sorting->builder ? sorting->builder : &defaultBuilder;
+    return builder->build( instance, states, sorting->layer, sorting->depth( *instance.matrix * Vec3::zero() ) );
+}
+
+// ** RenderPassBase::sortedDrawLess
+bool RenderPassBase::sortedDrawLess( const SortedDraw& a, const SortedDraw& b )
+{
+    return a.key < b.key;
 }
 
 // ** RenderPassBase::emitStaticMeshes
-void RenderPassBase::emitStaticMeshes( const RenderScene::StaticMeshes& staticMeshes, RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, u8 mask )
+void RenderPassBase::emitStaticMeshes( const RenderScene::StaticMeshes& staticMeshes, RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, u8 mask, const DrawSorting* sorting, const RenderScene::NodeIndices* visible )
 {
-    // Process each mesh entity
-    for( s32 i = 0, n = staticMeshes.count(); i < n; i++ ) {
-        // Get mesh entity by index
-        const RenderScene::StaticMeshNode& mesh = staticMeshes[i];
+    // Either process each mesh entity or only the ones from a visible list
+    s32 count = visible ? static_cast<s32>( visible->size() ) : staticMeshes.count();
+
+    // Emit meshes in an insertion order when a sorted queue is not requested
+    if( !sorting || !sorting->sorted ) {
+        for( s32 i = 0; i < count; i++ ) {
+            // Get mesh entity by index
+            const RenderScene::StaticMeshNode& mesh = staticMeshes[visible ? (*visible)[i] : i];
+
+            // Skip all meshes that do not pass a specified mask
+            if( (mesh.mask & mask) == 0 ) {
+                continue;
+            }
+
+            emitStaticMesh( mesh, commands, stateStack, sortKey( sorting, mesh, mesh.states ) );
+        }
+        return;
+    }
+
+    // Queue all meshes that pass a mask with their sorting keys
+    SortedDraws queue;
+    queue.reserve( count );
+
+    for( s32 i = 0; i < count; i++ ) {
+        s32 index = visible ? (*visible)[i] : i;
+        const RenderScene::StaticMeshNode& mesh = staticMeshes[index];
 
-        // Skip all meshes that do not pass a specified mask
         if( (mesh.mask & mask) == 0 ) {
             continue;
         }
 
-        StateScope materialStates = stateStack.push( mesh.material.states );
-        StateScope renderableStates = stateStack.push( mesh.states );
+        SortedDraw draw;
+        draw.key   = sortKey( sorting, mesh, mesh.states );
+        draw.index = index;
+        queue.push_back( draw );
+    }
 
-        StateScope instance = stateStack.newScope();
-        instance->bindConstantBuffer( mesh.constantBuffer, Constants::Instance );
+    // Sort the queue and emit meshes in a key order
+    std::sort( queue.begin(), queue.end(), sortedDrawLess );
 
-        if( mesh.material.lighting == LightingModel::Unlit ) {
-            instance->disableFeatures( ShaderAmbientColor );
-        }
+    for( s32 i = 0, n = static_cast<s32>( queue.size() ); i < n; i++ ) {
+        emitStaticMesh( staticMeshes[queue[i].index], commands, stateStack, queue[i].key );
+    }
+}
+
+// ** RenderPassBase::emitStaticMesh
+void RenderPassBase::emitStaticMesh( const RenderScene::StaticMeshNode& mesh, RenderCommandBuffer& commands, StateStack& stateStack, u64 sorting )
+{
+    StateScope materialStates = stateStack.push( mesh.material.states );
+    StateScope renderableStates = stateStack.push( mesh.states );
+
+    StateScope instance = stateStack.newScope();
+    instance->bindConstantBuffer( mesh.constantBuffer, Constants::Instance );
 
-        commands.drawIndexed( 0, Renderer::PrimTriangles, 0, mesh.count );
+    if( mesh.material.lighting == LightingModel::Unlit ) {
+        instance->disableFeatures( ShaderAmbientColor );
+    }
+
+    // Meshes that need 32-bit indices are rendered without indices when a rendering context does not support them
+    if( mesh.indexed ) {
+        commands.drawIndexed( sorting, Renderer::PrimTriangles, 0, mesh.count );
+    } else {
+        commands.drawPrimitives( sorting, Renderer::PrimTriangles, 0, mesh.count );
     }
 }
 
 // ** RenderPassBase::emitPointClouds
-void RenderPassBase::emitPointClouds( const RenderScene::PointClouds& pointClouds, RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, u8 mask )
+void RenderPassBase::emitPointClouds( const RenderScene::PointClouds& pointClouds, RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, u8 mask, const DrawSorting* sorting )
 {
-    // Process each active point cloud
+    // Emit point clouds in an insertion order when a sorted queue is not requested
+    if( !sorting || !sorting->sorted ) {
+        for( s32 i = 0, n = pointClouds.count(); i < n; i++ ) {
+            // Get a point cloud by index
+            const RenderScene::PointCloudNode& pointCloud = pointClouds[i];
+
+            // Skip all meshes that do not pass a specified mask
+            if( (pointCloud.mask & mask) == 0 ) {
+                continue;
+            }
+
+            emitPointCloud( pointCloud, commands, stateStack, sortKey( sorting, pointCloud, pointCloud.states ) );
+        }
+        return;
+    }
+
+    // Queue all point clouds that pass a mask with their sorting keys
+    SortedDraws queue;
+    queue.reserve( pointClouds.count() );
+
     for( s32 i = 0, n = pointClouds.count(); i < n; i++ ) {
-        // Get a point cloud by index
         const RenderScene::PointCloudNode& pointCloud = pointClouds[i];
 
-        // Skip all meshes that do not pass a specified mask
         if( (pointCloud.mask & mask) == 0 ) {
             continue;
         }
 
-        StateScope materialStates = stateStack.push( pointCloud.material.states );
-        StateScope renderableStates = stateStack.push( pointCloud.states );
+        SortedDraw draw;
+        draw.key   = sortKey( sorting, pointCloud, pointCloud.states );
+        draw.index = i;
+        queue.push_back( draw );
+    }
 
-        StateScope instance = stateStack.newScope();
-        instance->bindConstantBuffer( pointCloud.constantBuffer, Constants::Instance );
+    // Sort the queue and emit point clouds in a key order
+    std::sort( queue.begin(), queue.end(), sortedDrawLess );
 
-        if( pointCloud.material.lighting == LightingModel::Unlit ) {
-            instance->disableFeatures( ShaderAmbientColor );
-        }
+    for( s32 i = 0, n = static_cast<s32>( queue.size() ); i < n; i++ ) {
+        emitPointCloud( pointClouds[queue[i].index], commands, stateStack, queue[i].key );
+    }
+}
+
+// ** RenderPassBase::emitPointCloud
+void RenderPassBase::emitPointCloud( const RenderScene::PointCloudNode& pointCloud, RenderCommandBuffer& commands, StateStack& stateStack, u64 sorting )
+{
+    StateScope materialStates = stateStack.push( pointCloud.material.states );
+    StateScope renderableStates = stateStack.push( pointCloud.states );
 
-        commands.drawPrimitives( 0, Renderer::PrimPoints, 0, pointCloud.count );
+    StateScope instance = stateStack.newScope();
+    instance->bindConstantBuffer( pointCloud.constantBuffer, Constants::Instance );
+
+    if( pointCloud.material.lighting == LightingModel::Unlit ) {
+        instance->disableFeatures( ShaderAmbientColor );
     }
+
+    commands.drawPrimitives( sorting, Renderer::PrimPoints, 0, pointCloud.count );
 }
 
 // ** RenderPassBase::diffuseMaterial
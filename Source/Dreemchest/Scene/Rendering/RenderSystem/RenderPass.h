@@ -36,6 +36,53 @@ DC_BEGIN_DREEMCHEST
 
 namespace Scene
 {
+    //! Packs a draw call state and view depth into a 64-bit sorting key.
+    /*!
+    A default key layout from the most significant bit is: 4-bit layer, translucency bit,
+    and then program (12 bits), input layout (8 bits), material (15 bits) and quantized view depth (24 bits).
+    Opaque draws are sorted by state and front-to-back inside a state group, translucent
+    draws put an inverted depth right after the translucency bit to be sorted back-to-front.
+    */
+    class DrawSortKeyBuilder {
+    public:
+
+        //! Key field widths used by a default key layout.
+        enum {
+              LayerBits         = 4     //!< A number of bits used by a layer.
+            , ProgramBits       = 12    //!< A number of bits used by a program identifier.
+            , InputLayoutBits   = 8     //!< A number of bits used by an input layout identifier.
+            , MaterialBits      = 15    //!< A number of bits used by a material identifier.
+            , DepthBits         = 24    //!< A number of bits used by a quantized depth.
+        };
+
+        virtual                                 ~DrawSortKeyBuilder( void ) {}
+
+        //! Returns a sorting key for an instance rendered with a specified renderable state and normalized view depth.
+        virtual u64                             build( const RenderScene::InstanceNode& instance, const Renderer::StateBlock* states, u8 layer, f32 depth ) const;
+
+        //! Returns a resource identifier bound by a state block or 0 if there is no such state.
+        static ResourceId                       findResource( const Renderer::StateBlock* states, u8 type, s32 index = -1 );
+    };
+
+    //! Sorting parameters used by render passes when emitting scene draw calls.
+    struct DrawSorting {
+                                                //! Constructs a DrawSorting instance that emits draw calls unsorted.
+                                                DrawSorting( void );
+
+        //! Returns a normalized view depth of a specified point.
+        f32                                     depth( const Vec3& point ) const;
+
+        //! Constructs sorting parameters that sort draw calls relative to a camera.
+        static DrawSorting                      fromCamera( const Camera& camera, const Transform& transform, u8 layer = 0 );
+
+        const DrawSortKeyBuilder*               builder;            //!< A sort key builder, a default one is used when NULL.
+        Vec3                                    eye;                //!< A view position.
+        Vec3                                    direction;          //!< A view direction.
+        f32                                     far;                //!< A view distance used to normalize depth.
+        u8                                      layer;              //!< A layer written to the most significant key bits.
+        bool                                    sorted;             //!< Emit draw calls into a key-sorted queue instead of an insertion order.
+    };
+
     //! Performs a single rendering pass.
     class RenderPassBase {
     public:
@@ -55,11 +102,20 @@ namespace Scene
         //! Ends a pass rendering.
         virtual void                            end( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack ) {}
 
-        //! Emits rendering operations for static meshes that reside in scene.
-        static void                             emitStaticMeshes( const RenderScene::StaticMeshes& staticMeshes, RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, u8 mask = ~0 );
+        //! Sets draw call sorting parameters used by this pass.
+        void                                    setSorting( const DrawSorting& value );
+
+        //! Returns draw call sorting parameters used by this pass.
+        const DrawSorting&                      sorting( void ) const;
+
+        //! Emits rendering operations for static meshes that reside in scene, only meshes from a visible list are emitted when one is passed.
+        static void                             emitStaticMeshes( const RenderScene::StaticMeshes& staticMeshes, RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, u8 mask = ~0, const DrawSorting* sorting = NULL, const RenderScene::NodeIndices* visible = NULL );
 
         //! Emits rendering operations for point clouds that reside in scene.
-        static void                             emitPointClouds( const RenderScene::PointClouds& pointClouds, RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, u8 mask = ~0 );
+        static void                             emitPointClouds( const RenderScene::PointClouds& pointClouds, RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, u8 mask = ~0, const DrawSorting* sorting = NULL );
+
+        //! Returns a sorting key for an instance, or 0 if sorting is disabled.
+        static u64                              sortKey( const DrawSorting* sorting, const RenderScene::InstanceNode& instance, const Renderer::StateBlock* states );
 
         //! Constructs a material constant buffer with a specified color.
         static RenderScene::CBuffer::Material   diffuseMaterial( const Rgba& color );
@@ -67,11 +123,32 @@ namespace Scene
         //! Constructs a view constant buffer with an ortho projection.
         static RenderScene::CBuffer::View       orthoView( const Viewport& viewport );
 
+    private:
+
+        //! A queued draw call with a sorting key.
+        struct SortedDraw {
+            u64                                 key;                //!< A draw call sorting key.
+            s32                                 index;              //!< A scene node index.
+        };
+
+        //! Container type to store queued draw calls.
+        typedef Array<SortedDraw>               SortedDraws;
+
+        //! Emits rendering operations for a single static mesh.
+        static void                             emitStaticMesh( const RenderScene::StaticMeshNode& mesh, RenderCommandBuffer& commands, StateStack& stateStack, u64 sorting );
+
+        //! Emits rendering operations for a single point cloud.
+        static void                             emitPointCloud( const RenderScene::PointCloudNode& pointCloud, RenderCommandBuffer& commands, StateStack& stateStack, u64 sorting );
+
+        //! Compares two queued draw calls by a sorting key.
+        static bool                             sortedDrawLess( const SortedDraw& a, const SortedDraw& b );
+
     protected:
 
         RenderingContext&                       m_context;          //!< A parent rendering context.
         RenderScene&                            m_renderScene;      //!< Parent render scene.
         ConstantBuffer_                         m_materialCBuffer;  //!< A material constant buffer.
+        DrawSorting                             m_sorting;          //!< Draw call sorting parameters.
     };
 
 } // namespace Scene
@@ -31,10 +31,11 @@ DC_BEGIN_DREEMCHEST
 namespace Scene {
 
 // ** RenderSystemBase::RenderSystemBase
-RenderSystemBase::RenderSystemBase( RenderingContext& context, RenderScene& renderScene, Ecs::IndexPtr cameras )
+RenderSystemBase::RenderSystemBase( RenderingContext& context, RenderScene& renderScene, Ecs::IndexPtr cameras, CString name )
     : m_context( context )
     , m_renderScene( renderScene )
     , m_cameras( cameras )
+    , m_name( name )
 {
 }
 
@@ -47,6 +48,12 @@ void RenderSystemBase::render( RenderFrame& frame, RenderCommandBuffer& commands
     // Get a state stack
     StateStack& stateStack = frame.stateStack();
 
+    // All cameras rendered by this system share a single profiler scope
+    commands.beginProfileScope( m_name );
+
+    // Update a state shared by all cameras
+    beginFrame( frame, commands );
+
     // Process each camera
     for( Ecs::EntitySet::const_iterator i = cameras.begin(), end = cameras.end(); i != end; ++i ) {
         // Get the camera entity
@@ -72,6 +79,8 @@ void RenderSystemBase::render( RenderFrame& frame, RenderCommandBuffer& commands
         // Emit render operations for this camera
         emitRenderOperations(frame, cameraCommands, stateStack, entity, camera, transform);
     }
+
+    commands.endProfileScope();
 }
 
 } // namespace Scene
@@ -38,7 +38,7 @@ namespace Scene {
     public:
 
                                 //! Constructs the RenderSystemBase instance.
-                                RenderSystemBase( RenderingContext& context, RenderScene& renderScene, Ecs::IndexPtr cameras );
+                                RenderSystemBase( RenderingContext& context, RenderScene& renderScene, Ecs::IndexPtr cameras, CString name );
         virtual                 ~RenderSystemBase( void ) {}
 
         //! Renders all active cameras to their viewports.
@@ -46,6 +46,9 @@ namespace Scene {
 
     protected:
 
+        //! Called once per rendered frame before any camera is processed, per-frame state of a render system should be updated here.
+        virtual void            beginFrame( RenderFrame& frame, RenderCommandBuffer& commands ) {}
+
         //! Emits rendering operations to a command buffer for a specified camera.
         virtual void            emitRenderOperations( RenderFrame& frame, RenderCommandBuffer& commands, StateStack& stateStack, const Ecs::Entity& entity, const Camera& camera, const Transform& transform ) {}
 
@@ -54,6 +57,7 @@ namespace Scene {
         RenderingContext&       m_context;      //!< Parent rendering context.
         RenderScene&            m_renderScene;  //!< Parent render scene.
         Ecs::IndexPtr           m_cameras;        //!< All active cameras that are processed by this render system.
+        CString                 m_name;         //!< A render system name used as a profiler scope name.
     };
 
     //! Generic render system class.
@@ -62,7 +66,7 @@ namespace Scene {
     public:
 
                                 //! Constructs RenderSystem instance
-                                RenderSystem( RenderingContext& context, RenderScene& renderScene );
+                                RenderSystem( RenderingContext& context, RenderScene& renderScene, CString name );
 
     protected:
 
@@ -75,8 +79,8 @@ namespace Scene {
 
     // ** RenderSystem::RenderSystem
     template<typename TRenderer>
-    RenderSystem<TRenderer>::RenderSystem( RenderingContext& context, RenderScene& renderScene )
-        : RenderSystemBase( context, renderScene, renderScene.scene()->ecs()->requestIndex( "RenderSystemCameras", Ecs::Aspect::all<Camera, Transform, Viewport, TRenderer>() ) )
+    RenderSystem<TRenderer>::RenderSystem( RenderingContext& context, RenderScene& renderScene, CString name )
+        : RenderSystemBase( context, renderScene, renderScene.scene()->ecs()->requestIndex( "RenderSystemCameras", Ecs::Aspect::all<Camera, Transform, Viewport, TRenderer>() ), name )
     {
     }
 
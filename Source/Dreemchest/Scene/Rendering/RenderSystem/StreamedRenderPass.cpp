@@ -33,10 +33,12 @@ namespace Scene {
 // ** StreamedRenderPassBase::StreamedRenderPassBase
 StreamedRenderPassBase::StreamedRenderPassBase( RenderingContext& context, RenderScene& renderScene, s32 maxVerticesInBatch )
     : RenderPassBase( context, renderScene )
+    , m_vertexBufferOffset( 0 )
     , m_maxVerticesInBatch( maxVerticesInBatch )
 {
-    // Request a vertex buffer used for rendering
-    m_vertexBuffer = m_context.requestVertexBuffer( NULL, m_maxVerticesInBatch * VertexFormat( VertexFormat::Position | VertexFormat::Color | VertexFormat::TexCoord0 ).vertexSize() );
+    // Request a vertex buffer that is shared by consequent batches, so each flush writes to a region not used by previous draw calls
+    m_vertexBufferSize = m_maxVerticesInBatch * VertexFormat( VertexFormat::Position | VertexFormat::Color | VertexFormat::TexCoord0 ).vertexSize() * BatchesPerBuffer;
+    m_vertexBuffer     = m_context.requestVertexBuffer( NULL, m_vertexBufferSize );
 }
 
 // ** StreamedRenderPassBase::end
@@ -61,7 +63,7 @@ void StreamedRenderPassBase::beginBatch(RenderFrame& frame, RenderCommandBuffer&
     m_activeBatch.capacity      = actualCapacity;
     m_activeBatch.primitive     = primitive;
     m_activeBatch.vertexFormat  = vertexFormat;
-    m_activeBatch.stream        = frame.allocate( vertexFormat.vertexSize() * actualCapacity );
+    m_activeBatch.stream        = frame.allocateUpload( vertexFormat.vertexSize() * actualCapacity );
 }
 
 // ** StreamedRenderPassBase::restartBatch
@@ -90,9 +92,21 @@ void StreamedRenderPassBase::flush( RenderCommandBuffer& commands, StateStack& s
     state->bindVertexBuffer( m_vertexBuffer );
     state->bindInputLayout( m_context.requestInputLayout( m_activeBatch.vertexFormat ) );
 
-    // Upload vertex data to a GPU buffer and emit a draw primitives command
-    commands.uploadVertexBuffer( m_vertexBuffer, m_activeBatch.stream, m_activeBatch.size * m_activeBatch.vertexFormat.vertexSize() );
-    commands.drawPrimitives( 0, m_activeBatch.primitive, 0, m_activeBatch.size );
+    // Place a batch right after the previous one, or restart from the beginning of a buffer
+    s32 vertexSize = m_activeBatch.vertexFormat.vertexSize();
+    s32 size       = m_activeBatch.size * vertexSize;
+    s32 first      = (m_vertexBufferOffset + vertexSize - 1) / vertexSize;
+
+    if( first * vertexSize + size > m_vertexBufferSize ) {
+        first = 0;
+    }
+    NIMBLE_ABORT_IF( size > m_vertexBufferSize, "a batch does not fit a vertex buffer" );
+
+    m_vertexBufferOffset = first * vertexSize + size;
+
+    // Upload vertex data directly from an upload ring and emit a draw primitives command
+    commands.uploadVertexBuffer( m_vertexBuffer, Renderer::persistentPointer( m_activeBatch.stream ), size, first * vertexSize );
+    commands.drawPrimitives( 0, m_activeBatch.primitive, first, m_activeBatch.size );
 
     // Reset an active batch state
     m_activeBatch = ActiveBatch();
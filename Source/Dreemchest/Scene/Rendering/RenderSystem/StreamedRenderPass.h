@@ -105,7 +105,12 @@ namespace Scene {
             void*                       stream;                 //!< A batch vertex stream.
         };
 
+        //! A total number of batches that share a single vertex buffer before it is reused from the beginning.
+        enum { BatchesPerBuffer = 8 };
+
         VertexBuffer_                   m_vertexBuffer;            //!< An intermediate vertex buffer used for batching.
+        s32                             m_vertexBufferSize;     //!< A total vertex buffer size in bytes.
+        s32                             m_vertexBufferOffset;   //!< A vertex buffer offset to upload a next batch at.
         s32                             m_maxVerticesInBatch;   //! A maximum number of vertices that can be rendered in a single batch
         mutable ActiveBatch             m_activeBatch;          //!< An active batch state.
     };
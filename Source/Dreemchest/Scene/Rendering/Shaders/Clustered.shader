@@ -0,0 +1,139 @@
+// shadertype=glsl
+
+[Features]
+F_VertexNormal         = vertexNormal
+F_VertexColor          = vertexColor
+F_DiffuseTexture    = texture0
+
+[VertexShader]
+varying vec3 wsVertex;
+
+#if defined( F_VertexColor )
+varying vec4 v_Color;
+#endif  /*  F_VertexColor    */
+
+#if defined( F_DiffuseTexture )
+varying vec2 v_TexCoord0;
+#endif    /*    F_DiffuseTexture    */
+
+#if defined( F_VertexNormal )
+varying vec3 wsNormal;
+#endif  /*  F_VertexNormal    */
+
+void main()
+{
+    vec4 vertex = Instance.transform * gl_Vertex;
+    
+    gl_Position     = View.transform * vertex;
+    gl_PointSize    = 5.0;
+
+    wsVertex = vertex.xyz;
+
+#if defined( F_VertexColor )
+    v_Color = gl_Color;
+#endif  /*  F_VertexColor    */
+
+#if defined( F_VertexNormal )
+    wsNormal = (Instance.transform * vec4( gl_Normal, 0.0)).xyz;
+#endif  /*  F_VertexNormal    */
+
+#if defined( F_DiffuseTexture )
+    v_TexCoord0        = gl_MultiTexCoord0.xy;
+#endif    /*    F_DiffuseTexture    */
+}     
+
+[FragmentShader]
+varying vec3 wsVertex;
+
+#if defined( F_VertexColor )
+varying vec4 v_Color;
+#endif  /*  F_VertexColor    */
+
+#if defined( F_VertexNormal )
+varying vec3 wsNormal;
+#endif  /*  F_VertexNormal    */
+
+#if defined( F_DiffuseTexture )
+uniform sampler2D u_DiffuseTexture;
+varying vec2 v_TexCoord0;
+#endif    /*    F_DiffuseTexture    */
+
+//! Computes a distance attenuation of a light source between point 'a' and 'b'
+float distanceAttenuation( vec3 a, vec3 b, float range, float constant, float linear, float quadratic )
+{
+    float d = length( a - b ) / range;
+    return 1.0 / (constant + linear * d + quadratic * d * d);
+}
+
+//! Computes a point light intensity at specified point
+float pointLightIntensity( vec3 point, vec3 light, vec3 normal )
+{
+    vec3 dir = normalize( light - point );
+    return max( dot( normal, dir ), 0.0 );
+}
+
+//! Computes a spot light intensity at specified point
+float spotLightIntensity( vec3 point, vec3 light, vec3 normal, vec3 direction, float cutoff )
+{
+    vec3  dir      = normalize( light - point );
+    float lambert = max( dot( normal, dir ), 0.0 );
+    float spot      = max( dot( direction, dir ), 0.0 );
+    float falloff = max( 1.0 - (1.0 - spot) * 1.0 / (1.0 - cutoff), 0.0 );
+
+    return lambert * falloff;
+}
+
+//! Returns an index of a cluster that contains a fragment
+int clusterIndex( vec2 fragCoord, vec3 point )
+{
+    // Locate a screen tile
+    vec2 tile = clamp( floor( (fragCoord - Clusters.screen.xy) / Clusters.screen.zw * Clusters.grid.xy ), vec2( 0.0 ), Clusters.grid.xy - 1.0 );
+
+    // Locate a logarithmic depth slice
+    float depth = max( dot( point - Clusters.eye.xyz, Clusters.forward.xyz ), Clusters.depth.x );
+    float slice = clamp( floor( log( depth ) * Clusters.depth.z - Clusters.depth.w ), 0.0, Clusters.grid.z - 1.0 );
+
+    return int( (slice * Clusters.grid.y + tile.y) * Clusters.grid.x + tile.x );
+}
+
+void main()
+{
+    vec4 diffuseColor = Material.diffuse;
+    vec4 lightColor   = vec4( 0.0, 0.0, 0.0, 1.0 );
+
+#if defined( F_VertexColor )
+    diffuseColor = diffuseColor * v_Color;
+#endif  /*  F_VertexColor    */
+
+#if defined( F_DiffuseTexture )
+    diffuseColor = diffuseColor * texture2D( u_DiffuseTexture, v_TexCoord0 );
+#endif    /*    F_DiffuseTexture    */
+
+#if defined( F_VertexNormal )
+    vec3 normal  = normalize( wsNormal );
+    int  cluster = clusterIndex( gl_FragCoord.xy, wsVertex );
+
+    // Each vector stores an offset and count for two clusters
+    vec4 packed = Clusters.ranges[cluster / 2];
+    vec2 range  = (cluster - (cluster / 2) * 2 == 0) ? packed.xy : packed.zw;
+    int  first  = int( range.x );
+    int  count  = int( range.y );
+
+    // Accumulate all lights assigned to this cluster
+    for( int i = first; i < first + count; i++ ) {
+        int  index     = int( Clusters.indices[i / 4][i - (i / 4) * 4] );
+        vec4 position  = Clusters.positions[index];
+        vec4 color     = Clusters.colors[index];
+        vec4 direction = Clusters.directions[index];
+
+        float attenuation = distanceAttenuation( wsVertex, position.xyz, position.w, 1.0, 0.0, 25.0 );
+        float intensity   = direction.w < -1.0 ? pointLightIntensity( wsVertex, position.xyz, normal ) : spotLightIntensity( wsVertex, position.xyz, normal, direction.xyz, direction.w );
+
+        lightColor.rgb += color.rgb * color.w * intensity * attenuation;
+    }
+#endif  /*  F_VertexNormal    */
+
+    vec4 finalColor = lightColor * diffuseColor;
+
+    gl_FragColor = finalColor;
+}
@@ -0,0 +1,26 @@
+// shadertype=glsl
+
+[VertexShader]
+varying float v_Shade;
+
+void main()
+{
+    vec4 vertex = gl_Vertex;
+
+    // Blend a vertex height to a coarser LOD grid while approaching a distance this node is merged at
+    float morph = clamp( (distance( vertex.xyz, View.position ) - Terrain.morph.x) * Terrain.morph.y, 0.0, 1.0 );
+    vertex.y   += (gl_MultiTexCoord1.x - vertex.y) * morph;
+
+    // Slopes are darkened a bit, so the terrain shape is visible without lighting
+    v_Shade = 0.5 + 0.5 * gl_Normal.y;
+
+    gl_Position = View.transform * vertex;
+}
+
+[FragmentShader]
+varying float v_Shade;
+
+void main()
+{
+    gl_FragColor = vec4( Terrain.color.rgb * v_Shade, Terrain.color.a );
+}
@@ -62,7 +62,7 @@ s32 Resources::bytesAllocatedForMesh( const Mesh& asset )
     s32 result = 0;
 
     result += asset.vertexBuffer().size() * sizeof( Mesh::Vertex );
-    result += asset.indexBuffer().size() * sizeof( u16 );
+    result += asset.indexBuffer().size() * sizeof( Mesh::IndexBuffer::value_type );
 
     return result + sizeof( Mesh );
 }
@@ -89,6 +89,10 @@ s32 Resources::bytesAllocatedForMaterial( const Material& asset )
 
 // ** Scene::Scene
 Scene::Scene( void )
+    : m_fixedTimeStep( 0, INT_MAX )
+    , m_maxSimulationSteps( 5 )
+    , m_timeFraction( 0.0f )
+    , m_interpolationFactor( 1.0f )
 {
     // Construct entity component system instance
     m_ecs = Ecs::Ecs::create();
@@ -100,7 +104,8 @@ Scene::Scene( void )
     m_spatial   = DC_NEW Spatial( this );
 
     // Create system groups.
-    m_updateSystems = m_ecs->createGroup( "Update", ~0 );
+    m_simulationSystems = m_ecs->createGroup( "Simulation", SimulationSystems );
+    m_updateSystems     = m_ecs->createGroup( "Update", UpdateSystems );
 
     // Add default update systems.
     addSystem<AffineTransformSystem>();
@@ -123,8 +128,73 @@ void Scene::update( u32 currentTime, f32 dt )
         m_inputSystems[i]->update();
     };
 
+    // Run simulation systems with a fixed time step
+    if( m_fixedTimeStep.dt() > 0 ) {
+        simulateFixedSteps( currentTime, dt );
+    } else {
+        m_ecs->update( currentTime, dt, SimulationSystems );
+    }
+
     // Update all entity systems
-    m_ecs->update( currentTime, dt, ~0 );
+    m_ecs->update( currentTime, dt, UpdateSystems );
+
+    // An ECS is updated several times per frame, so removed entities are destroyed here within a frame budget
+    m_ecs->destroyRemovedEntities( m_ecs->destructionBudget() );
+}
+
+// ** Scene::simulateFixedSteps
+void Scene::simulateFixedSteps( u32 currentTime, f32 dt )
+{
+    WeakPtr<AffineTransformSystem> transforms = system<AffineTransformSystem>();
+
+    // A timer works with milliseconds, so keep a fraction that did not fit for the next update
+    m_timeFraction += dt * 1000.0f;
+    u32 milliseconds = static_cast<u32>( m_timeFraction );
+    m_timeFraction  -= milliseconds;
+
+    Platform::TimeStep step = m_fixedTimeStep.advance( milliseconds );
+
+    // Steps above a limit are dropped instead of stretched, so each step has the same duration
+    s32 count = min2( step.count(), m_maxSimulationSteps );
+
+    for( s32 i = 0; i < count; i++ ) {
+        transforms->beginSimulationStep();
+        m_ecs->update( currentTime, step.seconds(), SimulationSystems );
+    }
+
+    if( count > 0 ) {
+        transforms->endSimulation();
+    }
+
+    // Rendered transforms are interpolated by a time left in an accumulator
+    m_interpolationFactor = min2( (m_fixedTimeStep.accumulated() + m_timeFraction) / m_fixedTimeStep.dt(), 1.0f );
+    transforms->setInterpolationFactor( m_interpolationFactor );
+}
+
+// ** Scene::fixedTimeStep
+u32 Scene::fixedTimeStep( void ) const
+{
+    return m_fixedTimeStep.dt();
+}
+
+// ** Scene::setFixedTimeStep
+void Scene::setFixedTimeStep( u32 value, s32 maxSteps )
+{
+    NIMBLE_ABORT_IF( maxSteps <= 0, "at least one simulation step should be performed" );
+
+    m_fixedTimeStep       = Platform::FixedTimeStep( value, INT_MAX );
+    m_maxSimulationSteps  = maxSteps;
+    m_timeFraction        = 0.0f;
+    m_interpolationFactor = 1.0f;
+
+    // Transforms are not interpolated without a fixed time step
+    system<AffineTransformSystem>()->setInterpolationFactor( m_interpolationFactor );
+}
+
+// ** Scene::interpolationFactor
+f32 Scene::interpolationFactor( void ) const
+{
+    return m_interpolationFactor;
 }
 
 // ** Scene::createSceneObject
@@ -180,6 +180,7 @@ namespace Scene {
             , Light             //!< A constant buffer that stores light variables (color, position, etc.).
             , Shadow            //!< A constant buffer that stores shadow variables (transform, near, far, etc.).
             , ClippingPlanes    //!< A constant buffer that stores clipping planes.
+            , Clusters          //!< A constant buffer that stores light lists of view space clusters.
         };
     };
     
@@ -206,6 +207,7 @@ namespace Scene {
     dcDeclarePtrs( Camera )
     dcDeclarePtrs( StaticMesh )
     dcDeclarePtrs( Light )
+    dcDeclarePtrs( TerrainLod )
 
     dcDeclarePtrs( Physics2D )
     dcDeclarePtrs( RigidBody2D )
@@ -239,9 +241,24 @@ namespace Scene {
     class Scene : public InjectEventEmitter<RefCounted> {
     public:
 
-        //! Performs a scene update.
+        //! Masks of system groups that are updated by a scene.
+        enum SystemGroupMask {
+              UpdateSystems         = BIT( 0 )  //!< Systems that are updated once per frame with a frame time step.
+            , SimulationSystems     = BIT( 1 )  //!< Systems that are updated with a fixed time step.
+        };
+
+        //! Performs a scene update, simulation systems are updated zero or more times with a fixed time step before update systems.
         void                            update( u32 currentTime, f32 dt );
 
+        //! Returns a fixed simulation time step in milliseconds, zero means that simulation systems use a frame time step.
+        u32                             fixedTimeStep( void ) const;
+
+        //! Sets a fixed simulation time step in milliseconds and a maximum number of steps performed during a single update.
+        void                            setFixedTimeStep( u32 value, s32 maxSteps = 5 );
+
+        //! Returns an interpolation factor between two last simulation steps that is used to render transforms.
+        f32                             interpolationFactor( void ) const;
+
         //! Creates a new scene object instance.
         SceneObjectPtr                    createSceneObject( void );
 
@@ -277,6 +294,14 @@ namespace Scene {
         template<typename TSystem, typename ... Args>
         WeakPtr<TSystem>                addSystem( const Args& ... args );
 
+        //! Returns a simulation system of specified type.
+        template<typename TSystem>
+        WeakPtr<TSystem>                simulationSystem( void ) const;
+
+        //! Adds a new system that is updated with a fixed time step.
+        template<typename TSystem, typename ... Args>
+        WeakPtr<TSystem>                addSimulationSystem( const Args& ... args );
+
         //! Adds a new input system to a scene.
         template<typename TSystem, typename ... Args>
         void                            addInputSystem( const Args& ... args );
@@ -309,10 +334,18 @@ namespace Scene {
                                         //! Constructs a Scene instance.
                                         Scene( void );
 
+        //! Runs simulation systems for each fixed step that fits into a frame time.
+        void                            simulateFixedSteps( u32 currentTime, f32 dt );
+
     private:
 
         Ecs::EcsPtr                        m_ecs;                //!< Internal entity component system.
         Ecs::SystemGroupPtr                m_updateSystems;    //!< Update systems group.
+        Ecs::SystemGroupPtr             m_simulationSystems;    //!< Simulation systems group.
+        Platform::FixedTimeStep         m_fixedTimeStep;    //!< Splits a frame time to fixed simulation steps.
+        s32                             m_maxSimulationSteps;   //!< Steps that exceed this limit are dropped to stop a spiral of death on slow frames.
+        f32                             m_timeFraction;     //!< A fraction of a millisecond that was not passed to a fixed time step timer.
+        f32                             m_interpolationFactor;  //!< An interpolation factor between two last simulation steps.
         Array<InputSystemPtr>           m_inputSystems;     //!< User input processing systems.
         Ecs::IndexPtr                    m_named;            //!< All named entities that reside in scene stored inside this family.
         SpatialUPtr                     m_spatial;          //!< Scene spatial index.
@@ -334,6 +367,22 @@ namespace Scene {
         return m_updateSystems->get<TSystem>();
     }
 
+    // ** Scene::addSimulationSystem
+    template<typename TSystem, typename ... Args>
+    WeakPtr<TSystem> Scene::addSimulationSystem( const Args& ... args )
+    {
+        WeakPtr<TSystem> system = m_simulationSystems->add<TSystem>( args... );
+        m_ecs->rebuildIndices();
+        return system;
+    }
+
+    // ** Scene::simulationSystem
+    template<typename TSystem>
+    WeakPtr<TSystem> Scene::simulationSystem( void ) const
+    {
+        return m_simulationSystems->get<TSystem>();
+    }
+
     // ** Scene::addInputSystem
     template<typename TSystem, typename ... Args>
     void Scene::addInputSystem( const Args& ... args )
@@ -539,20 +588,24 @@ DC_END_DREEMCHEST
     #include "Components/Physics.h"
     #include "Components/Debug.h"
     #include "Assets/Mesh.h"
+    #include "Assets/MeshProcessing.h"
     #include "Assets/Material.h"
     #include "Assets/Image.h"
     #include "Assets/Terrain.h"
+    #include "Assets/TerrainLod.h"
     #include "Assets/Prefab.h"
     #include "Assets/AssetFileSources.h"
     #include "Assets/AssetGenerators.h"
     #include "Systems/InputSystems.h"
     #include "Systems/TransformSystems.h"
     #include "Systems/Physics2D.h"
+    #include "Systems/SpatialHash2D.h"
     #include "Systems/CullingSystems.h"
     #include "Rendering/RenderScene.h"
     #include "Rendering/RenderCache.h"
     #include "Rendering/Debug/ForwardRenderSystem.h"
     #include "Rendering/Debug/SpriteRenderSystem.h"
+    #include "Rendering/Debug/TerrainRenderSystem.h"
     #include "Rendering/Debug/DebugRenderSystem.h"
 #endif
 
@@ -26,6 +26,10 @@
 
 #include "Physics2D.h"
 
+#if DC_THREADS_AVAILABLE
+    #include "../../Threads/Task/TaskManager.h"
+#endif  /*  DC_THREADS_AVAILABLE    */
+
 DC_BEGIN_DREEMCHEST
 
 namespace Scene {
@@ -47,6 +51,12 @@ void Physics2D::setTimeStep( f32 value )
 // ** Physics2D::simulatePhysics
 void Physics2D::simulatePhysics( f32 dt )
 {
+    // A scene already runs this system with a fixed time step
+    if( m_timeStep <= 0.0f ) {
+        simulate( dt );
+        return;
+    }
+
     // Increase the time accumulator
     m_accumulator += dt;
 
@@ -208,22 +218,60 @@ void Box2DPhysics::Collisions::EndContact( b2Contact* contact )
 // ------------------------------------------------ Box2DPhysics ------------------------------------------------ //
 
 // ** Box2DPhysics::Box2DPhysics
-Box2DPhysics::Box2DPhysics( f32 timeStep, const ScaleFactors& scalingFactors, const Vec2& gravity ) : Physics2D( "Box2DPhysics", timeStep ), m_scalingFactors( scalingFactors )
+Box2DPhysics::Box2DPhysics( f32 timeStep, const ScaleFactors& scalingFactors, const Vec2& gravity ) : Physics2D( "Box2DPhysics", timeStep ), m_stepDuration( 0.0f ), m_scalingFactors( scalingFactors )
 {
-    // Create Box2D world instance
-    m_world = DC_NEW b2World( forceToBox2D( gravity ) );
+    m_gravity = forceToBox2D( gravity );
 
-    // Disable automatic force clearing
-    m_world->SetAutoClearForces( false );
+    // Create a default region
+    requestRegion( 0 );
+}
+
+#if DC_THREADS_AVAILABLE
+
+// ** Box2DPhysics::setTaskManager
+void Box2DPhysics::setTaskManager( Threads::TaskManagerWPtr value )
+{
+    m_taskManager = value;
+}
 
-    // Ensure that continuous physics is enabled.
-    m_world->SetContinuousPhysics( true );
+// ** Box2DPhysics::stepTask
+void Box2DPhysics::stepTask( Threads::TaskProgressWPtr progress, void* userData )
+{
+    Region* region = reinterpret_cast<Region*>( userData );
+    region->world->Step( m_stepDuration, 8, 4 );
+}
 
-    // Create collisions
-    m_collisions = DC_NEW Collisions;
+#endif  /*  DC_THREADS_AVAILABLE    */
 
-    // Set contact listener
-    m_world->SetContactListener( m_collisions.get() );
+// ** Box2DPhysics::regionCount
+s32 Box2DPhysics::regionCount( void ) const
+{
+    return static_cast<s32>( m_regions.size() );
+}
+
+// ** Box2DPhysics::requestRegion
+Box2DPhysics::Region& Box2DPhysics::requestRegion( u16 index )
+{
+    while( static_cast<s32>( m_regions.size() ) <= index ) {
+        Region* region = DC_NEW Region;
+
+        // Create Box2D world instance
+        region->world = DC_NEW b2World( m_gravity );
+
+        // Disable automatic force clearing
+        region->world->SetAutoClearForces( false );
+
+        // Ensure that continuous physics is enabled.
+        region->world->SetContinuousPhysics( true );
+
+        // Create collisions and set a contact listener
+        region->collisions = DC_NEW Collisions;
+        region->world->SetContactListener( region->collisions.get() );
+
+        m_regions.push_back( region );
+    }
+
+    return *m_regions[index].get();
 }
 
 // ** Box2DPhysics::queryRect
@@ -245,9 +293,12 @@ SceneObjectSet Box2DPhysics::queryRect( const Rect& rect ) const
     aabb.lowerBound = positionToBox2D( rect.min() );
     aabb.upperBound = positionToBox2D( rect.max() );
 
-    // Run the query
+    // Run the query in each region
     Callback callback;
-    m_world->QueryAABB( &callback, aabb );
+
+    for( s32 i = 0, n = regionCount(); i < n; i++ ) {
+        m_regions[i]->world->QueryAABB( &callback, aabb );
+    }
 
     return callback.m_result;
 }
@@ -271,7 +322,10 @@ SceneObjectSet Box2DPhysics::querySegment( const Vec2& start, const Vec2& end )
     };
 
     Callback callback;
-    m_world->RayCast( &callback, positionToBox2D( start ), positionToBox2D( end ) );
+
+    for( s32 i = 0, n = regionCount(); i < n; i++ ) {
+        m_regions[i]->world->RayCast( &callback, positionToBox2D( start ), positionToBox2D( end ) );
+    }
 
     return callback.m_result;
 }
@@ -297,21 +351,54 @@ bool Box2DPhysics::rayCast( const Vec2& start, const Vec2& end, Vec2& intersecti
     b2Vec2 p1 = positionToBox2D( start );
     b2Vec2 p2 = positionToBox2D( end );
 
-    // Ray cast the physics world.
-    Callback callback;
-    m_world->RayCast( &callback, p1, p2 );
+    // Ray cast each region and pick an intersection that is closest to a start point
+    bool   hasIntersection = false;
+    b2Vec2 closest = p2;
+
+    for( s32 i = 0, n = regionCount(); i < n; i++ ) {
+        Callback callback;
+        m_regions[i]->world->RayCast( &callback, p1, p2 );
+
+        if( callback.m_hasIntersection && (!hasIntersection || (callback.m_result - p1).LengthSquared() < (closest - p1).LengthSquared()) ) {
+            closest         = callback.m_result;
+            hasIntersection = true;
+        }
+    }
 
     // Convert the result to Vec2 and return
-    Vec3 result = positionFromBox2D( callback.m_result );
+    Vec3 result = positionFromBox2D( closest );
     intersectionPoint = Vec2( result.x, result.y );
 
-    return callback.m_hasIntersection;
+    return hasIntersection;
 }
 
 // ** Box2DPhysics::simulate
 void Box2DPhysics::simulate( f32 dt )
 {
-    m_world->Step( dt, 8, 4 );
+    m_stepDuration = dt;
+
+    // Regions do not share any state, so they are stepped concurrently
+#if DC_THREADS_AVAILABLE
+    Threads::TaskManagerWPtr taskManager = m_taskManager;
+
+    if( taskManager.valid() && regionCount() > 1 ) {
+        Array<Threads::TaskProgressPtr> tasks;
+
+        for( s32 i = 0, n = regionCount(); i < n; i++ ) {
+            tasks.push_back( taskManager->runBackgroundTask( dcThisMethod( Box2DPhysics::stepTask ), m_regions[i].get() ) );
+        }
+
+        for( s32 i = 0, n = static_cast<s32>( tasks.size() ); i < n; i++ ) {
+            tasks[i]->waitForCompletion();
+        }
+
+        return;
+    }
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+    for( s32 i = 0, n = regionCount(); i < n; i++ ) {
+        m_regions[i]->world->Step( dt, 8, 4 );
+    }
 }
 
 // ** Box2DPhysics::update
@@ -334,23 +421,49 @@ void Box2DPhysics::update( u32 currentTime, f32 dt )
     // Now simulate the physics with a fixed time step
     simulatePhysics( dt );
 
-    // Clear forces
-    m_world->ClearForces();
+    for( s32 i = 0, n = regionCount(); i < n; i++ ) {
+        Region& region = *m_regions[i].get();
 
-    // Now apply physics transform to a scene transform & dispatch collision events.
-    for( Ecs::EntitySet::iterator i = entities.begin(), end = entities.end(); i != end; ++i ) {
-        RigidBody2D& rigidBody = *(*i)->get<RigidBody2D>();
+        // Clear forces
+        region.world->ClearForces();
+
+        // Now apply physics transform to a scene transform
+        syncTransforms( *region.world.get() );
+
+        // Finally dispatch collision events recorded while a region was stepped
+        dispatchCollisionEvents( *region.collisions.get() );
+    }
+}
 
+// ** Box2DPhysics::syncTransforms
+void Box2DPhysics::syncTransforms( b2World& world )
+{
+    // Walk a world body list, so sleeping bodies are skipped without touching their components
+    for( b2Body* body = world.GetBodyList(); body; body = body->GetNext() ) {
         // Skip static and kinematic bodies
-        if( rigidBody.type() != RigidBody2D::Dynamic ) {
+        if( body->GetType() != b2_dynamicBody ) {
             continue;
         }
 
-        updateTransform( extractPhysicalBody( rigidBody ), rigidBody, *(*i)->get<Transform>() );
-    }
+        Ecs::Entity* entity = reinterpret_cast<Ecs::Entity*>( body->GetUserData() );
+
+        if( entity == NULL ) {
+            continue;
+        }
+
+        RigidBody2D&  rigidBody = *entity->get<RigidBody2D>();
+        Internal::Ptr physical  = rigidBody.internal<Internal>();
 
-    // Finally dispatch collision events
-    dispatchCollisionEvents();
+        // A body that has just fallen asleep is synced once more to reset its velocity
+        bool isAwake = body->IsAwake();
+
+        if( !isAwake && !physical->m_wasAwake ) {
+            continue;
+        }
+
+        physical->m_wasAwake = isAwake;
+        updateTransform( body, rigidBody, *entity->get<Transform>() );
+    }
 }
 
 // ** Box2DPhysics::extractPhysicalBody
@@ -390,15 +503,20 @@ void Box2DPhysics::prepareForSimulation( b2Body* body, RigidBody2D& rigidBody, T
         body->SetAngularVelocity( 0.0f );
     }
 
-    // Now apply forces
+    // A body that was moved outside of a simulation should be synced back to a scene
+    if( rigidBody.wasMoved() || rigidBody.wasRotated() || rigidBody.wasPutToRest() ) {
+        body->SetAwake( true );
+    }
+
+    // Now apply forces, sleeping bodies are woken up only by non-zero ones
     f32            torque = rigidBody.torque();
     const Vec2& force  = rigidBody.force();
 
     body->SetLinearDamping( rigidBody.linearDamping() );
     body->SetAngularDamping( rigidBody.angularDamping() );
     body->SetLinearVelocity( velocityToBox2D( rigidBody.linearVelocity() ) );
-    body->ApplyTorque( -torque, true );
-    body->ApplyForceToCenter( forceToBox2D( force ), true );
+    body->ApplyTorque( -torque, torque != 0.0f );
+    body->ApplyForceToCenter( forceToBox2D( force ), force.x != 0.0f || force.y != 0.0f );
     body->SetGravityScale( rigidBody.gravityScale() );
 
     for( u32 i = 0, n = rigidBody.appliedForceCount(); i < n; i++ ) {
@@ -432,12 +550,12 @@ void Box2DPhysics::updateTransform( b2Body* body, RigidBody2D& rigidBody, Transf
 }
 
 // ** Box2DPhysics::dispatchCollisionEvents
-void Box2DPhysics::dispatchCollisionEvents( void )
+void Box2DPhysics::dispatchCollisionEvents( Collisions& collisions )
 {
     // Dispatch all recorded events
-    for( s32 i = 0, n = m_collisions->eventCount(); i < n; i++ ) {
+    for( s32 i = 0, n = collisions.eventCount(); i < n; i++ ) {
         // Get collision event by index
-        const Collisions::Event& e = m_collisions->event( i );
+        const Collisions::Event& e = collisions.event( i );
 
         // Get fixtures from an event
         b2Fixture* firstFixture = e.first;
@@ -475,7 +593,7 @@ void Box2DPhysics::dispatchCollisionEvents( void )
     }
 
     // Clear recorded collision events
-    m_collisions->clear();
+    collisions.clear();
 }
 
 // ** Box2DPhysics::entityAdded
@@ -504,8 +622,8 @@ void Box2DPhysics::entityAdded( const Ecs::Entity& entity )
     def.angle = rotationToBox2D( transform.rotationZ() );
     def.bullet = rigidBody.isBullet();
 
-    // Construct the Box2D body and attach scene object to it
-    b2Body* body = m_world->CreateBody( &def );
+    // Construct the Box2D body inside a body region and attach scene object to it
+    b2Body* body = requestRegion( rigidBody.region() ).world->CreateBody( &def );
     body->SetUserData( const_cast<Ecs::Entity*>( &entity ) );
 
     // Initialize the body shape
@@ -531,7 +649,7 @@ void Box2DPhysics::entityAdded( const Ecs::Entity& entity )
     updateMass( rigidBody, body->GetMass() );
 
     // Attach created body to a component
-    rigidBody.setInternal<Internal>( DC_NEW Internal( body ) );
+    rigidBody.setInternal<Internal>( DC_NEW Internal( body, rigidBody.region() ) );
 }
 
 // ** Box2DPhysics::entityRemoved
@@ -545,7 +663,7 @@ void Box2DPhysics::entityRemoved( const Ecs::Entity& entity )
     NIMBLE_ABORT_IF( body == NULL, "Box2D body should be valid" );
 
     body->SetUserData( NULL );
-    m_world->DestroyBody( body );
+    m_regions[physical->m_region]->world->DestroyBody( body );
 }
 
 // ** Box2DPhysics::addCircleFixture
@@ -30,6 +30,7 @@
 #include "../Scene.h"
 #include "../Components/Transform.h"
 #include "../Components/Physics.h"
+#include "../../Threads/Threads.h"
 
 #ifdef DC_BOX2D_ENABLED
     #include <Box2D/Box2D.h>
@@ -54,7 +55,7 @@ namespace Scene {
             f32                 velocity;   //!< Velocity scaling factor.
         };
 
-        //! Sets the physics fixed time step.
+        //! Sets the physics fixed time step, zero disables sub-stepping when a system is updated by a scene with a fixed time step.
         void                    setTimeStep( f32 value );
 
         //! Performs the ray casting and returns the closes point to the starting one.
@@ -99,12 +100,26 @@ namespace Scene {
 #ifdef DC_BOX2D_ENABLED
 
     //! The Box2D physics system
+    /*!
+    Rigid bodies are placed to a Box2D world of a region they belong to. Regions never interact,
+    so each of them is stepped by a separate background task when a task manager is set. Contacts
+    are recorded per region during a step and are delivered to rigid bodies after all regions were
+    stepped. Only transforms of bodies that are awake or have just fallen asleep are written back.
+    */
     class Box2DPhysics : public Physics2D {
     public:
 
                                 //! Constructs the Box2DPhysics instance.
                                 Box2DPhysics( f32 timeStep = 1.0f / 120.0f, const ScaleFactors& scaleFactors = ScaleFactors(), const Vec2& gravity = Vec2( 0.0f, -9.8f ) );
 
+    #if DC_THREADS_AVAILABLE
+        //! Sets a task manager used to step regions in background, regions are stepped one by one without it.
+        void                    setTaskManager( Threads::TaskManagerWPtr value );
+    #endif  /*  DC_THREADS_AVAILABLE    */
+
+        //! Returns a total number of simulation regions.
+        s32                     regionCount( void ) const;
+
         //! Performs the ray casting and returns the closes point to the starting one.
         virtual bool            rayCast( const Vec2& start, const Vec2& end, Vec2& intersectionPoint ) const NIMBLE_OVERRIDE;
 
@@ -146,6 +161,9 @@ namespace Scene {
 
     private:
 
+        class Collisions;
+        struct Region;
+
         //! Adds a circle fixture to a body.
         b2Fixture*                addCircleFixture( b2Body* body, b2Filter filter, const SimpleShape2D& shape, bool isSensor ) const;
 
@@ -194,25 +212,46 @@ namespace Scene {
         //! Returns the Box2D body attached to this rigid body.
         b2Body*                 extractPhysicalBody( const RigidBody2D& rigidBody ) const;
 
-        //! Pushes the collision events to a respective bodies.
-        void                    dispatchCollisionEvents( void );
+        //! Pushes the collision events of a region to a respective bodies.
+        void                    dispatchCollisionEvents( Collisions& collisions );
 
-    private:
+        //! Writes transforms of awake dynamic bodies of a region back to scene objects.
+        void                    syncTransforms( b2World& world );
 
-        class Collisions;
+        //! Returns a simulation region with a specified index, creates it if it does not exist yet.
+        Region&                 requestRegion( u16 index );
+
+    #if DC_THREADS_AVAILABLE
+        //! A background task that steps a single region.
+        void                    stepTask( Threads::TaskProgressWPtr progress, void* userData );
+    #endif  /*  DC_THREADS_AVAILABLE    */
+
+    private:
 
         //! Holds the per-instance internal physics data inside the component.
         struct Internal : public Ecs::Internal<Internal> {
                                 //! Constructs the Internal instance.
-                                Internal( b2Body* body )
-                                    : m_body( body ) {}
+                                Internal( b2Body* body, u16 region )
+                                    : m_body( body ), m_region( region ), m_wasAwake( true ) {}
 
             b2Body*                m_body;                //!< The attached Box2D body.
+            u16                 m_region;           //!< A region this body was created in.
+            bool                m_wasAwake;         //!< Indicates that a body was awake during a previous transform sync.
+        };
+
+        //! An independent Box2D world with its own contact listener.
+        struct Region {
+            UPtr<b2World>       world;              //!< The Box2D physics world.
+            UPtr<Collisions>    collisions;         //!< Contacts recorded during a world step.
         };
 
-        UPtr<b2World>        m_world;            //!< The Box2D physics world.
-        UPtr<Collisions>     m_collisions;       //!< Collision listener interface.
+        Array< UPtr<Region> >   m_regions;          //!< Simulation regions, a region is created once the first body is placed to it.
+        b2Vec2                  m_gravity;          //!< Gravity applied to each region.
+        f32                     m_stepDuration;     //!< A duration of a step that is being simulated.
         ScaleFactors            m_scalingFactors;   //!< Physics world scaling factors.
+    #if DC_THREADS_AVAILABLE
+        Threads::TaskManagerWPtr m_taskManager;     //!< A task manager used to step regions.
+    #endif  /*  DC_THREADS_AVAILABLE    */
     };
 
 #endif    /*    DC_BOX2D_ENABLED    */
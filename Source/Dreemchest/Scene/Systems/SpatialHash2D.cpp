@@ -0,0 +1,583 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "SpatialHash2D.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+// ------------------------------------------------ SpatialHash2D ------------------------------------------------ //
+
+// ** SpatialHash2D::SpatialHash2D
+SpatialHash2D::SpatialHash2D( f32 cellSize )
+    : m_cellSize( cellSize )
+    , m_invCellSize( 1.0f / cellSize )
+    , m_itemCount( 0 )
+    , m_queryId( 0 )
+{
+    NIMBLE_ABORT_IF( cellSize <= 0.0f, "a cell size should be positive" );
+    clear();
+}
+
+// ** SpatialHash2D::cellSize
+f32 SpatialHash2D::cellSize( void ) const
+{
+    return m_cellSize;
+}
+
+// ** SpatialHash2D::itemCount
+s32 SpatialHash2D::itemCount( void ) const
+{
+    return m_itemCount;
+}
+
+// ** SpatialHash2D::cellCount
+s32 SpatialHash2D::cellCount( void ) const
+{
+    return static_cast<s32>( m_cells.size() );
+}
+
+// ** SpatialHash2D::userData
+void* SpatialHash2D::userData( Handle handle ) const
+{
+    NIMBLE_ABORT_IF( handle < 0 || handle >= static_cast<s32>( m_items.size() ), "invalid item handle" );
+    return m_items[handle].userData;
+}
+
+// ** SpatialHash2D::insert
+SpatialHash2D::Handle SpatialHash2D::insert( const Vec2& min, const Vec2& max, void* userData )
+{
+    // Reuse a removed item or allocate a new one
+    Handle handle;
+
+    if( m_freeItems.empty() ) {
+        handle = static_cast<Handle>( m_items.size() );
+        m_items.push_back( Item() );
+    } else {
+        handle = m_freeItems.back();
+        m_freeItems.pop_back();
+    }
+
+    Item& item = m_items[handle];
+    item.min      = min;
+    item.max      = max;
+    item.cells    = cellRange( min, max );
+    item.userData = userData;
+    item.queryId  = 0;
+    item.isActive = true;
+
+    link( handle, item.cells );
+    m_itemCount++;
+
+    return handle;
+}
+
+// ** SpatialHash2D::update
+void SpatialHash2D::update( Handle handle, const Vec2& min, const Vec2& max )
+{
+    NIMBLE_ABORT_IF( handle < 0 || handle >= static_cast<s32>( m_items.size() ) || !m_items[handle].isActive, "invalid item handle" );
+
+    Item& item = m_items[handle];
+    item.min = min;
+    item.max = max;
+
+    // Most of updates do not move an item to another cell
+    CellRange cells = cellRange( min, max );
+
+    if( cells == item.cells ) {
+        return;
+    }
+
+    unlink( handle, item.cells );
+    link( handle, cells );
+    item.cells = cells;
+}
+
+// ** SpatialHash2D::remove
+void SpatialHash2D::remove( Handle handle )
+{
+    NIMBLE_ABORT_IF( handle < 0 || handle >= static_cast<s32>( m_items.size() ) || !m_items[handle].isActive, "invalid item handle" );
+
+    Item& item = m_items[handle];
+    unlink( handle, item.cells );
+    item.isActive = false;
+    item.userData = NULL;
+
+    m_freeItems.push_back( handle );
+    m_itemCount--;
+
+    // Reset grid extents once the last item was removed
+    if( m_itemCount == 0 ) {
+        clear();
+    }
+}
+
+// ** SpatialHash2D::clear
+void SpatialHash2D::clear( void )
+{
+    m_items.clear();
+    m_freeItems.clear();
+    m_cells.clear();
+    m_itemCount = 0;
+
+    // Grid extents are empty until the first item is inserted
+    m_extents.x1 = m_extents.y1 = INT_MAX;
+    m_extents.x2 = m_extents.y2 = INT_MIN;
+}
+
+// ** SpatialHash2D::distanceTo
+f32 SpatialHash2D::distanceTo( Handle handle, const Vec2& point ) const
+{
+    const Item& item = m_items[handle];
+
+    f32 dx = max2( max2( item.min.x - point.x, point.x - item.max.x ), 0.0f );
+    f32 dy = max2( max2( item.min.y - point.y, point.y - item.max.y ), 0.0f );
+
+    return sqrtf( dx * dx + dy * dy );
+}
+
+// ** SpatialHash2D::queryRect
+s32 SpatialHash2D::queryRect( const Vec2& min, const Vec2& max, Array<Handle>& result ) const
+{
+    struct Visitor {
+        Vec2            min;
+        Vec2            max;
+        Array<Handle>*  result;
+
+        void operator () ( Handle handle, const Item& item ) {
+            if( item.max.x >= min.x && item.min.x <= max.x && item.max.y >= min.y && item.min.y <= max.y ) {
+                result->push_back( handle );
+            }
+        }
+    };
+
+    size_t   count   = result.size();
+    Visitor visitor = { min, max, &result };
+    visitCells( cellRange( min, max ), beginQuery(), visitor );
+
+    return static_cast<s32>( result.size() - count );
+}
+
+// ** SpatialHash2D::queryRadius
+s32 SpatialHash2D::queryRadius( const Vec2& center, f32 radius, Array<Handle>& result ) const
+{
+    struct Visitor {
+        const SpatialHash2D*    grid;
+        Vec2                    center;
+        f32                     radius;
+        Array<Handle>*          result;
+
+        void operator () ( Handle handle, const Item& item ) {
+            if( grid->distanceTo( handle, center ) <= radius ) {
+                result->push_back( handle );
+            }
+        }
+    };
+
+    size_t   count   = result.size();
+    Visitor visitor = { this, center, radius, &result };
+    visitCells( cellRange( center - Vec2( radius, radius ), center + Vec2( radius, radius ) ), beginQuery(), visitor );
+
+    return static_cast<s32>( result.size() - count );
+}
+
+// ** SpatialHash2D::queryNearest
+s32 SpatialHash2D::queryNearest( const Vec2& point, s32 count, Array<Handle>& result, f32 maxDistance ) const
+{
+    if( count <= 0 || m_itemCount == 0 ) {
+        return 0;
+    }
+
+    //! A nearest item candidate.
+    struct Candidate {
+        f32             distance;
+        Handle          handle;
+
+        bool operator < ( const Candidate& other ) const { return distance < other.distance; }
+    };
+
+    struct Visitor {
+        const SpatialHash2D*    grid;
+        Vec2                    point;
+        f32                     maxDistance;
+        Array<Candidate>*       candidates;
+
+        void operator () ( Handle handle, const Item& item ) {
+            Candidate candidate;
+            candidate.distance = grid->distanceTo( handle, point );
+            candidate.handle   = handle;
+
+            if( candidate.distance <= maxDistance ) {
+                candidates->push_back( candidate );
+            }
+        }
+    };
+
+    Array<Candidate> candidates;
+    Visitor          visitor = { this, point, maxDistance, &candidates };
+    u32              queryId = beginQuery();
+
+    // Visit rings of cells around a point cell, all cells that are closer than grid extents are empty
+    CellRange origin = cellRange( point, point );
+    s32       cx     = origin.x1;
+    s32       cy     = origin.y1;
+    s32       first  = max2( max2( m_extents.x1 - cx, cx - m_extents.x2 ), max2( m_extents.y1 - cy, cy - m_extents.y2 ) );
+
+    for( s32 ring = max2( first, 0 ); ; ring++ ) {
+        // Visit top and bottom rows of a ring clipped by grid extents
+        for( s32 y = cy - ring; y <= cy + ring; y += max2( ring * 2, 1 ) ) {
+            if( y < m_extents.y1 || y > m_extents.y2 ) {
+                continue;
+            }
+
+            CellRange row = { max2( cx - ring, m_extents.x1 ), y, min2( cx + ring, m_extents.x2 ), y };
+            visitCells( row, queryId, visitor );
+        }
+
+        // Visit left and right columns of a ring clipped by grid extents
+        for( s32 x = cx - ring; ring > 0 && x <= cx + ring; x += ring * 2 ) {
+            if( x < m_extents.x1 || x > m_extents.x2 ) {
+                continue;
+            }
+
+            CellRange column = { x, max2( cy - ring + 1, m_extents.y1 ), x, min2( cy + ring - 1, m_extents.y2 ) };
+            visitCells( column, queryId, visitor );
+        }
+
+        // Items in cells outside of this ring are at least this far from a point
+        f32 reached = ring * m_cellSize;
+
+        if( reached > maxDistance ) {
+            break;
+        }
+
+        if( static_cast<s32>( candidates.size() ) >= count ) {
+            std::nth_element( candidates.begin(), candidates.begin() + count - 1, candidates.end() );
+
+            if( candidates[count - 1].distance <= reached ) {
+                break;
+            }
+        }
+
+        // The whole grid was visited
+        if( cx - ring <= m_extents.x1 && cx + ring >= m_extents.x2 && cy - ring <= m_extents.y1 && cy + ring >= m_extents.y2 ) {
+            break;
+        }
+    }
+
+    // Output nearest candidates sorted by a distance
+    s32 found = min2( count, static_cast<s32>( candidates.size() ) );
+    std::partial_sort( candidates.begin(), candidates.begin() + found, candidates.end() );
+
+    for( s32 i = 0; i < found; i++ ) {
+        result.push_back( candidates[i].handle );
+    }
+
+    return found;
+}
+
+// ** SpatialHash2D::cellRange
+SpatialHash2D::CellRange SpatialHash2D::cellRange( const Vec2& min, const Vec2& max ) const
+{
+    CellRange range;
+    range.x1 = static_cast<s32>( floor( min.x * m_invCellSize ) );
+    range.y1 = static_cast<s32>( floor( min.y * m_invCellSize ) );
+    range.x2 = static_cast<s32>( floor( max.x * m_invCellSize ) );
+    range.y2 = static_cast<s32>( floor( max.y * m_invCellSize ) );
+    return range;
+}
+
+// ** SpatialHash2D::cellKey
+u64 SpatialHash2D::cellKey( s32 x, s32 y )
+{
+    return (static_cast<u64>( static_cast<u32>( x ) ) << 32) | static_cast<u32>( y );
+}
+
+// ** SpatialHash2D::link
+void SpatialHash2D::link( Handle handle, const CellRange& cells )
+{
+    for( s32 y = cells.y1; y <= cells.y2; y++ ) {
+        for( s32 x = cells.x1; x <= cells.x2; x++ ) {
+            m_cells[cellKey( x, y )].push_back( handle );
+        }
+    }
+
+    // Extend grid extents
+    m_extents.x1 = min2( m_extents.x1, cells.x1 );
+    m_extents.y1 = min2( m_extents.y1, cells.y1 );
+    m_extents.x2 = max2( m_extents.x2, cells.x2 );
+    m_extents.y2 = max2( m_extents.y2, cells.y2 );
+}
+
+// ** SpatialHash2D::unlink
+void SpatialHash2D::unlink( Handle handle, const CellRange& cells )
+{
+    for( s32 y = cells.y1; y <= cells.y2; y++ ) {
+        for( s32 x = cells.x1; x <= cells.x2; x++ ) {
+            Cells::iterator cell = m_cells.find( cellKey( x, y ) );
+            NIMBLE_BREAK_IF( cell == m_cells.end(), "an item is not referenced from a cell" );
+
+            if( cell == m_cells.end() ) {
+                continue;
+            }
+
+            // Order of items inside a cell does not matter, so swap with a last one
+            Array<Handle>&          items = cell->second;
+            Array<Handle>::iterator i     = std::find( items.begin(), items.end(), handle );
+
+            if( i != items.end() ) {
+                *i = items.back();
+                items.pop_back();
+            }
+
+            if( items.empty() ) {
+                m_cells.erase( cell );
+            }
+        }
+    }
+}
+
+// ** SpatialHash2D::beginQuery
+u32 SpatialHash2D::beginQuery( void ) const
+{
+    // Reset visit marks once a query counter has wrapped around
+    if( ++m_queryId == 0 ) {
+        for( size_t i = 0, n = m_items.size(); i < n; i++ ) {
+            m_items[i].queryId = 0;
+        }
+        m_queryId = 1;
+    }
+
+    return m_queryId;
+}
+
+// ** SpatialHash2D::visitCells
+template<typename TVisitor>
+void SpatialHash2D::visitCells( const CellRange& cells, u32 queryId, TVisitor& visitor ) const
+{
+    // Nothing outside of grid extents
+    CellRange range;
+    range.x1 = max2( cells.x1, m_extents.x1 );
+    range.y1 = max2( cells.y1, m_extents.y1 );
+    range.x2 = min2( cells.x2, m_extents.x2 );
+    range.y2 = min2( cells.y2, m_extents.y2 );
+
+    if( range.x1 > range.x2 || range.y1 > range.y2 ) {
+        return;
+    }
+
+    // A large range is processed by iterating occupied cells instead of looking up each of them
+    s64 area = static_cast<s64>( range.x2 - range.x1 + 1 ) * (range.y2 - range.y1 + 1);
+
+    if( area > static_cast<s64>( m_cells.size() ) ) {
+        for( Cells::const_iterator cell = m_cells.begin(), end = m_cells.end(); cell != end; ++cell ) {
+            s32 x = static_cast<s32>( static_cast<u32>( cell->first >> 32 ) );
+            s32 y = static_cast<s32>( static_cast<u32>( cell->first ) );
+
+            if( x < range.x1 || x > range.x2 || y < range.y1 || y > range.y2 ) {
+                continue;
+            }
+
+            const Array<Handle>& items = cell->second;
+
+            for( size_t i = 0, n = items.size(); i < n; i++ ) {
+                const Item& item = m_items[items[i]];
+
+                if( item.queryId != queryId ) {
+                    item.queryId = queryId;
+                    visitor( items[i], item );
+                }
+            }
+        }
+        return;
+    }
+
+    for( s32 y = range.y1; y <= range.y2; y++ ) {
+        for( s32 x = range.x1; x <= range.x2; x++ ) {
+            Cells::const_iterator cell = m_cells.find( cellKey( x, y ) );
+
+            if( cell == m_cells.end() ) {
+                continue;
+            }
+
+            const Array<Handle>& items = cell->second;
+
+            for( size_t i = 0, n = items.size(); i < n; i++ ) {
+                const Item& item = m_items[items[i]];
+
+                if( item.queryId != queryId ) {
+                    item.queryId = queryId;
+                    visitor( items[i], item );
+                }
+            }
+        }
+    }
+}
+
+// ** SpatialHash2D::CellRange::operator ==
+bool SpatialHash2D::CellRange::operator == ( const CellRange& other ) const
+{
+    return x1 == other.x1 && y1 == other.y1 && x2 == other.x2 && y2 == other.y2;
+}
+
+// -------------------------------------------- SpatialHash2DSystem ---------------------------------------------- //
+
+// ** SpatialHash2DSystem::SpatialHash2DSystem
+SpatialHash2DSystem::SpatialHash2DSystem( f32 cellSize )
+    : m_spatialHash( cellSize )
+{
+}
+
+// ** SpatialHash2DSystem::spatialHash
+const SpatialHash2D& SpatialHash2DSystem::spatialHash( void ) const
+{
+    return m_spatialHash;
+}
+
+// ** SpatialHash2DSystem::queryRect
+SceneObjectSet SpatialHash2DSystem::queryRect( const Rect& rect ) const
+{
+    m_queryResult.clear();
+    m_spatialHash.queryRect( rect.min(), rect.max(), m_queryResult );
+    return toSceneObjects( m_queryResult );
+}
+
+// ** SpatialHash2DSystem::queryRadius
+SceneObjectSet SpatialHash2DSystem::queryRadius( const Vec2& center, f32 radius ) const
+{
+    m_queryResult.clear();
+    m_spatialHash.queryRadius( center, radius, m_queryResult );
+    return toSceneObjects( m_queryResult );
+}
+
+// ** SpatialHash2DSystem::queryNearest
+Array<SceneObjectWPtr> SpatialHash2DSystem::queryNearest( const Vec2& point, s32 count, f32 maxDistance ) const
+{
+    m_queryResult.clear();
+    m_spatialHash.queryNearest( point, count, m_queryResult, maxDistance );
+
+    Array<SceneObjectWPtr> result;
+
+    for( size_t i = 0, n = m_queryResult.size(); i < n; i++ ) {
+        result.push_back( reinterpret_cast<Ecs::Entity*>( m_spatialHash.userData( m_queryResult[i] ) ) );
+    }
+
+    return result;
+}
+
+// ** SpatialHash2DSystem::toSceneObjects
+SceneObjectSet SpatialHash2DSystem::toSceneObjects( const Array<SpatialHash2D::Handle>& handles ) const
+{
+    SceneObjectSet result;
+
+    for( size_t i = 0, n = handles.size(); i < n; i++ ) {
+        result.insert( reinterpret_cast<Ecs::Entity*>( m_spatialHash.userData( handles[i] ) ) );
+    }
+
+    return result;
+}
+
+// ** SpatialHash2DSystem::calculateBounds
+void SpatialHash2DSystem::calculateBounds( const Matrix4& transform, const Shape2D& shape, Vec2& min, Vec2& max )
+{
+    // Calculate local space bounds of all shape parts
+    Vec2 lower( 0.0f, 0.0f );
+    Vec2 upper( 0.0f, 0.0f );
+
+    for( u32 i = 0, n = shape.partCount(); i < n; i++ ) {
+        const SimpleShape2D& part = shape.part( i );
+        Vec2                 partMin;
+        Vec2                 partMax;
+
+        switch( part.type ) {
+        case Shape2DType::Circle:   partMin = Vec2( part.circle.x - part.circle.radius, part.circle.y - part.circle.radius );
+                                    partMax = Vec2( part.circle.x + part.circle.radius, part.circle.y + part.circle.radius );
+                                    break;
+        case Shape2DType::Rect:     partMin = Vec2( part.rect.x - part.rect.width * 0.5f, part.rect.y - part.rect.height * 0.5f );
+                                    partMax = Vec2( part.rect.x + part.rect.width * 0.5f, part.rect.y + part.rect.height * 0.5f );
+                                    break;
+        case Shape2DType::Polygon:  partMin = Vec2(  FLT_MAX,  FLT_MAX );
+                                    partMax = Vec2( -FLT_MAX, -FLT_MAX );
+
+                                    for( u32 j = 0; j < part.polygon.count; j++ ) {
+                                        Vec2 vertex( part.polygon.vertices[j * 2 + 0], part.polygon.vertices[j * 2 + 1] );
+                                        partMin = Vec2( min2( partMin.x, vertex.x ), min2( partMin.y, vertex.y ) );
+                                        partMax = Vec2( max2( partMax.x, vertex.x ), max2( partMax.y, vertex.y ) );
+                                    }
+                                    break;
+        default:                    NIMBLE_NOT_IMPLEMENTED;
+        }
+
+        lower = i == 0 ? partMin : Vec2( min2( lower.x, partMin.x ), min2( lower.y, partMin.y ) );
+        upper = i == 0 ? partMax : Vec2( max2( upper.x, partMax.x ), max2( upper.y, partMax.y ) );
+    }
+
+    // Transform corners of local bounds to a world space
+    Vec2 corners[] = { lower, Vec2( upper.x, lower.y ), upper, Vec2( lower.x, upper.y ) };
+
+    min = Vec2(  FLT_MAX,  FLT_MAX );
+    max = Vec2( -FLT_MAX, -FLT_MAX );
+
+    for( s32 i = 0; i < 4; i++ ) {
+        Vec3 corner = transform * Vec3( corners[i].x, corners[i].y, 0.0f );
+        min = Vec2( min2( min.x, corner.x ), min2( min.y, corner.y ) );
+        max = Vec2( max2( max.x, corner.x ), max2( max.y, corner.y ) );
+    }
+}
+
+// ** SpatialHash2DSystem::process
+void SpatialHash2DSystem::process( u32 currentTime, f32 dt, Ecs::Entity& entity, Transform& transform, Shape2D& shape )
+{
+    HandleByEntity::const_iterator i = m_handleByEntity.find( &entity );
+    NIMBLE_ABORT_IF( i == m_handleByEntity.end(), "a scene object is not indexed" );
+
+    Vec2 min, max;
+    calculateBounds( transform.matrix(), shape, min, max );
+    m_spatialHash.update( i->second, min, max );
+}
+
+// ** SpatialHash2DSystem::entityAdded
+void SpatialHash2DSystem::entityAdded( const Ecs::Entity& entity )
+{
+    Vec2 min, max;
+    calculateBounds( entity.get<Transform>()->matrix(), *entity.get<Shape2D>(), min, max );
+    m_handleByEntity[&entity] = m_spatialHash.insert( min, max, const_cast<Ecs::Entity*>( &entity ) );
+}
+
+// ** SpatialHash2DSystem::entityRemoved
+void SpatialHash2DSystem::entityRemoved( const Ecs::Entity& entity )
+{
+    HandleByEntity::iterator i = m_handleByEntity.find( &entity );
+    NIMBLE_ABORT_IF( i == m_handleByEntity.end(), "a scene object is not indexed" );
+
+    m_spatialHash.remove( i->second );
+    m_handleByEntity.erase( i );
+}
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
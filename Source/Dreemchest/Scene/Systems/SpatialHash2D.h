@@ -0,0 +1,206 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Scene_Systems_SpatialHash2D_H__
+#define __DC_Scene_Systems_SpatialHash2D_H__
+
+#include "../Scene.h"
+
+#include "../Components/Transform.h"
+#include "../Components/Physics.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Scene {
+
+    //! A uniform grid that stores axis-aligned 2D rectangles and answers proximity queries.
+    /*!
+    Each item is referenced from all grid cells it overlaps. Cells are stored in a hash map,
+    so a grid is not bounded and only occupied cells consume memory. A query visits just the
+    cells that overlap a queried area, so it costs O(k) of items found nearby instead of
+    a linear scan over all items. Queries are not thread-safe, because each of them marks
+    visited items to report an item overlapping several cells once.
+    */
+    class SpatialHash2D {
+    public:
+
+        //! A handle of an item inserted to a grid.
+        typedef s32             Handle;
+
+                                //! Constructs a SpatialHash2D instance.
+                                SpatialHash2D( f32 cellSize = 64.0f );
+
+        //! Returns a grid cell size.
+        f32                     cellSize( void ) const;
+
+        //! Returns a total number of items inside a grid.
+        s32                     itemCount( void ) const;
+
+        //! Returns a total number of occupied grid cells.
+        s32                     cellCount( void ) const;
+
+        //! Inserts a new item with specified bounds and returns its handle.
+        Handle                  insert( const Vec2& min, const Vec2& max, void* userData = NULL );
+
+        //! Updates item bounds, cells are touched only when an item has crossed a cell border.
+        void                    update( Handle handle, const Vec2& min, const Vec2& max );
+
+        //! Removes an item from a grid.
+        void                    remove( Handle handle );
+
+        //! Removes all items from a grid.
+        void                    clear( void );
+
+        //! Returns a user data attached to an item.
+        void*                   userData( Handle handle ) const;
+
+        //! Writes handles of all items that overlap a rectangle to an output array and returns the number of items found.
+        s32                     queryRect( const Vec2& min, const Vec2& max, Array<Handle>& result ) const;
+
+        //! Writes handles of all items that are closer to a point than a specified radius and returns the number of items found.
+        s32                     queryRadius( const Vec2& center, f32 radius, Array<Handle>& result ) const;
+
+        //! Writes up to a specified number of items nearest to a point sorted by a distance and returns the number of items found.
+        s32                     queryNearest( const Vec2& point, s32 count, Array<Handle>& result, f32 maxDistance = FLT_MAX ) const;
+
+        //! Returns a distance from a point to item bounds, zero is returned for points inside.
+        f32                     distanceTo( Handle handle, const Vec2& point ) const;
+
+    private:
+
+        //! A grid cell coordinates.
+        struct CellRange {
+            s32                 x1;         //!< The first column.
+            s32                 y1;         //!< The first row.
+            s32                 x2;         //!< The last column.
+            s32                 y2;         //!< The last row.
+
+            //! Compares two cell ranges.
+            bool                operator == ( const CellRange& other ) const;
+        };
+
+        //! A single item stored inside a grid.
+        struct Item {
+            Vec2                min;        //!< Item bounds lower corner.
+            Vec2                max;        //!< Item bounds upper corner.
+            CellRange           cells;      //!< A range of cells an item is referenced from.
+            void*               userData;   //!< A user data attached to an item.
+            mutable u32         queryId;    //!< An identifier of a last query that visited this item.
+            bool                isActive;   //!< Indicates that this item was not removed.
+        };
+
+        //! A container type to map from cell coordinates to items that overlap a cell.
+        typedef HashMap<u64, Array<Handle>> Cells;
+
+        //! Returns a range of cells overlapped by a rectangle.
+        CellRange               cellRange( const Vec2& min, const Vec2& max ) const;
+
+        //! Returns a hash map key of a cell.
+        static u64              cellKey( s32 x, s32 y );
+
+        //! Adds an item reference to a range of cells.
+        void                    link( Handle handle, const CellRange& cells );
+
+        //! Removes an item reference from a range of cells.
+        void                    unlink( Handle handle, const CellRange& cells );
+
+        //! Starts a new query and returns its identifier.
+        u32                     beginQuery( void ) const;
+
+        //! Calls a visitor for each item referenced from a range of cells, each item is visited once per query.
+        template<typename TVisitor>
+        void                    visitCells( const CellRange& cells, u32 queryId, TVisitor& visitor ) const;
+
+    private:
+
+        f32                     m_cellSize;     //!< A grid cell size.
+        f32                     m_invCellSize;  //!< An inverse grid cell size.
+        Array<Item>             m_items;        //!< All items, removed items are reused by later insertions.
+        Array<Handle>           m_freeItems;    //!< Handles of removed items.
+        s32                     m_itemCount;    //!< A total number of active items.
+        Cells                   m_cells;        //!< Occupied grid cells.
+        CellRange               m_extents;      //!< A range of cells that were occupied since a grid was cleared.
+        mutable u32             m_queryId;      //!< A last query identifier.
+    };
+
+    //! Maintains a spatial hash of scene objects that have a Transform and Shape2D for gameplay proximity queries.
+    /*!
+    World-space bounds are calculated from shape parts and a transform matrix, so this system should
+    be updated after an affine transform system. Unlike queries of a physics system these do not
+    require Box2D bodies to be created.
+    */
+    class SpatialHash2DSystem : public Ecs::GenericEntitySystem<SpatialHash2DSystem, Transform, Shape2D> {
+    public:
+
+                            //! Constructs a SpatialHash2DSystem instance.
+                            SpatialHash2DSystem( f32 cellSize = 64.0f );
+
+        //! Returns a spatial hash with all indexed scene objects.
+        const SpatialHash2D& spatialHash( void ) const;
+
+        //! Returns all scene objects that overlap a rectangle.
+        SceneObjectSet      queryRect( const Rect& rect ) const;
+
+        //! Returns all scene objects that are closer to a point than a specified radius.
+        SceneObjectSet      queryRadius( const Vec2& center, f32 radius ) const;
+
+        //! Returns up to a specified number of scene objects nearest to a point sorted by a distance.
+        Array<SceneObjectWPtr> queryNearest( const Vec2& point, s32 count, f32 maxDistance = FLT_MAX ) const;
+
+        //! Calculates world-space bounds of a shape.
+        static void         calculateBounds( const Matrix4& transform, const Shape2D& shape, Vec2& min, Vec2& max );
+
+    protected:
+
+        //! Updates bounds of a scene object inside a spatial hash.
+        virtual void        process( u32 currentTime, f32 dt, Ecs::Entity& entity, Transform& transform, Shape2D& shape ) NIMBLE_OVERRIDE;
+
+        //! Inserts a scene object to a spatial hash.
+        virtual void        entityAdded( const Ecs::Entity& entity ) NIMBLE_OVERRIDE;
+
+        //! Removes a scene object from a spatial hash.
+        virtual void        entityRemoved( const Ecs::Entity& entity ) NIMBLE_OVERRIDE;
+
+    private:
+
+        //! Converts query results to a set of scene objects.
+        SceneObjectSet      toSceneObjects( const Array<SpatialHash2D::Handle>& handles ) const;
+
+    private:
+
+        //! A container type to map from an entity to its spatial hash item.
+        typedef HashMap<const Ecs::Entity*, SpatialHash2D::Handle> HandleByEntity;
+
+        SpatialHash2D       m_spatialHash;      //!< A spatial hash with all indexed scene objects.
+        HandleByEntity      m_handleByEntity;   //!< Spatial hash items of indexed scene objects.
+        mutable Array<SpatialHash2D::Handle> m_queryResult; //!< A temporary array to store query results.
+    };
+
+} // namespace Scene
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Scene_Systems_SpatialHash2D_H__    */
@@ -34,6 +34,34 @@ namespace Scene {
 
 // -------------------------------------------- AffineTransformSystem -------------------------------------------- //
 
+// ** AffineTransformSystem::AffineTransformSystem
+AffineTransformSystem::AffineTransformSystem( void )
+    : m_interpolationFactor( 1.0f )
+{
+}
+
+// ** AffineTransformSystem::beginSimulationStep
+void AffineTransformSystem::beginSimulationStep( void )
+{
+    for( u32 i = 0; i < m_transforms.size(); i++ ) {
+        m_previous[i] = stateOf( *m_transforms[i] );
+    }
+}
+
+// ** AffineTransformSystem::endSimulation
+void AffineTransformSystem::endSimulation( void )
+{
+    for( u32 i = 0; i < m_transforms.size(); i++ ) {
+        m_simulated[i] = stateOf( *m_transforms[i] );
+    }
+}
+
+// ** AffineTransformSystem::setInterpolationFactor
+void AffineTransformSystem::setInterpolationFactor( f32 value )
+{
+    m_interpolationFactor = value;
+}
+
 // ** AffineTransformSystem::update
 void AffineTransformSystem::update( u32 currentTime, f32 dt )
 {
@@ -48,20 +76,37 @@ void AffineTransformSystem::update( u32 currentTime, f32 dt )
     for( u32 i = 0; i < m_transforms.size(); i++ ) {
         Transform* transform = m_transforms[i];
 
+        // A simulated matrix is authoritative and is read by all non-rendering systems
         Matrix4 T = Matrix4::translation( transform->position() ) * transform->rotation() * Matrix4::scale( transform->scale() );
+        Matrix4 R = T;
+
+        // Transforms that were changed outside of simulation steps are not interpolated
+        if( m_interpolationFactor < 1.0f && isUnchanged( *transform, m_simulated[i] ) ) {
+            const State& a = m_previous[i];
+            const State& b = m_simulated[i];
+            f32          t = m_interpolationFactor;
+
+            R = Matrix4::translation( a.position + (b.position - a.position) * t ) * interpolate( a.rotation, b.rotation, t ) * Matrix4::scale( a.scale + (b.scale - a.scale) * t );
+        }
 
         if( transform->parent().valid() ) {
             T = transform->parent()->matrix() * T;
+            R = transform->parent()->renderMatrix() * R;
         }
 
         transform->setMatrix( T );
+        transform->setRenderMatrix( R );
     }
 }
 
 // ** AffineTransformSystem::entityAdded
 void AffineTransformSystem::entityAdded( const Ecs::Entity& entity )
 {
-    m_transforms.push_back( entity.get<Transform>() );
+    Transform* transform = entity.get<Transform>();
+
+    m_transforms.push_back( transform );
+    m_previous.push_back( stateOf( *transform ) );
+    m_simulated.push_back( stateOf( *transform ) );
 }
 
 // ** AffineTransformSystem::entityRemoved
@@ -71,8 +116,46 @@ void AffineTransformSystem::entityRemoved( const Ecs::Entity& entity )
     Array<Transform*>::iterator i = std::find( m_transforms.begin(), m_transforms.end(), entity.has<Transform>() );
     NIMBLE_ABORT_IF( i == m_transforms.end(), "no such transform" );
 
-    // Remove it from an array
+    // Remove it from an array with saved states
+    size_t index = std::distance( m_transforms.begin(), i );
     m_transforms.erase( i );
+    m_previous.erase( m_previous.begin() + index );
+    m_simulated.erase( m_simulated.begin() + index );
+}
+
+// ** AffineTransformSystem::stateOf
+AffineTransformSystem::State AffineTransformSystem::stateOf( const Transform& transform )
+{
+    State state;
+    state.position = transform.position();
+    state.rotation = transform.rotation();
+    state.scale    = transform.scale();
+    return state;
+}
+
+// ** AffineTransformSystem::isUnchanged
+bool AffineTransformSystem::isUnchanged( const Transform& transform, const State& state )
+{
+    const Vec3& position = transform.position();
+    const Quat& rotation = transform.rotation();
+    const Vec3& scale    = transform.scale();
+
+    return position.x == state.position.x && position.y == state.position.y && position.z == state.position.z
+        && rotation.x == state.rotation.x && rotation.y == state.rotation.y && rotation.z == state.rotation.z && rotation.w == state.rotation.w
+        && scale.x == state.scale.x && scale.y == state.scale.y && scale.z == state.scale.z;
+}
+
+// ** AffineTransformSystem::interpolate
+Quat AffineTransformSystem::interpolate( const Quat& a, const Quat& b, f32 factor )
+{
+    // Take a shortest arc by flipping a second rotation when quaternions point in opposite directions
+    f32 sign = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.0f ? -1.0f : 1.0f;
+
+    Vec3 axis = Vec3( a.x, a.y, a.z ) * (1.0f - factor) + Vec3( b.x, b.y, b.z ) * (factor * sign);
+    f32  w    = a.w * (1.0f - factor) + b.w * factor * sign;
+    f32  len  = sqrtf( axis.x * axis.x + axis.y * axis.y + axis.z * axis.z + w * w );
+
+    return Quat( axis / len, w / len );
 }
 
 // -------------------------------------------- WorldSpaceBoundingBoxSystem -------------------------------------------- //
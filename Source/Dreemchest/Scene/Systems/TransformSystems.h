@@ -36,7 +36,28 @@ DC_BEGIN_DREEMCHEST
 namespace Scene {
 
     //! Affine transform system calculates the transformation matricies for all transform components.
+    /*!
+    When a scene runs simulation systems with a fixed time step, a local state of each transform is saved
+    before and after simulation steps. Render matrices of transforms that were not changed after the last step
+    are calculated from a state interpolated between two last steps, so a rendered motion stays smooth
+    when a frame rate differs from a simulation rate. A simulated matrix is never interpolated, so systems
+    other than rendering stay deterministic.
+    */
     class AffineTransformSystem : public Ecs::GenericEntitySystem<AffineTransformSystem, Transform> {
+    public:
+
+                            //! Constructs an AffineTransformSystem instance.
+                            AffineTransformSystem( void );
+
+        //! Saves a local state of each transform before a simulation step.
+        void                beginSimulationStep( void );
+
+        //! Saves a local state of each transform after all simulation steps of a frame.
+        void                endSimulation( void );
+
+        //! Sets an interpolation factor between two last simulation steps, transforms are not interpolated when it is one.
+        void                setInterpolationFactor( f32 value );
+
     protected:
 
         //! Calculates the affine transform matrix for each transform component.
@@ -50,9 +71,30 @@ namespace Scene {
         //! Called when entity was removed.
         virtual void        entityRemoved( const Ecs::Entity& entity ) NIMBLE_OVERRIDE;
 
+    private:
+
+        //! A local state of a transform.
+        struct State {
+            Vec3            position;       //!< Transform position.
+            Quat            rotation;       //!< Transform rotation.
+            Vec3            scale;          //!< Transform scale.
+        };
+
+        //! Returns a local state of a transform.
+        static State        stateOf( const Transform& transform );
+
+        //! Returns true if a transform was not changed since a state was saved.
+        static bool         isUnchanged( const Transform& transform, const State& state );
+
+        //! Interpolates between two rotations.
+        static Quat         interpolate( const Quat& a, const Quat& b, f32 factor );
+
     private:
 
         Array<Transform*>    m_transforms;    //!< Active scene transform components.
+        Array<State>        m_previous;     //!< Transform states before the last simulation step.
+        Array<State>        m_simulated;    //!< Transform states after the last simulation step.
+        f32                 m_interpolationFactor;  //!< An interpolation factor between two last simulation steps.
     };
 
     //! World space bounding box system calculates bounding volumes for static meshes in scene.
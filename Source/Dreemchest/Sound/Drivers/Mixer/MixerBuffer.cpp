@@ -0,0 +1,223 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "MixerBuffer.h"
+
+#include "../../Decoders/SoundDecoder.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+// ** MixerBuffer::MixerBuffer
+MixerBuffer::MixerBuffer( SoundDecoderPtr decoder, u32 chunks )
+    : SoundBuffer( decoder, chunks )
+    , m_channels( 1 )
+    , m_bytesPerSample( 1 )
+    , m_rate( decoder->rate() )
+    , m_frameCount( 0 )
+    , m_readFrame( 0 )
+    , m_bufferedFrames( 0 )
+    , m_isFinished( false )
+{
+    switch( m_format ) {
+    case SoundSampleMono8:      m_channels = 1; m_bytesPerSample = 1; break;
+    case SoundSampleMono16:     m_channels = 1; m_bytesPerSample = 2; break;
+    case SoundSampleStereo8:    m_channels = 2; m_bytesPerSample = 1; break;
+    case SoundSampleStereo16:   m_channels = 2; m_bytesPerSample = 2; break;
+    }
+
+    m_decoder->seek( 0 );
+
+    // Streamed buffer only allocates a ring of decoded frames
+    if( isStreamed() ) {
+        m_frameCount = m_chunks * ChunkFrames;
+        m_samples.resize( m_frameCount * m_channels );
+        return;
+    }
+
+    // Decode the whole sound and release a decoder
+    m_frameCount = static_cast<u32>( m_size / ( m_channels * m_bytesPerSample ) );
+    m_samples.resize( m_frameCount * m_channels );
+
+    if( m_frameCount ) {
+        m_frameCount = decode( &m_samples[0], m_frameCount );
+    }
+
+    m_size    = m_samples.size() * sizeof( f32 );
+    m_decoder = SoundDecoderPtr();
+    m_pcm.clear();
+}
+
+// ** MixerBuffer::isStreamed
+bool MixerBuffer::isStreamed( void ) const
+{
+    return m_chunks > 1;
+}
+
+// ** MixerBuffer::channels
+u32 MixerBuffer::channels( void ) const
+{
+    return m_channels;
+}
+
+// ** MixerBuffer::rate
+u32 MixerBuffer::rate( void ) const
+{
+    return m_rate;
+}
+
+// ** MixerBuffer::frameCount
+u32 MixerBuffer::frameCount( void ) const
+{
+    return m_frameCount;
+}
+
+// ** MixerBuffer::samples
+const f32* MixerBuffer::samples( void ) const
+{
+    return m_samples.empty() ? NULL : &m_samples[0];
+}
+
+// ** MixerBuffer::bufferedFrames
+u32 MixerBuffer::bufferedFrames( void ) const
+{
+    return m_bufferedFrames;
+}
+
+// ** MixerBuffer::isStreamFinished
+bool MixerBuffer::isStreamFinished( void ) const
+{
+    return m_isFinished;
+}
+
+// ** MixerBuffer::updateStream
+bool MixerBuffer::updateStream( SoundSourceWPtr target, bool isLooped )
+{
+    if( !isStreamed() ) {
+        return false;
+    }
+
+    // Prevents an endless rewinding of an empty looped stream
+    bool isRewound = false;
+
+    while( m_bufferedFrames < m_frameCount && !m_isFinished ) {
+        // Decode into a contiguous free region of a ring
+        u32 writeFrame = ( m_readFrame + m_bufferedFrames ) % m_frameCount;
+        u32 free       = min2( m_frameCount - m_bufferedFrames, m_frameCount - writeFrame );
+        u32 decoded    = decode( &m_samples[writeFrame * m_channels], free );
+
+        m_bufferedFrames += decoded;
+
+        if( decoded ) {
+            isRewound = false;
+            continue;
+        }
+
+        // No more data - rewind a looped stream or mark it as finished
+        if( isLooped && !isRewound ) {
+            m_decoder->seek( 0 );
+            isRewound = true;
+        } else {
+            m_isFinished = true;
+        }
+    }
+
+    return m_isFinished && m_bufferedFrames == 0;
+}
+
+// ** MixerBuffer::readStream
+u32 MixerBuffer::readStream( f32* output, u32 frames )
+{
+    u32 count = min2( frames, m_bufferedFrames );
+
+    for( u32 i = 0; i < count; i++ ) {
+        const f32* frame = &m_samples[( ( m_readFrame + i ) % m_frameCount ) * m_channels];
+
+        for( u32 j = 0; j < m_channels; j++ ) {
+            output[i * m_channels + j] = frame[j];
+        }
+    }
+
+    return skipStream( count );
+}
+
+// ** MixerBuffer::skipStream
+u32 MixerBuffer::skipStream( u32 frames )
+{
+    u32 count = min2( frames, m_bufferedFrames );
+
+    m_readFrame       = m_frameCount ? ( m_readFrame + count ) % m_frameCount : 0;
+    m_bufferedFrames -= count;
+
+    return count;
+}
+
+// ** MixerBuffer::rewind
+void MixerBuffer::rewind( void )
+{
+    if( !isStreamed() ) {
+        return;
+    }
+
+    m_decoder->seek( 0 );
+    m_readFrame      = 0;
+    m_bufferedFrames = 0;
+    m_isFinished     = false;
+}
+
+// ** MixerBuffer::decode
+u32 MixerBuffer::decode( f32* output, u32 frames )
+{
+    u32 frameSize = m_channels * m_bytesPerSample;
+
+    if( m_pcm.size() < frames * frameSize ) {
+        m_pcm.resize( frames * frameSize );
+    }
+
+    u32 bytes  = m_decoder->read( &m_pcm[0], frames * frameSize );
+    u32 count  = bytes / frameSize;
+    u32 values = count * m_channels;
+
+    // Convert decoded samples to floats in [-1, 1] range
+    if( m_bytesPerSample == 2 ) {
+        const s16* pcm = reinterpret_cast<const s16*>( &m_pcm[0] );
+
+        for( u32 i = 0; i < values; i++ ) {
+            output[i] = pcm[i] / 32768.0f;
+        }
+    } else {
+        for( u32 i = 0; i < values; i++ ) {
+            output[i] = ( static_cast<s32>( m_pcm[i] ) - 128 ) / 128.0f;
+        }
+    }
+
+    return count;
+}
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
@@ -0,0 +1,106 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Sound_MixerBuffer_H__
+#define __DC_Sound_MixerBuffer_H__
+
+#include "../SoundBuffer.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+    //! A sound buffer that stores decoded samples as floats for a software mixer.
+    /*!
+        Non-streamed buffers are decoded at once and may be shared by several sources.
+        Streamed buffers are owned by a single source and keep a ring of decoded frames
+        that is refilled from a decoder by updateStream and consumed by a mixer.
+    */
+    class MixerBuffer : public SoundBuffer {
+    public:
+
+        //! A number of frames decoded per stream chunk.
+        enum { ChunkFrames = 4096 };
+
+                                //! Constructs MixerBuffer instance.
+                                MixerBuffer( SoundDecoderPtr decoder, u32 chunks );
+
+        //! Refills a stream ring with decoded frames, returns true when the stream is finished and consumed.
+        virtual bool            updateStream( SoundSourceWPtr target, bool isLooped ) NIMBLE_OVERRIDE;
+
+        //! Returns true if this buffer is streamed.
+        bool                    isStreamed( void ) const;
+
+        //! Returns a number of interleaved channels.
+        u32                     channels( void ) const;
+
+        //! Returns a sample rate.
+        u32                     rate( void ) const;
+
+        //! Returns a total number of frames in a non-streamed buffer.
+        u32                     frameCount( void ) const;
+
+        //! Returns decoded interleaved samples of a non-streamed buffer.
+        const f32*              samples( void ) const;
+
+        //! Returns a number of decoded frames ready to be consumed.
+        u32                     bufferedFrames( void ) const;
+
+        //! Returns true if a decoder reached the end of a non-looped stream.
+        bool                    isStreamFinished( void ) const;
+
+        //! Moves up to a given number of decoded frames from a stream ring to an output, returns a number of frames read.
+        u32                     readStream( f32* output, u32 frames );
+
+        //! Discards up to a given number of decoded frames, returns a number of frames skipped.
+        u32                     skipStream( u32 frames );
+
+        //! Rewinds a stream to the beginning.
+        void                    rewind( void );
+
+    private:
+
+        //! Reads and converts a given number of frames from a decoder, returns a number of frames decoded.
+        u32                     decode( f32* output, u32 frames );
+
+    private:
+
+        Array<f32>              m_samples;          //!< Decoded samples or a stream ring storage.
+        Array<u8>               m_pcm;              //!< Raw PCM data read from a decoder.
+        u32                     m_channels;         //!< A number of interleaved channels.
+        u32                     m_bytesPerSample;   //!< A size of a single sample in bytes.
+        u32                     m_rate;             //!< Sample rate.
+        u32                     m_frameCount;       //!< A total number of frames (ring capacity for streamed buffers).
+        u32                     m_readFrame;        //!< A ring read position.
+        u32                     m_bufferedFrames;   //!< A number of decoded frames inside a ring.
+        bool                    m_isFinished;       //!< Indicates that a decoder reached the end of a stream.
+    };
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Sound_MixerBuffer_H__    */
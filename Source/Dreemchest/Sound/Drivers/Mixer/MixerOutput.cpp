@@ -0,0 +1,149 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "MixerOutput.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+// ------------------------------------------------------ MixerOutput ------------------------------------------------------ //
+
+// ** MixerOutput::MixerOutput
+MixerOutput::MixerOutput( void )
+    : m_rate( 0 )
+{
+
+}
+
+MixerOutput::~MixerOutput( void )
+{
+
+}
+
+// ** MixerOutput::open
+bool MixerOutput::open( u32 rate )
+{
+    m_rate = rate;
+    return true;
+}
+
+// ** MixerOutput::rate
+u32 MixerOutput::rate( void ) const
+{
+    return m_rate;
+}
+
+// ------------------------------------------------------ MemoryMixerOutput ------------------------------------------------------ //
+
+// ** MemoryMixerOutput::MemoryMixerOutput
+MemoryMixerOutput::MemoryMixerOutput( void )
+    : m_frames( 0.0f )
+{
+
+}
+
+// ** MemoryMixerOutput::requestedFrames
+u32 MemoryMixerOutput::requestedFrames( f32 dt )
+{
+    m_frames += dt * m_rate;
+
+    u32 frames = static_cast<u32>( m_frames );
+    m_frames  -= frames;
+
+    return frames;
+}
+
+// ** MemoryMixerOutput::write
+void MemoryMixerOutput::write( const s16* samples, u32 frames )
+{
+    m_samples.insert( m_samples.end(), samples, samples + frames * 2 );
+}
+
+// ** MemoryMixerOutput::samples
+const Array<s16>& MemoryMixerOutput::samples( void ) const
+{
+    return m_samples;
+}
+
+// ** MemoryMixerOutput::frameCount
+u32 MemoryMixerOutput::frameCount( void ) const
+{
+    return static_cast<u32>( m_samples.size() / 2 );
+}
+
+// ** MemoryMixerOutput::clear
+void MemoryMixerOutput::clear( void )
+{
+    m_samples.clear();
+    m_frames = 0.0f;
+}
+
+// ** MemoryMixerOutput::saveToWave
+bool MemoryMixerOutput::saveToWave( const String& fileName ) const
+{
+    Io::StreamPtr stream = Io::DiskFileSystem::open( fileName, Io::BinaryWriteStream );
+
+    if( !stream.valid() ) {
+        LogWarning( "mixer", "failed to write a wave file '%s'\n", fileName.c_str() );
+        return false;
+    }
+
+    u32 dataSize   = static_cast<u32>( m_samples.size() * sizeof( s16 ) );
+    u32 chunkSize  = 36 + dataSize;
+    u32 formatSize = 16;
+    u16 pcm        = 1;
+    u16 channels   = 2;
+    u32 byteRate   = m_rate * channels * sizeof( s16 );
+    u16 blockAlign = channels * sizeof( s16 );
+    u16 bits       = 16;
+
+    // Write a RIFF header followed by a PCM format chunk
+    stream->write( "RIFF", 4 );
+    stream->write( &chunkSize, sizeof( chunkSize ) );
+    stream->write( "WAVEfmt ", 8 );
+    stream->write( &formatSize, sizeof( formatSize ) );
+    stream->write( &pcm, sizeof( pcm ) );
+    stream->write( &channels, sizeof( channels ) );
+    stream->write( &m_rate, sizeof( m_rate ) );
+    stream->write( &byteRate, sizeof( byteRate ) );
+    stream->write( &blockAlign, sizeof( blockAlign ) );
+    stream->write( &bits, sizeof( bits ) );
+
+    // Write samples
+    stream->write( "data", 4 );
+    stream->write( &dataSize, sizeof( dataSize ) );
+
+    if( dataSize ) {
+        stream->write( &m_samples[0], dataSize );
+    }
+
+    return true;
+}
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
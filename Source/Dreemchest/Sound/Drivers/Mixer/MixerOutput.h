@@ -0,0 +1,101 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Sound_MixerOutput_H__
+#define __DC_Sound_MixerOutput_H__
+
+#include "../../Sound.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+    dcDeclarePtrs( MixerOutput )
+    dcDeclarePtrs( MemoryMixerOutput )
+
+    //! A sink that receives a 16-bit stereo PCM stream produced by a software mixer.
+    class MixerOutput : public RefCounted {
+    public:
+
+                                MixerOutput( void );
+        virtual                 ~MixerOutput( void );
+
+        //! Opens an output with a given sample rate, returns true on success.
+        virtual bool            open( u32 rate );
+
+        //! Returns a number of frames that should be mixed and written to this output.
+        /*!
+         \param dt Time in seconds passed since last mixer update.
+         */
+        virtual u32             requestedFrames( f32 dt ) = 0;
+
+        //! Writes a block of interleaved stereo frames.
+        virtual void            write( const s16* samples, u32 frames ) = 0;
+
+        //! Returns an output sample rate.
+        u32                     rate( void ) const;
+
+    protected:
+
+        //! Output sample rate.
+        u32                     m_rate;
+    };
+
+    //! An output that accumulates mixed frames in memory, useful for tests and offline rendering.
+    class MemoryMixerOutput : public MixerOutput {
+    public:
+
+                                MemoryMixerOutput( void );
+
+        //! Returns a number of frames proportional to a passed time.
+        virtual u32             requestedFrames( f32 dt ) NIMBLE_OVERRIDE;
+
+        //! Appends frames to a memory buffer.
+        virtual void            write( const s16* samples, u32 frames ) NIMBLE_OVERRIDE;
+
+        //! Returns all interleaved stereo samples written so far.
+        const Array<s16>&       samples( void ) const;
+
+        //! Returns a total number of written frames.
+        u32                     frameCount( void ) const;
+
+        //! Removes all written samples.
+        void                    clear( void );
+
+        //! Saves all written samples to a WAV file.
+        bool                    saveToWave( const String& fileName ) const;
+
+    private:
+
+        Array<s16>              m_samples;  //!< Written interleaved stereo samples.
+        f32                     m_frames;   //!< A fractional number of frames accumulated by requestedFrames calls.
+    };
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Sound_MixerOutput_H__    */
@@ -0,0 +1,320 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "MixerSource.h"
+#include "MixerBuffer.h"
+#include "SoftwareMixer.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+// ** MixerSource::MixerSource
+MixerSource::MixerSource( SoftwareMixer* mixer )
+    : m_mixer( mixer )
+    , m_isRelative( false )
+    , m_referenceDistance( 1.0f )
+    , m_maximumDistance( FLT_MAX )
+    , m_rolloffFactor( 1.0f )
+    , m_cursor( 0.0 )
+    , m_audibility( 0.0f )
+    , m_isVirtual( false )
+    , m_streamFrames( 0 )
+{
+    m_gain[0] = m_gain[1] = 0.0f;
+    m_mixer->addSource( this );
+}
+
+MixerSource::~MixerSource( void )
+{
+    if( m_mixer ) {
+        m_mixer->removeSource( this );
+    }
+}
+
+// ** MixerSource::update
+void MixerSource::update( void )
+{
+    NIMBLE_ABORT_IF( !m_buffer.valid(), "invalid buffer" );
+
+    // Don't update stopped/paused sources
+    if( m_state != Playing ) {
+        return;
+    }
+
+    // Keep a stream ring filled, the source is stopped when all frames were consumed
+    bool completed = m_buffer->updateStream( this, isLooped() ) && m_streamFrames == 0;
+
+    if( completed ) {
+        SoundSource::setState( Stopped );
+    }
+}
+
+// ** MixerSource::setBuffer
+void MixerSource::setBuffer( SoundBufferPtr value )
+{
+    SoundSource::setBuffer( value );
+
+    m_cursor       = 0.0;
+    m_streamFrames = 0;
+}
+
+// ** MixerSource::setState
+void MixerSource::setState( SourceState value )
+{
+    // Restart a playback of a stopped source
+    if( value == Playing && m_state == Stopped && m_buffer.valid() ) {
+        m_cursor       = 0.0;
+        m_streamFrames = 0;
+        mixerBuffer()->rewind();
+    }
+
+    SoundSource::setState( value );
+}
+
+// ** MixerSource::setRelative
+void MixerSource::setRelative( bool value )
+{
+    m_isRelative = value;
+}
+
+// ** MixerSource::setReferenceDistance
+void MixerSource::setReferenceDistance( f32 value )
+{
+    m_referenceDistance = value;
+}
+
+// ** MixerSource::setMaximumDistance
+void MixerSource::setMaximumDistance( f32 value )
+{
+    m_maximumDistance = value;
+}
+
+// ** MixerSource::setRolloffFactor
+void MixerSource::setRolloffFactor( f32 value )
+{
+    m_rolloffFactor = value;
+}
+
+// ** MixerSource::isVirtual
+bool MixerSource::isVirtual( void ) const
+{
+    return m_isVirtual;
+}
+
+// ** MixerSource::audibility
+f32 MixerSource::audibility( void ) const
+{
+    return m_audibility;
+}
+
+// ** MixerSource::cursor
+f64 MixerSource::cursor( void ) const
+{
+    return m_cursor;
+}
+
+// ** MixerSource::mixerBuffer
+MixerBuffer* MixerSource::mixerBuffer( void ) const
+{
+    return static_cast<MixerBuffer*>( m_buffer.get() );
+}
+
+// ** MixerSource::attenuation
+f32 MixerSource::attenuation( f32 distance, DistanceModel model ) const
+{
+    // Distance models match clamped OpenAL models
+    f32 d = min2( max2( distance, m_referenceDistance ), m_maximumDistance );
+
+    switch( model ) {
+    case NoDistanceAttenutation:        return 1.0f;
+    case InverseDistanceAttenuation:    return m_referenceDistance / ( m_referenceDistance + m_rolloffFactor * ( d - m_referenceDistance ) );
+    case LinearDistanceAttenutation:    return max2( 1.0f - m_rolloffFactor * ( d - m_referenceDistance ) / ( m_maximumDistance - m_referenceDistance ), 0.0f );
+    case ExponentDistanceAttenuation:   return powf( d / m_referenceDistance, -m_rolloffFactor );
+    }
+
+    return 1.0f;
+}
+
+// ** MixerSource::updateGains
+void MixerSource::updateGains( const Vec3& listener, DistanceModel model )
+{
+    // Stereo sounds are not positioned in 3D
+    if( mixerBuffer()->channels() == 2 ) {
+        m_gain[0] = m_gain[1] = m_audibility = m_volume;
+        return;
+    }
+
+    Vec3 direction = m_isRelative ? m_position : m_position - listener;
+    f32  distance  = direction.length();
+    f32  gain      = m_volume * attenuation( distance, model );
+
+    // Equal power panning, a listener looks down the negative Z axis
+    f32 pan = distance > 0.0001f ? direction.x / distance : 0.0f;
+
+    m_gain[0]    = gain * sqrtf( 0.5f * ( 1.0f - pan ) );
+    m_gain[1]    = gain * sqrtf( 0.5f * ( 1.0f + pan ) );
+    m_audibility = gain;
+}
+
+// ** MixerSource::render
+u32 MixerSource::render( f32* output, u32 frames, f64 step )
+{
+    MixerBuffer* buffer   = mixerBuffer();
+    u32          channels = buffer->channels();
+
+    // Non-streamed sources are resampled right from a shared buffer
+    if( !buffer->isStreamed() ) {
+        u32 count    = buffer->frameCount();
+        u32 produced = resample( buffer->samples(), count, count, channels, isLooped(), output, frames, step );
+
+        if( produced < frames ) {
+            SoundSource::setState( Stopped );
+        }
+
+        return produced;
+    }
+
+    // Streamed sources keep one frame ahead for an interpolation until a stream is finished
+    fetchStream( frames, step );
+
+    bool finished = buffer->isStreamFinished() && buffer->bufferedFrames() == 0;
+    u32  limit    = finished || m_streamFrames == 0 ? m_streamFrames : m_streamFrames - 1;
+    u32  produced = resample( &m_stream[0], m_streamFrames, limit, channels, false, output, frames, step );
+
+    dropStream();
+
+    if( produced < frames && finished ) {
+        SoundSource::setState( Stopped );
+    }
+
+    return produced;
+}
+
+// ** MixerSource::advance
+void MixerSource::advance( u32 frames, f64 step )
+{
+    MixerBuffer* buffer = mixerBuffer();
+    f64          cursor = m_cursor + frames * step;
+
+    if( buffer->isStreamed() ) {
+        // Drop pulled frames first and then skip the rest right inside a stream ring
+        m_cursor = cursor;
+        dropStream();
+
+        u32 consumed = m_streamFrames == 0 ? static_cast<u32>( m_cursor ) : 0;
+        u32 skipped  = buffer->skipStream( consumed );
+        m_cursor    -= consumed;
+
+        if( skipped < consumed && buffer->isStreamFinished() && buffer->bufferedFrames() == 0 ) {
+            SoundSource::setState( Stopped );
+        }
+        return;
+    }
+
+    u32 count = buffer->frameCount();
+
+    if( cursor < count ) {
+        m_cursor = cursor;
+    } else if( isLooped() && count ) {
+        m_cursor = fmod( cursor, static_cast<f64>( count ) );
+    } else {
+        SoundSource::setState( Stopped );
+    }
+}
+
+// ** MixerSource::resample
+u32 MixerSource::resample( const f32* samples, u32 count, u32 limit, u32 channels, bool wrap, f32* output, u32 frames, f64 step )
+{
+    u32 i = 0;
+
+    for( ; i < frames; i++ ) {
+        // Wrap or stop at the end of samples
+        if( m_cursor >= limit ) {
+            if( !wrap || count == 0 ) {
+                break;
+            }
+
+            m_cursor = fmod( m_cursor, static_cast<f64>( count ) );
+        }
+
+        u32 a = static_cast<u32>( m_cursor );
+        u32 b = a + 1 < count ? a + 1 : ( wrap ? 0 : a );
+        f32 t = static_cast<f32>( m_cursor - a );
+
+        if( channels == 1 ) {
+            f32 value = samples[a] + ( samples[b] - samples[a] ) * t;
+            output[i * 2 + 0] = value;
+            output[i * 2 + 1] = value;
+        } else {
+            output[i * 2 + 0] = samples[a * 2 + 0] + ( samples[b * 2 + 0] - samples[a * 2 + 0] ) * t;
+            output[i * 2 + 1] = samples[a * 2 + 1] + ( samples[b * 2 + 1] - samples[a * 2 + 1] ) * t;
+        }
+
+        m_cursor += step;
+    }
+
+    return i;
+}
+
+// ** MixerSource::fetchStream
+void MixerSource::fetchStream( u32 frames, f64 step )
+{
+    MixerBuffer* buffer   = mixerBuffer();
+    u32          channels = buffer->channels();
+    u32          required = static_cast<u32>( m_cursor + frames * step ) + 2;
+
+    if( m_stream.size() < required * channels ) {
+        m_stream.resize( required * channels );
+    }
+
+    if( m_streamFrames < required ) {
+        m_streamFrames += buffer->readStream( &m_stream[m_streamFrames * channels], required - m_streamFrames );
+    }
+}
+
+// ** MixerSource::dropStream
+void MixerSource::dropStream( void )
+{
+    u32 channels = mixerBuffer()->channels();
+    u32 consumed = min2( static_cast<u32>( m_cursor ), m_streamFrames );
+
+    if( consumed == 0 ) {
+        return;
+    }
+
+    // Move remaining frames to the beginning of a stream array
+    for( u32 i = consumed * channels, n = m_streamFrames * channels; i < n; i++ ) {
+        m_stream[i - consumed * channels] = m_stream[i];
+    }
+
+    m_streamFrames -= consumed;
+    m_cursor       -= consumed;
+}
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
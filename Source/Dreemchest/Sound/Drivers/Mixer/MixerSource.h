@@ -0,0 +1,123 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Sound_MixerSource_H__
+#define __DC_Sound_MixerSource_H__
+
+#include "../SoundSource.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+    class SoftwareMixer;
+    class MixerBuffer;
+
+    //! A sound source played by a software mixer.
+    class MixerSource : public SoundSource {
+    friend class SoftwareMixer;
+    public:
+
+                                //! Constructs MixerSource instance.
+                                MixerSource( SoftwareMixer* mixer );
+        virtual                 ~MixerSource( void );
+
+        //! Refills a stream ring of a streamed buffer.
+        virtual void            update( void ) NIMBLE_OVERRIDE;
+
+        //! Sets a sound buffer and rewinds a playback cursor.
+        virtual void            setBuffer( SoundBufferPtr value ) NIMBLE_OVERRIDE;
+
+        //! Sets a sound source state, a stopped source is rewound when started again.
+        virtual void            setState( SourceState value ) NIMBLE_OVERRIDE;
+
+        //! Sets sound source relative flag.
+        virtual void            setRelative( bool value ) NIMBLE_OVERRIDE;
+
+        //! Sets the reference distance value.
+        virtual void            setReferenceDistance( f32 value ) NIMBLE_OVERRIDE;
+
+        //! Sets the maximum distance value.
+        virtual void            setMaximumDistance( f32 value ) NIMBLE_OVERRIDE;
+
+        //! Sets the rollof factor value.
+        virtual void            setRolloffFactor( f32 value ) NIMBLE_OVERRIDE;
+
+        //! Returns true if this source is playing but is not mixed.
+        bool                    isVirtual( void ) const;
+
+        //! Returns a source gain after the distance attenuation was applied.
+        f32                     audibility( void ) const;
+
+        //! Returns a fractional playback position in source frames.
+        f64                     cursor( void ) const;
+
+    private:
+
+        //! Returns an attached mixer buffer.
+        MixerBuffer*            mixerBuffer( void ) const;
+
+        //! Calculates a distance attenuation factor.
+        f32                     attenuation( f32 distance, DistanceModel model ) const;
+
+        //! Calculates left and right channel gains relative to a listener.
+        void                    updateGains( const Vec3& listener, DistanceModel model );
+
+        //! Resamples and writes up to a given number of stereo frames, returns a number of frames written.
+        u32                     render( f32* output, u32 frames, f64 step );
+
+        //! Advances a playback cursor of a virtual source without mixing it.
+        void                    advance( u32 frames, f64 step );
+
+        //! Resamples frames from a given sample array with a linear interpolation.
+        u32                     resample( const f32* samples, u32 count, u32 limit, u32 channels, bool wrap, f32* output, u32 frames, f64 step );
+
+        //! Pulls enough decoded frames from a stream to render a given number of output frames.
+        void                    fetchStream( u32 frames, f64 step );
+
+        //! Drops stream frames that were passed by a playback cursor.
+        void                    dropStream( void );
+
+    private:
+
+        SoftwareMixer*          m_mixer;                //!< A parent mixer instance.
+        bool                    m_isRelative;           //!< Indicates that a position is relative to a listener.
+        f32                     m_referenceDistance;    //!< Reference distance value.
+        f32                     m_maximumDistance;      //!< Maximum distance value.
+        f32                     m_rolloffFactor;        //!< Rolloff factor value.
+        f64                     m_cursor;               //!< A fractional playback position in source frames.
+        f32                     m_gain[2];              //!< Left and right channel gains.
+        f32                     m_audibility;           //!< A source gain with a distance attenuation applied.
+        bool                    m_isVirtual;            //!< Indicates that a source is not mixed during a last update.
+        Array<f32>              m_stream;               //!< Stream frames pulled from a ring but not played yet.
+        u32                     m_streamFrames;         //!< A number of pulled stream frames.
+    };
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Sound_MixerSource_H__    */
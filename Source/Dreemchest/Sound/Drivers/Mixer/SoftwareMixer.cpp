@@ -0,0 +1,308 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "SoftwareMixer.h"
+#include "MixerSource.h"
+#include "MixerBuffer.h"
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+    #define DC_SOUND_SSE    1
+    #include <xmmintrin.h>
+#else
+    #define DC_SOUND_SSE    0
+#endif
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+//! Voices quieter than this gain are always virtualized.
+static const f32 kAudibilityThreshold = 0.001f;
+
+// ** SoftwareMixer::SoftwareMixer
+SoftwareMixer::SoftwareMixer( MixerOutputPtr output, u32 maxVoices, u32 rate )
+    : m_output( output )
+    , m_rate( rate )
+    , m_maxVoices( maxVoices )
+    , m_activeVoices( 0 )
+    , m_volume( 1.0f )
+    , m_pitch( 1.0f )
+    , m_distanceModel( InverseDistanceAttenuation )
+{
+    NIMBLE_ABORT_IF( !output.valid(), "invalid mixer output" );
+
+    m_mix.resize( BlockFrames * 2 );
+    m_voice.resize( BlockFrames * 2 );
+    m_pcm.resize( BlockFrames * 2 );
+}
+
+SoftwareMixer::~SoftwareMixer( void )
+{
+    // Sources may outlive a mixer
+    for( u32 i = 0, n = static_cast<u32>( m_sources.size() ); i < n; i++ ) {
+        m_sources[i]->m_mixer = NULL;
+    }
+}
+
+// ** SoftwareMixer::initialize
+bool SoftwareMixer::initialize( void )
+{
+    if( !m_output->open( m_rate ) ) {
+        LogError( "mixer", "failed to open mixer output with %d Hz sample rate\n", m_rate );
+        return false;
+    }
+
+    LogVerbose( "mixer", "software mixer initialized, %d Hz, %d voices\n", m_rate, m_maxVoices );
+    return true;
+}
+
+// ** SoftwareMixer::createSource
+SoundSourcePtr SoftwareMixer::createSource( void )
+{
+    return DC_NEW MixerSource( this );
+}
+
+// ** SoftwareMixer::createBuffer
+SoundBufferPtr SoftwareMixer::createBuffer( SoundDecoderPtr decoder, u32 chunks )
+{
+    NIMBLE_ABORT_IF( !decoder.valid(), "invalid decoder" );
+    return DC_NEW MixerBuffer( decoder, chunks );
+}
+
+// ** SoftwareMixer::setVolume
+void SoftwareMixer::setVolume( f32 value )
+{
+    m_volume = value;
+}
+
+// ** SoftwareMixer::setPitch
+void SoftwareMixer::setPitch( f32 value )
+{
+    m_pitch = value;
+}
+
+// ** SoftwareMixer::setPosition
+void SoftwareMixer::setPosition( const Vec3& value )
+{
+    m_listener = value;
+}
+
+// ** SoftwareMixer::setDistanceModel
+void SoftwareMixer::setDistanceModel( DistanceModel value )
+{
+    m_distanceModel = value;
+}
+
+// ** SoftwareMixer::output
+MixerOutputWPtr SoftwareMixer::output( void ) const
+{
+    return m_output;
+}
+
+// ** SoftwareMixer::maxVoices
+u32 SoftwareMixer::maxVoices( void ) const
+{
+    return m_maxVoices;
+}
+
+// ** SoftwareMixer::setMaxVoices
+void SoftwareMixer::setMaxVoices( u32 value )
+{
+    m_maxVoices = value;
+}
+
+// ** SoftwareMixer::activeVoiceCount
+u32 SoftwareMixer::activeVoiceCount( void ) const
+{
+    return m_activeVoices;
+}
+
+// ** SoftwareMixer::virtualVoiceCount
+u32 SoftwareMixer::virtualVoiceCount( void ) const
+{
+    return static_cast<u32>( m_voices.size() ) - m_activeVoices;
+}
+
+// ** SoftwareMixer::addSource
+void SoftwareMixer::addSource( MixerSource* source )
+{
+    m_sources.push_back( source );
+}
+
+// ** SoftwareMixer::removeSource
+void SoftwareMixer::removeSource( MixerSource* source )
+{
+    Array<MixerSource*>::iterator i = std::find( m_sources.begin(), m_sources.end(), source );
+
+    if( i != m_sources.end() ) {
+        m_sources.erase( i );
+    }
+}
+
+// ** SoftwareMixer::update
+void SoftwareMixer::update( f32 dt )
+{
+    mix( m_output->requestedFrames( dt ) );
+}
+
+// ** SoftwareMixer::mix
+void SoftwareMixer::mix( u32 frames )
+{
+    if( frames == 0 ) {
+        return;
+    }
+
+    // Voices are selected once per update, so virtualization costs are amortized
+    selectVoices();
+
+    while( frames ) {
+        u32 count = min2( frames, static_cast<u32>( BlockFrames ) );
+
+        std::fill( m_mix.begin(), m_mix.begin() + count * 2, 0.0f );
+
+        for( u32 i = 0, n = static_cast<u32>( m_voices.size() ); i < n; i++ ) {
+            MixerSource* voice = m_voices[i];
+
+            // A voice may be stopped while mixing a previous block
+            if( voice->state() != SoundSource::Playing ) {
+                continue;
+            }
+
+            // Resampling step between a source and an output sample rates
+            f64 step = static_cast<f64>( voice->mixerBuffer()->rate() ) / m_rate * voice->pitch() * m_pitch;
+
+            if( voice->isVirtual() ) {
+                voice->advance( count, step );
+                continue;
+            }
+
+            u32 produced = voice->render( &m_voice[0], count, step );
+            accumulate( &m_mix[0], &m_voice[0], voice->m_gain[0], voice->m_gain[1], produced );
+        }
+
+        convert( &m_pcm[0], &m_mix[0], m_volume, count * 2 );
+        m_output->write( &m_pcm[0], count );
+
+        frames -= count;
+    }
+}
+
+// ** SoftwareMixer::selectVoices
+void SoftwareMixer::selectVoices( void )
+{
+    m_voices.clear();
+
+    for( u32 i = 0, n = static_cast<u32>( m_sources.size() ); i < n; i++ ) {
+        MixerSource* source = m_sources[i];
+
+        if( source->state() != SoundSource::Playing || !source->buffer().valid() ) {
+            continue;
+        }
+
+        source->updateGains( m_listener, m_distanceModel );
+        m_voices.push_back( source );
+    }
+
+    // Most important and loudest voices go first
+    std::sort( m_voices.begin(), m_voices.end(), compareVoices );
+
+    m_activeVoices = 0;
+
+    for( u32 i = 0, n = static_cast<u32>( m_voices.size() ); i < n; i++ ) {
+        MixerSource* voice = m_voices[i];
+
+        voice->m_isVirtual = m_activeVoices >= m_maxVoices || voice->audibility() < kAudibilityThreshold;
+
+        if( !voice->m_isVirtual ) {
+            m_activeVoices++;
+        }
+    }
+}
+
+// ** SoftwareMixer::compareVoices
+bool SoftwareMixer::compareVoices( const MixerSource* a, const MixerSource* b )
+{
+    if( a->priority() != b->priority() ) {
+        return a->priority() > b->priority();
+    }
+
+    return a->audibility() > b->audibility();
+}
+
+// ** SoftwareMixer::accumulate
+void SoftwareMixer::accumulate( f32* output, const f32* input, f32 left, f32 right, u32 frames )
+{
+    u32 i = 0;
+
+#if DC_SOUND_SSE
+    // Two stereo frames are mixed at once
+    __m128 gain = _mm_setr_ps( left, right, left, right );
+
+    for( ; i + 2 <= frames; i += 2 ) {
+        __m128 mixed = _mm_loadu_ps( output + i * 2 );
+        __m128 voice = _mm_loadu_ps( input + i * 2 );
+        _mm_storeu_ps( output + i * 2, _mm_add_ps( mixed, _mm_mul_ps( voice, gain ) ) );
+    }
+#endif  /*  DC_SOUND_SSE    */
+
+    for( ; i < frames; i++ ) {
+        output[i * 2 + 0] += input[i * 2 + 0] * left;
+        output[i * 2 + 1] += input[i * 2 + 1] * right;
+    }
+}
+
+// ** SoftwareMixer::convert
+void SoftwareMixer::convert( s16* output, const f32* input, f32 volume, u32 count )
+{
+    u32 i     = 0;
+    f32 scale = volume * 32767.0f;
+
+#if DC_SOUND_SSE
+    __m128 factor = _mm_set1_ps( scale );
+    __m128 lower  = _mm_set1_ps( -32768.0f );
+    __m128 upper  = _mm_set1_ps( 32767.0f );
+
+    for( ; i + 4 <= count; i += 4 ) {
+        f32 values[4];
+        _mm_storeu_ps( values, _mm_min_ps( _mm_max_ps( _mm_mul_ps( _mm_loadu_ps( input + i ), factor ), lower ), upper ) );
+
+        output[i + 0] = static_cast<s16>( values[0] );
+        output[i + 1] = static_cast<s16>( values[1] );
+        output[i + 2] = static_cast<s16>( values[2] );
+        output[i + 3] = static_cast<s16>( values[3] );
+    }
+#endif  /*  DC_SOUND_SSE    */
+
+    for( ; i < count; i++ ) {
+        // Scale by the same factor as a vectorized loop, so both paths round identically
+        f32 value = input[i] * scale;
+        output[i] = static_cast<s16>( min2( max2( value, -32768.0f ), 32767.0f ) );
+    }
+}
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
@@ -0,0 +1,144 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Sound_SoftwareMixer_H__
+#define __DC_Sound_SoftwareMixer_H__
+
+#include "../SoundEngine.h"
+#include "MixerOutput.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+    class MixerSource;
+
+    //! A sound engine that mixes all sources in software and writes a single stereo stream to an output.
+    /*!
+        Each update playing sources are sorted by a priority and audibility, only the first
+        maxVoices audible sources are resampled and mixed. The rest of sources become virtual:
+        their playback cursors keep advancing, so they resume at a correct position once they
+        become audible again, but no mixing work is done for them.
+    */
+    class SoftwareMixer : public SoundEngine {
+    friend class MixerSource;
+    public:
+
+        //! Default mixer parameters.
+        enum {
+              DefaultRate       = 44100 //!< Default output sample rate.
+            , DefaultMaxVoices  = 32    //!< Default number of mixed voices.
+            , BlockFrames       = 1024  //!< A maximum number of frames mixed at once.
+        };
+
+                                //! Constructs SoftwareMixer instance.
+                                SoftwareMixer( MixerOutputPtr output, u32 maxVoices = DefaultMaxVoices, u32 rate = DefaultRate );
+        virtual                 ~SoftwareMixer( void );
+
+        //! Opens a mixer output.
+        virtual bool            initialize( void ) NIMBLE_OVERRIDE;
+
+        //! Creates a new software sound source.
+        virtual SoundSourcePtr  createSource( void ) NIMBLE_OVERRIDE;
+
+        //! Creates a new software sound buffer.
+        virtual SoundBufferPtr  createBuffer( SoundDecoderPtr decoder, u32 chunks ) NIMBLE_OVERRIDE;
+
+        //! Sets the master volume.
+        virtual void            setVolume( f32 value ) NIMBLE_OVERRIDE;
+
+        //! Sets the master pitch.
+        virtual void            setPitch( f32 value ) NIMBLE_OVERRIDE;
+
+        //! Sets the listener position.
+        virtual void            setPosition( const Vec3& value ) NIMBLE_OVERRIDE;
+
+        //! Sets the distance attenuation model.
+        virtual void            setDistanceModel( DistanceModel value ) NIMBLE_OVERRIDE;
+
+        //! Mixes a number of frames requested by an output.
+        virtual void            update( f32 dt ) NIMBLE_OVERRIDE;
+
+        //! Mixes a given number of frames and writes them to an output.
+        void                    mix( u32 frames );
+
+        //! Returns a mixer output.
+        MixerOutputWPtr         output( void ) const;
+
+        //! Returns a maximum number of mixed voices.
+        u32                     maxVoices( void ) const;
+
+        //! Sets a maximum number of mixed voices.
+        void                    setMaxVoices( u32 value );
+
+        //! Returns a number of voices mixed during a last update.
+        u32                     activeVoiceCount( void ) const;
+
+        //! Returns a number of playing voices that were not mixed during a last update.
+        u32                     virtualVoiceCount( void ) const;
+
+        //! Adds stereo frames scaled by left and right gains to an output, pairs of frames are mixed with SSE when available.
+        static void             accumulate( f32* output, const f32* input, f32 left, f32 right, u32 frames );
+
+        //! Converts float samples to clamped 16-bit integers, groups of four samples are converted with SSE when available.
+        static void             convert( s16* output, const f32* input, f32 volume, u32 count );
+
+    private:
+
+        //! Registers a created source.
+        void                    addSource( MixerSource* source );
+
+        //! Unregisters a destroyed source.
+        void                    removeSource( MixerSource* source );
+
+        //! Selects voices to be mixed, the rest of playing sources are virtualized.
+        void                    selectVoices( void );
+
+        //! Returns true if a first voice should be mixed before a second one.
+        static bool             compareVoices( const MixerSource* a, const MixerSource* b );
+
+    private:
+
+        MixerOutputPtr          m_output;           //!< A mixer output.
+        Array<MixerSource*>     m_sources;          //!< All alive sources.
+        Array<MixerSource*>     m_voices;           //!< Playing sources sorted by an importance.
+        Array<f32>              m_mix;              //!< A mixed block of frames.
+        Array<f32>              m_voice;            //!< A resampled block of voice frames.
+        Array<s16>              m_pcm;              //!< A converted block of frames.
+        u32                     m_rate;             //!< Output sample rate.
+        u32                     m_maxVoices;        //!< A maximum number of mixed voices.
+        u32                     m_activeVoices;     //!< A number of voices mixed during a last update.
+        f32                     m_volume;           //!< Master volume.
+        f32                     m_pitch;            //!< Master pitch.
+        Vec3                    m_listener;         //!< Listener position.
+        DistanceModel           m_distanceModel;    //!< Distance attenuation model.
+    };
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Sound_SoftwareMixer_H__    */
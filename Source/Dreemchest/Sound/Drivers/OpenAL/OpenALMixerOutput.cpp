@@ -0,0 +1,124 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "OpenALMixerOutput.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+// ** OpenALMixerOutput::OpenALMixerOutput
+OpenALMixerOutput::OpenALMixerOutput( void )
+    : m_source( 0 )
+{
+
+}
+
+OpenALMixerOutput::~OpenALMixerOutput( void )
+{
+    if( !m_source ) {
+        return;
+    }
+
+    alSourceStop( m_source );
+    alSourcei( m_source, AL_BUFFER, 0 );
+    alDeleteSources( 1, &m_source );
+    alDeleteBuffers( static_cast<ALsizei>( m_buffers.size() ), &m_buffers[0] );
+
+    OpenAL::dumpErrors( "OpenALMixerOutput::~OpenALMixerOutput" );
+}
+
+// ** OpenALMixerOutput::open
+bool OpenALMixerOutput::open( u32 rate )
+{
+    MixerOutput::open( rate );
+
+    // Create an OpenAL device and context
+    m_device = DC_NEW OpenAL;
+
+    if( !m_device->initialize() ) {
+        m_device = SoundEnginePtr();
+        return false;
+    }
+
+    // Create a source and all buffers, initially all buffers are free
+    alGenSources( 1, &m_source );
+    alSourcei( m_source, AL_SOURCE_RELATIVE, AL_TRUE );
+
+    m_buffers.resize( BufferCount );
+    alGenBuffers( BufferCount, &m_buffers[0] );
+    m_free = m_buffers;
+
+    OpenAL::dumpErrors( "OpenALMixerOutput::open" );
+
+    return true;
+}
+
+// ** OpenALMixerOutput::requestedFrames
+u32 OpenALMixerOutput::requestedFrames( f32 dt )
+{
+    // Reclaim all played buffers
+    ALint processed = 0;
+    alGetSourcei( m_source, AL_BUFFERS_PROCESSED, &processed );
+
+    while( processed-- ) {
+        ALuint buffer = 0;
+        alSourceUnqueueBuffers( m_source, 1, &buffer );
+        m_free.push_back( buffer );
+    }
+
+    return static_cast<u32>( m_free.size() ) * BufferFrames;
+}
+
+// ** OpenALMixerOutput::write
+void OpenALMixerOutput::write( const s16* samples, u32 frames )
+{
+    while( frames && !m_free.empty() ) {
+        u32    count  = min2( frames, static_cast<u32>( BufferFrames ) );
+        ALuint buffer = m_free.back();
+        m_free.pop_back();
+
+        alBufferData( buffer, AL_FORMAT_STEREO16, samples, count * 2 * sizeof( s16 ), m_rate );
+        alSourceQueueBuffers( m_source, 1, &buffer );
+
+        samples += count * 2;
+        frames  -= count;
+    }
+
+    // Restart a source after an underrun
+    ALint state = 0;
+    alGetSourcei( m_source, AL_SOURCE_STATE, &state );
+
+    if( state != AL_PLAYING ) {
+        alSourcePlay( m_source );
+    }
+
+    OpenAL::dumpErrors( "OpenALMixerOutput::write" );
+}
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
@@ -0,0 +1,67 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_OpenALMixerOutput_H__
+#define __DC_OpenALMixerOutput_H__
+
+#include "OpenAL.h"
+#include "../Mixer/MixerOutput.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+    //! Plays a software mixer output through a single streamed OpenAL source.
+    class OpenALMixerOutput : public MixerOutput {
+    public:
+
+        //! Stream parameters.
+        enum {
+              BufferCount   = 4     //!< A number of queued OpenAL buffers.
+            , BufferFrames  = 1024  //!< A number of frames per OpenAL buffer.
+        };
+
+                                OpenALMixerOutput( void );
+        virtual                 ~OpenALMixerOutput( void ) NIMBLE_OVERRIDE;
+
+        // ** MixerOutput
+        virtual bool            open( u32 rate ) NIMBLE_OVERRIDE;
+        virtual u32             requestedFrames( f32 dt ) NIMBLE_OVERRIDE;
+        virtual void            write( const s16* samples, u32 frames ) NIMBLE_OVERRIDE;
+
+    private:
+
+        SoundEnginePtr          m_device;   //!< OpenAL device and context.
+        ALuint                  m_source;   //!< A streamed OpenAL source.
+        Array<ALuint>           m_buffers;  //!< All OpenAL buffers.
+        Array<ALuint>           m_free;     //!< OpenAL buffers that are ready to be filled.
+    };
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
+
+#endif        /*    __DC_OpenALMixerOutput_H__    */
@@ -88,6 +88,11 @@ void SoundEngine::setDistanceModel( DistanceModel value )
 {
 }
 
+// ** SoundEngine::update
+void SoundEngine::update( f32 dt )
+{
+}
+
 // ** SoundEngine::createSoundDecoder
 SoundDecoderPtr SoundEngine::createSoundDecoder( SoundContainerFormat format ) const
 {
@@ -55,6 +55,9 @@ namespace Sound {
         //! Sets the distance attenuation model.
         virtual void            setDistanceModel( DistanceModel value );
 
+        //! Updates a sound engine, called each frame after all channels were updated.
+        virtual void            update( f32 dt );
+
         //! Creates a new hardware sound source.
         virtual SoundSourcePtr    createSource( void );
 
@@ -32,7 +32,7 @@ DC_BEGIN_DREEMCHEST
 namespace Sound {
 
 // ** SoundSource::SoundSource
-SoundSource::SoundSource( void ) : m_state( Unknown ), m_isLooped( false ), m_volume( 1.0f ), m_pitch( 1.0f )
+SoundSource::SoundSource( void ) : m_state( Unknown ), m_isLooped( false ), m_volume( 1.0f ), m_pitch( 1.0f ), m_priority( 0 )
 {
 
 }
@@ -119,6 +119,18 @@ void SoundSource::setPosition( const Vec3& value )
     m_position = value;
 }
 
+// ** SoundSource::priority
+u32 SoundSource::priority( void ) const
+{
+    return m_priority;
+}
+
+// ** SoundSource::setPriority
+void SoundSource::setPriority( u32 value )
+{
+    m_priority = value;
+}
+
 } // namespace Sound
 
 DC_END_DREEMCHEST
\ No newline at end of file
@@ -101,6 +101,12 @@ namespace Sound {
         //! Sets the rollof factor value.
         virtual void            setRolloffFactor( f32 value ) = 0;
 
+        //! Returns a sound source playback priority.
+        u32                     priority( void ) const;
+
+        //! Sets a sound source playback priority (used by engines that virtualize voices).
+        virtual void            setPriority( u32 value );
+
     protected:
 
         //! Strong pointer to a hardware sound buffer.
@@ -120,6 +126,9 @@ namespace Sound {
 
         //! Source source position.
         Vec3                    m_position;
+
+        //! Sound source playback priority.
+        u32                     m_priority;
     };
 
 } // namespace Sound
@@ -0,0 +1,137 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "PcmCache.h"
+
+#include "Drivers/SoundBuffer.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+// ** PcmCache::PcmCache
+PcmCache::PcmCache( u64 capacity )
+    : m_size( 0 )
+    , m_capacity( capacity )
+    , m_stamp( 0 )
+{
+
+}
+
+// ** PcmCache::find
+SoundBufferPtr PcmCache::find( CString uri )
+{
+    Entries::iterator i = m_entries.find( String64( uri ) );
+
+    if( i == m_entries.end() ) {
+        return SoundBufferPtr();
+    }
+
+    i->second.lastUsed = ++m_stamp;
+    return i->second.buffer;
+}
+
+// ** PcmCache::insert
+void PcmCache::insert( CString uri, SoundBufferPtr buffer )
+{
+    NIMBLE_ABORT_IF( !buffer.valid(), "invalid sound buffer" );
+
+    // Replace a previously cached buffer
+    remove( uri );
+
+    Entry entry;
+    entry.buffer   = buffer;
+    entry.lastUsed = ++m_stamp;
+
+    m_entries[String64( uri )] = entry;
+    m_size += buffer->size();
+
+    // Keep the most recent buffer even if it is larger than a whole cache
+    trim();
+}
+
+// ** PcmCache::remove
+void PcmCache::remove( CString uri )
+{
+    Entries::iterator i = m_entries.find( String64( uri ) );
+
+    if( i == m_entries.end() ) {
+        return;
+    }
+
+    m_size -= i->second.buffer->size();
+    m_entries.erase( i );
+}
+
+// ** PcmCache::clear
+void PcmCache::clear( void )
+{
+    m_entries.clear();
+    m_size = 0;
+}
+
+// ** PcmCache::size
+u64 PcmCache::size( void ) const
+{
+    return m_size;
+}
+
+// ** PcmCache::capacity
+u64 PcmCache::capacity( void ) const
+{
+    return m_capacity;
+}
+
+// ** PcmCache::setCapacity
+void PcmCache::setCapacity( u64 value )
+{
+    m_capacity = value;
+    trim();
+}
+
+// ** PcmCache::trim
+void PcmCache::trim( void )
+{
+    while( m_size > m_capacity && m_entries.size() > 1 ) {
+        // Find the least recently used buffer
+        Entries::iterator oldest = m_entries.begin();
+
+        for( Entries::iterator i = m_entries.begin(), end = m_entries.end(); i != end; ++i ) {
+            if( i->second.lastUsed < oldest->second.lastUsed ) {
+                oldest = i;
+            }
+        }
+
+        LogVerbose( "sfx", "%d bytes of PCM data evicted from cache\n", static_cast<s32>( oldest->second.buffer->size() ) );
+
+        m_size -= oldest->second.buffer->size();
+        m_entries.erase( oldest );
+    }
+}
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
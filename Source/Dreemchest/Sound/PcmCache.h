@@ -0,0 +1,96 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Sound_PcmCache_H__
+#define __DC_Sound_PcmCache_H__
+
+#include "Sound.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+    //! A size-bounded cache of decoded PCM buffers shared by all channels of a SoundFx.
+    /*!
+        Non-streamed sounds are decoded once and the resulting sound buffer is reused by every
+        channel that plays the same asset. When the total size of cached buffers exceeds the
+        capacity the least recently used buffers are evicted, channels that are still playing
+        an evicted buffer keep it alive until the playback is finished.
+    */
+    class PcmCache : public RefCounted {
+    public:
+
+                                //! Constructs a PcmCache instance with a given capacity in bytes.
+                                PcmCache( u64 capacity );
+
+        //! Returns a cached sound buffer for a given asset URI or NULL if it was not cached yet.
+        SoundBufferPtr          find( CString uri );
+
+        //! Puts a decoded sound buffer to a cache and evicts least recently used buffers if needed.
+        void                    insert( CString uri, SoundBufferPtr buffer );
+
+        //! Removes a sound buffer of a given asset URI from a cache.
+        void                    remove( CString uri );
+
+        //! Removes all cached buffers.
+        void                    clear( void );
+
+        //! Returns a total size of cached PCM data in bytes.
+        u64                     size( void ) const;
+
+        //! Returns a maximum size of cached PCM data in bytes.
+        u64                     capacity( void ) const;
+
+        //! Sets a maximum size of cached PCM data in bytes.
+        void                    setCapacity( u64 value );
+
+    private:
+
+        //! Evicts least recently used buffers until the cache fits the capacity.
+        void                    trim( void );
+
+    private:
+
+        //! A single cached PCM buffer.
+        struct Entry {
+            SoundBufferPtr      buffer;     //!< A decoded sound buffer.
+            u32                 lastUsed;   //!< A cache access stamp when this buffer was used last time.
+        };
+
+        //! Container type to store cached buffers by asset URI.
+        typedef Hash<Entry>     Entries;
+
+        Entries                 m_entries;  //!< Cached PCM buffers.
+        u64                     m_size;     //!< A total size of cached PCM data.
+        u64                     m_capacity; //!< A maximum size of cached PCM data.
+        u32                     m_stamp;    //!< A cache access counter.
+    };
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Sound_PcmCache_H__    */
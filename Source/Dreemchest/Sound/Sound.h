@@ -68,6 +68,8 @@ namespace Sound {
     dcDeclarePtrs( SoundGroup )
     dcDeclarePtrs( SoundEvent )
     dcDeclarePtrs( Fader )
+    dcDeclarePtrs( SoundStreamer )
+    dcDeclarePtrs( PcmCache )
 
     dcDeclarePtrs( SoundEngine )
     dcDeclarePtrs( SoundBuffer )
@@ -92,6 +94,51 @@ namespace Sound {
     //! Container type to store sound channel strong pointers.
     typedef Array<SoundChannelPtr> SoundChannels;
 
+    //! An interned name of a sound, group or event registered inside a SoundFx.
+    /*!
+        A handle is an index into a SoundFx name table, so resolving it does not
+        involve any string hashing. Names are interned forever, a handle stays valid
+        while an asset is removed, renamed or recreated and resolves to NULL when
+        no asset with this name exists.
+    */
+    template<typename T>
+    class SoundFxHandle {
+    public:
+
+                        //! Constructs an invalid handle.
+                        SoundFxHandle( void )
+                            : m_index( ~0u ) {}
+
+                        //! Constructs a handle with a name table index.
+                        explicit SoundFxHandle( u32 index )
+                            : m_index( index ) {}
+
+        //! Returns true if this handle was interned by a SoundFx.
+        bool            isValid( void ) const { return m_index != ~0u; }
+
+        //! Returns a name table index.
+        u32             index( void ) const { return m_index; }
+
+        //! Compares two handles.
+        bool            operator == ( const SoundFxHandle& other ) const { return m_index == other.m_index; }
+
+        //! Compares two handles.
+        bool            operator < ( const SoundFxHandle& other ) const { return m_index < other.m_index; }
+
+    private:
+
+        u32             m_index;    //!< A name table index.
+    };
+
+    //! An interned sound data name.
+    typedef SoundFxHandle<SoundData> SoundHandle;
+
+    //! An interned sound group name.
+    typedef SoundFxHandle<SoundGroup> SoundGroupHandle;
+
+    //! An interned sound event name.
+    typedef SoundFxHandle<SoundEvent> SoundEventHandle;
+
 } // namespace Sound
 
 DC_END_DREEMCHEST
@@ -103,6 +150,8 @@ DC_END_DREEMCHEST
     #include "SoundEvent.h"
     #include "SoundChannel.h"
     #include "SoundStream.h"
+    #include "SoundStreamer.h"
+    #include "PcmCache.h"
 #endif
 
 #endif    /*    !__DC_Sound_H__    */
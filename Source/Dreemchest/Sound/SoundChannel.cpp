@@ -31,6 +31,7 @@
 #include "Drivers/SoundBuffer.h"
 #include "SoundData.h"
 #include "SoundGroup.h"
+#include "SoundStreamer.h"
 
 DC_BEGIN_DREEMCHEST
 
@@ -42,6 +43,7 @@ SoundChannel::SoundChannel( SoundDataWPtr data, SoundSourcePtr source )
     , m_volumeFader( NULL )
     , m_sound( data )
     , m_volume( 1.0f )
+    , m_streamer( NULL )
 {
 
 }
@@ -72,6 +74,8 @@ const Vec3& SoundChannel::position( void ) const
 // ** SoundChannel::setPosition
 void SoundChannel::setPosition( const Vec3& value )
 {
+    SoundStreamer::Scope lock( m_streamer );
+
     // Get the sound source buffer
     SoundBufferWPtr buffer = m_source->buffer();
 
@@ -111,6 +115,8 @@ SoundDataWPtr SoundChannel::sound( void ) const
 // ** SoundChannel::pause
 void SoundChannel::pause( f32 fade )
 {
+    SoundStreamer::Scope lock( m_streamer );
+
     if( m_volumeFader.valid() ) {
         NIMBLE_BREAK;
         return;
@@ -126,6 +132,8 @@ void SoundChannel::pause( f32 fade )
 // ** SoundChannel::resume
 void SoundChannel::resume( f32 fade )
 {
+    SoundStreamer::Scope lock( m_streamer );
+
     if( m_volumeFader.valid() ) {
         NIMBLE_BREAK;
         return;
@@ -144,6 +152,8 @@ void SoundChannel::resume( f32 fade )
 // ** SoundChannel::stop
 void SoundChannel::stop( f32 fade )
 {
+    SoundStreamer::Scope lock( m_streamer );
+
     if( fade == 0.0f ) {
         onStopped( m_volumeFader );
         return;
@@ -163,7 +173,12 @@ void SoundChannel::stop( f32 fade )
 // ** SoundChannel::update
 bool SoundChannel::update( f32 dt )
 {
-    m_source->update();
+    SoundStreamer::Scope lock( m_streamer );
+
+    // Streams of channels attached to a running streamer are updated by a worker thread
+    if( !m_streamer.valid() || !m_streamer->isRunning() ) {
+        m_source->update();
+    }
 
     // Update volume fader and calculate the volume fade factor
     f32 fade = 1.0f;
@@ -187,6 +202,18 @@ bool SoundChannel::update( f32 dt )
     return m_source->state() == SoundSource::Stopped;
 }
 
+// ** SoundChannel::updateStream
+void SoundChannel::updateStream( void )
+{
+    m_source->update();
+}
+
+// ** SoundChannel::setStreamer
+void SoundChannel::setStreamer( SoundStreamerWPtr value )
+{
+    m_streamer = value;
+}
+
 // ** SoundChannel::stopPlayback
 void SoundChannel::stopPlayback( bool pause )
 {
@@ -94,6 +94,12 @@ namespace Sound {
          */
         bool                update( f32 dt );
 
+        //! Refills processed chunks of a streamed sound source, called by a SoundStreamer worker thread.
+        void                updateStream( void );
+
+        //! Attaches this channel to a streamer, so the stream will be updated asynchronously.
+        void                setStreamer( SoundStreamerWPtr value );
+
         //! Fade in callback.
         void                onFadeIn( FaderWPtr fader );
 
@@ -119,6 +125,9 @@ namespace Sound {
 
         //! Sound channel volume.
         f32                 m_volume;
+
+        //! A streamer that updates a sound source stream (NULL for non-streamed channels).
+        SoundStreamerWPtr   m_streamer;
     };
     
 } // namespace Sound
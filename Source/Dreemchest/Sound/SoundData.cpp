@@ -27,7 +27,6 @@
 #include "SoundData.h"
 #include "SoundFx.h"
 #include "SoundGroup.h"
-#include "Drivers/SoundBuffer.h"
 
 DC_BEGIN_DREEMCHEST
 
@@ -43,7 +42,6 @@ SoundData::SoundData( SoundFxWPtr sfx, CString identifier, CString uri, SoundGro
     , m_referenceDistance( 1.0f )
     , m_maximumDistance( FLT_MAX )
     , m_rolloffFactor( 1.0f )
-    , m_pcm( NULL )
 {
     m_identifier        = identifier;
     m_type              = 0;
@@ -282,18 +280,6 @@ void SoundData::setData( const SoundDataInfo& value )
     m_priority          = value.priority;
 }
 
-// ** SoundData::pcm
-SoundBufferWPtr SoundData::pcm( void ) const
-{
-    return m_pcm;
-}
-
-// ** SoundData::setPcm
-void SoundData::setPcm( SoundBufferPtr value )
-{
-    m_pcm = value;
-}
-
 // ** SoundData::volumeForSound
 f32 SoundData::volumeForSound( void ) const
 {
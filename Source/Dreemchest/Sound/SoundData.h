@@ -153,10 +153,6 @@ namespace Sound {
         SoundDataInfo            data( void ) const;
         //! Loads a serialized sound data.
         void                    setData( const SoundDataInfo& value );
-        //! Returns a sound buffer with decoded PCM data.
-        SoundBufferWPtr            pcm( void ) const;
-        //! Sets a sound buffer with decoded PCM data.
-        void                    setPcm( SoundBufferPtr value );
         //! Calculates and returns a sound volume with a random modifier applied.
         f32                        volumeForSound( void ) const;
         //! Calculates and returns a sound pitch with a random modifier applied.
@@ -200,8 +196,6 @@ namespace Sound {
         f32                     m_rolloffFactor;
         //! Sound playback priority.
         u32                        m_priority;
-        //! Decoded PCM data.
-        SoundBufferPtr            m_pcm;
     };
     
 } // namespace Sound
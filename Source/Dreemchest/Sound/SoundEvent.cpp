@@ -53,22 +53,22 @@ SoundEvent::EventType SoundEvent::type( void ) const
     return m_type;
 }
 
-// ** SoundEvent::requestIdentifier
-const char* SoundEvent::requestIdentifier( void ) const
+// ** SoundEvent::requestSoundIndex
+s32 SoundEvent::requestSoundIndex( void ) const
 {
     if( m_sounds.empty() ) {
-        return NULL;
+        return -1;
     }
 
     // ** Event probability
     if( rand() % 100 > m_probability ) {
-        return NULL;
+        return -1;
     }
 
     // ** Get a random sound for triggered event
     m_lastPlayedIndex = generateSoundIndex();
 
-    return m_sounds[m_lastPlayedIndex].c_str();
+    return m_lastPlayedIndex;
 }
 
 // ** SoundEvent::generateSoundIndex
@@ -114,6 +114,7 @@ void SoundEvent::setData( const SoundEventInfo& value )
 {
     m_identifier        = value.identifier;
     m_sounds            = value.sounds;
+    m_handles.clear();
     m_probability       = value.probability;
     m_type              = static_cast<EventType>( value.type );
 }
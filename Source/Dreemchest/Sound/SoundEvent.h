@@ -74,8 +74,8 @@ namespace Sound {
         CString                identifier( void ) const;
         //! Sets a sound event identifier.
         void                setIdentifier( CString value );
-        //! Returns a pointer to a sound data for event playback.
-        CString                requestIdentifier( void ) const;
+        //! Returns an index of a sound for event playback or -1 if the event was skipped.
+        s32                    requestSoundIndex( void ) const;
         //! Returns a random sound index.
         u32                 generateSoundIndex( void ) const;
         //! Returns a serialized sound event data.
@@ -89,6 +89,9 @@ namespace Sound {
         String              m_identifier;
         //! Sounds that can be played by this event.
         StringArray         m_sounds;
+
+        //! Interned handles of event sounds, resolved by a SoundFx on a first trigger.
+        Array<SoundHandle>  m_handles;
         //! Probability of triggering a sound event.
         u8                  m_probability;
         //! Last played sound index.
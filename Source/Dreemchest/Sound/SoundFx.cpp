@@ -31,14 +31,18 @@
 #include "SoundData.h"
 #include "SoundEvent.h"
 #include "SoundStream.h"
+#include "SoundStreamer.h"
+#include "PcmCache.h"
 
 #include "Decoders/SoundDecoder.h"
 #include "Drivers/SoundSource.h"
 #include "Drivers/SoundBuffer.h"
 #include "Drivers/SoundEngine.h"
+#include "Drivers/Mixer/SoftwareMixer.h"
 
 #ifdef OPENAL_FOUND
     #include "Drivers/OpenAL/OpenAL.h"
+    #include "Drivers/OpenAL/OpenALMixerOutput.h"
 #endif    /*    #ifdef OPENAL_FOUND    */
 
 DC_BEGIN_DREEMCHEST
@@ -48,38 +52,82 @@ namespace Sound {
 // ------------------------------------------------------ SoundFx ------------------------------------------------------ //
 
 // ** SoundFx::SoundFx
-SoundFx::SoundFx( SoundHal hal, IStreamOpenerPtr streamOpener )
-    : m_hal( NULL )
+SoundFx::SoundFx( SoundEnginePtr hal, IStreamOpenerPtr streamOpener )
+    : m_hal( hal )
     , m_volume( 1.0f )
     , m_pitch( 1.0f )
     , m_streamOpener( streamOpener.valid() ? streamOpener : DC_NEW StandardStreamOpener )
     , m_distanceModel( InverseDistanceAttenuation )
+    , m_streamLookahead( 3 )
 {
-    switch( hal ) {
-    case None:      m_hal = NULL;           break;
-    case Default:   
-                    #ifdef OPENAL_FOUND
-                        m_hal = DC_NEW OpenAL;
-                        if( !m_hal->initialize() ) {
-                            LogError( "sfx", "%s", "failed to create OpenAL backend, fallback to default\n" );
-                            m_hal = DC_NEW SoundEngine;
-                        }
-                    #else
-                        LogError( "sfx", "%s", "the default sound HAL is OpenAL, but library compiled without OpenAL\n" );
-                    #endif  /*  #ifdef OPENAL_FOUND */
-                    break;
+    // Decoded PCM buffers of non-streamed sounds are shared by all channels
+    m_pcmCache = DC_NEW PcmCache( 16 * 1024 * 1024 );
+
+    // Move stream decoding away from the update thread
+    m_streamer = DC_NEW SoundStreamer;
+
+    if( m_hal.valid() ) {
+        m_streamer->start( 10 );
     }
 }
 
 SoundFx::~SoundFx( void )
 {
+    m_streamer->stop();
     reset();
 }
 
 // ** SoundFx::create
 SoundFxPtr SoundFx::create( SoundHal hal, IStreamOpenerPtr streamOpener )
 {
-    return SoundFxPtr( DC_NEW SoundFx( hal, streamOpener ) );
+    return SoundFxPtr( DC_NEW SoundFx( createHal( hal ), streamOpener ) );
+}
+
+// ** SoundFx::createWithEngine
+SoundFxPtr SoundFx::createWithEngine( SoundEnginePtr engine, IStreamOpenerPtr streamOpener )
+{
+    NIMBLE_ABORT_IF( !engine.valid(), "invalid sound engine" );
+
+    if( !engine->initialize() ) {
+        LogError( "sfx", "%s", "failed to initialize a sound engine\n" );
+        return SoundFxPtr();
+    }
+
+    return SoundFxPtr( DC_NEW SoundFx( engine, streamOpener ) );
+}
+
+// ** SoundFx::createHal
+SoundEnginePtr SoundFx::createHal( SoundHal hal )
+{
+    SoundEnginePtr engine;
+
+    switch( hal ) {
+    case None:      break;
+    case Default:   
+                    #ifdef OPENAL_FOUND
+                        engine = DC_NEW OpenAL;
+                        if( !engine->initialize() ) {
+                            LogError( "sfx", "%s", "failed to create OpenAL backend, fallback to default\n" );
+                            engine = DC_NEW SoundEngine;
+                        }
+                    #else
+                        LogError( "sfx", "%s", "the default sound HAL is OpenAL, but library compiled without OpenAL\n" );
+                    #endif  /*  #ifdef OPENAL_FOUND */
+                    break;
+    case Software:
+                    #ifdef OPENAL_FOUND
+                        engine = DC_NEW SoftwareMixer( DC_NEW OpenALMixerOutput );
+                        if( !engine->initialize() ) {
+                            LogError( "sfx", "%s", "failed to create software mixer backend, fallback to default\n" );
+                            engine = DC_NEW SoundEngine;
+                        }
+                    #else
+                        LogError( "sfx", "%s", "the software mixer outputs to OpenAL, but library compiled without OpenAL\n" );
+                    #endif  /*  #ifdef OPENAL_FOUND */
+                    break;
+    }
+
+    return engine;
 }
 
 // ** SoundFx::createGroup
@@ -96,6 +144,7 @@ SoundGroupWPtr SoundFx::createGroup( CString identifier )
     String64    hash( identifier );
 
     m_groups[hash] = group;
+    m_groupNames.set( identifier, group );
 
     return group;
 }
@@ -117,6 +166,7 @@ SoundDataWPtr SoundFx::createSound( CString identifier, CString uri, SoundGroupW
     String64   hash( identifier );
 
     m_sounds[hash] = sound;
+    m_soundNames.set( identifier, sound );
 
     return sound;
 }
@@ -135,6 +185,7 @@ SoundEventWPtr SoundFx::createEvent( CString identifier )
     String64    hash( identifier );
 
     m_events[hash] = event;
+    m_eventNames.set( identifier, event );
 
     return event;
 }
@@ -169,6 +220,7 @@ void SoundFx::removeSoundByName( CString identifier )
 {
     NIMBLE_ABORT_IF( identifier == NULL, "invalid identifier" );
     m_sounds.erase( String64( identifier ) );
+    m_soundNames.set( identifier, SoundDataWPtr() );
 }
 
 // ** SoundFx::renameSound
@@ -193,6 +245,7 @@ bool SoundFx::renameSound( CString identifier, CString newName )
     sound->setIdentifier( newName );
 
     m_sounds[hash] = sound;
+    m_soundNames.set( newName, sound );
 
     return true;
 }
@@ -214,6 +267,7 @@ void SoundFx::removeGroupByName( CString identifier )
 {
     NIMBLE_ABORT_IF( identifier == NULL, "invalid identifier" );
     m_groups.erase( String64( identifier ) );
+    m_groupNames.set( identifier, SoundGroupWPtr() );
 }
 
 // ** SoundFx::renameGroup
@@ -238,6 +292,7 @@ bool SoundFx::renameGroup( CString identifier, CString newName )
     group->setIdentifier( newName );
     
     m_groups[hash] = group;
+    m_groupNames.set( newName, group );
     
     return true;
 }
@@ -275,6 +330,7 @@ SoundSourcePtr SoundFx::createSource( SoundDataWPtr data )
     source->setBuffer( createBuffer( data ) );
     source->setPitch( data->pitchForSound() );
     source->setLooped( data->isLooped() );
+    source->setPriority( data->priority() );
 
     return source;
 }
@@ -289,22 +345,32 @@ SoundBufferPtr SoundFx::createBuffer( SoundDataWPtr data )
         return NULL;
     }
 
+    // ** Reuse the decoded PCM data
+    if( data->loading() == SoundData::Decode ) {
+        SoundBufferPtr pcm = m_pcmCache->find( data->uri() );
+
+        if( pcm.valid() ) {
+            return pcm;
+        }
+    }
+
     // ** Create sound decoder
     SoundDecoderPtr decoder = createDecoder( data );
-    if( !decoder.valid() && !data->pcm().valid() ) {
+    if( !decoder.valid() ) {
         LogError( "sfx", "failed to create sound decoder for '%s'\n", data->identifier() );
         return NULL;
     }
 
     // ** Create buffer
     switch( data->loading() ) {
-    case SoundData::Decode:     if( !data->pcm().valid() ) {
-                                    data->setPcm( m_hal->createBuffer( decoder, 1 ) );
+    case SoundData::Decode:     {
+                                    SoundBufferPtr pcm = m_hal->createBuffer( decoder, 1 );
+                                    m_pcmCache->insert( data->uri(), pcm );
+                                    return pcm;
                                 }
-                                return data->pcm();
 
-    case SoundData::Stream:     return m_hal->createBuffer( decoder, 3 );
-    case SoundData::LoadToRam:  return m_hal->createBuffer( decoder, 3 );
+    case SoundData::Stream:     return m_hal->createBuffer( decoder, m_streamLookahead );
+    case SoundData::LoadToRam:  return m_hal->createBuffer( decoder, m_streamLookahead );
     }
 
     return NULL;
@@ -322,11 +388,7 @@ SoundDecoderPtr SoundFx::createDecoder( SoundDataWPtr data )
     }
 
     switch( data->loading() ) {
-    case SoundData::Decode:     if( !data->pcm().valid() ) {
-                                    decoder = m_hal->createSoundDecoder( stream, data->format() );
-                                } else {
-                                //    stream->release();
-                                }
+    case SoundData::Decode:     decoder = m_hal->createSoundDecoder( stream, data->format() );
                                 break;
 
     case SoundData::LoadToRam:  decoder = m_hal->createSoundDecoder( stream->loadToRam(), data->format() );
@@ -349,36 +411,73 @@ void SoundFx::setListenerPosition( const Vec3& value )
 // ** SoundFx::event
 SoundChannelPtr SoundFx::event( CString identifier )
 {
-    // Find the event by name
-    SoundEventWPtr event = findEventByName( identifier );
+    SoundEventHandle handle = internEvent( identifier );
 
-    if( event == NULL ) {
+    if( !findEvent( handle ).valid() ) {
         LogError( "sfx", "no such event '%s'\n", identifier );
         return NULL;
     }
 
-    // ** Get the sound label from an event
-    const char* label = event->requestIdentifier();
+    return event( handle );
+}
+
+// ** SoundFx::event
+SoundChannelPtr SoundFx::event( SoundEventHandle handle )
+{
+    // Resolve the event by handle
+    SoundEventWPtr event = findEvent( handle );
+
+    if( event == NULL ) {
+        LogError( "sfx", "no such event with handle %d\n", handle.index() );
+        return NULL;
+    }
+
+    // ** Get the sound index from an event
+    s32 index = event->requestSoundIndex();
 
-    if( label == NULL ) {
-        LogDebug( "sfx", "event '%s' skipped due to probability\n", identifier );
+    if( index < 0 ) {
+        LogDebug( "sfx", "event '%s' skipped due to probability\n", event->identifier() );
         return NULL;
     }
 
-    return play( label );
+    // ** Intern event sound names on a first trigger
+    if( event->m_handles.size() != event->m_sounds.size() ) {
+        event->m_handles.clear();
+
+        for( u32 i = 0, n = ( u32 )event->m_sounds.size(); i < n; i++ ) {
+            event->m_handles.push_back( internSound( event->m_sounds[i].c_str() ) );
+        }
+    }
+
+    return play( event->m_handles[index] );
 }
 
 // ** SoundFx::play
 SoundChannelPtr SoundFx::play( CString identifier )
 {
-    // Find the sound data by name
-    SoundDataWPtr data = findSoundByName( identifier );
+    SoundHandle handle = internSound( identifier );
 
-    if( data == NULL ) {
+    if( !findSound( handle ).valid() ) {
         LogError( "sfx", "no such sound '%s'\n", identifier );
         return NULL;
     }
 
+    return play( handle );
+}
+
+// ** SoundFx::play
+SoundChannelPtr SoundFx::play( SoundHandle handle )
+{
+    // Resolve the sound data by handle
+    SoundDataWPtr data = findSound( handle );
+
+    if( data == NULL ) {
+        LogError( "sfx", "no such sound with handle %d\n", handle.index() );
+        return NULL;
+    }
+
+    CString identifier = data->identifier();
+
     // Get the sound group
     SoundGroupWPtr group = data->group();
 
@@ -408,6 +507,13 @@ SoundChannelPtr SoundFx::play( CString identifier )
     // Create channel
     SoundChannel* channel = DC_NEW SoundChannel( data, source );
     channel->setVolume( data->volumeForSound() );
+
+    // Streamed channels are updated by a worker thread
+    if( data->loading() != SoundData::Decode && m_streamer->isRunning() ) {
+        channel->setStreamer( m_streamer );
+        m_streamer->addChannel( channel );
+    }
+
     channel->resume( fadeTime );
     m_channels.push_back( channel );
 
@@ -421,6 +527,80 @@ SoundChannelPtr SoundFx::play( CString identifier )
     return channel;
 }
 
+// ** SoundFx::queuePlay
+void SoundFx::queuePlay( SoundHandle handle )
+{
+    m_queuedSounds.push_back( handle );
+}
+
+// ** SoundFx::queueEvent
+void SoundFx::queueEvent( SoundEventHandle handle )
+{
+    m_queuedEvents.push_back( handle );
+}
+
+// ** SoundFx::flushQueue
+void SoundFx::flushQueue( void )
+{
+    // ** Coalesce duplicate requests
+    std::sort( m_queuedSounds.begin(), m_queuedSounds.end() );
+    m_queuedSounds.erase( std::unique( m_queuedSounds.begin(), m_queuedSounds.end() ), m_queuedSounds.end() );
+
+    std::sort( m_queuedEvents.begin(), m_queuedEvents.end() );
+    m_queuedEvents.erase( std::unique( m_queuedEvents.begin(), m_queuedEvents.end() ), m_queuedEvents.end() );
+
+    // ** Start playbacks
+    for( u32 i = 0, n = ( u32 )m_queuedSounds.size(); i < n; i++ ) {
+        play( m_queuedSounds[i] );
+    }
+
+    for( u32 i = 0, n = ( u32 )m_queuedEvents.size(); i < n; i++ ) {
+        event( m_queuedEvents[i] );
+    }
+
+    m_queuedSounds.clear();
+    m_queuedEvents.clear();
+}
+
+// ** SoundFx::internSound
+SoundHandle SoundFx::internSound( CString identifier )
+{
+    NIMBLE_ABORT_IF( identifier == NULL, "invalid identifier" );
+    return m_soundNames.intern( identifier );
+}
+
+// ** SoundFx::internGroup
+SoundGroupHandle SoundFx::internGroup( CString identifier )
+{
+    NIMBLE_ABORT_IF( identifier == NULL, "invalid identifier" );
+    return m_groupNames.intern( identifier );
+}
+
+// ** SoundFx::internEvent
+SoundEventHandle SoundFx::internEvent( CString identifier )
+{
+    NIMBLE_ABORT_IF( identifier == NULL, "invalid identifier" );
+    return m_eventNames.intern( identifier );
+}
+
+// ** SoundFx::findSound
+SoundDataWPtr SoundFx::findSound( SoundHandle handle ) const
+{
+    return m_soundNames.find( handle );
+}
+
+// ** SoundFx::findGroup
+SoundGroupWPtr SoundFx::findGroup( SoundGroupHandle handle ) const
+{
+    return m_groupNames.find( handle );
+}
+
+// ** SoundFx::findEvent
+SoundEventWPtr SoundFx::findEvent( SoundEventHandle handle ) const
+{
+    return m_eventNames.find( handle );
+}
+
 // ** SoundFx::playWithParameters
 SoundChannelPtr SoundFx::playWithParameters( CString identifier, bool loop, f32 fade )
 {
@@ -451,6 +631,8 @@ void SoundFx::setData( const SoundFxInfo& value )
 {
     m_sounds.clear();
     m_groups.clear();
+    m_soundNames.clear();
+    m_groupNames.clear();
 
     // ** Deserialize groups
     for( u32 i = 0, n = ( u32 )value.groups.size(); i < n; i++ ) {
@@ -514,10 +696,17 @@ bool SoundFx::load( const char *identifier )
 // ** SoundFx::reset
 void SoundFx::reset( void )
 {
+    m_streamer->clear();
+    m_pcmCache->clear();
     m_channels.clear();
     m_events.clear();
     m_sounds.clear();
     m_groups.clear();
+    m_soundNames.clear();
+    m_groupNames.clear();
+    m_eventNames.clear();
+    m_queuedSounds.clear();
+    m_queuedEvents.clear();
 }
 
 // ** SoundFx::volume
@@ -559,14 +748,66 @@ const Sounds& SoundFx::sounds( void ) const
     return m_sounds;
 }
 
+// ** SoundFx::streamLookahead
+u32 SoundFx::streamLookahead( void ) const
+{
+    return m_streamLookahead;
+}
+
+// ** SoundFx::setStreamLookahead
+void SoundFx::setStreamLookahead( u32 value )
+{
+    NIMBLE_BREAK_IF( value < 2, "at least two chunks are required for a stream playback" );
+    m_streamLookahead = value;
+}
+
+// ** SoundFx::streamingInterval
+u32 SoundFx::streamingInterval( void ) const
+{
+    return m_streamer->interval();
+}
+
+// ** SoundFx::setStreamingInterval
+void SoundFx::setStreamingInterval( u32 value )
+{
+    m_streamer->setInterval( value );
+}
+
+// ** SoundFx::pcmCacheSize
+u64 SoundFx::pcmCacheSize( void ) const
+{
+    return m_pcmCache->capacity();
+}
+
+// ** SoundFx::setPcmCacheSize
+void SoundFx::setPcmCacheSize( u64 value )
+{
+    m_pcmCache->setCapacity( value );
+}
+
+// ** SoundFx::cachedPcmSize
+u64 SoundFx::cachedPcmSize( void ) const
+{
+    return m_pcmCache->size();
+}
+
 // ** SoundFx::update
 void SoundFx::update( f32 dt )
 {
+    // ** Start playbacks queued since a last update
+    flushQueue();
+
     // ** Update channels
     for( u32 i = 0; i < ( u32 )m_channels.size(); i++ ) {
         m_channels[i]->update( dt );
     }
 
+    // ** Mix or flush sound engine output
+    if( m_hal.valid() ) {
+        SoundStreamer::Scope lock( m_streamer );
+        m_hal->update( dt );
+    }
+
     // ** Cleanup stopped channels
     cleanupChannels();
 
@@ -585,6 +826,7 @@ void SoundFx::cleanupChannels( void )
         }
 
         // ** Remove channel from a list
+        m_streamer->removeChannel( m_channels[i] );
         m_channels.erase( m_channels.begin() + i );
         i--;
     }
@@ -49,6 +49,7 @@ namespace Sound {
         enum SoundHal {
             None,        //!< No HAL, the sound playback is disabled.
             Default,     //!< Use a platform default HAL.
+            Software,    //!< Mix all channels in software and output a single stream, voices beyond the limit are virtualized.
         };
 
     public:
@@ -77,6 +78,9 @@ namespace Sound {
         */
         SoundChannelPtr            play( CString identifier );
 
+        //! Starts a playback of a single sound referenced by an interned handle.
+        SoundChannelPtr            play( SoundHandle handle );
+
         //! Triggers an event.
         /*!
             If no event with a given identifier is found, the call is ignored.
@@ -86,6 +90,29 @@ namespace Sound {
         */
         SoundChannelPtr            event( CString identifier );
 
+        //! Triggers an event referenced by an interned handle.
+        SoundChannelPtr            event( SoundEventHandle handle );
+
+        //! Queues a sound playback that will be started by a next update, duplicate requests within a frame start a single playback.
+        void                    queuePlay( SoundHandle handle );
+
+        //! Queues an event that will be triggered by a next update, duplicate requests within a frame trigger it once.
+        void                    queueEvent( SoundEventHandle handle );
+
+        //! Returns an interned handle of a sound name.
+        SoundHandle             internSound( CString identifier );
+        //! Returns an interned handle of a sound group name.
+        SoundGroupHandle        internGroup( CString identifier );
+        //! Returns an interned handle of a sound event name.
+        SoundEventHandle        internEvent( CString identifier );
+
+        //! Returns a sound data referenced by a handle (NULL if no such sound found).
+        SoundDataWPtr           findSound( SoundHandle handle ) const;
+        //! Returns a sound group referenced by a handle (NULL if no such group found).
+        SoundGroupWPtr          findGroup( SoundGroupHandle handle ) const;
+        //! Returns a sound event referenced by a handle (NULL if no such event found).
+        SoundEventWPtr          findEvent( SoundEventHandle handle ) const;
+
         //! Sets the listener position.
         void                    setListenerPosition( const Vec3& value );
 
@@ -170,6 +197,21 @@ namespace Sound {
         //! Sets a master sound pitch.
         void                    setPitch( f32 value );
 
+        //! Returns a number of PCM chunks queued ahead of a playback for streamed sounds.
+        u32                     streamLookahead( void ) const;
+        //! Sets a number of PCM chunks queued ahead of a playback for streamed sounds (affects new channels only).
+        void                    setStreamLookahead( u32 value );
+        //! Returns an interval in milliseconds between stream updates done by a streaming thread.
+        u32                     streamingInterval( void ) const;
+        //! Sets an interval in milliseconds between stream updates done by a streaming thread.
+        void                    setStreamingInterval( u32 value );
+        //! Returns a maximum size in bytes of decoded PCM data shared by channels.
+        u64                     pcmCacheSize( void ) const;
+        //! Sets a maximum size in bytes of decoded PCM data shared by channels.
+        void                    setPcmCacheSize( u64 value );
+        //! Returns a size in bytes of currently cached PCM data.
+        u64                     cachedPcmSize( void ) const;
+
         //! Returns a reference to a sound group container.
         const SoundGroups&      groups( void ) const;
         //! Returns a reference to a sound container.
@@ -178,6 +220,9 @@ namespace Sound {
         //! Creates the SoundFx instance.
         static SoundFxPtr        create( SoundHal hal = Default, IStreamOpenerPtr streamOpener = IStreamOpenerPtr() );
 
+        //! Creates the SoundFx instance that uses a given sound engine (e.g. a software mixer with a memory output).
+        static SoundFxPtr        createWithEngine( SoundEnginePtr engine, IStreamOpenerPtr streamOpener = IStreamOpenerPtr() );
+
     private:
 
                                 //! Constructs a new SoundFx object.
@@ -185,7 +230,10 @@ namespace Sound {
                                  \param hal Used hardware abstraction layer.
                                  \param streamOpener A stream opener interface used to load sounds.
                                  */
-                                SoundFx( SoundHal hal, IStreamOpenerPtr streamOpener );
+                                SoundFx( SoundEnginePtr hal, IStreamOpenerPtr streamOpener );
+
+        //! Creates and initializes a sound engine of a given type.
+        static SoundEnginePtr   createHal( SoundHal hal );
 
         //! Creates a sound playback source for a given sound data.
         /*!
@@ -213,6 +261,59 @@ namespace Sound {
         //! Removes all stopped sound channels from an update queue.
         void                    cleanupChannels( void );
 
+        //! Starts all queued playbacks and events, duplicate requests are coalesced.
+        void                    flushQueue( void );
+
+    private:
+
+        //! Maps interned names to a dense array of assets.
+        template<typename T>
+        class NameTable {
+        public:
+
+            //! Returns a handle of a given name, the name is interned on a first call.
+            SoundFxHandle<T>    intern( CString name )
+            {
+                String64 hash( name );
+                Hash<u32>::iterator i = m_indices.find( hash );
+
+                if( i != m_indices.end() ) {
+                    return SoundFxHandle<T>( i->second );
+                }
+
+                u32 index = static_cast<u32>( m_items.size() );
+                m_indices[hash] = index;
+                m_items.push_back( WeakPtr<T>() );
+
+                return SoundFxHandle<T>( index );
+            }
+
+            //! Returns an asset referenced by a handle.
+            WeakPtr<T>          find( SoundFxHandle<T> handle ) const
+            {
+                return handle.index() < m_items.size() ? m_items[handle.index()] : WeakPtr<T>();
+            }
+
+            //! Associates an asset with a name.
+            void                set( CString name, const WeakPtr<T>& value )
+            {
+                m_items[intern( name ).index()] = value;
+            }
+
+            //! Removes all assets, interned names are kept so handles stay valid.
+            void                clear( void )
+            {
+                for( u32 i = 0, n = static_cast<u32>( m_items.size() ); i < n; i++ ) {
+                    m_items[i] = WeakPtr<T>();
+                }
+            }
+
+        private:
+
+            Hash<u32>           m_indices;  //!< Name table indices by name hash.
+            Array< WeakPtr<T> > m_items;    //!< Assets by name table index.
+        };
+
     private:
 
         //! Sound engine HAL.
@@ -244,6 +345,30 @@ namespace Sound {
 
         //! Distance attenuation model.
         DistanceModel           m_distanceModel;
+
+        //! A worker that keeps stream buffers filled ahead of a playback.
+        SoundStreamerPtr        m_streamer;
+
+        //! Decoded PCM buffers of non-streamed sounds.
+        PcmCachePtr             m_pcmCache;
+
+        //! A number of PCM chunks allocated for streamed sounds.
+        u32                     m_streamLookahead;
+
+        //! Interned sound names.
+        NameTable<SoundData>    m_soundNames;
+
+        //! Interned sound group names.
+        NameTable<SoundGroup>   m_groupNames;
+
+        //! Interned sound event names.
+        NameTable<SoundEvent>   m_eventNames;
+
+        //! Sound playbacks queued for a next update.
+        Array<SoundHandle>      m_queuedSounds;
+
+        //! Sound events queued for a next update.
+        Array<SoundEventHandle> m_queuedEvents;
     };
     
 } // namespace Sound
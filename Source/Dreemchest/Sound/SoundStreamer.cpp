@@ -0,0 +1,192 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "SoundStreamer.h"
+#include "SoundChannel.h"
+
+#if DC_THREADS_AVAILABLE
+    #include "../Threads/Thread.h"
+    #include "../Threads/Mutex.h"
+#endif  /*  DC_THREADS_AVAILABLE    */
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+// ------------------------------------------------------ SoundStreamer::Scope ------------------------------------------------------ //
+
+// ** SoundStreamer::Scope::Scope
+SoundStreamer::Scope::Scope( SoundStreamerWPtr streamer )
+    : m_streamer( streamer )
+{
+    if( m_streamer.valid() ) {
+        m_streamer->lock();
+    }
+}
+
+SoundStreamer::Scope::~Scope( void )
+{
+    if( m_streamer.valid() ) {
+        m_streamer->unlock();
+    }
+}
+
+// ------------------------------------------------------ SoundStreamer ------------------------------------------------------ //
+
+// ** SoundStreamer::SoundStreamer
+SoundStreamer::SoundStreamer( void )
+    : m_interval( 10 )
+    , m_isRunning( false )
+{
+#if DC_THREADS_AVAILABLE
+    m_mutex = Threads::Mutex::create( true );
+#endif  /*  DC_THREADS_AVAILABLE    */
+}
+
+SoundStreamer::~SoundStreamer( void )
+{
+    stop();
+}
+
+// ** SoundStreamer::start
+bool SoundStreamer::start( u32 interval )
+{
+#if DC_THREADS_AVAILABLE
+    NIMBLE_BREAK_IF( m_isRunning, "sound streamer is already running" );
+
+    m_interval  = interval;
+    m_isRunning = true;
+    m_thread    = Threads::Thread::create();
+    m_thread->start( dcThisMethod( SoundStreamer::run ), NULL );
+
+    LogVerbose( "sfx", "streaming thread started with %d ms update interval\n", interval );
+    return true;
+#else
+    LogWarning( "sfx", "%s", "library compiled without threads, sound streams will be updated by SoundFx::update\n" );
+    return false;
+#endif  /*  DC_THREADS_AVAILABLE    */
+}
+
+// ** SoundStreamer::stop
+void SoundStreamer::stop( void )
+{
+    if( !m_isRunning ) {
+        return;
+    }
+
+    m_isRunning = false;
+
+#if DC_THREADS_AVAILABLE
+    m_thread->wait();
+    m_thread = Threads::ThreadPtr();
+#endif  /*  DC_THREADS_AVAILABLE    */
+}
+
+// ** SoundStreamer::isRunning
+bool SoundStreamer::isRunning( void ) const
+{
+    return m_isRunning;
+}
+
+// ** SoundStreamer::interval
+u32 SoundStreamer::interval( void ) const
+{
+    return m_interval;
+}
+
+// ** SoundStreamer::setInterval
+void SoundStreamer::setInterval( u32 value )
+{
+    NIMBLE_BREAK_IF( value == 0, "stream update interval should be greater than zero" );
+    m_interval = value;
+}
+
+// ** SoundStreamer::lock
+void SoundStreamer::lock( void )
+{
+#if DC_THREADS_AVAILABLE
+    m_mutex->lock();
+#endif  /*  DC_THREADS_AVAILABLE    */
+}
+
+// ** SoundStreamer::unlock
+void SoundStreamer::unlock( void )
+{
+#if DC_THREADS_AVAILABLE
+    m_mutex->unlock();
+#endif  /*  DC_THREADS_AVAILABLE    */
+}
+
+// ** SoundStreamer::addChannel
+void SoundStreamer::addChannel( SoundChannelWPtr channel )
+{
+    lock();
+    m_channels.push_back( channel );
+    unlock();
+}
+
+// ** SoundStreamer::removeChannel
+void SoundStreamer::removeChannel( SoundChannelWPtr channel )
+{
+    lock();
+    for( u32 i = 0; i < ( u32 )m_channels.size(); i++ ) {
+        if( m_channels[i].get() == channel.get() ) {
+            m_channels.erase( m_channels.begin() + i );
+            break;
+        }
+    }
+    unlock();
+}
+
+// ** SoundStreamer::clear
+void SoundStreamer::clear( void )
+{
+    lock();
+    m_channels.clear();
+    unlock();
+}
+
+// ** SoundStreamer::run
+void SoundStreamer::run( void* userData )
+{
+#if DC_THREADS_AVAILABLE
+    while( m_isRunning ) {
+        // Refill processed chunks of all registered streams
+        lock();
+        for( u32 i = 0; i < ( u32 )m_channels.size(); i++ ) {
+            m_channels[i]->updateStream();
+        }
+        unlock();
+
+        // Sleep until some of queued chunks are consumed
+        Threads::Thread::sleep( m_interval );
+    }
+#endif  /*  DC_THREADS_AVAILABLE    */
+}
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
@@ -0,0 +1,113 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __DC_Sound_SoundStreamer_H__
+#define __DC_Sound_SoundStreamer_H__
+
+#include "Sound.h"
+#include "../Threads/Threads.h"
+
+DC_BEGIN_DREEMCHEST
+
+namespace Sound {
+
+    //! An audio worker that keeps buffers of streamed sound channels filled ahead of a playback.
+    /*!
+        Streamed channels are registered with a streamer when the playback starts. A worker thread
+        wakes up with a fixed interval and refills processed stream chunks of all registered channels,
+        so the decoding never happens inside a SoundFx::update call. All accesses to sound sources of
+        registered channels should be done while holding a streamer lock.
+    */
+    class SoundStreamer : public RefCounted {
+    public:
+
+        //! A helper class to lock a streamer by a C++ scope.
+        class Scope {
+        public:
+                                //! Locks a streamer (if any).
+                                Scope( SoundStreamerWPtr streamer );
+                                ~Scope( void );
+
+        private:
+
+            SoundStreamerWPtr   m_streamer; //!< A locked streamer instance.
+        };
+
+                                //! Constructs SoundStreamer instance.
+                                SoundStreamer( void );
+        virtual                 ~SoundStreamer( void );
+
+        //! Starts a worker thread that updates streams with a given interval in milliseconds.
+        bool                    start( u32 interval );
+
+        //! Stops a worker thread and waits for it's termination.
+        void                    stop( void );
+
+        //! Returns true if a worker thread is running.
+        bool                    isRunning( void ) const;
+
+        //! Returns a stream update interval in milliseconds.
+        u32                     interval( void ) const;
+
+        //! Sets a stream update interval in milliseconds.
+        void                    setInterval( u32 value );
+
+        //! Locks a streamer, so the worker thread will not touch sound sources.
+        void                    lock( void );
+
+        //! Unlocks a streamer.
+        void                    unlock( void );
+
+        //! Registers a streamed sound channel.
+        void                    addChannel( SoundChannelWPtr channel );
+
+        //! Unregisters a streamed sound channel.
+        void                    removeChannel( SoundChannelWPtr channel );
+
+        //! Unregisters all sound channels.
+        void                    clear( void );
+
+    private:
+
+        //! A worker thread entry point.
+        void                    run( void* userData );
+
+    private:
+
+    #if DC_THREADS_AVAILABLE
+        Threads::ThreadPtr      m_thread;       //!< A worker thread instance.
+        Threads::MutexPtr       m_mutex;        //!< A mutex that guards registered channels.
+    #endif  /*  DC_THREADS_AVAILABLE    */
+        SoundChannels           m_channels;     //!< Registered streamed sound channels.
+        volatile u32            m_interval;     //!< A stream update interval in milliseconds.
+        volatile bool           m_isRunning;    //!< A flag indicating that a worker thread should keep running.
+    };
+
+} // namespace Sound
+
+DC_END_DREEMCHEST
+
+#endif    /*    !__DC_Sound_SoundStreamer_H__    */
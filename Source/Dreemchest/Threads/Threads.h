@@ -31,6 +31,13 @@
 
 // --------------------------------------- Module macroses --------------------------------------- //
 
+//! Set to 1 if background threads and tasks can be used, Emscripten builds use POSIX headers but can't spawn threads.
+#if (defined( DC_THREADS_POSIX ) || defined( DC_THREADS_WINDOWS )) && !defined( DC_PLATFORM_EMSCRIPTEN )
+    #define DC_THREADS_AVAILABLE    1
+#else
+    #define DC_THREADS_AVAILABLE    0
+#endif
+
 #define DC_SCOPED_LOCK( mutex ) \
             DC_DREEMCHEST_NS Threads::ScopedLock mutex##ScopedLock( mutex )
 
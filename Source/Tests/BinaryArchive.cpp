@@ -0,0 +1,261 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "UnitTests.h"
+
+DC_USE_DREEMCHEST
+
+//! A save game record written with a current class layout.
+class SaveGame {
+
+    INTROSPECTION( SaveGame
+        , PROPERTY( health, health, setHealth, "Player health." )
+        , PROPERTY( level, level, setLevel, "Player level." )
+        , PROPERTY( position, position, setPosition, "Player position." )
+        , PROPERTY( name, name, setName, "Player name." )
+        )
+
+public:
+
+                    SaveGame( void ) : m_health( 0.0f ), m_level( 0 ) {}
+
+    f32             health( void ) const { return m_health; }
+    void            setHealth( f32 value ) { m_health = value; }
+    s32             level( void ) const { return m_level; }
+    void            setLevel( s32 value ) { m_level = value; }
+    const Vec3&     position( void ) const { return m_position; }
+    void            setPosition( const Vec3& value ) { m_position = value; }
+    const String&   name( void ) const { return m_name; }
+    void            setName( const String& value ) { m_name = value; }
+
+private:
+
+    f32             m_health;
+    s32             m_level;
+    Vec3            m_position;
+    String          m_name;
+};
+
+//! An older save game layout that has an extra field and lacks a position.
+class SaveGameV1 {
+
+    INTROSPECTION( SaveGameV1
+        , PROPERTY( coins, coins, setCoins, "Collected coins." )
+        , PROPERTY( level, level, setLevel, "Player level." )
+        , PROPERTY( name, name, setName, "Player name." )
+        )
+
+public:
+
+                    SaveGameV1( void ) : m_coins( 0 ), m_level( 0 ) {}
+
+    u32             coins( void ) const { return m_coins; }
+    void            setCoins( u32 value ) { m_coins = value; }
+    s32             level( void ) const { return m_level; }
+    void            setLevel( s32 value ) { m_level = value; }
+    const String&   name( void ) const { return m_name; }
+    void            setName( const String& value ) { m_name = value; }
+
+private:
+
+    u32             m_coins;
+    s32             m_level;
+    String          m_name;
+};
+
+//! Serializes a save game record with an embedded schema and returns its bytes.
+static Array<u8> writeSaveGame( void )
+{
+    SaveGame source;
+    source.setLevel( 7 );
+    source.setName( "player" );
+
+    Io::ByteBufferPtr buffer = Io::ByteBuffer::create();
+    Reflection::BinaryArchive ar( buffer );
+    Reflection::Serializer().serialize( source.metaInstance(), ar );
+
+    return Array<u8>( buffer->buffer(), buffer->buffer() + buffer->length() );
+}
+
+//! Tries to deserialize a save game record from a specified bytes.
+static bool readSaveGame( const Array<u8>& bytes )
+{
+    SaveGame target;
+    Reflection::BinaryArchive ar( Io::ByteBuffer::createFromArray( bytes ) );
+    return Reflection::Serializer().deserialize( target.metaInstance(), ar );
+}
+
+TEST(BinaryArchive, SchemaPlacesFixedFieldsFirst)
+{
+    const Reflection::Schema& schema = SaveGame::staticMetaObject()->schema();
+
+    ASSERT_EQ( 4, schema.fieldCount() );
+    EXPECT_EQ( 3, schema.fixedFieldCount() );
+    EXPECT_EQ( 4 + 4 + 12, schema.fixedSize() );
+    EXPECT_EQ( Reflection::BinaryValue::kString, schema.field( 3 ).type );
+}
+
+TEST(BinaryArchive, RoundTrip)
+{
+    SaveGame source;
+    source.setHealth( 75.5f );
+    source.setLevel( 12 );
+    source.setPosition( Vec3( 1.0f, 2.0f, 3.0f ) );
+    source.setName( "player" );
+
+    Io::ByteBufferPtr buffer = Io::ByteBuffer::create();
+    Reflection::Serializer serializer;
+
+    {
+        Reflection::BinaryArchive ar( buffer );
+        ASSERT_TRUE( serializer.serialize( source.metaInstance(), ar ) );
+    }
+
+    buffer->setPosition( 0 );
+
+    SaveGame target;
+    Reflection::BinaryArchive ar( buffer );
+    ASSERT_TRUE( serializer.deserialize( target.metaInstance(), ar ) );
+
+    EXPECT_EQ( source.health(), target.health() );
+    EXPECT_EQ( source.level(), target.level() );
+    EXPECT_EQ( source.position().x, target.position().x );
+    EXPECT_EQ( source.position().z, target.position().z );
+    EXPECT_EQ( source.name(), target.name() );
+}
+
+TEST(BinaryArchive, SchemaIsWrittenOnce)
+{
+    SaveGame instance;
+
+    Io::ByteBufferPtr buffer = Io::ByteBuffer::create();
+    Reflection::Serializer serializer;
+    Reflection::BinaryArchive ar( buffer );
+
+    serializer.serialize( instance.metaInstance(), ar );
+    s32 first = buffer->length();
+
+    serializer.serialize( instance.metaInstance(), ar );
+    s32 second = buffer->length() - first;
+
+    EXPECT_LT( second, first );
+}
+
+TEST(BinaryArchive, ReadsOlderLayout)
+{
+    SaveGameV1 source;
+    source.setCoins( 500 );
+    source.setLevel( 3 );
+    source.setName( "legacy" );
+
+    Io::ByteBufferPtr buffer = Io::ByteBuffer::create();
+    Reflection::Serializer serializer;
+
+    {
+        Reflection::BinaryArchive ar( buffer );
+        serializer.serialize( source.metaInstance(), ar );
+        serializer.serialize( source.metaInstance(), ar );
+    }
+
+    buffer->setPosition( 0 );
+
+    // Both records are read, the second one references a schema embedded to the first one
+    Reflection::BinaryArchive ar( buffer );
+
+    for( s32 i = 0; i < 2; i++ ) {
+        SaveGame target;
+        target.setHealth( 10.0f );
+
+        ASSERT_TRUE( serializer.deserialize( target.metaInstance(), ar ) );
+        EXPECT_EQ( 3, target.level() );
+        EXPECT_EQ( "legacy", target.name() );
+        EXPECT_EQ( 10.0f, target.health() );
+    }
+
+    EXPECT_FALSE( buffer->hasDataLeft() );
+}
+
+TEST(BinaryArchive, RejectsTruncatedRecord)
+{
+    Array<u8> bytes = writeSaveGame();
+    ASSERT_TRUE( readSaveGame( bytes ) );
+
+    // Cut the tail of a name string
+    bytes.resize( bytes.size() - 3 );
+    EXPECT_FALSE( readSaveGame( bytes ) );
+
+    // Cut a record header
+    bytes.resize( 3 );
+    EXPECT_FALSE( readSaveGame( bytes ) );
+}
+
+TEST(BinaryArchive, RejectsOversizedLengthPrefix)
+{
+    Array<u8> bytes = writeSaveGame();
+
+    // A class name length prefix follows a 4 byte hash and a 1 byte flags
+    u32 length = 0xffffffff;
+    memcpy( &bytes[5], &length, 4 );
+
+    EXPECT_FALSE( readSaveGame( bytes ) );
+}
+
+TEST(BinaryArchive, RejectsUnknownFieldType)
+{
+    Array<u8> bytes = writeSaveGame();
+
+    // Header, class name and a field count are followed by a name hash and a type of the first field
+    s32 offset = 4 + 1 + 4 + static_cast<s32>( strlen( "SaveGame" ) ) + 2 + 4;
+    bytes[offset] = Reflection::BinaryValue::kTotalTypes;
+
+    EXPECT_FALSE( readSaveGame( bytes ) );
+}
+
+TEST(BinaryArchive, DecodesUnalignedFloats)
+{
+    u8 bytes[1 + 12];
+    f32 values[] = { 1.0f, 2.0f, 3.0f };
+    memcpy( bytes + 1, values, sizeof( values ) );
+
+    Vec3 v = Reflection::BinaryValue::decode( Reflection::BinaryValue::kVec3, bytes + 1 ).as<Vec3>();
+    EXPECT_EQ( 1.0f, v.x );
+    EXPECT_EQ( 2.0f, v.y );
+    EXPECT_EQ( 3.0f, v.z );
+}
+
+TEST(Reflection, TypedPropertyAccessors)
+{
+    SaveGame instance;
+    const Reflection::Class* cls = SaveGame::staticMetaObject();
+
+    const Reflection::Property* level = cls->findMember( "level" )->isProperty();
+    ASSERT_TRUE( level != NULL );
+    EXPECT_EQ( level, cls->findMemberByHash( Reflection::MetaObject::hashName( "level" ) ) );
+
+    level->set<s32>( instance.metaInstance(), 42 );
+    EXPECT_EQ( 42, instance.level() );
+    EXPECT_EQ( 42, level->get<s32>( instance.metaInstance() ) );
+}
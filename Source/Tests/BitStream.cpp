@@ -0,0 +1,66 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "UnitTests.h"
+
+DC_USE_DREEMCHEST
+
+TEST(BitStream, ValuesAreReadBack)
+{
+    Network::BitWriter writer;
+    writer.writeVarUInt( 0 );
+    writer.writeVarUInt( 300 );
+    writer.writeVarUInt( 0xFFFFFFFF );
+    writer.writeBits( 5, 3 );
+    writer.writeBool( true );
+
+    Network::BitReader reader( writer.data() );
+    EXPECT_EQ( 0u, reader.readVarUInt() );
+    EXPECT_EQ( 300u, reader.readVarUInt() );
+    EXPECT_EQ( 0xFFFFFFFFu, reader.readVarUInt() );
+    EXPECT_EQ( 5u, reader.readBits( 3 ) );
+    EXPECT_TRUE( reader.readBool() );
+    EXPECT_FALSE( reader.hasFailed() );
+}
+
+TEST(BitStream, ReadingPastTheEndFails)
+{
+    BinaryBlob         data( 1, 0xFF );
+    Network::BitReader reader( data );
+
+    reader.readVarUInt();
+    EXPECT_TRUE( reader.hasFailed() );
+    EXPECT_EQ( 0u, reader.readBits( 3 ) );
+}
+
+TEST(BitStream, TooLongVariableIntegerFails)
+{
+    BinaryBlob         data( 10, 0xFF );
+    Network::BitReader reader( data );
+
+    EXPECT_EQ( 0u, reader.readVarUInt() );
+    EXPECT_TRUE( reader.hasFailed() );
+}
@@ -0,0 +1,127 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "UnitTests.h"
+
+DC_USE_DREEMCHEST
+
+//! Cooks a pair of named entities and returns a cooked scene blob.
+static Array<u8> cookTestScene( void )
+{
+    Ecs::EcsPtr      ecs = Ecs::Ecs::create();
+    Ecs::EntityArray entities;
+
+    for( s32 i = 0; i < 2; i++ ) {
+        Ecs::EntityPtr entity = ecs->createEntity();
+        entity->attach<Scene::Identifier>( i ? "second" : "first" );
+        entity->attach<Scene::Transform>()->setPosition( Vec3( 1.0f, 2.0f, 3.0f ) * static_cast<f32>( i ) );
+        entities.push_back( entity );
+    }
+
+    Io::ByteBufferPtr buffer = Io::ByteBuffer::create();
+    Ecs::SceneCooker( ecs ).cook( entities, buffer );
+
+    return Array<u8>( buffer->buffer(), buffer->buffer() + buffer->length() );
+}
+
+//! Loads a cooked scene from a blob to a new Ecs instance.
+static bool loadTestScene( const Array<u8>& blob, Ecs::EntityArray& entities )
+{
+    Reflection::AssemblyPtr assembly = Reflection::Assembly::create();
+    assembly->registerClass<Scene::Identifier>();
+    assembly->registerClass<Scene::Transform>();
+
+    Ecs::EcsPtr ecs = Ecs::Ecs::create();
+    return Ecs::CookedSceneLoader( ecs ).load( assembly, Io::ByteBuffer::createFromArray( blob ), entities );
+}
+
+//! Returns an offset of a class table inside a cooked scene blob.
+static s32 classTableOffset( const Array<u8>& blob )
+{
+    u32 stringCount;
+    memcpy( &stringCount, &blob[8], 4 );
+
+    s32 offset = 24;
+
+    for( u32 i = 0; i < stringCount; i++ ) {
+        u32 length;
+        memcpy( &length, &blob[offset], 4 );
+        offset += 4 + length;
+    }
+
+    return offset;
+}
+
+TEST(CookedScene, RoundTrip)
+{
+    Ecs::EntityArray entities;
+    ASSERT_TRUE( loadTestScene( cookTestScene(), entities ) );
+    ASSERT_EQ( 2, entities.size() );
+
+    EXPECT_EQ( "first", entities[0]->get<Scene::Identifier>()->name() );
+    EXPECT_EQ( "second", entities[1]->get<Scene::Identifier>()->name() );
+    EXPECT_EQ( 3.0f, entities[1]->get<Scene::Transform>()->position().z );
+}
+
+TEST(CookedScene, TruncatedSceneIsRejected)
+{
+    Array<u8> blob = cookTestScene();
+
+    // Cut a blob at each byte, so every table and record is truncated once
+    for( size_t size = 1; size < blob.size(); size++ ) {
+        Ecs::EntityArray entities;
+        EXPECT_FALSE( loadTestScene( Array<u8>( blob.begin(), blob.begin() + size ), entities ) ) << "blob size " << size;
+        EXPECT_TRUE( entities.empty() );
+    }
+}
+
+TEST(CookedScene, InvalidTableSizesAreRejected)
+{
+    Array<u8> blob = cookTestScene();
+    u32       huge = ~0u;
+
+    // String, class and entity counts are stored right after the magic and version
+    for( s32 offset = 8; offset < 20; offset += 4 ) {
+        Array<u8> corrupted = blob;
+        memcpy( &corrupted[offset], &huge, 4 );
+
+        Ecs::EntityArray entities;
+        EXPECT_FALSE( loadTestScene( corrupted, entities ) ) << "offset " << offset;
+    }
+}
+
+TEST(CookedScene, InvalidStringIndexIsRejected)
+{
+    Array<u8> blob   = cookTestScene();
+    u32       string = 1000;
+
+    // The first class table entry starts with a class name index
+    memcpy( &blob[classTableOffset( blob )], &string, 4 );
+
+    Ecs::EntityArray entities;
+    EXPECT_FALSE( loadTestScene( blob, entities ) );
+    EXPECT_TRUE( entities.empty() );
+}
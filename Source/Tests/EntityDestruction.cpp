@@ -0,0 +1,152 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "UnitTests.h"
+
+DC_USE_DREEMCHEST
+
+//! Creates a specified number of entities with a Transform component and adds them to an ECS.
+static Ecs::EntityArray createTestEntities( Ecs::EcsWPtr ecs, s32 count )
+{
+    Ecs::EntityArray entities;
+
+    for( s32 i = 0; i < count; i++ ) {
+        Ecs::EntityPtr entity = ecs->createEntity();
+        entity->attach<Scene::Transform>();
+        ecs->addEntity( entity );
+        entities.push_back( entity );
+    }
+
+    ecs->update( 0, 0.0f );
+    return entities;
+}
+
+//! Queues all entities for removal and returns weak pointers to them.
+static Ecs::EntityWeakArray removeTestEntities( Ecs::EntityArray& entities )
+{
+    Ecs::EntityWeakArray result;
+
+    for( s32 i = 0, n = static_cast<s32>( entities.size() ); i < n; i++ ) {
+        result.push_back( entities[i] );
+        entities[i]->queueRemoval();
+    }
+
+    entities.clear();
+    return result;
+}
+
+//! Returns the number of entities that were not destroyed yet.
+static s32 aliveTestEntities( const Ecs::EntityWeakArray& entities )
+{
+    s32 count = 0;
+
+    for( s32 i = 0, n = static_cast<s32>( entities.size() ); i < n; i++ ) {
+        count += entities[i].valid() ? 1 : 0;
+    }
+
+    return count;
+}
+
+TEST(EntityDestruction, WithoutBudgetEntitiesAreDestroyedAtOnce)
+{
+    Ecs::EcsPtr      ecs      = Ecs::Ecs::create();
+    Ecs::IndexPtr    index    = ecs->requestIndex( "Transforms", Ecs::Aspect::all<Scene::Transform>() );
+    Ecs::EntityArray entities = createTestEntities( ecs, 10 );
+    EXPECT_EQ( 10, index->size() );
+
+    Ecs::EntityWeakArray removed = removeTestEntities( entities );
+    ecs->update( 0, 0.0f );
+
+    EXPECT_EQ( 0, index->size() );
+    EXPECT_EQ( 0, ecs->destructionQueueSize() );
+    EXPECT_EQ( 0, aliveTestEntities( removed ) );
+}
+
+TEST(EntityDestruction, RemovedEntitiesLeaveIndicesBeforeDestruction)
+{
+    Ecs::EcsPtr      ecs      = Ecs::Ecs::create();
+    Ecs::IndexPtr    index    = ecs->requestIndex( "Transforms", Ecs::Aspect::all<Scene::Transform>() );
+    Ecs::EntityArray entities = createTestEntities( ecs, 10 );
+    Ecs::EntityId    id       = entities[0]->id();
+
+    ecs->setDestructionBudget( 1 );
+
+    Ecs::EntityWeakArray removed = removeTestEntities( entities );
+    ecs->update( 0, 0.0f );
+
+    // Entities are not visible anymore, but are still alive in a destruction queue
+    EXPECT_EQ( 0, index->size() );
+    EXPECT_FALSE( ecs->findEntity( id ).valid() );
+    EXPECT_EQ( 10, ecs->destructionQueueSize() );
+    EXPECT_EQ( 10, aliveTestEntities( removed ) );
+
+    // Zero budget releases everything
+    EXPECT_EQ( 10, ecs->destroyRemovedEntities( 0 ) );
+    EXPECT_EQ( 0, ecs->destructionQueueSize() );
+    EXPECT_EQ( 0, aliveTestEntities( removed ) );
+}
+
+TEST(EntityDestruction, BudgetedDestructionAlwaysMakesProgress)
+{
+    Ecs::EcsPtr      ecs      = Ecs::Ecs::create();
+    Ecs::EntityArray entities = createTestEntities( ecs, 1000 );
+
+    ecs->setDestructionBudget( 1 );
+
+    Ecs::EntityWeakArray removed = removeTestEntities( entities );
+    ecs->update( 0, 0.0f );
+
+    // Each call releases at least one batch of entities until a queue is empty
+    s32 calls = 0;
+
+    while( ecs->destructionQueueSize() ) {
+        EXPECT_GT( ecs->destroyRemovedEntities( ecs->destructionBudget() ), 0 );
+        calls++;
+    }
+
+    EXPECT_LE( calls, 1000 / 64 + 1 );
+    EXPECT_EQ( 0, aliveTestEntities( removed ) );
+}
+
+TEST(EntityDestruction, SceneDestroysEntitiesOncePerFrame)
+{
+    Scene::ScenePtr scene = Scene::Scene::create();
+    Ecs::EcsWPtr    ecs   = scene->ecs();
+
+    ecs->setDestructionBudget( 1 );
+
+    Ecs::EntityArray     entities = createTestEntities( ecs, 10 );
+    Ecs::EntityWeakArray removed  = removeTestEntities( entities );
+
+    // An ECS update only moves entities to a destruction queue
+    ecs->update( 0, 0.0f );
+    EXPECT_EQ( 10, ecs->destructionQueueSize() );
+
+    // A scene update releases them within a frame budget
+    scene->update( 0, 0.0f );
+    EXPECT_EQ( 0, ecs->destructionQueueSize() );
+    EXPECT_EQ( 0, aliveTestEntities( removed ) );
+}
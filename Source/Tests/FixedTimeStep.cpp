@@ -0,0 +1,153 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+
+#include "UnitTests.h"
+
+DC_USE_DREEMCHEST
+
+//! A simulation system that counts updates and records the last time step.
+class SimulationStepCounter : public Ecs::System {
+public:
+
+                        //! Constructs SimulationStepCounter instance.
+                        SimulationStepCounter( void )
+                            : System( "SimulationStepCounter" ), steps( 0 ), lastStep( 0.0f ) {}
+
+    //! Records a simulation step.
+    virtual void        update( u32 currentTime, f32 dt ) NIMBLE_OVERRIDE { steps++; lastStep = dt; }
+
+    s32                 steps;      //!< A total number of performed simulation steps.
+    f32                 lastStep;   //!< A time step of the last simulation step.
+};
+
+//! A simulation system that moves a single transform by one unit along the X axis each step.
+class TransformMover : public Ecs::System {
+public:
+
+                        //! Constructs TransformMover instance.
+                        TransformMover( Scene::Transform* transform )
+                            : System( "TransformMover" ), transform( transform ) {}
+
+    //! Moves a transform.
+    virtual void        update( u32 currentTime, f32 dt ) NIMBLE_OVERRIDE { transform->setX( transform->x() + 1.0f ); }
+
+    Scene::Transform*   transform;  //!< A transform being moved.
+};
+
+TEST(FixedTimeStep, FrameTimeIsAccumulatedUntilStepFits)
+{
+    Scene::ScenePtr                 scene   = Scene::Scene::create();
+    WeakPtr<SimulationStepCounter>  counter = scene->addSimulationSystem<SimulationStepCounter>();
+
+    scene->setFixedTimeStep( 10 );
+
+    scene->update( 0, 0.004f );
+    EXPECT_EQ( 0, counter->steps );
+    EXPECT_NEAR( 0.4f, scene->interpolationFactor(), 0.001f );
+
+    scene->update( 0, 0.004f );
+    EXPECT_EQ( 0, counter->steps );
+
+    // 12 milliseconds were accumulated, so a single step is performed and 2 are left
+    scene->update( 0, 0.004f );
+    EXPECT_EQ( 1, counter->steps );
+    EXPECT_FLOAT_EQ( 0.01f, counter->lastStep );
+    EXPECT_NEAR( 0.2f, scene->interpolationFactor(), 0.001f );
+}
+
+TEST(FixedTimeStep, SubMillisecondRemaindersAreCarriedOver)
+{
+    Scene::ScenePtr                 scene   = Scene::Scene::create();
+    WeakPtr<SimulationStepCounter>  counter = scene->addSimulationSystem<SimulationStepCounter>();
+
+    scene->setFixedTimeStep( 10 );
+
+    // Half milliseconds are not lost, so four 2.5 millisecond frames make a step
+    for( s32 i = 0; i < 3; i++ ) {
+        scene->update( 0, 0.0025f );
+    }
+    EXPECT_EQ( 0, counter->steps );
+
+    scene->update( 0, 0.0025f );
+    EXPECT_EQ( 1, counter->steps );
+}
+
+TEST(FixedTimeStep, StepsAboveLimitAreDropped)
+{
+    Scene::ScenePtr                 scene   = Scene::Scene::create();
+    WeakPtr<SimulationStepCounter>  counter = scene->addSimulationSystem<SimulationStepCounter>();
+
+    scene->setFixedTimeStep( 10, 3 );
+
+    // A slow frame fits ten steps, but only three are performed and each keeps a fixed duration
+    scene->update( 0, 0.1f );
+    EXPECT_EQ( 3, counter->steps );
+    EXPECT_FLOAT_EQ( 0.01f, counter->lastStep );
+
+    // Dropped steps are not carried over to a next frame
+    scene->update( 0, 0.005f );
+    EXPECT_EQ( 3, counter->steps );
+    EXPECT_NEAR( 0.5f, scene->interpolationFactor(), 0.001f );
+}
+
+TEST(FixedTimeStep, WithoutFixedStepSimulationRunsOncePerFrame)
+{
+    Scene::ScenePtr                 scene   = Scene::Scene::create();
+    WeakPtr<SimulationStepCounter>  counter = scene->addSimulationSystem<SimulationStepCounter>();
+
+    EXPECT_EQ( 0u, scene->fixedTimeStep() );
+
+    scene->update( 0, 0.033f );
+    scene->update( 0, 0.001f );
+
+    EXPECT_EQ( 2, counter->steps );
+    EXPECT_FLOAT_EQ( 0.001f, counter->lastStep );
+    EXPECT_FLOAT_EQ( 1.0f, scene->interpolationFactor() );
+}
+
+TEST(FixedTimeStep, OnlyRenderMatrixIsInterpolated)
+{
+    Scene::ScenePtr         scene     = Scene::Scene::create();
+    Scene::SceneObjectPtr   object    = scene->createSceneObject();
+    Scene::Transform*       transform = object->attach<Scene::Transform>();
+
+    scene->addSceneObject( object );
+    scene->addSimulationSystem<TransformMover>( transform );
+    scene->setFixedTimeStep( 10 );
+
+    // Register a transform before the first simulation step
+    scene->update( 0, 0.0f );
+
+    // A single step is performed and a half of a step is left in an accumulator
+    scene->update( 0, 0.015f );
+
+    Vec3 simulated = transform->matrix() * Vec3( 0.0f, 0.0f, 0.0f );
+    Vec3 rendered  = transform->renderMatrix() * Vec3( 0.0f, 0.0f, 0.0f );
+
+    EXPECT_FLOAT_EQ( 1.0f, simulated.x );
+    EXPECT_NEAR( 0.5f, rendered.x, 0.001f );
+}
@@ -0,0 +1,256 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "UnitTests.h"
+
+DC_USE_DREEMCHEST
+
+//! Generates a flat grid mesh with specified number of quads along each side.
+static void createMeshProcessingGrid( s32 size, Scene::Mesh::VertexBuffer& vertices, Scene::Mesh::IndexBuffer& indices )
+{
+    s32 stride = size + 1;
+
+    vertices.resize( stride * stride );
+
+    for( s32 z = 0; z <= size; z++ ) {
+        for( s32 x = 0; x <= size; x++ ) {
+            Scene::Mesh::Vertex& vertex = vertices[z * stride + x];
+            vertex.position = Vec3( static_cast<f32>( x ), 0.0f, static_cast<f32>( z ) );
+            vertex.normal   = Vec3( 0.0f, 1.0f, 0.0f );
+            vertex.uv[0]    = Vec2( static_cast<f32>( x ) / size, static_cast<f32>( z ) / size );
+            vertex.uv[1]    = vertex.uv[0];
+        }
+    }
+
+    for( s32 z = 0; z < size; z++ ) {
+        for( s32 x = 0; x < size; x++ ) {
+            s32 quad[] = { z * stride + x, z * stride + x + 1, (z + 1) * stride + x, (z + 1) * stride + x + 1 };
+
+            indices.push_back( quad[0] ); indices.push_back( quad[2] ); indices.push_back( quad[1] );
+            indices.push_back( quad[1] ); indices.push_back( quad[2] ); indices.push_back( quad[3] );
+        }
+    }
+}
+
+//! Shuffles triangles with a fixed seed, so a vertex cache is used poorly.
+static void shuffleMeshProcessingTriangles( Scene::Mesh::IndexBuffer& indices )
+{
+    u32 seed = 12345;
+
+    for( s32 i = static_cast<s32>( indices.size() / 3 ) - 1; i > 0; i-- ) {
+        seed = seed * 1103515245 + 12345;
+        s32 j = (seed >> 16) % (i + 1);
+
+        for( s32 k = 0; k < 3; k++ ) {
+            std::swap( indices[i * 3 + k], indices[j * 3 + k] );
+        }
+    }
+}
+
+//! Returns triangles encoded from corner positions, each one is rotated to start from the smallest corner, so winding is preserved and triangles can be compared.
+static Array<u64> meshProcessingTriangles( const Scene::Mesh::VertexBuffer& vertices, const Scene::Mesh::IndexBuffer& indices )
+{
+    Array<u64> result;
+
+    for( s32 i = 0, n = static_cast<s32>( indices.size() ); i < n; i += 3 ) {
+        u64 corners[3];
+
+        for( s32 k = 0; k < 3; k++ ) {
+            const Vec3& position = vertices[indices[i + k]].position;
+            corners[k] = static_cast<u64>( position.x ) * 256 + static_cast<u64>( position.z );
+        }
+
+        s32 first = 0;
+        for( s32 k = 1; k < 3; k++ ) {
+            if( corners[k] < corners[first] ) first = k;
+        }
+
+        result.push_back( (corners[first] << 32) | (corners[(first + 1) % 3] << 16) | corners[(first + 2) % 3] );
+    }
+
+    std::sort( result.begin(), result.end() );
+    return result;
+}
+
+TEST(MeshProcessing, VertexCacheOptimizationKeepsTriangles)
+{
+    Scene::Mesh::VertexBuffer vertices;
+    Scene::Mesh::IndexBuffer  indices;
+    createMeshProcessingGrid( 32, vertices, indices );
+    shuffleMeshProcessingTriangles( indices );
+
+    Scene::Mesh::IndexBuffer optimized = indices;
+    Scene::MeshProcessing::optimizeVertexCache( optimized, static_cast<s32>( vertices.size() ) );
+
+    EXPECT_EQ( meshProcessingTriangles( vertices, indices ), meshProcessingTriangles( vertices, optimized ) );
+
+    // A grid reordered for a vertex cache should be close to one miss per triangle
+    f32 before = Scene::MeshProcessing::averageCacheMissRatio( indices, static_cast<s32>( vertices.size() ) );
+    f32 after  = Scene::MeshProcessing::averageCacheMissRatio( optimized, static_cast<s32>( vertices.size() ) );
+
+    EXPECT_LT( after, before );
+    EXPECT_LT( after, 1.0f );
+}
+
+TEST(MeshProcessing, VertexFetchOptimizationOrdersVerticesByFirstUse)
+{
+    Scene::Mesh::VertexBuffer vertices;
+    Scene::Mesh::IndexBuffer  indices;
+    createMeshProcessingGrid( 4, vertices, indices );
+    shuffleMeshProcessingTriangles( indices );
+
+    // The last vertex is not referenced by any triangle
+    vertices.push_back( vertices.back() );
+
+    Scene::Mesh::VertexBuffer reordered = vertices;
+    Scene::Mesh::IndexBuffer  remapped  = indices;
+    Scene::MeshProcessing::optimizeVertexFetch( reordered, remapped );
+
+    EXPECT_EQ( vertices.size() - 1, reordered.size() );
+    EXPECT_EQ( meshProcessingTriangles( vertices, indices ), meshProcessingTriangles( reordered, remapped ) );
+
+    // Each new vertex is referenced right after all previous ones
+    u32 next = 0;
+
+    for( s32 i = 0, n = static_cast<s32>( remapped.size() ); i < n; i++ ) {
+        ASSERT_LE( remapped[i], next );
+
+        if( remapped[i] == next ) {
+            next++;
+        }
+    }
+}
+
+TEST(MeshProcessing, IndexSize)
+{
+    EXPECT_EQ( 2, Scene::MeshProcessing::indexSize( 3 ) );
+    EXPECT_EQ( 2, Scene::MeshProcessing::indexSize( 65536 ) );
+    EXPECT_EQ( 4, Scene::MeshProcessing::indexSize( 65537 ) );
+}
+
+TEST(MeshProcessing, PackIndices)
+{
+    Scene::Mesh::IndexBuffer indices;
+    indices.push_back( 0 );
+    indices.push_back( 65535 );
+    indices.push_back( 7 );
+
+    Array<u8> packed16 = Scene::MeshProcessing::packIndices( indices, sizeof( u16 ) );
+    ASSERT_EQ( indices.size() * sizeof( u16 ), packed16.size() );
+
+    Array<u8> packed32 = Scene::MeshProcessing::packIndices( indices, sizeof( u32 ) );
+    ASSERT_EQ( indices.size() * sizeof( u32 ), packed32.size() );
+
+    for( s32 i = 0; i < 3; i++ ) {
+        u16 index16;
+        u32 index32;
+        memcpy( &index16, &packed16[i * sizeof( u16 )], sizeof( u16 ) );
+        memcpy( &index32, &packed32[i * sizeof( u32 )], sizeof( u32 ) );
+
+        EXPECT_EQ( indices[i], index16 );
+        EXPECT_EQ( indices[i], index32 );
+    }
+}
+
+TEST(MeshProcessing, PackVertices)
+{
+    Scene::Mesh::VertexBuffer vertices( 1 );
+    vertices[0].position = Vec3( 1.0f, -2.0f, 0.5f );
+    vertices[0].normal   = Vec3( 0.0f, -1.0f, 0.0f );
+    vertices[0].uv[0]    = Vec2( 0.25f, 0.75f );
+
+    Renderer::VertexFormat format( Renderer::VertexFormat::Normal | Renderer::VertexFormat::TexCoord0 );
+    Array<u8>              packed = Scene::MeshProcessing::packVertices( vertices, format );
+    ASSERT_EQ( format.vertexSize(), static_cast<s32>( packed.size() ) );
+
+    Vec3 position, normal;
+    Vec2 uv;
+    memcpy( &position.x, &packed[format.attributeOffset( Renderer::VertexFormat::Position )], sizeof( position ) );
+    memcpy( &normal.x, &packed[format.attributeOffset( Renderer::VertexFormat::Normal )], sizeof( normal ) );
+    memcpy( &uv.x, &packed[format.attributeOffset( Renderer::VertexFormat::TexCoord0 )], sizeof( uv ) );
+
+    EXPECT_EQ( vertices[0].position.x, position.x );
+    EXPECT_EQ( vertices[0].position.y, position.y );
+    EXPECT_EQ( vertices[0].position.z, position.z );
+    EXPECT_EQ( vertices[0].normal.y, normal.y );
+    EXPECT_EQ( vertices[0].uv[0].x, uv.x );
+    EXPECT_EQ( vertices[0].uv[0].y, uv.y );
+}
+
+TEST(MeshProcessing, PackVerticesToCompactFormat)
+{
+    Scene::Mesh::VertexBuffer vertices( 1 );
+    vertices[0].position = Vec3( 1.0f, -2.0f, 0.5f );
+    vertices[0].normal   = Vec3( 0.0f, -1.0f, 0.0f );
+    vertices[0].uv[0]    = Vec2( 0.25f, 0.75f );
+
+    Renderer::VertexFormat format( Renderer::VertexFormat::Normal | Renderer::VertexFormat::TexCoord0, Renderer::VertexFormat::PackedPosition | Renderer::VertexFormat::PackedNormal | Renderer::VertexFormat::PackedTexCoords );
+    Array<u8>              packed = Scene::MeshProcessing::packVertices( vertices, format );
+    ASSERT_EQ( format.vertexSize(), static_cast<s32>( packed.size() ) );
+
+    u16 position[4], uv[2];
+    s8  normal[4];
+    memcpy( position, &packed[format.attributeOffset( Renderer::VertexFormat::Position )], sizeof( position ) );
+    memcpy( normal, &packed[format.attributeOffset( Renderer::VertexFormat::Normal )], sizeof( normal ) );
+    memcpy( uv, &packed[format.attributeOffset( Renderer::VertexFormat::TexCoord0 )], sizeof( uv ) );
+
+    // Half float bit patterns of exactly representable values
+    EXPECT_EQ( 0x3C00, position[0] );
+    EXPECT_EQ( 0xC000, position[1] );
+    EXPECT_EQ( 0x3800, position[2] );
+    EXPECT_EQ( 0x3C00, position[3] );
+    EXPECT_EQ( 0x3400, uv[0] );
+    EXPECT_EQ( 0x3A00, uv[1] );
+
+    EXPECT_EQ( 0, normal[0] );
+    EXPECT_EQ( -127, normal[1] );
+    EXPECT_EQ( 0, normal[2] );
+}
+
+TEST(MeshProcessing, PackHalfRoundsAndClamps)
+{
+    EXPECT_EQ( 0x0000, Scene::MeshProcessing::packHalf( 0.0f ) );
+    EXPECT_EQ( 0x7BFF, Scene::MeshProcessing::packHalf( 65504.0f ) );
+    EXPECT_EQ( 0x7C00, Scene::MeshProcessing::packHalf( 100000.0f ) );
+    EXPECT_EQ( 0xFC00, Scene::MeshProcessing::packHalf( -100000.0f ) );
+    EXPECT_EQ( 0x0001, Scene::MeshProcessing::packHalf( 5.9604645e-8f ) );
+    EXPECT_EQ( 0x0000, Scene::MeshProcessing::packHalf( 1e-10f ) );
+}
+
+TEST(MeshProcessing, UnindexVertices)
+{
+    Scene::Mesh::VertexBuffer vertices;
+    Scene::Mesh::IndexBuffer  indices;
+    createMeshProcessingGrid( 2, vertices, indices );
+
+    Scene::Mesh::VertexBuffer unindexed = Scene::MeshProcessing::unindexVertices( vertices, indices );
+    ASSERT_EQ( indices.size(), unindexed.size() );
+
+    for( s32 i = 0, n = static_cast<s32>( indices.size() ); i < n; i++ ) {
+        EXPECT_EQ( vertices[indices[i]].position.x, unindexed[i].position.x );
+        EXPECT_EQ( vertices[indices[i]].position.z, unindexed[i].position.z );
+    }
+}
@@ -0,0 +1,106 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "UnitTests.h"
+
+DC_USE_DREEMCHEST
+
+//! A camera at the origin looking along a negative Z axis.
+static Matrix4 occlusionTestViewProjection( void )
+{
+    return Matrix4::perspective( 60.0f, 2.0f, 0.1f, 100.0f );
+}
+
+//! Adds a square occluder that faces a camera to an occlusion buffer.
+static void addOccluderQuad( Scene::OcclusionBuffer& buffer, f32 halfSize, f32 depth, bool clockwise )
+{
+    Vec3 vertices[] = {
+          Vec3( -halfSize, -halfSize, depth )
+        , Vec3(  halfSize, -halfSize, depth )
+        , Vec3(  halfSize,  halfSize, depth )
+        , Vec3( -halfSize,  halfSize, depth )
+    };
+    u32 counterClockwise[] = { 0, 1, 2, 0, 2, 3 };
+    u32 reversed[]         = { 0, 2, 1, 0, 3, 2 };
+
+    buffer.addOccluder( occlusionTestViewProjection(), vertices, sizeof( Vec3 ), clockwise ? reversed : counterClockwise, 6 );
+}
+
+TEST(OcclusionBuffer, EmptyBufferOccludesNothing)
+{
+    Scene::OcclusionBuffer buffer;
+    buffer.rasterize();
+
+    EXPECT_EQ( 0, buffer.triangleCount() );
+    EXPECT_FALSE( buffer.isOccluded( Bounds( Vec3( -1.0f, -1.0f, -21.0f ), Vec3( 1.0f, 1.0f, -19.0f ) ), occlusionTestViewProjection() ) );
+}
+
+TEST(OcclusionBuffer, FullscreenOccluderHasNoGaps)
+{
+    Scene::OcclusionBuffer buffer;
+    addOccluderQuad( buffer, 50.0f, -10.0f, false );
+    buffer.rasterize();
+
+    // Pixels along a diagonal shared by both triangles should be covered as well
+    for( s32 y = 0; y < Scene::OcclusionBuffer::Height; y++ ) {
+        for( s32 x = 0; x < Scene::OcclusionBuffer::Width; x++ ) {
+            ASSERT_LT( buffer.depthAt( 0, x, y ), 1.0f );
+        }
+    }
+
+    EXPECT_LT( buffer.depthAt( Scene::OcclusionBuffer::Levels - 1, 0, 0 ), 1.0f );
+}
+
+TEST(OcclusionBuffer, BoxBehindOccluderIsHidden)
+{
+    Scene::OcclusionBuffer buffer;
+    addOccluderQuad( buffer, 50.0f, -10.0f, false );
+    buffer.rasterize();
+
+    EXPECT_TRUE( buffer.isOccluded( Bounds( Vec3( -1.0f, -1.0f, -21.0f ), Vec3( 1.0f, 1.0f, -19.0f ) ), occlusionTestViewProjection() ) );
+    EXPECT_FALSE( buffer.isOccluded( Bounds( Vec3( -1.0f, -1.0f, -6.0f ), Vec3( 1.0f, 1.0f, -4.0f ) ), occlusionTestViewProjection() ) );
+}
+
+TEST(OcclusionBuffer, BoxNextToOccluderIsVisible)
+{
+    Scene::OcclusionBuffer buffer;
+    addOccluderQuad( buffer, 1.0f, -10.0f, true );
+    buffer.rasterize();
+
+    EXPECT_EQ( 2, buffer.triangleCount() );
+    EXPECT_TRUE( buffer.isOccluded( Bounds( Vec3( -0.5f, -0.5f, -21.0f ), Vec3( 0.5f, 0.5f, -19.0f ) ), occlusionTestViewProjection() ) );
+    EXPECT_FALSE( buffer.isOccluded( Bounds( Vec3( 3.0f, -0.5f, -21.0f ), Vec3( 4.0f, 0.5f, -19.0f ) ), occlusionTestViewProjection() ) );
+    EXPECT_FALSE( buffer.isOccluded( Bounds( Vec3( -5.0f, -5.0f, -21.0f ), Vec3( 5.0f, 5.0f, -19.0f ) ), occlusionTestViewProjection() ) );
+}
+
+TEST(OcclusionBuffer, BoxCrossingCameraPlaneIsVisible)
+{
+    Scene::OcclusionBuffer buffer;
+    addOccluderQuad( buffer, 50.0f, -10.0f, false );
+    buffer.rasterize();
+
+    EXPECT_FALSE( buffer.isOccluded( Bounds( Vec3( -1.0f, -1.0f, -30.0f ), Vec3( 1.0f, 1.0f, 1.0f ) ), occlusionTestViewProjection() ) );
+}
@@ -0,0 +1,105 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+
+#include "UnitTests.h"
+
+DC_USE_DREEMCHEST
+
+//! Creates a permutation manifest entry.
+static Renderer::RenderingContext::PermutationEntry createPermutationEntry( u32 program, u32 featureLayout, Renderer::PipelineFeatures features )
+{
+    Renderer::RenderingContext::PermutationEntry entry;
+    entry.program       = program;
+    entry.featureLayout = featureLayout;
+    entry.features      = features;
+    return entry;
+}
+
+TEST(PermutationManifest, FormattedEntriesAreParsedBack)
+{
+    Renderer::RenderingContext::PermutationManifest manifest;
+    manifest.insert( createPermutationEntry( 0x12345678, 0, 0 ) );
+    manifest.insert( createPermutationEntry( 0x12345678, 0x9abcdef0, 0x5 ) );
+    manifest.insert( createPermutationEntry( 0xffffffff, 0x1, static_cast<Renderer::PipelineFeatures>( 0x80000001 ) << 32 | 0x7 ) );
+
+    String text = Renderer::RenderingContext::formatPermutationManifest( manifest );
+
+    Renderer::RenderingContext::PendingPermutations parsed;
+    EXPECT_EQ( 3, Renderer::RenderingContext::parsePermutationManifest( text, parsed ) );
+
+    Renderer::RenderingContext::PermutationManifest restored( parsed.begin(), parsed.end() );
+    ASSERT_EQ( manifest.size(), restored.size() );
+
+    for( Renderer::RenderingContext::PermutationManifest::const_iterator i = manifest.begin(), j = restored.begin(); i != manifest.end(); ++i, ++j ) {
+        EXPECT_EQ( i->program, j->program );
+        EXPECT_EQ( i->featureLayout, j->featureLayout );
+        EXPECT_EQ( i->features, j->features );
+    }
+
+    // Formatting restored entries should produce exactly the same text
+    EXPECT_EQ( text, Renderer::RenderingContext::formatPermutationManifest( restored ) );
+}
+
+TEST(PermutationManifest, CommentsAndMalformedLinesAreSkipped)
+{
+    String text = "# program layout features\n"
+                  "\n"
+                  "0000000a 00000000 0000000000000001\n"
+                  "not an entry\n"
+                  "0000000b\n"
+                  "0000000c 00000002 0000000100000000";
+
+    Renderer::RenderingContext::PendingPermutations parsed;
+    EXPECT_EQ( 2, Renderer::RenderingContext::parsePermutationManifest( text, parsed ) );
+    ASSERT_EQ( 2u, parsed.size() );
+
+    EXPECT_EQ( 0xau, parsed.front().program );
+    EXPECT_EQ( 1u, parsed.front().features );
+    EXPECT_EQ( 0xcu, parsed.back().program );
+    EXPECT_EQ( 2u, parsed.back().featureLayout );
+    EXPECT_EQ( static_cast<Renderer::PipelineFeatures>( 1 ) << 32, parsed.back().features );
+}
+
+TEST(PermutationManifest, FeatureLayoutHashDependsOnContentOnly)
+{
+    Renderer::PipelineFeatureLayout a;
+    a.addFeature( "F_Color", Renderer::PipelineFeature::user( 0x1 ) );
+
+    Renderer::PipelineFeatureLayout b;
+    b.addFeature( "F_Color", Renderer::PipelineFeature::user( 0x1 ) );
+
+    Renderer::PipelineFeatureLayout c;
+    c.addFeature( "F_Fog", Renderer::PipelineFeature::user( 0x1 ) );
+
+    // Separately allocated layouts with the same features share a cached source
+    EXPECT_EQ( Renderer::ShaderLibrary::featureLayoutHash( &a ), Renderer::ShaderLibrary::featureLayoutHash( &b ) );
+    EXPECT_NE( Renderer::ShaderLibrary::featureLayoutHash( &a ), Renderer::ShaderLibrary::featureLayoutHash( &c ) );
+
+    // Zero is reserved for permutations without a layout
+    EXPECT_EQ( 0u, Renderer::ShaderLibrary::featureLayoutHash( NULL ) );
+    EXPECT_NE( 0u, Renderer::ShaderLibrary::featureLayoutHash( &a ) );
+}
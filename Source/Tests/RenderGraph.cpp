@@ -0,0 +1,122 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+
+#include "UnitTests.h"
+
+DC_USE_DREEMCHEST
+
+TEST(RenderGraph, PassesThatDoNotContributeToOutputAreCulled)
+{
+    Renderer::RenderGraph graph;
+
+    Renderer::RenderGraph::Resource shadows = graph.createTexture2D( 64, 64, Renderer::TextureD24 );
+    Renderer::RenderGraph::Resource unused  = graph.createTexture2D( 64, 64, Renderer::TextureD24 );
+
+    s32 shadowPass = graph.addPass( "Shadow", Renderer::RenderGraph::PassCallback() );
+    s32 unusedPass = graph.addPass( "Unused", Renderer::RenderGraph::PassCallback() );
+    s32 lightPass  = graph.addPass( "Light", Renderer::RenderGraph::PassCallback() );
+
+    graph.write( shadowPass, shadows );
+    graph.write( unusedPass, unused );
+    graph.read( lightPass, shadows );
+    graph.setSideEffects( lightPass );
+    graph.compile();
+
+    EXPECT_EQ( 2, graph.statistics().passes );
+    EXPECT_EQ( 1, graph.statistics().culledPasses );
+    EXPECT_EQ( 1, graph.statistics().resources );
+    EXPECT_EQ( 1, graph.statistics().physicalTextures );
+}
+
+TEST(RenderGraph, TexturesWithDisjointLifetimesAreAliased)
+{
+    Renderer::RenderGraph graph;
+
+    // A chain of passes where each one samples an output of a previous one
+    Renderer::RenderGraph::Resource textures[3];
+    s32                             passes[4];
+
+    for( s32 i = 0; i < 3; i++ ) {
+        textures[i] = graph.createTexture2D( 64, 64, Renderer::TextureD24 );
+    }
+
+    for( s32 i = 0; i < 4; i++ ) {
+        passes[i] = graph.addPass( "Pass", Renderer::RenderGraph::PassCallback() );
+
+        if( i > 0 ) {
+            graph.read( passes[i], textures[i - 1] );
+        }
+        if( i < 3 ) {
+            graph.write( passes[i], textures[i] );
+        }
+    }
+
+    graph.setSideEffects( passes[3] );
+    graph.compile();
+
+    // The first and the last textures are never alive at the same pass
+    const Renderer::RenderGraph::Statistics& statistics = graph.statistics();
+    EXPECT_EQ( 3, statistics.resources );
+    EXPECT_EQ( 2, statistics.physicalTextures );
+    EXPECT_EQ( statistics.requestedBytes / 3 * 2, statistics.physicalBytes );
+    EXPECT_EQ( statistics.physicalBytes, statistics.peakBytes );
+}
+
+TEST(RenderGraph, PeakBytesAreMaximumOfAliveTextures)
+{
+    Renderer::RenderGraph graph;
+
+    // Textures of different sizes can't be aliased, but the first and the last ones are never alive together
+    u16                             sizes[] = { 64, 128, 32 };
+    Renderer::RenderGraph::Resource textures[3];
+    s32                             passes[4];
+
+    for( s32 i = 0; i < 3; i++ ) {
+        textures[i] = graph.createTexture2D( sizes[i], sizes[i], Renderer::TextureD24 );
+    }
+
+    for( s32 i = 0; i < 4; i++ ) {
+        passes[i] = graph.addPass( "Pass", Renderer::RenderGraph::PassCallback() );
+
+        if( i > 0 ) {
+            graph.read( passes[i], textures[i - 1] );
+        }
+        if( i < 3 ) {
+            graph.write( passes[i], textures[i] );
+        }
+    }
+
+    graph.setSideEffects( passes[3] );
+    graph.compile();
+
+    const Renderer::RenderGraph::Statistics& statistics = graph.statistics();
+    s32 bytesPerPixel = statistics.requestedBytes / (64 * 64 + 128 * 128 + 32 * 32);
+
+    EXPECT_EQ( 3, statistics.physicalTextures );
+    EXPECT_EQ( statistics.requestedBytes, statistics.physicalBytes );
+    EXPECT_EQ( (64 * 64 + 128 * 128) * bytesPerPixel, statistics.peakBytes );
+}
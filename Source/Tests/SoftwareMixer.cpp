@@ -0,0 +1,203 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+
+#include "UnitTests.h"
+
+#include <Sound/Drivers/Mixer/SoftwareMixer.h>
+#include <Sound/Drivers/Mixer/MixerSource.h>
+
+DC_USE_DREEMCHEST
+
+//! An output sample rate and a sample rate of test sounds, so sources are mixed without resampling.
+static const u32 SoftwareMixerTestRate = 44100;
+
+//! A sound decoder that reads a constant 16-bit mono signal from memory.
+class ConstantSoundDecoder : public Sound::SoundDecoder {
+public:
+
+                        //! Constructs ConstantSoundDecoder instance.
+                        ConstantSoundDecoder( s16 value, u32 frames )
+                            : m_pcm( frames, value ), m_position( 0 ) { m_rate = SoftwareMixerTestRate; m_format = Sound::SoundSampleMono16; }
+
+    //! Copies PCM bytes starting from a current position.
+    virtual u32         read( u8* buffer, u32 size ) NIMBLE_OVERRIDE
+                        {
+                            u32 bytes = min2( size, this->size() - m_position );
+                            memcpy( buffer, reinterpret_cast<const u8*>( &m_pcm[0] ) + m_position, bytes );
+                            m_position += bytes;
+                            return bytes;
+                        }
+
+    //! Sets a current position.
+    virtual void        seek( u32 pos ) NIMBLE_OVERRIDE { m_position = pos; }
+
+    //! Returns a total size of PCM data.
+    virtual u32         size( void ) const NIMBLE_OVERRIDE { return static_cast<u32>( m_pcm.size() * sizeof( s16 ) ); }
+
+private:
+
+    Array<s16>          m_pcm;      //!< Decoded PCM samples.
+    u32                 m_position; //!< A current read position in bytes.
+};
+
+//! Creates a playing source with a constant signal of a half amplitude that lasts one second.
+static Sound::MixerSource* playConstantSource( Sound::SoftwareMixer& mixer, Array<Sound::SoundSourcePtr>& sources, const Vec3& position, u32 priority = 0 )
+{
+    Sound::SoundSourcePtr source = mixer.createSource();
+    source->setBuffer( mixer.createBuffer( DC_NEW ConstantSoundDecoder( 16384, SoftwareMixerTestRate ), 1 ) );
+    source->setPosition( position );
+    source->setPriority( priority );
+    source->setState( Sound::SoundSource::Playing );
+    sources.push_back( source );
+
+    return static_cast<Sound::MixerSource*>( source.get() );
+}
+
+//! Returns the last mixed left channel sample.
+static s16 lastMixedSample( const Sound::MemoryMixerOutput& output )
+{
+    const Array<s16>& samples = output.samples();
+    return samples.empty() ? 0 : samples[samples.size() - 2];
+}
+
+TEST(SoftwareMixer, VoicesPastMaxVoicesAreVirtualized)
+{
+    Sound::MemoryMixerOutputPtr   output = DC_NEW Sound::MemoryMixerOutput;
+    Sound::SoftwareMixer          mixer( output, 2, SoftwareMixerTestRate );
+    Array<Sound::SoundSourcePtr>  sources;
+    Sound::MixerSource*           voices[4];
+    ASSERT_TRUE( mixer.initialize() );
+
+    for( u32 i = 0; i < 4; i++ ) {
+        voices[i] = playConstantSource( mixer, sources, Vec3( 0.0f, 0.0f, 0.0f ), i );
+    }
+
+    // Only voices with the highest priority are mixed
+    mixer.mix( 1000 );
+    EXPECT_EQ( 2u, mixer.activeVoiceCount() );
+    EXPECT_EQ( 2u, mixer.virtualVoiceCount() );
+    EXPECT_TRUE( voices[0]->isVirtual() );
+    EXPECT_TRUE( voices[1]->isVirtual() );
+    EXPECT_FALSE( voices[2]->isVirtual() );
+    EXPECT_FALSE( voices[3]->isVirtual() );
+    EXPECT_EQ( 1000u, output->frameCount() );
+    EXPECT_NEAR( 2.0f * 0.5f * sqrtf( 0.5f ) * 32767.0f, lastMixedSample( *output ), 1.0f );
+
+    // Virtual voices keep advancing, so all cursors stay in sync
+    for( u32 i = 0; i < 4; i++ ) {
+        EXPECT_DOUBLE_EQ( 1000.0, voices[i]->cursor() );
+    }
+
+    // Virtual voices resume at a correct position once there are enough voices
+    mixer.setMaxVoices( 4 );
+    mixer.mix( 500 );
+    EXPECT_EQ( 4u, mixer.activeVoiceCount() );
+    EXPECT_EQ( 0u, mixer.virtualVoiceCount() );
+    EXPECT_NEAR( 4.0f * 0.5f * sqrtf( 0.5f ) * 32767.0f, lastMixedSample( *output ), 1.0f );
+
+    for( u32 i = 0; i < 4; i++ ) {
+        EXPECT_DOUBLE_EQ( 1500.0, voices[i]->cursor() );
+    }
+}
+
+TEST(SoftwareMixer, GainIsAttenuatedByDistanceModel)
+{
+    Sound::MemoryMixerOutputPtr   output = DC_NEW Sound::MemoryMixerOutput;
+    Sound::SoftwareMixer          mixer( output, 4, SoftwareMixerTestRate );
+    Array<Sound::SoundSourcePtr>  sources;
+    ASSERT_TRUE( mixer.initialize() );
+
+    // A source is right in front of a listener, so both channels have an equal gain
+    Sound::MixerSource* voice = playConstantSource( mixer, sources, Vec3( 0.0f, 0.0f, -10.0f ) );
+    voice->setReferenceDistance( 1.0f );
+    voice->setMaximumDistance( 100.0f );
+    voice->setRolloffFactor( 2.0f );
+
+    struct { Sound::DistanceModel model; f32 gain; } cases[] = {
+          { Sound::NoDistanceAttenutation,      1.0f                        }
+        , { Sound::InverseDistanceAttenuation,  1.0f / 19.0f                }
+        , { Sound::LinearDistanceAttenutation,  1.0f - 18.0f / 99.0f        }
+        , { Sound::ExponentDistanceAttenuation, 0.01f                       }
+    };
+
+    for( s32 i = 0, n = sizeof( cases ) / sizeof( cases[0] ); i < n; i++ ) {
+        mixer.setDistanceModel( cases[i].model );
+        mixer.mix( 16 );
+
+        EXPECT_NEAR( cases[i].gain, voice->audibility(), 1e-5f );
+        EXPECT_NEAR( 0.5f * cases[i].gain * sqrtf( 0.5f ) * 32767.0f, lastMixedSample( *output ), 1.0f );
+    }
+
+    // A source past the maximum distance is silent with a linear model and is not mixed
+    voice->setPosition( Vec3( 0.0f, 0.0f, -200.0f ) );
+    mixer.setDistanceModel( Sound::LinearDistanceAttenutation );
+    mixer.mix( 16 );
+
+    EXPECT_EQ( 0.0f, voice->audibility() );
+    EXPECT_TRUE( voice->isVirtual() );
+    EXPECT_EQ( 0u, mixer.activeVoiceCount() );
+    EXPECT_EQ( 0, lastMixedSample( *output ) );
+}
+
+TEST(SoftwareMixer, VectorizedAndScalarPathsMatch)
+{
+    // Odd counts make both a vectorized loop and a scalar tail run
+    const u32 frames = 37;
+
+    Array<f32> input( frames * 2 );
+    Array<f32> vectorized( frames * 2, 0.25f );
+    Array<f32> scalar( frames * 2, 0.25f );
+
+    for( u32 i = 0; i < frames * 2; i++ ) {
+        input[i] = sinf( i * 0.37f ) * 1.5f;
+    }
+
+    // Single frame calls are always handled by a scalar loop
+    Sound::SoftwareMixer::accumulate( &vectorized[0], &input[0], 0.3f, 0.7f, frames );
+
+    for( u32 i = 0; i < frames; i++ ) {
+        Sound::SoftwareMixer::accumulate( &scalar[i * 2], &input[i * 2], 0.3f, 0.7f, 1 );
+    }
+
+    for( u32 i = 0; i < frames * 2; i++ ) {
+        EXPECT_EQ( scalar[i], vectorized[i] );
+    }
+
+    // Samples out of a [-1, 1] range are clamped identically
+    Array<s16> converted( frames * 2 );
+    Array<s16> reference( frames * 2 );
+
+    Sound::SoftwareMixer::convert( &converted[0], &vectorized[0], 0.8f, frames * 2 );
+
+    for( u32 i = 0; i < frames * 2; i++ ) {
+        Sound::SoftwareMixer::convert( &reference[i], &vectorized[i], 0.8f, 1 );
+    }
+
+    for( u32 i = 0; i < frames * 2; i++ ) {
+        EXPECT_EQ( reference[i], converted[i] );
+    }
+}
@@ -0,0 +1,213 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "UnitTests.h"
+
+DC_USE_DREEMCHEST
+
+//! A number of items inserted to a spatial hash by benchmark tests.
+static const s32 SpatialHashBenchmarkItems = 10000;
+
+//! A number of queries performed by benchmark tests.
+static const s32 SpatialHashBenchmarkQueries = 2000;
+
+//! Returns a pseudo-random value in a specified range, a generator is seeded with a fixed value so tests are repeatable.
+static f32 spatialHashRandom( u32& seed, f32 min, f32 max )
+{
+    seed = seed * 1664525u + 1013904223u;
+    return min + (max - min) * ((seed >> 8) / 16777216.0f);
+}
+
+//! Returns a distance from a point to a rectangle.
+static f32 spatialHashDistance( const Vec2& min, const Vec2& max, const Vec2& point )
+{
+    f32 dx = max2( max2( min.x - point.x, point.x - max.x ), 0.0f );
+    f32 dy = max2( max2( min.y - point.y, point.y - max.y ), 0.0f );
+    return sqrtf( dx * dx + dy * dy );
+}
+
+//! Fills a spatial hash with random squares.
+static void fillSpatialHash( Scene::SpatialHash2D& hash, Array<Vec2>& min, Array<Vec2>& max, Array<Scene::SpatialHash2D::Handle>& handles, s32 count )
+{
+    u32 seed = 1;
+
+    for( s32 i = 0; i < count; i++ ) {
+        Vec2 center( spatialHashRandom( seed, -2000.0f, 2000.0f ), spatialHashRandom( seed, -2000.0f, 2000.0f ) );
+        f32  size = spatialHashRandom( seed, 1.0f, 40.0f );
+
+        min.push_back( center - Vec2( size, size ) );
+        max.push_back( center + Vec2( size, size ) );
+        handles.push_back( hash.insert( min.back(), max.back() ) );
+    }
+}
+
+TEST(SpatialHash2D, EmptyHashFindsNothing)
+{
+    Scene::SpatialHash2D                hash( 10.0f );
+    Array<Scene::SpatialHash2D::Handle> result;
+
+    EXPECT_EQ( 0, hash.queryRect( Vec2( -100.0f, -100.0f ), Vec2( 100.0f, 100.0f ), result ) );
+    EXPECT_EQ( 0, hash.queryRadius( Vec2( 0.0f, 0.0f ), 100.0f, result ) );
+    EXPECT_EQ( 0, hash.queryNearest( Vec2( 0.0f, 0.0f ), 4, result ) );
+}
+
+TEST(SpatialHash2D, ItemIsReportedOnceFromAllCells)
+{
+    Scene::SpatialHash2D                hash( 10.0f );
+    Array<Scene::SpatialHash2D::Handle> result;
+
+    Scene::SpatialHash2D::Handle item = hash.insert( Vec2( -25.0f, -25.0f ), Vec2( 25.0f, 25.0f ) );
+    EXPECT_EQ( 36, hash.cellCount() );
+
+    EXPECT_EQ( 1, hash.queryRect( Vec2( -100.0f, -100.0f ), Vec2( 100.0f, 100.0f ), result ) );
+    EXPECT_EQ( item, result[0] );
+}
+
+TEST(SpatialHash2D, MovedItemIsFoundAtNewPosition)
+{
+    Scene::SpatialHash2D                hash( 10.0f );
+    Array<Scene::SpatialHash2D::Handle> result;
+
+    Scene::SpatialHash2D::Handle item = hash.insert( Vec2( 0.0f, 0.0f ), Vec2( 1.0f, 1.0f ) );
+    hash.update( item, Vec2( 100.0f, 100.0f ), Vec2( 101.0f, 101.0f ) );
+
+    EXPECT_EQ( 0, hash.queryRadius( Vec2( 0.0f, 0.0f ), 5.0f, result ) );
+    EXPECT_EQ( 1, hash.queryRadius( Vec2( 100.0f, 100.0f ), 5.0f, result ) );
+    EXPECT_EQ( 1, hash.cellCount() );
+}
+
+TEST(SpatialHash2D, RemovedItemIsNotFound)
+{
+    Scene::SpatialHash2D                hash( 10.0f );
+    Array<Scene::SpatialHash2D::Handle> result;
+
+    Scene::SpatialHash2D::Handle first = hash.insert( Vec2( 0.0f, 0.0f ), Vec2( 1.0f, 1.0f ) );
+    hash.insert( Vec2( 50.0f, 0.0f ), Vec2( 51.0f, 1.0f ) );
+    hash.remove( first );
+
+    EXPECT_EQ( 1, hash.itemCount() );
+    EXPECT_EQ( 0, hash.queryRadius( Vec2( 0.0f, 0.0f ), 5.0f, result ) );
+}
+
+TEST(SpatialHash2D, NearestItemsAreSortedByDistance)
+{
+    Scene::SpatialHash2D                hash( 10.0f );
+    Array<Scene::SpatialHash2D::Handle> result;
+
+    Scene::SpatialHash2D::Handle farthest = hash.insert( Vec2( 300.0f, 0.0f ), Vec2( 301.0f, 1.0f ) );
+    Scene::SpatialHash2D::Handle nearest  = hash.insert( Vec2( 5.0f, 0.0f ), Vec2( 6.0f, 1.0f ) );
+    Scene::SpatialHash2D::Handle middle   = hash.insert( Vec2( 0.0f, 40.0f ), Vec2( 1.0f, 41.0f ) );
+
+    ASSERT_EQ( 3, hash.queryNearest( Vec2( 0.0f, 0.0f ), 5, result ) );
+    EXPECT_EQ( nearest, result[0] );
+    EXPECT_EQ( middle, result[1] );
+    EXPECT_EQ( farthest, result[2] );
+
+    result.clear();
+    EXPECT_EQ( 2, hash.queryNearest( Vec2( 0.0f, 0.0f ), 5, result, 100.0f ) );
+}
+
+TEST(SpatialHash2D, QueriesMatchLinearScan)
+{
+    Scene::SpatialHash2D                hash( 32.0f );
+    Array<Vec2>                         min, max;
+    Array<Scene::SpatialHash2D::Handle> handles;
+    u32                                 seed = 2;
+
+    fillSpatialHash( hash, min, max, handles, 2000 );
+
+    for( s32 i = 0; i < 100; i++ ) {
+        Vec2 point( spatialHashRandom( seed, -2500.0f, 2500.0f ), spatialHashRandom( seed, -2500.0f, 2500.0f ) );
+        f32  radius = spatialHashRandom( seed, 10.0f, 300.0f );
+
+        Array<Scene::SpatialHash2D::Handle> radiusResult, nearestResult;
+        hash.queryRadius( point, radius, radiusResult );
+        hash.queryNearest( point, 8, nearestResult );
+
+        // Run the same queries with a linear scan
+        s32        inside = 0;
+        Array<f32> distances;
+
+        for( s32 j = 0, n = static_cast<s32>( handles.size() ); j < n; j++ ) {
+            f32 distance = spatialHashDistance( min[j], max[j], point );
+            inside += distance <= radius ? 1 : 0;
+            distances.push_back( distance );
+        }
+
+        std::sort( distances.begin(), distances.end() );
+
+        EXPECT_EQ( inside, static_cast<s32>( radiusResult.size() ) );
+        ASSERT_EQ( 8, static_cast<s32>( nearestResult.size() ) );
+
+        for( s32 j = 0; j < 8; j++ ) {
+            EXPECT_FLOAT_EQ( distances[j], hash.distanceTo( nearestResult[j], point ) );
+        }
+    }
+}
+
+//! A timing comparison is not a unit test, so it's disabled by default and runs with --gtest_also_run_disabled_tests.
+TEST(SpatialHash2D, DISABLED_BenchmarkAgainstLinearScan)
+{
+    Scene::SpatialHash2D                hash( 32.0f );
+    Array<Vec2>                         min, max;
+    Array<Scene::SpatialHash2D::Handle> handles;
+    Array<Vec2>                         points;
+    u32                                 seed = 3;
+
+    fillSpatialHash( hash, min, max, handles, SpatialHashBenchmarkItems );
+
+    for( s32 i = 0; i < SpatialHashBenchmarkQueries; i++ ) {
+        points.push_back( Vec2( spatialHashRandom( seed, -2000.0f, 2000.0f ), spatialHashRandom( seed, -2000.0f, 2000.0f ) ) );
+    }
+
+    // Radius queries with a spatial hash
+    Array<Scene::SpatialHash2D::Handle> result;
+    s32                                 hashFound = 0;
+    u64                                 time      = Platform::currentTime();
+
+    for( s32 i = 0; i < SpatialHashBenchmarkQueries; i++ ) {
+        result.clear();
+        hashFound += hash.queryRadius( points[i], 100.0f, result );
+    }
+
+    u64 hashTime = Platform::currentTime() - time;
+
+    // Same queries with a linear scan
+    s32 linearFound = 0;
+    time = Platform::currentTime();
+
+    for( s32 i = 0; i < SpatialHashBenchmarkQueries; i++ ) {
+        for( s32 j = 0; j < SpatialHashBenchmarkItems; j++ ) {
+            linearFound += spatialHashDistance( min[j], max[j], points[i] ) <= 100.0f ? 1 : 0;
+        }
+    }
+
+    u64 linearTime = Platform::currentTime() - time;
+
+    EXPECT_EQ( linearFound, hashFound );
+    RecordProperty( "spatialHashMs", static_cast<s32>( hashTime ) );
+    RecordProperty( "linearScanMs", static_cast<s32>( linearTime ) );
+}
@@ -0,0 +1,221 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "UnitTests.h"
+
+DC_USE_DREEMCHEST
+
+//! A terrain with 16 x 16 chunks, so the root quadtree node has LOD 4.
+static const u32 TerrainLodTestSize = 512;
+
+//! Writes a level of detail of each selected node to a per-chunk grid and returns false if any chunk is covered twice or not covered at all.
+static bool fillTerrainLodGrid( const Scene::TerrainLod::Nodes& nodes, s32 chunks, Array<s32>& grid )
+{
+    grid.assign( chunks * chunks, -1 );
+
+    for( s32 i = 0, n = static_cast<s32>( nodes.size() ); i < n; i++ ) {
+        const Scene::TerrainLod::Node& node = nodes[i];
+
+        for( s32 z = node.z << node.lod; z < min2( (node.z + 1) << node.lod, chunks ); z++ ) {
+            for( s32 x = node.x << node.lod; x < min2( (node.x + 1) << node.lod, chunks ); x++ ) {
+                if( grid[z * chunks + x] != -1 ) {
+                    return false;
+                }
+                grid[z * chunks + x] = node.lod;
+            }
+        }
+    }
+
+    for( s32 i = 0, n = static_cast<s32>( grid.size() ); i < n; i++ ) {
+        if( grid[i] == -1 ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//! Returns true if all selected nodes have a tile to render.
+static bool hasAllTerrainTiles( const Scene::TerrainLod::Nodes& nodes )
+{
+    for( s32 i = 0, n = static_cast<s32>( nodes.size() ); i < n; i++ ) {
+        if( !nodes[i].tile.valid() ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+TEST(TerrainLod, DistantCameraSelectsRootNode)
+{
+    Scene::Terrain    terrain( TerrainLodTestSize );
+    Scene::TerrainLod lod( terrain, 32.0f );
+
+    const Scene::TerrainLod::Nodes& nodes = lod.update( Vec3( 100000.0f, 0.0f, 100000.0f ) );
+
+    ASSERT_EQ( 1u, nodes.size() );
+    EXPECT_EQ( lod.maxLod(), nodes[0].lod );
+    EXPECT_EQ( 0, nodes[0].edges );
+    EXPECT_TRUE( nodes[0].tile.valid() );
+}
+
+TEST(TerrainLod, NearestNodesAreFinest)
+{
+    Scene::Terrain    terrain( TerrainLodTestSize );
+    Scene::TerrainLod lod( terrain, 32.0f );
+    lod.setGenerationBudget( 1000 );
+
+    const Scene::TerrainLod::Nodes& nodes = lod.update( Vec3( 0.0f, 0.0f, 0.0f ) );
+    s32                             chunks = static_cast<s32>( terrain.chunkCount() );
+    Array<s32>                      grid;
+
+    ASSERT_TRUE( fillTerrainLodGrid( nodes, chunks, grid ) );
+    EXPECT_TRUE( hasAllTerrainTiles( nodes ) );
+
+    // A chunk under a camera is rendered at the finest LOD and the opposite corner is coarser
+    EXPECT_EQ( 0, grid[0] );
+    EXPECT_GT( grid[chunks * chunks - 1], 0 );
+
+    // Nodes are sorted from near to far
+    for( s32 i = 1, n = static_cast<s32>( nodes.size() ); i < n; i++ ) {
+        EXPECT_LE( nodes[i - 1].distance, nodes[i].distance );
+    }
+}
+
+TEST(TerrainLod, NeighboursDifferByOneLevel)
+{
+    Scene::Terrain    terrain( TerrainLodTestSize );
+    Scene::TerrainLod lod( terrain, 8.0f );
+    lod.setGenerationBudget( 1000 );
+
+    const Scene::TerrainLod::Nodes& nodes = lod.update( Vec3( 100.0f, 0.0f, 50.0f ) );
+    s32                             chunks = static_cast<s32>( terrain.chunkCount() );
+    Array<s32>                      grid;
+
+    ASSERT_TRUE( fillTerrainLodGrid( nodes, chunks, grid ) );
+
+    for( s32 z = 0; z < chunks; z++ ) {
+        for( s32 x = 0; x < chunks; x++ ) {
+            if( x + 1 < chunks ) EXPECT_LE( abs( grid[z * chunks + x] - grid[z * chunks + x + 1] ), 1 );
+            if( z + 1 < chunks ) EXPECT_LE( abs( grid[z * chunks + x] - grid[(z + 1) * chunks + x] ), 1 );
+        }
+    }
+
+    // Each edge that borders a coarser node is stitched
+    for( s32 i = 0, n = static_cast<s32>( nodes.size() ); i < n; i++ ) {
+        const Scene::TerrainLod::Node& node = nodes[i];
+
+        s32 x0   = node.x << node.lod;
+        s32 z0   = node.z << node.lod;
+        s32 size = 1 << node.lod;
+
+        EXPECT_EQ( z0 > 0 && grid[(z0 - 1) * chunks + x0] > node.lod, (node.edges & Scene::TerrainLod::EdgeNorth) != 0 );
+        EXPECT_EQ( x0 + size < chunks && grid[z0 * chunks + x0 + size] > node.lod, (node.edges & Scene::TerrainLod::EdgeEast) != 0 );
+        EXPECT_EQ( z0 + size < chunks && grid[(z0 + size) * chunks + x0] > node.lod, (node.edges & Scene::TerrainLod::EdgeSouth) != 0 );
+        EXPECT_EQ( x0 > 0 && grid[z0 * chunks + x0 - 1] > node.lod, (node.edges & Scene::TerrainLod::EdgeWest) != 0 );
+    }
+}
+
+TEST(TerrainLod, MissingTilesFallBackToCoarserOnes)
+{
+    Scene::Terrain    terrain( TerrainLodTestSize );
+    Scene::TerrainLod lod( terrain, 32.0f );
+    lod.setGenerationBudget( 1 );
+
+    s32        chunks = static_cast<s32>( terrain.chunkCount() );
+    Array<s32> grid;
+    Vec3       camera( 0.0f, 0.0f, 0.0f );
+
+    // A root tile is generated first, finer ones are generated one per update
+    const Scene::TerrainLod::Nodes& nodes = lod.update( camera );
+    ASSERT_EQ( 1u, nodes.size() );
+    EXPECT_EQ( lod.maxLod(), nodes[0].lod );
+    EXPECT_TRUE( nodes[0].tile.valid() );
+
+    // Each update covers a whole terrain exactly once until all tiles are generated
+    for( s32 i = 0; i < 100; i++ ) {
+        lod.update( camera );
+        ASSERT_TRUE( fillTerrainLodGrid( lod.nodes(), chunks, grid ) );
+        ASSERT_TRUE( hasAllTerrainTiles( lod.nodes() ) );
+
+        for( s32 j = 0, n = static_cast<s32>( lod.nodes().size() ); j < n; j++ ) {
+            const Scene::TerrainLod::Node& node = lod.nodes()[j];
+            EXPECT_EQ( node.lod, node.tile->lod() );
+            EXPECT_EQ( node.x, node.tile->x() );
+            EXPECT_EQ( node.z, node.tile->z() );
+        }
+    }
+
+    // Fallback tiles are replaced by selected tiles once those are generated
+    Scene::TerrainLod reference( terrain, 32.0f );
+    reference.setGenerationBudget( 1000 );
+    reference.update( camera );
+
+    EXPECT_EQ( reference.nodes().size(), lod.nodes().size() );
+    EXPECT_EQ( 0, grid[0] );
+}
+
+TEST(TerrainLod, UsedTilesAreNotEvicted)
+{
+    Scene::Terrain    terrain( TerrainLodTestSize );
+    Scene::TerrainLod lod( terrain, 32.0f, 4 );
+    lod.setGenerationBudget( 1000 );
+
+    // Tiles selected by a last update are kept even when a budget is exceeded
+    lod.update( Vec3( 0.0f, 0.0f, 0.0f ) );
+    EXPECT_EQ( lod.nodes().size() + 1, lod.residentTileCount() );
+
+    // Unused tiles are evicted down to a budget once a camera moves away
+    lod.update( Vec3( 100000.0f, 0.0f, 100000.0f ) );
+    EXPECT_EQ( lod.maxResidentTiles(), lod.residentTileCount() );
+}
+
+TEST(TerrainLod, AllCamerasShareSingleUpdate)
+{
+    Scene::Terrain    terrain( TerrainLodTestSize );
+    Scene::TerrainLod lod( terrain, 32.0f, 4 );
+    lod.setGenerationBudget( 1000 );
+
+    s32         chunks = static_cast<s32>( terrain.chunkCount() );
+    Array<s32>  grid;
+    Array<Vec3> cameras;
+    cameras.push_back( Vec3( 0.0f, 0.0f, 0.0f ) );
+    cameras.push_back( Vec3( static_cast<f32>( TerrainLodTestSize ), 0.0f, static_cast<f32>( TerrainLodTestSize ) ) );
+
+    // Chunks under both cameras are rendered at the finest LOD
+    lod.update( cameras );
+    ASSERT_TRUE( fillTerrainLodGrid( lod.nodes(), chunks, grid ) );
+    EXPECT_EQ( 0, grid[0] );
+    EXPECT_EQ( 0, grid[chunks * chunks - 1] );
+
+    // Tiles selected for any camera are kept even when a budget is exceeded
+    EXPECT_EQ( lod.nodes().size() + 1, lod.residentTileCount() );
+
+    for( s32 i = 0, n = static_cast<s32>( lod.nodes().size() ); i < n; i++ ) {
+        EXPECT_EQ( Scene::TerrainTile::Ready, lod.nodes()[i].tile->state() );
+    }
+}
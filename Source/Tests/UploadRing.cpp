@@ -0,0 +1,154 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+
+#include "UnitTests.h"
+
+DC_USE_DREEMCHEST
+
+//! An upload ring that records inserted and awaited fences instead of talking to a GPU.
+class RecordingUploadRing : public Renderer::UploadRing {
+public:
+
+                        //! Constructs RecordingUploadRing instance.
+                        RecordingUploadRing( s32 capacity, s32 framesInFlight )
+                            : UploadRing( capacity, framesInFlight, 16 ) {}
+
+    Array<u32>          insertedFences; //!< Frames protected by a fence in order.
+    Array<u32>          awaitedFences;  //!< Frames waited for in order.
+
+protected:
+
+    //! Records an inserted fence.
+    virtual void        insertFence( u32 frame ) NIMBLE_OVERRIDE { insertedFences.push_back( frame ); }
+
+    //! Records an awaited fence.
+    virtual void        waitFence( u32 frame ) NIMBLE_OVERRIDE { awaitedFences.push_back( frame ); }
+};
+
+TEST(UploadRing, AllocationsAreAligned)
+{
+    Renderer::UploadRing ring( 256, 3, 16 );
+
+    Renderer::UploadRing::Allocation a = ring.allocate( 10 );
+    Renderer::UploadRing::Allocation b = ring.allocate( 1 );
+
+    ASSERT_TRUE( a.data != NULL );
+    ASSERT_TRUE( b.data != NULL );
+    EXPECT_EQ( 0, a.offset );
+    EXPECT_EQ( 10, a.size );
+    EXPECT_EQ( 16, b.offset );
+    EXPECT_EQ( 32, ring.usedBytes() );
+}
+
+TEST(UploadRing, WrapsAroundToTheBeginning)
+{
+    RecordingUploadRing ring( 128, 2 );
+
+    // The first frame is retired as soon as the second one ends
+    EXPECT_EQ( 0, ring.allocate( 64 ).offset );
+    ring.endFrame();
+    EXPECT_EQ( 64, ring.allocate( 48 ).offset );
+    ring.endFrame();
+    EXPECT_EQ( 48, ring.usedBytes() );
+
+    // Does not fit after a head, so 16 bytes of a tail are wasted and an allocation starts from zero
+    Renderer::UploadRing::Allocation wrapped = ring.allocate( 32 );
+    ASSERT_TRUE( wrapped.data != NULL );
+    EXPECT_EQ( 0, wrapped.offset );
+    EXPECT_EQ( 48 + 16 + 32, ring.usedBytes() );
+
+    // Retiring the second frame releases a space between a head and the end of a ring
+    ring.endFrame();
+    EXPECT_EQ( 48, ring.usedBytes() );
+
+    Renderer::UploadRing::Allocation between = ring.allocate( 64 );
+    ASSERT_TRUE( between.data != NULL );
+    EXPECT_EQ( 32, between.offset );
+
+    // The wasted tail is released together with a frame that skipped it
+    ring.endFrame();
+    EXPECT_EQ( 64, ring.usedBytes() );
+    EXPECT_EQ( 0, ring.failedAllocations() );
+}
+
+TEST(UploadRing, StallsOnOldestFrameWhenFull)
+{
+    RecordingUploadRing ring( 128, 3 );
+
+    ring.allocate( 64 );
+    ring.endFrame();
+    ring.allocate( 64 );
+    ring.endFrame();
+
+    // Two frames in flight fit the limit, so nothing was awaited yet
+    ASSERT_EQ( 2u, ring.insertedFences.size() );
+    EXPECT_TRUE( ring.awaitedFences.empty() );
+
+    // A ring is full, so an allocation waits for the oldest frame and reuses it's segment
+    Renderer::UploadRing::Allocation allocation = ring.allocate( 16 );
+    ASSERT_TRUE( allocation.data != NULL );
+    EXPECT_EQ( 0, allocation.offset );
+    ASSERT_EQ( 1u, ring.awaitedFences.size() );
+    EXPECT_EQ( 0u, ring.awaitedFences[0] );
+    EXPECT_EQ( 64 + 16, ring.usedBytes() );
+}
+
+TEST(UploadRing, EndFrameBoundsFramesInFlight)
+{
+    RecordingUploadRing ring( 256, 3 );
+
+    for( s32 i = 0; i < 5; i++ ) {
+        ring.allocate( 16 );
+        ring.endFrame();
+    }
+
+    // Each frame is awaited in order once two newer frames were closed
+    ASSERT_EQ( 5u, ring.insertedFences.size() );
+    ASSERT_EQ( 3u, ring.awaitedFences.size() );
+
+    for( u32 i = 0; i < 3; i++ ) {
+        EXPECT_EQ( i, ring.awaitedFences[i] );
+    }
+
+    EXPECT_EQ( 32, ring.usedBytes() );
+}
+
+TEST(UploadRing, FailsWhenCurrentFrameOwnsWholeRing)
+{
+    RecordingUploadRing ring( 64, 3 );
+
+    EXPECT_TRUE( ring.allocate( 64 ).data != NULL );
+
+    // There are no frames in flight to wait for, so an allocation fails
+    EXPECT_TRUE( ring.allocate( 16 ).data == NULL );
+    EXPECT_TRUE( ring.awaitedFences.empty() );
+
+    // An allocation larger than a ring can never succeed
+    EXPECT_TRUE( ring.allocate( 65 ).data == NULL );
+    EXPECT_EQ( 2, ring.failedAllocations() );
+    EXPECT_EQ( 64, ring.usedBytes() );
+}